@@ -39,6 +39,7 @@
 #include "../../shared/gpubuf.h"
 #include "../../shared/rocfft_params.h"
 #include "rider.h"
+#include "rider_timing.h"
 #include "rocfft.h"
 
 #include <boost/program_options.hpp>
@@ -269,23 +270,18 @@ float run_plan(
     auto procfft_execute
         = (decltype(&rocfft_execute))rocfft_lib_symbol(libhandle, "rocfft_execute");
 
-    hipEvent_t start, stop;
-    HIP_V_THROW(hipEventCreate(&start), "hipEventCreate failed");
-    HIP_V_THROW(hipEventCreate(&stop), "hipEventCreate failed");
+    rider_event start, stop;
 
-    HIP_V_THROW(hipEventRecord(start), "hipEventRecord failed");
+    HIP_V_THROW(hipEventRecord(start.event), "hipEventRecord failed");
 
     procfft_execute(plan, in, out, info);
 
-    HIP_V_THROW(hipEventRecord(stop), "hipEventRecord failed");
-    HIP_V_THROW(hipEventSynchronize(stop), "hipEventSynchronize failed");
+    HIP_V_THROW(hipEventRecord(stop.event), "hipEventRecord failed");
+    HIP_V_THROW(hipEventSynchronize(stop.event), "hipEventSynchronize failed");
 
     float time;
-    HIP_V_THROW(hipEventElapsedTime(&time, start, stop), "hipEventElapsedTime failed");
+    HIP_V_THROW(hipEventElapsedTime(&time, start.event, stop.event), "hipEventElapsedTime failed");
     return time;
-
-    HIP_V_THROW(hipEventDestroy(start), "hipEventDestroy failed");
-    HIP_V_THROW(hipEventDestroy(stop), "hipEventDestroy failed");
 }
 
 // Load python library with RTLD_GLOBAL so that rocfft is free to
@@ -342,6 +338,9 @@ int main(int argc, char* argv[])
     // Number of performance trial samples
     int ntrial{};
 
+    // Number of untimed executions of each library before the trials
+    int nwarmup{};
+
     // Vector of test target libraries
     std::vector<std::string> libs;
 
@@ -351,6 +350,9 @@ int main(int argc, char* argv[])
     // Token string to fully specify fft params.
     std::string token;
 
+    // File to write results to, as JSON.
+    std::string json_file;
+
     // Declare the supported options.
 
     // clang-format doesn't handle boost program options very well:
@@ -361,6 +363,11 @@ int main(int argc, char* argv[])
         ("device", po::value<int>(&deviceId)->default_value(0), "Select a specific device id")
         ("verbose", po::value<int>(&verbose)->default_value(0), "Control output verbosity")
         ("ntrial,N", po::value<int>(&ntrial)->default_value(1), "Trial size for the problem")
+        ("warmup", po::value<int>(&nwarmup)->default_value(1),
+         "Number of untimed executions of each library before the trials")
+        ("flush-cache", "Flush the device L2 cache before each trial")
+        ("json", po::value<std::string>(&json_file),
+         "Write the plans, kernels, times and statistics to this file as JSON")
         ("notInPlace,o", "Not in-place FFT transform (default: in-place)")
         ("double", "Double precision transform (deprecated: use --precision double)")
         ("precision", po::value<fft_precision>(&params.precision), "Transform precision: single (default), double, half")
@@ -569,6 +576,34 @@ int main(int argc, char* argv[])
         handles.push_back(libhandle);
     }
 
+    // Create each library's plan in a session of its own with the
+    // plan log enabled.  Executions are also logged, so the plans
+    // that are timed are created after the capture is done.
+    std::vector<std::string> plan_text(libs.size());
+    if(!json_file.empty())
+    {
+        plan_log_capture plan_log;
+        for(unsigned int idx = 0; idx < libs.size(); ++idx)
+        {
+            auto capture_plan = make_plan(handles[idx],
+                                          rocfft_result_placement_from_fftparams(params.placement),
+                                          params.transform_type,
+                                          params.length_cm(),
+                                          params.istride_cm(),
+                                          params.ostride_cm(),
+                                          params.idist,
+                                          params.odist,
+                                          params.ioffset,
+                                          params.ooffset,
+                                          params.nbatch,
+                                          rocfft_precision_from_fftparams(params.precision),
+                                          rocfft_array_type_from_fftparams(params.itype),
+                                          rocfft_array_type_from_fftparams(params.otype));
+            plan_text[idx] = plan_log.read_new();
+            destroy_plan(handles[idx], capture_plan);
+        }
+    }
+
     // Set up plans:
     for(unsigned int idx = 0; idx < libs.size(); ++idx)
     {
@@ -659,15 +694,19 @@ int main(int argc, char* argv[])
         pobuffer[i] = obuffer->at(i).data();
     }
 
-    if(handles.size())
+    // Run the plan using its associated rocFFT library:
+    for(int iwarmup = 0; iwarmup < nwarmup; ++iwarmup)
     {
-        // Run the plan using its associated rocFFT library:
         for(unsigned int idx = 0; idx < handles.size(); ++idx)
         {
             run_plan(handles[idx], plan[idx], info[idx], pibuffer.data(), pobuffer.data());
         }
     }
 
+    std::unique_ptr<cache_flusher> flusher;
+    if(vm.count("flush-cache"))
+        flusher = std::make_unique<cache_flusher>();
+
     // Execution times for loaded libraries:
     std::vector<std::vector<double>> time(libs.size());
 
@@ -687,6 +726,9 @@ int main(int argc, char* argv[])
 
         params.compute_input(ibuffer);
 
+        if(flusher)
+            flusher->flush();
+
         // Run the plan using its associated rocFFT library:
         time[idx].push_back(
             run_plan(handles[idx], plan[idx], info[idx], pibuffer.data(), pobuffer.data()));
@@ -716,6 +758,29 @@ int main(int argc, char* argv[])
             std::cout << " " << i;
         }
         std::cout << " ms" << std::endl;
+        print_timing_stats(std::cout, compute_timing_stats(time[idx]));
+    }
+
+    if(!json_file.empty())
+    {
+        std::ofstream json(json_file);
+        json << "{\"token\": \"" << json_escape(params.token()) << "\", \"ntrial\": " << ntrial
+             << ", \"warmup\": " << nwarmup
+             << ", \"flush_cache\": " << (flusher ? "true" : "false") << ", \"libraries\": [";
+        for(unsigned int idx = 0; idx < libs.size(); ++idx)
+        {
+            json << (idx ? ", " : "") << "{\"lib\": \"" << json_escape(libs[idx])
+                 << "\", \"times\": ";
+            write_json_array(json, time[idx]);
+            json << ", \"stats\": ";
+            write_json(json, compute_timing_stats(time[idx]));
+            json << ", \"kernels\": ";
+            write_json(json, plan_log_kernels(plan_text[idx]));
+            json << ", \"plan\": \"" << json_escape(plan_text[idx]) << "\"}";
+        }
+        json << "]}" << std::endl;
+        if(!json)
+            throw std::runtime_error("Unable to write " + json_file);
     }
 
     // Clean up:
@@ -20,16 +20,311 @@
 
 #include <cmath>
 #include <cstddef>
+#include <fstream>
 #include <iostream>
+#include <numeric>
 #include <sstream>
+#include <string>
+#include <vector>
 
 #include "../../shared/gpubuf.h"
 #include "../../shared/rocfft_params.h"
 #include "rider.h"
+#include "rider_timing.h"
 #include "rocfft.h"
 #include <boost/program_options.hpp>
 namespace po = boost::program_options;
 
+// Number of floating-point operations in one execution of the
+// transform, as used for the gflops figures.
+static double transform_opscount(const fft_params& params)
+{
+    const double totsize
+        = std::accumulate(params.length.begin(), params.length.end(), 1, std::multiplies<size_t>());
+    const double k
+        = ((params.itype == fft_array_type_real) || (params.otype == fft_array_type_real)) ? 2.5
+                                                                                           : 5.0;
+    return (double)params.nbatch * k * totsize * log(totsize) / log(2.0);
+}
+
+// Time ntrial executions of a validated transform, after nwarmup
+// untimed executions.  If flusher is not null, the cache is flushed
+// before each trial.  Returns the execution times in milliseconds,
+// or an empty vector if the problem was skipped because it does not
+// fit on the device.  Progress messages are written to log.
+static std::vector<double> time_transform(rocfft_params& params,
+                                          const int      ntrial,
+                                          const int      nwarmup,
+                                          cache_flusher* flusher,
+                                          const int      verbose,
+                                          std::ostream&  log)
+{
+    const auto raw_vram_footprint
+        = params.fft_params_vram_footprint() + twiddle_table_vram_footprint(params);
+    if(!vram_fits_problem(raw_vram_footprint))
+    {
+        log << "SKIPPED: Problem size (" << raw_vram_footprint
+            << ") raw data too large for device.\n";
+        return {};
+    }
+
+    const auto vram_footprint = params.vram_footprint();
+    if(!vram_fits_problem(vram_footprint))
+    {
+        log << "SKIPPED: Problem size (" << vram_footprint << ") raw data too large for device.\n";
+        return {};
+    }
+
+    auto ret = params.create_plan();
+    if(ret != fft_status_success)
+        LIB_V_THROW(rocfft_status_failure, "Plan creation failed");
+
+    // GPU input buffer:
+    auto                ibuffer_sizes = params.ibuffer_sizes();
+    std::vector<gpubuf> ibuffer(ibuffer_sizes.size());
+    std::vector<void*>  pibuffer(ibuffer_sizes.size());
+    for(unsigned int i = 0; i < ibuffer.size(); ++i)
+    {
+        HIP_V_THROW(ibuffer[i].alloc(ibuffer_sizes[i]), "Creating input Buffer failed");
+        pibuffer[i] = ibuffer[i].data();
+    }
+
+    // Input data:
+    params.compute_input(ibuffer);
+
+    if(verbose > 1)
+    {
+        // Copy input to CPU
+        auto cpu_input = allocate_host_buffer(params.precision, params.itype, params.isize);
+        for(unsigned int idx = 0; idx < ibuffer.size(); ++idx)
+        {
+            HIP_V_THROW(hipMemcpy(cpu_input.at(idx).data(),
+                                  ibuffer[idx].data(),
+                                  ibuffer_sizes[idx],
+                                  hipMemcpyDeviceToHost),
+                        "hipMemcpy failed");
+        }
+
+        log << "GPU input:\n";
+        params.print_ibuffer(cpu_input, log);
+    }
+
+    // GPU output buffer:
+    std::vector<gpubuf>  obuffer_data;
+    std::vector<gpubuf>* obuffer = &obuffer_data;
+    if(params.placement == fft_placement_inplace)
+    {
+        obuffer = &ibuffer;
+    }
+    else
+    {
+        auto obuffer_sizes = params.obuffer_sizes();
+        obuffer_data.resize(obuffer_sizes.size());
+        for(unsigned int i = 0; i < obuffer_data.size(); ++i)
+        {
+            HIP_V_THROW(obuffer_data[i].alloc(obuffer_sizes[i]), "Creating output Buffer failed");
+        }
+    }
+    std::vector<void*> pobuffer(obuffer->size());
+    for(unsigned int i = 0; i < obuffer->size(); ++i)
+    {
+        pobuffer[i] = obuffer->at(i).data();
+    }
+
+    for(int iwarmup = 0; iwarmup < nwarmup; ++iwarmup)
+        params.execute(pibuffer.data(), pobuffer.data());
+
+    // Run the transform several times and record the execution time:
+    std::vector<double> gpu_time(ntrial);
+
+    rider_event start, stop;
+    for(unsigned int itrial = 0; itrial < gpu_time.size(); ++itrial)
+    {
+        params.compute_input(ibuffer);
+
+        if(flusher)
+            flusher->flush();
+
+        HIP_V_THROW(hipEventRecord(start.event), "hipEventRecord failed");
+
+        params.execute(pibuffer.data(), pobuffer.data());
+
+        HIP_V_THROW(hipEventRecord(stop.event), "hipEventRecord failed");
+        HIP_V_THROW(hipEventSynchronize(stop.event), "hipEventSynchronize failed");
+
+        float time;
+        HIP_V_THROW(hipEventElapsedTime(&time, start.event, stop.event),
+                    "hipEventElapsedTime failed");
+        gpu_time[itrial] = time;
+
+        if(verbose > 2)
+        {
+            auto output = allocate_host_buffer(params.precision, params.otype, params.osize);
+            for(unsigned int idx = 0; idx < output.size(); ++idx)
+            {
+                HIP_V_THROW(hipMemcpy(output[idx].data(),
+                                      pobuffer[idx],
+                                      output[idx].size(),
+                                      hipMemcpyDeviceToHost),
+                            "hipMemcpy failed");
+            }
+            log << "GPU output:\n";
+            params.print_obuffer(output, log);
+        }
+    }
+
+    return gpu_time;
+}
+
+// Write the results of timing a transform, as the members of a
+// JSON object.
+static void write_json_results(std::ostream&                   os,
+                               const fft_params&               params,
+                               const std::vector<double>&      gpu_time,
+                               const std::vector<plan_kernel>& kernels)
+{
+    const double        opscount = transform_opscount(params);
+    std::vector<double> gflops;
+    for(const auto& i : gpu_time)
+        gflops.push_back(opscount / (1e6 * i));
+
+    os << "\"status\": \"ok\", \"times\": ";
+    write_json_array(os, gpu_time);
+    os << ", \"gflops\": ";
+    write_json_array(os, gflops);
+    os << ", \"stats\": ";
+    write_json(os, compute_timing_stats(gpu_time));
+    os << ", \"kernels\": ";
+    write_json(os, kernels);
+}
+
+// Read fft params from a token, and check that they are valid.
+static void params_from_token(rocfft_params& params, const std::string& token, const int verbose)
+{
+    params.from_token(token);
+    params.validate();
+    if(!params.valid(verbose))
+        throw std::runtime_error("Invalid parameters");
+}
+
+// Create the plan for each token in a rocFFT session of its own, with
+// the plan log enabled, and return the log of each plan.  The library
+// also logs every execution, so the transforms are timed in a later
+// session without the plan log.  Tokens whose plan can't be created
+// get an empty log; the failure is reported when they are timed.
+static std::vector<std::string> capture_plan_logs(const std::vector<std::string>& tokens)
+{
+    std::vector<std::string> plan_text(tokens.size());
+
+    plan_log_capture plan_log;
+    rocfft_setup();
+    for(size_t i = 0; i < tokens.size(); ++i)
+    {
+        try
+        {
+            rocfft_params params;
+            params_from_token(params, tokens[i], 0);
+            // discard the log of any earlier plan that failed
+            plan_log.read_new();
+            if(params.setup_structs() == fft_status_success)
+                plan_text[i] = plan_log.read_new();
+        }
+        catch(std::exception&)
+        {
+        }
+    }
+    rocfft_cleanup();
+    return plan_text;
+}
+
+// Time each fft params token read from a file, one token per line,
+// in this process.  Empty lines and lines starting with '#' are
+// ignored.  One JSON object is written to stdout per token, in the
+// same order as the tokens, e.g.
+//
+//   {"token": "...", "status": "ok", "times": [0.1, 0.1], "gflops": [4.2, 4.2],
+//    "stats": {"median": 0.1, ...}, "kernels": [{"scheme": "CS_KERNEL_STOCKHAM", ...}]}
+//
+// where status is "ok", "skipped" or "failed".  Failed problems
+// also have a "message" describing the failure.  Other output goes
+// to stderr.
+static int run_token_file(const std::string& token_file,
+                          const int          ntrial,
+                          const int          nwarmup,
+                          cache_flusher*     flusher,
+                          const int          verbose)
+{
+    std::ifstream file;
+    if(token_file != "-")
+    {
+        file.open(token_file);
+        if(!file)
+        {
+            std::cerr << "Unable to open token file " << token_file << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    std::istream& input = token_file == "-" ? std::cin : file;
+
+    std::vector<std::string> tokens;
+    std::string              line;
+    while(std::getline(input, line))
+    {
+        // trim whitespace
+        const auto first = line.find_first_not_of(" \t\r");
+        if(first == std::string::npos || line[first] == '#')
+            continue;
+        tokens.push_back(line.substr(first, line.find_last_not_of(" \t\r") - first + 1));
+    }
+
+    const auto plan_text = capture_plan_logs(tokens);
+
+    rocfft_setup();
+
+    for(size_t i = 0; i < tokens.size(); ++i)
+    {
+        const auto& token = tokens[i];
+
+        // Build the whole result before writing it, since errors
+        // thrown by HIP_V_THROW and LIB_V_THROW are also printed to
+        // stdout.  Report the token with all defaults filled in, as
+        // printed in single-problem mode, if it can be parsed.
+        std::string        result_token = token;
+        std::ostringstream result;
+        try
+        {
+            rocfft_params params;
+            params_from_token(params, token, verbose);
+            result_token = params.token();
+
+            if(verbose)
+                std::cerr << params.str(" ") << std::endl;
+
+            const auto gpu_time
+                = time_transform(params, ntrial, nwarmup, flusher, verbose, std::cerr);
+            if(gpu_time.empty())
+            {
+                result << "\"status\": \"skipped\"}";
+            }
+            else
+            {
+                write_json_results(result, params, gpu_time, plan_log_kernels(plan_text[i]));
+                result << "}";
+            }
+        }
+        catch(std::exception& e)
+        {
+            result << "\"status\": \"failed\", \"message\": \"" << json_escape(e.what())
+                   << "\"}";
+        }
+        std::cout << "{\"token\": \"" << json_escape(result_token) << "\", " << result.str()
+                  << std::endl;
+    }
+
+    rocfft_cleanup();
+    return EXIT_SUCCESS;
+}
+
 int main(int argc, char* argv[])
 {
     // This helps with mixing output of both wide and narrow characters to the screen
@@ -44,12 +339,21 @@ int main(int argc, char* argv[])
     // Number of performance trial samples
     int ntrial{};
 
+    // Number of untimed executions before the trials
+    int nwarmup{};
+
     // FFT parameters:
     rocfft_params params;
 
     // Token string to fully specify fft params.
     std::string token;
 
+    // File of tokens to time in batch mode.
+    std::string token_file;
+
+    // File to write results to, as JSON.
+    std::string json_file;
+
     // Declare the supported options.
 
     // clang-format doesn't handle boost program options very well:
@@ -60,6 +364,11 @@ int main(int argc, char* argv[])
         ("device", po::value<int>(&deviceId)->default_value(0), "Select a specific device id")
         ("verbose", po::value<int>(&verbose)->default_value(0), "Control output verbosity")
         ("ntrial,N", po::value<int>(&ntrial)->default_value(1), "Trial size for the problem")
+        ("warmup", po::value<int>(&nwarmup)->default_value(1),
+         "Number of untimed executions before the trials")
+        ("flush-cache", "Flush the device L2 cache before each trial")
+        ("json", po::value<std::string>(&json_file),
+         "Write the plan, kernels, times and statistics to this file as JSON")
         ("notInPlace,o", "Not in-place FFT transform (default: in-place)")
         ("double", "Double precision transform (deprecated: use --precision double)")
         ("precision", po::value<fft_precision>(&params.precision), "Transform precision: single (default), double, half")
@@ -91,7 +400,10 @@ int main(int argc, char* argv[])
         ("ioffset", po::value<std::vector<size_t>>(&params.ioffset)->multitoken(), "Input offsets.")
         ("ooffset", po::value<std::vector<size_t>>(&params.ooffset)->multitoken(), "Output offsets.")
         ("scalefactor", po::value<double>(&params.scale_factor), "Scale factor to apply to output.")
-        ("token", po::value<std::string>(&token));
+        ("token", po::value<std::string>(&token))
+        ("token-file", po::value<std::string>(&token_file),
+         "Time each fft params token in this file (- for stdin), one per line, and print one "
+         "JSON result per line");
     // clang-format on
 
     po::variables_map vm;
@@ -112,6 +424,15 @@ int main(int argc, char* argv[])
         return EXIT_SUCCESS;
     }
 
+    std::unique_ptr<cache_flusher> flusher;
+    if(vm.count("flush-cache"))
+        flusher = std::make_unique<cache_flusher>();
+
+    if(!token_file.empty())
+    {
+        return run_token_file(token_file, ntrial, nwarmup, flusher.get(), verbose);
+    }
+
     if(vm.count("ntrial"))
     {
         std::cout << "Running profile with " << ntrial << " samples\n";
@@ -142,7 +463,8 @@ int main(int argc, char* argv[])
 
         params.placement
             = vm.count("notInPlace") ? fft_placement_notinplace : fft_placement_inplace;
-        params.precision = vm.count("double") ? fft_precision_double : fft_precision_single;
+        if(vm.count("double"))
+            params.precision = fft_precision_double;
 
         if(vm.count("notInPlace"))
         {
@@ -203,8 +525,6 @@ int main(int argc, char* argv[])
 
     std::cout << std::flush;
 
-    rocfft_setup();
-
     // Fixme: set the device id properly after the IDs are synced
     // bewteen hip runtime and rocm-smi.
     // HIP_V_THROW(hipSetDevice(deviceId), "set device failed!");
@@ -216,123 +536,22 @@ int main(int argc, char* argv[])
         throw std::runtime_error("Invalid parameters, add --verbose=1 for detail");
     }
 
+    std::string plan_text;
+    if(!json_file.empty())
+        plan_text = capture_plan_logs({params.token()}).front();
+
+    rocfft_setup();
+
     std::cout << "Token: " << params.token() << std::endl;
     if(verbose)
     {
         std::cout << params.str(" ") << std::endl;
     }
 
-    const auto raw_vram_footprint
-        = params.fft_params_vram_footprint() + twiddle_table_vram_footprint(params);
-    if(!vram_fits_problem(raw_vram_footprint))
-    {
-        std::cout << "SKIPPED: Problem size (" << raw_vram_footprint
-                  << ") raw data too large for device.\n";
-        return EXIT_SUCCESS;
-    }
-
-    const auto vram_footprint = params.vram_footprint();
-    if(!vram_fits_problem(vram_footprint))
-    {
-        std::cout << "SKIPPED: Problem size (" << vram_footprint
-                  << ") raw data too large for device.\n";
+    const auto gpu_time
+        = time_transform(params, ntrial, nwarmup, flusher.get(), verbose, std::cout);
+    if(gpu_time.empty())
         return EXIT_SUCCESS;
-    }
-
-    auto ret = params.create_plan();
-    if(ret != fft_status_success)
-        LIB_V_THROW(rocfft_status_failure, "Plan creation failed");
-
-    // GPU input buffer:
-    auto                ibuffer_sizes = params.ibuffer_sizes();
-    std::vector<gpubuf> ibuffer(ibuffer_sizes.size());
-    std::vector<void*>  pibuffer(ibuffer_sizes.size());
-    for(unsigned int i = 0; i < ibuffer.size(); ++i)
-    {
-        HIP_V_THROW(ibuffer[i].alloc(ibuffer_sizes[i]), "Creating input Buffer failed");
-        pibuffer[i] = ibuffer[i].data();
-    }
-
-    // Input data:
-    params.compute_input(ibuffer);
-
-    if(verbose > 1)
-    {
-        // Copy input to CPU
-        auto cpu_input = allocate_host_buffer(params.precision, params.itype, params.isize);
-        for(unsigned int idx = 0; idx < ibuffer.size(); ++idx)
-        {
-            HIP_V_THROW(hipMemcpy(cpu_input.at(idx).data(),
-                                  ibuffer[idx].data(),
-                                  ibuffer_sizes[idx],
-                                  hipMemcpyDeviceToHost),
-                        "hipMemcpy failed");
-        }
-
-        std::cout << "GPU input:\n";
-        params.print_ibuffer(cpu_input);
-    }
-
-    // GPU output buffer:
-    std::vector<gpubuf>  obuffer_data;
-    std::vector<gpubuf>* obuffer = &obuffer_data;
-    if(params.placement == fft_placement_inplace)
-    {
-        obuffer = &ibuffer;
-    }
-    else
-    {
-        auto obuffer_sizes = params.obuffer_sizes();
-        obuffer_data.resize(obuffer_sizes.size());
-        for(unsigned int i = 0; i < obuffer_data.size(); ++i)
-        {
-            HIP_V_THROW(obuffer_data[i].alloc(obuffer_sizes[i]), "Creating output Buffer failed");
-        }
-    }
-    std::vector<void*> pobuffer(obuffer->size());
-    for(unsigned int i = 0; i < obuffer->size(); ++i)
-    {
-        pobuffer[i] = obuffer->at(i).data();
-    }
-
-    params.execute(pibuffer.data(), pobuffer.data());
-
-    // Run the transform several times and record the execution time:
-    std::vector<double> gpu_time(ntrial);
-
-    hipEvent_t start, stop;
-    HIP_V_THROW(hipEventCreate(&start), "hipEventCreate failed");
-    HIP_V_THROW(hipEventCreate(&stop), "hipEventCreate failed");
-    for(unsigned int itrial = 0; itrial < gpu_time.size(); ++itrial)
-    {
-        params.compute_input(ibuffer);
-
-        HIP_V_THROW(hipEventRecord(start), "hipEventRecord failed");
-
-        params.execute(pibuffer.data(), pobuffer.data());
-
-        HIP_V_THROW(hipEventRecord(stop), "hipEventRecord failed");
-        HIP_V_THROW(hipEventSynchronize(stop), "hipEventSynchronize failed");
-
-        float time;
-        HIP_V_THROW(hipEventElapsedTime(&time, start, stop), "hipEventElapsedTime failed");
-        gpu_time[itrial] = time;
-
-        if(verbose > 2)
-        {
-            auto output = allocate_host_buffer(params.precision, params.otype, params.osize);
-            for(unsigned int idx = 0; idx < output.size(); ++idx)
-            {
-                HIP_V_THROW(hipMemcpy(output[idx].data(),
-                                      pobuffer[idx],
-                                      output[idx].size(),
-                                      hipMemcpyDeviceToHost),
-                            "hipMemcpy failed");
-            }
-            std::cout << "GPU output:\n";
-            params.print_obuffer(output);
-        }
-    }
 
     std::cout << "\nExecution gpu time:";
     for(const auto& i : gpu_time)
@@ -342,20 +561,26 @@ int main(int argc, char* argv[])
     std::cout << " ms" << std::endl;
 
     std::cout << "Execution gflops:  ";
-    const double totsize
-        = std::accumulate(params.length.begin(), params.length.end(), 1, std::multiplies<size_t>());
-    const double k
-        = ((params.itype == fft_array_type_real) || (params.otype == fft_array_type_real)) ? 2.5
-                                                                                           : 5.0;
-    const double opscount = (double)params.nbatch * k * totsize * log(totsize) / log(2.0);
+    const double opscount = transform_opscount(params);
     for(const auto& i : gpu_time)
     {
         std::cout << " " << opscount / (1e6 * i);
     }
     std::cout << std::endl;
 
-    rocfft_cleanup();
+    print_timing_stats(std::cout, compute_timing_stats(gpu_time));
 
-    HIP_V_THROW(hipEventDestroy(start), "hipEventDestroy failed");
-    HIP_V_THROW(hipEventDestroy(stop), "hipEventDestroy failed");
+    if(!json_file.empty())
+    {
+        std::ofstream json(json_file);
+        json << "{\"token\": \"" << json_escape(params.token()) << "\", \"ntrial\": " << ntrial
+             << ", \"warmup\": " << nwarmup
+             << ", \"flush_cache\": " << (flusher ? "true" : "false") << ", ";
+        write_json_results(json, params, gpu_time, plan_log_kernels(plan_text));
+        json << ", \"plan\": \"" << json_escape(plan_text) << "\"}" << std::endl;
+        if(!json)
+            throw std::runtime_error("Unable to write " + json_file);
+    }
+
+    rocfft_cleanup();
 }
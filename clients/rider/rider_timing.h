@@ -0,0 +1,383 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Timing helpers shared by rocfft-rider and dyna-rocfft-rider:
+// summary statistics of the samples, flushing the device cache
+// between trials, capturing the plan log, and JSON output.
+
+#ifndef RIDER_TIMING_H
+#define RIDER_TIMING_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <hip/hip_runtime.h>
+
+#include "../../shared/environment.h"
+#include "../../shared/gpubuf.h"
+#include "rider.h"
+
+// hipEvent_t that is destroyed when it goes out of scope.
+struct rider_event
+{
+    hipEvent_t event = nullptr;
+
+    rider_event()
+    {
+        HIP_V_THROW(hipEventCreate(&event), "hipEventCreate failed");
+    }
+    ~rider_event()
+    {
+        if(event)
+            (void)hipEventDestroy(event);
+    }
+    rider_event(const rider_event&) = delete;
+    rider_event& operator=(const rider_event&) = delete;
+};
+
+// Summary of a set of execution times, in milliseconds.
+struct timing_stats
+{
+    size_t count  = 0;
+    double min    = 0.0;
+    double max    = 0.0;
+    double mean   = 0.0;
+    double median = 0.0;
+    double p10    = 0.0;
+    double p90    = 0.0;
+    // Bootstrap confidence interval of the median
+    double median_ci_low  = 0.0;
+    double median_ci_high = 0.0;
+};
+
+// Return the p-th percentile of sorted values, interpolating
+// linearly between the closest ranks, as numpy.percentile does.
+inline double sorted_percentile(const std::vector<double>& sorted, const double p)
+{
+    if(sorted.empty())
+        return 0.0;
+    const double pos  = p / 100.0 * (sorted.size() - 1);
+    const size_t lo   = static_cast<size_t>(std::floor(pos));
+    const size_t hi   = std::min(lo + 1, sorted.size() - 1);
+    const double frac = pos - lo;
+    return sorted[lo] + frac * (sorted[hi] - sorted[lo]);
+}
+
+// Summarize the samples.  The confidence interval of the median is
+// computed by bootstrap resampling, in the same way as
+// perflib.analysis.confidence_interval, but with a fixed seed so
+// that the output is reproducible.
+inline timing_stats compute_timing_stats(const std::vector<double>& samples,
+                                         const double               alpha = 0.95,
+                                         const size_t               nboot = 2000)
+{
+    timing_stats stats;
+    if(samples.empty())
+        return stats;
+
+    auto sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    stats.count  = sorted.size();
+    stats.min    = sorted.front();
+    stats.max    = sorted.back();
+    stats.mean   = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+    stats.median = sorted_percentile(sorted, 50.0);
+    stats.p10    = sorted_percentile(sorted, 10.0);
+    stats.p90    = sorted_percentile(sorted, 90.0);
+
+    std::mt19937                          gen(sorted.size());
+    std::uniform_int_distribution<size_t> pick(0, sorted.size() - 1);
+    std::vector<double>                   medians(nboot);
+    std::vector<double>                   resample(sorted.size());
+    for(auto& median : medians)
+    {
+        for(auto& val : resample)
+            val = sorted[pick(gen)];
+        std::sort(resample.begin(), resample.end());
+        median = sorted_percentile(resample, 50.0);
+    }
+    std::sort(medians.begin(), medians.end());
+    const auto low_idx  = static_cast<size_t>(std::floor(nboot * 0.5 * (1.0 - alpha)));
+    const auto high_idx = static_cast<size_t>(std::ceil(nboot * (1.0 - 0.5 * (1.0 - alpha))));
+    stats.median_ci_low  = medians[std::min(low_idx, nboot - 1)];
+    stats.median_ci_high = medians[std::min(high_idx, nboot - 1)];
+    return stats;
+}
+
+inline void print_timing_stats(std::ostream& os, const timing_stats& stats)
+{
+    os << "Execution gpu time stats: median " << stats.median << " ms, 95% CI ["
+       << stats.median_ci_low << ", " << stats.median_ci_high << "] ms, p10 " << stats.p10
+       << " ms, p90 " << stats.p90 << " ms, min " << stats.min << " ms, max " << stats.max
+       << " ms" << std::endl;
+}
+
+static const unsigned int FLUSH_CACHE_THREADS = 256;
+
+// Read every word of a buffer, to evict whatever was in the cache.
+// sink is never written, since the buffer is zeroed, but the
+// compiler can't know that.
+__global__ static void __launch_bounds__(FLUSH_CACHE_THREADS)
+    flush_cache_kernel(const uint4* buf, const size_t n, unsigned int* sink)
+{
+    unsigned int acc = 0;
+    for(size_t i = threadIdx.x + blockIdx.x * blockDim.x; i < n;
+        i += static_cast<size_t>(blockDim.x) * gridDim.x)
+    {
+        const auto v = buf[i];
+        acc ^= v.x ^ v.y ^ v.z ^ v.w;
+    }
+    if(acc != 0)
+        *sink = acc;
+}
+
+// Evicts the device's L2 cache between trials, so that input that
+// was just generated on the device, or output of the previous trial,
+// doesn't make small transforms look faster than they are in
+// practice.
+class cache_flusher
+{
+public:
+    cache_flusher()
+    {
+        int             deviceId = 0;
+        hipDeviceProp_t prop;
+        HIP_V_THROW(hipGetDevice(&deviceId), "hipGetDevice failed");
+        HIP_V_THROW(hipGetDeviceProperties(&prop, deviceId), "hipGetDeviceProperties failed");
+
+        // read several times the size of the cache, so that
+        // replacement policy doesn't leave older lines behind
+        static const size_t MIN_FLUSH_BYTES = 32 * 1024 * 1024;
+        const size_t        bytes
+            = std::max(4 * static_cast<size_t>(prop.l2CacheSize), MIN_FLUSH_BYTES);
+        nelems = bytes / sizeof(uint4);
+        // one more element at the end is the kernel's sink
+        HIP_V_THROW(buf.alloc(bytes + sizeof(uint4)), "Creating cache flush buffer failed");
+        HIP_V_THROW(hipMemset(buf.data(), 0, bytes + sizeof(uint4)), "hipMemset failed");
+    }
+
+    // Enqueue the flush on the null stream.
+    void flush()
+    {
+        const auto   elems  = static_cast<uint4*>(buf.data());
+        const size_t blocks = std::min<size_t>(
+            (nelems + FLUSH_CACHE_THREADS - 1) / FLUSH_CACHE_THREADS, MAX_FLUSH_BLOCKS);
+        hipLaunchKernelGGL(flush_cache_kernel,
+                           dim3(blocks),
+                           dim3(FLUSH_CACHE_THREADS),
+                           0,
+                           0,
+                           elems,
+                           nelems,
+                           reinterpret_cast<unsigned int*>(elems + nelems));
+        HIP_V_THROW(hipPeekAtLastError(), "flush_cache_kernel launch failed");
+    }
+
+private:
+    static constexpr size_t MAX_FLUSH_BLOCKS = 65536;
+
+    gpubuf buf;
+    size_t nelems = 0;
+};
+
+// One kernel in a plan, as described in the plan log.
+struct plan_kernel
+{
+    std::string         scheme;
+    std::vector<size_t> length;
+};
+
+// Captures rocFFT's plan log, so that the plan and the kernels it
+// launches can be reported.  The library logs each plan when it is
+// created, and again on every execution.  So plans are created for
+// the log in a rocfft_setup/rocfft_cleanup session of their own,
+// during the lifetime of this object, and timed in a later session
+// after it is destroyed.  If the environment already requests a plan
+// log, that log is read instead of a temporary file.
+class plan_log_capture
+{
+public:
+    plan_log_capture()
+    {
+        auto layer = rocfft_getenv("ROCFFT_LAYER");
+        // rocfft_layer_mode_log_plan
+        static const long LOG_PLAN_LAYER = 8;
+        const long        layer_mode = layer.empty() ? 0 : std::strtol(layer.c_str(), nullptr, 0);
+        if(!(layer_mode & LOG_PLAN_LAYER))
+            env_layer = std::make_unique<EnvironmentSetTemp>(
+                "ROCFFT_LAYER", std::to_string(layer_mode | LOG_PLAN_LAYER).c_str());
+
+        auto log_path = rocfft_getenv("ROCFFT_LOG_PLAN_PATH");
+        if(!log_path.empty() && env_layer == nullptr)
+        {
+            path = log_path;
+        }
+        else
+        {
+            path = std::filesystem::temp_directory_path()
+                   / ("rocfft-rider-plan-" + std::to_string(std::random_device()()) + ".log");
+            env_path = std::make_unique<EnvironmentSetTemp>("ROCFFT_LOG_PLAN_PATH",
+                                                            path.string().c_str());
+            remove_path = true;
+        }
+    }
+    ~plan_log_capture()
+    {
+        if(remove_path)
+        {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+    }
+    plan_log_capture(const plan_log_capture&) = delete;
+    plan_log_capture& operator=(const plan_log_capture&) = delete;
+
+    // Return what was written to the plan log since the last call.
+    std::string read_new()
+    {
+        std::ifstream file(path, std::ios::binary);
+        if(!file)
+            return {};
+        file.seekg(0, std::ios::end);
+        const std::streamoff size = file.tellg();
+        // rocfft_setup truncates the log, e.g. when dyna-rider loads
+        // another library
+        if(size < offset)
+            offset = 0;
+        file.seekg(offset);
+        std::string ret(size - offset, '\0');
+        file.read(ret.data(), ret.size());
+        offset = size;
+        return ret;
+    }
+
+private:
+    std::filesystem::path               path;
+    bool                                remove_path = false;
+    std::streamoff                      offset      = 0;
+    std::unique_ptr<EnvironmentSetTemp> env_layer;
+    std::unique_ptr<EnvironmentSetTemp> env_path;
+};
+
+// Return the kernels in a plan log, in the order they are launched.
+// Kernels are the nodes of the plan tree with a CS_KERNEL_* scheme.
+inline std::vector<plan_kernel> plan_log_kernels(const std::string& plan_log)
+{
+    std::vector<plan_kernel> kernels;
+    std::istringstream       lines(plan_log);
+    std::string              line;
+    bool                     in_kernel = false;
+    while(std::getline(lines, line))
+    {
+        const auto first = line.find_first_not_of(' ');
+        if(first == std::string::npos)
+            continue;
+        line.erase(0, first);
+
+        if(line.compare(0, 8, "scheme: ") == 0)
+        {
+            in_kernel = line.compare(8, 10, "CS_KERNEL_") == 0;
+            if(in_kernel)
+                kernels.push_back({line.substr(8), {}});
+        }
+        else if(in_kernel && line.compare(0, 8, "length: ") == 0)
+        {
+            std::istringstream lengths(line.substr(8));
+            size_t             len;
+            while(lengths >> len)
+                kernels.back().length.push_back(len);
+            in_kernel = false;
+        }
+    }
+    return kernels;
+}
+
+// Escape a string for use as a JSON string value.
+inline std::string json_escape(const std::string& s)
+{
+    std::ostringstream out;
+    for(const char c : s)
+    {
+        switch(c)
+        {
+        case '"':
+            out << "\\\"";
+            break;
+        case '\\':
+            out << "\\\\";
+            break;
+        case '\n':
+            out << "\\n";
+            break;
+        default:
+            if(static_cast<unsigned char>(c) < 0x20)
+                out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c
+                    << std::dec;
+            else
+                out << c;
+        }
+    }
+    return out.str();
+}
+
+template <typename T>
+void write_json_array(std::ostream& os, const std::vector<T>& vals)
+{
+    os << "[";
+    for(size_t i = 0; i < vals.size(); ++i)
+        os << (i ? ", " : "") << vals[i];
+    os << "]";
+}
+
+inline void write_json(std::ostream& os, const timing_stats& stats)
+{
+    os << "{\"count\": " << stats.count << ", \"min\": " << stats.min << ", \"max\": " << stats.max
+       << ", \"mean\": " << stats.mean << ", \"median\": " << stats.median
+       << ", \"p10\": " << stats.p10 << ", \"p90\": " << stats.p90
+       << ", \"median_ci_low\": " << stats.median_ci_low
+       << ", \"median_ci_high\": " << stats.median_ci_high << "}";
+}
+
+inline void write_json(std::ostream& os, const std::vector<plan_kernel>& kernels)
+{
+    os << "[";
+    for(size_t i = 0; i < kernels.size(); ++i)
+    {
+        os << (i ? ", " : "") << "{\"scheme\": \"" << json_escape(kernels[i].scheme)
+           << "\", \"length\": ";
+        write_json_array(os, kernels[i].length);
+        os << "}";
+    }
+    os << "]";
+}
+
+#endif // RIDER_TIMING_H
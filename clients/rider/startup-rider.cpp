@@ -0,0 +1,175 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Measures how long a short-lived process takes to get from process
+// start to its first plan.  Each trial runs this program again as a
+// child process, which does rocfft_setup and creates one plan, so
+// the wall time of a trial includes loading the library.
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define popen _popen
+#define pclose _pclose
+#else
+#include <errno.h>
+#endif
+
+#include "rider_timing.h"
+#include "rocfft.h"
+#include <boost/program_options.hpp>
+namespace po = boost::program_options;
+
+// path to this executable, to run it again as a child
+static std::string self_path()
+{
+#ifdef WIN32
+    char filename[MAX_PATH];
+    GetModuleFileNameA(NULL, filename, MAX_PATH);
+    return filename;
+#else
+    return program_invocation_name;
+#endif
+}
+
+// the child's side of a trial: set up the library and create one
+// plan, and print how long each step took in milliseconds
+static int run_child(const std::vector<size_t>& length, const rocfft_precision precision)
+{
+    auto setup_begin = std::chrono::steady_clock::now();
+    if(rocfft_setup() != rocfft_status_success)
+        return 1;
+    auto plan_begin = std::chrono::steady_clock::now();
+
+    rocfft_plan plan = nullptr;
+    if(rocfft_plan_create(&plan,
+                          rocfft_placement_inplace,
+                          rocfft_transform_type_complex_forward,
+                          precision,
+                          length.size(),
+                          length.data(),
+                          1,
+                          nullptr)
+       != rocfft_status_success)
+        return 1;
+    auto plan_end = std::chrono::steady_clock::now();
+
+    rocfft_plan_destroy(plan);
+    rocfft_cleanup();
+
+    std::chrono::duration<double, std::milli> setup_ms = plan_begin - setup_begin;
+    std::chrono::duration<double, std::milli> plan_ms  = plan_end - plan_begin;
+    std::cout << setup_ms.count() << " " << plan_ms.count() << std::endl;
+    return 0;
+}
+
+static void print_stats(const char* what, const std::vector<double>& samples)
+{
+    auto stats = compute_timing_stats(samples);
+    std::cout << what << ": median " << stats.median << " ms, 95% CI [" << stats.median_ci_low
+              << ", " << stats.median_ci_high << "] ms, min " << stats.min << " ms, max "
+              << stats.max << " ms" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    int                 ntrial = 10;
+    std::vector<size_t> length;
+    std::string         precision_str;
+
+    po::options_description opdesc("rocfft startup rider command line options");
+    opdesc.add_options()("help,h", "produces this help message")
+        ("ntrial,N", po::value<int>(&ntrial)->default_value(10), "Number of processes to start")
+        ("length", po::value<std::vector<size_t>>(&length)->multitoken(), "Lengths of the plan to create (default: 256)")
+        ("precision", po::value<std::string>(&precision_str)->default_value("single"), "Transform precision: single or double")
+        ("child", "Run one trial in this process (used internally)");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, opdesc), vm);
+    po::notify(vm);
+
+    if(vm.count("help"))
+    {
+        std::cout << opdesc << std::endl;
+        return 0;
+    }
+
+    if(length.empty())
+        length.push_back(256);
+
+    rocfft_precision precision;
+    if(precision_str == "single")
+        precision = rocfft_precision_single;
+    else if(precision_str == "double")
+        precision = rocfft_precision_double;
+    else
+    {
+        std::cerr << "unsupported precision " << precision_str << std::endl;
+        return 1;
+    }
+
+    if(vm.count("child"))
+        return run_child(length, precision);
+
+    std::stringstream child_cmd;
+    child_cmd << "\"" << self_path() << "\" --child --precision " << precision_str << " --length";
+    for(auto len : length)
+        child_cmd << " " << len;
+
+    std::vector<double> process_times;
+    std::vector<double> setup_times;
+    std::vector<double> plan_times;
+    for(int i = 0; i < ntrial; ++i)
+    {
+        auto  begin = std::chrono::steady_clock::now();
+        FILE* child = popen(child_cmd.str().c_str(), "r");
+        if(!child)
+        {
+            std::cerr << "failed to start " << child_cmd.str() << std::endl;
+            return 1;
+        }
+        double setup_ms = 0.0;
+        double plan_ms  = 0.0;
+        int    nread    = fscanf(child, "%lf %lf", &setup_ms, &plan_ms);
+        if(pclose(child) != 0 || nread != 2)
+        {
+            std::cerr << "trial failed: " << child_cmd.str() << std::endl;
+            return 1;
+        }
+        std::chrono::duration<double, std::milli> process_ms
+            = std::chrono::steady_clock::now() - begin;
+
+        process_times.push_back(process_ms.count());
+        setup_times.push_back(setup_ms);
+        plan_times.push_back(plan_ms);
+    }
+
+    print_stats("Process time", process_times);
+    print_stats("rocfft_setup time", setup_times);
+    print_stats("First plan create time", plan_times);
+    return 0;
+}
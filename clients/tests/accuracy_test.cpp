@@ -78,6 +78,50 @@ __device__ auto load_callback_round_trip_inverse_dev_double
 __device__ auto load_callback_round_trip_inverse_dev_complex_double
     = load_callback_round_trip_inverse<rocfft_complex<double>>;
 
+// planar versions of the load callbacks, which get the real and
+// imaginary parts of the input separately
+template <typename Treal>
+__host__ __device__ rocfft_complex<Treal>
+    load_callback_planar(Treal* real, Treal* imag, size_t offset, void* cbdata, void* sharedMem)
+{
+    auto testdata = static_cast<const callback_test_data*>(cbdata);
+    // multiply each element by scalar
+    if(real == testdata->base)
+        return rocfft_complex<Treal>{real[offset], imag[offset]} * testdata->scalar;
+    else
+    {
+        // wrong base address passed, return something obviously wrong
+        return rocfft_complex<Treal>{real[0], imag[0]};
+    }
+}
+
+__device__ auto load_callback_planar_dev_half   = load_callback_planar<_Float16>;
+__device__ auto load_callback_planar_dev_float  = load_callback_planar<float>;
+__device__ auto load_callback_planar_dev_double = load_callback_planar<double>;
+
+template <typename Treal>
+__host__ __device__ rocfft_complex<Treal> load_callback_planar_round_trip_inverse(
+    Treal* real, Treal* imag, size_t offset, void* cbdata, void* sharedMem)
+{
+    auto testdata = static_cast<const callback_test_data*>(cbdata);
+    // subtract each element by scalar
+    rocfft_complex<Treal> element{real[offset], imag[offset]};
+    if(real == testdata->base)
+        return element - testdata->scalar;
+    else
+    {
+        // wrong base address passed, return something obviously wrong
+        return rocfft_complex<Treal>{real[0], imag[0]};
+    }
+}
+
+__device__ auto load_callback_planar_round_trip_inverse_dev_half
+    = load_callback_planar_round_trip_inverse<_Float16>;
+__device__ auto load_callback_planar_round_trip_inverse_dev_float
+    = load_callback_planar_round_trip_inverse<float>;
+__device__ auto load_callback_planar_round_trip_inverse_dev_double
+    = load_callback_planar_round_trip_inverse<double>;
+
 void* get_load_callback_host(fft_array_type itype,
                              fft_precision  precision,
                              bool           round_trip_inverse = false)
@@ -200,8 +244,65 @@ void* get_load_callback_host(fft_array_type itype,
             return load_callback_host;
         }
     }
+    case fft_array_type_complex_planar:
+    case fft_array_type_hermitian_planar:
+    {
+        switch(precision)
+        {
+        case fft_precision_half:
+            if(round_trip_inverse)
+            {
+                EXPECT_EQ(hipMemcpyFromSymbol(
+                              &load_callback_host,
+                              HIP_SYMBOL(load_callback_planar_round_trip_inverse_dev_half),
+                              sizeof(void*)),
+                          hipSuccess);
+            }
+            else
+            {
+                EXPECT_EQ(hipMemcpyFromSymbol(&load_callback_host,
+                                              HIP_SYMBOL(load_callback_planar_dev_half),
+                                              sizeof(void*)),
+                          hipSuccess);
+            }
+            return load_callback_host;
+        case fft_precision_single:
+            if(round_trip_inverse)
+            {
+                EXPECT_EQ(hipMemcpyFromSymbol(
+                              &load_callback_host,
+                              HIP_SYMBOL(load_callback_planar_round_trip_inverse_dev_float),
+                              sizeof(void*)),
+                          hipSuccess);
+            }
+            else
+            {
+                EXPECT_EQ(hipMemcpyFromSymbol(&load_callback_host,
+                                              HIP_SYMBOL(load_callback_planar_dev_float),
+                                              sizeof(void*)),
+                          hipSuccess);
+            }
+            return load_callback_host;
+        case fft_precision_double:
+            if(round_trip_inverse)
+            {
+                EXPECT_EQ(hipMemcpyFromSymbol(
+                              &load_callback_host,
+                              HIP_SYMBOL(load_callback_planar_round_trip_inverse_dev_double),
+                              sizeof(void*)),
+                          hipSuccess);
+            }
+            else
+            {
+                EXPECT_EQ(hipMemcpyFromSymbol(&load_callback_host,
+                                              HIP_SYMBOL(load_callback_planar_dev_double),
+                                              sizeof(void*)),
+                          hipSuccess);
+            }
+            return load_callback_host;
+        }
+    }
     default:
-        // planar is unsupported for now
         return load_callback_host;
     }
 }
@@ -250,6 +351,56 @@ __device__ auto store_callback_round_trip_inverse_dev_double
 __device__ auto store_callback_round_trip_inverse_dev_complex_double
     = store_callback_round_trip_inverse<rocfft_complex<double>>;
 
+// planar versions of the store callbacks, which get the real and
+// imaginary parts of the output separately
+template <typename Treal>
+__host__ __device__ static void store_callback_planar(Treal*                real,
+                                                      Treal*                imag,
+                                                      size_t                offset,
+                                                      rocfft_complex<Treal> element,
+                                                      void*                 cbdata,
+                                                      void*                 sharedMem)
+{
+    auto testdata = static_cast<callback_test_data*>(cbdata);
+    // add scalar to each element
+    if(real == testdata->base)
+    {
+        auto result  = element + testdata->scalar;
+        real[offset] = result.x;
+        imag[offset] = result.y;
+    }
+    // otherwise, wrong base address passed, just don't write
+}
+__device__ auto store_callback_planar_dev_half   = store_callback_planar<_Float16>;
+__device__ auto store_callback_planar_dev_float  = store_callback_planar<float>;
+__device__ auto store_callback_planar_dev_double = store_callback_planar<double>;
+
+template <typename Treal>
+__host__ __device__ static void
+    store_callback_planar_round_trip_inverse(Treal*                real,
+                                             Treal*                imag,
+                                             size_t                offset,
+                                             rocfft_complex<Treal> element,
+                                             void*                 cbdata,
+                                             void*                 sharedMem)
+{
+    auto testdata = static_cast<callback_test_data*>(cbdata);
+    // divide each element by scalar
+    if(real == testdata->base)
+    {
+        auto result  = element / testdata->scalar;
+        real[offset] = result.x;
+        imag[offset] = result.y;
+    }
+    // otherwise, wrong base address passed, just don't write
+}
+__device__ auto store_callback_planar_round_trip_inverse_dev_half
+    = store_callback_planar_round_trip_inverse<_Float16>;
+__device__ auto store_callback_planar_round_trip_inverse_dev_float
+    = store_callback_planar_round_trip_inverse<float>;
+__device__ auto store_callback_planar_round_trip_inverse_dev_double
+    = store_callback_planar_round_trip_inverse<double>;
+
 void* get_store_callback_host(fft_array_type otype,
                               fft_precision  precision,
                               bool           round_trip_inverse = false)
@@ -372,8 +523,65 @@ void* get_store_callback_host(fft_array_type otype,
             return store_callback_host;
         }
     }
+    case fft_array_type_complex_planar:
+    case fft_array_type_hermitian_planar:
+    {
+        switch(precision)
+        {
+        case fft_precision_half:
+            if(round_trip_inverse)
+            {
+                EXPECT_EQ(hipMemcpyFromSymbol(
+                              &store_callback_host,
+                              HIP_SYMBOL(store_callback_planar_round_trip_inverse_dev_half),
+                              sizeof(void*)),
+                          hipSuccess);
+            }
+            else
+            {
+                EXPECT_EQ(hipMemcpyFromSymbol(&store_callback_host,
+                                              HIP_SYMBOL(store_callback_planar_dev_half),
+                                              sizeof(void*)),
+                          hipSuccess);
+            }
+            return store_callback_host;
+        case fft_precision_single:
+            if(round_trip_inverse)
+            {
+                EXPECT_EQ(hipMemcpyFromSymbol(
+                              &store_callback_host,
+                              HIP_SYMBOL(store_callback_planar_round_trip_inverse_dev_float),
+                              sizeof(void*)),
+                          hipSuccess);
+            }
+            else
+            {
+                EXPECT_EQ(hipMemcpyFromSymbol(&store_callback_host,
+                                              HIP_SYMBOL(store_callback_planar_dev_float),
+                                              sizeof(void*)),
+                          hipSuccess);
+            }
+            return store_callback_host;
+        case fft_precision_double:
+            if(round_trip_inverse)
+            {
+                EXPECT_EQ(hipMemcpyFromSymbol(
+                              &store_callback_host,
+                              HIP_SYMBOL(store_callback_planar_round_trip_inverse_dev_double),
+                              sizeof(void*)),
+                          hipSuccess);
+            }
+            else
+            {
+                EXPECT_EQ(hipMemcpyFromSymbol(&store_callback_host,
+                                              HIP_SYMBOL(store_callback_planar_dev_double),
+                                              sizeof(void*)),
+                          hipSuccess);
+            }
+            return store_callback_host;
+        }
+    }
     default:
-        // planar is unsupported for now
         return store_callback_host;
     }
 }
@@ -390,8 +598,12 @@ void apply_store_callback(const fft_params& params, fftw_data_t& output)
 
     switch(params.otype)
     {
+    // FFTW data is always interleaved, even if the transform we're
+    // testing uses planar format
     case fft_array_type_complex_interleaved:
     case fft_array_type_hermitian_interleaved:
+    case fft_array_type_complex_planar:
+    case fft_array_type_hermitian_planar:
     {
         switch(params.precision)
         {
@@ -446,66 +658,6 @@ void apply_store_callback(const fft_params& params, fftw_data_t& output)
         }
     }
     break;
-    case fft_array_type_complex_planar:
-    case fft_array_type_hermitian_planar:
-    {
-        // planar wouldn't run callbacks, but we could still want scaling
-        switch(params.precision)
-        {
-        case fft_precision_half:
-        {
-            const size_t elem_size = sizeof(rocfft_complex<_Float16>);
-            for(auto& buf : output)
-            {
-                const size_t num_elems = buf.size() / elem_size;
-
-                auto output_begin = reinterpret_cast<rocfft_complex<_Float16>*>(buf.data());
-                for(size_t i = 0; i < num_elems; ++i)
-                {
-                    auto& element = output_begin[i];
-                    if(params.scale_factor != 1.0)
-                        element = element * params.scale_factor;
-                }
-            }
-            break;
-        }
-        case fft_precision_single:
-        {
-            const size_t elem_size = sizeof(rocfft_complex<float>);
-            for(auto& buf : output)
-            {
-                const size_t num_elems = buf.size() / elem_size;
-
-                auto output_begin = reinterpret_cast<rocfft_complex<float>*>(buf.data());
-                for(size_t i = 0; i < num_elems; ++i)
-                {
-                    auto& element = output_begin[i];
-                    if(params.scale_factor != 1.0)
-                        element = element * params.scale_factor;
-                }
-            }
-            break;
-        }
-        case fft_precision_double:
-        {
-            const size_t elem_size = sizeof(rocfft_complex<double>);
-            for(auto& buf : output)
-            {
-                const size_t num_elems = buf.size() / elem_size;
-
-                auto output_begin = reinterpret_cast<rocfft_complex<double>*>(buf.data());
-                for(size_t i = 0; i < num_elems; ++i)
-                {
-                    auto& element = output_begin[i];
-                    if(params.scale_factor != 1.0)
-                        element = element * params.scale_factor;
-                }
-            }
-            break;
-        }
-        }
-    }
-    break;
     case fft_array_type_real:
     {
         switch(params.precision)
@@ -581,8 +733,12 @@ void apply_load_callback(const fft_params& params, fftw_data_t& input)
 
     switch(params.itype)
     {
+    // FFTW data is always interleaved, even if the transform we're
+    // testing uses planar format
     case fft_array_type_complex_interleaved:
     case fft_array_type_hermitian_interleaved:
+    case fft_array_type_complex_planar:
+    case fft_array_type_hermitian_planar:
     {
         switch(params.precision)
         {
@@ -32,6 +32,7 @@
 
 #include "../../shared/fft_params.h"
 #include "../../shared/gpubuf.h"
+#include "cpu_fft_cache.h"
 #include "fftw_transform.h"
 #include "rocfft_against_fftw.h"
 #include "test_params.h"
@@ -44,23 +45,6 @@ static const size_t ONE_GiB = 1 << 30;
 typedef std::tuple<fft_transform_type, fft_result_placement, fft_array_type, fft_array_type>
     type_place_io_t;
 
-// Remember the results of the last FFT we computed with FFTW.  Tests
-// are ordered so that later cases can often reuse this result.
-struct last_cpu_fft_cache
-{
-    // keys to the cache
-    std::vector<size_t> length;
-    size_t              nbatch         = 0;
-    fft_transform_type  transform_type = fft_transform_type_complex_forward;
-    bool                run_callbacks  = false;
-    fft_precision       precision      = fft_precision_single;
-
-    // FFTW input/output
-    fftw_data_t cpu_input;
-    fftw_data_t cpu_output;
-};
-extern last_cpu_fft_cache last_cpu_fft_data;
-
 struct system_memory
 {
     size_t total_bytes = 0;
@@ -104,6 +88,9 @@ inline size_t needed_ram_buffers(const fft_params& params, const int verbose)
 
     needed_ram *= params.nbatch;
     needed_ram += start_memory.free_bytes - get_system_memory().free_bytes;
+    // cached CPU FFT results can be evicted to make room, so they
+    // don't count
+    needed_ram -= std::min(needed_ram, cpu_fft_data.bytes());
 
     if(verbose)
     {
@@ -460,21 +447,7 @@ inline auto param_generator_base(const std::vector<fft_transform_type>&   type_r
                                             param.ooffset        = ooffset;
 
                                             if(run_callbacks)
-                                            {
-                                                // add a test if both input and output support callbacks
-                                                if(param.itype != fft_array_type_complex_planar
-                                                   && param.itype != fft_array_type_hermitian_planar
-                                                   && param.otype != fft_array_type_complex_planar
-                                                   && param.otype
-                                                          != fft_array_type_hermitian_planar)
-                                                {
-                                                    param.run_callbacks = true;
-                                                }
-                                                else
-                                                {
-                                                    continue;
-                                                }
-                                            }
+                                                param.run_callbacks = true;
                                             param.validate();
                                             if(param.valid(0))
                                             {
@@ -1050,6 +1023,8 @@ inline void fft_vs_reference_impl(Tparams& params, bool round_trip)
         GTEST_SKIP();
         return;
     }
+    if(ramgb > 0)
+        cpu_fft_data.trim(ramgb * ONE_GiB - needed_ram);
 
     auto ibuffer_sizes = params.ibuffer_sizes();
     auto obuffer_sizes = params.obuffer_sizes();
@@ -1155,59 +1130,34 @@ inline void fft_vs_reference_impl(Tparams& params, bool round_trip)
     for(auto& buf : ibuffer_sizes_elems)
         buf /= var_size<size_t>(params.precision, params.itype);
 
-    // Check cache first - nbatch is a >= comparison because we compute
-    // the largest batch size and cache it.  Smaller batch runs can
-    // compare against the larger data.
-    fftw_data_t              cpu_input;
-    fftw_data_t              cpu_output;
+    // Check cache first - a cached result with a larger batch is
+    // also usable, since smaller batch runs can compare against the
+    // leading batches of the larger data.
+    cpu_fft_cache_entry      cached;
+    fftw_data_t&             cpu_input  = cached.cpu_input;
+    fftw_data_t&             cpu_output = cached.cpu_output;
     std::shared_future<void> convert_cpu_output_precision;
     std::shared_future<void> convert_cpu_input_precision;
     bool                     run_fftw = true;
-    if(last_cpu_fft_data.length == params.length
-       && last_cpu_fft_data.transform_type == params.transform_type
-       && last_cpu_fft_data.run_callbacks == params.run_callbacks)
+    if(cpu_fft_data.take(cpu_fft_cache_key(params), cached))
     {
-        if(last_cpu_fft_data.nbatch >= params.nbatch)
-        {
-            // use the cached input/output
-            cpu_input.swap(last_cpu_fft_data.cpu_input);
-            cpu_output.swap(last_cpu_fft_data.cpu_output);
-            run_fftw = false;
+        run_fftw = false;
 
-            if(params.precision != last_cpu_fft_data.precision)
-            {
-                // Tests should be ordered so we do double first, then float.
-                if(last_cpu_fft_data.precision == fft_precision_double)
-                {
-                    // convert the input/output to single-precision
-                    convert_cpu_output_precision = std::async(std::launch::async, [&]() {
-                        narrow_precision_inplace<double, float>(cpu_output.front());
-                    });
-                    convert_cpu_input_precision  = std::async(std::launch::async, [&]() {
-                        narrow_precision_inplace<double, float>(cpu_input.front());
-                    });
-                    last_cpu_fft_data.precision  = fft_precision_single;
-                }
-                else
-                {
-                    // Somehow we've done float first, then double?
-                    // Tests are ordered wrong, and we don't want to
-                    // lose precision
-                    std::cerr << "Can't do float first then double: aborting." << std::endl;
-                    abort();
-                }
-            }
+        if(params.precision != cached.key.precision)
+        {
+            // we got a double-precision result for a single-precision
+            // test, so convert the input/output to single-precision
+            convert_cpu_output_precision = std::async(std::launch::async, [&]() {
+                narrow_precision_inplace<double, float>(cpu_output.front());
+            });
+            convert_cpu_input_precision  = std::async(std::launch::async, [&]() {
+                narrow_precision_inplace<double, float>(cpu_input.front());
+            });
+            cached.key.precision         = fft_precision_single;
         }
-        // If the last result has a smaller batch than the new
-        // params, that might be a developer error - tests should be
-        // ordered to generate the bigger batch first.  But if tests
-        // got filtered or skipped due to insufficient memory, we
-        // might never have tried to generate the bigger batch first.
-        // So just fall through and redo the CPU FFT.
     }
-    // Clear cache explicitly so that even if we didn't get a hit,
-    // we're not uselessly holding on to cached cpu input/output
-    last_cpu_fft_data = last_cpu_fft_cache();
+    else
+        cached.key = cpu_fft_cache_key(params);
 
     // Allocate CPU input
     if(run_fftw)
@@ -1252,6 +1202,8 @@ inline void fft_vs_reference_impl(Tparams& params, bool round_trip)
             GTEST_SKIP();
             return;
         }
+        if(ramgb > 0)
+            cpu_fft_data.trim(ramgb * ONE_GiB - needed_ram);
     }
 
     fftw_data_t gpu_input_data = allocate_host_buffer<fftwAllocator<char>>(
@@ -1260,49 +1212,14 @@ inline void fft_vs_reference_impl(Tparams& params, bool round_trip)
     // allocate and populate the input buffer (cpu/gpu)
     if(run_fftw)
     {
-        //generate the input directly on the gpu
+        // generate the input directly on the gpu, and the same input
+        // for FFTW on the cpu at the same time - the generated values
+        // only depend on each element's logical index, so there's no
+        // need to copy the input back from the gpu
+        std::future<void> cpu_input_gen = std::async(
+            std::launch::async, [&]() { contiguous_params.compute_input(cpu_input); });
         params.compute_input(ibuffer);
-
-        // Copy the input to CPU
-        if(params.itype != contiguous_params.itype || params.istride != contiguous_params.istride
-           || params.idist != contiguous_params.idist || params.isize != contiguous_params.isize)
-        {
-            // Copy input to CPU
-            for(unsigned int idx = 0; idx < ibuffer.size(); ++idx)
-            {
-                auto hip_status = hipMemcpy(gpu_input_data.at(idx).data(),
-                                            ibuffer[idx].data(),
-                                            ibuffer_sizes[idx],
-                                            hipMemcpyDeviceToHost);
-                ASSERT_EQ(hip_status, hipSuccess) << "hipMemcpy failure with error " << hip_status;
-            }
-
-            copy_buffers(gpu_input_data,
-                         cpu_input,
-                         params.ilength(),
-                         params.nbatch,
-                         params.precision,
-                         params.itype,
-                         params.istride,
-                         params.idist,
-                         contiguous_params.itype,
-                         contiguous_params.istride,
-                         contiguous_params.idist,
-                         params.ioffset,
-                         contiguous_params.ioffset);
-        }
-        else
-        {
-            // Copy input to CPU
-            for(unsigned int idx = 0; idx < ibuffer.size(); ++idx)
-            {
-                auto hip_status = hipMemcpy(cpu_input.at(idx).data(),
-                                            ibuffer[idx].data(),
-                                            ibuffer_sizes[idx],
-                                            hipMemcpyDeviceToHost);
-                ASSERT_EQ(hip_status, hipSuccess) << "hipMemcpy failure with error " << hip_status;
-            }
-        }
+        cpu_input_gen.get();
     }
     else
     {
@@ -1525,19 +1442,12 @@ inline void fft_vs_reference_impl(Tparams& params, bool round_trip)
                         params.ooffset);
     });
 
-    // store cpu output in cache
-    last_cpu_fft_data.length         = params.length;
-    last_cpu_fft_data.nbatch         = params.nbatch;
-    last_cpu_fft_data.transform_type = params.transform_type;
-    last_cpu_fft_data.run_callbacks  = params.run_callbacks;
-    last_cpu_fft_data.precision      = params.precision;
-
     compare_output.get();
 
+    // store cpu output in cache
     BOOST_SCOPE_EXIT_ALL(&)
     {
-        last_cpu_fft_data.cpu_output.swap(cpu_output);
-        last_cpu_fft_data.cpu_input.swap(cpu_input);
+        cpu_fft_data.put(std::move(cached));
     };
 
     Tparams params_inverse;
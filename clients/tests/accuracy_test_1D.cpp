@@ -276,6 +276,23 @@ INSTANTIATE_TEST_SUITE_P(DISABLED_offset_mix_1D,
                                                              true)),
                          accuracy_test::TestName);
 
+// lengths that aren't in the generated kernel tables, but factor
+// into supported radices, so they get kernels configured at runtime
+const static std::vector<size_t> configured_range = {130, 154, 198, 338, 507, 686, 1300, 1575};
+
+INSTANTIATE_TEST_SUITE_P(configured_1D,
+                         accuracy_test,
+                         ::testing::ValuesIn(param_generator(generate_lengths({configured_range}),
+                                                             precision_range,
+                                                             batch_range_1D,
+                                                             stride_range,
+                                                             stride_range,
+                                                             ioffset_range_zero,
+                                                             ooffset_range_zero,
+                                                             place_range,
+                                                             true)),
+                         accuracy_test::TestName);
+
 // small 1D sizes just need to make sure our factorization isn't
 // completely broken, so we just check simple C2C outplace interleaved
 INSTANTIATE_TEST_SUITE_P(small_1D,
@@ -222,3 +222,21 @@ INSTANTIATE_TEST_SUITE_P(
         place_range,
         true)),
     accuracy_test::TestName);
+
+// small bricks with enough batches to be done by one 3D_SINGLE
+// kernel, including shapes whose dimensions factor differently
+static std::vector<std::vector<size_t>> single_3D_adhoc
+    = {{8, 8, 8}, {12, 20, 18}, {32, 32, 16}, {6, 10, 14}, {9, 9, 27}, {16, 8, 4}};
+static std::vector<size_t> single_3D_batch_range = {256};
+INSTANTIATE_TEST_SUITE_P(single_3D,
+                         accuracy_test,
+                         ::testing::ValuesIn(param_generator(single_3D_adhoc,
+                                                             precision_range,
+                                                             single_3D_batch_range,
+                                                             stride_range,
+                                                             stride_range,
+                                                             ioffset_range_zero,
+                                                             ooffset_range_zero,
+                                                             place_range,
+                                                             true)),
+                         accuracy_test::TestName);
@@ -52,6 +52,10 @@ std::vector<std::vector<size_t>> adhoc_sizes = {
 
     // TILE_UNALIGNED type of SBRC 3D ERC
     {98, 98, 98},
+
+    // skinny transposes that use non-square tiles
+    {8192, 6},
+    {6, 8192},
 };
 
 const static std::vector<std::vector<size_t>> stride_range = {{1}};
@@ -0,0 +1,388 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "cpu_fft_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#if __has_include(<filesystem>)
+#include <filesystem>
+#else
+#include <experimental/filesystem>
+namespace std
+{
+    namespace filesystem = experimental::filesystem;
+}
+#endif
+
+#ifdef ROCFFT_TEST_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// Identifies files written by this code.  Bump the version when the
+// layout of the file changes.
+static const char     CACHE_FILE_MAGIC[8]  = {'R', 'F', 'C', 'P', 'U', 'F', 'F', 'T'};
+static const uint32_t CACHE_FILE_VERSION   = 1;
+static const uint32_t BUFFER_FLAG_COMPRESS = 1;
+
+cpu_fft_cache_key::cpu_fft_cache_key(const fft_params& params)
+    : length(params.length)
+    , nbatch(params.nbatch)
+    , transform_type(params.transform_type)
+    , run_callbacks(params.run_callbacks)
+    , precision(params.precision)
+{
+}
+
+bool cpu_fft_cache_key::covers(const cpu_fft_cache_key& other) const
+{
+    return length == other.length && nbatch >= other.nbatch
+           && transform_type == other.transform_type && run_callbacks == other.run_callbacks
+           && precision == other.precision && input_generator == other.input_generator;
+}
+
+std::string cpu_fft_cache_key::str() const
+{
+    std::stringstream ss;
+    ss << "len";
+    for(auto len : length)
+        ss << "_" << len;
+    ss << "_type_" << transform_type << "_prec_" << precision << "_cb_" << run_callbacks
+       << "_gen_" << input_generator;
+    return ss.str();
+}
+
+size_t cpu_fft_cache_entry::bytes() const
+{
+    size_t total = 0;
+    for(const auto& buf : cpu_input)
+        total += buf.size();
+    for(const auto& buf : cpu_output)
+        total += buf.size();
+    return total;
+}
+
+bool cpu_fft_cache::take(const cpu_fft_cache_key& key, cpu_fft_cache_entry& entry)
+{
+    for(auto e = entries.begin(); e != entries.end(); ++e)
+    {
+        if(e->key.covers(key))
+        {
+            used_bytes -= e->bytes();
+            entry = std::move(*e);
+            entries.erase(e);
+            return true;
+        }
+    }
+    if(load(key, entry))
+        return true;
+
+    // single-precision tests can use a narrowed copy of a
+    // double-precision result
+    if(key.precision != fft_precision_single)
+        return false;
+    auto wide_key      = key;
+    wide_key.precision = fft_precision_double;
+    for(auto e = entries.begin(); e != entries.end(); ++e)
+    {
+        if(e->key.covers(wide_key))
+        {
+            entry.key        = e->key;
+            entry.cpu_input  = e->cpu_input;
+            entry.cpu_output = e->cpu_output;
+            entry.on_disk    = false;
+            entries.splice(entries.begin(), entries, e);
+            return true;
+        }
+    }
+    if(load(wide_key, entry))
+    {
+        // the narrowed result isn't on disk yet
+        entry.on_disk = false;
+        return true;
+    }
+    return false;
+}
+
+void cpu_fft_cache::put(cpu_fft_cache_entry&& entry)
+{
+    if(!entry.on_disk && !disk_path.empty())
+    {
+        // failing to store a result shouldn't fail the test that
+        // computed it
+        try
+        {
+            store(entry);
+            entry.on_disk = true;
+        }
+        catch(std::exception& e)
+        {
+            std::cerr << "failed to store CPU FFT result: " << e.what() << std::endl;
+        }
+    }
+
+    const size_t entry_bytes = entry.bytes();
+    if(entry_bytes > max_bytes)
+        return;
+
+    // results this one covers are now redundant
+    for(auto e = entries.begin(); e != entries.end();)
+    {
+        if(entry.key.covers(e->key))
+        {
+            used_bytes -= e->bytes();
+            e = entries.erase(e);
+        }
+        else
+            ++e;
+    }
+
+    trim(max_bytes - entry_bytes);
+    used_bytes += entry_bytes;
+    entries.push_front(std::move(entry));
+}
+
+void cpu_fft_cache::trim(size_t limit)
+{
+    while(used_bytes > limit && !entries.empty())
+    {
+        used_bytes -= entries.back().bytes();
+        entries.pop_back();
+    }
+}
+
+std::string cpu_fft_cache::entry_filename(const cpu_fft_cache_key& key) const
+{
+    return (fs::path(disk_path) / (key.str() + ".dat")).string();
+}
+
+template <typename T>
+static void write_value(std::ostream& os, const T& val)
+{
+    os.write(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+
+template <typename T>
+static T read_value(std::istream& is)
+{
+    T val;
+    if(!is.read(reinterpret_cast<char*>(&val), sizeof(T)))
+        throw std::runtime_error("truncated file");
+    return val;
+}
+
+// Write a buffer, transposing it to byte planes and deflating it if
+// zlib is available.  Grouping the sign/exponent bytes of all
+// elements together is what lets random floating-point data
+// compress at all.
+static void write_buffer(std::ostream&                                 os,
+                         const std::vector<char, fftwAllocator<char>>& buf,
+                         [[maybe_unused]] size_t                       elem_bytes)
+{
+    write_value<uint64_t>(os, buf.size());
+#ifdef ROCFFT_TEST_ZLIB
+    if(buf.size() % elem_bytes != 0)
+        elem_bytes = 1;
+    const size_t      elems = buf.size() / elem_bytes;
+    std::vector<char> planes(buf.size());
+    for(size_t i = 0; i < elems; ++i)
+        for(size_t b = 0; b < elem_bytes; ++b)
+            planes[b * elems + i] = buf[i * elem_bytes + b];
+
+    uLongf             compressed_size = compressBound(planes.size());
+    std::vector<Bytef> compressed(compressed_size);
+    if(compress2(compressed.data(),
+                 &compressed_size,
+                 reinterpret_cast<const Bytef*>(planes.data()),
+                 planes.size(),
+                 Z_BEST_SPEED)
+       != Z_OK)
+        throw std::runtime_error("compression failed");
+
+    write_value<uint32_t>(os, BUFFER_FLAG_COMPRESS);
+    write_value<uint64_t>(os, compressed_size);
+    write_value<uint64_t>(os, elem_bytes);
+    os.write(reinterpret_cast<const char*>(compressed.data()), compressed_size);
+#else
+    write_value<uint32_t>(os, 0);
+    write_value<uint64_t>(os, buf.size());
+    os.write(buf.data(), buf.size());
+#endif
+}
+
+static std::vector<char, fftwAllocator<char>> read_buffer(std::istream& is)
+{
+    const auto raw_size    = read_value<uint64_t>(is);
+    const auto flags       = read_value<uint32_t>(is);
+    const auto stored_size = read_value<uint64_t>(is);
+
+    std::vector<char, fftwAllocator<char>> buf(raw_size);
+    if(!(flags & BUFFER_FLAG_COMPRESS))
+    {
+        if(stored_size != raw_size || !is.read(buf.data(), raw_size))
+            throw std::runtime_error("truncated buffer");
+        return buf;
+    }
+
+#ifdef ROCFFT_TEST_ZLIB
+    const auto elem_bytes = read_value<uint64_t>(is);
+    if(elem_bytes == 0 || raw_size % elem_bytes != 0)
+        throw std::runtime_error("invalid element size");
+    std::vector<Bytef> compressed(stored_size);
+    if(!is.read(reinterpret_cast<char*>(compressed.data()), stored_size))
+        throw std::runtime_error("truncated buffer");
+    std::vector<char> planes(raw_size);
+    uLongf            planes_size = planes.size();
+    if(uncompress(reinterpret_cast<Bytef*>(planes.data()),
+                  &planes_size,
+                  compressed.data(),
+                  compressed.size())
+           != Z_OK
+       || planes_size != raw_size)
+        throw std::runtime_error("decompression failed");
+
+    const size_t elems = raw_size / elem_bytes;
+    for(size_t i = 0; i < elems; ++i)
+        for(size_t b = 0; b < elem_bytes; ++b)
+            buf[i * elem_bytes + b] = planes[b * elems + i];
+    return buf;
+#else
+    throw std::runtime_error("compressed buffer, but zlib support is not built in");
+#endif
+}
+
+// Read the header of a stored result, returning the batch size it
+// holds, or 0 if the file does not hold a result for 'key'.
+static size_t read_header(std::istream& is, const cpu_fft_cache_key& key)
+{
+    char magic[sizeof(CACHE_FILE_MAGIC)];
+    if(!is.read(magic, sizeof(magic))
+       || !std::equal(magic, magic + sizeof(magic), CACHE_FILE_MAGIC)
+       || read_value<uint32_t>(is) != CACHE_FILE_VERSION)
+        return 0;
+
+    std::string key_str(read_value<uint64_t>(is), '\0');
+    if(!is.read(key_str.data(), key_str.size()) || key_str != key.str())
+        return 0;
+    return read_value<uint64_t>(is);
+}
+
+static void read_buffers(std::istream& is, fftw_data_t& bufs)
+{
+    bufs.resize(read_value<uint32_t>(is));
+    for(auto& buf : bufs)
+        buf = read_buffer(is);
+}
+
+bool cpu_fft_cache::load(const cpu_fft_cache_key& key, cpu_fft_cache_entry& entry) const
+{
+    if(disk_path.empty())
+        return false;
+
+    std::ifstream is(entry_filename(key), std::ios::binary);
+    if(!is)
+        return false;
+
+    try
+    {
+        const size_t nbatch = read_header(is, key);
+        if(nbatch == 0 || nbatch < key.nbatch)
+            return false;
+
+        cpu_fft_cache_entry loaded;
+        loaded.key        = key;
+        loaded.key.nbatch = nbatch;
+        loaded.on_disk    = true;
+        read_buffers(is, loaded.cpu_input);
+        read_buffers(is, loaded.cpu_output);
+        entry = std::move(loaded);
+        return true;
+    }
+    catch(std::exception& e)
+    {
+        // corrupt or truncated, so just recompute the result
+        std::cerr << "ignoring stored CPU FFT result " << entry_filename(key) << ": " << e.what()
+                  << std::endl;
+        return false;
+    }
+}
+
+void cpu_fft_cache::store(const cpu_fft_cache_entry& entry) const
+{
+    const auto filename = entry_filename(entry.key);
+
+    // don't replace a stored result that covers this one
+    {
+        std::ifstream is(filename, std::ios::binary);
+        try
+        {
+            if(is && read_header(is, entry.key) >= entry.key.nbatch)
+                return;
+        }
+        catch(std::exception&)
+        {
+        }
+    }
+
+    fs::create_directories(disk_path);
+
+    // write to a temporary file and rename it into place, so that
+    // concurrent test processes never read a partial result
+    const auto    tmp_filename = filename + "." + std::to_string(getpid()) + ".tmp";
+    std::ofstream os(tmp_filename, std::ios::binary);
+    if(!os)
+        throw std::runtime_error("unable to open " + tmp_filename);
+
+    const auto key_str = entry.key.str();
+    os.write(CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC));
+    write_value<uint32_t>(os, CACHE_FILE_VERSION);
+    write_value<uint64_t>(os, key_str.size());
+    os.write(key_str.data(), key_str.size());
+    write_value<uint64_t>(os, entry.key.nbatch);
+
+    const size_t elem_bytes = entry.key.precision == fft_precision_double ? 8 : 4;
+    for(const auto bufs : {&entry.cpu_input, &entry.cpu_output})
+    {
+        write_value<uint32_t>(os, bufs->size());
+        for(const auto& buf : *bufs)
+            write_buffer(os, buf, elem_bytes);
+    }
+    os.close();
+    if(!os)
+    {
+        fs::remove(tmp_filename);
+        throw std::runtime_error("unable to write " + tmp_filename);
+    }
+    fs::rename(tmp_filename, filename);
+}
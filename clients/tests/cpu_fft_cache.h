@@ -0,0 +1,121 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+#ifndef CPU_FFT_CACHE_H
+#define CPU_FFT_CACHE_H
+
+#include "fftw_transform.h"
+#include <list>
+#include <string>
+#include <vector>
+
+// Identifies a CPU reference result.  A result can be reused by any
+// test with the same key and an equal or smaller batch, since the
+// batches are laid out contiguously.
+struct cpu_fft_cache_key
+{
+    std::vector<size_t> length;
+    size_t              nbatch          = 0;
+    fft_transform_type  transform_type  = fft_transform_type_complex_forward;
+    bool                run_callbacks   = false;
+    fft_precision       precision       = fft_precision_single;
+    unsigned int        input_generator = DATA_GEN_VERSION;
+
+    cpu_fft_cache_key() = default;
+    explicit cpu_fft_cache_key(const fft_params& params);
+
+    // true if a result for this key can be used for a test that
+    // wants 'other'
+    bool covers(const cpu_fft_cache_key& other) const;
+
+    // string form of everything but the batch, used to name results
+    // stored on disk
+    std::string str() const;
+};
+
+struct cpu_fft_cache_entry
+{
+    cpu_fft_cache_key key;
+
+    // FFTW input/output
+    fftw_data_t cpu_input;
+    fftw_data_t cpu_output;
+
+    // true if this result is already stored on disk
+    bool on_disk = false;
+
+    size_t bytes() const;
+};
+
+// Remembers the results of recent FFTs we computed with FFTW, so
+// that tests which need the same reference result don't need to
+// recompute it.
+//
+// Results are kept in memory up to a byte limit, evicting the least
+// recently used results first.  If a directory is given, results
+// are also stored there (compressed if zlib is available) so that
+// later runs of the suite can skip the CPU transforms entirely.
+class cpu_fft_cache
+{
+public:
+    // upper limit on bytes held in memory, 0 disables in-memory caching
+    size_t max_bytes = 0;
+    // directory for stored results, empty disables the disk store
+    std::string disk_path;
+
+    // Look for a result usable for 'key'.  On success, the result is
+    // moved out of the cache into 'entry' and true is returned.
+    // Callers should put() the entry back once they're done with
+    // it.
+    //
+    // A double-precision result is also usable for a
+    // single-precision key.  In that case a copy is returned, with
+    // its key still saying double precision; the caller is expected
+    // to narrow the data and update the key.
+    bool take(const cpu_fft_cache_key& key, cpu_fft_cache_entry& entry);
+
+    // Give a result to the cache, storing it to disk if it's not
+    // there already.  This may evict older results, or the new
+    // result itself if it exceeds the memory limit.
+    void put(cpu_fft_cache_entry&& entry);
+
+    // Evict results until at most 'limit' bytes are held in memory.
+    void trim(size_t limit);
+
+    // bytes currently held in memory
+    size_t bytes() const
+    {
+        return used_bytes;
+    }
+
+private:
+    bool load(const cpu_fft_cache_key& key, cpu_fft_cache_entry& entry) const;
+    void store(const cpu_fft_cache_entry& entry) const;
+    std::string entry_filename(const cpu_fft_cache_key& key) const;
+
+    // most recently used result first
+    std::list<cpu_fft_cache_entry> entries;
+    size_t                         used_bytes = 0;
+};
+
+extern cpu_fft_cache cpu_fft_data;
+
+#endif
@@ -18,7 +18,9 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <cmath>
 #include <memory>
+#include <random>
 #include <type_traits>
 #include <vector>
 
@@ -485,3 +487,324 @@ TEST(rocfft_UnitTest, default_store_callback_real_double)
                        DefaultCallbackType::STORE,
                        8);
 }
+
+// -------------------------------------------------------------------
+// Test load and store callbacks given as source, which are compiled
+// into the plan's kernels.  The callbacks scale each element by a
+// factor in their callback data, so the result should match an
+// ordinary transform of input that was scaled on the host, or whose
+// output was scaled on the host.
+//
+// Plans with several kernels are tested too, since the load callback
+// goes into the first kernel and the store callback into the last,
+// and those can be real-complex or transpose kernels rather than
+// Stockham kernels.
+// -------------------------------------------------------------------
+
+static const char* scale_cb_source = R"(
+struct scale_data
+{
+    float scale;
+};
+
+__device__ rocfft_complex<float>
+    scale_load_complex(rocfft_complex<float>* data, size_t offset, void* cbdata, void* sharedMem)
+{
+    return data[offset] * static_cast<const scale_data*>(cbdata)->scale;
+}
+
+__device__ float scale_load_real(float* data, size_t offset, void* cbdata, void* sharedMem)
+{
+    return data[offset] * static_cast<const scale_data*>(cbdata)->scale;
+}
+
+__device__ void scale_store_complex(rocfft_complex<float>* data,
+                                    size_t                 offset,
+                                    rocfft_complex<float>  element,
+                                    void*                  cbdata,
+                                    void*                  sharedMem)
+{
+    data[offset] = element * static_cast<const scale_data*>(cbdata)->scale;
+}
+
+__device__ void
+    scale_store_real(float* data, size_t offset, float element, void* cbdata, void* sharedMem)
+{
+    data[offset] = element * static_cast<const scale_data*>(cbdata)->scale;
+}
+)";
+
+// must match the struct in scale_cb_source
+struct scale_data
+{
+    float scale;
+};
+
+// Run a single-precision out-of-place 1D transform of host_in,
+// returning out_count output elements.  If cbdata is non-null, the
+// named load and/or store callbacks from scale_cb_source are given to
+// the plan, and cbdata is passed to them.
+template <typename Tin, typename Tout>
+static std::vector<Tout> source_callback_transform(rocfft_transform_type   type,
+                                                   size_t                  length,
+                                                   const std::vector<Tin>& host_in,
+                                                   size_t                  out_count,
+                                                   const char*             load_fn,
+                                                   const char*             store_fn,
+                                                   const scale_data*       cbdata)
+{
+    std::vector<Tout> host_out(out_count);
+
+    rocfft_plan_description desc = nullptr;
+    EXPECT_EQ(rocfft_plan_description_create(&desc), rocfft_status_success);
+    if(cbdata)
+    {
+        EXPECT_EQ(
+            rocfft_plan_description_set_callback_source(desc, scale_cb_source, load_fn, store_fn),
+            rocfft_status_success);
+    }
+
+    rocfft_plan plan = nullptr;
+    EXPECT_EQ(rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 type,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 1,
+                                 desc),
+              rocfft_status_success);
+    EXPECT_EQ(rocfft_plan_description_destroy(desc), rocfft_status_success);
+
+    rocfft_execution_info info = nullptr;
+    EXPECT_EQ(rocfft_execution_info_create(&info), rocfft_status_success);
+
+    size_t work_buffer_size = 0;
+    EXPECT_EQ(rocfft_plan_get_work_buffer_size(plan, &work_buffer_size), rocfft_status_success);
+    gpubuf work_buffer;
+    if(work_buffer_size)
+    {
+        EXPECT_EQ(work_buffer.alloc(work_buffer_size), hipSuccess);
+        EXPECT_EQ(
+            rocfft_execution_info_set_work_buffer(info, work_buffer.data(), work_buffer_size),
+            rocfft_status_success);
+    }
+
+    gpubuf device_cbdata;
+    if(cbdata)
+    {
+        EXPECT_EQ(device_cbdata.alloc(sizeof(scale_data)), hipSuccess);
+        EXPECT_EQ(
+            hipMemcpy(device_cbdata.data(), cbdata, sizeof(scale_data), hipMemcpyHostToDevice),
+            hipSuccess);
+        void* cbdata_ptr = device_cbdata.data();
+        if(load_fn)
+            EXPECT_EQ(rocfft_execution_info_set_load_callback(info, nullptr, &cbdata_ptr, 0),
+                      rocfft_status_success);
+        if(store_fn)
+            EXPECT_EQ(rocfft_execution_info_set_store_callback(info, nullptr, &cbdata_ptr, 0),
+                      rocfft_status_success);
+
+        // function pointers can't be given as well as source
+        void* load_cb_host = nullptr;
+        EXPECT_EQ(hipMemcpyFromSymbol(
+                      &load_cb_host, HIP_SYMBOL(load_cb_complex_float), sizeof(void*)),
+                  hipSuccess);
+        rocfft_execution_info fn_info = nullptr;
+        EXPECT_EQ(rocfft_execution_info_create(&fn_info), rocfft_status_success);
+        EXPECT_EQ(rocfft_execution_info_set_load_callback(fn_info, &load_cb_host, nullptr, 0),
+                  rocfft_status_success);
+        void* dummy = nullptr;
+        EXPECT_EQ(rocfft_execute(plan, &dummy, &dummy, fn_info), rocfft_status_invalid_arg_value);
+        EXPECT_EQ(rocfft_execution_info_destroy(fn_info), rocfft_status_success);
+    }
+
+    const size_t in_bytes  = host_in.size() * sizeof(Tin);
+    const size_t out_bytes = out_count * sizeof(Tout);
+    gpubuf       device_in;
+    gpubuf       device_out;
+    EXPECT_EQ(device_in.alloc(in_bytes), hipSuccess);
+    EXPECT_EQ(device_out.alloc(out_bytes), hipSuccess);
+    EXPECT_EQ(hipMemcpy(device_in.data(), host_in.data(), in_bytes, hipMemcpyHostToDevice),
+              hipSuccess);
+
+    void* in_ptr  = device_in.data();
+    void* out_ptr = device_out.data();
+    EXPECT_EQ(rocfft_execute(plan, &in_ptr, &out_ptr, info), rocfft_status_success);
+    EXPECT_EQ(hipMemcpy(host_out.data(), out_ptr, out_bytes, hipMemcpyDeviceToHost), hipSuccess);
+
+    EXPECT_EQ(rocfft_execution_info_destroy(info), rocfft_status_success);
+    EXPECT_EQ(rocfft_plan_destroy(plan), rocfft_status_success);
+    return host_out;
+}
+
+static void random_input(std::vector<float>& data)
+{
+    std::minstd_rand                      gen(9);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for(auto& x : data)
+        x = dist(gen);
+}
+
+static void random_input(std::vector<rocfft_complex<float>>& data)
+{
+    std::minstd_rand                      gen(9);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for(auto& x : data)
+    {
+        x.x = dist(gen);
+        x.y = dist(gen);
+    }
+}
+
+template <typename T>
+static std::vector<T> scaled(const std::vector<T>& data, float scale)
+{
+    std::vector<T> ret(data.size());
+    for(size_t i = 0; i < data.size(); ++i)
+        ret[i] = data[i] * scale;
+    return ret;
+}
+
+// compare output against the expected result, using the same
+// tolerance as the accuracy tests
+static void compare_output(const std::vector<rocfft_complex<float>>& output,
+                           const std::vector<rocfft_complex<float>>& expected,
+                           size_t                                    length)
+{
+    auto norm = norm_complex(expected.data(), expected.size(), 1, 1, expected.size(), {0});
+
+    std::vector<std::pair<size_t, size_t>> linf_failures;
+
+    const double linf_cutoff = type_epsilon<float>() * norm.l_inf * log(length);
+    auto         diff        = distance_1to1_complex(output.data(),
+                                      expected.data(),
+                                      output.size(),
+                                      1,
+                                      1,
+                                      output.size(),
+                                      1,
+                                      expected.size(),
+                                      linf_failures,
+                                      linf_cutoff,
+                                      {0},
+                                      {0});
+
+    EXPECT_LE(diff.l_inf, linf_cutoff);
+}
+
+static void compare_output(const std::vector<float>& output,
+                           const std::vector<float>& expected,
+                           size_t                    length)
+{
+    auto norm = norm_real(expected.data(), expected.size(), 1, 1, expected.size(), {0});
+
+    std::vector<std::pair<size_t, size_t>> linf_failures;
+
+    const double linf_cutoff = type_epsilon<float>() * norm.l_inf * log(length);
+    auto         diff        = distance_1to1_real(output.data(),
+                                   expected.data(),
+                                   output.size(),
+                                   1,
+                                   1,
+                                   output.size(),
+                                   1,
+                                   expected.size(),
+                                   linf_failures,
+                                   linf_cutoff,
+                                   {0},
+                                   {0});
+
+    EXPECT_LE(diff.l_inf, linf_cutoff);
+}
+
+// Run a transform with a source load callback, and with a source
+// store callback, and check each against a transform without
+// callbacks.
+template <typename Tin, typename Tout>
+static void test_source_callbacks(rocfft_transform_type   type,
+                                  size_t                  length,
+                                  const std::vector<Tin>& host_in,
+                                  size_t                  out_count,
+                                  const char*             load_fn,
+                                  const char*             store_fn)
+{
+    const scale_data cbdata = {3.5f};
+
+    auto output = source_callback_transform<Tin, Tout>(
+        type, length, host_in, out_count, nullptr, nullptr, nullptr);
+
+    // load callback scales the input
+    auto load_output = source_callback_transform<Tin, Tout>(
+        type, length, host_in, out_count, load_fn, nullptr, &cbdata);
+    auto load_expected = source_callback_transform<Tin, Tout>(
+        type, length, scaled(host_in, cbdata.scale), out_count, nullptr, nullptr, nullptr);
+    compare_output(load_output, load_expected, length);
+
+    // store callback scales the output
+    auto store_output = source_callback_transform<Tin, Tout>(
+        type, length, host_in, out_count, nullptr, store_fn, &cbdata);
+    compare_output(store_output, scaled(output, cbdata.scale), length);
+}
+
+// single Stockham kernel
+TEST(rocfft_UnitTest, source_callback_complex_single)
+{
+    const size_t                       length = 1024;
+    std::vector<rocfft_complex<float>> host_in(length);
+    random_input(host_in);
+    test_source_callbacks<rocfft_complex<float>, rocfft_complex<float>>(
+        rocfft_transform_type_complex_forward,
+        length,
+        host_in,
+        length,
+        "scale_load_complex",
+        "scale_store_complex");
+}
+
+// large power of 2 is decomposed into transposes and Stockham
+// kernels, with transposes reading the input and writing the output
+TEST(rocfft_UnitTest, source_callback_complex_single_transpose)
+{
+    const size_t                       length = 1 << 20;
+    std::vector<rocfft_complex<float>> host_in(length);
+    random_input(host_in);
+    test_source_callbacks<rocfft_complex<float>, rocfft_complex<float>>(
+        rocfft_transform_type_complex_forward,
+        length,
+        host_in,
+        length,
+        "scale_load_complex",
+        "scale_store_complex");
+}
+
+// even-length real-complex is a multi-kernel complex transform of
+// half the length, plus real-complex pre- or post-processing
+TEST(rocfft_UnitTest, source_callback_real_forward_single_multi_kernel)
+{
+    const size_t       length = 65536;
+    std::vector<float> host_in(length);
+    random_input(host_in);
+    test_source_callbacks<float, rocfft_complex<float>>(rocfft_transform_type_real_forward,
+                                                        length,
+                                                        host_in,
+                                                        length / 2 + 1,
+                                                        "scale_load_real",
+                                                        "scale_store_complex");
+}
+
+TEST(rocfft_UnitTest, source_callback_real_inverse_single_multi_kernel)
+{
+    const size_t                       length = 65536;
+    std::vector<rocfft_complex<float>> host_in(length / 2 + 1);
+    random_input(host_in);
+    // input must be Hermitian-symmetric
+    host_in.front().y = 0.0f;
+    host_in.back().y  = 0.0f;
+    test_source_callbacks<rocfft_complex<float>, float>(rocfft_transform_type_real_inverse,
+                                                        length,
+                                                        host_in,
+                                                        length,
+                                                        "scale_load_complex",
+                                                        "scale_store_real");
+}
@@ -75,8 +75,8 @@ double max_l2_eps_half     = 0.0;
 // Control whether we use FFTW's wisdom (which we use to imply FFTW_MEASURE).
 bool use_fftw_wisdom = false;
 
-// Cache the last cpu fft that was requested
-last_cpu_fft_cache last_cpu_fft_data;
+// Cache recent cpu ffts, so tests can reuse their results
+cpu_fft_cache cpu_fft_data;
 
 system_memory get_system_memory()
 {
@@ -200,6 +200,9 @@ int main(int argc, char* argv[])
     // Filename for precompiled kernels to be written to
     std::string precompile_file;
 
+    // Limit in GiB for cpu fft results cached in memory
+    size_t cpu_cache_gb = 0;
+
     po::options_description opdesc(
         "\n"
         "rocFFT Runtime Test command line options\n"
@@ -274,6 +277,8 @@ int main(int argc, char* argv[])
         ("scalefactor", po::value<double>(&manual_params.scale_factor), "Scale factor to apply to output.")
         ("token", po::value<std::string>(&test_token)->default_value(""), "Test token name for manual test")
         ("precompile",  po::value<std::string>(&precompile_file), "Precompile kernels to a file for all test cases before running tests")
+        ("cpu_cache_gb", po::value<size_t>(&cpu_cache_gb), "Limit in GiB for CPU FFT results cached in memory (default: 1/8 of the RAM limit)")
+        ("cpu_cache_dir", po::value<std::string>(&cpu_fft_data.disk_path), "Directory to store CPU FFT results in, so that later runs can reuse them")
         ("seed", po::value<size_t>(&random_seed), "Random seed; if unset, use an actual random seed.");
     // clang-format on
 
@@ -297,6 +302,10 @@ int main(int argc, char* argv[])
 
     verbose = vm["verbose"].as<int>();
 
+    cpu_fft_data.max_bytes
+        = vm.count("cpu_cache_gb") ? cpu_cache_gb * ONE_GiB
+                                   : (ramgb ? ramgb * ONE_GiB : start_memory.total_bytes) / 8;
+
     std::cout << "single epsilon: " << single_epsilon << "\tdouble epsilon: " << double_epsilon
               << std::endl;
 
@@ -0,0 +1,531 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Tests of the kernel cache itself.  These link the library's RTC
+// code directly, so they can write caches and look kernels up
+// without compiling anything or needing a GPU.
+
+#include "../../shared/environment.h"
+#include "rtc_cache.h"
+#include "rtc_compile.h"
+#include <boost/scope_exit.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <hip/hip_version.h>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// generator sum with every byte set to 'c'
+static std::array<char, 32> test_generator_sum(char c)
+{
+    std::array<char, 32> sum;
+    sum.fill(c);
+    return sum;
+}
+
+// fake code object for a kernel.  lengths vary, so that code
+// objects in the AOT file need padding between them.
+static std::vector<char> test_code(const std::string& kernel_name, const std::string& arch)
+{
+    auto text = "code for " + kernel_name + " on " + arch;
+    return {text.begin(), text.end()};
+}
+
+static std::vector<char> read_file(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+static void write_file(const std::string& path, const char* data, size_t bytes)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(data, bytes);
+}
+
+// look up a kernel in an AOT cache file, returning the code if found
+static std::optional<std::vector<char>> aot_find(const AOTCacheFile&         file,
+                                                 const std::string&          kernel_name,
+                                                 const std::string&          arch,
+                                                 int64_t                     hip_version,
+                                                 const std::array<char, 32>& generator_sum)
+{
+    size_t code_bytes = 0;
+    auto   code       = file.find(kernel_name, arch, hip_version, generator_sum, code_bytes);
+    if(!code)
+        return {};
+    return std::vector<char>(code, code + code_bytes);
+}
+
+// write an AOT cache file from a user cache, and check that lookups
+// in it hit and miss on every part of the key
+TEST(rocfft_UnitTest, rtc_cache_aot_file)
+{
+    const std::string user_path = std::tmpnam(nullptr);
+    const std::string aot_path  = std::tmpnam(nullptr);
+    BOOST_SCOPE_EXIT_ALL(=)
+    {
+        remove(user_path.c_str());
+        remove(aot_path.c_str());
+    };
+
+    // the system cache doesn't exist yet
+    EnvironmentSetTemp user_env("ROCFFT_RTC_CACHE_PATH", user_path.c_str());
+    EnvironmentSetTemp sys_env("ROCFFT_RTC_SYS_CACHE_PATH", aot_path.c_str());
+
+    const auto sum      = test_generator_sum('a');
+    const auto sum_old  = test_generator_sum('b');
+    const auto sum_miss = test_generator_sum('c');
+
+    {
+        RTCCache cache;
+        cache.store_code_object(
+            "fft_len8", "gfx908", sum, test_code("fft_len8", "gfx908"), 1, 10);
+        cache.store_code_object(
+            "fft_len8", "gfx90a", sum, test_code("fft_len8", "gfx90a"), 1, 10);
+        cache.store_code_object(
+            "fft_len64", "gfx908", sum, test_code("fft_len64", "gfx908"), 2, 10);
+        // not one of the arches being written out
+        cache.store_code_object(
+            "fft_len64", "gfx1030", sum, test_code("fft_len64", "gfx1030"), 2, 10);
+        // from an older generator
+        cache.store_code_object(
+            "fft_len16", "gfx908", sum_old, test_code("fft_len16", "gfx908"), 3, 10);
+
+        // arches may come with feature flags, which aren't part of
+        // the key
+        cache.write_aot_cache(aot_path, sum, {"gfx908:xnack-", "gfx90a"});
+    }
+
+    auto file = AOTCacheFile::open(aot_path);
+    ASSERT_TRUE(file);
+
+    // hits
+    for(const auto& [kernel_name, arch] :
+        std::vector<std::pair<std::string, std::string>>{
+            {"fft_len8", "gfx908"}, {"fft_len8", "gfx90a"}, {"fft_len64", "gfx908"}})
+    {
+        auto code = aot_find(*file, kernel_name, arch, HIP_VERSION, sum);
+        ASSERT_TRUE(code) << kernel_name << " " << arch;
+        EXPECT_EQ(*code, test_code(kernel_name, arch));
+    }
+
+    // misses by kernel name, including names sorted before and
+    // after everything in the file
+    EXPECT_FALSE(aot_find(*file, "fft_len1", "gfx908", HIP_VERSION, sum));
+    EXPECT_FALSE(aot_find(*file, "fft_len9", "gfx908", HIP_VERSION, sum));
+    EXPECT_FALSE(aot_find(*file, "fft_len", "gfx908", HIP_VERSION, sum));
+    // by arch: not written out, a prefix of one that was, or
+    // written with feature flags
+    EXPECT_FALSE(aot_find(*file, "fft_len64", "gfx1030", HIP_VERSION, sum));
+    EXPECT_FALSE(aot_find(*file, "fft_len64", "gfx90a", HIP_VERSION, sum));
+    EXPECT_FALSE(aot_find(*file, "fft_len8", "gfx90", HIP_VERSION, sum));
+    EXPECT_FALSE(aot_find(*file, "fft_len8", "gfx908:xnack-", HIP_VERSION, sum));
+    // by HIP version
+    EXPECT_FALSE(aot_find(*file, "fft_len8", "gfx908", HIP_VERSION - 1, sum));
+    EXPECT_FALSE(aot_find(*file, "fft_len8", "gfx908", HIP_VERSION + 1, sum));
+    // by generator sum - kernels from other generators aren't
+    // written out either
+    EXPECT_FALSE(aot_find(*file, "fft_len8", "gfx908", HIP_VERSION, sum_miss));
+    EXPECT_FALSE(aot_find(*file, "fft_len16", "gfx908", HIP_VERSION, sum_old));
+
+    // the cache finds kernels in the AOT file when it's the system
+    // cache, and the user cache is empty
+    {
+        EnvironmentSetTemp empty_user_env("ROCFFT_RTC_CACHE_PATH", ":memory:");
+        RTCCache           cache;
+        EXPECT_EQ(cache.get_code_object("fft_len64", "gfx908", sum),
+                  test_code("fft_len64", "gfx908"));
+        EXPECT_TRUE(cache.get_code_object("fft_len64", "gfx1030", sum).empty());
+        EXPECT_TRUE(cache.get_code_object("fft_len64", "gfx908", sum_miss).empty());
+    }
+
+    // writing the same kernels again gives the same file
+    const auto contents = read_file(aot_path);
+    file.reset();
+    {
+        // don't map the file we're about to replace
+        EnvironmentSetTemp no_sys_env("ROCFFT_RTC_SYS_CACHE_PATH", (aot_path + ".none").c_str());
+        RTCCache           cache;
+        cache.write_aot_cache(aot_path, sum, {"gfx90a", "gfx908:xnack-"});
+    }
+    EXPECT_EQ(read_file(aot_path), contents);
+}
+
+// check that damaged AOT cache files are rejected, instead of being
+// read out of bounds
+TEST(rocfft_UnitTest, rtc_cache_aot_file_damaged)
+{
+    const std::string user_path    = std::tmpnam(nullptr);
+    const std::string aot_path     = std::tmpnam(nullptr);
+    const std::string damaged_path = std::tmpnam(nullptr);
+    BOOST_SCOPE_EXIT_ALL(=)
+    {
+        remove(user_path.c_str());
+        remove(aot_path.c_str());
+        remove(damaged_path.c_str());
+    };
+
+    EnvironmentSetTemp user_env("ROCFFT_RTC_CACHE_PATH", user_path.c_str());
+    EnvironmentSetTemp sys_env("ROCFFT_RTC_SYS_CACHE_PATH", aot_path.c_str());
+
+    const auto sum = test_generator_sum('a');
+    {
+        RTCCache cache;
+        for(const auto& kernel_name : {"fft_len8", "fft_len64", "fft_len128"})
+            cache.store_code_object(
+                kernel_name, "gfx908", sum, test_code(kernel_name, "gfx908"), 1, 10);
+        cache.write_aot_cache(aot_path, sum, {"gfx908"});
+    }
+    const auto contents = read_file(aot_path);
+    ASSERT_TRUE(AOTCacheFile::open(aot_path));
+
+    // AOTCacheFile layout: 16-byte header (8-byte magic, version,
+    // entry count), then 80-byte index entries
+    const size_t header_bytes = 16;
+    const size_t entry_bytes  = 80;
+    ASSERT_GT(contents.size(), header_bytes + 3 * entry_bytes);
+
+    // the last code object ends at the end of the file, so every
+    // truncation cuts off something the index points to
+    for(size_t len = 0; len < contents.size(); ++len)
+    {
+        write_file(damaged_path, contents.data(), len);
+        EXPECT_FALSE(AOTCacheFile::open(damaged_path)) << "truncated to " << len << " bytes";
+    }
+
+    // wrong magic, or wrong version
+    for(size_t offset : {size_t(0), size_t(7), size_t(8)})
+    {
+        auto damaged = contents;
+        damaged[offset] ^= 0x20;
+        write_file(damaged_path, damaged.data(), damaged.size());
+        EXPECT_FALSE(AOTCacheFile::open(damaged_path)) << "byte " << offset << " changed";
+    }
+
+    // index entries pointing past the end of the file: the entry
+    // count, each offset, and each length
+    auto set_u64 = [](std::vector<char>& data, size_t offset, uint64_t value) {
+        memcpy(data.data() + offset, &value, sizeof(value));
+    };
+    {
+        auto     damaged     = contents;
+        uint32_t entry_count = ~uint32_t(0);
+        memcpy(damaged.data() + 12, &entry_count, sizeof(entry_count));
+        write_file(damaged_path, damaged.data(), damaged.size());
+        EXPECT_FALSE(AOTCacheFile::open(damaged_path)) << "entry count changed";
+    }
+    for(size_t entry = 0; entry < 3; ++entry)
+    {
+        const size_t entry_offset = header_bytes + entry * entry_bytes;
+        // kernel_name_offset, arch_offset, code_offset, code_bytes
+        for(size_t field = 0; field < 4; ++field)
+        {
+            for(uint64_t value : {uint64_t(contents.size() + 1), ~uint64_t(0)})
+            {
+                auto damaged = contents;
+                set_u64(damaged, entry_offset + field * 8, value);
+                write_file(damaged_path, damaged.data(), damaged.size());
+                EXPECT_FALSE(AOTCacheFile::open(damaged_path))
+                    << "entry " << entry << " field " << field << " set to " << value;
+            }
+        }
+        // kernel_name_bytes, arch_bytes
+        for(size_t field_offset : {size_t(40), size_t(44)})
+        {
+            auto     damaged = contents;
+            uint32_t value   = ~uint32_t(0);
+            memcpy(damaged.data() + entry_offset + field_offset, &value, sizeof(value));
+            write_file(damaged_path, damaged.data(), damaged.size());
+            EXPECT_FALSE(AOTCacheFile::open(damaged_path))
+                << "entry " << entry << " byte " << field_offset << " changed";
+        }
+    }
+
+    // other damage to the index can leave it pointing inside the
+    // file, but at the wrong place.  such a file may open, but
+    // lookups in it must stay inside the file.
+    for(size_t offset = 0; offset < header_bytes + 3 * entry_bytes; ++offset)
+    {
+        auto damaged = contents;
+        damaged[offset] ^= 0x01;
+        write_file(damaged_path, damaged.data(), damaged.size());
+        auto file = AOTCacheFile::open(damaged_path);
+        if(!file)
+            continue;
+        for(const auto& kernel_name : {"fft_len8", "fft_len64", "fft_len128"})
+        {
+            auto code = aot_find(*file, kernel_name, "gfx908", HIP_VERSION, sum);
+            if(code)
+            {
+                EXPECT_LE(code->size(), contents.size());
+            }
+        }
+    }
+
+    // other kinds of files: the user cache database, an empty file,
+    // a directory and a path that doesn't exist
+    EXPECT_FALSE(AOTCacheFile::open(user_path));
+    write_file(damaged_path, nullptr, 0);
+    EXPECT_FALSE(AOTCacheFile::open(damaged_path));
+    EXPECT_FALSE(AOTCacheFile::open(fs::temp_directory_path()));
+    remove(damaged_path.c_str());
+    EXPECT_FALSE(AOTCacheFile::open(damaged_path));
+
+    // a damaged system cache is ignored, rather than being opened as
+    // a database or breaking the user cache
+    {
+        auto damaged = contents;
+        damaged[0] ^= 0x20;
+        write_file(aot_path, damaged.data(), damaged.size());
+        EnvironmentSetTemp empty_user_env("ROCFFT_RTC_CACHE_PATH", ":memory:");
+        RTCCache           cache;
+        EXPECT_TRUE(cache.get_code_object("fft_len8", "gfx908", sum).empty());
+        cache.store_code_object("fft_len8", "gfx908", sum, test_code("fft_len8", "gfx908"), 1, 10);
+        EXPECT_EQ(cache.get_code_object("fft_len8", "gfx908", sum),
+                  test_code("fft_len8", "gfx908"));
+    }
+}
+
+// a kernel whose generated source and compile signature are
+// unchanged reuses its code object under a new generator sum.  a
+// changed source or changed compile options means compiling again.
+TEST(rocfft_UnitTest, rtc_cache_reuse_by_source)
+{
+    const std::string user_path = std::tmpnam(nullptr);
+    BOOST_SCOPE_EXIT_ALL(=)
+    {
+        RTCCache::single.reset();
+        remove(user_path.c_str());
+        fs::remove_all(user_path + ".locks");
+    };
+
+    EnvironmentSetTemp user_env("ROCFFT_RTC_CACHE_PATH", user_path.c_str());
+    EnvironmentSetTemp sys_env("ROCFFT_RTC_SYS_CACHE_PATH", (user_path + ".none").c_str());
+    // compile in-process, so that a compile that isn't skipped is
+    // sure to fail on the fake source instead of looking for a helper
+    EnvironmentSetTemp process_env("ROCFFT_RTC_PROCESS", "0");
+
+    RTCCache::single = std::make_unique<RTCCache>();
+
+    const auto        sum_old   = test_generator_sum('a');
+    const auto        sum_new   = test_generator_sum('b');
+    const std::string src       = "not really a kernel";
+    const std::string signature = compile_signature();
+
+    // count how often the source gets generated
+    size_t generated    = 0;
+    auto   generate_src = [&generated](const std::string& src) {
+        return kernel_src_gen_t([&generated, src](const std::string&) {
+            ++generated;
+            return src;
+        });
+    };
+
+    // same source and signature: the code object is copied to the
+    // new generator sum, along with how long it took to compile
+    RTCCache::single->store_code_object("fft_same",
+                                        "gfx908",
+                                        sum_old,
+                                        test_code("fft_same", "gfx908"),
+                                        rtc_source_sum(src, signature),
+                                        1234);
+    EXPECT_EQ(cached_compile("fft_same", "gfx908:xnack-", generate_src(src), sum_new),
+              test_code("fft_same", "gfx908"));
+    EXPECT_EQ(generated, 1u);
+    EXPECT_EQ(RTCCache::single->get_code_object("fft_same", "gfx908", sum_new),
+              test_code("fft_same", "gfx908"));
+    EXPECT_EQ(RTCCache::single->get_compile_durations().at("fft_same"), 1234);
+
+    // now it's a plain cache hit, without generating the source
+    EXPECT_EQ(cached_compile("fft_same", "gfx908", generate_src(src), sum_new),
+              test_code("fft_same", "gfx908"));
+    EXPECT_EQ(generated, 1u);
+
+    // the code object is only reused for the same arch
+    EXPECT_ANY_THROW(cached_compile("fft_same", "gfx90a", generate_src(src), sum_new));
+    EXPECT_TRUE(RTCCache::single->get_code_object("fft_same", "gfx90a", sum_new).empty());
+
+    // changed source
+    RTCCache::single->store_code_object("fft_src",
+                                        "gfx908",
+                                        sum_old,
+                                        test_code("fft_src", "gfx908"),
+                                        rtc_source_sum(src, signature),
+                                        1234);
+    EXPECT_ANY_THROW(
+        cached_compile("fft_src", "gfx908", generate_src(src + " changed"), sum_new));
+    EXPECT_TRUE(RTCCache::single->get_code_object("fft_src", "gfx908", sum_new).empty());
+
+    // changed compile options
+    RTCCache::single->store_code_object("fft_options",
+                                        "gfx908",
+                                        sum_old,
+                                        test_code("fft_options", "gfx908"),
+                                        rtc_source_sum(src, signature + " -DCHANGED"),
+                                        1234);
+    EXPECT_ANY_THROW(cached_compile("fft_options", "gfx908", generate_src(src), sum_new));
+    EXPECT_TRUE(RTCCache::single->get_code_object("fft_options", "gfx908", sum_new).empty());
+
+    // the same source under another kernel name isn't reused either
+    EXPECT_ANY_THROW(cached_compile("fft_other", "gfx908", generate_src(src), sum_new));
+}
+
+// compile durations add up over architectures, and only kernels
+// compiled from the same source for every architecture count as
+// already compiled
+TEST(rocfft_UnitTest, rtc_cache_compile_durations)
+{
+    const std::string user_path = std::tmpnam(nullptr);
+    BOOST_SCOPE_EXIT_ALL(=)
+    {
+        remove(user_path.c_str());
+    };
+
+    EnvironmentSetTemp user_env("ROCFFT_RTC_CACHE_PATH", user_path.c_str());
+    EnvironmentSetTemp sys_env("ROCFFT_RTC_SYS_CACHE_PATH", (user_path + ".none").c_str());
+
+    RTCCache   cache;
+    const auto sum_old = test_generator_sum('a');
+    const auto sum_new = test_generator_sum('b');
+
+    auto store = [&](const std::string&          kernel_name,
+                     const std::string&          arch,
+                     const std::array<char, 32>& generator_sum,
+                     sqlite3_int64               source_sum,
+                     sqlite3_int64               compile_ms) {
+        cache.store_code_object(kernel_name,
+                                arch,
+                                generator_sum,
+                                test_code(kernel_name, arch),
+                                source_sum,
+                                compile_ms);
+    };
+
+    // compiled for both arches from the same source
+    store("fft_both", "gfx908", sum_old, 1, 100);
+    store("fft_both", "gfx90a", sum_old, 1, 200);
+    // compiled for both arches, but from different source
+    store("fft_split", "gfx908", sum_old, 2, 300);
+    store("fft_split", "gfx90a", sum_new, 3, 50);
+    // compiled twice for one arch - the slower one counts
+    store("fft_one", "gfx908", sum_old, 4, 400);
+    store("fft_one", "gfx908", sum_new, 5, 500);
+
+    auto durations = cache.get_compile_durations();
+    EXPECT_EQ(durations.size(), 3u);
+    EXPECT_EQ(durations["fft_both"], 300);
+    EXPECT_EQ(durations["fft_split"], 350);
+    EXPECT_EQ(durations["fft_one"], 500);
+
+    auto compiled = cache.get_compiled_sources({"gfx908:xnack-", "gfx90a"});
+    EXPECT_EQ(compiled,
+              (std::set<std::pair<std::string, sqlite3_int64>>{{"fft_both", 1}}));
+
+    compiled = cache.get_compiled_sources({"gfx908"});
+    EXPECT_EQ(compiled,
+              (std::set<std::pair<std::string, sqlite3_int64>>{
+                  {"fft_both", 1}, {"fft_split", 2}, {"fft_one", 4}, {"fft_one", 5}}));
+
+    EXPECT_TRUE(cache.get_compiled_sources({"gfx1030"}).empty());
+    EXPECT_TRUE(cache.get_compiled_sources({}).empty());
+}
+
+// with a small size budget, storing kernels trims the user cache.
+// the least used kernels are evicted first, and a frequently used
+// one is kept even though it's the oldest.
+TEST(rocfft_UnitTest, rtc_cache_eviction)
+{
+    const std::string user_path = std::tmpnam(nullptr);
+    BOOST_SCOPE_EXIT_ALL(=)
+    {
+        remove(user_path.c_str());
+    };
+
+    EnvironmentSetTemp user_env("ROCFFT_RTC_CACHE_PATH", user_path.c_str());
+    EnvironmentSetTemp sys_env("ROCFFT_RTC_SYS_CACHE_PATH", (user_path + ".none").c_str());
+
+    const auto  sum  = test_generator_sum('a');
+    const char* arch = "gfx908";
+
+    // kernel i is used i times after being stored
+    const size_t             num_kernels = 15;
+    std::vector<std::string> kernel_names;
+    for(size_t i = 0; i < num_kernels; ++i)
+        kernel_names.push_back("fft_k" + std::string(i < 10 ? "0" : "") + std::to_string(i));
+
+    // fill the cache and use the kernels under the default budget.
+    // the uses are written when the cache is closed.
+    {
+        RTCCache cache;
+        cache.store_code_object("fft_hot", arch, sum, test_code("fft_hot", arch), 0, 10);
+        for(const auto& kernel_name : kernel_names)
+            cache.store_code_object(
+                kernel_name, arch, sum, test_code(kernel_name, arch), 0, 10);
+
+        for(size_t i = 0; i < num_kernels; ++i)
+            for(size_t use = 0; use < i; ++use)
+                ASSERT_FALSE(cache.get_code_object(kernel_names[i], arch, sum).empty());
+        for(size_t use = 0; use < 100; ++use)
+            ASSERT_FALSE(cache.get_code_object("fft_hot", arch, sum).empty());
+    }
+
+    // shrink the budget to a handful of the test kernels.  the
+    // first store checks the budget and trims the cache, and closing
+    // the cache waits for the trim to finish.
+    const sqlite3_int64 max_size = 200;
+    {
+        EnvironmentSetTemp max_size_env("ROCFFT_RTC_CACHE_MAX_SIZE",
+                                        std::to_string(max_size).c_str());
+        RTCCache           cache;
+        cache.store_code_object("fft_new", arch, sum, test_code("fft_new", arch), 0, 10);
+    }
+
+    // something must have been kept, and what's left fits the budget
+    std::vector<std::string> kept;
+    sqlite3_int64            kept_size = 0;
+    {
+        RTCCache cache;
+        for(const auto& kernel_name : kernel_names)
+        {
+            auto code = cache.get_code_object(kernel_name, arch, sum);
+            if(code.empty())
+                continue;
+            kept.push_back(kernel_name);
+            kept_size += code.size() + kernel_name.size();
+        }
+        EXPECT_FALSE(cache.get_code_object("fft_hot", arch, sum).empty());
+        EXPECT_TRUE(cache.get_code_object("fft_new", arch, sum).empty());
+        kept_size += test_code("fft_hot", arch).size() + strlen("fft_hot");
+    }
+    EXPECT_LE(kept_size, max_size);
+    ASSERT_FALSE(kept.empty());
+    ASSERT_LT(kept.size(), num_kernels);
+
+    // the kernels kept are the most used ones
+    EXPECT_EQ(kept,
+              std::vector<std::string>(kernel_names.end() - kept.size(), kernel_names.end()));
+}
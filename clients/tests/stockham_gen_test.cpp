@@ -0,0 +1,430 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Host-side tests of Stockham kernel generation, that don't need to
+// compile or run any kernels.
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <gtest/gtest.h>
+#include <map>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "../../shared/arithmetic.h"
+#include "rtc_stockham_config.h"
+
+using namespace std::placeholders;
+
+#include "../../library/src/device/generator/generator.h"
+#include "../../library/src/device/generator/stockham_gen.h"
+#include "../../library/src/device/generator/stockham_gen_base.h"
+#include "../../library/src/device/generator/stockham_gen_rr.h"
+
+static const unsigned int WAVEFRONT_SIZE = 64;
+
+// check the threads and workgroup chosen for lengths that the
+// accuracy tests run with runtime-configured kernels
+TEST(rocfft_UnitTest, stockham_config_lengths)
+{
+    struct expected_config
+    {
+        size_t                    length;
+        std::vector<unsigned int> factors;
+        unsigned int              threads_per_transform;
+        unsigned int              workgroup_size;
+        bool                      half_lds;
+    };
+    const std::vector<expected_config> expected = {
+        {130, {13, 5, 2}, 10, 120, false},
+        {154, {11, 7, 2}, 14, 126, false},
+        {198, {11, 6, 3}, 18, 126, false},
+        {338, {13, 13, 2}, 26, 156, false},
+        {507, {13, 13, 3}, 39, 117, false},
+        {686, {7, 7, 7, 2}, 49, 245, true},
+        {1300, {13, 5, 5, 4}, 100, 100, false},
+        {1575, {9, 7, 5, 5}, 175, 175, false},
+    };
+    for(const auto& e : expected)
+    {
+        SCOPED_TRACE("length " + std::to_string(e.length));
+        auto config = configure_stockham(e.length);
+        ASSERT_TRUE(config);
+        EXPECT_EQ(config->factors, e.factors);
+        EXPECT_EQ(config->threads_per_transform, e.threads_per_transform);
+        EXPECT_EQ(config->workgroup_size(), e.workgroup_size);
+        EXPECT_EQ(config->half_lds, e.half_lds);
+    }
+
+    // these would need more registers per thread than the budget
+    // allows, or more threads than a transform may have.  4913 (17^3)
+    // would also need more than the 32 KiB of LDS, even in single
+    // precision, since the generator budgets LDS for double-precision
+    // elements.
+    for(size_t length : {286, 2431, 4095, 4913})
+        EXPECT_FALSE(configure_stockham(length)) << "length " << length;
+
+    // long lengths are rejected before they're factorized, since they
+    // have very many factorizations and the configurator runs while
+    // the function pool is locked
+    auto start = std::chrono::steady_clock::now();
+    for(size_t length : {1 << 20, 1 << 22, 241920})
+        EXPECT_FALSE(configure_stockham(length)) << "length " << length;
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+}
+
+// check that every configured kernel stays within the register, thread
+// and LDS budgets, and fills whole wavefronts where that's possible
+TEST(rocfft_UnitTest, stockham_config_budgets)
+{
+    for(size_t length = 2; length <= 4096; ++length)
+    {
+        auto config = configure_stockham(length);
+        if(!config)
+            continue;
+        SCOPED_TRACE("length " + std::to_string(length));
+
+        const auto& factors = config->factors;
+        ASSERT_FALSE(factors.empty());
+        ASSERT_EQ(std::accumulate(factors.begin(), factors.end(), size_t(1), std::multiplies<>()),
+                  length);
+
+        const unsigned int tpt        = config->threads_per_transform;
+        const unsigned int max_factor = *std::max_element(factors.begin(), factors.end());
+        const unsigned int budget     = std::max(16u, max_factor);
+        ASSERT_GT(tpt, 0u);
+        EXPECT_LE(tpt, length / max_factor);
+        EXPECT_LE(DivRoundingUp<size_t>(length, tpt), budget);
+        for(auto width : factors)
+            EXPECT_LE(DivRoundingUp<size_t>(length / width, tpt) * width, budget);
+
+        // half LDS can't do write guards, so needs even passes
+        if(config->half_lds)
+        {
+            EXPECT_EQ(length % tpt, 0u);
+            for(auto width : factors)
+                EXPECT_EQ((length / tpt) % width, 0u);
+        }
+
+        size_t bytes_per_batch = length * StockhamKernel::BYTES_PER_ELEMENT;
+        if(config->half_lds)
+            bytes_per_batch /= 2;
+        const size_t max_tpb
+            = std::min<size_t>(StockhamKernel::LDS_BYTE_LIMIT / bytes_per_batch, 256 / tpt);
+        ASSERT_GT(config->transforms_per_block, 0u);
+        EXPECT_LE(config->transforms_per_block, max_tpb);
+        EXPECT_LE(config->workgroup_size(), 256u);
+
+        if(WAVEFRONT_SIZE / std::gcd(tpt, WAVEFRONT_SIZE) <= max_tpb)
+        {
+            EXPECT_EQ(config->workgroup_size() % WAVEFRONT_SIZE, 0u);
+        }
+    }
+}
+
+// Evaluates generated integer and register code for every lane of a
+// transform.  Registers hold element IDs, so that data movement can be
+// compared.
+struct LaneSimulator
+{
+    // per-lane scalars and arrays
+    std::vector<std::map<std::string, long long>>                     scalars;
+    std::vector<std::map<std::string, std::map<long long, long long>>> arrays;
+    // LDS is shared by all lanes
+    std::map<long long, long long> lds;
+
+    explicit LaneSimulator(unsigned int lanes)
+        : scalars(lanes)
+        , arrays(lanes)
+    {
+        for(unsigned int lane = 0; lane < lanes; ++lane)
+        {
+            scalars[lane]["thread"]     = lane;
+            scalars[lane]["offset_lds"] = 0;
+            scalars[lane]["lstride"]    = 1;
+        }
+    }
+
+    long long eval(const Expression& expr, unsigned int lane)
+    {
+        auto binary = [&](const auto& op, auto fn) {
+            return fn(eval(op.args.at(0), lane), eval(op.args.at(1), lane));
+        };
+        if(auto e = std::get_if<Literal>(&expr))
+        {
+            if(e->value == "true")
+                return 1;
+            return static_cast<long long>(std::stoull(e->value, nullptr, 0));
+        }
+        if(auto e = std::get_if<Variable>(&expr))
+            return load(*e, lane);
+        if(auto e = std::get_if<Parens>(&expr))
+            return eval(e->args.at(0), lane);
+        if(auto e = std::get_if<Add>(&expr))
+            return binary(*e, std::plus<>());
+        if(auto e = std::get_if<Subtract>(&expr))
+            return binary(*e, std::minus<>());
+        if(auto e = std::get_if<Multiply>(&expr))
+            return binary(*e, std::multiplies<>());
+        if(auto e = std::get_if<Divide>(&expr))
+            return binary(*e, std::divides<>());
+        if(auto e = std::get_if<Modulus>(&expr))
+            return binary(*e, std::modulus<>());
+        if(auto e = std::get_if<ShiftRight>(&expr))
+            return binary(*e, [](long long a, long long b) {
+                return static_cast<long long>(static_cast<unsigned long long>(a) >> b);
+            });
+        if(auto e = std::get_if<BitAnd>(&expr))
+            return binary(*e, std::bit_and<>());
+        if(auto e = std::get_if<Equal>(&expr))
+            return binary(*e, std::equal_to<>());
+        if(auto e = std::get_if<Or>(&expr))
+            return binary(*e, std::logical_or<>());
+        if(auto e = std::get_if<Ternary>(&expr))
+            return eval(e->args.at(0), lane) ? eval(e->args.at(1), lane)
+                                             : eval(e->args.at(2), lane);
+        if(auto e = std::get_if<CallExpr>(&expr))
+        {
+            // lane_shuffle(value, src_lane, width) reads value from
+            // src_lane of the same transform
+            if(e->name == "lane_shuffle")
+            {
+                auto src = eval(e->arguments.at(1), lane);
+                auto T   = eval(e->arguments.at(2), lane);
+                EXPECT_LT(src, T);
+                return eval(e->arguments.at(0), lane / T * T + src);
+            }
+        }
+        ADD_FAILURE() << "can't evaluate " << vrender(expr);
+        return 0;
+    }
+
+    long long load(const Variable& v, unsigned int lane)
+    {
+        if(!v.index)
+            return scalars[lane].at(v.name);
+        auto index = eval(*v.index, lane);
+        if(v.name == "lds_complex")
+            return lds.at(index);
+        return arrays[lane].at(v.name).at(index);
+    }
+
+    void store(const Variable& v, unsigned int lane, long long value)
+    {
+        if(!v.index)
+            scalars[lane][v.name] = value;
+        else if(v.name == "lds_complex")
+            lds[eval(*v.index, lane)] = value;
+        else
+            arrays[lane][v.name][eval(*v.index, lane)] = value;
+    }
+
+    // run statements on each lane in turn
+    void run_each_lane(const StatementList& stmts)
+    {
+        for(unsigned int lane = 0; lane < scalars.size(); ++lane)
+        {
+            for(const auto& stmt : stmts.statements)
+            {
+                auto assign = std::get_if<Assign>(&stmt);
+                ASSERT_TRUE(assign) << vrender(stmt);
+                store(assign->lhs, lane, eval(assign->rhs, lane));
+            }
+        }
+    }
+
+    // run statements on all lanes in lockstep, so that cross-lane
+    // reads see values from before each statement
+    void run_lockstep(const StatementList& stmts)
+    {
+        for(const auto& stmt : stmts.statements)
+        {
+            auto assign = std::get_if<Assign>(&stmt);
+            ASSERT_TRUE(assign) << vrender(stmt);
+            std::vector<long long> values;
+            for(unsigned int lane = 0; lane < scalars.size(); ++lane)
+                values.push_back(eval(assign->rhs, lane));
+            for(unsigned int lane = 0; lane < scalars.size(); ++lane)
+                store(assign->lhs, lane, values[lane]);
+        }
+    }
+};
+
+// check that cross-lane exchanges move every element to the same
+// lane and register as the LDS store and load they replace, for the
+// pool's SBRR kernels that can use the exchange
+TEST(rocfft_UnitTest, stockham_cross_lane_exchange)
+{
+    struct pool_kernel
+    {
+        std::vector<unsigned int> factors;
+        unsigned int              workgroup_size;
+        unsigned int              threads_per_transform;
+        bool                      half_lds;
+        bool                      direct_to_from_reg;
+    };
+    // multi-pass kernels from kernel-generator.py with power-of-2
+    // threads per transform up to 16
+    const std::vector<pool_kernel> pool = {
+        {{4, 2}, 64, 4, true, true},
+        {{4, 4}, 64, 4, true, true},
+        {{11, 2}, 64, 2, true, true},
+        {{8, 3}, 256, 8, true, true},
+        {{13, 2}, 64, 2, true, true},
+        {{7, 4}, 64, 4, true, true},
+        {{8, 4}, 128, 16, true, true},
+        {{11, 4}, 64, 4, true, true},
+        {{4, 3, 4}, 64, 16, true, true},
+        {{13, 4}, 64, 4, true, true},
+        {{7, 8}, 128, 8, true, true},
+        {{4, 4, 4}, 64, 16, false, true},
+        {{6, 16}, 128, 16, false, false},
+        {{13, 8}, 64, 8, true, true},
+        {{16, 7}, 256, 16, false, false},
+        {{16, 8}, 256, 16, true, true},
+        {{16, 10}, 256, 16, true, true},
+        {{11, 16}, 64, 16, true, true},
+        {{6, 4, 4, 2}, 128, 16, true, true},
+        {{13, 16}, 64, 16, true, true},
+        {{7, 2, 2, 2, 2, 2}, 64, 16, true, true},
+        {{10, 4, 4, 2}, 64, 16, true, true},
+        {{10, 8, 6}, 64, 16, true, true},
+    };
+
+    size_t exchanges = 0;
+    for(const auto& k : pool)
+    {
+        StockhamGeneratorSpecs specs(k.factors, {}, {0}, k.workgroup_size, "CS_KERNEL_STOCKHAM");
+        specs.threads_per_transform = k.threads_per_transform;
+        specs.half_lds              = k.half_lds;
+        specs.direct_to_from_reg    = k.direct_to_from_reg;
+        specs.cross_lane_exchange   = true;
+        StockhamKernelRR kernel(specs);
+
+        const unsigned int T = kernel.threads_per_transform;
+        for(unsigned int npass = 0; npass + 1 < kernel.factors.size(); ++npass)
+        {
+            auto rounds = kernel.plan_cross_lane_exchange(npass);
+            if(rounds.empty())
+                continue;
+            ++exchanges;
+            SCOPED_TRACE("length " + std::to_string(kernel.length) + " pass "
+                         + std::to_string(npass));
+
+            const unsigned int nregs = kernel.length / T;
+            ASSERT_EQ(rounds.size(), nregs);
+
+            // every register starts out holding a distinct element
+            auto init = [&](LaneSimulator& sim) {
+                for(unsigned int lane = 0; lane < T; ++lane)
+                    for(unsigned int r = 0; r < kernel.nregisters; ++r)
+                        sim.arrays[lane]["R"][r] = lane * kernel.nregisters + r;
+            };
+
+            // what the LDS store of this pass and load of the next
+            // pass do, as generated for the kernel
+            const unsigned int width  = kernel.factors[npass];
+            const unsigned int width2 = kernel.factors[npass + 1];
+            const unsigned int cumheight
+                = product(kernel.factors.begin(), kernel.factors.begin() + npass);
+            const bool bank_shift = kernel.length == 64;
+            auto       store_lds  = std::bind(std::mem_fn(&StockhamKernel::store_lds_generator),
+                                       &kernel,
+                                       _1,
+                                       _2,
+                                       _3,
+                                       _4,
+                                       _5,
+                                       Component::BOTH,
+                                       cumheight,
+                                       bank_shift);
+            auto       load_lds   = std::bind(std::mem_fn(&StockhamKernel::load_lds_generator),
+                                      &kernel,
+                                      _1,
+                                      _2,
+                                      _3,
+                                      _4,
+                                      _5,
+                                      Component::BOTH,
+                                      bank_shift);
+            const float height    = static_cast<float>(kernel.length) / width / T;
+            const float height2   = static_cast<float>(kernel.length) / width2 / T;
+            using Guard           = StockhamKernel::ThreadGuardMode;
+
+            LaneSimulator expected(T);
+            init(expected);
+            expected.run_each_lane(kernel.add_work(store_lds, width, height, Guard::NO_GUARD));
+            expected.run_each_lane(kernel.add_work(load_lds, width2, height2, Guard::NO_GUARD));
+            ASSERT_EQ(expected.lds.size(), kernel.length);
+
+            // simulate the planned rounds directly
+            std::vector<std::vector<long long>> regs(T);
+            for(unsigned int lane = 0; lane < T; ++lane)
+                for(unsigned int r = 0; r < nregs; ++r)
+                    regs[lane].push_back(lane * kernel.nregisters + r);
+            const auto original = regs;
+            std::vector<std::vector<bool>> overwritten(T, std::vector<bool>(nregs, false));
+            auto snapshot = StockhamKernel::cross_lane_snapshot_regs(rounds);
+            for(const auto& round : rounds)
+            {
+                std::vector<long long> sent(T);
+                for(unsigned int lane = 0; lane < T; ++lane)
+                {
+                    auto r = round.send_reg[lane];
+                    // an overwritten register must come from the copy
+                    // made before the first round
+                    if(overwritten[lane][r])
+                    {
+                        EXPECT_TRUE(std::count(snapshot.begin(), snapshot.end(), r))
+                            << "register " << r << " is overwritten before it is sent";
+                        sent[lane] = original[lane][r];
+                    }
+                    else
+                        sent[lane] = regs[lane][r];
+                }
+                for(unsigned int lane = 0; lane < T; ++lane)
+                {
+                    regs[lane][round.recv_reg[lane]]        = sent[round.src_lane[lane]];
+                    overwritten[lane][round.recv_reg[lane]] = true;
+                }
+            }
+
+            // and run the code generated for the exchange
+            LaneSimulator exchanged(T);
+            init(exchanged);
+            exchanged.run_lockstep(kernel.cross_lane_exchange_generator(rounds));
+
+            for(unsigned int lane = 0; lane < T; ++lane)
+            {
+                for(unsigned int r = 0; r < nregs; ++r)
+                {
+                    auto want = expected.arrays[lane]["R"][r];
+                    EXPECT_EQ(regs[lane][r], want) << "rounds: lane " << lane << " reg " << r;
+                    EXPECT_EQ(exchanged.arrays[lane]["R"][r], want)
+                        << "generated: lane " << lane << " reg " << r;
+                }
+            }
+        }
+    }
+    // make sure the exchange is actually being tested
+    EXPECT_GT(exchanges, 0u);
+}
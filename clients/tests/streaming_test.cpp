@@ -0,0 +1,408 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "rocfft.h"
+
+#include "../../shared/gpubuf.h"
+#include "../../shared/rocfft_complex.h"
+#include "hip/hip_runtime_api.h"
+#include "streaming.h"
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <vector>
+
+typedef std::complex<double> cplx;
+
+// naive DFT of count sequences of length len, elements stride apart
+// and sequences dist apart
+static void naive_dft(cplx* data, size_t len, size_t stride, size_t count, size_t dist)
+{
+    const double      two_pi = 2.0 * std::acos(-1.0);
+    std::vector<cplx> tmp(len);
+    for(size_t c = 0; c < count; ++c)
+    {
+        cplx* seq = data + c * dist;
+        for(size_t k = 0; k < len; ++k)
+        {
+            tmp[k] = 0;
+            for(size_t j = 0; j < len; ++j)
+                tmp[k] += seq[j * stride] * std::polar(1.0, -two_pi * j * k / len);
+        }
+        for(size_t k = 0; k < len; ++k)
+            seq[k * stride] = tmp[k];
+    }
+}
+
+// Stand-in for the device: slots are host memory, copies are
+// memcpys, and transforms are naive DFTs.  Pass 0 transforms packed
+// rows, pass 1 transforms packed columns.
+struct HostStreamingEngine : public StreamingEngine
+{
+    HostStreamingEngine(cplx* in, cplx* out, size_t num_slots, size_t slot_elems)
+        : in(reinterpret_cast<char*>(in))
+        , out(reinterpret_cast<char*>(out))
+        , slots(num_slots, std::vector<cplx>(slot_elems))
+    {
+    }
+
+    static void copy_2d(
+        char* dst, size_t dpitch, const char* src, size_t spitch, size_t width, size_t rows)
+    {
+        for(size_t r = 0; r < rows; ++r)
+            memcpy(dst + r * dpitch, src + r * spitch, width);
+    }
+
+    char* host(StreamingBuffer buf)
+    {
+        return buf == StreamingBuffer::IN ? in : out;
+    }
+
+    void copy_to_device(size_t                slot,
+                        const StreamingPass&  pass,
+                        const StreamingChunk& chunk) override
+    {
+        ASSERT_LE(chunk.in.rows * chunk.dev_in_pitch, slots[slot].size() * sizeof(cplx));
+        // the slot must have been emptied since it was last filled
+        ASSERT_FALSE(busy.at(slot));
+        busy[slot] = true;
+        copy_2d(reinterpret_cast<char*>(slots[slot].data()),
+                chunk.dev_in_pitch,
+                host(pass.src) + chunk.in.offset,
+                chunk.in.pitch,
+                chunk.in.width,
+                chunk.in.rows);
+    }
+
+    void transform(size_t slot, size_t pass_idx, const StreamingChunk& chunk) override
+    {
+        auto data = slots[slot].data();
+        if(pass_idx == 0)
+        {
+            const size_t len = chunk.dev_in_pitch / sizeof(cplx);
+            naive_dft(data, len, 1, chunk.items, len);
+        }
+        else
+            naive_dft(data, chunk.in.rows, chunk.items, chunk.items, 1);
+        ++transforms;
+    }
+
+    void copy_to_host(size_t slot, const StreamingPass& pass, const StreamingChunk& chunk) override
+    {
+        busy[slot] = false;
+        copy_2d(host(pass.dst) + chunk.out.offset,
+                chunk.out.pitch,
+                reinterpret_cast<const char*>(slots[slot].data()),
+                chunk.dev_out_pitch,
+                chunk.out.width,
+                chunk.out.rows);
+    }
+
+    void barrier() override
+    {
+        ++barriers;
+    }
+
+    char*                          in;
+    char*                          out;
+    std::vector<std::vector<cplx>> slots;
+    std::vector<bool>              busy = std::vector<bool>(slots.size());
+    size_t                         transforms = 0;
+    size_t                         barriers   = 0;
+};
+
+TEST(rocfft_UnitTest, streaming_split_rows)
+{
+    StreamingPass pass;
+    pass.chunk_items = 4;
+
+    StreamingRows in;
+    in.base      = 16;
+    in.width     = 24;
+    in.pitch     = 32;
+    in.dev_pitch = 24;
+    StreamingRows out;
+    out.base      = 0;
+    out.width     = 40;
+    out.pitch     = 48;
+    out.dev_pitch = 40;
+    streaming_split_rows(pass, 10, in, out);
+
+    ASSERT_EQ(pass.chunks.size(), 3U);
+    size_t covered = 0;
+    for(size_t i = 0; i < pass.chunks.size(); ++i)
+    {
+        const auto& chunk = pass.chunks[i];
+        EXPECT_EQ(chunk.in.offset, in.base + covered * in.pitch);
+        EXPECT_EQ(chunk.out.offset, out.base + covered * out.pitch);
+        EXPECT_EQ(chunk.in.rows, chunk.items);
+        EXPECT_EQ(chunk.remainder, i == 2);
+        covered += chunk.items;
+    }
+    EXPECT_EQ(covered, 10U);
+    EXPECT_EQ(pass.chunks.back().items, 2U);
+}
+
+// 2D transform on padded host data, decomposed into a row pass and
+// a column pass, each split into chunks that rotate through slots.
+TEST(rocfft_UnitTest, streaming_2d_host_engine)
+{
+    const size_t len0   = 12;
+    const size_t len1   = 10;
+    const size_t pitch0 = 13;
+
+    std::vector<cplx> in(len1 * pitch0);
+    for(size_t i = 0; i < in.size(); ++i)
+        in[i] = cplx(i % 11, i % 5);
+    std::vector<cplx> out(in.size());
+
+    std::vector<cplx> expected = in;
+    naive_dft(expected.data(), len0, 1, len1, pitch0);
+    naive_dft(expected.data(), len1, pitch0, len0, 1);
+
+    const size_t num_slots = 2;
+
+    std::vector<StreamingPass> passes(2);
+    passes[0].chunk_items = 3;
+    StreamingRows rows;
+    rows.width     = len0 * sizeof(cplx);
+    rows.pitch     = pitch0 * sizeof(cplx);
+    rows.dev_pitch = rows.width;
+    streaming_split_rows(passes[0], len1, rows, rows);
+
+    passes[1].src         = StreamingBuffer::OUT;
+    passes[1].chunk_items = 5;
+    streaming_split_columns(passes[1], len0, len1, sizeof(cplx), 0, pitch0 * sizeof(cplx));
+
+    HostStreamingEngine engine(in.data(), out.data(), num_slots, len0 * len1);
+    streaming_execute(passes, num_slots, engine);
+
+    EXPECT_EQ(engine.transforms, passes[0].chunks.size() + passes[1].chunks.size());
+    EXPECT_EQ(engine.barriers, passes.size() + 1);
+    for(size_t r = 0; r < len1; ++r)
+    {
+        for(size_t c = 0; c < len0; ++c)
+        {
+            const auto idx = r * pitch0 + c;
+            ASSERT_NEAR(out[idx].real(), expected[idx].real(), 1e-9) << "row " << r << " col " << c;
+            ASSERT_NEAR(out[idx].imag(), expected[idx].imag(), 1e-9) << "row " << r << " col " << c;
+        }
+    }
+}
+
+// 1D transform of length N1 * N2, decomposed into a pass over
+// columns that multiplies by twiddles and writes columns out as
+// rows, and an in-place pass over the strided sequences of the
+// output.
+TEST(rocfft_UnitTest, streaming_1d_host_engine)
+{
+    const size_t N1 = 6;
+    const size_t N2 = 10;
+    const size_t N  = N1 * N2;
+
+    std::vector<cplx> in(N);
+    for(size_t i = 0; i < in.size(); ++i)
+        in[i] = cplx(i % 11, i % 5);
+    std::vector<cplx> out(in.size());
+
+    std::vector<cplx> expected = in;
+    naive_dft(expected.data(), N, 1, 1, N);
+
+    const size_t num_slots = 2;
+
+    std::vector<StreamingPass> passes(2);
+    passes[0].dst         = StreamingBuffer::OUT;
+    passes[0].inplace     = false;
+    passes[0].chunk_items = 4;
+    streaming_split_columns_to_rows(passes[0], N2, N1, sizeof(cplx), 0, N2 * sizeof(cplx), 0);
+
+    passes[1].src         = StreamingBuffer::OUT;
+    passes[1].chunk_items = 4;
+    streaming_split_columns(passes[1], N1, N2, sizeof(cplx), 0, N1 * sizeof(cplx));
+
+    // the column pass transforms packed columns out of place, with
+    // twiddles for the chunk's columns
+    struct SplitEngine : public HostStreamingEngine
+    {
+        using HostStreamingEngine::HostStreamingEngine;
+
+        void transform(size_t slot, size_t pass_idx, const StreamingChunk& chunk) override
+        {
+            auto data = slots[slot].data();
+            if(pass_idx == 0)
+            {
+                const double      two_pi = 2.0 * std::acos(-1.0);
+                const size_t      rows   = chunk.in.rows;
+                const size_t      N      = rows * chunk_count;
+                std::vector<cplx> tmp(chunk.items * rows);
+                for(size_t j = 0; j < chunk.items; ++j)
+                {
+                    for(size_t k1 = 0; k1 < rows; ++k1)
+                    {
+                        cplx sum = 0;
+                        for(size_t n1 = 0; n1 < rows; ++n1)
+                            sum += data[n1 * chunk.items + j]
+                                   * std::polar(1.0, -two_pi * n1 * k1 / rows);
+                        tmp[j * rows + k1]
+                            = sum * std::polar(1.0, -two_pi * (chunk.first + j) * k1 / N);
+                    }
+                }
+                std::copy(tmp.begin(), tmp.end(), data);
+            }
+            else
+                naive_dft(data, chunk.in.rows, chunk.items, chunk.items, 1);
+            ++transforms;
+        }
+
+        size_t chunk_count = 0;
+    };
+
+    SplitEngine engine(in.data(), out.data(), num_slots, N);
+    engine.chunk_count = N2;
+    streaming_execute(passes, num_slots, engine);
+
+    EXPECT_EQ(engine.transforms, passes[0].chunks.size() + passes[1].chunks.size());
+    for(size_t i = 0; i < N; ++i)
+    {
+        ASSERT_NEAR(out[i].real(), expected[i].real(), 1e-9) << "index " << i;
+        ASSERT_NEAR(out[i].imag(), expected[i].imag(), 1e-9) << "index " << i;
+    }
+}
+
+// Streamed transforms of host data must match the same transforms
+// run on the device.
+TEST(rocfft_UnitTest, streaming_execute)
+{
+    struct problem
+    {
+        std::vector<size_t>   lengths;
+        size_t                batch;
+        rocfft_transform_type type;
+    };
+    // batch split, 2D row/column splits of C2C, R2C, C2R, and 1D
+    // splits of C2C
+    const std::vector<problem> problems = {
+        {{256}, 37, rocfft_transform_type_complex_forward},
+        {{256, 128}, 2, rocfft_transform_type_complex_inverse},
+        {{256, 128}, 1, rocfft_transform_type_real_forward},
+        {{256, 128}, 1, rocfft_transform_type_real_inverse},
+        {{16384}, 2, rocfft_transform_type_complex_forward},
+        {{24000}, 1, rocfft_transform_type_complex_inverse},
+    };
+    // 3 slots of 48 KiB: fits a few short 1D transforms, or some
+    // rows or columns of the 2D and long 1D ones, but no whole 2D or
+    // long 1D transform
+    const size_t budget = 3 * 48 * 1024;
+
+    std::vector<float> r2c_output;
+
+    for(const auto& p : problems)
+    {
+        SCOPED_TRACE(p.lengths.size() == 1 ? "1D" : "2D");
+
+        size_t in_elems  = p.batch;
+        size_t out_elems = p.batch;
+        for(size_t i = 0; i < p.lengths.size(); ++i)
+        {
+            const bool fastest = i == 0;
+            in_elems *= fastest && p.type == rocfft_transform_type_real_inverse
+                            ? p.lengths[i] / 2 + 1
+                            : p.lengths[i];
+            out_elems *= fastest && p.type == rocfft_transform_type_real_forward
+                             ? p.lengths[i] / 2 + 1
+                             : p.lengths[i];
+        }
+        const size_t in_bytes
+            = in_elems * (p.type == rocfft_transform_type_real_forward ? 4 : 8);
+        const size_t out_bytes
+            = out_elems * (p.type == rocfft_transform_type_real_inverse ? 4 : 8);
+
+        // complex-to-real input needs Hermitian symmetry, so use the
+        // previous real-to-complex output
+        std::vector<float> in_host(in_bytes / sizeof(float));
+        if(p.type == rocfft_transform_type_real_inverse)
+        {
+            ASSERT_EQ(r2c_output.size(), in_host.size());
+            in_host = r2c_output;
+        }
+        else
+        {
+            for(size_t i = 0; i < in_host.size(); ++i)
+                in_host[i] = static_cast<float>((i * 7) % 19) - 9.0f;
+        }
+
+        // reference on the device
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_plan_create(&plan,
+                                     rocfft_placement_notinplace,
+                                     p.type,
+                                     rocfft_precision_single,
+                                     p.lengths.size(),
+                                     p.lengths.data(),
+                                     p.batch,
+                                     nullptr),
+                  rocfft_status_success);
+        gpubuf in_device;
+        gpubuf out_device;
+        ASSERT_EQ(in_device.alloc(in_bytes), hipSuccess);
+        ASSERT_EQ(out_device.alloc(out_bytes), hipSuccess);
+        ASSERT_EQ(hipMemcpy(in_device.data(), in_host.data(), in_bytes, hipMemcpyHostToDevice),
+                  hipSuccess);
+        void* in_ptr  = in_device.data();
+        void* out_ptr = out_device.data();
+        ASSERT_EQ(rocfft_execute(plan, &in_ptr, &out_ptr, nullptr), rocfft_status_success);
+        std::vector<float> expected(out_bytes / sizeof(float));
+        ASSERT_EQ(hipMemcpy(expected.data(), out_device.data(), out_bytes, hipMemcpyDeviceToHost),
+                  hipSuccess);
+        ASSERT_EQ(rocfft_plan_destroy(plan), rocfft_status_success);
+
+        // streamed from host memory
+        rocfft_plan_description desc = nullptr;
+        ASSERT_EQ(rocfft_plan_description_create(&desc), rocfft_status_success);
+        ASSERT_EQ(rocfft_plan_description_set_streaming(desc, budget), rocfft_status_success);
+        rocfft_plan streaming_plan = nullptr;
+        ASSERT_EQ(rocfft_plan_create(&streaming_plan,
+                                     rocfft_placement_notinplace,
+                                     p.type,
+                                     rocfft_precision_single,
+                                     p.lengths.size(),
+                                     p.lengths.data(),
+                                     p.batch,
+                                     desc),
+                  rocfft_status_success);
+        ASSERT_EQ(rocfft_plan_description_destroy(desc), rocfft_status_success);
+
+        std::vector<float> out_host(expected.size());
+        in_ptr  = in_host.data();
+        out_ptr = out_host.data();
+        ASSERT_EQ(rocfft_execute(streaming_plan, &in_ptr, &out_ptr, nullptr),
+                  rocfft_status_success);
+        ASSERT_EQ(hipDeviceSynchronize(), hipSuccess);
+        ASSERT_EQ(rocfft_plan_destroy(streaming_plan), rocfft_status_success);
+
+        for(size_t i = 0; i < expected.size(); ++i)
+            ASSERT_NEAR(out_host[i], expected[i], 1e-3 * std::abs(expected[i]) + 1e-2)
+                << "index " << i;
+
+        if(p.type == rocfft_transform_type_real_forward)
+            r2c_output = expected;
+    }
+}
@@ -30,6 +30,7 @@
 #include <gtest/gtest.h>
 #include <mutex>
 #include <regex>
+#include <set>
 #include <thread>
 #include <vector>
 
@@ -95,6 +96,52 @@ TEST(rocfft_UnitTest, plan_description)
     ASSERT_TRUE(rocfft_status_success == rocfft_plan_destroy(plan));
 }
 
+// Check that plans whose output elements would share a location are
+// rejected
+TEST(rocfft_UnitTest, overlapping_output)
+{
+    std::vector<size_t> lengths = {64, 64};
+    const size_t        batch   = 2;
+
+    auto create = [&](const std::vector<size_t>& o_strides, const size_t odist) {
+        rocfft_plan_description desc = nullptr;
+        EXPECT_EQ(rocfft_plan_description_create(&desc), rocfft_status_success);
+        EXPECT_EQ(rocfft_plan_description_set_data_layout(desc,
+                                                          rocfft_array_type_complex_interleaved,
+                                                          rocfft_array_type_complex_interleaved,
+                                                          nullptr,
+                                                          nullptr,
+                                                          0,
+                                                          nullptr,
+                                                          0,
+                                                          o_strides.size(),
+                                                          o_strides.data(),
+                                                          odist),
+                  rocfft_status_success);
+        rocfft_plan plan   = nullptr;
+        auto        status = rocfft_plan_create(&plan,
+                                                rocfft_placement_notinplace,
+                                                rocfft_transform_type_complex_forward,
+                                                rocfft_precision_single,
+                                                lengths.size(),
+                                                lengths.data(),
+                                                batch,
+                                                desc);
+        rocfft_plan_destroy(plan);
+        rocfft_plan_description_destroy(desc);
+        return status;
+    };
+
+    // rows overlap each other
+    EXPECT_EQ(create({1, 32}, 64 * 64), rocfft_status_invalid_strides);
+    // transposed rows overlap
+    EXPECT_EQ(create({32, 1}, 64 * 64), rocfft_status_invalid_strides);
+    // batches overlap each other
+    EXPECT_EQ(create({1, 64}, 64 * 32), rocfft_status_invalid_distance);
+    // padded rows and batches are fine
+    EXPECT_EQ(create({1, 65}, 65 * 64 + 3), rocfft_status_success);
+}
+
 // Check whether logs can be emitted from multiple threads properly
 TEST(rocfft_UnitTest, log_multithreading)
 {
@@ -153,6 +200,73 @@ TEST(rocfft_UnitTest, log_multithreading)
     }
 }
 
+TEST(rocfft_UnitTest, log_events)
+{
+    static const char* EVENTS_FILE = "events.json";
+
+    // clean up environment and temporary file when we exit
+    BOOST_SCOPE_EXIT_ALL(=)
+    {
+        rocfft_cleanup();
+        remove(EVENTS_FILE);
+        // re-init logs with default logging
+        rocfft_setup();
+    };
+
+    rocfft_cleanup();
+    EnvironmentSetTemp layer("ROCFFT_LAYER", "64");
+    EnvironmentSetTemp eventspath("ROCFFT_LOG_EVENTS_PATH", EVENTS_FILE);
+
+    rocfft_setup();
+
+    size_t      length = 8191;
+    rocfft_plan plan   = nullptr;
+    ASSERT_EQ(rocfft_plan_create(&plan,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 1,
+                                 nullptr),
+              rocfft_status_success);
+
+    gpubuf data_device;
+    ASSERT_EQ(data_device.alloc(length * sizeof(rocfft_complex<float>)), hipSuccess);
+    void* data_ptr = data_device.data();
+    ASSERT_EQ(rocfft_execute(plan, &data_ptr, nullptr, nullptr), rocfft_status_success);
+    ASSERT_EQ(hipDeviceSynchronize(), hipSuccess);
+    rocfft_plan_destroy(plan);
+
+    rocfft_cleanup();
+
+    // the trace is a JSON array with one event per line
+    std::ifstream events_log(EVENTS_FILE);
+    std::string   line;
+    ASSERT_TRUE(std::getline(events_log, line));
+    ASSERT_EQ(line, "[");
+
+    std::regex event_line(R"(^\{"name":".*","cat":"([a-z_]+)","ph":"[Xi]",.*\}\}(,)?$)");
+
+    std::set<std::string> categories;
+    bool                  closed = false;
+    while(std::getline(events_log, line))
+    {
+        if(line == "]")
+        {
+            closed = true;
+            continue;
+        }
+        ASSERT_FALSE(closed) << "event after end of trace: " << line;
+        std::smatch match;
+        ASSERT_TRUE(std::regex_match(line, match, event_line)) << "invalid event: " << line;
+        categories.insert(match[1]);
+    }
+    ASSERT_TRUE(closed);
+    for(const char* expected : {"plan_create", "plan_stage", "execute", "kernel_launch"})
+        ASSERT_EQ(categories.count(expected), 1U) << "no " << expected << " events";
+}
+
 // a function that accepts a plan's requested size on input, and
 // returns the size to actually allocate for the test
 typedef std::function<size_t(size_t)> workmem_sizer;
@@ -248,6 +362,388 @@ TEST(rocfft_UnitTest, workmem_null)
     workmem_test([](size_t requested) { return requested; }, rocfft_status_success, true);
 }
 
+// cap the work buffer of a batched transform so that it must be
+// executed in chunks, and check that it gives the same results as
+// the uncapped plan
+TEST(rocfft_UnitTest, workmem_capped)
+{
+    // Prime size requires Bluestein, which guarantees work memory.
+    // Use a batch that doesn't divide evenly into chunks.
+    size_t       length = 8191;
+    const size_t batch  = 7;
+
+    rocfft_plan plan = nullptr;
+    ASSERT_EQ(rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 batch,
+                                 nullptr),
+              rocfft_status_success);
+    size_t full_work_size = 0;
+    ASSERT_EQ(rocfft_plan_get_work_buffer_size(plan, &full_work_size), rocfft_status_success);
+    ASSERT_GT(full_work_size, 0U);
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_plan_description_create(&desc), rocfft_status_success);
+    const size_t max_work_size = full_work_size / 3;
+    ASSERT_EQ(rocfft_plan_description_set_max_work_buffer_size(desc, max_work_size),
+              rocfft_status_success);
+
+    rocfft_plan capped_plan = nullptr;
+    ASSERT_EQ(rocfft_plan_create(&capped_plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 batch,
+                                 desc),
+              rocfft_status_success);
+    size_t capped_work_size = 0;
+    ASSERT_EQ(rocfft_plan_get_work_buffer_size(capped_plan, &capped_work_size),
+              rocfft_status_success);
+    ASSERT_LE(capped_work_size, max_work_size);
+
+    std::vector<rocfft_complex<float>> data_host(length * batch);
+    for(size_t i = 0; i < data_host.size(); ++i)
+        data_host[i] = rocfft_complex<float>(i % 13, i % 7);
+    const auto data_size_bytes = data_host.size() * sizeof(rocfft_complex<float>);
+
+    gpubuf in_device;
+    ASSERT_EQ(in_device.alloc(data_size_bytes), hipSuccess);
+
+    // run a plan and return its output
+    auto run = [&](rocfft_plan p) {
+        EXPECT_EQ(
+            hipMemcpy(in_device.data(), data_host.data(), data_size_bytes, hipMemcpyHostToDevice),
+            hipSuccess);
+        gpubuf out_device;
+        EXPECT_EQ(out_device.alloc(data_size_bytes), hipSuccess);
+        void* in_ptr  = in_device.data();
+        void* out_ptr = out_device.data();
+        EXPECT_EQ(rocfft_execute(p, &in_ptr, &out_ptr, nullptr), rocfft_status_success);
+
+        std::vector<rocfft_complex<float>> out_host(data_host.size());
+        EXPECT_EQ(
+            hipMemcpy(out_host.data(), out_device.data(), data_size_bytes, hipMemcpyDeviceToHost),
+            hipSuccess);
+        return out_host;
+    };
+    auto full_output   = run(plan);
+    auto capped_output = run(capped_plan);
+
+    for(size_t i = 0; i < full_output.size(); ++i)
+    {
+        ASSERT_NEAR(full_output[i].x, capped_output[i].x, 1e-3 * std::abs(full_output[i].x) + 1e-3)
+            << "index " << i;
+        ASSERT_NEAR(full_output[i].y, capped_output[i].y, 1e-3 * std::abs(full_output[i].y) + 1e-3)
+            << "index " << i;
+    }
+
+    // a cap that's too small for even one transform fails plan creation
+    rocfft_plan tiny_plan = nullptr;
+    ASSERT_EQ(rocfft_plan_description_set_max_work_buffer_size(desc, 1), rocfft_status_success);
+    ASSERT_EQ(rocfft_plan_create(&tiny_plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 batch,
+                                 desc),
+              rocfft_status_invalid_work_buffer);
+
+    rocfft_plan_destroy(tiny_plan);
+    rocfft_plan_destroy(capped_plan);
+    rocfft_plan_destroy(plan);
+    rocfft_plan_description_destroy(desc);
+}
+
+// run a 2D transform with half-precision storage, and check that it
+// matches a single-precision transform of the same (rounded) input
+// to within half-precision accuracy
+TEST(rocfft_UnitTest, storage_half)
+{
+    std::vector<size_t> lengths = {64, 96};
+    const size_t        batch   = 3;
+    const size_t        count   = lengths[0] * lengths[1] * batch;
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_plan_description_create(&desc), rocfft_status_success);
+    ASSERT_EQ(rocfft_plan_description_set_storage_precision(desc, rocfft_storage_precision_half),
+              rocfft_status_success);
+
+    // only single-precision compute is supported with narrower storage
+    rocfft_plan double_plan = nullptr;
+    ASSERT_EQ(rocfft_plan_create(&double_plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_double,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 batch,
+                                 desc),
+              rocfft_status_invalid_arg_value);
+
+    rocfft_plan half_plan = nullptr;
+    ASSERT_EQ(rocfft_plan_create(&half_plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 batch,
+                                 desc),
+              rocfft_status_success);
+    rocfft_plan single_plan = nullptr;
+    ASSERT_EQ(rocfft_plan_create(&single_plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 batch,
+                                 nullptr),
+              rocfft_status_success);
+
+    // input values are exactly representable in half precision, so
+    // both transforms see the same input
+    std::vector<rocfft_complex<float>>    single_in(count);
+    std::vector<rocfft_complex<_Float16>> half_in(count);
+    for(size_t i = 0; i < count; ++i)
+    {
+        single_in[i] = rocfft_complex<float>((i % 13) / 8.0f - 0.75f, (i % 7) / 4.0f - 0.75f);
+        half_in[i]
+            = rocfft_complex<_Float16>(_Float16(single_in[i].x), _Float16(single_in[i].y));
+    }
+
+    // run a plan on host input and return its output
+    auto run = [](rocfft_plan p, const auto& in_host) {
+        using T                      = typename std::decay_t<decltype(in_host)>::value_type;
+        const size_t data_size_bytes = in_host.size() * sizeof(T);
+
+        gpubuf in_device;
+        gpubuf out_device;
+        EXPECT_EQ(in_device.alloc(data_size_bytes), hipSuccess);
+        EXPECT_EQ(out_device.alloc(data_size_bytes), hipSuccess);
+        EXPECT_EQ(
+            hipMemcpy(in_device.data(), in_host.data(), data_size_bytes, hipMemcpyHostToDevice),
+            hipSuccess);
+
+        size_t work_size = 0;
+        EXPECT_EQ(rocfft_plan_get_work_buffer_size(p, &work_size), rocfft_status_success);
+        gpubuf                work_device;
+        rocfft_execution_info info = nullptr;
+        EXPECT_EQ(rocfft_execution_info_create(&info), rocfft_status_success);
+        if(work_size)
+        {
+            EXPECT_EQ(work_device.alloc(work_size), hipSuccess);
+            EXPECT_EQ(rocfft_execution_info_set_work_buffer(info, work_device.data(), work_size),
+                      rocfft_status_success);
+        }
+
+        void* in_ptr  = in_device.data();
+        void* out_ptr = out_device.data();
+        EXPECT_EQ(rocfft_execute(p, &in_ptr, &out_ptr, info), rocfft_status_success);
+        rocfft_execution_info_destroy(info);
+
+        std::vector<T> out_host(in_host.size());
+        EXPECT_EQ(
+            hipMemcpy(out_host.data(), out_device.data(), data_size_bytes, hipMemcpyDeviceToHost),
+            hipSuccess);
+        return out_host;
+    };
+    auto single_out = run(single_plan, single_in);
+    auto half_out   = run(half_plan, half_in);
+
+    // compare relative to the largest output, since half precision
+    // has about 3 significant digits and rounds every intermediate
+    float max_mag = 0.0f;
+    for(const auto& v : single_out)
+        max_mag = std::max(max_mag, std::max(std::abs(v.x), std::abs(v.y)));
+    const float tol = 1e-2f * max_mag;
+    for(size_t i = 0; i < count; ++i)
+    {
+        ASSERT_NEAR(single_out[i].x, static_cast<float>(half_out[i].x), tol) << "index " << i;
+        ASSERT_NEAR(single_out[i].y, static_cast<float>(half_out[i].y), tol) << "index " << i;
+    }
+
+    rocfft_plan_destroy(single_plan);
+    rocfft_plan_destroy(half_plan);
+    rocfft_plan_description_destroy(desc);
+}
+
+// run a batched 2D transform with host execution, and check that it
+// matches the same transform run on the device
+TEST(rocfft_UnitTest, host_execution)
+{
+    std::vector<size_t> lengths = {30, 64};
+    const size_t        batch   = 3;
+    const size_t        count   = lengths[0] * lengths[1] * batch;
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_plan_description_create(&desc), rocfft_status_success);
+    ASSERT_EQ(rocfft_plan_description_set_execution_target(desc, rocfft_execution_target_host),
+              rocfft_status_success);
+
+    // host execution only supports single and double precision
+    rocfft_plan half_plan = nullptr;
+    ASSERT_EQ(rocfft_plan_create(&half_plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_half,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 batch,
+                                 desc),
+              rocfft_status_invalid_arg_value);
+
+    rocfft_plan host_plan = nullptr;
+    ASSERT_EQ(rocfft_plan_create(&host_plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_double,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 batch,
+                                 desc),
+              rocfft_status_success);
+    rocfft_plan device_plan = nullptr;
+    ASSERT_EQ(rocfft_plan_create(&device_plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_double,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 batch,
+                                 nullptr),
+              rocfft_status_success);
+
+    std::vector<rocfft_complex<double>> in_host(count);
+    for(size_t i = 0; i < count; ++i)
+        in_host[i] = rocfft_complex<double>((i % 13) / 8.0 - 0.75, (i % 7) / 4.0 - 0.75);
+    const size_t data_size_bytes = count * sizeof(rocfft_complex<double>);
+
+    // host plan reads and writes host memory, and allocates its own
+    // work buffer
+    std::vector<rocfft_complex<double>> host_in = in_host;
+    std::vector<rocfft_complex<double>> host_out(count);
+    void*                               in_ptr  = host_in.data();
+    void*                               out_ptr = host_out.data();
+    ASSERT_EQ(rocfft_execute(host_plan, &in_ptr, &out_ptr, nullptr), rocfft_status_success);
+
+    gpubuf in_device;
+    gpubuf out_device;
+    ASSERT_EQ(in_device.alloc(data_size_bytes), hipSuccess);
+    ASSERT_EQ(out_device.alloc(data_size_bytes), hipSuccess);
+    ASSERT_EQ(hipMemcpy(in_device.data(), in_host.data(), data_size_bytes, hipMemcpyHostToDevice),
+              hipSuccess);
+    in_ptr  = in_device.data();
+    out_ptr = out_device.data();
+    ASSERT_EQ(rocfft_execute(device_plan, &in_ptr, &out_ptr, nullptr), rocfft_status_success);
+    std::vector<rocfft_complex<double>> device_out(count);
+    ASSERT_EQ(
+        hipMemcpy(device_out.data(), out_device.data(), data_size_bytes, hipMemcpyDeviceToHost),
+        hipSuccess);
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        ASSERT_NEAR(device_out[i].x, host_out[i].x, 1e-9) << "index " << i;
+        ASSERT_NEAR(device_out[i].y, host_out[i].y, 1e-9) << "index " << i;
+    }
+
+    rocfft_plan_destroy(host_plan);
+    rocfft_plan_destroy(device_plan);
+    rocfft_plan_description_destroy(desc);
+}
+
+// time the kernels of a plan executed on a user stream
+TEST(rocfft_UnitTest, kernel_timing)
+{
+    // Prime size requires Bluestein, which needs several kernels
+    size_t       length = 8191;
+    const size_t batch  = 4;
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_plan_description_create(&desc), rocfft_status_success);
+    ASSERT_EQ(rocfft_plan_description_set_kernel_timing(desc, 1), rocfft_status_success);
+
+    rocfft_plan plan = nullptr;
+    ASSERT_EQ(rocfft_plan_create(&plan,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 batch,
+                                 desc),
+              rocfft_status_success);
+
+    // nothing is timed before the plan is executed
+    size_t count = 1;
+    ASSERT_EQ(rocfft_plan_get_kernel_timing_count(plan, &count), rocfft_status_success);
+    ASSERT_EQ(count, 0U);
+
+    hipStream_t stream = nullptr;
+    ASSERT_EQ(hipStreamCreate(&stream), hipSuccess);
+    rocfft_execution_info info = nullptr;
+    ASSERT_EQ(rocfft_execution_info_create(&info), rocfft_status_success);
+    ASSERT_EQ(rocfft_execution_info_set_stream(info, stream), rocfft_status_success);
+
+    gpubuf data_device;
+    ASSERT_EQ(data_device.alloc(length * batch * sizeof(rocfft_complex<float>)), hipSuccess);
+    void* data_ptr = data_device.data();
+
+    // execute more times than events are kept in flight, without
+    // waiting in between
+    for(size_t i = 0; i < 20; ++i)
+        ASSERT_EQ(rocfft_execute(plan, &data_ptr, nullptr, info), rocfft_status_success);
+
+    ASSERT_EQ(rocfft_plan_get_kernel_timing_count(plan, &count), rocfft_status_success);
+    ASSERT_GT(count, 1U);
+    for(size_t i = 0; i < count; ++i)
+    {
+        float  duration_ms        = 0.0f;
+        size_t size_in_bytes      = 0;
+        float  bandwidth_GB_per_s = 0.0f;
+        ASSERT_EQ(rocfft_plan_get_kernel_timing(
+                      plan, i, &duration_ms, &size_in_bytes, &bandwidth_GB_per_s),
+                  rocfft_status_success);
+        ASSERT_GT(duration_ms, 0.0f) << "kernel " << i;
+        ASSERT_GT(size_in_bytes, 0U) << "kernel " << i;
+        ASSERT_NEAR(bandwidth_GB_per_s,
+                    size_in_bytes / (1000000.0 * duration_ms),
+                    1e-3 * bandwidth_GB_per_s)
+            << "kernel " << i;
+    }
+    ASSERT_EQ(rocfft_plan_get_kernel_timing(plan, count, nullptr, nullptr, nullptr),
+              rocfft_status_invalid_arg_value);
+
+    // timing isn't supported for plans that don't launch kernels
+    // themselves
+    rocfft_plan host_plan = nullptr;
+    ASSERT_EQ(rocfft_plan_description_set_execution_target(desc, rocfft_execution_target_host),
+              rocfft_status_success);
+    ASSERT_EQ(rocfft_plan_create(&host_plan,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 batch,
+                                 desc),
+              rocfft_status_invalid_arg_value);
+
+    rocfft_plan_destroy(host_plan);
+    rocfft_execution_info_destroy(info);
+    rocfft_plan_destroy(plan);
+    rocfft_plan_description_destroy(desc);
+    (void)hipStreamDestroy(stream);
+}
+
 #ifdef ROCFFT_RUNTIME_COMPILE
 static const size_t RTC_PROBLEM_SIZE = 2304;
 // runtime compilation cache tests
@@ -40,7 +40,18 @@ inline auto generate_valid_length_stride()
         {{8, 8, 8, 8, 8}, {4096, 512, 64, 7, 1}},
         {{8, 8, 8, 8, 8, 8}, {32768, 4096, 512, 64, 8, 1}},
         {{299, 307, 495}, {1006, 50, 674}},
-
+        // strides that are mixed-radix digits without being packed
+        {{3, 2}, {2, 5}},
+        {{8, 8, 8}, {1, 9, 71}},
+        // colliding strides
+        {{8, 8}, {1, 4}},
+        {{8, 8, 8}, {1, 8, 32}},
+        {{4, 6, 4}, {3, 2, 7}},
+        {{3, 4, 3, 4}, {26, 25, 15, 16}},
+        {{2, 3, 7, 3}, {18, 5, 11, 12}},
+        // undecided analytically
+        {{3, 3, 5}, {2, 3, 7}},
+        {{5, 5, 5, 5}, {1, 7, 11, 13}},
     };
 
     return vals;
@@ -121,3 +132,35 @@ TEST_P(valid_length_stride, direct_comparison)
 INSTANTIATE_TEST_SUITE_P(reference_test,
                          valid_length_stride,
                          ::testing::ValuesIn(generate_valid_length_stride()));
+
+// The analytic check must agree with direct enumeration whenever it
+// claims to know the answer.
+TEST(array_validator, analytic_random)
+{
+    std::mt19937                          gen(0);
+    std::uniform_int_distribution<size_t> dim_dis(1, 4);
+    std::uniform_int_distribution<size_t> length_dis(1, 7);
+    std::uniform_int_distribution<size_t> stride_dis(0, 30);
+
+    size_t undecided = 0;
+    for(size_t i = 0; i < 10000; ++i)
+    {
+        std::vector<size_t> length(dim_dis(gen));
+        std::vector<size_t> stride(length.size());
+        for(size_t d = 0; d < length.size(); ++d)
+        {
+            length[d] = length_dis(gen);
+            stride[d] = stride_dis(gen);
+        }
+
+        const auto analytic = array_overlap_analytic(length, stride);
+        const auto ref_val  = direct_validity_test(length, stride, verbose);
+        if(analytic == array_overlap::unknown)
+            ++undecided;
+        else
+            EXPECT_EQ(analytic == array_overlap::none, ref_val);
+        EXPECT_EQ(array_valid(length, stride, verbose), ref_val);
+    }
+    if(verbose)
+        std::cout << "undecided: " << undecided << "\n";
+}
@@ -0,0 +1,233 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Benchmark the functions that compare FFT results against the
+// reference: the general strided distance/norm loops against the
+// blocked fast paths for unit-stride data.
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../../shared/fft_params.h"
+#include <boost/program_options.hpp>
+namespace po = boost::program_options;
+
+// Time ntrial calls of f, returning the median time in milliseconds
+// and the result of the last call.
+template <typename Tfunc>
+static double time_ms(const int ntrial, Tfunc&& f, VectorNorms& result)
+{
+    std::vector<double> times;
+    for(int i = 0; i < ntrial; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        result     = f();
+        auto end   = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+static void print_result(const char*        name,
+                         const double       strided_ms,
+                         const double       blocked_ms,
+                         const VectorNorms& strided,
+                         const VectorNorms& blocked)
+{
+    std::cout << std::setw(10) << name << std::fixed << std::setprecision(3) << std::setw(12)
+              << strided_ms << std::setw(12) << blocked_ms << std::setw(9) << std::setprecision(2)
+              << strided_ms / blocked_ms << "x" << std::scientific << std::setprecision(3)
+              << std::setw(12) << std::abs(strided.l_2 - blocked.l_2) / blocked.l_2
+              << std::setw(12) << std::abs(strided.l_inf - blocked.l_inf) << std::endl;
+}
+
+template <typename Tfloat, typename Tint>
+static void run_bench(const Tint&  length,
+                      const Tint&  stride,
+                      const size_t dist,
+                      const size_t nbatch,
+                      const int    ntrial)
+{
+    // two buffers that differ by a small amount, like an FFT result
+    // and its reference
+    const size_t                       size = dist * nbatch;
+    std::vector<rocfft_complex<Tfloat>> a(size);
+    std::vector<rocfft_complex<Tfloat>> b(size);
+    std::mt19937                        gen(0);
+    std::uniform_real_distribution<>    dis(-1.0, 1.0);
+    for(size_t i = 0; i < size; ++i)
+    {
+        a[i] = rocfft_complex<Tfloat>(dis(gen), dis(gen));
+        b[i] = rocfft_complex<Tfloat>(a[i].real() + dis(gen) * 1e-3, a[i].imag());
+    }
+
+    const std::vector<size_t>              offset = {0, 0};
+    std::vector<std::pair<size_t, size_t>> linf_failures;
+    const double                           linf_cutoff = 1.0;
+
+    VectorNorms strided, blocked;
+
+    std::cout << std::setw(10) << "" << std::setw(12) << "strided ms" << std::setw(12)
+              << "blocked ms" << std::setw(10) << "speedup" << std::setw(12) << "l2 reldiff"
+              << std::setw(12) << "linf diff" << std::endl;
+
+    auto strided_ms = time_ms(
+        ntrial,
+        [&]() {
+            return norm_complex_strided(a.data(), length, nbatch, stride, dist, offset);
+        },
+        strided);
+    auto blocked_ms = time_ms(
+        ntrial,
+        [&]() { return norm_complex(a.data(), length, nbatch, stride, dist, offset); },
+        blocked);
+    print_result("norm", strided_ms, blocked_ms, strided, blocked);
+
+    strided_ms = time_ms(
+        ntrial,
+        [&]() {
+            return distance_1to1_complex_strided(a.data(),
+                                                 b.data(),
+                                                 length,
+                                                 nbatch,
+                                                 stride,
+                                                 dist,
+                                                 stride,
+                                                 dist,
+                                                 linf_failures,
+                                                 linf_cutoff,
+                                                 offset,
+                                                 offset);
+        },
+        strided);
+    blocked_ms = time_ms(
+        ntrial,
+        [&]() {
+            return distance_1to1_complex(a.data(),
+                                         b.data(),
+                                         length,
+                                         nbatch,
+                                         stride,
+                                         dist,
+                                         stride,
+                                         dist,
+                                         linf_failures,
+                                         linf_cutoff,
+                                         offset,
+                                         offset);
+        },
+        blocked);
+    print_result("distance", strided_ms, blocked_ms, strided, blocked);
+}
+
+template <typename Tfloat>
+static void run_bench(const std::vector<size_t>& length,
+                      const std::vector<size_t>& stride,
+                      const size_t               dist,
+                      const size_t               nbatch,
+                      const int                  ntrial)
+{
+    switch(length.size())
+    {
+    case 1:
+        run_bench<Tfloat>(length[0], stride[0], dist, nbatch, ntrial);
+        break;
+    case 2:
+        run_bench<Tfloat>(std::make_tuple(length[0], length[1]),
+                          std::make_tuple(stride[0], stride[1]),
+                          dist,
+                          nbatch,
+                          ntrial);
+        break;
+    case 3:
+        run_bench<Tfloat>(std::make_tuple(length[0], length[1], length[2]),
+                          std::make_tuple(stride[0], stride[1], stride[2]),
+                          dist,
+                          nbatch,
+                          ntrial);
+        break;
+    default:
+        abort();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // Number of timed repetitions of each function
+    int ntrial{};
+
+    fft_precision       precision = fft_precision_single;
+    std::vector<size_t> length;
+    size_t              nbatch{};
+
+    // Padding added to the innermost row pitch, so that rows are
+    // contiguous but the batch isn't.
+    size_t pad{};
+
+    // clang-format doesn't handle boost program options very well:
+    // clang-format off
+    po::options_description opdesc("rocfft result verification benchmark options");
+    opdesc.add_options()("help,h", "produces this help message")
+        ("ntrial,N", po::value<int>(&ntrial)->default_value(5), "Trial size for the problem")
+        ("precision", po::value<fft_precision>(&precision),
+         "Data precision: single (default), double, half")
+        ("length",  po::value<std::vector<size_t>>(&length)->multitoken(), "Lengths.")
+        ("batchSize,b", po::value<size_t>(&nbatch)->default_value(1), "Number of arrays")
+        ("pad", po::value<size_t>(&pad)->default_value(0), "Padding after each innermost row");
+    // clang-format on
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, opdesc), vm);
+    po::notify(vm);
+
+    if(vm.count("help") || length.empty() || length.size() > 3)
+    {
+        std::cout << opdesc << std::endl;
+        return vm.count("help") ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // row-major strides, with the innermost rows optionally padded
+    std::vector<size_t> stride(length.size(), 1);
+    size_t              dist = length.back() + (length.size() > 1 ? pad : 0);
+    for(size_t i = length.size() - 1; i > 0; --i)
+    {
+        stride[i - 1] = dist;
+        dist *= length[i - 1];
+    }
+
+    switch(precision)
+    {
+    case fft_precision_half:
+        run_bench<_Float16>(length, stride, dist, nbatch, ntrial);
+        break;
+    case fft_precision_single:
+        run_bench<float>(length, stride, dist, nbatch, ntrial);
+        break;
+    case fft_precision_double:
+        run_bench<double>(length, stride, dist, nbatch, ntrial);
+        break;
+    }
+    return EXIT_SUCCESS;
+}
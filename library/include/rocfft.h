@@ -87,6 +87,32 @@ typedef enum rocfft_precision_e
     rocfft_precision_half,
 } rocfft_precision;
 
+/*! @brief Storage precision
+ *  @details Declares the type of the numbers kept in input, output
+ *  and work buffers, when it differs from the precision that the
+ *  transform computes in.
+*/
+typedef enum rocfft_storage_precision_e
+{
+    /// buffers hold numbers of the plan's precision
+    rocfft_storage_precision_native,
+    /// buffers hold IEEE half-precision numbers
+    rocfft_storage_precision_half,
+    /// buffers hold bfloat16 numbers
+    rocfft_storage_precision_bfloat16,
+} rocfft_storage_precision;
+
+/*! @brief Execution target
+ *  @details Declares where a plan's kernels run.
+*/
+typedef enum rocfft_execution_target_e
+{
+    /// kernels run on the current device
+    rocfft_execution_target_device,
+    /// kernels run on the host CPU
+    rocfft_execution_target_host,
+} rocfft_execution_target;
+
 /*! @brief Result placement
  *  @details Declares where the output of the transform should be
  *  placed.  Note that input buffers may still be overwritten
@@ -148,6 +174,10 @@ ROCFFT_EXPORT rocfft_status rocfft_cleanup();
  *  more detailed transforms. For simple transforms, this parameter
  *  can be set to NULL.
  *
+ *  Plan creation fails with ::rocfft_status_invalid_strides or
+ *  ::rocfft_status_invalid_distance if the output strides or
+ *  distance would make two output elements share a location.
+ *
  *  The plan must be destroyed with a call to ::rocfft_plan_destroy.
  *
  *  @param[out] plan plan handle
@@ -221,6 +251,173 @@ ROCFFT_EXPORT rocfft_status rocfft_plan_destroy(rocfft_plan plan);
 ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_scale_factor(
     rocfft_plan_description description, const double scale_factor);
 
+/*! @brief Set maximum work buffer size.
+ *  @details Limits the work buffer that a plan requires to at most
+ *  the given number of bytes.  If a transform of the whole batch
+ *  would need more work memory than that, the plan executes the
+ *  batch in smaller chunks, one after another, reusing a single work
+ *  buffer.  ::rocfft_plan_get_work_buffer_size reports the capped
+ *  size.
+ *
+ *  Plan creation fails with ::rocfft_status_invalid_work_buffer if
+ *  even a single transform needs more work memory than the limit.
+ *
+ *  Load and store callbacks are not supported by plans that execute
+ *  in chunks.
+ *
+ *  @param[in] description description handle
+ *  @param[in] max_bytes maximum work buffer size in bytes, or 0 for no limit
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_max_work_buffer_size(
+    rocfft_plan_description description, const size_t max_bytes);
+
+/*! @brief Stream host-resident data through the device.
+ *  @details Requests a plan whose input and output buffers are in
+ *  host memory rather than device memory, for data that may be
+ *  larger than the device.  The plan copies the data to the device
+ *  a chunk at a time, transforms it, and copies it back, using at
+ *  most the given number of bytes of device memory.  Copies and
+ *  transforms of consecutive chunks overlap on several streams.
+ *  Host buffers should be pinned (e.g. allocated with hipHostMalloc)
+ *  for copies to overlap.
+ *
+ *  Batched transforms are streamed a group of transforms at a time.
+ *  A 2D transform that does not fit on the device is streamed as a
+ *  pass over its rows followed by a pass over its columns, and
+ *  requires unit stride along the fastest dimension.  A 1D complex
+ *  transform that does not fit is split into two passes of shorter
+ *  transforms, with twiddle multiplication in between.  That
+ *  requires a not in-place transform with unit strides, a length
+ *  that is not prime, and runtime compilation.  1D real-complex
+ *  transforms that do not fit are not supported.
+ *
+ *  Execution is asynchronous on the stream given in the execution
+ *  info, as with device-resident data.  Chunks run on streams of the
+ *  plan's own, which wait for earlier work on the given stream, and
+ *  later work on the given stream waits for them.  Any work buffer
+ *  given in the execution info is ignored.
+ *
+ *  Plan creation fails with ::rocfft_status_invalid_array_type for
+ *  planar data, and ::rocfft_status_invalid_arg_value if the
+ *  transform cannot be split to fit the budget.  Load and store
+ *  callbacks are not supported.
+ *
+ *  @param[in] description description handle
+ *  @param[in] max_device_bytes device memory budget in bytes, or 0
+ *  for data that is already on the device
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_streaming(
+    rocfft_plan_description description, const size_t max_device_bytes);
+
+/*! @brief Set storage precision.
+ *  @details Requests a mixed-precision plan, whose input, output and
+ *  work buffers hold numbers of the given storage precision, while
+ *  butterflies and twiddle multiplication run in the plan's
+ *  precision.  Values are converted as they are loaded from and
+ *  stored to memory, so memory traffic matches the storage
+ *  precision.  Intermediate results kept in buffers between kernels
+ *  are also rounded to the storage precision.
+ *
+ *  Strides, distances, offsets and buffer sizes are all counted in
+ *  elements of the storage precision.
+ *
+ *  Half and bfloat16 storage require a ::rocfft_precision_single
+ *  plan; plan creation fails with ::rocfft_status_invalid_arg_value
+ *  for other precisions.  Transform sizes that need Bluestein's
+ *  algorithm are not supported, and neither are load and store
+ *  callbacks.
+ *
+ *  @param[in] description description handle
+ *  @param[in] storage storage precision
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_storage_precision(
+    rocfft_plan_description description, const rocfft_storage_precision storage);
+
+/*! @brief Set execution target.
+ *  @details Selects where the kernels of a plan run.  A plan for
+ *  ::rocfft_execution_target_host is decomposed into the same
+ *  kernels as a device plan, but each kernel is carried out by a
+ *  separate reference implementation on the host CPU, spread over a
+ *  pool of threads.  It is intended for checking device results and
+ *  for systems without a GPU, rather than for performance.  No device
+ *  is needed to create or execute such a plan.
+ *
+ *  Input, output and work buffers given to ::rocfft_execute for a
+ *  host plan must be host memory.  Execution is synchronous, and any
+ *  stream set on the execution info is ignored.
+ *
+ *  Host execution supports single and double precision.  Plan
+ *  creation fails with ::rocfft_status_invalid_arg_value for other
+ *  precisions, or if the description also requests streaming or a
+ *  storage precision.  Load and store callbacks are not supported.
+ *
+ *  The number of threads defaults to the number of CPUs available to
+ *  the process, and can be overridden with the ROCFFT_HOST_THREADS
+ *  environment variable.
+ *
+ *  @param[in] description description handle
+ *  @param[in] target execution target
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_execution_target(
+    rocfft_plan_description description, const rocfft_execution_target target);
+
+/*! @brief Enable kernel timing.
+ *  @details Asks a plan to time each of its kernels whenever it is
+ *  executed, on whichever stream the execution info specifies.
+ *  Events are recorded around the kernels, and ::rocfft_execute does
+ *  not wait for them.  ::rocfft_plan_get_kernel_timing_count and
+ *  ::rocfft_plan_get_kernel_timing wait for executions that are
+ *  still in flight, and report the kernels of the most recent one.
+ *
+ *  Recording the events adds a small overhead to every execution.
+ *  Plan creation fails with ::rocfft_status_invalid_arg_value if
+ *  the description also requests streaming or host execution.
+ *
+ *  @param[in] description description handle
+ *  @param[in] enable nonzero to time kernels
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_kernel_timing(
+    rocfft_plan_description description, const int enable);
+
+/*! @brief Set load and store callbacks as device source code.
+ *  @details Gives a plan the source code of load and store callback
+ *  functions, which are compiled into the plan's kernels when the
+ *  plan is created.  Unlike callback function pointers set on an
+ *  execution info, the callbacks can be inlined into the kernels.
+ *
+ *  The source is device code that defines the callback functions
+ *  and any types they need, such as the struct that their callback
+ *  data points to.  The functions have the same signatures as the
+ *  function pointers described at
+ *  ::rocfft_execution_info_set_load_callback and
+ *  ::rocfft_execution_info_set_store_callback, and are named by
+ *  'load_function' and 'store_function'.  Either name may be null
+ *  if there is no callback of that kind.  A null 'source' clears
+ *  any callback source.
+ *
+ *  The callbacks run on every execution of the plan.  Callback data
+ *  is still set on the execution info, by passing null callback
+ *  functions to ::rocfft_execution_info_set_load_callback or
+ *  ::rocfft_execution_info_set_store_callback.  Executing the plan
+ *  with callback functions fails with
+ *  ::rocfft_status_invalid_arg_value.
+ *
+ *  Plan creation fails with ::rocfft_status_invalid_arg_value if the
+ *  description also requests planar data, narrower storage
+ *  precision, streaming or host execution, and fails with
+ *  ::rocfft_status_failure if the source does not compile.
+ *
+ *  @param[in] description description handle
+ *  @param[in] source device source code of the callbacks
+ *  @param[in] load_function name of the load callback function in the source, or null
+ *  @param[in] store_function name of the store callback function in the source, or null
+ *  */
+ROCFFT_EXPORT rocfft_status
+    rocfft_plan_description_set_callback_source(rocfft_plan_description description,
+                                                const char*             source,
+                                                const char*             load_function,
+                                                const char*             store_function);
+
 /*!
  *  @brief Set advanced data layout parameters on a plan description
  * 
@@ -298,6 +495,43 @@ ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_devices( rocfft_plan_des
 ROCFFT_EXPORT rocfft_status rocfft_plan_get_work_buffer_size(const rocfft_plan plan,
                                                              size_t*           size_in_bytes);
 
+/*! @brief Get number of timed kernels
+ *  @details Waits for all executions of a plan that are still in
+ *  flight, and gets the number of kernels that were timed in the
+ *  most recent one.  The count is 0 if the plan has not been
+ *  executed, or if kernel timing was not enabled with
+ *  ::rocfft_plan_description_set_kernel_timing.
+ *
+ *  If the plan executes its batch in chunks, the kernels of every
+ *  chunk are counted, in the order they ran.
+ *  @param[in] plan plan handle
+ *  @param[out] count number of timed kernels
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_get_kernel_timing_count(const rocfft_plan plan,
+                                                               size_t*           count);
+
+/*! @brief Get timing of a kernel
+ *  @details Gets the time taken by one kernel of the most recent
+ *  execution of a plan, the number of bytes it read and wrote, and
+ *  the bandwidth that it achieved.  Like
+ *  ::rocfft_plan_get_kernel_timing_count, this waits for all
+ *  executions of the plan that are still in flight.
+ *
+ *  Any of the output pointers may be NULL.
+ *  @param[in] plan plan handle
+ *  @param[in] index index of the kernel, less than the count
+ *  returned by ::rocfft_plan_get_kernel_timing_count
+ *  @param[out] duration_ms time taken by the kernel in milliseconds
+ *  @param[out] size_in_bytes bytes read and written by the kernel
+ *  @param[out] bandwidth_GB_per_s size_in_bytes divided by the
+ *  duration, in GB/s
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_get_kernel_timing(const rocfft_plan plan,
+                                                         const size_t      index,
+                                                         float*            duration_ms,
+                                                         size_t*           size_in_bytes,
+                                                         float*            bandwidth_GB_per_s);
+
 /*! @brief Print all plan information
  *  @details Prints plan details to stdout, to aid debugging
  *  @param[in] plan plan handle
@@ -416,12 +650,18 @@ ROCFFT_EXPORT rocfft_status rocfft_execution_info_set_stream(rocfft_execution_in
  *  real-to-complex transform would load single-precision real
  *  elements).
  *
+ *  Planar input is instead loaded by callbacks with the following
+ *  signature, where 'Treal' is the real type of the input and 'T2'
+ *  is the matching complex type:
+ *
+ *  @code
+ *  T2 load_cb(Treal* real, Treal* imag, size_t offset, void* cbdata, void* sharedMem);
+ *  @endcode
+ *
  *  A null value for 'cb' may be specified to clear any previously
  *  registered load callback.
  *
- *  Currently, 'shared_mem_bytes' must be 0.  Callbacks are not
- *  supported on transforms that use planar formats for either input
- *  or output.
+ *  Currently, 'shared_mem_bytes' must be 0.
  *
  *  @param[in] info execution info handle
  *  @param[in] cb callback function pointers
@@ -456,12 +696,19 @@ ROCFFT_EXPORT rocfft_status rocfft_execution_info_set_load_callback(rocfft_execu
  *  real-to-complex transform would store single-precision complex
  *  elements).
  *
+ *  Planar output is instead stored by callbacks with the following
+ *  signature, where 'Treal' is the real type of the output and 'T2'
+ *  is the matching complex type:
+ *
+ *  @code
+ *  void store_cb(Treal* real, Treal* imag, size_t offset, T2 element,
+ *                void* cbdata, void* sharedMem);
+ *  @endcode
+ *
  *  A null value for 'cb' may be specified to clear any previously
  *  registered store callback.
  *
- *  Currently, 'shared_mem_bytes' must be 0.  Callbacks are not
- *  supported on transforms that use planar formats for either input
- *  or output.
+ *  Currently, 'shared_mem_bytes' must be 0.
  *
  *  @param[in] info execution info handle
  *  @param[in] cb callbacks function pointers
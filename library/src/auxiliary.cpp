@@ -21,12 +21,14 @@
 *******************************************************************************/
 
 #include "../../shared/environment.h"
+#include "event_trace.h"
 #include "logging.h"
 #include "repo.h"
 #include "rocfft.h"
 #include "rocfft_hip.h"
 #include "rocfft_ostream.hpp"
 #include "rtc_cache.h"
+#include <chrono>
 #include <fcntl.h>
 #include <memory>
 
@@ -77,10 +79,15 @@ static void open_log_stream(const char* environment_variable_name, int& log_fd)
 // library setup function, called once in program at the start of library use
 rocfft_status rocfft_setup()
 {
+    // log files aren't open yet, so remember how long each phase
+    // took and log them at the end
+    auto ostream_begin = std::chrono::steady_clock::now();
     rocfft_ostream::setup();
+    auto ostream_end = std::chrono::steady_clock::now();
 
 #ifdef ROCFFT_RUNTIME_COMPILE
-    RTCCache::single = std::make_unique<RTCCache>();
+    // the cache is opened on first use
+    RTCCache::setup();
 #endif
 
     // set layer_mode from value of environment variable ROCFFT_LAYER
@@ -115,9 +122,16 @@ rocfft_status rocfft_setup()
         // open log_rtc file
         if(layer_mode & rocfft_layer_mode_log_rtc)
             open_log_stream("ROCFFT_LOG_RTC_PATH", log_rtc_fd);
+
+        // start writing out binary trace events
+        if(layer_mode & rocfft_layer_mode_log_events)
+            event_trace_setup();
     }
+    auto logging_end = std::chrono::steady_clock::now();
 
     log_trace(__func__);
+    log_startup("ostream_setup", ostream_end - ostream_begin);
+    log_startup("logging_setup", logging_end - ostream_end);
     return rocfft_status_success;
 }
 
@@ -130,7 +144,7 @@ rocfft_status rocfft_cleanup()
     // rocfft_setup() + plan creation will start from scratch
     Repo::Clear();
 #ifdef ROCFFT_RUNTIME_COMPILE
-    RTCCache::single.reset();
+    RTCCache::cleanup();
 #endif
 
     LogSingleton::GetInstance().SetLayerMode(rocfft_layer_mode_none);
@@ -165,6 +179,8 @@ rocfft_status rocfft_cleanup()
         CLOSE(log_rtc_fd);
         log_rtc_fd = -1;
     }
+    // write out the rest of the trace events
+    event_trace_cleanup();
 
     // stop all log worker threads
     rocfft_ostream::cleanup();
@@ -754,8 +754,16 @@ public:
         , cbtype(cbtype){};
     std::string scalar_type;
     std::string cbtype;
+    // if set, global memory holds this type instead of scalar_type,
+    // and loads/stores convert between them.  user callbacks are
+    // not supported in that case.
+    std::string storage_type;
     std::string render() const
     {
+        if(!storage_type.empty())
+            return "auto load_cb = load_cb_storage<" + scalar_type + ", " + storage_type + ">;\n"
+                   + "auto store_cb = store_cb_storage<" + scalar_type + ", " + storage_type
+                   + ">;\n";
         return "auto load_cb = get_load_cb<" + scalar_type + ", " + cbtype + ">(load_cb_fn);\n"
                + "auto store_cb = get_store_cb<" + scalar_type + ", " + cbtype
                + ">(store_cb_fn);\n";
@@ -877,16 +885,25 @@ public:
                       const Variable&                  imagPtr,
                       const Expression&                index,
                       const Variable&                  value,
-                      const std::optional<Expression>& scale_factor)
+                      const std::optional<Expression>& scale_factor,
+                      bool                             callbacks = false)
         : realPtr{realPtr}
         , imagPtr{imagPtr}
         , index{index}
         , value{value}
         , scale_factor{scale_factor}
+        , callbacks{callbacks}
     {
     }
     std::string render() const
     {
+        // Store through the planar callback, which gets both halves
+        // of the element at once
+        if(callbacks)
+            return "store_planar<cbtype>(" + realPtr.render() + "," + imagPtr.render() + ","
+                   + vrender(index) + ","
+                   + vrender(scale_factor ? (value * scale_factor.value()) : Expression{value})
+                   + ", store_cb_fn, store_cb_data, nullptr);";
         // Output two assignments
         return Assign{realPtr[index],
                       scale_factor ? Expression{value.x() * scale_factor.value()}
@@ -903,6 +920,8 @@ public:
     Expression                index;
     Variable                  value;
     std::optional<Expression> scale_factor;
+    // store through a planar user callback instead of directly
+    bool callbacks;
 };
 
 class Butterfly
@@ -1319,7 +1338,8 @@ struct BaseVisitor
         std::optional<Expression> scale_factor;
         if(x.scale_factor)
             scale_factor = std::visit(*this, x.scale_factor.value());
-        return StatementList{StoreGlobalPlanar(realPtr, imagPtr, index, value, scale_factor)};
+        return StatementList{
+            StoreGlobalPlanar(realPtr, imagPtr, index, value, scale_factor, x.callbacks)};
     }
 
     virtual Function visit_Function(const Function& x)
@@ -1341,6 +1361,9 @@ struct BaseVisitor
 struct MakePlanarVisitor : public BaseVisitor
 {
     std::string varname, rename, imname;
+    // global memory holds numbers of the compute precision, so loads
+    // and stores can go through user callbacks
+    bool callbacks = false;
 
     MakePlanarVisitor(const std::string& varname)
         : varname(varname)
@@ -1373,6 +1396,12 @@ struct MakePlanarVisitor : public BaseVisitor
         return y;
     }
 
+    StatementList visit_CallbackDeclaration(const CallbackDeclaration& x) override
+    {
+        callbacks = x.storage_type.empty();
+        return {x};
+    }
+
     StatementList visit_Assign(const Assign& x) override
     {
         StatementList stmts;
@@ -1407,8 +1436,8 @@ struct MakePlanarVisitor : public BaseVisitor
             stmts += Assign{x.lhs, ComplexLiteral{re, im}, x.oper};
             return stmts;
         }
-        // callbacks don't support planar, so loads are just direct
-        // memory accesses
+        // loads go through the planar callback, or are direct memory
+        // accesses if buffers hold a different storage type
         else if(std::holds_alternative<LoadGlobal>(x.rhs))
         {
             auto load = std::get<LoadGlobal>(x.rhs);
@@ -1422,7 +1451,19 @@ struct MakePlanarVisitor : public BaseVisitor
                 auto im = ptr;
                 im.name = imname;
 
-                stmts += Assign{x.lhs, ComplexLiteral{re[idx], im[idx]}, x.oper};
+                if(callbacks)
+                    stmts += Assign{x.lhs,
+                                    CallExpr{"load_planar",
+                                             TemplateList{Variable{"cbtype", ""}},
+                                             {re,
+                                              im,
+                                              idx,
+                                              Variable{"load_cb_fn", ""},
+                                              Variable{"load_cb_data", ""},
+                                              Literal{"nullptr"}}},
+                                    x.oper};
+                else
+                    stmts += Assign{x.lhs, ComplexLiteral{re[idx], im[idx]}, x.oper};
                 return stmts;
             }
         }
@@ -1455,8 +1496,6 @@ struct MakePlanarVisitor : public BaseVisitor
 
     StatementList visit_StoreGlobal(const StoreGlobal& x) override
     {
-        // callbacks don't support planar, so stores are just direct
-        // memory accesses
         auto var = std::get<Variable>(x.ptr);
 
         if(var.name == varname)
@@ -1467,7 +1506,7 @@ struct MakePlanarVisitor : public BaseVisitor
             im.name = imname;
 
             auto value = std::get<Variable>(x.value);
-            return {StoreGlobalPlanar{re, im, x.index, value, x.scale_factor}};
+            return {StoreGlobalPlanar{re, im, x.index, value, x.scale_factor, callbacks}};
         }
         return StatementList{x};
     }
@@ -1515,6 +1554,67 @@ static Function make_planar(const Function& f, const std::string& varname)
     return visitor(f);
 }
 
+//
+// Make mixed precision
+//
+// Global memory holds storage_type while computation stays in
+// scalar_type.  Buffer arguments and pointers with the given names
+// change type, and the load/store functions convert between the
+// two.
+struct MakeStorageVisitor : public BaseVisitor
+{
+    const std::vector<std::string> buf_names;
+    MakeStorageVisitor(std::vector<std::string>&& buf_names)
+        : buf_names(buf_names)
+    {
+    }
+
+    static std::string storage_type(std::string type)
+    {
+        auto pos = type.find("scalar_type");
+        if(pos != std::string::npos)
+            type.replace(pos, strlen("scalar_type"), "storage_type");
+        return type;
+    }
+
+    Variable storage_var(const Variable& x)
+    {
+        if(std::find(buf_names.begin(), buf_names.end(), x.name) == buf_names.end())
+            return x;
+        Variable y{x};
+        y.type = storage_type(y.type);
+        return y;
+    }
+
+    ArgumentList visit_ArgumentList(const ArgumentList& x) override
+    {
+        ArgumentList y;
+        for(const auto& arg : x.arguments)
+            y.append(storage_var(arg));
+        return y;
+    }
+
+    StatementList visit_Declaration(const Declaration& x) override
+    {
+        Declaration y{x};
+        y.var = storage_var(x.var);
+        return BaseVisitor::visit_Declaration(y);
+    }
+
+    StatementList visit_CallbackDeclaration(const CallbackDeclaration& x) override
+    {
+        CallbackDeclaration y{x};
+        y.storage_type = storage_type(x.scalar_type);
+        return {y};
+    }
+};
+
+static Function make_storage(const Function& f, std::vector<std::string>&& buf_names)
+{
+    auto visitor = MakeStorageVisitor(std::move(buf_names));
+    return visitor(f);
+}
+
 //
 // Make out of place
 //
@@ -54,8 +54,17 @@ int main(int argc, char** _argv)
         argv.push_back(*p);
     }
 
+    // optional leading flag to let the generator replace LDS
+    // exchanges between passes with cross-lane shuffles
+    bool cross_lane_exchange = false;
+    if(!argv.empty() && argv.front() == "--cross-lane-exchange")
+    {
+        cross_lane_exchange = true;
+        argv.erase(argv.begin());
+    }
+
     // expected args:
-    // factors1d <factors2d> precisions threads_per_transform workgroup_size half_lds direct_to_from_reg scheme output_filename
+    // [--cross-lane-exchange] factors1d <factors2d> precisions threads_per_transform workgroup_size half_lds direct_to_from_reg scheme output_filename
     //
     // factors1d, factors2d, precisions and threads_per_transform are
     // comma-separated values, factors2d is only present for
@@ -100,8 +109,9 @@ int main(int argc, char** _argv)
     factors = parse_uints_csv(*arg);
 
     StockhamGeneratorSpecs specs(factors, factors2d, precisions, workgroup_size, scheme);
-    specs.half_lds           = half_lds;
-    specs.direct_to_from_reg = direct_to_from_reg;
+    specs.half_lds            = half_lds;
+    specs.direct_to_from_reg  = direct_to_from_reg;
+    specs.cross_lane_exchange = cross_lane_exchange;
 
     specs.threads_per_transform = threads_per_transform.front();
 
@@ -53,6 +53,10 @@ struct StockhamGeneratorSpecs
     unsigned int threads_per_transform = 0;
     bool         half_lds              = false;
     bool         direct_to_from_reg    = false;
+    // allow the generator to exchange data between passes with
+    // cross-lane shuffles instead of LDS, for passes where that's
+    // possible
+    bool cross_lane_exchange = false;
     // dimension of the kernel - 0 if the generated kernel accepts a
     // 'dim' argument at runtime; otherwise the dimension is
     // statically defined for the kernel
@@ -147,7 +147,13 @@ struct StockhamKernelFused2D : public StockhamKernelRR
 
         // load
         body += LineBreak{};
-        auto rw_iters = length0 * length1 / workgroup_size;
+        auto rw_iters = DivRoundingUp(length0 * length1, workgroup_size);
+        // the last iteration might not need all threads
+        auto guarded = [&](unsigned int i, Statement stmt) -> Statement {
+            if((i + 1) * workgroup_size <= length0 * length1)
+                return stmt;
+            return If{(i * workgroup_size + thread_id) < length0 * length1, {stmt}};
+        };
         body += CommentLines{"load length-" + std::to_string(length0) + " rows using all threads.",
                              "need " + std::to_string(rw_iters) + " iterations to load all "
                                  + std::to_string(length1) + " rows in the slab"};
@@ -158,9 +164,10 @@ struct StockhamKernelFused2D : public StockhamKernelRR
         {
             auto row_offset = Parens{(i * workgroup_size + thread_id) / length0};
             auto col_offset = Parens{(i * workgroup_size + thread_id) % length0};
-            body += Assign{
-                lds_complex[row_offset * length0_padded + col_offset],
-                LoadGlobal{buf, offset + col_offset * stride[0] + row_offset * stride[1]}};
+            body += guarded(
+                i,
+                Assign{lds_complex[row_offset * length0_padded + col_offset],
+                       LoadGlobal{buf, offset + col_offset * stride[0] + row_offset * stride[1]}});
         }
 
         // -------------
@@ -283,9 +290,10 @@ struct StockhamKernelFused2D : public StockhamKernelRR
         {
             auto row_offset = Parens{(i * workgroup_size + thread_id) / length0};
             auto col_offset = Parens{(i * workgroup_size + thread_id) % length0};
-            body += StoreGlobal{buf,
-                                offset + col_offset * stride[0] + row_offset * stride[1],
-                                lds_complex[row_offset * length0_padded + col_offset]};
+            body += guarded(i,
+                            StoreGlobal{buf,
+                                        offset + col_offset * stride[0] + row_offset * stride[1],
+                                        lds_complex[row_offset * length0_padded + col_offset]});
         }
 
         f.qualifier     = "__global__";
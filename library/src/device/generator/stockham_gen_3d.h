@@ -0,0 +1,310 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Like StockhamKernelFused2D, but transforms a whole 3D brick in
+// LDS.  The brick is stored with the fastest dimension padded to
+// avoid bank conflicts, and each dimension is transformed by an RR
+// device function with its own specs.
+struct StockhamKernelFused3D : public StockhamKernelRR
+{
+    StockhamKernelFused3D(const StockhamGeneratorSpecs& specs0,
+                          const StockhamGeneratorSpecs& specs1,
+                          const StockhamGeneratorSpecs& specs2)
+        : StockhamKernelRR(specs0)
+        , kernel0(specs0)
+        , kernel1(specs1)
+        , kernel2(specs2)
+    {
+        auto brick = specs0.length * specs1.length * specs2.length;
+
+        // all rows along one dimension are transformed at once, so
+        // the block needs enough threads for the dimension that uses
+        // the most
+        threads_per_transform = 0;
+        for(auto k : {&kernel0, &kernel1, &kernel2})
+        {
+            threads_per_transform
+                = std::max(threads_per_transform, k->threads_per_transform * brick / k->length);
+            k->writeGuard = true;
+        }
+        // 3D_SINGLE does one 3D brick per workgroup(threadblock)
+        workgroup_size       = threads_per_transform;
+        transforms_per_block = 1;
+        R.size = std::max({kernel0.nregisters, kernel1.nregisters, kernel2.nregisters});
+        // 3D kernels use the per-dimension device functions, so this
+        // writeGuard value is not used and irrelevant
+        writeGuard = true;
+
+        // twiddles for each dimension follow one another in the
+        // table, except that a dimension with the same factors as an
+        // earlier one shares its twiddles.  This must match how the
+        // table is built on the host.
+        auto         all_kernels = kernels();
+        unsigned int table_size  = 0;
+        for(auto k : all_kernels)
+        {
+            auto earlier = std::find_if(all_kernels.begin(), all_kernels.end(), [=](auto other) {
+                return other->factors == k->factors;
+            });
+            if(*earlier != k)
+            {
+                twiddle_offsets.push_back(twiddle_offsets[earlier - all_kernels.begin()]);
+                continue;
+            }
+            twiddle_offsets.push_back(table_size);
+            table_size += k->length - k->factors.front();
+        }
+    }
+
+    StockhamKernelRR kernel0;
+    StockhamKernelRR kernel1;
+    StockhamKernelRR kernel2;
+
+    // offset of each dimension's twiddles in the twiddle table
+    std::vector<unsigned int> twiddle_offsets;
+
+    std::array<StockhamKernelRR*, 3> kernels()
+    {
+        return {&kernel0, &kernel1, &kernel2};
+    }
+
+    std::vector<unsigned int> launcher_lengths() override
+    {
+        return {kernel0.length, kernel1.length, kernel2.length};
+    }
+    std::vector<unsigned int> launcher_factors() override
+    {
+        std::vector<unsigned int> ret;
+        for(auto k : kernels())
+            std::copy(k->factors.begin(), k->factors.end(), std::back_inserter(ret));
+        return ret;
+    }
+
+    std::vector<Expression> device_lds_reg_inout_device_call_arguments() override
+    {
+        return {R, lds_complex, stride_lds, offset_lds, thread_in_device, write};
+    }
+
+    std::vector<Expression> device_call_arguments(unsigned int call_iter) override
+    {
+        return {R,
+                lds_real,
+                lds_complex,
+                twiddles,
+                stride_lds,
+                call_iter ? Expression{offset_lds + call_iter * stride_lds * transforms_per_block}
+                          : Expression{offset_lds},
+                thread_in_device,
+                write};
+    }
+
+    // transform the brick along dimension d.  each row starts at
+    // row_offset in LDS and its elements are row_stride apart.
+    StatementList transform_dimension(unsigned int      d,
+                                      const Expression& row_offset,
+                                      const Expression& row_stride)
+    {
+        auto& kernel     = *kernels()[d];
+        auto  brick      = kernel0.length * kernel1.length * kernel2.length;
+        auto  rows       = brick / kernel.length;
+        auto  active     = kernel.threads_per_transform * rows;
+        auto  sb         = d == 0 ? "SB_UNIT" : "SB_NONUNIT";
+        auto  length_str = std::to_string(kernel.length);
+
+        StatementList stmts;
+        stmts += CommentLines{"", "dimension " + std::to_string(d) + ", length: " + length_str, ""};
+        stmts += LineBreak{};
+        stmts += CommentLines{"each block handles " + std::to_string(rows) + " rows of length "
+                                  + length_str + ".",
+                              "each row needs " + std::to_string(kernel.threads_per_transform)
+                                  + " threads, so " + std::to_string(active)
+                                  + " are active in the block"};
+
+        if(active == workgroup_size)
+            stmts += Assign{write, 1};
+        else
+            stmts += Assign{write, thread_id < active};
+        stmts += Assign{offset_lds, row_offset};
+        stmts += Assign{stride_lds, row_stride};
+        stmts += CommentLines{"calc the thread_in_device value once and for all device funcs"};
+        stmts += Assign{thread_in_device,
+                        Ternary{lds_linear,
+                                thread_id % kernel.threads_per_transform,
+                                thread_id / kernel.transforms_per_block}};
+
+        stmts += LineBreak{};
+        stmts += CommentLines{"call a pre-load from lds to registers (if necessary)"};
+        auto pre_post_lds_tmpl = device_lds_reg_inout_device_call_templates();
+        auto pre_post_lds_args = device_lds_reg_inout_device_call_arguments();
+        pre_post_lds_tmpl.set_value(stride_type.name, sb);
+        stmts += Call{"lds_to_reg_input_length" + length_str + "_device",
+                      pre_post_lds_tmpl,
+                      pre_post_lds_args};
+        stmts += LineBreak{};
+
+        auto templates = device_call_templates();
+        templates.set_value(stride_type.name, sb);
+        auto arguments = device_call_arguments(0);
+        if(twiddle_offsets[d])
+            arguments[3] = twiddles + twiddle_offsets[d];
+        stmts += Call{"forward_length" + length_str + "_SBRR_device", templates, arguments};
+        stmts += LineBreak{};
+
+        stmts += CommentLines{"call a post-store from registers to lds (if necessary)"};
+        stmts += Call{"lds_from_reg_output_length" + length_str + "_device",
+                      pre_post_lds_tmpl,
+                      pre_post_lds_args};
+        stmts += LineBreak{};
+        return stmts;
+    }
+
+    Function generate_global_function() override
+    {
+        auto is_pow2 = [](unsigned int n) { return n != 0 && (n & (n - 1)) == 0; };
+
+        auto length0 = kernel0.length;
+        auto length1 = kernel1.length;
+        auto length2 = kernel2.length;
+        auto brick   = length0 * length1 * length2;
+
+        auto length0_padded = is_pow2(length0) ? (length0 + 1) : length0;
+
+        Function f{"forward_length" + std::to_string(length0) + "x" + std::to_string(length1) + "x"
+                   + std::to_string(length2)};
+
+        StatementList& body = f.body;
+        body += LineBreak{};
+        body += CommentLines{"",
+                             "this kernel:",
+                             "  uses " + std::to_string(threads_per_transform)
+                                 + " threads per 3d transform",
+                             "  does 1 3d transforms per thread block",
+                             "therefore it should be called with " + std::to_string(workgroup_size)
+                                 + " threads per block",
+                             ""};
+
+        Variable d{"d", "int"};
+        Variable index_along_d{"index_along_d", "size_t"};
+        Variable remaining{"remaining", "size_t"};
+        Variable plength{"plength", "size_t"};
+
+        Variable batch0{"batch0", "size_t"};
+
+        body += LDSDeclaration{scalar_type.name};
+        body += Declaration{R};
+        body += Declaration{transform};
+        body += Declaration{offset, 0};
+        body += Declaration{offset_lds};
+        body += Declaration{stride_lds};
+        body += Declaration{write};
+        body += Declaration{batch0};
+        body += Declaration{remaining};
+        body += Declaration{plength, 1};
+        body += Declaration{index_along_d};
+        body += Declaration{lds_is_real, "false"};
+        body += Declaration{lds_linear, "true"};
+        body += Declaration{direct_load_to_reg, "false"};
+        body += Declaration{direct_store_from_reg, "false"};
+        body += Declaration{thread_in_device};
+        body += CallbackDeclaration{scalar_type.name, callback_type.name};
+
+        body += LineBreak{};
+        body += CommentLines{"transform is: 3D brick number (1 per block)"};
+        body += Assign{transform, block_id};
+        body += Assign{remaining, transform};
+        body += CommentLines{"compute 3D brick offset (start from length/stride index 3)"};
+
+        if(static_dim)
+        {
+            body += Declaration{dim, static_dim};
+        }
+        body += For{d,
+                    3,
+                    d < dim,
+                    1,
+                    {Assign{plength, plength * lengths[d]},
+                     Assign{index_along_d, remaining % lengths[d]},
+                     Assign{remaining, remaining / lengths[d]},
+                     Assign{offset, offset + index_along_d * stride[d]}}};
+        body += Assign{batch0, transform / plength};
+        body += Assign{offset, offset + batch0 * stride[dim]};
+
+        // the brick is loaded and stored as a flat array of
+        // elements, with dimension 0 moving fastest
+        auto rw_iters  = DivRoundingUp(brick, workgroup_size);
+        auto element   = [&](unsigned int i) { return Parens{i * workgroup_size + thread_id}; };
+        auto row       = [&](unsigned int i) { return Parens{element(i) / length0}; };
+        auto col       = [&](unsigned int i) { return Parens{element(i) % length0}; };
+        auto lds_index = [&](unsigned int i) { return row(i) * length0_padded + col(i); };
+
+        auto global_offset = [&](unsigned int i) {
+            return offset + col(i) * stride[0] + Parens{row(i) % length1} * stride[1]
+                   + Parens{row(i) / length1} * stride[2];
+        };
+        // the last iteration might not need all threads
+        auto guarded = [&](unsigned int i, Statement stmt) -> Statement {
+            if((i + 1) * workgroup_size <= brick)
+                return stmt;
+            return If{element(i) < brick, {stmt}};
+        };
+
+        // load
+        body += LineBreak{};
+        body += CommentLines{"load the " + std::to_string(brick)
+                             + "-element brick using all threads.",
+                             "need " + std::to_string(rw_iters) + " iterations"};
+        for(unsigned int i = 0; i < rw_iters; ++i)
+            body += guarded(
+                i, Assign{lds_complex[lds_index(i)], LoadGlobal{buf, global_offset(i)}});
+
+        // dimension 0: rows are contiguous in LDS
+        Variable row_id{"row_id", "unsigned int"};
+        body += LineBreak{};
+        body += Declaration{row_id, thread_id / kernel0.threads_per_transform};
+        body += transform_dimension(0, length0_padded * row_id, 1);
+
+        // dimension 1: columns within each plane of the brick
+        body += Assign{row_id, thread_id / kernel1.threads_per_transform};
+        body += transform_dimension(1,
+                                    Parens{row_id / length0} * (length1 * length0_padded)
+                                        + row_id % length0,
+                                    length0_padded);
+
+        // dimension 2: columns across planes
+        body += Assign{row_id, thread_id / kernel2.threads_per_transform};
+        body += transform_dimension(2,
+                                    Parens{row_id / length0} * length0_padded + row_id % length0,
+                                    length1 * length0_padded);
+
+        // store
+        body += SyncThreads{};
+        body += CommentLines{"store the " + std::to_string(brick)
+                             + "-element brick using all threads.",
+                             "need " + std::to_string(rw_iters) + " iterations"};
+        for(unsigned int i = 0; i < rw_iters; ++i)
+            body += guarded(i, StoreGlobal{buf, global_offset(i), lds_complex[lds_index(i)]});
+
+        f.qualifier     = "__global__";
+        f.templates     = global_templates();
+        f.arguments     = global_arguments();
+        f.launch_bounds = workgroup_size;
+        return f;
+    }
+};
@@ -22,6 +22,10 @@
 #include "../../device/kernels/bank_shift.h"
 #include "stockham_gen.h"
 #include <cmath>
+#include <functional>
+#include <map>
+#include <set>
+#include <sstream>
 
 // Base class for stockham kernels.  Subclasses are responsible for
 // different tiling types.
@@ -96,6 +100,156 @@ struct StockhamKernel : public StockhamGeneratorSpecs
         return max_registers;
     }
 
+    // Cross-lane exchange between passes.
+    //
+    // When all threads of a transform sit in the same wavefront, the
+    // LDS round-trip between two passes can be replaced by a series
+    // of register shuffles.  Each round of the exchange moves one
+    // element into every lane: a lane sends one of its registers,
+    // reads the value sent by another lane, and keeps it in one of
+    // its registers.  Per-lane choices are fixed at generation time.
+    //
+    // Wavefronts are at least 32 lanes wide, so a power-of-2 thread
+    // count up to 16 keeps each transform in one wavefront.
+    static const unsigned int CROSS_LANE_MAX_THREADS = 16;
+    // Lane-dependent register choices cost a select per distinct
+    // register, so give up on the exchange if a round needs more than
+    // this many.
+    static const unsigned int CROSS_LANE_MAX_SELECTS = 4;
+
+    struct CrossLaneRound
+    {
+        // indexed by lane within the transform
+        std::vector<unsigned int> send_reg;
+        std::vector<unsigned int> src_lane;
+        std::vector<unsigned int> recv_reg;
+    };
+
+    // Tilings that always map consecutive lanes to the threads of a
+    // transform can use the cross-lane exchange.
+    virtual bool cross_lane_exchange_supported()
+    {
+        return false;
+    }
+
+    // Plan the exchange between pass npass and npass + 1.  Returns an
+    // empty list if the exchange has to go through LDS.
+    std::vector<CrossLaneRound> plan_cross_lane_exchange(unsigned int npass)
+    {
+        const unsigned int T = threads_per_transform;
+        if(!cross_lane_exchange || !cross_lane_exchange_supported() || writeGuard)
+            return {};
+        if(T > CROSS_LANE_MAX_THREADS || (T & (T - 1)) != 0)
+            return {};
+
+        const unsigned int width     = factors[npass];
+        const unsigned int width2    = factors[npass + 1];
+        const unsigned int cumheight = product(factors.begin(), factors.begin() + npass);
+        // every thread needs the same amount of work on both sides,
+        // so that no lane sits out of a shuffle
+        if(length % (width * T) != 0 || length % (width2 * T) != 0)
+            return {};
+        const unsigned int nregs = length / T;
+
+        // position of each element in the transform, for both the
+        // store side (pass npass) and load side (pass npass + 1) -
+        // this mirrors store_lds_generator and load_lds_generator
+        struct Element
+        {
+            unsigned int src_lane, send_reg, dst_lane, recv_reg;
+        };
+        std::vector<Element> elements(length);
+        for(unsigned int lane = 0; lane < T; ++lane)
+        {
+            for(unsigned int h = 0; h < length / width / T; ++h)
+            {
+                for(unsigned int w = 0; w < width; ++w)
+                {
+                    auto tid = lane + h * T;
+                    auto pos = (tid / cumheight) * (width * cumheight) + tid % cumheight
+                               + w * cumheight;
+                    elements[pos].src_lane = lane;
+                    elements[pos].send_reg = h * width + w;
+                }
+            }
+            for(unsigned int h = 0; h < length / width2 / T; ++h)
+            {
+                for(unsigned int w = 0; w < width2; ++w)
+                {
+                    auto tid = lane + h * T;
+                    auto pos = tid + w * (length / width2);
+                    elements[pos].dst_lane = lane;
+                    elements[pos].recv_reg = h * width2 + w;
+                }
+            }
+        }
+
+        // Every lane sends and receives nregs elements, so the
+        // elements can be split into nregs rounds where each lane
+        // sends and receives exactly once.  Find each round as a
+        // perfect matching between source and destination lanes.
+        std::sort(elements.begin(), elements.end(), [](const Element& a, const Element& b) {
+            if(a.send_reg != b.send_reg)
+                return a.send_reg < b.send_reg;
+            return a.recv_reg < b.recv_reg;
+        });
+        std::vector<bool>           used(elements.size(), false);
+        std::vector<CrossLaneRound> rounds;
+        for(unsigned int r = 0; r < nregs; ++r)
+        {
+            // element index matched to each destination lane
+            std::vector<int> match(T, -1);
+
+            std::function<bool(unsigned int, std::vector<bool>&)> augment
+                = [&](unsigned int src, std::vector<bool>& seen) {
+                      for(unsigned int e = 0; e < elements.size(); ++e)
+                      {
+                          if(used[e] || elements[e].src_lane != src)
+                              continue;
+                          auto dst = elements[e].dst_lane;
+                          if(seen[dst])
+                              continue;
+                          seen[dst] = true;
+                          if(match[dst] < 0 || augment(elements[match[dst]].src_lane, seen))
+                          {
+                              match[dst] = e;
+                              return true;
+                          }
+                      }
+                      return false;
+                  };
+            for(unsigned int src = 0; src < T; ++src)
+            {
+                std::vector<bool> seen(T, false);
+                if(!augment(src, seen))
+                    throw std::runtime_error("cross-lane exchange: no complete round");
+            }
+
+            CrossLaneRound round;
+            round.send_reg.resize(T);
+            round.src_lane.resize(T);
+            round.recv_reg.resize(T);
+            for(unsigned int dst = 0; dst < T; ++dst)
+            {
+                const auto& e              = elements[match[dst]];
+                round.send_reg[e.src_lane] = e.send_reg;
+                round.src_lane[dst]        = e.src_lane;
+                round.recv_reg[dst]        = e.recv_reg;
+                used[match[dst]]           = true;
+            }
+
+            auto distinct = [](std::vector<unsigned int> v) {
+                std::sort(v.begin(), v.end());
+                return std::unique(v.begin(), v.end()) - v.begin();
+            };
+            if(distinct(round.send_reg) > CROSS_LANE_MAX_SELECTS
+               || distinct(round.recv_reg) > CROSS_LANE_MAX_SELECTS)
+                return {};
+            rounds.push_back(std::move(round));
+        }
+        return rounds;
+    }
+
     //
     // templates
     //
@@ -204,6 +358,12 @@ struct StockhamKernel : public StockhamGeneratorSpecs
     // butterfly registers
     Variable R{"R", "scalar_type", false, false};
 
+    // copies of butterfly registers that are still to be sent after
+    // being overwritten, and value in flight during a cross-lane
+    // exchange
+    Variable R_xchg{"R_xchg", "scalar_type", false, false};
+    Variable xchg_value{"xchg_value", "scalar_type"};
+
     virtual std::vector<unsigned int> launcher_lengths()
     {
         return {length};
@@ -405,6 +565,138 @@ struct StockhamKernel : public StockhamGeneratorSpecs
         return work;
     }
 
+    // Decide which passes hand data to the next pass through
+    // cross-lane shuffles instead of LDS, and declare the variables
+    // the exchange needs in the device function body.
+    std::vector<std::vector<CrossLaneRound>> plan_cross_lane_exchanges(StatementList& body)
+    {
+        std::vector<std::vector<CrossLaneRound>> exchanges(factors.size());
+        for(unsigned int npass = 0; npass + 1 < factors.size(); ++npass)
+            exchanges[npass] = plan_cross_lane_exchange(npass);
+        if(std::any_of(exchanges.begin(), exchanges.end(), [](const auto& e) {
+               return !e.empty();
+           }))
+        {
+            size_t nsnapshot = 0;
+            for(const auto& rounds : exchanges)
+                nsnapshot = std::max(nsnapshot, cross_lane_snapshot_regs(rounds).size());
+            if(nsnapshot)
+            {
+                R_xchg.size = Expression{static_cast<unsigned int>(nsnapshot)};
+                body += Declaration{R_xchg};
+            }
+            body += Declaration{xchg_value};
+        }
+        return exchanges;
+    }
+
+    // Registers that a lane sends after an earlier round of the same
+    // exchange has already overwritten them.  Only these need to be
+    // copied before the first round.
+    static std::vector<unsigned int>
+        cross_lane_snapshot_regs(const std::vector<CrossLaneRound>& rounds)
+    {
+        std::set<unsigned int> regs;
+        for(unsigned int k = 0; k < rounds.size(); ++k)
+        {
+            for(unsigned int lane = 0; lane < rounds[k].send_reg.size(); ++lane)
+            {
+                for(unsigned int j = 0; j < k; ++j)
+                {
+                    if(rounds[j].recv_reg[lane] == rounds[k].send_reg[lane])
+                    {
+                        regs.insert(rounds[k].send_reg[lane]);
+                        break;
+                    }
+                }
+            }
+        }
+        return {regs.begin(), regs.end()};
+    }
+
+    // build an expression that evaluates to make(values[thread])
+    Expression lane_select(const std::vector<unsigned int>&         values,
+                           std::function<Expression(unsigned int)> make)
+    {
+        // lanes that need each distinct value
+        std::map<unsigned int, std::vector<unsigned int>> lanes;
+        for(unsigned int lane = 0; lane < values.size(); ++lane)
+            lanes[values[lane]].push_back(lane);
+
+        // the value needed by the most lanes is the fallthrough case
+        auto fallthrough = std::max_element(
+            lanes.begin(), lanes.end(), [](const auto& a, const auto& b) {
+                return a.second.size() < b.second.size();
+            });
+        Expression result = make(fallthrough->first);
+        for(auto group = lanes.begin(); group != lanes.end(); ++group)
+        {
+            if(group == fallthrough)
+                continue;
+            Expression cond = thread == group->second.front();
+            for(auto lane = group->second.begin() + 1; lane != group->second.end(); ++lane)
+                cond = cond || (thread == *lane);
+            result = Ternary{Parens{cond}, make(group->first), Parens{result}};
+        }
+        return result;
+    }
+
+    StatementList cross_lane_exchange_generator(const std::vector<CrossLaneRound>& rounds)
+    {
+        const unsigned int T = threads_per_transform;
+
+        StatementList work;
+        const auto    snapshot = cross_lane_snapshot_regs(rounds);
+        for(unsigned int i = 0; i < snapshot.size(); ++i)
+            work += Assign{R_xchg[i], R[snapshot[i]]};
+        auto send_value = [&](unsigned int r) -> Expression {
+            auto copy = std::find(snapshot.begin(), snapshot.end(), r);
+            if(copy != snapshot.end())
+                return R_xchg[static_cast<unsigned int>(copy - snapshot.begin())];
+            return R[r];
+        };
+
+        for(const auto& round : rounds)
+        {
+            work += Assign{xchg_value, lane_select(round.send_reg, send_value)};
+
+            bool lanes_move = false;
+            for(unsigned int lane = 0; lane < T; ++lane)
+                lanes_move |= round.src_lane[lane] != lane;
+            if(lanes_move)
+            {
+                // source lanes are below 16, so pack them into a
+                // 64-bit constant and pull out 4 bits for each lane
+                unsigned long long packed = 0;
+                for(unsigned int lane = 0; lane < T; ++lane)
+                    packed |= static_cast<unsigned long long>(round.src_lane[lane]) << (lane * 4);
+                std::ostringstream packed_str;
+                packed_str << "0x" << std::hex << packed << "ULL";
+                auto src_lane
+                    = Parens{Parens{Literal{packed_str.str()} >> (thread * 4)} & Literal{15}};
+                work += Assign{xchg_value, CallExpr{"lane_shuffle", {xchg_value, src_lane, T}}};
+            }
+
+            std::set<unsigned int> recv_regs(round.recv_reg.begin(), round.recv_reg.end());
+            for(auto r : recv_regs)
+            {
+                if(recv_regs.size() == 1)
+                {
+                    work += Assign{R[r], xchg_value};
+                    continue;
+                }
+                std::vector<unsigned int> is_dest(T);
+                for(unsigned int lane = 0; lane < T; ++lane)
+                    is_dest[lane] = round.recv_reg[lane] == r;
+                work += Assign{
+                    R[r], lane_select(is_dest, [&](unsigned int dest) -> Expression {
+                        return dest ? xchg_value : R[r];
+                    })};
+            }
+        }
+        return work;
+    }
+
     // The "stacked" twiddle table starts at the second factor, since
     // the first factor's values are not actually needed for
     // anything.  It still counts towards cumulative height, but we
@@ -641,6 +933,8 @@ struct StockhamKernel : public StockhamGeneratorSpecs
             lstride, Ternary{Parens{stride_type == "SB_UNIT"}, Parens{1}, Parens{stride_lds}}};
         body += Declaration{l_offset};
 
+        auto exchanges = plan_cross_lane_exchanges(body);
+
         for(unsigned int npass = 0; npass < factors.size(); ++npass)
         {
             // width is the butterfly width, Radix-n.
@@ -666,7 +960,8 @@ struct StockhamKernel : public StockhamGeneratorSpecs
 
             if(npass > 0)
             {
-                // internal full lds2reg (both linear/nonlinear variants)
+                // internal full lds2reg (both linear/nonlinear variants),
+                // unless the previous pass already exchanged registers
                 StatementList lds2reg_full;
                 lds2reg_full += SyncThreads();
                 lds2reg_full += add_work(
@@ -675,7 +970,8 @@ struct StockhamKernel : public StockhamGeneratorSpecs
                     height,
                     ThreadGuardMode::GUARD_BY_IF,
                     true);
-                body += If{Not{lds_is_real}, lds2reg_full};
+                if(exchanges[npass - 1].empty())
+                    body += If{Not{lds_is_real}, lds2reg_full};
 
                 auto apply_twiddle = std::mem_fn(&StockhamKernel::apply_twiddle_generator);
                 body += add_work(
@@ -697,7 +993,12 @@ struct StockhamKernel : public StockhamGeneratorSpecs
             // internal lds store (half-with-linear and full-with-linear/nonlinear)
             StatementList reg2lds_full;
             StatementList reg2lds_half;
-            if(npass < factors.size() - 1)
+            if(npass < factors.size() - 1 && !exchanges[npass].empty())
+            {
+                body += CommentLines{"exchange registers across lanes for the next pass"};
+                body += cross_lane_exchange_generator(exchanges[npass]);
+            }
+            else if(npass < factors.size() - 1)
             {
                 // linear variant store (half) and load (half)
                 for(auto component : {Component::REAL, Component::IMAG})
@@ -37,6 +37,12 @@ struct StockhamKernelRR : public StockhamKernel
         return "SBRR";
     }
 
+    // threads of a transform are always consecutive lanes
+    bool cross_lane_exchange_supported() override
+    {
+        return true;
+    }
+
     StatementList calculate_offsets() override
     {
         Variable d{"d", "int"};
@@ -186,6 +192,8 @@ struct StockhamKernelRR : public StockhamKernel
 
         body += Declaration{l_offset};
 
+        auto exchanges = plan_cross_lane_exchanges(body);
+
         for(unsigned int npass = 0; npass < factors.size(); ++npass)
         {
             // width is the butterfly width, Radix-n. Mostly is used as dt in add_work()
@@ -211,7 +219,8 @@ struct StockhamKernelRR : public StockhamKernel
 
             if(npass > 0)
             {
-                // internal full lds2reg (both linear/nonlinear variants)
+                // internal full lds2reg (both linear/nonlinear variants),
+                // unless the previous pass already exchanged registers
                 StatementList lds2reg_full;
                 lds2reg_full += SyncThreads();
 
@@ -234,7 +243,8 @@ struct StockhamKernelRR : public StockhamKernel
                         height,
                         ThreadGuardMode::GUARD_BY_IF);
                 }
-                body += If{Not{lds_is_real}, lds2reg_full};
+                if(exchanges[npass - 1].empty())
+                    body += If{Not{lds_is_real}, lds2reg_full};
 
                 auto apply_twiddle = std::mem_fn(&StockhamKernel::apply_twiddle_generator);
                 body += add_work(
@@ -256,7 +266,12 @@ struct StockhamKernelRR : public StockhamKernel
             // internal lds store (half-with-linear and full-with-linear/nonlinear)
             StatementList reg2lds_full;
             StatementList reg2lds_half;
-            if(npass < factors.size() - 1)
+            if(npass < factors.size() - 1 && !exchanges[npass].empty())
+            {
+                body += CommentLines{"exchange registers across lanes for the next pass"};
+                body += cross_lane_exchange_generator(exchanges[npass]);
+            }
+            else if(npass < factors.size() - 1)
             {
                 // linear variant store (half) and load (half)
                 for(auto component : {Component::REAL, Component::IMAG})
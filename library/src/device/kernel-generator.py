@@ -41,9 +41,9 @@ from pathlib import Path
 from types import SimpleNamespace as NS
 from operator import mul
 
-from generator import (ArgumentList, BaseNode, Call, CommentBlock, Function,
-                       Include, LineBreak, Map, StatementList, Variable,
-                       name_args, write, clang_format_file)
+from generator import (ArgumentList, BaseNode, Call, CommentBlock, Equal,
+                       Function, If, Include, LineBreak, Map, StatementList,
+                       Variable, name_args, write, clang_format_file)
 
 from collections import namedtuple
 
@@ -156,21 +156,23 @@ class FFTKernel(BaseNode):
             f += 'true'
         else:
             f += 'false'
+        if getattr(self.function.meta, 'cross_lane_exchange', False):
+            f += ', true'
         f += ')'
         return f
 
 
 def generate_cpu_function_pool(functions):
-    """Generate function to populate the kernel function pool."""
+    """Generate function to populate the kernel function pool, a precision at a time."""
 
-    function_map = Map('function_map')
+    function_map = Map('map')
     precisions = {
         'sp': 'rocfft_precision_single',
         'dp': 'rocfft_precision_double',
         'half': 'rocfft_precision_half',
     }
 
-    populate = StatementList()
+    populate = {precision: StatementList() for precision in precisions}
     for f in functions:
         length, precision, scheme, transpose = f.meta.length, f.meta.precision, f.meta.scheme, f.meta.transpose
         if isinstance(length, (int, str)):
@@ -180,14 +182,20 @@ def generate_cpu_function_pool(functions):
                        'std::array<size_t, 2>({' + cjoin(length) + '})',
                        precisions[precision], scheme, transpose
                        or 'NONE')).inline()
-        populate += function_map.assert_emplace(key, FFTKernel(f))
+        populate[precision] += function_map.assert_emplace(key, FFTKernel(f))
+
+    body = StatementList()
+    for precision, statements in populate.items():
+        body += If(Equal('precision', precisions[precision]), statements)
 
     return StatementList(
         Include('"../include/function_pool.h"'),
-        Function(name='function_pool::function_pool',
-                 value=False,
-                 arguments=ArgumentList(),
-                 body=populate))
+        Function(name='function_pool::populate',
+                 value=None,
+                 arguments=ArgumentList(
+                     Variable('precision', 'rocfft_precision'),
+                     Variable('map', 'kernel_map_t&')),
+                 body=body))
 
 
 def list_generated_kernels(kernels):
@@ -230,6 +238,9 @@ def list_small_kernels():
     # Note: Default half_lds is True and default direct_to_from_reg is True as well.
     # TODO- Currently, if half_lds is True, then direct_to_from_reg must be True
     #       but if half_lds is False, direct_to_from_reg can be either (still can be True).
+    # cross_lane_exchange=True opts a kernel in to exchanging data between passes
+    # with cross-lane shuffles instead of LDS.  Default is False; only set it on
+    # kernels where benchmarks show the exchange is faster.
     kernels1d = [
         NS(length=   1, workgroup_size= 64, threads_per_transform=  1, factors=(1,), runtime_compile=True),
         NS(length=   2, workgroup_size= 64, threads_per_transform=  1, factors=(2,), runtime_compile=True),
@@ -748,6 +759,10 @@ def generate_kernel(kernel, precisions, stockham_aot):
                        kernel.scheme == 'CS_KERNEL_STOCKHAM')
     # for unspecified direct_to_from_reg, default is True only for CS_KERNEL_STOCKHAM and SBCC
     direct_to_from_reg = getattr(kernel, 'direct_to_from_reg', True)
+    # cross-lane exchange is opt-in per kernel
+    cross_lane_exchange = getattr(kernel, 'cross_lane_exchange', False)
+    if cross_lane_exchange:
+        args.insert(1, '--cross-lane-exchange')
 
     filename = kernel_file_name(kernel)
 
@@ -789,6 +804,7 @@ def generate_kernel(kernel, precisions, stockham_aot):
         precision = 'dp' if launcher.double_precision else 'sp'
         runtime_compile = kernel.runtime_compile
         use_3steps_large_twd = getattr(kernel, 'use_3steps_large_twd', None)
+        cross_lane_exchange = getattr(kernel, 'cross_lane_exchange', False)
 
         params = LaunchParams(transforms_per_block, workgroup_size,
                               threads_per_transform, half_lds,
@@ -817,6 +833,7 @@ def generate_kernel(kernel, precisions, stockham_aot):
                              threads_per_transform=tpt_list,
                              transpose=sbrc_transpose_type,
                              use_3steps_large_twd=use_3steps_large_twd,
+                             cross_lane_exchange=cross_lane_exchange,
                          ))
 
             cpu_functions.append(f)
@@ -124,10 +124,7 @@ struct Handler<planar<rocfft_complex<float>>, cbtype>
     static __host__ __device__ inline rocfft_complex<float> read(
         const planar<rocfft_complex<float>> in, size_t idx, void* load_cb_fn, void* load_cb_data)
     {
-        rocfft_complex<float> t;
-        t.x = in.R[idx];
-        t.y = in.I[idx];
-        return t;
+        return load_planar<cbtype>(in.R, in.I, idx, load_cb_fn, load_cb_data, nullptr);
     }
 
     static __host__ __device__ inline void write(planar<rocfft_complex<float>> out,
@@ -136,8 +133,7 @@ struct Handler<planar<rocfft_complex<float>>, cbtype>
                                                  void*                         store_cb_fn,
                                                  void*                         store_cb_data)
     {
-        out.R[idx] = v.x;
-        out.I[idx] = v.y;
+        store_planar<cbtype>(out.R, out.I, idx, v, store_cb_fn, store_cb_data, nullptr);
     }
 };
 
@@ -147,10 +143,7 @@ struct Handler<planar<rocfft_complex<double>>, cbtype>
     static __host__ __device__ inline rocfft_complex<double> read(
         const planar<rocfft_complex<double>> in, size_t idx, void* load_cb_fn, void* load_cb_data)
     {
-        rocfft_complex<double> t;
-        t.x = in.R[idx];
-        t.y = in.I[idx];
-        return t;
+        return load_planar<cbtype>(in.R, in.I, idx, load_cb_fn, load_cb_data, nullptr);
     }
 
     static __host__ __device__ inline void write(planar<rocfft_complex<double>> out,
@@ -159,8 +152,7 @@ struct Handler<planar<rocfft_complex<double>>, cbtype>
                                                  void*                          store_cb_fn,
                                                  void*                          store_cb_data)
     {
-        out.R[idx] = v.x;
-        out.I[idx] = v.y;
+        store_planar<cbtype>(out.R, out.I, idx, v, store_cb_fn, store_cb_data, nullptr);
     }
 };
 
@@ -36,6 +36,11 @@ struct UserCallbacks
     void*  store_cb_fn        = nullptr;
     void*  store_cb_data      = nullptr;
     size_t store_cb_lds_bytes = 0;
+
+    // callbacks compiled into the kernel from source, instead of
+    // called through the function pointers above
+    bool load_cb_source  = false;
+    bool store_cb_source = false;
 };
 
 // default callback implementations that just do simple load/store
@@ -51,6 +56,21 @@ __device__ void store_cb_default(T* data, size_t offset, T element, void* cbdata
     data[offset] = element;
 }
 
+// load/store functions for buffers whose elements are narrower than
+// the type used for computation
+template <typename T, typename Tstorage>
+__device__ T load_cb_storage(const Tstorage* data, size_t offset, void* cbdata, void* sharedMem)
+{
+    return static_cast<T>(data[offset]);
+}
+
+template <typename T, typename Tstorage>
+__device__ void
+    store_cb_storage(Tstorage* data, size_t offset, T element, void* cbdata, void* sharedMem)
+{
+    data[offset] = static_cast<Tstorage>(element);
+}
+
 // callback function types
 template <typename T>
 struct callback_type;
@@ -138,6 +158,47 @@ struct callback_type<double>
 static __device__ auto load_cb_default_double  = load_cb_default<double>;
 static __device__ auto store_cb_default_double = store_cb_default<double>;
 
+// callback function types for planar buffers, where the real and
+// imaginary parts of each element are in separate arrays
+template <typename Treal>
+struct planar_callback_type
+{
+    typedef rocfft_complex<Treal> (*load)(
+        Treal* real, Treal* imag, size_t offset, void* cbdata, void* sharedMem);
+    typedef void (*store)(Treal*                real,
+                          Treal*                imag,
+                          size_t                offset,
+                          rocfft_complex<Treal> element,
+                          void*                 cbdata,
+                          void*                 sharedMem);
+};
+
+template <typename Treal>
+__device__ rocfft_complex<Treal>
+    load_cb_planar_default(Treal* real, Treal* imag, size_t offset, void* cbdata, void* sharedMem)
+{
+    return rocfft_complex<Treal>{real[offset], imag[offset]};
+}
+
+template <typename Treal>
+__device__ void store_cb_planar_default(Treal*                real,
+                                        Treal*                imag,
+                                        size_t                offset,
+                                        rocfft_complex<Treal> element,
+                                        void*                 cbdata,
+                                        void*                 sharedMem)
+{
+    real[offset] = element.x;
+    imag[offset] = element.y;
+}
+
+static __device__ auto load_cb_default_planar_half    = load_cb_planar_default<_Float16>;
+static __device__ auto store_cb_default_planar_half   = store_cb_planar_default<_Float16>;
+static __device__ auto load_cb_default_planar_float   = load_cb_planar_default<float>;
+static __device__ auto store_cb_default_planar_float  = store_cb_planar_default<float>;
+static __device__ auto load_cb_default_planar_double  = load_cb_planar_default<double>;
+static __device__ auto store_cb_default_planar_double = store_cb_planar_default<double>;
+
 // intrinsic
 template <typename T>
 __device__ void intrinsic_load_to_dest(
@@ -183,12 +244,63 @@ __device__ void
 #endif
 }
 
+// store to a buffer whose elements are narrower than the type used
+// for computation
+template <typename T, typename Tstorage>
+__device__ void
+    store_intrinsic(Tstorage* data, unsigned int voffset, unsigned int soffset, T element, bool rw)
+{
+    store_intrinsic(data, voffset, soffset, static_cast<Tstorage>(element), rw);
+}
+
 enum struct CallbackType
 {
     // don't run user callbacks
     NONE,
     // run user load/store callbacks
     USER_LOAD_STORE,
+    // run user load/store callbacks compiled into the kernel from
+    // source
+    USER_SOURCE,
+};
+
+// user callbacks compiled from source.  Kernels generated with
+// callback source specialize these for the element types they load
+// and store, to return the user's functions instead of the defaults.
+template <typename T>
+struct source_load_cb
+{
+    static __device__ typename callback_type<T>::load get()
+    {
+        return load_cb_default<T>;
+    }
+};
+
+template <typename T>
+struct source_store_cb
+{
+    static __device__ typename callback_type<T>::store get()
+    {
+        return store_cb_default<T>;
+    }
+};
+
+template <typename Treal>
+struct source_load_cb_planar
+{
+    static __device__ typename planar_callback_type<Treal>::load get()
+    {
+        return load_cb_planar_default<Treal>;
+    }
+};
+
+template <typename Treal>
+struct source_store_cb_planar
+{
+    static __device__ typename planar_callback_type<Treal>::store get()
+    {
+        return store_cb_planar_default<Treal>;
+    }
 };
 
 // helpers to cast void* to the correct function pointer type
@@ -198,6 +310,8 @@ static __device__ typename callback_type<T>::load get_load_cb(void* ptr)
 #ifdef ROCFFT_CALLBACKS_ENABLED
     if(cbtype == CallbackType::USER_LOAD_STORE)
         return reinterpret_cast<typename callback_type<T>::load>(ptr);
+    if(cbtype == CallbackType::USER_SOURCE)
+        return source_load_cb<T>::get();
 #endif
     return load_cb_default<T>;
 }
@@ -208,8 +322,61 @@ static __device__ typename callback_type<T>::store get_store_cb(void* ptr)
 #ifdef ROCFFT_CALLBACKS_ENABLED
     if(cbtype == CallbackType::USER_LOAD_STORE)
         return reinterpret_cast<typename callback_type<T>::store>(ptr);
+    if(cbtype == CallbackType::USER_SOURCE)
+        return source_store_cb<T>::get();
 #endif
     return store_cb_default<T>;
 }
 
+template <typename Treal, CallbackType cbtype>
+static __device__ typename planar_callback_type<Treal>::load get_load_cb_planar(void* ptr)
+{
+#ifdef ROCFFT_CALLBACKS_ENABLED
+    if(cbtype == CallbackType::USER_LOAD_STORE)
+        return reinterpret_cast<typename planar_callback_type<Treal>::load>(ptr);
+    if(cbtype == CallbackType::USER_SOURCE)
+        return source_load_cb_planar<Treal>::get();
+#endif
+    return load_cb_planar_default<Treal>;
+}
+
+template <typename Treal, CallbackType cbtype>
+static __device__ typename planar_callback_type<Treal>::store get_store_cb_planar(void* ptr)
+{
+#ifdef ROCFFT_CALLBACKS_ENABLED
+    if(cbtype == CallbackType::USER_LOAD_STORE)
+        return reinterpret_cast<typename planar_callback_type<Treal>::store>(ptr);
+    if(cbtype == CallbackType::USER_SOURCE)
+        return source_store_cb_planar<Treal>::get();
+#endif
+    return store_cb_planar_default<Treal>;
+}
+
+// load/store an element of a planar buffer, through a user callback
+// if the kernel has them
+template <CallbackType cbtype, typename Treal>
+__device__ rocfft_complex<Treal> load_planar(const Treal* real,
+                                             const Treal* imag,
+                                             size_t       offset,
+                                             void*        load_cb_fn,
+                                             void*        load_cb_data,
+                                             void*        sharedMem)
+{
+    return get_load_cb_planar<Treal, cbtype>(load_cb_fn)(
+        const_cast<Treal*>(real), const_cast<Treal*>(imag), offset, load_cb_data, sharedMem);
+}
+
+template <CallbackType cbtype, typename Treal>
+__device__ void store_planar(Treal*                real,
+                             Treal*                imag,
+                             size_t                offset,
+                             rocfft_complex<Treal> element,
+                             void*                 store_cb_fn,
+                             void*                 store_cb_data,
+                             void*                 sharedMem)
+{
+    get_store_cb_planar<Treal, cbtype>(store_cb_fn)(
+        real, imag, offset, element, store_cb_data, sharedMem);
+}
+
 #endif
@@ -185,6 +185,74 @@ struct real_type<rocfft_complex<_Float16>>
     typedef _Float16 type;
 };
 
+// bfloat16 number: the upper half of an IEEE single-precision
+// number.  Only used for storage, arithmetic is done on floats.
+struct rocfft_bfloat16
+{
+    unsigned short data;
+
+    rocfft_bfloat16() = default;
+
+    // round to nearest even
+    __device__ __host__ rocfft_bfloat16(float f)
+    {
+        union
+        {
+            float        f;
+            unsigned int u;
+        } bits = {f};
+        if((bits.u & 0x7fffffff) > 0x7f800000)
+            data = 0x7fc0;
+        else
+            data = (bits.u + 0x7fff + ((bits.u >> 16) & 1)) >> 16;
+    }
+
+    __device__ __host__ operator float() const
+    {
+        union
+        {
+            unsigned int u;
+            float        f;
+        } bits = {static_cast<unsigned int>(data) << 16};
+        return bits.f;
+    }
+};
+
+// Complex number kept in memory as a pair of Tstorage numbers.
+// Loads and stores convert to and from rocfft_complex<Tcompute>,
+// so kernels can compute in higher precision than they store.
+template <typename Tstorage, typename Tcompute>
+struct storage_complex
+{
+    Tstorage x;
+    Tstorage y;
+
+    storage_complex() = default;
+
+    __device__ __host__ storage_complex(Tcompute re, Tcompute im)
+        : x(re)
+        , y(im)
+    {
+    }
+
+    __device__ __host__ storage_complex(const rocfft_complex<Tcompute>& z)
+        : x(z.x)
+        , y(z.y)
+    {
+    }
+
+    __device__ __host__ operator rocfft_complex<Tcompute>() const
+    {
+        return rocfft_complex<Tcompute>(static_cast<Tcompute>(x), static_cast<Tcompute>(y));
+    }
+};
+
+template <typename Tstorage, typename Tcompute>
+struct real_type<storage_complex<Tstorage, Tcompute>>
+{
+    typedef Tstorage type;
+};
+
 template <class T>
 using real_type_t = typename real_type<T>::type;
 
@@ -210,6 +278,47 @@ using complex_type_t = typename complex_type<T>::type;
 // complex_type_t<float> float_complex_val;
 // complex_type_t<double> double_complex_val;
 
+// read a complex value from another lane, in groups of width lanes
+__device__ inline rocfft_complex<float>
+    lane_shuffle(const rocfft_complex<float>& v, unsigned int src_lane, unsigned int width)
+{
+    return rocfft_complex<float>(__shfl(v.x, src_lane, width), __shfl(v.y, src_lane, width));
+}
+
+__device__ inline rocfft_complex<double>
+    lane_shuffle(const rocfft_complex<double>& v, unsigned int src_lane, unsigned int width)
+{
+    return rocfft_complex<double>(__shfl(v.x, src_lane, width), __shfl(v.y, src_lane, width));
+}
+
+__device__ inline rocfft_complex<_Float16>
+    lane_shuffle(const rocfft_complex<_Float16>& v, unsigned int src_lane, unsigned int width)
+{
+    return rocfft_complex<_Float16>(
+        static_cast<_Float16>(__shfl(static_cast<float>(v.x), src_lane, width)),
+        static_cast<_Float16>(__shfl(static_cast<float>(v.y), src_lane, width)));
+}
+
+// vec consecutive complex values, moved to/from global memory with a
+// single wide access
+template <typename T, unsigned int vec>
+struct alignas(sizeof(T) * vec) complex_vec
+{
+    T v[vec];
+};
+
+template <unsigned int vec, typename T>
+__device__ inline complex_vec<T, vec> load_complex_vec(const T* data, size_t idx)
+{
+    return *reinterpret_cast<const complex_vec<T, vec>*>(data + idx);
+}
+
+template <unsigned int vec, typename T>
+__device__ inline void store_complex_vec(T* data, size_t idx, const complex_vec<T, vec>& val)
+{
+    *reinterpret_cast<complex_vec<T, vec>*>(data + idx) = val;
+}
+
 template <typename T>
 __device__ T TWLstep1(const T* twiddles, size_t u)
 {
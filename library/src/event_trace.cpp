@@ -0,0 +1,397 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef WIN32
+#include <process.h>
+#define GETPID _getpid
+#else
+#include <unistd.h>
+#define GETPID getpid
+#endif
+
+#include "../../shared/environment.h"
+#include "event_trace.h"
+#include "rocfft_ostream.hpp"
+
+// how often the drain thread empties the ring buffers
+static const auto TRACE_DRAIN_INTERVAL = std::chrono::milliseconds(50);
+
+// Ring buffer of records appended by one thread and drained by
+// another.  Only the owning thread writes head, and only the drain
+// thread writes tail, so neither side needs a lock.
+struct TraceRing
+{
+    // must be a power of 2
+    static const size_t CAPACITY = 2048;
+
+    explicit TraceRing(uint32_t tid)
+        : tid(tid)
+    {
+    }
+
+    const uint32_t                    tid;
+    std::array<TraceRecord, CAPACITY> records;
+    std::atomic<size_t>               head{0};
+    std::atomic<size_t>               tail{0};
+    std::atomic<size_t>               dropped{0};
+    // set once the owning thread stops appending
+    std::atomic<bool> retired{false};
+
+    void push(const TraceRecord& record)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if(h - tail.load(std::memory_order_acquire) >= CAPACITY)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        records[h & (CAPACITY - 1)] = record;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // call f for each record appended since the last drain
+    template <typename Tfunc>
+    void drain(Tfunc&& f)
+    {
+        const size_t h = head.load(std::memory_order_acquire);
+        size_t       t = tail.load(std::memory_order_relaxed);
+        for(; t != h; ++t)
+            f(records[t & (CAPACITY - 1)]);
+        tail.store(t, std::memory_order_release);
+    }
+
+    bool empty() const
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
+
+struct TraceState
+{
+    std::mutex                              mutex;
+    std::condition_variable                 cv;
+    std::vector<std::shared_ptr<TraceRing>> rings;
+    uint32_t                                next_tid = 0;
+
+    FILE*       out          = nullptr;
+    bool        first_record = true;
+    bool        stop         = false;
+    size_t      dropped      = 0;
+    std::thread drainer;
+};
+
+// Never destroyed, since the drain thread may still be running if
+// the process exits without calling rocfft_cleanup
+static TraceState& trace_state()
+{
+    static TraceState* state = new TraceState;
+    return *state;
+}
+
+// Incremented each time tracing starts, so that threads notice that
+// their ring buffers from an earlier rocfft_setup are gone.
+static std::atomic<uint64_t> trace_generation{0};
+
+// The calling thread's ring buffer, retired when the thread exits
+struct ThreadTraceRing
+{
+    std::shared_ptr<TraceRing> ring;
+    uint64_t                   generation = 0;
+
+    ~ThreadTraceRing()
+    {
+        if(ring)
+            ring->retired = true;
+    }
+};
+
+void trace_record(const TraceRecord& record)
+{
+    static thread_local ThreadTraceRing local;
+
+    const auto generation = trace_generation.load(std::memory_order_acquire);
+    if(!local.ring || local.generation != generation)
+    {
+        // first record on this thread since tracing started
+        auto&                       state = trace_state();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if(!state.out)
+            return;
+        if(local.ring)
+            local.ring->retired = true;
+        local.ring       = std::make_shared<TraceRing>(state.next_tid++);
+        local.generation = generation;
+        state.rings.push_back(local.ring);
+    }
+    local.ring->push(record);
+}
+
+static const char* trace_event_name(TraceEvent event)
+{
+    switch(event)
+    {
+    case TraceEvent::PLAN_STAGE:
+        return "plan_stage";
+    case TraceEvent::PLAN_CREATE:
+        return "plan_create";
+    case TraceEvent::RTC_CACHE_HIT:
+        return "rtc_cache_hit";
+    case TraceEvent::RTC_CACHE_MISS:
+        return "rtc_cache_miss";
+    case TraceEvent::RTC_GENERATE:
+        return "rtc_generate";
+    case TraceEvent::RTC_COMPILE:
+        return "rtc_compile";
+    case TraceEvent::EXECUTE:
+        return "execute";
+    case TraceEvent::KERNEL_LAUNCH:
+        return "kernel_launch";
+    case TraceEvent::DROPPED_RECORDS:
+        return "dropped_records";
+    }
+    return "unknown";
+}
+
+// names of each event's arguments, nullptr for unused ones
+static std::array<const char*, TraceRecord::NUM_ARGS> trace_arg_names(TraceEvent event)
+{
+    switch(event)
+    {
+    case TraceEvent::PLAN_CREATE:
+        return {"rank", "batch", "work_buffer_bytes"};
+    case TraceEvent::RTC_GENERATE:
+        return {"source_bytes", nullptr, nullptr};
+    case TraceEvent::RTC_COMPILE:
+        return {"source_bytes", "code_bytes", nullptr};
+    case TraceEvent::EXECUTE:
+        return {"batch", "work_buffer_bytes", "chunks"};
+    case TraceEvent::KERNEL_LAUNCH:
+        return {"kernel_index", "bytes", "batch"};
+    case TraceEvent::DROPPED_RECORDS:
+        return {"count", nullptr, nullptr};
+    case TraceEvent::PLAN_STAGE:
+    case TraceEvent::RTC_CACHE_HIT:
+    case TraceEvent::RTC_CACHE_MISS:
+        break;
+    }
+    return {nullptr, nullptr, nullptr};
+}
+
+// Append a record as a Chrome trace event.  Complete events are
+// named after what they time (e.g. a plan stage or kernel), and
+// categorized by event type.
+static void format_record(std::string& out, const TraceRecord& record, uint32_t tid, int pid)
+{
+    const char* type = trace_event_name(record.event);
+
+    out += "{\"name\":\"";
+    const char* name = record.name[0] ? record.name.data() : type;
+    for(; *name; ++name)
+    {
+        if(*name == '"' || *name == '\\')
+            out += '\\';
+        out += *name;
+    }
+    out += "\",\"cat\":\"";
+    out += type;
+
+    char buf[128];
+    if(record.end_ns)
+        std::snprintf(buf,
+                      sizeof(buf),
+                      "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f",
+                      record.begin_ns / 1000.0,
+                      (record.end_ns - record.begin_ns) / 1000.0);
+    else
+        std::snprintf(
+            buf, sizeof(buf), "\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f", record.begin_ns / 1000.0);
+    out += buf;
+    std::snprintf(buf, sizeof(buf), ",\"pid\":%d,\"tid\":%u,\"args\":{", pid, tid);
+    out += buf;
+
+    auto arg_names = trace_arg_names(record.event);
+    bool first_arg = true;
+    for(size_t i = 0; i < TraceRecord::NUM_ARGS; ++i)
+    {
+        if(!arg_names[i])
+            continue;
+        std::snprintf(buf,
+                      sizeof(buf),
+                      "%s\"%s\":%llu",
+                      first_arg ? "" : ",",
+                      arg_names[i],
+                      static_cast<unsigned long long>(record.args[i]));
+        out += buf;
+        first_arg = false;
+    }
+    out += "}}";
+}
+
+// Write out everything in the ring buffers, and forget rings whose
+// threads have exited.  Only called by the drain thread, or after
+// it has stopped.
+static void drain_rings(TraceState& state)
+{
+    std::vector<std::shared_ptr<TraceRing>> rings;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        rings = state.rings;
+    }
+
+    static const int pid = GETPID();
+    std::string      json;
+    for(auto& ring : rings)
+    {
+        ring->drain([&](const TraceRecord& record) {
+            json += state.first_record ? "" : ",\n";
+            state.first_record = false;
+            format_record(json, record, ring->tid, pid);
+        });
+        state.dropped += ring->dropped.exchange(0);
+    }
+    if(!json.empty())
+    {
+        std::fwrite(json.data(), 1, json.size(), state.out);
+        std::fflush(state.out);
+    }
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.rings.erase(std::remove_if(state.rings.begin(),
+                                     state.rings.end(),
+                                     [](const std::shared_ptr<TraceRing>& ring) {
+                                         return ring->retired && ring->empty();
+                                     }),
+                      state.rings.end());
+}
+
+// Start tracing to the file at path, or to stderr if path is empty.
+static void start_trace(const std::string& path)
+{
+    if(!LOG_EVENTS_ENABLED())
+        return;
+
+    auto& state = trace_state();
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if(state.out)
+            return;
+
+        // like the text logs, write to stderr if no file is given
+        if(!path.empty())
+        {
+            int fd = OPEN(path.c_str());
+            if(fd != -1)
+                state.out = FDOPEN(fd, "w");
+        }
+        if(!state.out)
+            state.out = stderr;
+
+        // Chrome's JSON array format doesn't require the closing
+        // bracket, so the trace is still readable if the process
+        // exits without calling rocfft_cleanup
+        std::fputs("[\n", state.out);
+        state.first_record = true;
+        state.stop         = false;
+        state.dropped      = 0;
+        state.rings.clear();
+        ++trace_generation;
+    }
+
+    state.drainer = std::thread([&state]() {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        while(!state.stop)
+        {
+            state.cv.wait_for(lock, TRACE_DRAIN_INTERVAL);
+            lock.unlock();
+            drain_rings(state);
+            lock.lock();
+        }
+    });
+}
+
+void event_trace_setup()
+{
+    start_trace(rocfft_getenv("ROCFFT_LOG_EVENTS_PATH"));
+}
+
+void event_trace_helper_setup()
+{
+    auto layer_mode
+        = static_cast<rocfft_layer_mode>(strtol(rocfft_getenv("ROCFFT_LAYER").c_str(), 0, 0));
+    if(!(layer_mode & rocfft_layer_mode_log_events))
+        return;
+
+    // helpers don't write any of the text logs
+    LogSingleton::GetInstance().SetLayerMode(rocfft_layer_mode_log_events);
+
+    // the library process that started this helper is already
+    // writing to the file, so write alongside it
+    auto path = rocfft_getenv("ROCFFT_LOG_EVENTS_PATH");
+    if(!path.empty())
+        path += "." + std::to_string(GETPID());
+    start_trace(path);
+}
+
+void event_trace_cleanup()
+{
+    auto& state = trace_state();
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if(!state.out)
+            return;
+        state.stop = true;
+    }
+    state.cv.notify_all();
+    state.drainer.join();
+
+    // pick up anything recorded since the last drain
+    drain_rings(state);
+    if(state.dropped)
+    {
+        TraceRecord record;
+        record.event    = TraceEvent::DROPPED_RECORDS;
+        record.begin_ns = trace_now_ns();
+        record.args[0]  = state.dropped;
+        std::string json = state.first_record ? "" : ",\n";
+        format_record(json, record, 0, GETPID());
+        std::fwrite(json.data(), 1, json.size(), state.out);
+    }
+    std::fputs("\n]\n", state.out);
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if(state.out != stderr)
+        std::fclose(state.out);
+    else
+        std::fflush(state.out);
+    state.out = nullptr;
+    state.rings.clear();
+}
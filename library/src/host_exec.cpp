@@ -0,0 +1,1288 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../../shared/arithmetic.h"
+#include "../../shared/array_predicate.h"
+#include "../../shared/concurrency.h"
+#include "../../shared/environment.h"
+#include "../../shared/rocfft_complex.h"
+#include "host_exec.h"
+#include "logging.h"
+#include "plan.h"
+#include "rocfft.h"
+#include "transform.h"
+
+// Number of rows that host kernels transform together.  Rows are
+// interleaved in scratch memory, so that the innermost loops over
+// rows can be vectorized.
+static const size_t HOST_ROWS_PER_BLOCK = 8;
+
+// Minimum number of complex elements that each thread of the pool
+// works on.  Smaller problems are not worth the synchronization.
+static const size_t HOST_ELEMS_PER_THREAD = 16384;
+
+HostThreadPool::HostThreadPool(size_t num_threads)
+{
+    for(size_t i = 1; i < num_threads; ++i)
+        workers.emplace_back([this]() { worker_loop(); });
+}
+
+HostThreadPool::~HostThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    wake.notify_all();
+    for(auto& w : workers)
+        w.join();
+}
+
+HostThreadPool& HostThreadPool::get()
+{
+    static HostThreadPool pool([]() -> size_t {
+        auto threads_str = rocfft_getenv("ROCFFT_HOST_THREADS");
+        if(!threads_str.empty())
+        {
+            auto threads = std::strtoull(threads_str.c_str(), nullptr, 10);
+            if(threads > 0)
+                return threads;
+        }
+        return std::max(rocfft_concurrency(), 1u);
+    }());
+    return pool;
+}
+
+void HostThreadPool::worker_loop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    size_t                       seen = 0;
+    while(true)
+    {
+        wake.wait(lock, [&]() { return stop || (job && generation != seen); });
+        if(stop)
+            return;
+        seen = generation;
+        ++active;
+        lock.unlock();
+        run_chunks();
+        lock.lock();
+        --active;
+        done.notify_all();
+    }
+}
+
+void HostThreadPool::run_chunks()
+{
+    while(true)
+    {
+        const size_t chunk = nextChunk.fetch_add(1);
+        if(chunk >= jobChunks)
+            return;
+        const size_t begin = chunk * jobCount / jobChunks;
+        const size_t end   = (chunk + 1) * jobCount / jobChunks;
+        try
+        {
+            (*job)(begin, end);
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(!jobFailure)
+                jobFailure = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if(++finished == jobChunks)
+            done.notify_all();
+    }
+}
+
+void HostThreadPool::parallel_for(size_t                                     count,
+                                  size_t                                     grain,
+                                  const std::function<void(size_t, size_t)>& fn)
+{
+    if(count == 0)
+        return;
+
+    // a few chunks per thread, so that uneven chunks balance out
+    const size_t chunks = std::min(DivRoundingUp<size_t>(count, std::max<size_t>(grain, 1)),
+                                   4 * size());
+
+    std::unique_lock<std::mutex> owner(busy, std::try_to_lock);
+    if(chunks < 2 || workers.empty() || !owner.owns_lock())
+    {
+        fn(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job        = &fn;
+        jobCount   = count;
+        jobChunks  = chunks;
+        finished   = 0;
+        jobFailure = nullptr;
+        nextChunk  = 0;
+        ++generation;
+    }
+    wake.notify_all();
+
+    run_chunks();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]() { return finished == jobChunks && active == 0; });
+    job = nullptr;
+    if(jobFailure)
+        std::rethrow_exception(jobFailure);
+}
+
+hipDeviceProp_t HostDeviceProp()
+{
+    hipDeviceProp_t prop = {};
+
+    int deviceId = 0;
+    if(hipGetDevice(&deviceId) == hipSuccess
+       && hipGetDeviceProperties(&prop, deviceId) == hipSuccess)
+        return prop;
+
+    prop = {};
+    prop.warpSize = 64;
+    return prop;
+}
+
+// exp(sign * 2 * pi * i * num / den), with the angle computed in
+// double precision after reducing num
+template <typename Treal>
+static rocfft_complex<Treal> unit_root(int sign, size_t num, size_t den)
+{
+    const double angle
+        = sign * 2.0 * M_PI * static_cast<double>(num % den) / static_cast<double>(den);
+    return {static_cast<Treal>(cos(angle)), static_cast<Treal>(sin(angle))};
+}
+
+template <typename Treal>
+static rocfft_complex<Treal> conj(const rocfft_complex<Treal>& z)
+{
+    return {z.x, -z.y};
+}
+
+template <typename Treal>
+static rocfft_complex<Treal> cmul(const rocfft_complex<Treal>& a, const rocfft_complex<Treal>& b)
+{
+    return {a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x};
+}
+
+// Complex elements of a buffer that is either interleaved or planar.
+template <typename Treal>
+struct HostComplexArray
+{
+    HostComplexArray(void* const buf[2], rocfft_array_type type)
+    {
+        re = static_cast<Treal*>(buf[0]);
+        if(array_type_is_planar(type))
+        {
+            im   = static_cast<Treal*>(buf[1]);
+            step = 1;
+        }
+        else
+        {
+            im   = re + 1;
+            step = 2;
+        }
+    }
+
+    rocfft_complex<Treal> load(size_t i) const
+    {
+        return {re[i * step], im[i * step]};
+    }
+    void store(size_t i, const rocfft_complex<Treal>& z) const
+    {
+        re[i * step] = z.x;
+        im[i * step] = z.y;
+    }
+
+    Treal* re   = nullptr;
+    Treal* im   = nullptr;
+    size_t step = 2;
+};
+
+// Lengths and strides of a node, with the batch appended as the
+// slowest dimension.
+struct HostShape
+{
+    explicit HostShape(const TreeNode& node)
+        : lengths(node.length)
+        , inStride(node.inStride)
+        , outStride(node.outStride)
+    {
+        lengths.push_back(node.batch);
+        inStride.push_back(node.iDist);
+        outStride.push_back(node.oDist);
+    }
+
+    // number of index combinations of dimensions first and up
+    size_t count(size_t first) const
+    {
+        return std::accumulate(
+            lengths.begin() + first, lengths.end(), static_cast<size_t>(1), std::multiplies<>());
+    }
+
+    // Set idx[d] for dimensions first and up, from an index over
+    // those dimensions in which dimension first moves fastest.
+    void decompose(size_t linear, size_t first, std::vector<size_t>& idx) const
+    {
+        for(size_t d = first; d < lengths.size(); ++d)
+        {
+            idx[d] = linear % lengths[d];
+            linear /= lengths[d];
+        }
+    }
+
+    static size_t offset(const std::vector<size_t>& idx,
+                         const std::vector<size_t>& stride,
+                         size_t                     first)
+    {
+        size_t off = 0;
+        for(size_t d = first; d < stride.size(); ++d)
+            off += idx[d] * stride[d];
+        return off;
+    }
+
+    std::vector<size_t> lengths;
+    std::vector<size_t> inStride;
+    std::vector<size_t> outStride;
+};
+
+// Radices for a Stockham FFT of the given length.  Use the leading
+// factors that the kernel generator chose for the node if they
+// multiply out to the length, and consume them from the list.
+// Otherwise, factor the length into small radices.
+static std::vector<size_t> host_factors(size_t length, std::vector<size_t>& kernelFactors)
+{
+    size_t product = 1;
+    for(size_t i = 0; i < kernelFactors.size() && product < length; ++i)
+    {
+        product *= kernelFactors[i];
+        if(product == length)
+        {
+            std::vector<size_t> factors(kernelFactors.begin(), kernelFactors.begin() + i + 1);
+            kernelFactors.erase(kernelFactors.begin(), kernelFactors.begin() + i + 1);
+            return factors;
+        }
+    }
+
+    std::vector<size_t> factors;
+    for(size_t radix : {8, 4, 2, 3, 5, 7, 11, 13})
+    {
+        while(length % radix == 0)
+        {
+            factors.push_back(radix);
+            length /= radix;
+        }
+    }
+    for(size_t radix = 17; length > 1; radix += 2)
+    {
+        while(length % radix == 0)
+        {
+            factors.push_back(radix);
+            length /= radix;
+        }
+    }
+    return factors;
+}
+
+// Self-sorting Stockham FFT of one length and direction.  Each pass
+// of radix R splits the remaining length n into R interleaved
+// subsequences of length m = n / R, does an R-point DFT across them
+// and multiplies by twiddles, writing results in order so that no
+// final reordering is needed.
+template <typename Treal>
+class HostStockham
+{
+public:
+    using complex_t = rocfft_complex<Treal>;
+
+    HostStockham() = default;
+    HostStockham(size_t length, int direction, const std::vector<size_t>& factors)
+        : n(length)
+    {
+        size_t remaining = length;
+        size_t stride    = 1;
+        for(auto radix : factors)
+        {
+            Pass pass;
+            pass.radix = radix;
+            pass.m     = remaining / radix;
+            pass.s     = stride;
+            for(size_t u = 0; u < radix; ++u)
+                pass.roots.push_back(unit_root<Treal>(direction, u, radix));
+            for(size_t p = 0; p < pass.m; ++p)
+                for(size_t u = 0; u < radix; ++u)
+                    pass.twiddles.push_back(unit_root<Treal>(direction, p * u, remaining));
+            passes.push_back(std::move(pass));
+
+            remaining /= radix;
+            stride *= radix;
+        }
+        if(remaining != 1)
+            throw std::runtime_error("host FFT factors don't match length "
+                                     + std::to_string(length));
+    }
+
+    size_t length() const
+    {
+        return n;
+    }
+
+    // Transform rows rows held in data, with element k of row r at
+    // data[k * rows + r].  work must be as large as data.  Returns
+    // whichever of data or work holds the result.
+    complex_t* run(complex_t* data, complex_t* work, size_t rows) const
+    {
+        complex_t* x = data;
+        complex_t* y = work;
+        for(const auto& pass : passes)
+        {
+            const size_t R = pass.radix;
+            const size_t m = pass.m;
+            const size_t s = pass.s;
+            for(size_t p = 0; p < m; ++p)
+            {
+                for(size_t u = 0; u < R; ++u)
+                {
+                    const complex_t tw = pass.twiddles[p * R + u];
+                    for(size_t q = 0; q < s; ++q)
+                    {
+                        complex_t*       out = y + (q + s * (R * p + u)) * rows;
+                        const complex_t* a0  = x + (q + s * p) * rows;
+                        for(size_t r = 0; r < rows; ++r)
+                            out[r] = a0[r];
+                        for(size_t t = 1; t < R; ++t)
+                        {
+                            const complex_t  w = pass.roots[(t * u) % R];
+                            const complex_t* a = x + (q + s * (p + t * m)) * rows;
+                            for(size_t r = 0; r < rows; ++r)
+                            {
+                                out[r].x += a[r].x * w.x - a[r].y * w.y;
+                                out[r].y += a[r].x * w.y + a[r].y * w.x;
+                            }
+                        }
+                        if(p * u != 0)
+                        {
+                            for(size_t r = 0; r < rows; ++r)
+                                out[r] = {out[r].x * tw.x - out[r].y * tw.y,
+                                          out[r].x * tw.y + out[r].y * tw.x};
+                        }
+                    }
+                }
+            }
+            std::swap(x, y);
+        }
+        return x;
+    }
+
+private:
+    struct Pass
+    {
+        size_t radix = 0;
+        size_t m     = 0;
+        size_t s     = 0;
+        // radix-th roots of unity
+        std::vector<complex_t> roots;
+        // twiddles for each of the m subsequences and radix outputs
+        std::vector<complex_t> twiddles;
+    };
+
+    size_t            n = 1;
+    std::vector<Pass> passes;
+};
+
+// Number of blocks of rows that makes each thread do a worthwhile
+// amount of work, for rows of the given length.
+static size_t host_row_grain(size_t rowLength)
+{
+    const size_t blockElems = std::max<size_t>(rowLength, 1) * HOST_ROWS_PER_BLOCK;
+    return std::max<size_t>(1, HOST_ELEMS_PER_THREAD / blockElems);
+}
+
+// Post-processing of an N = 2M point real-to-complex FFT that was
+// computed as an M point complex FFT z.  Writes the M + 1 non-redundant
+// outputs to x.
+template <typename Treal>
+static void host_r2c_post(const rocfft_complex<Treal>* z, size_t M, rocfft_complex<Treal>* x)
+{
+    x[0] = {z[0].x + z[0].y, 0};
+    x[M] = {z[0].x - z[0].y, 0};
+    for(size_t k = 1; k < M; ++k)
+    {
+        const auto p   = z[k];
+        const auto q   = conj(z[M - k]);
+        const auto tw  = unit_root<Treal>(-1, k, 2 * M);
+        const auto e   = rocfft_complex<Treal>{(p.x + q.x) / 2, (p.y + q.y) / 2};
+        const auto d   = rocfft_complex<Treal>{(p.x - q.x) / 2, (p.y - q.y) / 2};
+        // odd part is d / i
+        const auto o   = rocfft_complex<Treal>{d.y, -d.x};
+        x[k]           = {e.x + tw.x * o.x - tw.y * o.y, e.y + tw.x * o.y + tw.y * o.x};
+    }
+}
+
+// Pre-processing of an N = 2M point complex-to-real FFT, that turns
+// the M + 1 non-redundant inputs x into the input z of an M point
+// complex FFT.  The result is unnormalized, like the transform.
+template <typename Treal>
+static void host_c2r_pre(const rocfft_complex<Treal>* x, size_t M, rocfft_complex<Treal>* z)
+{
+    z[0] = {x[0].x + x[M].x, x[0].x - x[M].x};
+    for(size_t k = 1; k < M; ++k)
+    {
+        const auto p  = x[k];
+        const auto q  = conj(x[M - k]);
+        const auto tw = unit_root<Treal>(1, k, 2 * M);
+        const auto e  = rocfft_complex<Treal>{p.x + q.x, p.y + q.y};
+        const auto d  = rocfft_complex<Treal>{p.x - q.x, p.y - q.y};
+        // i * tw * d
+        const auto o  = rocfft_complex<Treal>{tw.x * d.x - tw.y * d.y, tw.x * d.y + tw.y * d.x};
+        z[k]          = {e.x - o.y, e.y + o.x};
+    }
+}
+
+// Common parts of host kernels
+template <typename Treal>
+class HostKernelBase : public HostKernel
+{
+public:
+    using complex_t = rocfft_complex<Treal>;
+
+    explicit HostKernelBase(const TreeNode& node)
+        : node(node)
+        , shape(node)
+        , scale(static_cast<Treal>(node.scale_factor))
+    {
+    }
+
+protected:
+    complex_t scaled(const complex_t& z) const
+    {
+        return node.IsScalingEnabled() ? complex_t{z.x * scale, z.y * scale} : z;
+    }
+
+    const TreeNode& node;
+    HostShape       shape;
+    Treal           scale;
+};
+
+// FFTs along the fastest dimension, as done by the Stockham kernels
+// and the fused Stockham + transpose kernels.  Input is read in its
+// natural order; the scheme decides where outputs are written.
+// Embedded real/complex processing and large 1D twiddles are applied
+// as for the device kernel.
+template <typename Treal>
+class HostStockhamKernel : public HostKernelBase<Treal>
+{
+    using typename HostKernelBase<Treal>::complex_t;
+    using HostKernelBase<Treal>::node;
+    using HostKernelBase<Treal>::shape;
+
+public:
+    HostStockhamKernel(const TreeNode& node, std::vector<size_t> factors)
+        : HostKernelBase<Treal>(node)
+        , fft(node.length[0], node.direction, host_factors(node.length[0], factors))
+    {
+        if(node.large1D)
+        {
+            // the twiddle index along the other dimension comes from
+            // the batch when transforms are counted by batch
+            twiddleDim = node.largeTwdBatchIsTransformCount ? node.length.size() : 1;
+        }
+    }
+
+    void launch(void* const     bufIn[2],
+                void* const     bufOut[2],
+                void*           bufTemp,
+                HostThreadPool& pool) const override
+    {
+        const HostComplexArray<Treal> in(bufIn, node.inArrayType);
+        const HostComplexArray<Treal> out(bufOut, node.outArrayType);
+
+        const size_t n        = node.length[0];
+        const bool   pre      = node.ebtype == EmbeddedType::C2Real_PRE;
+        const bool   post     = node.ebtype == EmbeddedType::Real2C_POST;
+        const size_t loadLen  = pre ? n + 1 : n;
+        const size_t storeLen = post ? n + 1 : n;
+        const size_t rows     = shape.count(1);
+
+        auto blocks = [&](size_t begin, size_t end) {
+            std::vector<complex_t> data(n * HOST_ROWS_PER_BLOCK);
+            std::vector<complex_t> work(n * HOST_ROWS_PER_BLOCK);
+            std::vector<complex_t> row(n + 1);
+            std::vector<complex_t> processed(n + 1);
+            std::vector<size_t>    idx(shape.lengths.size());
+
+            for(size_t block = begin; block < end; ++block)
+            {
+                const size_t row0  = block * HOST_ROWS_PER_BLOCK;
+                const size_t nrows = std::min(HOST_ROWS_PER_BLOCK, rows - row0);
+
+                for(size_t r = 0; r < nrows; ++r)
+                {
+                    shape.decompose(row0 + r, 1, idx);
+                    const size_t inOffset = HostShape::offset(idx, shape.inStride, 1);
+                    for(size_t k = 0; k < loadLen; ++k)
+                        row[k] = in.load(inOffset + k * shape.inStride[0]);
+                    if(pre)
+                    {
+                        host_c2r_pre(row.data(), n, processed.data());
+                        std::swap(row, processed);
+                    }
+                    for(size_t k = 0; k < n; ++k)
+                        data[k * nrows + r] = row[k];
+                }
+
+                const complex_t* result = fft.run(data.data(), work.data(), nrows);
+
+                for(size_t r = 0; r < nrows; ++r)
+                {
+                    shape.decompose(row0 + r, 1, idx);
+                    for(size_t k = 0; k < n; ++k)
+                        row[k] = result[k * nrows + r];
+                    if(post)
+                    {
+                        host_r2c_post(row.data(), n, processed.data());
+                        std::swap(row, processed);
+                    }
+                    for(size_t k = 0; k < storeLen; ++k)
+                    {
+                        auto elem = row[k];
+                        if(node.large1D)
+                            elem = cmul(elem,
+                                        unit_root<Treal>(
+                                            node.direction, k * idx[twiddleDim], node.large1D));
+                        out.store(output_offset(k, idx), this->scaled(elem));
+                    }
+                }
+            }
+        };
+        pool.parallel_for(
+            DivRoundingUp(rows, HOST_ROWS_PER_BLOCK), host_row_grain(n), blocks);
+    }
+
+private:
+    // offset of output element k of the row at idx
+    size_t output_offset(size_t k, const std::vector<size_t>& idx) const
+    {
+        const auto& os = shape.outStride;
+        switch(node.scheme)
+        {
+        case CS_KERNEL_STOCKHAM_BLOCK_RC:
+            // rows are written as columns
+            return idx[1] * os[0] + k * os[1] + HostShape::offset(idx, os, 2);
+        case CS_KERNEL_STOCKHAM_TRANSPOSE_XY_Z:
+            return idx[2] * os[0] + k * os[1] + idx[1] * os[2] + HostShape::offset(idx, os, 3);
+        case CS_KERNEL_STOCKHAM_TRANSPOSE_Z_XY:
+        case CS_KERNEL_STOCKHAM_R_TO_CMPLX_TRANSPOSE_Z_XY:
+            return idx[1] * os[0] + idx[2] * os[1] + k * os[2] + HostShape::offset(idx, os, 3);
+        default:
+            return k * os[0] + HostShape::offset(idx, os, 1);
+        }
+    }
+
+    HostStockham<Treal> fft;
+    size_t              twiddleDim = 1;
+};
+
+// 2D or 3D FFT over the fastest dimensions, in natural order
+template <typename Treal>
+class HostSingleKernel : public HostKernelBase<Treal>
+{
+    using typename HostKernelBase<Treal>::complex_t;
+    using HostKernelBase<Treal>::node;
+    using HostKernelBase<Treal>::shape;
+
+public:
+    HostSingleKernel(const TreeNode& node, std::vector<size_t> factors, size_t dims)
+        : HostKernelBase<Treal>(node)
+    {
+        // kernel factors list the radices for the fastest dimension,
+        // then the next one, and so on
+        for(size_t d = 0; d < dims; ++d)
+            ffts.emplace_back(
+                node.length[d], node.direction, host_factors(node.length[d], factors));
+    }
+
+    void launch(void* const     bufIn[2],
+                void* const     bufOut[2],
+                void*           bufTemp,
+                HostThreadPool& pool) const override
+    {
+        const HostComplexArray<Treal> in(bufIn, node.inArrayType);
+        const HostComplexArray<Treal> out(bufOut, node.outArrayType);
+
+        const size_t dims = ffts.size();
+        const size_t brick = product(node.length.begin(), node.length.begin() + dims);
+
+        auto bricks = [&](size_t begin, size_t end) {
+            // the brick is kept with dim 0 moving fastest, and is
+            // transformed along each dimension in turn, one row per
+            // lane
+            std::vector<complex_t> elems(brick);
+            std::vector<complex_t> data(brick);
+            std::vector<complex_t> work(brick);
+            std::vector<size_t>    idx(shape.lengths.size());
+
+            for(size_t i = begin; i < end; ++i)
+            {
+                shape.decompose(i, dims, idx);
+                const size_t inOffset  = HostShape::offset(idx, shape.inStride, dims);
+                const size_t outOffset = HostShape::offset(idx, shape.outStride, dims);
+
+                for(size_t e = 0; e < brick; ++e)
+                    elems[e] = in.load(inOffset + brick_offset(e, shape.inStride));
+
+                size_t inner = 1;
+                for(const auto& fft : ffts)
+                {
+                    // element k of the row at lane is at
+                    // (lane / inner) * inner * len + k * inner + lane % inner
+                    const size_t len   = fft.length();
+                    const size_t lanes = brick / len;
+                    for(size_t lane = 0; lane < lanes; ++lane)
+                    {
+                        const size_t base = (lane / inner) * inner * len + lane % inner;
+                        for(size_t k = 0; k < len; ++k)
+                            data[k * lanes + lane] = elems[base + k * inner];
+                    }
+                    const complex_t* result = fft.run(data.data(), work.data(), lanes);
+                    for(size_t lane = 0; lane < lanes; ++lane)
+                    {
+                        const size_t base = (lane / inner) * inner * len + lane % inner;
+                        for(size_t k = 0; k < len; ++k)
+                            elems[base + k * inner] = result[k * lanes + lane];
+                    }
+                    inner *= len;
+                }
+
+                for(size_t e = 0; e < brick; ++e)
+                    out.store(outOffset + brick_offset(e, shape.outStride),
+                              this->scaled(elems[e]));
+            }
+        };
+        pool.parallel_for(
+            shape.count(dims), std::max<size_t>(1, HOST_ELEMS_PER_THREAD / brick), bricks);
+    }
+
+private:
+    // offset of element e of a brick, counting with dim 0 fastest
+    size_t brick_offset(size_t e, const std::vector<size_t>& stride) const
+    {
+        size_t offset = 0;
+        for(size_t d = 0; d < ffts.size(); ++d)
+        {
+            offset += (e % ffts[d].length()) * stride[d];
+            e /= ffts[d].length();
+        }
+        return offset;
+    }
+
+    std::vector<HostStockham<Treal>> ffts;
+};
+
+// Element-wise copy between two layouts of the same shape, as done by
+// the transpose kernels (the permutation is in the output strides),
+// with the large 1D twiddle multiplied in if the node has one.
+template <typename Treal>
+class HostTransposeKernel : public HostKernelBase<Treal>
+{
+    using typename HostKernelBase<Treal>::complex_t;
+    using HostKernelBase<Treal>::node;
+    using HostKernelBase<Treal>::shape;
+
+public:
+    explicit HostTransposeKernel(const TreeNode& node)
+        : HostKernelBase<Treal>(node)
+    {
+    }
+
+    void launch(void* const     bufIn[2],
+                void* const     bufOut[2],
+                void*           bufTemp,
+                HostThreadPool& pool) const override
+    {
+        const HostComplexArray<Treal> in(bufIn, node.inArrayType);
+        const HostComplexArray<Treal> out(bufOut, node.outArrayType);
+
+        const size_t len0 = node.length[0];
+
+        auto rows = [&](size_t begin, size_t end) {
+            std::vector<size_t> idx(shape.lengths.size());
+            for(size_t row = begin; row < end; ++row)
+            {
+                shape.decompose(row, 1, idx);
+                const size_t inOffset  = HostShape::offset(idx, shape.inStride, 1);
+                const size_t outOffset = HostShape::offset(idx, shape.outStride, 1);
+                for(size_t k = 0; k < len0; ++k)
+                {
+                    auto elem = in.load(inOffset + k * shape.inStride[0]);
+                    if(node.large1D)
+                        elem = cmul(elem,
+                                    unit_root<Treal>(node.direction, k * idx[1], node.large1D));
+                    out.store(outOffset + k * shape.outStride[0], this->scaled(elem));
+                }
+            }
+        };
+        pool.parallel_for(shape.count(1), host_row_grain(len0) * HOST_ROWS_PER_BLOCK, rows);
+    }
+};
+
+// Standalone post-processing after an even-length real-to-complex
+// FFT (R_TO_CMPLX), or pre-processing before an even-length
+// complex-to-real FFT (CMPLX_TO_R).  Rows are contiguous, higher
+// dimensions are rows apart.
+template <typename Treal>
+class HostRealComplexEvenKernel : public HostKernelBase<Treal>
+{
+    using typename HostKernelBase<Treal>::complex_t;
+    using HostKernelBase<Treal>::node;
+    using HostKernelBase<Treal>::shape;
+
+public:
+    explicit HostRealComplexEvenKernel(const TreeNode& node)
+        : HostKernelBase<Treal>(node)
+    {
+    }
+
+    void launch(void* const     bufIn[2],
+                void* const     bufOut[2],
+                void*           bufTemp,
+                HostThreadPool& pool) const override
+    {
+        const HostComplexArray<Treal> in(bufIn, node.inArrayType);
+        const HostComplexArray<Treal> out(bufOut, node.outArrayType);
+
+        const bool   r2c    = node.scheme == CS_KERNEL_R_TO_CMPLX;
+        const size_t half_N = r2c ? node.length[0] : node.length[0] - 1;
+        const size_t high   = shape.count(1) / node.batch;
+        const size_t is1    = node.length.size() > 1 ? node.inStride[1] : 0;
+        const size_t os1    = node.length.size() > 1 ? node.outStride[1] : 0;
+
+        auto rows = [&](size_t begin, size_t end) {
+            std::vector<complex_t> x(half_N + 1);
+            std::vector<complex_t> y(half_N + 1);
+            for(size_t row = begin; row < end; ++row)
+            {
+                const size_t b         = row / high;
+                const size_t h         = row % high;
+                const size_t inOffset  = b * node.iDist + h * is1;
+                const size_t outOffset = b * node.oDist + h * os1;
+
+                const size_t loadLen = r2c ? half_N : half_N + 1;
+                for(size_t k = 0; k < loadLen; ++k)
+                    x[k] = in.load(inOffset + k);
+                if(r2c)
+                    host_r2c_post(x.data(), half_N, y.data());
+                else
+                    host_c2r_pre(x.data(), half_N, y.data());
+                const size_t storeLen = r2c ? half_N + 1 : half_N;
+                for(size_t k = 0; k < storeLen; ++k)
+                    out.store(outOffset + k, this->scaled(y[k]));
+            }
+        };
+        pool.parallel_for(shape.count(1), host_row_grain(half_N) * HOST_ROWS_PER_BLOCK, rows);
+    }
+};
+
+// Real/complex processing fused with a transpose
+// (R_TO_CMPLX_TRANSPOSE, TRANSPOSE_CMPLX_TO_R), for 2D and 3D
+// even-length real transforms.
+template <typename Treal>
+class HostRealComplexEvenTransposeKernel : public HostKernelBase<Treal>
+{
+    using typename HostKernelBase<Treal>::complex_t;
+    using HostKernelBase<Treal>::node;
+    using HostKernelBase<Treal>::shape;
+
+public:
+    explicit HostRealComplexEvenTransposeKernel(const TreeNode& node)
+        : HostKernelBase<Treal>(node)
+    {
+    }
+
+    void launch(void* const     bufIn[2],
+                void* const     bufOut[2],
+                void*           bufTemp,
+                HostThreadPool& pool) const override
+    {
+        const HostComplexArray<Treal> in(bufIn, node.inArrayType);
+        const HostComplexArray<Treal> out(bufOut, node.outArrayType);
+
+        const size_t dim  = node.length.size();
+        const bool   r2c  = node.scheme == CS_KERNEL_R_TO_CMPLX_TRANSPOSE;
+        const auto&  is   = node.inStride;
+        const auto&  os   = node.outStride;
+        const size_t len0 = node.length[0];
+        const size_t len1 = node.length[1];
+
+        // R_TO_CMPLX_TRANSPOSE: each row along dim 0 is post-processed
+        // and written as a column along the slowest dimension.
+        //
+        // TRANSPOSE_CMPLX_TO_R: each column along the slowest dimension
+        // is pre-processed and written as a row along dim 0.
+        const size_t half_N = r2c ? len0 : node.length[dim - 1] - 1;
+        const size_t lines  = r2c ? (dim == 3 ? len1 * node.length[2] : len1)
+                                  : (dim == 3 ? len0 * len1 : len0);
+
+        auto work = [&](size_t begin, size_t end) {
+            std::vector<complex_t> x(half_N + 1);
+            std::vector<complex_t> y(half_N + 1);
+            for(size_t i = begin; i < end; ++i)
+            {
+                const size_t b    = i / lines;
+                const size_t line = i % lines;
+                if(r2c)
+                {
+                    const size_t inOffset = b * node.iDist + (line % len1) * is[1]
+                                            + (dim == 3 ? (line / len1) * is[2] : 0);
+                    const size_t osLast   = os[dim - 1];
+                    for(size_t k = 0; k < half_N; ++k)
+                        x[k] = in.load(inOffset + k);
+                    host_r2c_post(x.data(), half_N, y.data());
+                    for(size_t k = 0; k <= half_N; ++k)
+                        out.store(b * node.oDist + k * osLast + line, this->scaled(y[k]));
+                }
+                else
+                {
+                    const size_t c0       = line % len0;
+                    const size_t c1       = line / len0;
+                    const size_t isLast   = is[dim - 1];
+                    const size_t inOffset = b * node.iDist + c0 * is[0] + c1 * is[1];
+                    const size_t outOffset
+                        = b * node.oDist + c0 * os[1] + (dim == 3 ? c1 * os[2] : 0);
+                    for(size_t k = 0; k <= half_N; ++k)
+                        x[k] = in.load(inOffset + k * isLast);
+                    host_c2r_pre(x.data(), half_N, y.data());
+                    for(size_t k = 0; k < half_N; ++k)
+                        out.store(outOffset + k * os[0], this->scaled(y[k]));
+                }
+            }
+        };
+        pool.parallel_for(
+            lines * node.batch, host_row_grain(half_N) * HOST_ROWS_PER_BLOCK, work);
+    }
+};
+
+// Copies between real and complex data for odd-length real
+// transforms, which are done as complex transforms
+template <typename Treal>
+class HostRealComplexCopyKernel : public HostKernelBase<Treal>
+{
+    using typename HostKernelBase<Treal>::complex_t;
+    using HostKernelBase<Treal>::node;
+    using HostKernelBase<Treal>::shape;
+
+public:
+    explicit HostRealComplexCopyKernel(const TreeNode& node)
+        : HostKernelBase<Treal>(node)
+    {
+    }
+
+    void launch(void* const     bufIn[2],
+                void* const     bufOut[2],
+                void*           bufTemp,
+                HostThreadPool& pool) const override
+    {
+        const size_t len0 = node.length[0];
+
+        auto rows = [&](size_t begin, size_t end) {
+            std::vector<size_t> idx(shape.lengths.size());
+            for(size_t row = begin; row < end; ++row)
+            {
+                shape.decompose(row, 1, idx);
+                const size_t inOffset  = HostShape::offset(idx, shape.inStride, 1);
+                const size_t outOffset = HostShape::offset(idx, shape.outStride, 1);
+                const size_t is0       = shape.inStride[0];
+                const size_t os0       = shape.outStride[0];
+                switch(node.scheme)
+                {
+                case CS_KERNEL_COPY_R_TO_CMPLX:
+                {
+                    const Treal*                  in = static_cast<const Treal*>(bufIn[0]);
+                    const HostComplexArray<Treal> out(bufOut, node.outArrayType);
+                    for(size_t k = 0; k < len0; ++k)
+                        out.store(outOffset + k * os0,
+                                  this->scaled({in[inOffset + k * is0], 0}));
+                    break;
+                }
+                case CS_KERNEL_COPY_CMPLX_TO_R:
+                {
+                    const HostComplexArray<Treal> in(bufIn, node.inArrayType);
+                    Treal*                        out = static_cast<Treal*>(bufOut[0]);
+                    for(size_t k = 0; k < len0; ++k)
+                        out[outOffset + k * os0] = this->scaled(in.load(inOffset + k * is0)).x;
+                    break;
+                }
+                case CS_KERNEL_COPY_CMPLX_TO_HERM:
+                {
+                    const HostComplexArray<Treal> in(bufIn, node.inArrayType);
+                    const HostComplexArray<Treal> out(bufOut, node.outArrayType);
+                    for(size_t k = 0; k < len0 / 2 + 1; ++k)
+                        out.store(outOffset + k * os0, this->scaled(in.load(inOffset + k * is0)));
+                    break;
+                }
+                case CS_KERNEL_COPY_HERM_TO_CMPLX:
+                {
+                    // expand the non-redundant half of dim 0 to a full
+                    // complex array, using Hermitian symmetry
+                    const HostComplexArray<Treal> in(bufIn, node.inArrayType);
+                    const HostComplexArray<Treal> out(bufOut, node.outArrayType);
+                    const size_t                  outLen0 = node.outputLength[0];
+                    for(size_t k = 0; k < outLen0 / 2 + 1; ++k)
+                    {
+                        const auto elem = this->scaled(in.load(inOffset + k * is0));
+                        out.store(outOffset + k * os0, elem);
+                        if(k == 0 || 2 * k == outLen0)
+                            continue;
+
+                        size_t mirror = ((outLen0 - k) % outLen0) * os0;
+                        for(size_t d = 1; d < node.length.size(); ++d)
+                            mirror += ((node.length[d] - idx[d]) % node.length[d])
+                                      * shape.outStride[d];
+                        mirror += idx.back() * node.oDist;
+                        out.store(mirror, conj(elem));
+                    }
+                    break;
+                }
+                default:
+                    throw std::runtime_error("invalid copy scheme");
+                }
+            }
+        };
+        pool.parallel_for(shape.count(1), host_row_grain(len0) * HOST_ROWS_PER_BLOCK, rows);
+    }
+};
+
+// Chirp setup for Bluestein's algorithm.  Writes the chirp to the
+// first 2 * lengthBlue elements of the Bluestein buffer: the chirp
+// and its mirror image, zero padded to lengthBlue, twice.
+template <typename Treal>
+class HostChirpKernel : public HostKernelBase<Treal>
+{
+    using typename HostKernelBase<Treal>::complex_t;
+    using HostKernelBase<Treal>::node;
+
+public:
+    explicit HostChirpKernel(const TreeNode& node)
+        : HostKernelBase<Treal>(node)
+    {
+    }
+
+    void launch(void* const     bufIn[2],
+                void* const     bufOut[2],
+                void*           bufTemp,
+                HostThreadPool& pool) const override
+    {
+        const size_t N     = node.length[0];
+        const size_t M     = node.lengthBlue;
+        complex_t*   chirp = static_cast<complex_t*>(bufOut[0]);
+
+        for(size_t i = 0; i < M; ++i)
+            chirp[i] = chirp[i + M] = {0, 0};
+        for(size_t i = 0; i < N; ++i)
+        {
+            const auto val = unit_root<Treal>(-node.direction, (i * i) % (2 * N), 2 * N);
+            chirp[i] = chirp[i + M] = val;
+            if(i > 0)
+                chirp[M - i] = chirp[2 * M - i] = val;
+        }
+    }
+};
+
+// Element-wise steps of multi-kernel Bluestein: pad and multiply
+// input by the chirp (PAD_MUL), multiply by the transformed chirp
+// (FFT_MUL), and multiply the result by the chirp (RES_MUL).
+template <typename Treal>
+class HostBluesteinMulKernel : public HostKernelBase<Treal>
+{
+    using typename HostKernelBase<Treal>::complex_t;
+    using HostKernelBase<Treal>::node;
+    using HostKernelBase<Treal>::shape;
+
+public:
+    explicit HostBluesteinMulKernel(const TreeNode& node)
+        : HostKernelBase<Treal>(node)
+    {
+    }
+
+    void launch(void* const     bufIn[2],
+                void* const     bufOut[2],
+                void*           bufTemp,
+                HostThreadPool& pool) const override
+    {
+        const HostComplexArray<Treal> in(bufIn, node.inArrayType);
+        const HostComplexArray<Treal> out(bufOut, node.outArrayType);
+
+        const size_t N   = node.length[0];
+        const size_t M   = node.lengthBlue;
+        const size_t is0 = shape.inStride[0];
+        const size_t os0 = shape.outStride[0];
+
+        auto rows = [&](size_t begin, size_t end) {
+            std::vector<size_t> idx(shape.lengths.size());
+            for(size_t row = begin; row < end; ++row)
+            {
+                shape.decompose(row, 1, idx);
+                const size_t inOffset  = HostShape::offset(idx, shape.inStride, 1);
+                const size_t outOffset = HostShape::offset(idx, shape.outStride, 1);
+                switch(node.scheme)
+                {
+                case CS_KERNEL_PAD_MUL:
+                    // chirp is the second copy in the output buffer,
+                    // padded rows follow it
+                    for(size_t k = 0; k < M; ++k)
+                    {
+                        complex_t elem = {0, 0};
+                        if(k < N)
+                            elem = cmul(in.load(inOffset + k * is0), conj(out.load(M + k)));
+                        out.store(2 * M + outOffset + k * os0, elem);
+                    }
+                    break;
+                case CS_KERNEL_FFT_MUL:
+                    for(size_t k = 0; k < M; ++k)
+                    {
+                        const size_t o = 2 * M + outOffset + k * os0;
+                        out.store(o, cmul(in.load(M + k * is0), out.load(o)));
+                    }
+                    break;
+                case CS_KERNEL_RES_MUL:
+                {
+                    const Treal MI = static_cast<Treal>(1.0) / static_cast<Treal>(M);
+                    for(size_t k = 0; k < N; ++k)
+                    {
+                        auto elem = cmul(in.load(2 * M + inOffset + k * is0), conj(in.load(k)));
+                        out.store(outOffset + k * os0,
+                                  this->scaled(complex_t{elem.x * MI, elem.y * MI}));
+                    }
+                    break;
+                }
+                default:
+                    throw std::runtime_error("invalid bluestein scheme");
+                }
+            }
+        };
+        pool.parallel_for(shape.count(1), host_row_grain(M) * HOST_ROWS_PER_BLOCK, rows);
+    }
+};
+
+// Single-kernel Bluestein: chirp is at the start of the temp buffer,
+// followed by its FFT.  Each row is padded and multiplied by the
+// chirp, convolved with it using forward and inverse FFTs of
+// lengthBlue, and multiplied by the chirp again.
+template <typename Treal>
+class HostBluesteinSingleKernel : public HostKernelBase<Treal>
+{
+    using typename HostKernelBase<Treal>::complex_t;
+    using HostKernelBase<Treal>::node;
+    using HostKernelBase<Treal>::shape;
+
+public:
+    HostBluesteinSingleKernel(const TreeNode& node, std::vector<size_t> factors)
+        : HostKernelBase<Treal>(node)
+    {
+        auto factorsBlue = host_factors(node.lengthBlue, factors);
+        forward          = HostStockham<Treal>(node.lengthBlue, node.direction, factorsBlue);
+        inverse          = HostStockham<Treal>(node.lengthBlue, -node.direction, factorsBlue);
+    }
+
+    void launch(void* const     bufIn[2],
+                void* const     bufOut[2],
+                void*           bufTemp,
+                HostThreadPool& pool) const override
+    {
+        const HostComplexArray<Treal> in(bufIn, node.inArrayType);
+        const HostComplexArray<Treal> out(bufOut, node.outArrayType);
+
+        const bool   inplace   = node.placement == rocfft_placement_inplace;
+        const auto&  outStride = inplace ? shape.inStride : shape.outStride;
+        const size_t N         = node.length[0];
+        const size_t M         = node.lengthBlue;
+        const size_t rows      = shape.count(1);
+
+        const complex_t* chirp    = static_cast<const complex_t*>(bufTemp);
+        const complex_t* chirpFFT = chirp + M;
+        const Treal      MI       = static_cast<Treal>(1.0) / static_cast<Treal>(M);
+
+        auto blocks = [&](size_t begin, size_t end) {
+            std::vector<complex_t> data(M * HOST_ROWS_PER_BLOCK);
+            std::vector<complex_t> work(M * HOST_ROWS_PER_BLOCK);
+            std::vector<size_t>    idx(shape.lengths.size());
+
+            for(size_t block = begin; block < end; ++block)
+            {
+                const size_t row0  = block * HOST_ROWS_PER_BLOCK;
+                const size_t nrows = std::min(HOST_ROWS_PER_BLOCK, rows - row0);
+
+                for(size_t r = 0; r < nrows; ++r)
+                {
+                    shape.decompose(row0 + r, 1, idx);
+                    const size_t inOffset = HostShape::offset(idx, shape.inStride, 1);
+                    for(size_t k = 0; k < M; ++k)
+                    {
+                        complex_t elem = {0, 0};
+                        if(k < N)
+                            elem = cmul(in.load(inOffset + k * shape.inStride[0]), conj(chirp[k]));
+                        data[k * nrows + r] = elem;
+                    }
+                }
+
+                complex_t* spectrum = forward.run(data.data(), work.data(), nrows);
+                complex_t* other    = spectrum == data.data() ? work.data() : data.data();
+                for(size_t k = 0; k < M; ++k)
+                    for(size_t r = 0; r < nrows; ++r)
+                        spectrum[k * nrows + r] = cmul(spectrum[k * nrows + r], chirpFFT[k]);
+                const complex_t* result = inverse.run(spectrum, other, nrows);
+
+                for(size_t r = 0; r < nrows; ++r)
+                {
+                    shape.decompose(row0 + r, 1, idx);
+                    const size_t outOffset = HostShape::offset(idx, outStride, 1);
+                    for(size_t k = 0; k < N; ++k)
+                    {
+                        const auto y = cmul(result[k * nrows + r], conj(chirp[k]));
+                        out.store(outOffset + k * outStride[0],
+                                  this->scaled(complex_t{y.x * MI, y.y * MI}));
+                    }
+                }
+            }
+        };
+        pool.parallel_for(DivRoundingUp(rows, HOST_ROWS_PER_BLOCK), host_row_grain(M), blocks);
+    }
+
+private:
+    HostStockham<Treal> forward;
+    HostStockham<Treal> inverse;
+};
+
+// Kernels that have nothing to do without callbacks
+class HostNopKernel : public HostKernel
+{
+public:
+    void launch(void* const     bufIn[2],
+                void* const     bufOut[2],
+                void*           bufTemp,
+                HostThreadPool& pool) const override
+    {
+    }
+};
+
+template <typename Treal>
+static std::shared_ptr<HostKernel> make_host_kernel(const TreeNode& node)
+{
+    std::vector<size_t> factors;
+    if(auto leaf = dynamic_cast<const LeafNode*>(&node))
+        factors = leaf->kernelFactors;
+
+    switch(node.scheme)
+    {
+    case CS_KERNEL_STOCKHAM:
+    case CS_KERNEL_STOCKHAM_BLOCK_CC:
+    case CS_KERNEL_STOCKHAM_BLOCK_RC:
+    case CS_KERNEL_STOCKHAM_BLOCK_CR:
+    case CS_KERNEL_STOCKHAM_TRANSPOSE_XY_Z:
+    case CS_KERNEL_STOCKHAM_TRANSPOSE_Z_XY:
+    case CS_KERNEL_STOCKHAM_R_TO_CMPLX_TRANSPOSE_Z_XY:
+        return std::make_shared<HostStockhamKernel<Treal>>(node, factors);
+    case CS_KERNEL_2D_SINGLE:
+        return std::make_shared<HostSingleKernel<Treal>>(node, factors, 2);
+    case CS_KERNEL_3D_SINGLE:
+        return std::make_shared<HostSingleKernel<Treal>>(node, factors, 3);
+    case CS_KERNEL_TRANSPOSE:
+    case CS_KERNEL_TRANSPOSE_XY_Z:
+    case CS_KERNEL_TRANSPOSE_Z_XY:
+        return std::make_shared<HostTransposeKernel<Treal>>(node);
+    case CS_KERNEL_R_TO_CMPLX:
+    case CS_KERNEL_CMPLX_TO_R:
+        return std::make_shared<HostRealComplexEvenKernel<Treal>>(node);
+    case CS_KERNEL_R_TO_CMPLX_TRANSPOSE:
+    case CS_KERNEL_TRANSPOSE_CMPLX_TO_R:
+        return std::make_shared<HostRealComplexEvenTransposeKernel<Treal>>(node);
+    case CS_KERNEL_COPY_R_TO_CMPLX:
+    case CS_KERNEL_COPY_CMPLX_TO_HERM:
+    case CS_KERNEL_COPY_HERM_TO_CMPLX:
+    case CS_KERNEL_COPY_CMPLX_TO_R:
+        return std::make_shared<HostRealComplexCopyKernel<Treal>>(node);
+    case CS_KERNEL_CHIRP:
+        return std::make_shared<HostChirpKernel<Treal>>(node);
+    case CS_KERNEL_PAD_MUL:
+    case CS_KERNEL_FFT_MUL:
+    case CS_KERNEL_RES_MUL:
+        return std::make_shared<HostBluesteinMulKernel<Treal>>(node);
+    case CS_KERNEL_BLUESTEIN_SINGLE:
+        return std::make_shared<HostBluesteinSingleKernel<Treal>>(node, factors);
+    case CS_KERNEL_APPLY_CALLBACK:
+        return std::make_shared<HostNopKernel>();
+    default:
+        throw std::runtime_error("no host kernel for scheme " + PrintScheme(node.scheme));
+    }
+}
+
+void PlanHostExec(ExecPlan& execPlan)
+{
+    for(const auto& node : execPlan.execSeq)
+    {
+        switch(node->precision)
+        {
+        case rocfft_precision_single:
+            execPlan.hostKernels.push_back(make_host_kernel<float>(*node));
+            break;
+        case rocfft_precision_double:
+            execPlan.hostKernels.push_back(make_host_kernel<double>(*node));
+            break;
+        default:
+            throw std::runtime_error("host execution requires single or double precision");
+        }
+    }
+}
+
+void ExecuteHostPlan(const ExecPlan&       execPlan,
+                     void*                 in_buffer[],
+                     void*                 out_buffer[],
+                     rocfft_execution_info info)
+{
+    assert(execPlan.execSeq.size() == execPlan.hostKernels.size());
+
+    auto& pool = HostThreadPool::get();
+    for(size_t i = 0; i < execPlan.execSeq.size(); ++i)
+    {
+        const TreeNode& node    = *execPlan.execSeq[i];
+        void*           bufIn[2]  = {};
+        void*           bufOut[2] = {};
+        void*           bufTemp   = nullptr;
+        AssignNodeBuffers(
+            execPlan, node, in_buffer, out_buffer, info->workBuffer, bufIn, bufOut, bufTemp);
+
+        execPlan.hostKernels[i]->launch(bufIn, bufOut, bufTemp, pool);
+    }
+}
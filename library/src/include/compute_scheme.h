@@ -77,7 +77,7 @@ enum ComputeScheme
     CS_3D_BLOCK_CR,
     CS_3D_RC,
     CS_KERNEL_3D_STOCKHAM_BLOCK_CC, // not implemented yet
-    CS_KERNEL_3D_SINGLE // not implemented yet
+    CS_KERNEL_3D_SINGLE
 };
 
 std::string PrintScheme(ComputeScheme cs);
@@ -0,0 +1,204 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ROCFFT_EVENT_TRACE_H
+#define ROCFFT_EVENT_TRACE_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "logging.h"
+
+// Event tracing records what the library is doing as fixed-size
+// binary records, instead of formatting text like the other logs.
+// Each thread appends records to its own ring buffer without taking
+// any locks.  A background thread drains the ring buffers and writes
+// the records out as Chrome trace JSON, which can be loaded into
+// chrome://tracing or Perfetto.
+//
+// Tracing is enabled by the ROCFFT_LAYER bit for
+// rocfft_layer_mode_log_events, and ROCFFT_LOG_EVENTS_PATH names the
+// file to write.  When it's disabled, recording an event costs one
+// check of the layer mode.
+
+#define LOG_EVENTS_ENABLED() \
+    (LogSingleton::GetInstance().GetLayerMode() & rocfft_layer_mode_log_events)
+
+enum class TraceEvent : uint16_t
+{
+    // a stage of plan creation, named by the record
+    PLAN_STAGE,
+    // creation of a whole plan
+    PLAN_CREATE,
+    // kernel found in the RTC cache
+    RTC_CACHE_HIT,
+    // kernel not found in the RTC cache
+    RTC_CACHE_MISS,
+    // generation of kernel source
+    RTC_GENERATE,
+    // compilation of kernel source
+    RTC_COMPILE,
+    // one call to rocfft_execute
+    EXECUTE,
+    // launch of one kernel of a plan
+    KERNEL_LAUNCH,
+    // number of records dropped because a ring buffer was full
+    DROPPED_RECORDS,
+};
+
+// One event.  Events with a zero end time are instantaneous.
+struct TraceRecord
+{
+    static const size_t NUM_ARGS = 3;
+    static const size_t NAME_LEN = 86;
+
+    uint64_t                       begin_ns = 0;
+    uint64_t                       end_ns   = 0;
+    std::array<uint64_t, NUM_ARGS> args     = {};
+    TraceEvent                     event    = TraceEvent::PLAN_STAGE;
+    std::array<char, NAME_LEN>     name     = {};
+
+    // names longer than the record allows are truncated
+    void set_name(const std::string& s)
+    {
+        auto len = std::min(s.size(), NAME_LEN - 1);
+        std::copy_n(s.begin(), len, name.begin());
+        name[len] = '\0';
+    }
+};
+
+static inline uint64_t trace_ns(std::chrono::steady_clock::time_point t)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+static inline uint64_t trace_now_ns()
+{
+    return trace_ns(std::chrono::steady_clock::now());
+}
+
+// Append a record to the calling thread's ring buffer.  The record
+// is dropped if the buffer is full.
+void trace_record(const TraceRecord& record);
+
+// Start and stop the thread that writes out trace records.  Called
+// by rocfft_setup and rocfft_cleanup.
+void event_trace_setup();
+void event_trace_cleanup();
+
+// Start tracing in a helper executable, if the ROCFFT_LAYER bit for
+// rocfft_layer_mode_log_events is set.  Helpers write their records
+// to ROCFFT_LOG_EVENTS_PATH with "." and their process ID appended,
+// so they don't overwrite the trace of the process that started
+// them.  Helpers call event_trace_cleanup before exiting.
+void event_trace_helper_setup();
+
+// Records an event covering the lifetime of the scope, if tracing
+// was enabled when the scope began.  Names and arguments are only
+// worth computing if the scope is active.
+class TraceScope
+{
+public:
+    explicit TraceScope(TraceEvent event, const char* name = nullptr)
+        : active(LOG_EVENTS_ENABLED())
+    {
+        if(!active)
+            return;
+        record.event = event;
+        if(name)
+            record.set_name(name);
+        record.begin_ns = trace_now_ns();
+    }
+    ~TraceScope()
+    {
+        end();
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    bool is_active() const
+    {
+        return active;
+    }
+
+    TraceScope& set_name(const std::string& name)
+    {
+        record.set_name(name);
+        return *this;
+    }
+    TraceScope& set_arg(size_t idx, uint64_t value)
+    {
+        record.args[idx] = value;
+        return *this;
+    }
+
+    // record the event now, instead of at the end of the scope
+    void end()
+    {
+        if(!active)
+            return;
+        record.end_ns = trace_now_ns();
+        trace_record(record);
+        active = false;
+    }
+
+private:
+    bool        active;
+    TraceRecord record;
+};
+
+// Record an instantaneous event, if tracing is enabled
+static inline void trace_instant(TraceEvent event, const std::string& name)
+{
+    if(!LOG_EVENTS_ENABLED())
+        return;
+    TraceRecord record;
+    record.event    = event;
+    record.begin_ns = trace_now_ns();
+    record.set_name(name);
+    trace_record(record);
+}
+
+// Record an event that was already timed, if tracing is enabled
+static inline void trace_complete(TraceEvent                            event,
+                                  const std::string&                    name,
+                                  std::chrono::steady_clock::time_point begin,
+                                  std::chrono::steady_clock::time_point end,
+                                  uint64_t                              arg0 = 0,
+                                  uint64_t                              arg1 = 0)
+{
+    if(!LOG_EVENTS_ENABLED())
+        return;
+    TraceRecord record;
+    record.event    = event;
+    record.begin_ns = trace_ns(begin);
+    record.end_ns   = trace_ns(end);
+    record.args[0]  = arg0;
+    record.args[1]  = arg1;
+    record.set_name(name);
+    trace_record(record);
+}
+
+#endif // ROCFFT_EVENT_TRACE_H
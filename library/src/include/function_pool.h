@@ -23,10 +23,16 @@
 #ifndef FUNCTION_POOL_H
 #define FUNCTION_POOL_H
 
+#include "../../../shared/arithmetic.h"
 #include "../../../shared/rocfft_complex.h"
 #include "../device/kernels/common.h"
+#include "logging.h"
 #include "tree_node.h"
+#include <array>
+#include <mutex>
+#include <optional>
 #include <sstream>
+#include <stdexcept>
 #include <unordered_map>
 
 using FMKey
@@ -93,15 +99,18 @@ struct FFTKernel
     // workgroup size： number of threads per block (wgs) = tpt * tpb
     int workgroup_size = 0;
     // number of threads to perform single transform (tpt)
-    // 2D_SINGLE specifies separate threads for each dimension;
-    // otherwise second dim's threads will be 0
-    std::array<int, 2> threads_per_transform = {0, 0};
+    // 2D_SINGLE and 3D_SINGLE specify separate threads for each
+    // dimension; otherwise higher dims' threads will be 0
+    std::array<int, 3> threads_per_transform = {0, 0, 0};
     bool               use_3steps_large_twd  = false;
     bool               half_lds              = false;
     bool               direct_to_from_reg    = false;
     // true if this kernel is compiled ahead of time (i.e. at library
     // build time), using runtime compilation.
     bool aot_rtc = false;
+    // true if this kernel exchanges data between passes with
+    // cross-lane shuffles instead of LDS.  Opt-in per kernel.
+    bool cross_lane_exchange = false;
 
     FFTKernel() = delete;
 
@@ -113,10 +122,11 @@ struct FFTKernel
               std::vector<size_t>&& factors,
               int                   tpb,
               int                   wgs,
-              std::array<int, 2>&&  tpt,
-              bool                  half_lds           = false,
-              bool                  direct_to_from_reg = false,
-              bool                  aot_rtc            = false)
+              std::array<int, 3>&&  tpt,
+              bool                  half_lds            = false,
+              bool                  direct_to_from_reg  = false,
+              bool                  aot_rtc             = false,
+              bool                  cross_lane_exchange = false)
         : device_function(fn)
         , factors(factors)
         , transforms_per_block(tpb)
@@ -126,20 +136,107 @@ struct FFTKernel
         , half_lds(half_lds)
         , direct_to_from_reg(direct_to_from_reg)
         , aot_rtc(aot_rtc)
+        , cross_lane_exchange(cross_lane_exchange)
     {
     }
+
+    // split the factors of a kernel that transforms several
+    // dimensions at once into the factors for each dimension
+    std::vector<std::vector<size_t>> factors_per_dim(const std::vector<size_t>& lengths) const
+    {
+        std::vector<std::vector<size_t>> ret;
+        auto                             f = factors.begin();
+        for(auto len : lengths)
+        {
+            ret.emplace_back();
+            for(size_t cumulative_product = 1; cumulative_product < len && f != factors.end();
+                ++f)
+            {
+                cumulative_product *= *f;
+                ret.back().push_back(*f);
+            }
+        }
+        return ret;
+    }
 };
 
+// Choose factors, threads and so on for a single-kernel Stockham FFT
+// of a length the generated pool doesn't have, so that it can be
+// built with runtime compilation.  Returns nullopt if the length
+// can't be done in one kernel.  Defined in rtc_stockham_gen.cpp.
+std::optional<FFTKernel> configure_stockham_kernel(size_t length);
+
 class function_pool
 {
-    std::unordered_map<FMKey, FFTKernel, SimpleHash> function_map;
+    typedef std::unordered_map<FMKey, FFTKernel, SimpleHash> kernel_map_t;
+
+    // generated kernels, with a map for each precision.  each map is
+    // populated the first time a kernel of its precision is looked
+    // up, so that processes only pay for the precisions they use.
+    static const size_t                        NUM_PRECISIONS = 3;
+    std::array<kernel_map_t, NUM_PRECISIONS>   function_maps;
+    std::array<std::once_flag, NUM_PRECISIONS> populated;
 
-    ROCFFT_DEVICE_EXPORT function_pool();
+    // kernels configured at runtime for keys that aren't in the
+    // generated pool.  keys that can't be configured map to nullopt,
+    // so each key is only tried once.
+    std::unordered_map<FMKey, std::optional<FFTKernel>, SimpleHash> runtime_map;
+    std::mutex                                                      runtime_map_mutex;
+
+    function_pool() = default;
+
+    // add the generated kernels of one precision to its map.  defined
+    // in the generated function_pool.cpp.
+    ROCFFT_DEVICE_EXPORT static void populate(rocfft_precision precision, kernel_map_t& map);
+
+    // the map of generated kernels for a precision, populated if
+    // this is the first time it's needed
+    const kernel_map_t& get_map(rocfft_precision precision)
+    {
+        auto idx = static_cast<size_t>(precision);
+        if(idx >= NUM_PRECISIONS)
+            throw std::out_of_range("invalid precision");
+        std::call_once(populated[idx], [this, precision, idx]() {
+            StartupTimer timer("function_pool");
+            populate(precision, function_maps[idx]);
+        });
+        return function_maps[idx];
+    }
+
+    // find the kernel for a key, configuring one at runtime if
+    // necessary.  returns nullptr if there is no kernel.
+    static const FFTKernel* find_kernel(const FMKey& key)
+    {
+        function_pool& func_pool = get_function_pool();
+
+        const auto& function_map = func_pool.get_map(std::get<1>(key));
+        auto        generated    = function_map.find(key);
+        if(generated != function_map.end())
+            return &generated->second;
+
+        // only plain 1D Stockham kernels are configured at runtime
+        if(std::get<0>(key)[1] != 0 || std::get<2>(key) != CS_KERNEL_STOCKHAM
+           || std::get<3>(key) != NONE)
+            return nullptr;
+
+        // elements of an unordered_map don't move, so pointers to
+        // them stay valid after the lock is released
+        std::lock_guard<std::mutex> lock(func_pool.runtime_map_mutex);
+
+        auto configured = func_pool.runtime_map.find(key);
+        if(configured == func_pool.runtime_map.end())
+            configured = func_pool.runtime_map
+                             .emplace(key, configure_stockham_kernel(std::get<0>(key)[0]))
+                             .first;
+        return configured->second ? &*configured->second : nullptr;
+    }
 
 public:
     function_pool(const function_pool&) = delete;
     function_pool& operator=(const function_pool&) = delete;
 
+    // the pool is empty until kernels are looked up, which is
+    // normally when the first plan is created
     static function_pool& get_function_pool()
     {
         static function_pool func_pool;
@@ -150,8 +247,7 @@ public:
 
     static bool has_function(const FMKey& key)
     {
-        function_pool& func_pool = get_function_pool();
-        return func_pool.function_map.count(key) > 0;
+        return find_kernel(key) != nullptr;
     }
 
     static size_t get_largest_length(rocfft_precision precision)
@@ -163,14 +259,16 @@ public:
         return 0;
     }
 
+    // lengths of the generated kernels of a scheme.  kernels
+    // configured at runtime are not included.
     static std::vector<size_t> get_lengths(rocfft_precision precision, ComputeScheme scheme)
     {
-        const function_pool& func_pool = get_function_pool();
-        std::vector<size_t>  lengths;
-        for(auto const& kv : func_pool.function_map)
+        function_pool&      func_pool = get_function_pool();
+        std::vector<size_t> lengths;
+        for(auto const& kv : func_pool.get_map(precision))
         {
-            if(std::get<0>(kv.first)[1] == 0 && std::get<1>(kv.first) == precision
-               && std::get<2>(kv.first) == scheme && std::get<3>(kv.first) == NONE)
+            if(std::get<0>(kv.first)[1] == 0 && std::get<2>(kv.first) == scheme
+               && std::get<3>(kv.first) == NONE)
             {
                 lengths.push_back(std::get<0>(kv.first)[0]);
             }
@@ -181,14 +279,15 @@ public:
 
     static DevFnCall get_function(const FMKey& key)
     {
-        function_pool& func_pool = get_function_pool();
-        return func_pool.function_map.at(key).device_function;
+        return get_kernel(key).device_function;
     }
 
     static FFTKernel get_kernel(const FMKey& key)
     {
-        function_pool& func_pool = get_function_pool();
-        return func_pool.function_map.at(key);
+        auto kernel = find_kernel(key);
+        if(!kernel)
+            throw std::out_of_range(PrintMissingKernelInfo(key));
+        return *kernel;
     }
 
     // helper for common used
@@ -207,9 +306,51 @@ public:
         return has_function(fpkey(length, precision, CS_KERNEL_STOCKHAM_BLOCK_CR));
     }
 
-    const auto& get_map() const
+    // Get a kernel that does a whole 2D or 3D transform in one
+    // threadblock.  A 2D_SINGLE kernel from the pool is used if there
+    // is one.  Otherwise, the kernel is put together from the 1D
+    // kernels for each length, and must be built with runtime
+    // compilation.  Returns nullopt if a length has no 1D kernel.
+    static std::optional<FFTKernel> get_fused_kernel(const std::vector<size_t>& lengths,
+                                                     rocfft_precision           precision)
     {
-        return function_map;
+        if(lengths.size() == 2 && has_function(fpkey(lengths[0], lengths[1], precision)))
+            return get_kernel(fpkey(lengths[0], lengths[1], precision));
+        if(lengths.size() != 2 && lengths.size() != 3)
+            return std::nullopt;
+
+        FFTKernel    fused(nullptr, false, {}, 1, 0, {0, 0, 0});
+        const size_t brick = product(lengths.begin(), lengths.end());
+        for(size_t d = 0; d < lengths.size(); ++d)
+        {
+            auto key = fpkey(lengths[d], precision);
+            // the factors of a length-1 kernel wouldn't say where
+            // one dimension ends and the next begins
+            if(lengths[d] == 1 || !has_function(key))
+                return std::nullopt;
+            auto kernel = get_kernel(key);
+            fused.factors.insert(fused.factors.end(), kernel.factors.begin(), kernel.factors.end());
+            fused.threads_per_transform[d] = kernel.threads_per_transform[0];
+            // every row along a dimension is transformed at once, so
+            // the block needs enough threads for the dimension that
+            // uses the most
+            fused.workgroup_size = std::max<int>(
+                fused.workgroup_size, kernel.threads_per_transform[0] * brick / lengths[d]);
+        }
+        return fused;
+    }
+
+    // all generated kernels, of every precision
+    std::vector<std::pair<FMKey, FFTKernel>> get_all_kernels()
+    {
+        std::vector<std::pair<FMKey, FFTKernel>> kernels;
+        for(auto precision :
+            {rocfft_precision_single, rocfft_precision_double, rocfft_precision_half})
+        {
+            const auto& map = get_map(precision);
+            kernels.insert(kernels.end(), map.begin(), map.end());
+        }
+        return kernels;
     }
 };
 
@@ -0,0 +1,139 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ROCFFT_HOST_EXEC_H
+#define ROCFFT_HOST_EXEC_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rocfft.h"
+#include "tree_node.h"
+
+// Host execution is a reference executor that runs the nodes of an
+// ExecPlan on the CPU instead of launching device kernels.  It does
+// not share code with the device kernels: the kernel generator only
+// emits device code, and each node is carried out by a hand-written
+// host kernel in this file, which implements the same index mapping,
+// twiddle and pre/post-processing conventions as the device kernel
+// for its scheme.  Plans are decomposed and buffers are assigned to
+// nodes exactly as they would be for the device, so host and device
+// execution of a plan touch the same parts of the same buffers.
+//
+// FFTs along a row are done with a self-sorting Stockham algorithm,
+// using the radices from the generator's configuration for the
+// node, if it has one.  Several rows are transformed together,
+// interleaved so that the innermost loops run over rows and can be
+// vectorized.
+
+// Fork-join pool of threads that host kernels spread their work
+// over.  The calling thread takes part in the work.
+class HostThreadPool
+{
+public:
+    explicit HostThreadPool(size_t num_threads);
+    ~HostThreadPool();
+
+    HostThreadPool(const HostThreadPool&) = delete;
+    HostThreadPool& operator=(const HostThreadPool&) = delete;
+
+    // Pool shared by all host plans, created on first use.  Its size
+    // defaults to the number of CPUs available to the process, and
+    // can be overridden with the ROCFFT_HOST_THREADS environment
+    // variable.
+    static HostThreadPool& get();
+
+    // number of threads that run work, including the caller
+    size_t size() const
+    {
+        return workers.size() + 1;
+    }
+
+    // Call fn(begin, end) on disjoint ranges that together cover
+    // [0, count), and return once all calls have finished.  Ranges
+    // are at least grain items long, unless count is smaller.  Only
+    // one loop runs on the pool at a time; if the pool is busy with
+    // another caller's loop, this loop runs on the calling thread.
+    void parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn);
+
+private:
+    void worker_loop();
+    void run_chunks();
+
+    std::vector<std::thread> workers;
+
+    // held by the caller whose loop is running on the pool
+    std::mutex busy;
+
+    // protects the state below
+    std::mutex              mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    bool                    stop       = false;
+    size_t                  generation = 0;
+    size_t                  active     = 0;
+
+    // the loop currently running on the pool
+    const std::function<void(size_t, size_t)>* job        = nullptr;
+    size_t                                     jobCount   = 0;
+    size_t                                     jobChunks  = 0;
+    size_t                                     finished   = 0;
+    std::atomic<size_t>                        nextChunk  = {0};
+    std::exception_ptr                         jobFailure = nullptr;
+};
+
+// Kernel that carries out one node of a plan on the host.
+struct HostKernel
+{
+    virtual ~HostKernel() = default;
+
+    // Buffers are resolved for the node the same way as for a device
+    // kernel (see AssignNodeBuffers).
+    virtual void launch(void* const     bufIn[2],
+                        void* const     bufOut[2],
+                        void*           bufTemp,
+                        HostThreadPool& pool) const = 0;
+};
+
+// Properties of the current device, used to decompose host plans the
+// same way as device plans.  If there is no device, return
+// properties that don't restrict the decomposition to any
+// particular architecture.
+hipDeviceProp_t HostDeviceProp();
+
+// Create host kernels for all nodes of the plan, in place of device
+// kernels.  Throws if a node's scheme can't run on the host.
+void PlanHostExec(ExecPlan& execPlan);
+
+// Execute a plan whose kernels run on the host.  For in-place
+// transforms, in_buffer == out_buffer.  Returns once the transform
+// is finished.
+void ExecuteHostPlan(const ExecPlan&       execPlan,
+                     void*                 in_buffer[],
+                     void*                 out_buffer[],
+                     rocfft_execution_info info);
+
+#endif // ROCFFT_HOST_EXEC_H
@@ -78,7 +78,9 @@ struct DeviceCallIn
 
     CallbackType get_callback_type() const
     {
-        if(callbacks.load_cb_fn || callbacks.store_cb_fn)
+        if(callbacks.load_cb_source || callbacks.store_cb_source)
+            return CallbackType::USER_SOURCE;
+        else if(callbacks.load_cb_fn || callbacks.store_cb_fn)
             return CallbackType::USER_LOAD_STORE;
         else
             return CallbackType::NONE;
@@ -0,0 +1,141 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ROCFFT_KERNEL_TIMING_H
+#define ROCFFT_KERNEL_TIMING_H
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rocfft_hip.h"
+
+class TreeNode;
+
+// Kernel timing measures each kernel of a plan on whatever stream
+// the plan is executed on.  An event is recorded on the stream
+// before a plan's first kernel and after each kernel, so the time
+// between consecutive events is the time taken by one kernel.
+//
+// Execution doesn't wait for the events.  Finished executions are
+// collected the next time the plan is executed or the timings are
+// queried, at which point their events go back to a pool owned by
+// the plan to be reused.
+
+// Number of bytes a kernel reads and writes
+size_t kernel_data_size_bytes(const TreeNode& node);
+
+float execution_bandwidth_GB_per_s(size_t data_size_bytes, float duration_ms);
+
+// NOTE: HIP returns the maximum global frequency in kHz, which might
+// not be the actual frequency when the transform ran.  This function
+// might also return 0.0 if the bandwidth can't be queried.
+float max_memory_bandwidth_GB_per_s();
+
+struct KernelTiming
+{
+    std::string         scheme;
+    std::vector<size_t> length;
+    float               duration_ms        = 0.0f;
+    size_t              bytes              = 0;
+    float               bandwidth_GB_per_s = 0.0f;
+};
+
+class KernelTimer;
+
+// Events recorded during one execution of a plan.  A chunked plan
+// executes several ExecPlans, whose kernels are all timed as part
+// of the same execution.
+class KernelTimingExecution
+{
+public:
+    explicit KernelTimingExecution(KernelTimer& timer)
+        : timer(timer)
+    {
+    }
+    ~KernelTimingExecution();
+
+    KernelTimingExecution(const KernelTimingExecution&) = delete;
+    KernelTimingExecution& operator=(const KernelTimingExecution&) = delete;
+
+    // record an event before the first kernel of an ExecPlan
+    void start(hipStream_t stream);
+    // record an event after a kernel that was launched for node
+    void stop(const TreeNode& node, hipStream_t stream);
+
+private:
+    friend class KernelTimer;
+
+    KernelTimer&            timer;
+    std::vector<hipEvent_t> events;
+    // node that each kernel was launched for, and the index into
+    // events of the events before and after it.  Nodes belong to
+    // the plan, which outlives its timer.
+    std::vector<const TreeNode*>           nodes;
+    std::vector<std::pair<size_t, size_t>> bounds;
+};
+
+// Per-plan pool of events, and the executions that are still
+// waiting for their events to complete.
+class KernelTimer
+{
+public:
+    KernelTimer() = default;
+    // waits for pending executions, so they are logged
+    ~KernelTimer();
+
+    KernelTimer(const KernelTimer&) = delete;
+    KernelTimer& operator=(const KernelTimer&) = delete;
+
+    std::unique_ptr<KernelTimingExecution> begin_execution();
+    // queue an execution to be collected once its events complete
+    void end_execution(std::unique_ptr<KernelTimingExecution> execution);
+
+    // Wait for all pending executions, and return the kernel
+    // timings of the most recent one.
+    std::vector<KernelTiming> latest();
+
+private:
+    friend class KernelTimingExecution;
+
+    // executions that may still have events in flight, beyond which
+    // end_execution waits for the oldest one
+    static const size_t MAX_PENDING = 16;
+
+    hipEvent_t acquire_event();
+    // collect pending executions in order, stopping at the first
+    // one that hasn't finished unless wait is true
+    void collect(bool wait);
+    // collect the oldest pending execution, returning false if it
+    // hasn't finished and wait is false
+    bool collect_front(bool wait);
+    void finish(KernelTimingExecution& execution);
+
+    std::mutex                                         mutex;
+    std::vector<hipEvent_t>                            free_events;
+    std::deque<std::unique_ptr<KernelTimingExecution>> pending;
+    std::vector<KernelTiming>                          latest_kernels;
+    float                                              max_memory_bw = -1.0f;
+};
+
+#endif // ROCFFT_KERNEL_TIMING_H
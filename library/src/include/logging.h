@@ -26,6 +26,7 @@
 #include "rocfft_ostream.hpp"
 #include "tuple_helper.hpp"
 #include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cstdlib>
 #include <iomanip>
@@ -143,6 +144,7 @@ typedef enum rocfft_layer_mode_
     rocfft_layer_mode_log_plan     = 0b0000001000, //  8
     rocfft_layer_mode_log_kernelio = 0b0000010000, // 16
     rocfft_layer_mode_log_rtc      = 0b0000100000, // 32
+    rocfft_layer_mode_log_events   = 0b0001000000, // 64
 } rocfft_layer_mode;
 
 class LogSingleton
@@ -260,6 +262,36 @@ inline void log_trace(Ts&&... xs)
         log_arguments(*LogSingleton::GetInstance().GetTraceOS(), ",", std::forward<Ts>(xs)...);
 }
 
+// log how long a phase of library startup took, as
+// "startup,<phase>,duration_ms,<ms>" in the trace log
+static inline void log_startup(const char*                                     phase,
+                               const std::chrono::duration<double, std::milli>& duration)
+{
+    log_trace("startup", phase, "duration_ms", duration.count());
+}
+
+// Times a phase of library startup from construction to
+// destruction.  Most subsystems are initialized lazily on first use,
+// so their phases are logged whenever that first use happens.
+class StartupTimer
+{
+    const char*                                        phase;
+    std::chrono::time_point<std::chrono::steady_clock> start;
+
+public:
+    explicit StartupTimer(const char* phase)
+        : phase(phase)
+        , start(std::chrono::steady_clock::now())
+    {
+    }
+    ~StartupTimer()
+    {
+        log_startup(phase, std::chrono::steady_clock::now() - start);
+    }
+    StartupTimer(const StartupTimer&) = delete;
+    StartupTimer& operator=(const StartupTimer&) = delete;
+};
+
 // if bench logging is turned on with
 // (layer_mode & rocfft_layer_mode_log_bench) != 0
 // log_bench will call log_arguments to log a string that
@@ -55,6 +55,7 @@ public:
     static bool use_CS_2D_RC(NodeMetaData& nodeData); // using scheme CS_2D_RC or not
     static bool use_CS_3D_BLOCK_RC(NodeMetaData& nodeData);
     static bool use_CS_3D_RC(NodeMetaData& nodeData);
+    static bool use_CS_3D_SINGLE(NodeMetaData& nodeData); // using scheme CS_KERNEL_3D_SINGLE or not
     // how many SBRC kernels can we put into a 3D transform?
     static size_t count_3D_SBRC_nodes(NodeMetaData& nodeData);
 
@@ -21,11 +21,14 @@
 #ifndef PLAN_H
 #define PLAN_H
 
+#include <algorithm>
 #include <array>
 #include <cstring>
+#include <memory>
 #include <vector>
 
 #include "function_pool.h"
+#include "kernel_timing.h"
 #include "tree_node.h"
 
 // Calculate the maximum pow number with the given base number
@@ -64,6 +67,26 @@ struct rocfft_plan_description_t
 
     double scale_factor = 1.0;
 
+    // maximum work buffer size in bytes, 0 for no limit
+    size_t maxWorkBufBytes = 0;
+
+    // device memory budget in bytes for streaming host-resident
+    // data through the device, 0 if data is already on the device
+    size_t streamingDeviceBytes = 0;
+
+    // type of the numbers in input, output and work buffers, if it
+    // differs from the plan's precision
+    rocfft_storage_precision storagePrecision = rocfft_storage_precision_native;
+
+    // where the plan's kernels run
+    rocfft_execution_target executionTarget = rocfft_execution_target_device;
+
+    // time each kernel when the plan is executed
+    bool kernelTiming = false;
+
+    // user callbacks to compile into the plan's kernels
+    RTCCallbackSource callbackSource;
+
     rocfft_plan_description_t() = default;
 
     // A plan description is created in a vacuum and does not know what
@@ -76,6 +99,8 @@ struct rocfft_plan_description_t
                        const std::array<size_t, 3>& lengths);
 };
 
+struct StreamingPlan;
+
 struct rocfft_plan_t
 {
     size_t                rank    = 1;
@@ -93,6 +118,29 @@ struct rocfft_plan_t
 
     ExecPlan execPlan;
 
+    // If the work buffer is capped, execPlan transforms chunkBatch
+    // transforms at a time, and remainderPlan transforms the last
+    // chunk if the batch doesn't divide evenly.
+    size_t                    chunkBatch = 1;
+    std::unique_ptr<ExecPlan> remainderPlan;
+
+    // work buffer needed to execute all chunks of the batch
+    size_t WorkBufBytes() const
+    {
+        auto bytes = execPlan.WorkBufBytes(base_type_size);
+        if(remainderPlan)
+            bytes = std::max(bytes, remainderPlan->WorkBufBytes(base_type_size));
+        return bytes;
+    }
+
+    // If the plan streams host-resident data, execPlan is unused and
+    // this holds the chunked transforms instead.
+    std::shared_ptr<StreamingPlan> streaming;
+
+    // Times the kernels of each execution, if kernel timing or
+    // profile logging was enabled when the plan was created.
+    std::unique_ptr<KernelTimer> kernelTimer;
+
     // Users can provide lengths+strides in any order, but we'll
     // construct the most sensible plans if they're in row-major order.
     // Sort the FFT dimensions.
@@ -104,4 +152,22 @@ struct rocfft_plan_t
 
 bool PlanPowX(ExecPlan& execPlan);
 
+rocfft_status rocfft_plan_allocate(rocfft_plan* plan);
+rocfft_status rocfft_plan_create_internal(rocfft_plan                   plan,
+                                          const rocfft_result_placement placement,
+                                          const rocfft_transform_type   transform_type,
+                                          const rocfft_precision        precision,
+                                          const size_t                  dimensions,
+                                          const size_t*                 lengths,
+                                          const size_t                  number_of_transforms,
+                                          const rocfft_plan_description description);
+
+// Set up chunked transforms for a plan that streams host-resident
+// data through the device, and execute them.
+rocfft_status CreateStreamingPlan(rocfft_plan plan);
+rocfft_status ExecuteStreaming(const rocfft_plan     plan,
+                               void*                 in_buffer[],
+                               void*                 out_buffer[],
+                               rocfft_execution_info info);
+
 #endif // PLAN_H
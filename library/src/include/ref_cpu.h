@@ -23,77 +23,144 @@
 
 #ifdef REF_DEBUG
 
+// Per-kernel check of device results against FFTW.
+//
+// Before each kernel of a plan is launched, RefLibOp reads the
+// elements the kernel will read from device memory, and computes the
+// values the kernel should write, along with where it should write
+// them.  FFTs are done with double-precision FFTW, and everything
+// else (twiddle multiplication, real/complex processing, Bluestein
+// chirps) is done on the host in double precision.  After the kernel
+// has run, the written elements are read back and compared, and an
+// error report line is written for the kernel.
+//
+// Node strides, distances, buffer offsets and planar layouts are all
+// respected, and only the parts of buffers that the kernel touches
+// are copied between device and host.
+//
+// The following environment variables control the check:
+//
+// ROCFFT_DBG_FFTW3_LIB - path to double-precision FFTW library
+//   (default libfftw3.so)
+// ROCFFT_DBG_FFTW3_THREADS_LIB - path to FFTW threads library
+//   (default libfftw3_threads.so).  If it can't be loaded, FFTW runs
+//   single-threaded.
+// ROCFFT_DBG_FFTW_REPORT - if set, error reports are also appended to
+//   this file as CSV
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
 #include <cstdio>
 #include <dlfcn.h>
+#include <fstream>
 #include <functional>
 #include <iostream>
+#include <map>
 #include <numeric>
 #include <stdlib.h>
+#include <tuple>
+#include <vector>
+
+#include "../../shared/array_predicate.h"
+#include "../../shared/concurrency.h"
 
 #define LOCAL_FFTW_FORWARD (-1)
 #define LOCAL_FFTW_BACKWARD (+1)
+#define LOCAL_FFTW_UNALIGNED (1U << 1)
 #define LOCAL_FFTW_ESTIMATE (1U << 6)
 
-typedef float local_fftwf_complex[2]; // each elment is a float type
+typedef double local_fftw_complex[2];
 
-typedef void* (*ftype_fftwf_malloc)(size_t n);
-typedef void (*ftype_fftwf_free)(void* p);
+typedef void* (*ftype_fftw_plan_many_dft)(int                 rank,
+                                          const int*          n,
+                                          int                 howmany,
+                                          local_fftw_complex* in,
+                                          const int*          inembed,
+                                          int                 istride,
+                                          int                 idist,
+                                          local_fftw_complex* out,
+                                          const int*          onembed,
+                                          int                 ostride,
+                                          int                 odist,
+                                          int                 sign,
+                                          unsigned            flags);
 
-typedef void* (*ftype_fftwf_plan_many_dft)(int                  rank,
-                                           const int*           n,
-                                           int                  howmany,
-                                           local_fftwf_complex* in,
-                                           const int*           inembed,
-                                           int                  istride,
-                                           int                  idist,
-                                           local_fftwf_complex* out,
-                                           const int*           onembed,
-                                           int                  ostride,
-                                           int                  odist,
-                                           int                  sign,
-                                           unsigned             flags);
+typedef void (*ftype_fftw_execute_dft)(void*, local_fftw_complex*, local_fftw_complex*);
 
-typedef void (*ftype_fftwf_execute)(void*);
+typedef void (*ftype_fftw_destroy_plan)(void*);
 
-typedef void (*ftype_fftwf_destroy_plan)(void*);
+typedef int (*ftype_fftw_init_threads)();
+
+typedef void (*ftype_fftw_plan_with_nthreads)(int);
 
 class RefLibHandle
 {
     RefLibHandle()
-        : fftw3f_lib(nullptr)
-        , fftw3_lib(nullptr)
     {
-        const char* fftw3f_lib_path = getenv("ROCFFT_DBG_FFTW3F_LIB");
-        const char* fftw3_lib_path  = getenv("ROCFFT_DBG_FFTW3_LIB");
-
-        if(!fftw3f_lib_path)
-        {
-            fftw3f_lib_path = "libfftw3f.so";
-        }
+        const char* fftw3_lib_path         = getenv("ROCFFT_DBG_FFTW3_LIB");
+        const char* fftw3_threads_lib_path = getenv("ROCFFT_DBG_FFTW3_THREADS_LIB");
 
         if(!fftw3_lib_path)
         {
             fftw3_lib_path = "libfftw3.so";
         }
 
-        fftw3f_lib = dlopen(fftw3f_lib_path, RTLD_NOW);
-        if(!fftw3f_lib)
+        if(!fftw3_threads_lib_path)
         {
-            rocfft_cout << "error opening " << fftw3f_lib_path << ": " << dlerror() << std::endl;
-            rocfft_cout << "set env variable ROCFFT_DBG_FFTW3F_LIB to a valid path\n";
+            fftw3_threads_lib_path = "libfftw3_threads.so";
         }
 
-        fftw3_lib = dlopen(fftw3_lib_path, RTLD_NOW);
+        fftw3_lib = dlopen(fftw3_lib_path, RTLD_NOW | RTLD_GLOBAL);
         if(!fftw3_lib)
         {
             rocfft_cout << "error opening " << fftw3_lib_path << ": " << dlerror() << std::endl;
             rocfft_cout << "set env variable ROCFFT_DBG_FFTW3_LIB to a valid path\n";
+            return;
+        }
+
+        plan_many_dft = (ftype_fftw_plan_many_dft)dlsym(fftw3_lib, "fftw_plan_many_dft");
+        execute_dft   = (ftype_fftw_execute_dft)dlsym(fftw3_lib, "fftw_execute_dft");
+        destroy_plan  = (ftype_fftw_destroy_plan)dlsym(fftw3_lib, "fftw_destroy_plan");
+
+        // thread support is usually a separate library, but some
+        // builds of FFTW have it in the main one
+        fftw3_threads_lib = dlopen(fftw3_threads_lib_path, RTLD_NOW);
+        void* threads_lib  = fftw3_threads_lib ? fftw3_threads_lib : fftw3_lib;
+        auto  init_threads = (ftype_fftw_init_threads)dlsym(threads_lib, "fftw_init_threads");
+        auto  plan_with_nthreads
+            = (ftype_fftw_plan_with_nthreads)dlsym(threads_lib, "fftw_plan_with_nthreads");
+        if(init_threads && plan_with_nthreads && init_threads())
+        {
+            // all plans created from now on use all the CPUs
+            plan_with_nthreads(std::max(rocfft_concurrency(), 1u));
+        }
+        else
+        {
+            rocfft_cout << "FFTW threads unavailable, set env variable "
+                           "ROCFFT_DBG_FFTW3_THREADS_LIB to a valid path\n";
+        }
+
+        const char* report_path = getenv("ROCFFT_DBG_FFTW_REPORT");
+        if(report_path)
+        {
+            report.open(report_path, std::ios::app);
+            if(report.tellp() == 0)
+                report << "kernel,scheme,precision,length,batch,elements,l2_rel_err,linf_rel_err"
+                       << std::endl;
         }
     }
 
 public:
-    void* fftw3f_lib;
-    void* fftw3_lib;
+    void* fftw3_lib         = nullptr;
+    void* fftw3_threads_lib = nullptr;
+
+    ftype_fftw_plan_many_dft plan_many_dft = nullptr;
+    ftype_fftw_execute_dft   execute_dft   = nullptr;
+    ftype_fftw_destroy_plan  destroy_plan  = nullptr;
+
+    // CSV error report, if requested
+    std::ofstream report;
 
     // delete is a c++11 feature, prohibit copy constructor:
     RefLibHandle(const RefLibHandle&) = delete;
@@ -106,955 +173,744 @@ public:
         return refLibHandle;
     }
 
-    ~RefLibHandle()
+    bool valid() const
     {
-        if(fftw3f_lib)
-        {
-            dlclose(fftw3f_lib);
-            fftw3f_lib = nullptr;
-        }
-
-        if(fftw3_lib)
-        {
-            dlclose(fftw3_lib);
-            fftw3_lib = nullptr;
-        }
+        return plan_many_dft && execute_dft && destroy_plan;
     }
-};
 
-class fftwbuf
-{
-private:
-    void* (*local_fftwf_malloc)(const size_t);
-    void (*local_fftwf_free)(void*);
-    void freedata()
+    // Return a plan for contiguous out-of-place batched FFTs of
+    // the given lengths (fastest dimension first).  Plans are
+    // unaligned, so they can be executed on any pair of distinct
+    // arrays, and are cached for the life of the process.
+    void* GetPlan(const std::vector<size_t>& length,
+                  size_t                     howmany,
+                  int                        direction,
+                  local_fftw_complex*        in,
+                  local_fftw_complex*        out)
     {
-        (*local_fftwf_free)(data);
+        // FFTW is row-major, we're column-major
+        std::vector<int> n(length.rbegin(), length.rend());
+        auto             key = std::make_tuple(n, howmany, direction);
+        auto             it  = plans.find(key);
+        if(it != plans.end())
+            return it->second;
+
+        const int dist = std::accumulate(n.begin(), n.end(), 1, std::multiplies<int>());
+        void*     p    = plan_many_dft(n.size(),
+                                       n.data(),
+                                       howmany,
+                                       in,
+                                       nullptr,
+                                       1,
+                                       dist,
+                                       out,
+                                       nullptr,
+                                       1,
+                                       dist,
+                                       direction == -1 ? LOCAL_FFTW_FORWARD : LOCAL_FFTW_BACKWARD,
+                                       LOCAL_FFTW_ESTIMATE | LOCAL_FFTW_UNALIGNED);
+        if(!p)
+            throw std::runtime_error("failed to create FFTW plan");
+        plans.emplace(key, p);
+        return p;
     }
 
-public:
-    fftwbuf()
-        : data(NULL)
-        , size(0)
-        , typesize(0)
-    {
-        RefLibHandle& refHandle = RefLibHandle::GetRefLibHandle();
-        local_fftwf_malloc      = (ftype_fftwf_malloc)dlsym(refHandle.fftw3f_lib, "fftwf_malloc");
-        local_fftwf_free        = (ftype_fftwf_free)dlsym(refHandle.fftw3f_lib, "fftwf_free");
-    };
-    fftwbuf(const size_t size0, const size_t typesize0)
-        : data(0)
-        , size(size0)
-        , typesize(typesize0)
+    ~RefLibHandle()
     {
-        RefLibHandle& refHandle = RefLibHandle::GetRefLibHandle();
-        local_fftwf_malloc      = (ftype_fftwf_malloc)dlsym(refHandle.fftw3f_lib, "fftwf_malloc");
-        local_fftwf_free        = (ftype_fftwf_free)dlsym(refHandle.fftw3f_lib, "fftwf_free");
+        if(destroy_plan)
+        {
+            for(auto& p : plans)
+                destroy_plan(p.second);
+        }
+        plans.clear();
 
-        alloc(size0, typesize0);
-    };
-    ~fftwbuf()
-    {
-        if(data)
+        if(fftw3_threads_lib)
         {
-            freedata();
+            dlclose(fftw3_threads_lib);
+            fftw3_threads_lib = nullptr;
         }
-    };
-    void alloc(const size_t size0, const size_t typesize0)
-    {
-        size     = size0;
-        typesize = typesize0;
-        if(data != NULL)
+
+        if(fftw3_lib)
         {
-            freedata();
+            dlclose(fftw3_lib);
+            fftw3_lib = nullptr;
         }
-        data = (void*)(*local_fftwf_malloc)(typesize * size);
-        assert(data != NULL);
     }
-    size_t bufsize() const
-    {
-        return size * typesize;
-    };
-    void*  data;
-    size_t size;
-    size_t typesize;
+
+private:
+    std::map<std::tuple<std::vector<int>, size_t, int>, void*> plans;
 };
 
 class RefLibOp
 {
-    // input from fftw:
-    fftwbuf fftwin;
-
-    // output from fftw:
-    fftwbuf fftwout;
-
-    // output from lib:
-    fftwbuf libout;
+    typedef std::complex<double> cdouble;
 
-    void DataSetup(const void* data_p)
+    // Host copy of the start of a device buffer, up to the highest
+    // element that's needed.  Elements are widened to double.
+    class DeviceSpan
     {
-        RefLibHandle& refHandle = RefLibHandle::GetRefLibHandle();
-
-        auto data = static_cast<const DeviceCallIn*>(data_p);
-
-        size_t totalSize;
-
-        size_t in_typesize  = (data->node->inArrayType == rocfft_array_type_real)
-                                  ? sizeof(float)
-                                  : sizeof(rocfft_complex<float>);
-        size_t out_typesize = (data->node->outArrayType == rocfft_array_type_real)
-                                  ? sizeof(float)
-                                  : sizeof(rocfft_complex<float>);
-
-        size_t     insize  = 0;
-        size_t     outsize = 0;
-        const auto batch   = data->node->batch;
-
-        // TODO: what about strides, etc?
-        switch(data->node->scheme)
-        {
-        case CS_KERNEL_CHIRP:
-            insize  = 2 * data->node->lengthBlue;
-            outsize = insize;
-            break;
-        case CS_KERNEL_FFT_MUL:
-        case CS_KERNEL_PAD_MUL:
-        case CS_KERNEL_RES_MUL:
-            // NB: the Bluestein length is the first dimesion
-            insize = std::accumulate(data->node->length.begin() + 1,
-                                     data->node->length.end(),
-                                     batch,
-                                     std::multiplies<size_t>());
-            insize *= data->node->lengthBlue;
-            outsize = insize;
-            break;
-        case CS_KERNEL_R_TO_CMPLX:
-            insize      = batch * data->node->length[0];
-            outsize     = batch * (data->node->length[0] + 1);
-            in_typesize = sizeof(rocfft_complex<float>);
-            break;
-        case CS_KERNEL_CMPLX_TO_R:
-            insize       = batch * (data->node->length[0] + 1);
-            outsize      = batch * data->node->length[0];
-            in_typesize  = sizeof(rocfft_complex<float>);
-            out_typesize = sizeof(rocfft_complex<float>);
-            break;
-        default:
-            insize  = std::accumulate(data->node->length.begin(),
-                                     data->node->length.end(),
-                                     batch,
-                                     std::multiplies<size_t>());
-            outsize = insize;
+    public:
+        DeviceSpan(void* const       buf[2],
+                   rocfft_array_type type,
+                   rocfft_precision  precision,
+                   size_t            count)
+            : isDouble(precision == rocfft_precision_double)
+            , isReal(type == rocfft_array_type_real)
+            , isPlanar(array_type_is_planar(type))
+        {
+            const size_t realBytes = isDouble ? sizeof(double) : sizeof(float);
+            const size_t reBytes   = count * realBytes * (isReal || isPlanar ? 1 : 2);
+            re.resize(reBytes);
+            if(hipMemcpy(re.data(), buf[0], reBytes, hipMemcpyDeviceToHost) != hipSuccess)
+                throw std::runtime_error("hipMemcpy failure");
+            if(isPlanar)
+            {
+                im.resize(reBytes);
+                if(hipMemcpy(im.data(), buf[1], reBytes, hipMemcpyDeviceToHost) != hipSuccess)
+                    throw std::runtime_error("hipMemcpy failure");
+            }
         }
 
-        assert(insize > 0);
-        assert(outsize > 0);
-
-        fftwin.alloc(insize, in_typesize);
-        fftwout.alloc(outsize, out_typesize);
-        libout.alloc(outsize, out_typesize);
-
-        memset(fftwin.data, 0x40, fftwin.bufsize());
-        memset(fftwout.data, 0x40, fftwout.bufsize());
-        memset(libout.data, 0x40, libout.bufsize());
-
-#if 0
-        // Initialize the code to some known value to help debug the
-        // cpu reference implementation.
-        rocfft_complex<float>* input = (rocfft_complex<float>*)fftwin.data;
-        for(int r = 0; r < fftwin.size; ++r)
+        cdouble operator[](size_t i) const
         {
-            input[r] = rocfft_complex<float>(r + 0.5, r * r + 3);
+            return isDouble ? load<double>(i) : load<float>(i);
         }
-#endif
-    }
 
-    // Copy a host vector to a host vector, taking strides and other
-    // data layout elements into account.
-    void CopyVector(local_fftwf_complex*       dst,
-                    local_fftwf_complex*       src,
-                    size_t                     batch,
-                    size_t                     dist,
-                    const std::vector<size_t>& length,
-                    const std::vector<size_t>& stride)
-    {
-        size_t lenSize = std::accumulate(
-            length.begin(), length.end(), static_cast<size_t>(1), std::multiplies<size_t>());
-
-        size_t b = 0;
-        while(b < batch)
+    private:
+        template <typename Treal>
+        cdouble load(size_t i) const
         {
-            size_t offset_dst   = 0;
-            size_t offset_src_d = 0;
-            size_t pos          = 0;
-            bool   obreak       = false;
+            const Treal* r = reinterpret_cast<const Treal*>(re.data());
+            const Treal* m = reinterpret_cast<const Treal*>(im.data());
+            if(isReal)
+                return cdouble(r[i], 0.0);
+            if(isPlanar)
+                return cdouble(r[i], m[i]);
+            return cdouble(r[2 * i], r[2 * i + 1]);
+        }
 
-            std::vector<size_t> current;
-            current.assign(length.size(), 0);
+        bool              isDouble;
+        bool              isReal;
+        bool              isPlanar;
+        std::vector<char> re;
+        std::vector<char> im;
+    };
 
-            while(true)
+    // Call f(idx) for every index of an array of the given lengths,
+    // with the batch index appended.  Dimension 0 moves fastest.
+    static void ForEachIndex(const std::vector<size_t>&                             length,
+                             size_t                                                 batch,
+                             const std::function<void(const std::vector<size_t>&)>& f)
+    {
+        std::vector<size_t> idx(length.size() + 1, 0);
+        std::vector<size_t> lengthBatch = length;
+        lengthBatch.push_back(batch);
+        if(std::find(lengthBatch.begin(), lengthBatch.end(), 0) != lengthBatch.end())
+            return;
+        while(true)
+        {
+            f(idx);
+            size_t d = 0;
+            for(; d < idx.size(); ++d)
             {
-                size_t offset_src = offset_src_d + current[0] * stride[0];
-
-                dst[offset_dst][0] = src[offset_src][0];
-                dst[offset_dst][1] = src[offset_src][1];
-
-                current[0]++;
-                offset_dst++;
-
-                while(current[pos] == length[pos])
-                {
-                    if(pos == (length.size() - 1))
-                    {
-                        obreak = true;
-                        break;
-                    }
-
-                    current[pos] = 0;
-                    pos++;
-                    current[pos]++;
-
-                    offset_src_d = 0;
-                    for(size_t i = 1; i < current.size(); i++)
-                        offset_src_d += current[i] * stride[i];
-                }
-
-                if(obreak)
+                if(++idx[d] < lengthBatch[d])
                     break;
-
-                pos = 0;
+                idx[d] = 0;
             }
-
-            b++;
-            src += dist;
-            dst += lenSize;
+            if(d == idx.size())
+                return;
         }
     }
 
-    void CopyInputVector(const void* data_p, size_t offset = 0)
+    // Offset of an index tuple (batch last) given strides for
+    // dimensions first and up, and the batch distance.
+    static size_t Offset(const std::vector<size_t>& idx,
+                         const std::vector<size_t>& stride,
+                         size_t                     dist,
+                         size_t                     first = 0)
     {
-        auto data = static_cast<DeviceCallIn*>(data_p);
-
-        size_t in_size_bytes = (data->node->iDist * data->node->batch) * sizeof(float);
+        size_t off = idx.back() * dist;
+        for(size_t d = first; d < stride.size(); ++d)
+            off += idx[d] * stride[d];
+        return off;
+    }
 
-        if(data->node->inArrayType != rocfft_array_type_real)
-        {
-            in_size_bytes *= 2;
-        }
+    // Read the elements at the given offsets of a device buffer.
+    static std::vector<cdouble> Gather(void* const                buf[2],
+                                       rocfft_array_type          type,
+                                       rocfft_precision           precision,
+                                       const std::vector<size_t>& offsets)
+    {
+        std::vector<cdouble> values;
+        if(offsets.empty())
+            return values;
+        DeviceSpan span(
+            buf, type, precision, *std::max_element(offsets.begin(), offsets.end()) + 1);
+        values.reserve(offsets.size());
+        for(auto o : offsets)
+            values.push_back(span[o]);
+        return values;
+    }
 
-        void*   buf = ((char*)data->bufIn[0] + offset);
-        fftwbuf tmp_mem(data->node->iDist * data->node->batch, sizeof(rocfft_complex<float>));
-        hipMemcpy(tmp_mem.data, buf, in_size_bytes, hipMemcpyDeviceToHost);
+    // Offsets of all elements of an array of the given lengths, in
+    // natural order
+    static std::vector<size_t> NaturalOffsets(const std::vector<size_t>& length,
+                                              const std::vector<size_t>& stride,
+                                              size_t                     dist,
+                                              size_t                     batch)
+    {
+        std::vector<size_t> offsets;
+        ForEachIndex(length, batch, [&](const std::vector<size_t>& idx) {
+            offsets.push_back(Offset(idx, stride, dist));
+        });
+        return offsets;
+    }
 
-        CopyVector((local_fftwf_complex*)fftwin.data,
-                   (local_fftwf_complex*)tmp_mem.data,
-                   data->node->batch,
-                   data->node->iDist,
-                   data->node->length,
-                   data->node->inStride);
+    // exp(sign * 2 * pi * i * num / den)
+    static cdouble UnitRoot(int sign, size_t num, size_t den)
+    {
+        return std::polar(1.0, sign * 2.0 * M_PI * static_cast<double>(num % den) / den);
     }
 
-    inline static rocfft_complex<float> TwMul(rocfft_complex<float>* twiddles,
-                                              const size_t           twl,
-                                              const int              direction,
-                                              rocfft_complex<float>  val,
-                                              size_t                 u)
+    // Contiguous batched FFTs of data along its fastest dimensions
+    static void FFT(std::vector<cdouble>& data, const std::vector<size_t>& length, int direction)
     {
-        size_t                j      = u & 255;
-        rocfft_complex<float> result = twiddles[j];
+        auto&        refHandle = RefLibHandle::GetRefLibHandle();
+        const size_t n         = std::accumulate(
+            length.begin(), length.end(), static_cast<size_t>(1), std::multiplies<size_t>());
+        if(data.empty())
+            return;
+
+        std::vector<cdouble> out(data.size());
+        auto                 in_ptr  = reinterpret_cast<local_fftw_complex*>(data.data());
+        auto                 out_ptr = reinterpret_cast<local_fftw_complex*>(out.data());
+        void* p = refHandle.GetPlan(length, data.size() / n, direction, in_ptr, out_ptr);
+        refHandle.execute_dft(p, in_ptr, out_ptr);
+        data.swap(out);
+    }
 
-        float  real, imag;
-        size_t h = 1;
-        do
-        {
-            u >>= 8;
-            j        = u & 255;
-            real     = (result.x * twiddles[256 * h + j].x - result.y * twiddles[256 * h + j].y);
-            imag     = (result.y * twiddles[256 * h + j].x + result.x * twiddles[256 * h + j].y);
-            result.x = real;
-            result.y = imag;
-            h++;
-        } while(h < twl);
-
-        if(direction == -1)
-        {
-            real = (result.x * val.x) - (result.y * val.y);
-            imag = (result.y * val.x) + (result.x * val.y);
-        }
-        else
+    // Post-processing of an N = 2M point real-to-complex FFT computed
+    // as an M point complex FFT z, giving M + 1 outputs x.
+    static void R2CPost(const cdouble* z, size_t M, cdouble* x)
+    {
+        x[0] = cdouble(z[0].real() + z[0].imag(), 0.0);
+        x[M] = cdouble(z[0].real() - z[0].imag(), 0.0);
+        for(size_t k = 1; k < M; ++k)
         {
-            real = (result.x * val.x) + (result.y * val.y);
-            imag = -(result.y * val.x) + (result.x * val.y);
+            const cdouble p = z[k];
+            const cdouble q = std::conj(z[M - k]);
+            x[k] = 0.5 * (p + q) - 0.5 * cdouble(0, 1) * UnitRoot(-1, k, 2 * M) * (p - q);
         }
-
-        result.x = real;
-        result.y = imag;
-
-        return result;
     }
 
-    inline static void chirp(size_t N, size_t M, int dir, local_fftwf_complex* vec)
+    // Pre-processing of an N = 2M point complex-to-real FFT, turning
+    // M + 1 inputs x into the input z of an M point complex FFT.
+    static void C2RPre(const cdouble* x, size_t M, cdouble* z)
     {
-        const double TWO_PI = atan(1.0) * 8.0 * (double)(-dir);
-
-        for(size_t i = 0; i <= (M - N); i++)
+        z[0] = cdouble(x[0].real() + x[M].real(), x[0].real() - x[M].real());
+        for(size_t k = 1; k < M; ++k)
         {
-            double cs = cos(TWO_PI * (double)(i * i) / (2.0 * (double)N));
-            double ss = sin(TWO_PI * (double)(i * i) / (2.0 * (double)N));
-
-            if(i == 0)
-            {
-                vec[i][0] = cs;
-                vec[i][1] = ss;
-
-                vec[i + M][0] = cs;
-                vec[i + M][1] = ss;
-            }
-            else if(i < N)
-            {
-                vec[i][0]     = cs;
-                vec[i][1]     = ss;
-                vec[M - i][0] = cs;
-                vec[M - i][1] = ss;
-
-                vec[i + M][0]     = cs;
-                vec[i + M][1]     = ss;
-                vec[M - i + M][0] = cs;
-                vec[M - i + M][1] = ss;
-            }
-            else
-            {
-                vec[i][0]     = 0;
-                vec[i][1]     = 0;
-                vec[i + M][0] = 0;
-                vec[i + M][1] = 0;
-            }
+            const cdouble p = x[k];
+            const cdouble q = std::conj(x[M - k]);
+            z[k]            = (p + q) + cdouble(0, 1) * UnitRoot(1, k, 2 * M) * (p - q);
         }
     }
 
-    inline static void chirp_fft(size_t N, size_t M, int dir, local_fftwf_complex* vec)
+    // Bluestein chirp for length N: exp(-dir * pi * i * t^2 / N)
+    static cdouble Chirp(int direction, size_t t, size_t N)
     {
-        RefLibHandle&             refHandle = RefLibHandle::GetRefLibHandle();
-        ftype_fftwf_plan_many_dft local_fftwf_plan_many_dft
-            = (ftype_fftwf_plan_many_dft)dlsym(refHandle.fftw3f_lib, "fftwf_plan_many_dft");
-        ftype_fftwf_execute local_fftwf_execute
-            = (ftype_fftwf_execute)dlsym(refHandle.fftw3f_lib, "fftwf_execute");
-        ftype_fftwf_destroy_plan local_fftwf_destroy_plan
-            = (ftype_fftwf_destroy_plan)dlsym(refHandle.fftw3f_lib, "fftwf_destroy_plan");
-
-        int n[1] = {static_cast<int>(M)};
-
-        void* p = local_fftwf_plan_many_dft(1,
-                                            n,
-                                            1,
-                                            vec,
-                                            NULL,
-                                            1,
-                                            n[0],
-                                            vec,
-                                            NULL,
-                                            1,
-                                            n[0],
-                                            (dir == -1) ? LOCAL_FFTW_FORWARD : LOCAL_FFTW_BACKWARD,
-                                            LOCAL_FFTW_ESTIMATE);
-        chirp(N, M, dir, vec);
-        local_fftwf_execute(p);
-        local_fftwf_destroy_plan(p);
+        return UnitRoot(-direction, (t * t) % (2 * N), 2 * N);
     }
 
-    void Execute(const void* data_p)
+    // Offset of output element k of the Stockham row at idx, for the
+    // schemes that write their rows transposed
+    static size_t
+        StockhamOutputOffset(const TreeNode& node, size_t k, const std::vector<size_t>& idx)
     {
-        auto data = static_cast<DeviceCallIn*>(data_p);
-
-        switch(data->node->scheme)
+        const auto& os = node.outStride;
+        switch(node.scheme)
         {
-        case CS_KERNEL_STOCKHAM:
+        case CS_KERNEL_STOCKHAM_BLOCK_RC:
+            return idx[1] * os[0] + k * os[1] + Offset(idx, os, node.oDist, 2);
+        case CS_KERNEL_STOCKHAM_TRANSPOSE_XY_Z:
+            return idx[2] * os[0] + k * os[1] + idx[1] * os[2] + Offset(idx, os, node.oDist, 3);
+        case CS_KERNEL_STOCKHAM_TRANSPOSE_Z_XY:
+        case CS_KERNEL_STOCKHAM_R_TO_CMPLX_TRANSPOSE_Z_XY:
+            return idx[1] * os[0] + idx[2] * os[1] + k * os[2] + Offset(idx, os, node.oDist, 3);
+        default:
+            return k * os[0] + Offset(idx, os, node.oDist, 1);
+        }
+    }
+
+    // Work out what the node's kernel should write, from what's in
+    // device memory before it runs.
+    void Setup(const DeviceCallIn& data)
+    {
+        const TreeNode& node = *data.node;
+
+        if(node.precision == rocfft_precision_half
+           || node.storage != rocfft_storage_precision_native)
         {
-            RefLibHandle&             refHandle = RefLibHandle::GetRefLibHandle();
-            ftype_fftwf_plan_many_dft local_fftwf_plan_many_dft
-                = (ftype_fftwf_plan_many_dft)dlsym(refHandle.fftw3f_lib, "fftwf_plan_many_dft");
-            ftype_fftwf_execute local_fftwf_execute
-                = (ftype_fftwf_execute)dlsym(refHandle.fftw3f_lib, "fftwf_execute");
-            ftype_fftwf_destroy_plan local_fftwf_destroy_plan
-                = (ftype_fftwf_destroy_plan)dlsym(refHandle.fftw3f_lib, "fftwf_destroy_plan");
-
-            int n[1]    = {static_cast<int>(data->node->length[0])};
-            int howmany = data->node->batch;
-            for(size_t i = 1; i < data->node->length.size(); i++)
-                howmany *= data->node->length[i];
-
-            void* p = local_fftwf_plan_many_dft(1,
-                                                n,
-                                                howmany,
-                                                (local_fftwf_complex*)fftwin.data,
-                                                NULL,
-                                                1,
-                                                n[0],
-                                                (local_fftwf_complex*)fftwout.data,
-                                                NULL,
-                                                1,
-                                                n[0],
-                                                (data->node->direction == -1) ? LOCAL_FFTW_FORWARD
-                                                                              : LOCAL_FFTW_BACKWARD,
-                                                LOCAL_FFTW_ESTIMATE);
-            CopyInputVector(data_p);
-            local_fftwf_execute(p);
-            local_fftwf_destroy_plan(p);
+            skipReason = "precision not supported";
+            return;
         }
-        break;
-        case CS_KERNEL_2D_SINGLE:
+        if(data.get_callback_type() != CallbackType::NONE)
         {
-            RefLibHandle&             refHandle = RefLibHandle::GetRefLibHandle();
-            ftype_fftwf_plan_many_dft local_fftwf_plan_many_dft
-                = (ftype_fftwf_plan_many_dft)dlsym(refHandle.fftw3f_lib, "fftwf_plan_many_dft");
-            ftype_fftwf_execute local_fftwf_execute
-                = (ftype_fftwf_execute)dlsym(refHandle.fftw3f_lib, "fftwf_execute");
-            ftype_fftwf_destroy_plan local_fftwf_destroy_plan
-                = (ftype_fftwf_destroy_plan)dlsym(refHandle.fftw3f_lib, "fftwf_destroy_plan");
-
-            // fftw does row-major indexing and we have column-major,
-            // so give N1, N0
-            int n[2]    = {static_cast<int>(data->node->length[1]),
-                        static_cast<int>(data->node->length[0])};
-            int howmany = data->node->batch;
-            for(size_t i = 2; i < data->node->length.size(); i++)
-                howmany *= data->node->length[i];
-
-            void* p = local_fftwf_plan_many_dft(2,
-                                                n,
-                                                howmany,
-                                                (local_fftwf_complex*)fftwin.data,
-                                                NULL,
-                                                1,
-                                                n[0],
-                                                (local_fftwf_complex*)fftwout.data,
-                                                NULL,
-                                                1,
-                                                n[0],
-                                                (data->node->direction == -1) ? LOCAL_FFTW_FORWARD
-                                                                              : LOCAL_FFTW_BACKWARD,
-                                                LOCAL_FFTW_ESTIMATE);
-            CopyInputVector(data_p);
-            local_fftwf_execute(p);
-            local_fftwf_destroy_plan(p);
+            skipReason = "callbacks not supported";
+            return;
         }
-        break;
-        case CS_KERNEL_TRANSPOSE:
+        if(!RefLibHandle::GetRefLibHandle().valid())
         {
-            // TODO: what about the real transpose case?
-            rocfft_complex<float>* ot = (rocfft_complex<float>*)fftwout.data;
-            rocfft_complex<float>* in = (rocfft_complex<float>*)fftwin.data;
-
-            CopyInputVector(data_p);
+            skipReason = "FFTW not available";
+            return;
+        }
 
-            size_t howmany = data->node->batch;
-            for(size_t i = 2; i < data->node->length.size(); i++)
-                howmany *= data->node->length[i];
+        // Real data is treated as complex, except by the kernels that
+        // convert between real and complex elements
+        auto inType = node.inArrayType;
+        if(inType == rocfft_array_type_real && node.scheme != CS_KERNEL_COPY_R_TO_CMPLX)
+            inType = rocfft_array_type_complex_interleaved;
+        outType = node.outArrayType;
+        if(outType == rocfft_array_type_real && node.scheme != CS_KERNEL_COPY_CMPLX_TO_R)
+            outType = rocfft_array_type_complex_interleaved;
 
-            size_t cols = data->node->length[0];
-            size_t rows = data->node->length[1];
+        outBuf[0]   = data.bufOut[0];
+        outBuf[1]   = data.bufOut[1];
+        bool scaled = true;
+        auto gather = [&](const std::vector<size_t>& offsets) {
+            return Gather(data.bufIn, inType, node.precision, offsets);
+        };
+        auto emit = [&](size_t offset, cdouble value) {
+            outOffsets.push_back(offset);
+            expected.push_back(value);
+        };
 
-            if(data->node->large1D == 0)
+        switch(node.scheme)
+        {
+        case CS_KERNEL_STOCKHAM:
+        case CS_KERNEL_STOCKHAM_BLOCK_CC:
+        case CS_KERNEL_STOCKHAM_BLOCK_CR:
+        case CS_KERNEL_STOCKHAM_BLOCK_RC:
+        case CS_KERNEL_STOCKHAM_TRANSPOSE_XY_Z:
+        case CS_KERNEL_STOCKHAM_TRANSPOSE_Z_XY:
+        case CS_KERNEL_STOCKHAM_R_TO_CMPLX_TRANSPOSE_Z_XY:
+        {
+            // FFTs along dim 0, with optional real/complex
+            // processing before or after, and large 1D twiddles
+            const size_t n        = node.length[0];
+            const bool   pre      = node.ebtype == EmbeddedType::C2Real_PRE;
+            const bool   post     = node.ebtype == EmbeddedType::Real2C_POST;
+            const size_t loadLen  = pre ? n + 1 : n;
+            const size_t storeLen = post ? n + 1 : n;
+
+            auto loadLength = node.length;
+            loadLength[0]   = loadLen;
+            auto in = gather(NaturalOffsets(loadLength, node.inStride, node.iDist, node.batch));
+
+            const size_t         rows = in.size() / loadLen;
+            std::vector<cdouble> x(rows * n);
+            for(size_t r = 0; r < rows; ++r)
             {
-                for(size_t b = 0; b < howmany; b++)
-                {
-                    for(size_t i = 0; i < rows; i++)
-                    {
-                        for(size_t j = 0; j < cols; j++)
-                        {
-                            ot[b * rows * cols + j * rows + i] = in[b * rows * cols + i * cols + j];
-                        }
-                    }
-                }
+                if(pre)
+                    C2RPre(in.data() + r * loadLen, n, x.data() + r * n);
+                else
+                    std::copy_n(in.begin() + r * loadLen, n, x.begin() + r * n);
             }
-            else
+            FFT(x, {n}, node.direction);
+
+            std::vector<cdouble> y(rows * storeLen);
+            for(size_t r = 0; r < rows; ++r)
             {
-                rocfft_complex<float>*                   twtc;
-                size_t                                   ns = 0;
-                TwiddleTableLarge<rocfft_complex<float>> twTable(data->node->large1D);
-                std::tie(ns, twtc) = twTable.GenerateTwiddleTable();
-
-                int twl = 0;
-
-                if(data->node->large1D > (size_t)256 * 256 * 256 * 256)
-                    printf("large1D twiddle size too large error");
-                else if(data->node->large1D > (size_t)256 * 256 * 256)
-                    twl = 4;
-                else if(data->node->large1D > (size_t)256 * 256)
-                    twl = 3;
-                else if(data->node->large1D > (size_t)256)
-                    twl = 2;
+                if(post)
+                    R2CPost(x.data() + r * n, n, y.data() + r * storeLen);
                 else
-                    twl = 0;
-
-                for(size_t b = 0; b < howmany; b++)
-                {
-                    for(size_t i = 0; i < rows; i++)
-                    {
-                        for(size_t j = 0; j < cols; j++)
-                        {
-                            rocfft_complex<float> in_v, ot_v;
-
-                            in_v.x = in[b * rows * cols + i * cols + j].real();
-                            in_v.y = in[b * rows * cols + i * cols + j].imag();
-
-                            ot_v = TwMul(twtc, twl, data->node->direction, in_v, i * j);
-
-                            ot[b * rows * cols + j * rows + i].real(ot_v.x);
-                            ot[b * rows * cols + j * rows + i].imag(ot_v.y);
-                        }
-                    }
-                }
+                    std::copy_n(x.begin() + r * n, n, y.begin() + r * storeLen);
             }
+
+            // the twiddle index along the other dimension comes from
+            // the batch when transforms are counted by batch
+            const size_t twiddleDim = node.largeTwdBatchIsTransformCount ? node.length.size() : 1;
+
+            auto   storeLength = node.length;
+            size_t i           = 0;
+            storeLength[0]     = storeLen;
+            ForEachIndex(storeLength, node.batch, [&](const std::vector<size_t>& idx) {
+                cdouble value = y[i++];
+                if(node.large1D)
+                    value *= UnitRoot(node.direction, idx[0] * idx[twiddleDim], node.large1D);
+                emit(StockhamOutputOffset(node, idx[0], idx), value);
+            });
+            break;
         }
-        break;
-        case CS_KERNEL_COPY_R_TO_CMPLX:
+        case CS_KERNEL_2D_SINGLE:
+        case CS_KERNEL_3D_SINGLE:
         {
-            rocfft_complex<float>* ot = (rocfft_complex<float>*)fftwout.data;
-            size_t in_size_bytes      = (data->node->iDist * data->node->batch) * sizeof(float);
-
-            fftwbuf tmp_mem(data->node->iDist * data->node->batch, sizeof(rocfft_complex<float>));
+            const size_t dims = node.scheme == CS_KERNEL_3D_SINGLE ? 3 : 2;
 
-            hipMemcpy(tmp_mem.data, data->bufIn[0], in_size_bytes, hipMemcpyDeviceToHost);
-
-            rocfft_complex<float>* tmp_data = (rocfft_complex<float>*)tmp_mem.data;
+            auto x = gather(NaturalOffsets(node.length, node.inStride, node.iDist, node.batch));
+            FFT(x, {node.length.begin(), node.length.begin() + dims}, node.direction);
+            size_t i = 0;
+            ForEachIndex(node.length, node.batch, [&](const std::vector<size_t>& idx) {
+                emit(Offset(idx, node.outStride, node.oDist), x[i++]);
+            });
+            break;
+        }
+        case CS_KERNEL_BLUESTEIN_SINGLE:
+        {
+            // the reference is the DFT of the row, however the
+            // kernel computes it
+            auto x = gather(NaturalOffsets(node.length, node.inStride, node.iDist, node.batch));
+            FFT(x, {node.length[0]}, node.direction);
 
-            size_t elements = 1;
-            for(size_t d = 0; d < data->node->length.size(); d++)
-            {
-                elements *= data->node->length[d];
-            }
-            for(size_t b = 0; b < data->node->batch; b++)
+            const bool inplace = node.placement == rocfft_placement_inplace;
+            if(inplace)
             {
-                for(size_t i = 0; i < elements; i++)
-                {
-                    ot[data->node->oDist * b + i]
-                        = rocfft_complex<float>(tmp_data[data->node->iDist * b + i].real(), 0.0);
-                }
+                outBuf[0] = data.bufIn[0];
+                outBuf[1] = data.bufIn[1];
+                outType   = inType;
             }
+            const auto& stride = inplace ? node.inStride : node.outStride;
+            const auto  dist   = inplace ? node.iDist : node.oDist;
+            size_t      i      = 0;
+            ForEachIndex(node.length, node.batch, [&](const std::vector<size_t>& idx) {
+                emit(Offset(idx, stride, dist), x[i++]);
+            });
+            break;
         }
-        break;
-        case CS_KERNEL_COPY_CMPLX_TO_HERM:
+        case CS_KERNEL_TRANSPOSE:
+        case CS_KERNEL_TRANSPOSE_XY_Z:
+        case CS_KERNEL_TRANSPOSE_Z_XY:
+        {
+            // the permutation is in the output strides
+            auto   x = gather(NaturalOffsets(node.length, node.inStride, node.iDist, node.batch));
+            size_t i = 0;
+            ForEachIndex(node.length, node.batch, [&](const std::vector<size_t>& idx) {
+                cdouble value = x[i++];
+                if(node.large1D)
+                    value *= UnitRoot(node.direction, idx[0] * idx[1], node.large1D);
+                emit(Offset(idx, node.outStride, node.oDist), value);
+            });
+            break;
+        }
+        case CS_KERNEL_R_TO_CMPLX:
+        case CS_KERNEL_CMPLX_TO_R:
         {
-            rocfft_complex<float>* ot = (rocfft_complex<float>*)fftwout.data;
-            // assump the input is complex, the output is hermitian on take the first
-            // [N/2 + 1] elements
-            size_t in_size_bytes = (data->node->iDist * data->node->batch) * 2 * sizeof(float);
-
-            fftwbuf tmp_mem(data->node->iDist * data->node->batch, sizeof(rocfft_complex<float>));
-
-            hipMemcpy(tmp_mem.data, data->bufIn[0], in_size_bytes, hipMemcpyDeviceToHost);
-
-            rocfft_complex<float>* tmp_data = (rocfft_complex<float>*)tmp_mem.data;
-
-            size_t elements = 1;
-            elements *= data->node->length[0] / 2 + 1;
-            for(size_t d = 1; d < data->node->length.size(); d++)
+            // contiguous rows, with higher dimensions rows apart
+            const bool   r2c      = node.scheme == CS_KERNEL_R_TO_CMPLX;
+            const size_t half_N   = r2c ? node.length[0] : node.length[0] - 1;
+            const size_t loadLen  = r2c ? half_N : half_N + 1;
+            const size_t storeLen = r2c ? half_N + 1 : half_N;
+            const size_t is1      = node.length.size() > 1 ? node.inStride[1] : 0;
+            const size_t os1      = node.length.size() > 1 ? node.outStride[1] : 0;
+            const size_t high     = std::accumulate(node.length.begin() + 1,
+                                                node.length.end(),
+                                                static_cast<size_t>(1),
+                                                std::multiplies<size_t>());
+            const size_t rows     = high * node.batch;
+
+            std::vector<size_t> inOffsets;
+            for(size_t r = 0; r < rows; ++r)
+                for(size_t k = 0; k < loadLen; ++k)
+                    inOffsets.push_back((r / high) * node.iDist + (r % high) * is1 + k);
+            auto x = gather(inOffsets);
+
+            std::vector<cdouble> y(storeLen + 1);
+            for(size_t r = 0; r < rows; ++r)
             {
-                elements *= data->node->length[d];
+                if(r2c)
+                    R2CPost(x.data() + r * loadLen, half_N, y.data());
+                else
+                    C2RPre(x.data() + r * loadLen, half_N, y.data());
+                for(size_t k = 0; k < storeLen; ++k)
+                    emit((r / high) * node.oDist + (r % high) * os1 + k, y[k]);
             }
-
-            rocfft_cout << "iDist: " << data->node->iDist << " Dist: " << data->node->oDist
-                        << " in complex2hermitian kernel\n";
-            for(size_t b = 0; b < data->node->batch; b++)
+            break;
+        }
+        case CS_KERNEL_R_TO_CMPLX_TRANSPOSE:
+        case CS_KERNEL_TRANSPOSE_CMPLX_TO_R:
+        {
+            // real/complex processing along one dimension, fused
+            // with a transpose
+            const size_t dim    = node.length.size();
+            const bool   r2c    = node.scheme == CS_KERNEL_R_TO_CMPLX_TRANSPOSE;
+            const auto&  is     = node.inStride;
+            const auto&  os     = node.outStride;
+            const size_t len0   = node.length[0];
+            const size_t len1   = node.length[1];
+            const size_t half_N = r2c ? len0 : node.length[dim - 1] - 1;
+            const size_t lines  = r2c ? (dim == 3 ? len1 * node.length[2] : len1)
+                                      : (dim == 3 ? len0 * len1 : len0);
+
+            std::vector<size_t> inOffsets;
+            for(size_t i = 0; i < lines * node.batch; ++i)
             {
-                for(size_t i = 0; i < elements; i++) // TODO: only work for 1D cases
+                const size_t b    = i / lines;
+                const size_t line = i % lines;
+                if(r2c)
                 {
-                    ot[data->node->oDist * b + i] = tmp_data[data->node->iDist * b + i];
+                    const size_t inOffset = b * node.iDist + (line % len1) * is[1]
+                                            + (dim == 3 ? (line / len1) * is[2] : 0);
+                    for(size_t k = 0; k < half_N; ++k)
+                        inOffsets.push_back(inOffset + k);
                 }
-            }
-        }
-        break;
-        case CS_KERNEL_COPY_HERM_TO_CMPLX:
-        {
-            rocfft_complex<float>* ot = (rocfft_complex<float>*)fftwout.data;
-            // assump the input is hermitian, the output is complex on take the first
-            // [N/2 + 1] elements
-            size_t in_size_bytes = (data->node->iDist * data->node->batch) * 2 * sizeof(float);
-
-            fftwbuf tmp_mem(data->node->iDist * data->node->batch, sizeof(rocfft_complex<float>));
-
-            hipMemcpy(tmp_mem.data, data->bufIn[0], in_size_bytes, hipMemcpyDeviceToHost);
-
-            rocfft_complex<float>* tmp_data = (rocfft_complex<float>*)tmp_mem.data;
-
-            size_t output_size = data->node->length[0];
-            size_t input_size  = output_size / 2 + 1;
-
-            rocfft_cout << "iDist: " << data->node->iDist << " Dist: " << data->node->oDist
-                        << " in hermitian2complex kernel\n";
-
-            for(size_t b = 0; b < data->node->batch; b++)
-            {
-                for(size_t d = 0;
-                    d < (data->node->length.size() == 2 ? (data->node->length[1]) : 1);
-                    d++) // TODO; only work for 1D or 2D
+                else
                 {
-                    for(size_t i = 0; i < input_size; i++)
-                    {
-                        ot[data->node->oDist * b + d * output_size + i]
-                            = tmp_data[data->node->iDist * b + d * input_size + i];
-
-                        if(i > 0)
-                        {
-                            size_t mirror = output_size - i;
-                            ot[data->node->oDist * b + d * output_size + mirror]
-                                = tmp_data[data->node->iDist * b + d * input_size + i];
-                        }
-                    }
+                    const size_t inOffset
+                        = b * node.iDist + (line % len0) * is[0] + (line / len0) * is[1];
+                    for(size_t k = 0; k <= half_N; ++k)
+                        inOffsets.push_back(inOffset + k * is[dim - 1]);
                 }
             }
-        }
-        break;
-        case CS_KERNEL_R_TO_CMPLX:
-        {
-            // Post-processing stage of 1D real-to-complex transform, out-of-place
-            const size_t halfN = data->node->length[0];
-            const size_t batch = data->node->batch;
+            auto x = gather(inOffsets);
 
-            assert(fftwin.size == batch * halfN);
-            assert(fftwout.size == batch * (halfN + 1));
-
-            const auto             input  = (rocfft_complex<float>*)fftwin.data;
-            rocfft_complex<float>* output = (rocfft_complex<float>*)fftwout.data;
-
-            size_t output_idx_base = 0;
-
-            const rocfft_complex<float> I(0, 1);
-            const rocfft_complex<float> one(1, 0);
-            const rocfft_complex<float> half(0.5, 0);
-
-            const float overN = 0.5 / halfN;
-
-            for(int ibatch = 0; ibatch < batch; ++ibatch)
+            const size_t         loadLen = r2c ? half_N : half_N + 1;
+            std::vector<cdouble> y(half_N + 1);
+            for(size_t i = 0; i < lines * node.batch; ++i)
             {
-                const auto bin  = input + ibatch * halfN;
-                auto       bout = output + ibatch * (halfN + 1);
-                bout[0]         = rocfft_complex<float>(bin[0].real() + bin[0].imag());
-                for(int r = 1; r < halfN; ++r)
+                const size_t b    = i / lines;
+                const size_t line = i % lines;
+                if(r2c)
                 {
-                    const auto omegaNr
-                        = std::exp(rocfft_complex<float>(0.0f, (float)(-2.0f * M_PI * r * overN)));
-                    bout[r] = bin[r] * half * (one - I * omegaNr)
-                              + conj(bin[halfN - r]) * half * (one + I * omegaNr);
+                    R2CPost(x.data() + i * loadLen, half_N, y.data());
+                    for(size_t k = 0; k <= half_N; ++k)
+                        emit(b * node.oDist + k * os[dim - 1] + line, y[k]);
                 }
-            }
-            output[output_idx_base + halfN]
-                = rocfft_complex<float>(input[0].real() - input[0].imag(), 0);
-        }
-        break;
-        case CS_KERNEL_CMPLX_TO_R:
-        {
-            // Pre-processing stage of 1D complex-to-real transform, out-of-place
-            const size_t halfN = data->node->length[0];
-            const size_t batch = data->node->batch;
-
-            assert(fftwin.size == batch * (halfN + 1));
-            assert(fftwout.size == batch * halfN);
-            assert(fftwin.typesize == sizeof(rocfft_complex<float>));
-            assert(fftwout.typesize == sizeof(rocfft_complex<float>));
-
-            const rocfft_complex<float>* input  = (rocfft_complex<float>*)fftwin.data;
-            rocfft_complex<float>*       output = (rocfft_complex<float>*)fftwout.data;
-
-            const float                 overN = 0.5 / halfN;
-            const rocfft_complex<float> I(0, 1);
-            const rocfft_complex<float> one(1, 0);
-
-            for(int ibatch = 0; ibatch < batch; ++ibatch)
-            {
-                const auto bin  = input + ibatch * (halfN + 1);
-                auto       bout = output + ibatch * halfN;
-                for(int r = 0; r < halfN; ++r)
+                else
                 {
-                    const auto omegaNr = std::exp(rocfft_complex<float>(0, 2.0 * M_PI * r * overN));
-                    bout[r]
-                        = bin[r] * (one + I * omegaNr) + conj(bin[halfN - r]) * (one - I * omegaNr);
+                    C2RPre(x.data() + i * loadLen, half_N, y.data());
+                    const size_t outOffset = b * node.oDist + (line % len0) * os[1]
+                                             + (dim == 3 ? (line / len0) * os[2] : 0);
+                    for(size_t k = 0; k < half_N; ++k)
+                        emit(outOffset + k * os[0], y[k]);
                 }
             }
+            break;
         }
-        break;
-        case CS_KERNEL_CHIRP:
+        case CS_KERNEL_COPY_R_TO_CMPLX:
+        case CS_KERNEL_COPY_CMPLX_TO_R:
         {
-            size_t N = data->node->length[0];
-            size_t M = data->node->lengthBlue;
-            chirp(N, M, data->node->direction, (local_fftwf_complex*)fftwout.data);
+            auto   x = gather(NaturalOffsets(node.length, node.inStride, node.iDist, node.batch));
+            size_t i = 0;
+            ForEachIndex(node.length, node.batch, [&](const std::vector<size_t>& idx) {
+                emit(Offset(idx, node.outStride, node.oDist), cdouble(x[i++].real(), 0.0));
+            });
+            break;
         }
-        break;
-        case CS_KERNEL_PAD_MUL:
+        case CS_KERNEL_COPY_CMPLX_TO_HERM:
         {
-            rocfft_complex<float>* in = (rocfft_complex<float>*)fftwin.data;
-            rocfft_complex<float>* ot = (rocfft_complex<float>*)fftwout.data;
-            CopyInputVector(data_p);
-
-            size_t howmany = data->node->batch;
-            for(size_t i = 1; i < data->node->length.size(); i++)
-                howmany *= data->node->length[i];
-
-            size_t N = data->node->length[0];
-            size_t M = data->node->lengthBlue;
-
-            fftwbuf chirp_mem(M * 2, sizeof(rocfft_complex<float>));
-
-            chirp(N, M, data->node->direction, (local_fftwf_complex*)chirp_mem.data);
-
-            rocfft_complex<float>* chirp_data = (rocfft_complex<float>*)chirp_mem.data;
-
-            for(size_t b = 0; b < howmany; b++)
-            {
-                for(size_t i = 0; i < M; i++)
-                {
-                    if(i < N)
-                    {
-                        float in_r = in[b * N + i].real();
-                        float in_i = in[b * N + i].imag();
-                        float ch_r = chirp_data[i].real();
-                        float ch_i = chirp_data[i].imag();
-
-                        ot[b * M + i].real(in_r * ch_r + in_i * ch_i);
-                        ot[b * M + i].imag(-in_r * ch_i + in_i * ch_r);
-                    }
-                    else
-                    {
-                        ot[b * M + i].real(0);
-                        ot[b * M + i].imag(0);
-                    }
-                }
-            }
+            auto length = node.length;
+            length[0]   = length[0] / 2 + 1;
+            auto   x    = gather(NaturalOffsets(length, node.inStride, node.iDist, node.batch));
+            size_t i    = 0;
+            ForEachIndex(length, node.batch, [&](const std::vector<size_t>& idx) {
+                emit(Offset(idx, node.outStride, node.oDist), x[i++]);
+            });
+            break;
         }
-        break;
-        case CS_KERNEL_FFT_MUL:
+        case CS_KERNEL_COPY_HERM_TO_CMPLX:
         {
-            rocfft_complex<float>* in = (rocfft_complex<float>*)fftwin.data;
-            rocfft_complex<float>* ot = (rocfft_complex<float>*)fftwout.data;
-            size_t                 M  = data->node->lengthBlue;
-            size_t                 N  = data->node->parent->length[0];
-
-            CopyInputVector(data_p, M * 2 * 2 * sizeof(float));
-
-            fftwbuf chirp_mem(M * 2, sizeof(rocfft_complex<float>));
-
-            chirp_fft(N, M, data->node->direction, (local_fftwf_complex*)chirp_mem.data);
-
-            rocfft_complex<float>* chirp_data = (rocfft_complex<float>*)chirp_mem.data;
-
-            size_t howmany = data->node->batch;
-            for(size_t i = 1; i < data->node->length.size(); i++)
-                howmany *= data->node->length[i];
-
-            for(size_t b = 0; b < howmany; b++)
+            // expand the non-redundant half of dim 0 to a full
+            // complex array, using Hermitian symmetry
+            const size_t outLen0 = node.outputLength[0];
+            auto         length  = node.length;
+            length[0]            = outLen0 / 2 + 1;
+            auto   x = gather(NaturalOffsets(length, node.inStride, node.iDist, node.batch));
+            size_t i = 0;
+            ForEachIndex(length, node.batch, [&](const std::vector<size_t>& idx) {
+                const cdouble value = x[i++];
+                emit(Offset(idx, node.outStride, node.oDist), value);
+                if(idx[0] == 0 || 2 * idx[0] == outLen0)
+                    return;
+                size_t mirror = ((outLen0 - idx[0]) % outLen0) * node.outStride[0];
+                for(size_t d = 1; d < node.length.size(); ++d)
+                    mirror += ((node.length[d] - idx[d]) % node.length[d]) * node.outStride[d];
+                emit(mirror + idx.back() * node.oDist, std::conj(value));
+            });
+            break;
+        }
+        case CS_KERNEL_CHIRP:
+        {
+            // chirp and its mirror image, zero padded to lengthBlue,
+            // twice
+            const size_t N = node.length[0];
+            const size_t M = node.lengthBlue;
+            outType        = rocfft_array_type_complex_interleaved;
+            for(size_t copy = 0; copy < 2; ++copy)
             {
-                for(size_t i = 0; i < M; i++)
+                for(size_t t = 0; t < M; ++t)
                 {
-                    float in_r = in[b * M + i].real();
-                    float in_i = in[b * M + i].imag();
-                    float ch_r = chirp_data[i].real();
-                    float ch_i = chirp_data[i].imag();
-
-                    ot[b * M + i].real(in_r * ch_r - in_i * ch_i);
-                    ot[b * M + i].imag(in_r * ch_i + in_i * ch_r);
+                    cdouble value = 0.0;
+                    if(t < N)
+                        value = Chirp(node.direction, t, N);
+                    else if(M - t < N)
+                        value = Chirp(node.direction, M - t, N);
+                    emit(copy * M + t, value);
                 }
             }
+            scaled = false;
+            break;
         }
-        break;
+        case CS_KERNEL_PAD_MUL:
+        case CS_KERNEL_FFT_MUL:
         case CS_KERNEL_RES_MUL:
         {
-            rocfft_complex<float>* in = (rocfft_complex<float>*)fftwin.data;
-            rocfft_complex<float>* ot = (rocfft_complex<float>*)fftwout.data;
-            size_t                 M  = data->node->lengthBlue;
-            size_t                 N  = data->node->length[0];
-
-            CopyInputVector(data_p, M * 2 * 2 * sizeof(float));
-
-            fftwbuf chirp_mem(M * 2, sizeof(rocfft_complex<float>));
-
-            chirp(N, M, data->node->direction, (local_fftwf_complex*)chirp_mem.data);
-
-            rocfft_complex<float>* chirp_data = (rocfft_complex<float>*)chirp_mem.data;
-
-            size_t howmany = data->node->batch;
-            for(size_t i = 1; i < data->node->length.size(); i++)
-                howmany *= data->node->length[i];
-
-            double MI = 1.0 / (double)M;
-            for(size_t b = 0; b < howmany; b++)
+            // Bluestein element-wise steps.  The Bluestein buffer
+            // starts with two copies of the chirp, or the chirp and
+            // its FFT, followed by padded rows.
+            const size_t N      = node.length[0];
+            const size_t M      = node.lengthBlue;
+            auto         rowLen = node.length;
+            rowLen[0]           = 1;
+            std::vector<size_t> inRows;
+            std::vector<size_t> outRows;
+            ForEachIndex(rowLen, node.batch, [&](const std::vector<size_t>& idx) {
+                inRows.push_back(Offset(idx, node.inStride, node.iDist, 1));
+                outRows.push_back(Offset(idx, node.outStride, node.oDist, 1));
+            });
+            const size_t is0 = node.inStride[0];
+            const size_t os0 = node.outStride[0];
+
+            // offsets to read from input and output buffers
+            std::vector<size_t> inOffsets;
+            std::vector<size_t> outReads;
+            if(node.scheme == CS_KERNEL_PAD_MUL)
             {
-                for(size_t i = 0; i < N; i++)
-                {
-                    float in_r = in[b * N + i].real();
-                    float in_i = in[b * N + i].imag();
-                    float ch_r = chirp_data[i].real();
-                    float ch_i = chirp_data[i].imag();
-
-                    ot[b * N + i].real(MI * (in_r * ch_r + in_i * ch_i));
-                    ot[b * N + i].imag(MI * (-in_r * ch_i + in_i * ch_r));
-                }
+                // input rows times the conjugate of the second chirp
+                for(auto row : inRows)
+                    for(size_t k = 0; k < N; ++k)
+                        inOffsets.push_back(row + k * is0);
+                for(size_t k = 0; k < N; ++k)
+                    outReads.push_back(M + k);
+                auto x     = gather(inOffsets);
+                auto chirp = Gather(data.bufOut, outType, node.precision, outReads);
+                for(size_t r = 0; r < outRows.size(); ++r)
+                    for(size_t k = 0; k < M; ++k)
+                        emit(2 * M + outRows[r] + k * os0,
+                             k < N ? x[r * N + k] * std::conj(chirp[k]) : 0.0);
+            }
+            else if(node.scheme == CS_KERNEL_FFT_MUL)
+            {
+                // padded rows times the FFT of the chirp
+                for(size_t k = 0; k < M; ++k)
+                    inOffsets.push_back(M + k * is0);
+                for(auto row : outRows)
+                    for(size_t k = 0; k < M; ++k)
+                        outReads.push_back(2 * M + row + k * os0);
+                auto chirpFFT = gather(inOffsets);
+                auto x = Gather(data.bufOut, outType, node.precision, outReads);
+                for(size_t i = 0; i < outReads.size(); ++i)
+                    emit(outReads[i], x[i] * chirpFFT[i % M]);
+            }
+            else
+            {
+                // convolved rows times the conjugate of the chirp
+                for(size_t k = 0; k < N; ++k)
+                    inOffsets.push_back(k);
+                for(auto row : inRows)
+                    for(size_t k = 0; k < N; ++k)
+                        inOffsets.push_back(2 * M + row + k * is0);
+                auto x = gather(inOffsets);
+                for(size_t r = 0; r < outRows.size(); ++r)
+                    for(size_t k = 0; k < N; ++k)
+                        emit(outRows[r] + k * os0,
+                             x[N + r * N + k] * std::conj(x[k]) / static_cast<double>(M));
             }
+            scaled = node.scheme == CS_KERNEL_RES_MUL;
+            break;
         }
-        break;
         default:
-            // assert(false);
-            // do not terminate the program but only tells not implemented
-            rocfft_cout << "Not implemented\n";
+            skipReason = "scheme not implemented";
+            return;
+        }
+
+        if(scaled && node.IsScalingEnabled())
+        {
+            for(auto& value : expected)
+                value *= node.scale_factor;
         }
     }
 
 public:
-    explicit RefLibOp(const void* data_p)
+    RefLibOp(const void* data_p, size_t kernelIndex)
+        : kernelIndex(kernelIndex)
     {
-        DataSetup(data_p);
-        Execute(data_p);
+        auto data = static_cast<const DeviceCallIn*>(data_p);
+
+        if(hipDeviceSynchronize() != hipSuccess)
+            throw std::runtime_error("hipDeviceSynchronize failure");
+        Setup(*data);
     }
 
     void VerifyResult(const void* data_p)
     {
-        auto   data        = static_cast<DeviceCallIn*>(data_p);
-        size_t out_size    = (data->node->oDist * data->node->batch);
-        size_t checklength = data->node->length[0];
-        for(int i = 1; i < data->node->length.size(); ++i)
-        {
-            checklength *= data->node->length[i];
-        }
-        void* bufOut = data->bufOut[0];
+        auto        data = static_cast<const DeviceCallIn*>(data_p);
+        const auto& node = *data->node;
 
-        switch(data->node->scheme)
+        rocfft_cout << "kernel " << kernelIndex << " (" << PrintScheme(node.scheme) << "): ";
+        if(!skipReason.empty())
         {
-        case CS_KERNEL_CHIRP:
-            out_size *= 2;
-            break;
-        case CS_KERNEL_FFT_MUL:
-        case CS_KERNEL_PAD_MUL:
-            // TODO: document
-            bufOut = ((char*)bufOut + 2 * 2 * sizeof(float) * data->node->lengthBlue);
-            break;
-        case CS_KERNEL_COPY_CMPLX_TO_R:
-        case CS_KERNEL_COPY_HERM_TO_CMPLX:
-        case CS_KERNEL_STOCKHAM_BLOCK_RC:
-        case CS_KERNEL_STOCKHAM_BLOCK_CC:
-            return; // not implemented
-            break;
-        case CS_KERNEL_COPY_CMPLX_TO_HERM:
-            checklength = libout.size / 2 + 1;
-            break;
-        case CS_KERNEL_CMPLX_TO_R:
-            checklength = libout.size / 2;
-            break;
-        default:
-            break;
+            rocfft_cout << "not checked, " << skipReason << std::endl;
+            return;
         }
 
-        fftwbuf tmp_mem(out_size, sizeof(rocfft_complex<float>));
+        if(hipDeviceSynchronize() != hipSuccess)
+            throw std::runtime_error("hipDeviceSynchronize failure");
+        auto actual = Gather(outBuf, outType, node.precision, outOffsets);
 
-        // Copy the device information to out local buffer:
-        hipMemcpy(tmp_mem.data, bufOut, tmp_mem.bufsize(), hipMemcpyDeviceToHost);
+        // real outputs only have a real part to compare
+        const bool realOut = outType == rocfft_array_type_real;
 
-        switch(data->node->scheme)
-        {
-        case CS_KERNEL_TRANSPOSE:
-        {
-            std::vector<size_t> length_transpose_output;
-            length_transpose_output.push_back(data->node->length[1]);
-            length_transpose_output.push_back(data->node->length[0]);
-            for(size_t i = 2; i < data->node->length.size(); i++)
-                length_transpose_output.push_back(data->node->length[i]);
-            CopyVector((local_fftwf_complex*)libout.data,
-                       (local_fftwf_complex*)tmp_mem.data,
-                       data->node->batch,
-                       data->node->oDist,
-                       length_transpose_output,
-                       data->node->outStride);
-        }
-        break;
-        case CS_KERNEL_CHIRP:
-        {
-            std::vector<size_t> length_chirp;
-            length_chirp.push_back(data->node->lengthBlue);
-            CopyVector((local_fftwf_complex*)libout.data,
-                       (local_fftwf_complex*)tmp_mem.data,
-                       2 * data->node->batch,
-                       data->node->oDist,
-                       length_chirp,
-                       data->node->outStride);
-        }
-        break;
-        case CS_KERNEL_PAD_MUL:
+        double errSq  = 0.0;
+        double refSq  = 0.0;
+        double errMax = 0.0;
+        double refMax = 0.0;
+        size_t errIdx = 0;
+        for(size_t i = 0; i < expected.size(); ++i)
         {
-            std::vector<size_t> length_ot;
-            length_ot.push_back(data->node->lengthBlue);
-            for(size_t i = 1; i < data->node->length.size(); i++)
-                length_ot.push_back(data->node->length[i]);
-            CopyVector((local_fftwf_complex*)libout.data,
-                       (local_fftwf_complex*)tmp_mem.data,
-                       data->node->batch,
-                       data->node->oDist,
-                       length_ot,
-                       data->node->outStride);
-        }
-        break;
-        case CS_KERNEL_COPY_CMPLX_TO_HERM:
-            hipMemcpy(libout.data,
-                      tmp_mem.data,
-                      tmp_mem.bufsize(),
-                      hipMemcpyHostToHost); // hermitan only works for batch=1, dense
-            // packed cases
-            //assert(batch == 1);
-            return; // TODO
-            break;
-        default:
-        {
-            CopyVector((local_fftwf_complex*)libout.data,
-                       (local_fftwf_complex*)tmp_mem.data,
-                       data->node->batch,
-                       data->node->oDist,
-                       data->node->length,
-                       data->node->outStride);
-        }
+            const cdouble ref  = realOut ? cdouble(expected[i].real(), 0.0) : expected[i];
+            const double  diff = std::abs(actual[i] - ref);
+            errSq += diff * diff;
+            refSq += std::norm(ref);
+            refMax = std::max(refMax, std::abs(ref));
+            if(diff > errMax)
+            {
+                errMax = diff;
+                errIdx = i;
+            }
         }
+        const double l2   = refSq > 0.0 ? std::sqrt(errSq / refSq) : std::sqrt(errSq);
+        const double linf = refMax > 0.0 ? errMax / refMax : errMax;
 
-        double maxMag = 0.0;
-        double rmse   = 0.0;
+        rocfft_cout << expected.size() << " elements, L2 rel err " << l2 << ", Linf rel err "
+                    << linf;
+        if(errMax > 0.0)
+            rocfft_cout << " at offset " << outOffsets[errIdx];
+        rocfft_cout << std::endl;
 
-        // compare library results vs CPU results
-        // TODO: what about real-valued outputs?
-        rocfft_complex<float>* lb = (rocfft_complex<float>*)libout.data;
-        rocfft_complex<float>* ot = (rocfft_complex<float>*)fftwout.data;
-        for(size_t i = 0; i < checklength; i++)
+        auto& report = RefLibHandle::GetRefLibHandle().report;
+        if(report.is_open())
         {
-            double ac_r = lb[i].real();
-            double ac_i = lb[i].imag();
-            double ex_r = ot[i].real();
-            double ex_i = ot[i].imag();
-
-            double mag = ex_r * ex_r + ex_i * ex_i;
-            maxMag     = (mag > maxMag) ? mag : maxMag;
-
-            rmse += ((ex_r - ac_r) * (ex_r - ac_r) + (ex_i - ac_i) * (ex_i - ac_i));
+            report << kernelIndex << "," << PrintScheme(node.scheme) << ","
+                   << (node.precision == rocfft_precision_double ? "double" : "single") << ",";
+            for(size_t d = 0; d < node.length.size(); ++d)
+                report << (d ? "x" : "") << node.length[d];
+            report << "," << node.batch << "," << expected.size() << "," << l2 << "," << linf
+                   << std::endl;
         }
+    }
 
-        maxMag       = sqrt(maxMag);
-        rmse         = sqrt(rmse / (double)checklength);
-        double nrmse = rmse / maxMag;
-
-        rocfft_cout << "rmse: " << rmse << std::endl << "nrmse: " << nrmse << std::endl;
-        rocfft_cout << "---------------------------------------------" << std::endl;
+private:
+    size_t kernelIndex;
 
-#if 0
-        rocfft_complex<float>* in      = (rocfft_complex<float>*)fftwin.data;
+    // if non-empty, the kernel can't be checked, for this reason
+    std::string skipReason;
 
-        rocfft_cout << "input:" << std::endl;
-        for(size_t i = 0; i < fftwin.size; ++i)
-        {
-            rocfft_cout << i << "\t(" << in[i].real() << ", " << in[i].imag() << ")\n";
-        }
-
-        rocfft_cout << "lib output vs cpu output:" << std::endl;
-        for(size_t i = 0; i < libout.size; ++i)
-        {
-            rocfft_cout << i << "\t(" << lb[i].real() << "," << lb[i].imag() << ")"
-                      << "\t(" << ot[i].real() << "," << ot[i].imag() << ")\n";
-        }
-#endif
-    }
+    // buffer the kernel writes to, and the offsets in it that should
+    // hold the expected values
+    void*                outBuf[2] = {};
+    rocfft_array_type    outType   = rocfft_array_type_complex_interleaved;
+    std::vector<size_t>  outOffsets;
+    std::vector<cdouble> expected;
 };
 
 #endif // REF_DEBUG
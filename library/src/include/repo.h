@@ -23,93 +23,53 @@
 #define REPO_H
 
 #include "../../../shared/gpubuf.h"
+#include "twiddles.h"
 #include <map>
+#include <memory>
 #include <mutex>
 
 class Repo
 {
     Repo() {}
 
-    // key structure for 1D twiddles - these are the arguments to
-    // twiddle creation
-    struct repo_key_1D_t
+    // key structure for twiddles - the table description, plus
+    // the device, since buffers are in device memory and we need
+    // per-device twiddles
+    struct repo_key_t
     {
-        // twiddle table length
-        size_t           length       = 0;
-        size_t           length_limit = 0;
-        rocfft_precision precision    = rocfft_precision_single;
-        // large twiddle base (0 for non-large twiddle)
-        size_t              large_twiddle_base = 0;
-        bool                attach_halfN       = false;
-        std::vector<size_t> radices;
-        // buffers are in device memory, so we need per-device
-        // twiddles
-        int deviceId = 0;
+        TwiddleTableSpec spec;
+        int              deviceId = 0;
 
-        bool operator<(const repo_key_1D_t& other) const
+        bool operator<(const repo_key_t& other) const
         {
-            if(length != other.length)
-                return length < other.length;
-            if(length_limit != other.length_limit)
-                return length_limit < other.length_limit;
-            if(precision != other.precision)
-                return precision < other.precision;
-            if(large_twiddle_base != other.large_twiddle_base)
-                return large_twiddle_base < other.large_twiddle_base;
-            if(attach_halfN != other.attach_halfN)
-                return attach_halfN < other.attach_halfN;
-            if(radices != other.radices)
-                return radices < other.radices;
+            if(spec < other.spec)
+                return true;
+            if(other.spec < spec)
+                return false;
             return deviceId < other.deviceId;
         }
     };
-    // key structure for 2D twiddles
-    struct repo_key_2D_t
-    {
-        size_t           length0   = 0;
-        size_t           length1   = 0;
-        rocfft_precision precision = rocfft_precision_single;
-        // buffers are in device memory, so we need per-device
-        // twiddles
-        int deviceId = 0;
 
-        bool operator<(const repo_key_2D_t& other) const
-        {
-            if(length0 != other.length0)
-                return length0 < other.length0;
-            if(length1 != other.length1)
-                return length1 < other.length1;
-            if(precision != other.precision)
-                return precision < other.precision;
-            return deviceId < other.deviceId;
-        }
+    // a twiddle table is part of a device buffer that might hold
+    // several tables generated together.  the buffer is freed once
+    // none of its tables are in use.
+    struct repo_twiddle_t
+    {
+        std::shared_ptr<gpubuf> buf;
+        void*                   data = nullptr;
+        size_t                  size = 0;
+        // reference count
+        unsigned int refs = 0;
     };
 
-    // twiddle tables are buffers in device memory, along with a
-    // reference count
-    //
     // NOTE: some buffers might be more shareable here (e.g. simple
-    // 1D might match half of a 2D twiddle, or a simple 1D might be
-    // shareable with a same-length attach_halfN buffer)
-    std::map<repo_key_1D_t, std::pair<gpubuf, unsigned int>> twiddles_1D;
-    std::map<repo_key_2D_t, std::pair<gpubuf, unsigned int>> twiddles_2D;
+    // 1D might match part of a multi-dimensional twiddle, or a simple
+    // 1D might be shareable with a same-length attach_halfN buffer)
+    std::map<repo_key_t, repo_twiddle_t> twiddles;
     // reverse-map the device pointers back to the keys so users can
     // free the pointer they were given
-    std::map<void*, repo_key_1D_t> twiddles_1D_reverse;
-    std::map<void*, repo_key_2D_t> twiddles_2D_reverse;
-    static std::mutex              mtx;
-
-    // internal helpers to get and free twiddles
-    template <typename KeyType>
-    static std::pair<void*, size_t>
-        GetTwiddlesInternal(KeyType,
-                            std::map<KeyType, std::pair<gpubuf, unsigned int>>&,
-                            std::map<void*, KeyType>&,
-                            std::function<gpubuf(unsigned int)>);
-    template <typename KeyType>
-    static void ReleaseTwiddlesInternal(void* ptr,
-                                        std::map<KeyType, std::pair<gpubuf, unsigned int>>&,
-                                        std::map<void*, KeyType>&);
+    std::map<void*, repo_key_t> twiddles_reverse;
+    static std::mutex           mtx;
 
 public:
     // repo is a singleton, so no copying or assignment
@@ -127,19 +87,18 @@ public:
         repoDestroyed = true;
     }
 
-    static std::pair<void*, size_t> GetTwiddles1D(size_t                     length,
-                                                  size_t                     length_limit,
-                                                  rocfft_precision           precision,
-                                                  const char*                gpu_arch,
-                                                  size_t                     largeTwdBase,
-                                                  bool                       attach_halfN,
-                                                  const std::vector<size_t>& radices);
-    static std::pair<void*, size_t> GetTwiddles2D(size_t           length0,
-                                                  size_t           length1,
-                                                  rocfft_precision precision,
-                                                  const char*      gpu_arch);
-    static void                     ReleaseTwiddle1D(void* ptr);
-    static void                     ReleaseTwiddle2D(void* ptr);
+    // get several twiddle tables, returning the pointer and size of
+    // each.  tables that aren't already in the repo are generated
+    // together, into one device buffer.  each table returned must be
+    // released with ReleaseTwiddles.
+    static std::vector<std::pair<void*, size_t>>
+        GetTwiddlesBatch(const std::vector<TwiddleTableSpec>& specs, const char* gpu_arch);
+    static std::pair<void*, size_t> GetTwiddles(const TwiddleTableSpec& spec,
+                                                const char*             gpu_arch)
+    {
+        return GetTwiddlesBatch({spec}, gpu_arch).front();
+    }
+    static void ReleaseTwiddles(void* ptr);
     // remove cached twiddles
     static void Clear();
 
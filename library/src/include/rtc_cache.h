@@ -25,9 +25,15 @@
 #include "rtc_generator.h"
 #include "sqlite3.h"
 #include <array>
+#include <cstdint>
+#include <future>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <string>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #if __has_include(<filesystem>)
@@ -60,10 +66,74 @@ struct sqlite3_stmt_deleter
 typedef std::unique_ptr<sqlite3, sqlite3_deleter>           sqlite3_ptr;
 typedef std::unique_ptr<sqlite3_stmt, sqlite3_stmt_deleter> sqlite3_stmt_ptr;
 
+// Read-only kernel cache file, as written by
+// RTCCache::write_aot_cache.  The file starts with an index of
+// kernels sorted by key, followed by the kernel names and code
+// objects.  It's memory-mapped, so a lookup is a binary search over
+// the index, and the mapped pages are shared by every process that
+// uses the same file.
+class AOTCacheFile
+{
+public:
+    // returns null if the path isn't a readable file in this format
+    static std::unique_ptr<AOTCacheFile> open(const std::filesystem::path& path);
+    ~AOTCacheFile();
+
+    AOTCacheFile(const AOTCacheFile&) = delete;
+    AOTCacheFile& operator=(const AOTCacheFile&) = delete;
+
+    // returns pointer to the code object in the mapped file, and its
+    // length.  returns null if no matching kernel was found.
+    const char* find(const std::string&          kernel_name,
+                     const std::string&          gpu_arch,
+                     int64_t                     hip_version,
+                     const std::array<char, 32>& generator_sum,
+                     size_t&                     code_bytes) const;
+
+private:
+    AOTCacheFile() = default;
+
+    // check that the header and index fit in the file and point to
+    // data that's also inside the file
+    bool valid() const;
+
+    const char* data = nullptr;
+    size_t      size = 0;
+#ifdef WIN32
+    // handle to the file mapping object
+    void* mapping = nullptr;
+#endif
+};
+
+// Exclusive lock shared by every process on a node that uses the
+// same user cache file, held while compiling a kernel so that only
+// one process compiles it.  The lock is a file lock, so the OS
+// releases it if the holder dies.
+class RTCCompileLock
+{
+public:
+    // blocks until the lock is acquired.  returns null if locking
+    // isn't possible, in which case the caller should just compile.
+    static std::unique_ptr<RTCCompileLock> acquire(const std::filesystem::path& lock_path);
+    ~RTCCompileLock();
+
+    RTCCompileLock(const RTCCompileLock&) = delete;
+    RTCCompileLock& operator=(const RTCCompileLock&) = delete;
+
+private:
+    RTCCompileLock() = default;
+
+#ifdef WIN32
+    void* handle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
 struct RTCCache
 {
     RTCCache();
-    ~RTCCache() = default;
+    ~RTCCache();
 
     // get bytes for a matching code object from the cache.
     // returns empty vector if a matching kernel was not found.
@@ -71,11 +141,43 @@ struct RTCCache
                                       const std::string&          gpu_arch,
                                       const std::array<char, 32>& generator_sum);
 
-    // store the code object into the cache.
+    // get bytes for a code object that was compiled from source with
+    // the given checksum, under any generator sum.  only the user
+    // cache is searched.  returns empty vector if a matching kernel
+    // was not found.  also returns how long the kernel took to
+    // compile.
+    std::vector<char> get_code_object_by_source(const std::string& kernel_name,
+                                                const std::string& gpu_arch,
+                                                sqlite3_int64      source_sum,
+                                                sqlite3_int64&     compile_ms);
+
+    // store the code object into the cache, along with the checksum
+    // of the source it was compiled from and how long that took.
     void store_code_object(const std::string&          kernel_name,
                            const std::string&          gpu_arch,
                            const std::array<char, 32>& generator_sum,
-                           const std::vector<char>&    code);
+                           const std::vector<char>&    code,
+                           sqlite3_int64               source_sum,
+                           sqlite3_int64               compile_ms);
+
+    // lock compilation of a kernel for an architecture across all
+    // processes that use the same user cache file.  returns null if
+    // the user cache isn't a file, since then no other process can
+    // see what this one compiles.
+    std::unique_ptr<RTCCompileLock> lock_compile(const std::string& kernel_name,
+                                                 const std::string& gpu_arch);
+
+    // get how long each kernel in the user cache took to compile
+    // for all of its architectures, in milliseconds.  if a kernel
+    // was compiled from several versions of its source for an
+    // architecture, the slowest one counts.
+    std::unordered_map<std::string, sqlite3_int64> get_compile_durations();
+
+    // get the kernel names and source checksums in the user cache
+    // that have been compiled for every one of the given
+    // architectures
+    std::set<std::pair<std::string, sqlite3_int64>>
+        get_compiled_sources(const std::vector<std::string>& gpu_archs);
 
     // allocates buffer, call serialize_free to free it
     rocfft_status serialize(void** buffer, size_t* buffer_len_bytes);
@@ -87,8 +189,8 @@ struct RTCCache
     void enable_write_mostly();
 
     // write out kernels in the current cache to the output path.
-    // this copies the kernels in a consistent order and clears out
-    // the timestamp fields so that the resulting file is a
+    // this writes the kernels as an AOTCacheFile, in a consistent
+    // order and without timestamps, so that the resulting file is a
     // reproducible build artifact, suitable for use as an AOT cache.
     void write_aot_cache(const std::string&              output_path,
                          const std::array<char, 32>&     generator_sum,
@@ -97,21 +199,52 @@ struct RTCCache
     // remove kernels in the current cache to keep it roughly under a
     // target size - this counts just the kernel name and code
     // length, and ignores other overhead like indexes and other
-    // metadata about the kernels
+    // metadata about the kernels.  kernels that were used least
+    // recently and least often are removed first.
     void cleanup_cache(sqlite3_int64 target_size_bytes);
 
-    // singleton allocated in rocfft_setup and freed in rocfft_cleanup
+    // singleton, opened by get() on first use after rocfft_setup and
+    // freed in rocfft_cleanup.  standalone tools may set it directly.
     static std::unique_ptr<RTCCache> single;
 
+    // allow get() to open the singleton, called from rocfft_setup
+    static void setup();
+    // free the singleton, called from rocfft_cleanup
+    static void cleanup();
+    // get the singleton, opening the caches if this is the first
+    // use since rocfft_setup.  returns null if the library is not
+    // set up.
+    static RTCCache* get();
+
 private:
     sqlite3_ptr connect_db(const std::filesystem::path& path, bool readonly);
 
+    // note a use of a kernel in the user cache.  uses are batched
+    // up in memory and written by flush_uses, which logs errors
+    // instead of throwing.
+    void record_use(const std::string&          kernel_name,
+                    const std::string&          gpu_arch,
+                    const std::array<char, 32>& generator_sum);
+    void flush_uses();
+
+    // start trimming the user cache to its size budget in the
+    // background, if it's a file and a trim isn't already running
+    void maybe_trim();
+
+    // the system-level cache, if it was written by
+    // write_aot_cache.  otherwise the system-level cache is opened
+    // as a database.
+    std::unique_ptr<AOTCacheFile> aot_sys;
+
     // database handles to system- and user-level caches.  either or
     // both may be a null pointer, if that particular cache could not
     // be located.
     sqlite3_ptr db_sys;
     sqlite3_ptr db_user;
 
+    // path to the user cache, if it's a file
+    std::filesystem::path user_path;
+
     // query handles, with mutexes to prevent concurrent queries that
     // might stomp on one another's bound values
     sqlite3_stmt_ptr get_stmt_sys;
@@ -119,21 +252,49 @@ private:
     sqlite3_stmt_ptr get_stmt_user;
     std::mutex       get_mutex_user;
     sqlite3_stmt_ptr store_stmt_user;
+    sqlite3_stmt_ptr store_source_stmt_user;
     std::mutex       store_mutex_user;
+    sqlite3_stmt_ptr get_source_stmt_user;
+    std::mutex       get_source_mutex_user;
 
     // lock around deserialization, since that attaches a fixed-name
     // schema to the db and we don't want a collision
     std::mutex deserialize_mutex;
+
+    // uses of kernels that haven't been written to the user cache
+    // yet: count and time of last use, by kernel name, arch and
+    // generator sum
+    std::map<std::tuple<std::string, std::string, std::array<char, 32>>,
+             std::pair<sqlite3_int64, sqlite3_int64>>
+               pending_uses;
+    std::mutex pending_uses_mutex;
+
+    // size budget for the user cache, from
+    // ROCFFT_RTC_CACHE_MAX_SIZE.  0 means no budget.
+    sqlite3_int64 max_size_bytes = 0;
+    // kernels stored by this process, to check the size budget
+    // every so often
+    size_t stores_since_trim = 0;
+    // background trim of the user cache
+    std::future<void> trim_future;
+    std::mutex        trim_mutex;
 };
 
+// Checksum of a kernel's source as generated, and the signature of
+// the compiler and options it would be compiled with.  A code object
+// compiled from source with the same checksum can be reused.
+sqlite3_int64 rtc_source_sum(const std::string& generated_src, const std::string& signature);
+
 // Get compiled code object for a kernel.  Checks the cache to
 // see if the kernel has already been compiled and returns the
 // cached kernel if present.
 //
-// Otherwise, calls "generate_src" to generate the source, compiles
-// the source, and updates the cache before returning the compiled
-// kernel.  Tries in-process compile first and falls back to
-// subprocess if necessary.
+// Otherwise, calls "generate_src" to generate the source.  If the
+// same source was compiled before under a different generator sum,
+// that code object is reused.  Otherwise compiles the source, and
+// updates the cache before returning the compiled kernel.  Tries
+// in-process compile first and falls back to subprocess if
+// necessary.
 std::vector<char> cached_compile(const std::string&          kernel_name,
                                  const std::string&          gpu_arch_with_flags,
                                  kernel_src_gen_t            generate_src,
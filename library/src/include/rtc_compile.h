@@ -27,4 +27,9 @@
 // compile source to a code object, in the current process.
 std::vector<char> compile_inprocess(const std::string& kernel_src, const std::string& gpu_arch);
 
+// describe the compiler version and options that compile_inprocess
+// uses, so that code objects are only reused for identical source if
+// they were also compiled the same way.
+std::string compile_signature();
+
 #endif
@@ -102,6 +102,25 @@ private:
     std::vector<char> buf;
 };
 
+// User load/store callbacks given as device source code, to be
+// compiled into the kernels that read the plan's input and write its
+// output.
+struct RTCCallbackSource
+{
+    // device code that defines the callback functions, and any types
+    // they need
+    std::string source;
+    // names of the load and store functions in the source, empty if
+    // there is no callback of that kind
+    std::string load_function;
+    std::string store_function;
+
+    bool empty() const
+    {
+        return load_function.empty() && store_function.empty();
+    }
+};
+
 // Base class for a runtime compiled kernel.  Subclassed for
 // different kernel types that each have their own details about how
 // to be launched.
@@ -111,8 +130,15 @@ struct RTCKernel
     // node if successful.  returns nullptr if there is no matching
     // supported scheme + problem size.  throws runtime_error on
     // error.
-    static std::shared_future<std::unique_ptr<RTCKernel>> runtime_compile(
-        const TreeNode& node, const std::string& gpu_arch, bool enable_callbacks = false);
+    //
+    // if callbacks are enabled and callback_source is not empty, the
+    // kernel runs the user's callbacks from that source instead of
+    // calling function pointers.
+    static std::shared_future<std::unique_ptr<RTCKernel>>
+        runtime_compile(const TreeNode&          node,
+                        const std::string&       gpu_arch,
+                        bool                     enable_callbacks = false,
+                        const RTCCallbackSource& callback_source  = {});
 
     virtual ~RTCKernel()
     {
@@ -224,6 +250,36 @@ static const char* rtc_precision_type_decl(rocfft_precision precision)
     }
 }
 
+// kernels that store narrower numbers than they compute with get a
+// storage suffix after the precision
+static const char* rtc_storage_name(rocfft_storage_precision storage)
+{
+    switch(storage)
+    {
+    case rocfft_storage_precision_native:
+        return "";
+    case rocfft_storage_precision_half:
+        return "_sthalf";
+    case rocfft_storage_precision_bfloat16:
+        return "_stbf16";
+    }
+}
+
+// type of complex numbers in global memory, converted to and from
+// scalar_type on load and store
+static const char* rtc_storage_type_decl(rocfft_storage_precision storage)
+{
+    switch(storage)
+    {
+    case rocfft_storage_precision_native:
+        return "typedef scalar_type storage_type;\n";
+    case rocfft_storage_precision_half:
+        return "typedef storage_complex<_Float16, real_type_t<scalar_type>> storage_type;\n";
+    case rocfft_storage_precision_bfloat16:
+        return "typedef storage_complex<rocfft_bfloat16, real_type_t<scalar_type>> storage_type;\n";
+    }
+}
+
 static const std::string rtc_const_cbtype_decl(bool enable_callbacks)
 {
     if(enable_callbacks)
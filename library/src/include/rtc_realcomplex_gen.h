@@ -31,13 +31,14 @@
 
 struct RealComplexSpecs
 {
-    ComputeScheme     scheme;
-    size_t            dim;
-    rocfft_precision  precision;
-    rocfft_array_type inArrayType;
-    rocfft_array_type outArrayType;
-    bool              enable_callbacks;
-    bool              enable_scaling;
+    ComputeScheme            scheme;
+    size_t                   dim;
+    rocfft_precision         precision;
+    rocfft_storage_precision storage;
+    rocfft_array_type        inArrayType;
+    rocfft_array_type        outArrayType;
+    bool                     enable_callbacks;
+    bool                     enable_scaling;
 };
 
 struct RealComplexEvenSpecs : public RealComplexSpecs
@@ -0,0 +1,60 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef RTC_STOCKHAM_CONFIG_H
+#define RTC_STOCKHAM_CONFIG_H
+
+#include <cstddef>
+#include <optional>
+#include <set>
+#include <vector>
+
+// radices that the Stockham generator has butterflies for
+extern const std::vector<unsigned int> supported_factors;
+
+// recursively find all unique factorizations of given length.  each
+// factorization is a vector of ints, sorted so they're uniquified in
+// a set.
+std::set<std::vector<unsigned int>> factorize(unsigned int length);
+
+// How a single-kernel Stockham FFT of a length the generated pool
+// doesn't have is built at runtime.
+struct StockhamConfig
+{
+    // largest radix first
+    std::vector<unsigned int> factors;
+    unsigned int              threads_per_transform = 0;
+    unsigned int              transforms_per_block  = 0;
+    // every pass divides evenly among the threads, so the kernel can
+    // use half LDS and go directly to and from registers
+    bool half_lds = false;
+
+    unsigned int workgroup_size() const
+    {
+        return threads_per_transform * transforms_per_block;
+    }
+};
+
+// Choose factors and threads so that each thread stays within the
+// register budget and a transform fits in the LDS budget.  Returns
+// nullopt if the length can't be done in one kernel.
+std::optional<StockhamConfig> configure_stockham(size_t length);
+
+#endif
@@ -31,36 +31,40 @@
 #include "../device/kernels/common.h"
 
 // generate name for RTC stockham kernel
-std::string stockham_rtc_kernel_name(ComputeScheme           scheme,
-                                     size_t                  length1D,
-                                     size_t                  length2D,
-                                     size_t                  static_dim,
-                                     int                     direction,
-                                     rocfft_precision        precision,
-                                     rocfft_result_placement placement,
-                                     rocfft_array_type       inArrayType,
-                                     rocfft_array_type       outArrayType,
-                                     bool                    unitstride,
-                                     size_t                  largeTwdBase,
-                                     size_t                  largeTwdSteps,
-                                     bool                    largeTwdBatchIsTransformCount,
-                                     EmbeddedType            ebtype,
-                                     DirectRegType           dir2regMode,
-                                     IntrinsicAccessType     intrinsicMode,
-                                     SBRC_TRANSPOSE_TYPE     transpose_type,
-                                     bool                    enable_callbacks,
-                                     bool                    enable_scaling);
+std::string stockham_rtc_kernel_name(ComputeScheme            scheme,
+                                     size_t                   length1D,
+                                     size_t                   length2D,
+                                     size_t                   length3D,
+                                     size_t                   static_dim,
+                                     int                      direction,
+                                     rocfft_precision         precision,
+                                     rocfft_storage_precision storage,
+                                     rocfft_result_placement  placement,
+                                     rocfft_array_type        inArrayType,
+                                     rocfft_array_type        outArrayType,
+                                     bool                     unitstride,
+                                     size_t                   largeTwdBase,
+                                     size_t                   largeTwdSteps,
+                                     bool                     largeTwdBatchIsTransformCount,
+                                     EmbeddedType             ebtype,
+                                     DirectRegType            dir2regMode,
+                                     IntrinsicAccessType      intrinsicMode,
+                                     SBRC_TRANSPOSE_TYPE      transpose_type,
+                                     bool                     enable_callbacks,
+                                     bool                     enable_scaling);
 
 // generate source for RTC stockham kernel.  transforms_per_block may
 // be nullptr, but if non-null, stockham_rtc stores the number of
 // transforms each threadblock will do
 std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
                          const StockhamGeneratorSpecs& specs2d,
+                         const StockhamGeneratorSpecs& specs3d,
                          unsigned int*                 transforms_per_block,
                          const std::string&            kernel_name,
                          ComputeScheme                 scheme,
                          int                           direction,
                          rocfft_precision              precision,
+                         rocfft_storage_precision      storage,
                          rocfft_result_placement       placement,
                          rocfft_array_type             inArrayType,
                          rocfft_array_type             outArrayType,
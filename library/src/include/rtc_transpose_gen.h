@@ -28,18 +28,25 @@
 
 struct TransposeSpecs
 {
-    unsigned int      tileX;
-    unsigned int      tileY;
-    size_t            dim;
-    rocfft_precision  precision;
-    rocfft_array_type inArrayType;
-    rocfft_array_type outArrayType;
-    size_t            largeTwdSteps;
-    int               largeTwdDirection;
-    bool              diagonal;
-    bool              tileAligned;
-    bool              enable_callbacks;
-    bool              enable_scaling;
+    // tiles are tileX columns (along length0) by tileY rows, moved
+    // by a 1D block of threads
+    unsigned int             tileX;
+    unsigned int             tileY;
+    unsigned int             threads;
+    // number of consecutive elements per global load/store
+    unsigned int             vecIn;
+    unsigned int             vecOut;
+    size_t                   dim;
+    rocfft_precision         precision;
+    rocfft_storage_precision storage;
+    rocfft_array_type        inArrayType;
+    rocfft_array_type        outArrayType;
+    size_t                   largeTwdSteps;
+    int                      largeTwdDirection;
+    bool                     diagonal;
+    bool                     tileAligned;
+    bool                     enable_callbacks;
+    bool                     enable_scaling;
 };
 
 // generate name for RTC transpose kernel
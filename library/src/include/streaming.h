@@ -0,0 +1,225 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ROCFFT_STREAMING_H
+#define ROCFFT_STREAMING_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Streaming execution moves host-resident data through the device a
+// chunk at a time.  Each chunk copies a 2D region of a host buffer
+// into a device slot, transforms it there, and copies a 2D region
+// back to a host buffer.
+//
+// Chunks rotate through a small number of slots, and each slot has
+// its own queue.  Work on one queue runs in order, so a slot is only
+// reused once its previous chunk has been copied back, while copies
+// and transforms of neighbouring chunks overlap on other queues.
+//
+// A transform may need more than one pass over the data (e.g. rows,
+// then columns of a 2D transform, or the two sub-transforms of a
+// long 1D transform).  Each pass reads what earlier
+// passes wrote, so passes are separated by barriers.
+
+// host buffers that a pass reads from or writes to
+enum class StreamingBuffer
+{
+    IN,
+    OUT,
+};
+
+// A 2D region of a host buffer: rows of width bytes, pitch bytes
+// apart, starting offset bytes into the buffer
+struct StreamingRegion
+{
+    size_t offset = 0;
+    size_t width  = 0;
+    size_t rows   = 0;
+    size_t pitch  = 0;
+};
+
+struct StreamingChunk
+{
+    StreamingRegion in;
+    StreamingRegion out;
+    // bytes between rows in the device slot
+    size_t dev_in_pitch  = 0;
+    size_t dev_out_pitch = 0;
+    // number of items (transforms, rows or columns) in the chunk
+    size_t items = 0;
+    // index of the chunk's first item among the items of its pass
+    size_t first = 0;
+    // true if the chunk is smaller than the pass's chunk size and
+    // needs the pass's remainder transform
+    bool remainder = false;
+};
+
+struct StreamingPass
+{
+    StreamingBuffer src = StreamingBuffer::IN;
+    StreamingBuffer dst = StreamingBuffer::OUT;
+    // whether the device transform overwrites its input in the slot
+    bool                        inplace     = true;
+    size_t                      chunk_items = 0;
+    std::vector<StreamingChunk> chunks;
+};
+
+// Copies and transforms for streaming execution.  Each slot has its
+// own queue, and work submitted to one queue runs in order.
+struct StreamingEngine
+{
+    virtual ~StreamingEngine() = default;
+
+    virtual void copy_to_device(size_t slot, const StreamingPass& pass, const StreamingChunk& chunk)
+        = 0;
+    virtual void transform(size_t slot, size_t pass_idx, const StreamingChunk& chunk) = 0;
+    virtual void copy_to_host(size_t slot, const StreamingPass& pass, const StreamingChunk& chunk)
+        = 0;
+    // make every queue wait for all work already submitted to any queue
+    virtual void barrier() = 0;
+};
+
+// Describes one side (input or output) of items that are rows of a
+// host buffer
+struct StreamingRows
+{
+    // byte offset of the first row in the host buffer
+    size_t base = 0;
+    // bytes per row to copy
+    size_t width = 0;
+    // bytes between rows in the host buffer
+    size_t pitch = 0;
+    // bytes between rows in the device slot
+    size_t dev_pitch = 0;
+};
+
+// Append chunks of up to pass.chunk_items rows, for count rows laid
+// out as described by in and out.
+static inline void streaming_split_rows(StreamingPass&       pass,
+                                        size_t               count,
+                                        const StreamingRows& in,
+                                        const StreamingRows& out)
+{
+    for(size_t start = 0; start < count; start += pass.chunk_items)
+    {
+        StreamingChunk chunk;
+        chunk.items     = std::min(pass.chunk_items, count - start);
+        chunk.remainder = chunk.items < pass.chunk_items;
+        chunk.first     = start;
+
+        chunk.in.offset     = in.base + start * in.pitch;
+        chunk.in.width      = in.width;
+        chunk.in.rows       = chunk.items;
+        chunk.in.pitch      = in.pitch;
+        chunk.dev_in_pitch  = in.dev_pitch;
+        chunk.out.offset    = out.base + start * out.pitch;
+        chunk.out.width     = out.width;
+        chunk.out.rows      = chunk.items;
+        chunk.out.pitch     = out.pitch;
+        chunk.dev_out_pitch = out.dev_pitch;
+        pass.chunks.push_back(chunk);
+    }
+}
+
+// Append chunks of up to pass.chunk_items columns, for count
+// columns of elem_bytes elements, each rows long.  Rows are pitch
+// bytes apart in the host buffer, starting at base.  Columns of a
+// chunk are packed next to each other in the device slot, and are
+// read and written in place.
+static inline void streaming_split_columns(
+    StreamingPass& pass, size_t count, size_t rows, size_t elem_bytes, size_t base, size_t pitch)
+{
+    for(size_t start = 0; start < count; start += pass.chunk_items)
+    {
+        StreamingChunk chunk;
+        chunk.items     = std::min(pass.chunk_items, count - start);
+        chunk.remainder = chunk.items < pass.chunk_items;
+        chunk.first     = start;
+
+        chunk.in.offset     = base + start * elem_bytes;
+        chunk.in.width      = chunk.items * elem_bytes;
+        chunk.in.rows       = rows;
+        chunk.in.pitch      = pitch;
+        chunk.dev_in_pitch  = chunk.in.width;
+        chunk.out           = chunk.in;
+        chunk.dev_out_pitch = chunk.dev_in_pitch;
+        pass.chunks.push_back(chunk);
+    }
+}
+
+// Append chunks of up to pass.chunk_items columns, read from the
+// host like streaming_split_columns.  Each chunk is written back
+// out of place with its columns as rows, so that column i becomes
+// the contiguous run of rows elements at out_base + i * rows *
+// elem_bytes.
+static inline void streaming_split_columns_to_rows(StreamingPass& pass,
+                                                   size_t         count,
+                                                   size_t         rows,
+                                                   size_t         elem_bytes,
+                                                   size_t         in_base,
+                                                   size_t         in_pitch,
+                                                   size_t         out_base)
+{
+    for(size_t start = 0; start < count; start += pass.chunk_items)
+    {
+        StreamingChunk chunk;
+        chunk.items     = std::min(pass.chunk_items, count - start);
+        chunk.remainder = chunk.items < pass.chunk_items;
+        chunk.first     = start;
+
+        chunk.in.offset     = in_base + start * elem_bytes;
+        chunk.in.width      = chunk.items * elem_bytes;
+        chunk.in.rows       = rows;
+        chunk.in.pitch      = in_pitch;
+        chunk.dev_in_pitch  = chunk.in.width;
+        chunk.out.offset    = out_base + start * rows * elem_bytes;
+        chunk.out.width     = chunk.items * rows * elem_bytes;
+        chunk.out.rows      = 1;
+        chunk.out.pitch     = chunk.out.width;
+        chunk.dev_out_pitch = chunk.out.width;
+        pass.chunks.push_back(chunk);
+    }
+}
+
+// Submit every chunk of every pass to the engine, using num_slots
+// slots.  The engine's queues are ordered with the caller's work
+// before the first chunk and after the last one.
+static inline void streaming_execute(const std::vector<StreamingPass>& passes,
+                                     size_t                            num_slots,
+                                     StreamingEngine&                  engine)
+{
+    engine.barrier();
+    for(size_t p = 0; p < passes.size(); ++p)
+    {
+        const auto& pass = passes[p];
+        for(size_t i = 0; i < pass.chunks.size(); ++i)
+        {
+            const size_t slot = i % num_slots;
+            engine.copy_to_device(slot, pass, pass.chunks[i]);
+            engine.transform(slot, p, pass.chunks[i]);
+            engine.copy_to_host(slot, pass, pass.chunks[i]);
+        }
+        engine.barrier();
+    }
+}
+
+#endif // ROCFFT_STREAMING_H
@@ -36,9 +36,26 @@ struct rocfft_execution_info_t
     UserCallbacks callbacks;
 };
 
-void TransformPowX(const ExecPlan&       execPlan,
-                   void*                 in_buffer[],
-                   void*                 out_buffer[],
-                   rocfft_execution_info info);
+class KernelTimingExecution;
+
+// Launch the kernels of a plan.  If timing is given, an event is
+// recorded around each kernel so the kernels can be timed.
+void TransformPowX(const ExecPlan&        execPlan,
+                   void*                  in_buffer[],
+                   void*                  out_buffer[],
+                   rocfft_execution_info  info,
+                   KernelTimingExecution* timing = nullptr);
+
+// Work out the buffers that a node of the plan reads from and writes
+// to, given the user's buffers and the work buffer.  bufTemp is set
+// for nodes that need scratch space besides input and output.
+void AssignNodeBuffers(const ExecPlan& execPlan,
+                       const TreeNode& node,
+                       void*           in_buffer[],
+                       void*           out_buffer[],
+                       void*           workBuffer,
+                       void*           bufIn[2],
+                       void*           bufOut[2],
+                       void*&          bufTemp);
 
 #endif // TRANSFORM_H
@@ -36,6 +36,7 @@
 #include "compute_scheme.h"
 #include "kargs.h"
 #include "rtc_kernel.h"
+#include "twiddles.h"
 #include <hip/hip_runtime_api.h>
 
 enum OperatingBuffer
@@ -123,20 +124,21 @@ class TreeNode;
 // The mininal tree node data needed to decide the scheme
 struct NodeMetaData
 {
-    size_t                  batch     = 1;
-    size_t                  dimension = 1;
-    std::vector<size_t>     length;
-    std::vector<size_t>     outputLength;
-    std::vector<size_t>     inStride, outStride;
-    size_t                  iDist = 0, oDist = 0;
-    size_t                  iOffset = 0, oOffset = 0;
-    int                     direction    = -1;
-    rocfft_result_placement placement    = rocfft_placement_inplace;
-    rocfft_precision        precision    = rocfft_precision_single;
-    rocfft_array_type       inArrayType  = rocfft_array_type_unset;
-    rocfft_array_type       outArrayType = rocfft_array_type_unset;
-    hipDeviceProp_t         deviceProp   = {};
-    bool                    rootIsC2C;
+    size_t                   batch     = 1;
+    size_t                   dimension = 1;
+    std::vector<size_t>      length;
+    std::vector<size_t>      outputLength;
+    std::vector<size_t>      inStride, outStride;
+    size_t                   iDist = 0, oDist = 0;
+    size_t                   iOffset = 0, oOffset = 0;
+    int                      direction    = -1;
+    rocfft_result_placement  placement    = rocfft_placement_inplace;
+    rocfft_precision         precision    = rocfft_precision_single;
+    rocfft_storage_precision storage      = rocfft_storage_precision_native;
+    rocfft_array_type        inArrayType  = rocfft_array_type_unset;
+    rocfft_array_type        outArrayType = rocfft_array_type_unset;
+    hipDeviceProp_t          deviceProp   = {};
+    bool                     rootIsC2C;
 
     explicit NodeMetaData(TreeNode* refNode);
 };
@@ -214,6 +216,7 @@ protected:
         if(p != nullptr)
         {
             precision  = p->precision;
+            storage    = p->storage;
             batch      = p->batch;
             direction  = p->direction;
             deviceProp = p->deviceProp;
@@ -271,6 +274,9 @@ public:
     rocfft_precision        precision    = rocfft_precision_single;
     rocfft_array_type       inArrayType  = rocfft_array_type_unset;
     rocfft_array_type       outArrayType = rocfft_array_type_unset;
+    // type of the numbers in input, output and work buffers;
+    // computation is always done in precision
+    rocfft_storage_precision storage = rocfft_storage_precision_native;
 
     // Extra twiddle multiplication for large 1D
     size_t large1D = 0;
@@ -467,6 +473,10 @@ public:
     virtual bool CreateTwiddleTableResource()                              = 0;
     virtual void SetupGridParamAndFuncPtr(DevFnCall& fnPtr, GridParam& gp) = 0;
 
+    // twiddle tables that this node's kernel needs, so that a plan
+    // can generate all of its tables at once
+    virtual std::vector<TwiddleTableSpec> GetTwiddleTableSpecs() = 0;
+
     // for 3D SBRC kernels, decide the transpose type based on the
     // block width and lengths that the block tiles need to align on.
     // default type is NONE, meaning this isn't a SBRC node
@@ -505,6 +515,12 @@ protected:
         return false;
     }
 
+    std::vector<TwiddleTableSpec> GetTwiddleTableSpecs() override
+    {
+        throw std::runtime_error("Shouldn't call GetTwiddleTableSpecs in a non-LeafNode");
+        return {};
+    }
+
     bool CreateTwiddleTableResource() override
     {
         throw std::runtime_error("Shouldn't call CreateTwiddleTableResource in a non-LeafNode");
@@ -547,7 +563,7 @@ public:
 
     void           BuildTree_internal() final {} // nothing to do in leaf node
     void           AssignParams_internal() final {} // nothing to do in leaf node
-    bool           CreateLargeTwdTable();
+    void           GetLargeTwdTableSpec(std::vector<TwiddleTableSpec>& specs);
     virtual size_t GetTwiddleTableLength();
     // Limit length of generated twiddle table.  Default limit is 0,
     // which means to generate the full length of table.
@@ -563,6 +579,8 @@ public:
     bool         CreateTwiddleTableResource() override;
     void         SetupGridParamAndFuncPtr(DevFnCall& fnPtr, GridParam& gp) override;
     virtual void GetKernelFactors();
+
+    std::vector<TwiddleTableSpec> GetTwiddleTableSpecs() override;
 };
 
 /*****************************************************
@@ -570,6 +588,20 @@ public:
  * CS_KERNEL_TRANSPOSE_XY_Z
  * CS_KERNEL_TRANSPOSE_Z_XY
  *****************************************************/
+// Tile shape, vector width and block ordering for a transpose
+// kernel.  Tiles are tileX columns (along length[0]) by tileY rows
+// (along length[1], and length[2] if present).
+struct TransposeTiling
+{
+    unsigned int tileX    = 0;
+    unsigned int tileY    = 0;
+    unsigned int threads  = 0;
+    // number of elements moved by each global load/store
+    unsigned int vecIn    = 1;
+    unsigned int vecOut   = 1;
+    bool         diagonal = false;
+};
+
 class TransposeNode : public LeafNode
 {
     friend class NodeFactory;
@@ -597,8 +629,14 @@ public:
         // the current choice of which nodes we fuse.
         return large1D == 0;
     }
+
+    // choose the tiling for this transpose from its shape, strides
+    // and element size
+    TransposeTiling SelectTiling(bool enable_callbacks) const;
 };
 
+struct HostKernel;
+
 struct ExecPlan
 {
     // shared pointer allows for ExecPlans to be copyable
@@ -614,8 +652,17 @@ struct ExecPlan
     std::vector<DevFnCall> devFnCall;
     std::vector<GridParam> gridParam;
 
+    // true if the plan's kernels run on the host, in which case
+    // hostKernels has one kernel per node of execSeq instead of
+    // devFnCall and gridParam
+    bool                                     hostExec = false;
+    std::vector<std::shared_ptr<HostKernel>> hostKernels;
+
     hipDeviceProp_t deviceProp;
 
+    // user callbacks to compile into the kernels that load and store
+    RTCCallbackSource callbackSource;
+
     std::vector<size_t> iLength;
     std::vector<size_t> oLength;
 
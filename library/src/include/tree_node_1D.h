@@ -92,9 +92,9 @@ protected:
     void SetupGPAndFnPtr_internal(DevFnCall& fnPtr, GridParam& gp) override;
 
 public:
-    bool                CreateTwiddleTableResource() override;
-    std::vector<size_t> CollapsibleDims() override;
-    bool                UseOutputLengthForPadding() override
+    std::vector<TwiddleTableSpec> GetTwiddleTableSpecs() override;
+    std::vector<size_t>           CollapsibleDims() override;
+    bool                          UseOutputLengthForPadding() override
     {
         // with embedded r2c, stockham nodes will change length, so the
         // output length is different from the input length.
@@ -202,7 +202,7 @@ public:
     // we can put codes here to switch-on/off some features at arch-wise
     bool KernelCheck() override;
 
-    bool CreateTwiddleTableResource() override;
+    std::vector<TwiddleTableSpec> GetTwiddleTableSpecs() override;
 
     // reads are along columns so they may benefit from padding
     bool PaddingBenefitsInput() override
@@ -73,10 +73,18 @@ protected:
         need_twd_table = true;
     }
 
+    // lengths of the dimensions transformed by the kernel
+    virtual std::vector<size_t> FusedLengths() const
+    {
+        return {length[0], length[1]};
+    }
+
     void SetupGPAndFnPtr_internal(DevFnCall& fnPtr, GridParam& gp) override;
+    void GetKernelFactors() override;
 
 public:
-    bool CreateTwiddleTableResource() override;
+    bool                          KernelCheck() override;
+    std::vector<TwiddleTableSpec> GetTwiddleTableSpecs() override;
 };
 
 #endif // TREE_NODE_2D_H
@@ -262,4 +262,25 @@ public:
     }
 };
 
+/*****************************************************
+ * CS_KERNEL_3D_SINGLE  *
+ * Like 2D_SINGLE, but the whole 3D transform is done
+ * in LDS by one kernel.
+ *****************************************************/
+class Single3DNode : public Single2DNode
+{
+    friend class NodeFactory;
+
+protected:
+    Single3DNode(TreeNode* p, ComputeScheme s)
+        : Single2DNode(p, s)
+    {
+    }
+
+    std::vector<size_t> FusedLengths() const override
+    {
+        return {length[0], length[1], length[2]};
+    }
+};
+
 #endif // TREE_NODE_3D_H
@@ -23,22 +23,50 @@
 
 #include "../../../shared/gpubuf.h"
 #include "rocfft.h"
+#include <tuple>
 #include <vector>
 
 static const size_t       LTWD_BASE_DEFAULT       = 8;
 static const size_t       LARGE_TWIDDLE_THRESHOLD = 4096;
 static const unsigned int TWIDDLES_MAX_RADICES    = 8;
 
-gpubuf twiddles_create(size_t                     N,
-                       size_t                     length_limit,
-                       rocfft_precision           precision,
-                       const char*                gpu_arch,
-                       size_t                     largeTwdBase,
-                       bool                       attach_halfN,
-                       const std::vector<size_t>& radices,
-                       unsigned int               deviceId);
-gpubuf twiddles_create_2D(
-    size_t N1, size_t N2, rocfft_precision precision, const char* gpu_arch, unsigned int deviceId);
+// Description of a twiddle table that a kernel needs.  The Repo
+// also uses this to identify tables, so that plans can share them.
+struct TwiddleTableSpec
+{
+    // length of the transform that the table is for.  kernels that
+    // transform several dimensions at once have one length per
+    // dimension, and get one table per dimension.
+    std::vector<size_t> lengths;
+    // limit number of generated table elements (0 for no limit)
+    size_t           length_limit = 0;
+    rocfft_precision precision    = rocfft_precision_single;
+    // large twiddle base (0 for non-large twiddle)
+    size_t              large_twiddle_base = 0;
+    bool                attach_halfN       = false;
+    std::vector<size_t> radices;
+
+    bool operator<(const TwiddleTableSpec& other) const
+    {
+        return std::tie(
+                   lengths, length_limit, precision, large_twiddle_base, attach_halfN, radices)
+               < std::tie(other.lengths,
+                          other.length_limit,
+                          other.precision,
+                          other.large_twiddle_base,
+                          other.attach_halfN,
+                          other.radices);
+    }
+};
+
+// Generate several twiddle tables into one device allocation.  The
+// tables' kernels are all launched before waiting for any of them.
+// tables receives the offset and size in bytes of each table in
+// the allocation (size 0 for tables that turned out to be empty).
+gpubuf twiddles_create_batch(const std::vector<TwiddleTableSpec>&    specs,
+                             const char*                             gpu_arch,
+                             unsigned int                            deviceId,
+                             std::vector<std::pair<size_t, size_t>>& tables);
 
 void twiddle_streams_cleanup();
 
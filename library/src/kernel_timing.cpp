@@ -0,0 +1,268 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cassert>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+
+#include "../../shared/environment.h"
+#include "../../shared/precision_type.h"
+#include "kernel_timing.h"
+#include "logging.h"
+#include "tree_node.h"
+
+static size_t data_size_bytes(const std::vector<size_t>& lengths,
+                              rocfft_precision           precision,
+                              rocfft_storage_precision   storage,
+                              rocfft_array_type          type)
+{
+    // first compute the raw number of elements
+    const size_t elems = std::accumulate(
+        lengths.begin(), lengths.end(), static_cast<size_t>(1), std::multiplies<size_t>());
+    // size of each element, as stored in memory
+    const size_t elemsize = real_type_size(precision, storage);
+    switch(type)
+    {
+    case rocfft_array_type_complex_interleaved:
+    case rocfft_array_type_complex_planar:
+        // complex needs two numbers per element
+        return 2 * elems * elemsize;
+    case rocfft_array_type_real:
+        // real needs one number per element
+        return elems * elemsize;
+    case rocfft_array_type_hermitian_interleaved:
+    case rocfft_array_type_hermitian_planar:
+    {
+        // hermitian requires 2 numbers per element, but innermost
+        // dimension is cut down to roughly half
+        size_t non_innermost = elems / lengths[0];
+        return 2 * non_innermost * elemsize * ((lengths[0] / 2) + 1);
+    }
+    case rocfft_array_type_unset:
+        // we should really have an array type at this point
+        assert(false);
+        return 0;
+    }
+}
+
+size_t kernel_data_size_bytes(const TreeNode& node)
+{
+    size_t in_size_bytes
+        = data_size_bytes(node.length, node.precision, node.storage, node.inArrayType);
+    size_t out_size_bytes
+        = data_size_bytes(node.length, node.precision, node.storage, node.outArrayType);
+    return (in_size_bytes + out_size_bytes) * node.batch;
+}
+
+float execution_bandwidth_GB_per_s(size_t data_size_bytes, float duration_ms)
+{
+    // divide bytes by (1000000 * milliseconds) to get GB/s
+    return static_cast<float>(data_size_bytes) / (1000000.0 * duration_ms);
+}
+
+float max_memory_bandwidth_GB_per_s()
+{
+    // Try to get the device bandwidth from an environment variable:
+    auto pdevbw = rocfft_getenv("ROCFFT_DEVICE_BW");
+    if(!pdevbw.empty())
+    {
+        return atof(pdevbw.c_str());
+    }
+
+    // Try to get the device bandwidth from hip calls:
+    int deviceid = 0;
+    if(hipGetDevice(&deviceid) != hipSuccess)
+        // default to first device
+        deviceid = 0;
+    int max_memory_clock_kHz = 0;
+    int memory_bus_width     = 0;
+    if(hipDeviceGetAttribute(&max_memory_clock_kHz, hipDeviceAttributeMemoryClockRate, deviceid)
+       != hipSuccess)
+        max_memory_clock_kHz = 0;
+    if(hipDeviceGetAttribute(&memory_bus_width, hipDeviceAttributeMemoryBusWidth, deviceid)
+       != hipSuccess)
+        memory_bus_width = 0;
+    auto max_memory_clock_MHz = static_cast<float>(max_memory_clock_kHz) / 1000.0;
+    // multiply by 2.0 because transfer is bidirectional
+    // divide by 8.0 because bus width is in bits and we want bytes
+    // divide by 1000 to convert MB to GB
+    float result = (max_memory_clock_MHz * 2.0 * memory_bus_width / 8.0) / 1000.0;
+    return result;
+}
+
+KernelTimingExecution::~KernelTimingExecution()
+{
+    // only an execution that was abandoned part way through still
+    // owns its events
+    for(auto e : events)
+        (void)hipEventDestroy(e);
+}
+
+void KernelTimingExecution::start(hipStream_t stream)
+{
+    events.push_back(timer.acquire_event());
+    if(hipEventRecord(events.back(), stream) != hipSuccess)
+        throw std::runtime_error("hipEventRecord failure");
+}
+
+void KernelTimingExecution::stop(const TreeNode& node, hipStream_t stream)
+{
+    // start() must have been called for this ExecPlan
+    assert(!events.empty());
+
+    events.push_back(timer.acquire_event());
+    if(hipEventRecord(events.back(), stream) != hipSuccess)
+        throw std::runtime_error("hipEventRecord failure");
+    nodes.push_back(&node);
+    bounds.emplace_back(events.size() - 2, events.size() - 1);
+}
+
+KernelTimer::~KernelTimer()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    collect(true);
+    for(auto e : free_events)
+        (void)hipEventDestroy(e);
+}
+
+std::unique_ptr<KernelTimingExecution> KernelTimer::begin_execution()
+{
+    {
+        // make events of finished executions available for reuse
+        std::lock_guard<std::mutex> lock(mutex);
+        collect(false);
+    }
+    return std::make_unique<KernelTimingExecution>(*this);
+}
+
+void KernelTimer::end_execution(std::unique_ptr<KernelTimingExecution> execution)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(std::move(execution));
+    collect(false);
+
+    // bound the number of events in flight
+    while(pending.size() > MAX_PENDING)
+        collect_front(true);
+}
+
+std::vector<KernelTiming> KernelTimer::latest()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    collect(true);
+    return latest_kernels;
+}
+
+hipEvent_t KernelTimer::acquire_event()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if(!free_events.empty())
+    {
+        auto e = free_events.back();
+        free_events.pop_back();
+        return e;
+    }
+    hipEvent_t e;
+    if(hipEventCreate(&e) != hipSuccess)
+        throw std::runtime_error("hipEventCreate failure");
+    return e;
+}
+
+void KernelTimer::collect(bool wait)
+{
+    while(!pending.empty() && collect_front(wait))
+        ;
+}
+
+bool KernelTimer::collect_front(bool wait)
+{
+    auto& execution = *pending.front();
+    if(!execution.events.empty())
+    {
+        auto last = execution.events.back();
+        // if waiting fails, the elapsed times can't be queried
+        // either, and finish() reports zero for them
+        if(wait)
+            (void)hipEventSynchronize(last);
+        else if(hipEventQuery(last) == hipErrorNotReady)
+            return false;
+    }
+    finish(execution);
+    pending.pop_front();
+    return true;
+}
+
+void KernelTimer::finish(KernelTimingExecution& execution)
+{
+    const bool emit_profile_log = LOG_PROFILE_ENABLED();
+    if(emit_profile_log && max_memory_bw < 0.0f)
+        max_memory_bw = max_memory_bandwidth_GB_per_s();
+
+    std::vector<KernelTiming> kernels(execution.nodes.size());
+    for(size_t i = 0; i < kernels.size(); ++i)
+    {
+        auto& kernel = kernels[i];
+        auto& node   = *execution.nodes[i];
+
+        kernel.scheme = PrintScheme(node.scheme);
+        kernel.length = node.length;
+        kernel.bytes  = kernel_data_size_bytes(node);
+
+        auto start = execution.events[execution.bounds[i].first];
+        auto stop  = execution.events[execution.bounds[i].second];
+        if(hipEventElapsedTime(&kernel.duration_ms, start, stop) != hipSuccess)
+            kernel.duration_ms = 0.0f;
+        if(kernel.duration_ms > 0.0f)
+            kernel.bandwidth_GB_per_s
+                = execution_bandwidth_GB_per_s(kernel.bytes, kernel.duration_ms);
+
+        if(emit_profile_log)
+        {
+            auto efficiency_pct = 0.0;
+            if(max_memory_bw != 0.0)
+                efficiency_pct = 100.0 * kernel.bandwidth_GB_per_s / max_memory_bw;
+            // kernels were launched by TransformPowX, which is what
+            // profile logs have always named them after
+            log_profile("TransformPowX",
+                        "scheme",
+                        kernel.scheme,
+                        "duration_ms",
+                        kernel.duration_ms,
+                        "in_size",
+                        std::make_pair(static_cast<const size_t*>(kernel.length.data()),
+                                       kernel.length.size()),
+                        "total_size_bytes",
+                        kernel.bytes,
+                        "exec_GB_s",
+                        kernel.bandwidth_GB_per_s,
+                        "max_mem_GB_s",
+                        max_memory_bw,
+                        "bw_efficiency_pct",
+                        efficiency_pct,
+                        "kernel_index",
+                        i);
+        }
+    }
+
+    free_events.insert(free_events.end(), execution.events.begin(), execution.events.end());
+    execution.events.clear();
+    latest_kernels = std::move(kernels);
+}
@@ -436,6 +436,8 @@ std::unique_ptr<TreeNode> NodeFactory::CreateNodeFromScheme(ComputeScheme s, Tre
         return std::unique_ptr<SBCRNode>(new SBCRNode(parent, s));
     case CS_KERNEL_2D_SINGLE:
         return std::unique_ptr<Single2DNode>(new Single2DNode(parent, s));
+    case CS_KERNEL_3D_SINGLE:
+        return std::unique_ptr<Single3DNode>(new Single3DNode(parent, s));
     case CS_KERNEL_STOCKHAM_TRANSPOSE_XY_Z:
         return std::unique_ptr<SBRCTransXY_ZNode>(new SBRCTransXY_ZNode(parent, s));
     case CS_KERNEL_STOCKHAM_TRANSPOSE_Z_XY:
@@ -740,12 +742,14 @@ static bool Apply_SBCR(NodeMetaData& nodeData)
 
 ComputeScheme NodeFactory::Decide3DScheme(NodeMetaData& nodeData)
 {
-    // this flag can be enabled when generator can do block column fft in
-    // multi-dimension cases and small 2d, 3d within one kernel
-    bool MultiDimFuseKernelsAvailable = false;
-
-    // try 3 SBCR kernels first
-    if(Apply_SBCR(nodeData))
+    // large batches of small bricks are best done in one kernel,
+    // without going through global memory between dimensions
+    if(use_CS_3D_SINGLE(nodeData))
+    {
+        return CS_KERNEL_3D_SINGLE;
+    }
+    // next, try 3 SBCR kernels
+    else if(Apply_SBCR(nodeData))
     {
         return CS_3D_BLOCK_CR;
     }
@@ -753,16 +757,6 @@ ComputeScheme NodeFactory::Decide3DScheme(NodeMetaData& nodeData)
     {
         return CS_3D_RC;
     }
-    else if(MultiDimFuseKernelsAvailable)
-    {
-        // conditions to choose which scheme
-        if((nodeData.length[0] * nodeData.length[1] * nodeData.length[2]) <= 2048)
-            return CS_KERNEL_3D_SINGLE;
-        else if(nodeData.length[2] <= 256)
-            return CS_3D_RC;
-        else
-            return CS_3D_RTRT;
-    }
     else
     {
         // if we can get down to 3 or 4 kernels via SBRC, prefer that
@@ -799,17 +793,48 @@ ComputeScheme NodeFactory::Decide3DScheme(NodeMetaData& nodeData)
 
         return CS_3D_RTRT;
     }
-    // TODO: CS_KERNEL_3D_SINGLE?
 }
 
-bool NodeFactory::use_CS_2D_SINGLE(NodeMetaData& nodeData)
+// Fused kernels that do a whole multi-dimensional transform in one
+// threadblock need enough threads for every row along the busiest
+// dimension, so they can't be larger than this.
+static const int MAX_SINGLE_KERNEL_THREADS = 1024;
+
+// A fused kernel put together at runtime does one brick per
+// threadblock, so it's only worth using when there are enough bricks
+// to keep the device busy.
+static bool is_large_batch(const NodeMetaData& nodeData)
 {
-    if(!function_pool::has_function(
-           fpkey(nodeData.length[0], nodeData.length[1], nodeData.precision, CS_KERNEL_2D_SINGLE)))
+    // assume a contemporary device if the properties are not known
+    size_t cus = nodeData.deviceProp.multiProcessorCount > 0
+                     ? static_cast<size_t>(nodeData.deviceProp.multiProcessorCount)
+                     : 64;
+    return nodeData.batch >= cus;
+}
+
+// check if a kernel that transforms the first dims dimensions of the
+// problem in one threadblock is available, and will fit the problem
+// into LDS
+static bool use_single_kernel(NodeMetaData& nodeData, size_t dims)
+{
+    if(nodeData.length.size() < dims)
+        return false;
+    std::vector<size_t> lengths(nodeData.length.begin(), nodeData.length.begin() + dims);
+
+#ifndef ROCFFT_RUNTIME_COMPILE
+    // without runtime compilation, only the kernels in the pool can
+    // be used
+    if(dims != 2
+       || !function_pool::has_function(fpkey(lengths[0], lengths[1], nodeData.precision)))
+        return false;
+#endif
+
+    auto kernel = function_pool::get_fused_kernel(lengths, nodeData.precision);
+    if(!kernel || kernel->workgroup_size > MAX_SINGLE_KERNEL_THREADS)
         return false;
 
-    // Get actual LDS size, to check if we can run a 2D_SINGLE
-    // kernel that will fit the problem into LDS.
+    // Get actual LDS size, to check if we can run a single kernel
+    // that will fit the problem into LDS.
     //
     // NOTE: This is potentially problematic in a heterogeneous
     // multi-device environment.  The device we query now could
@@ -835,10 +860,7 @@ bool NodeFactory::use_CS_2D_SINGLE(NodeMetaData& nodeData)
         ldsSize = 0;
     }
 
-    auto kernel = function_pool::get_kernel(
-        fpkey(nodeData.length[0], nodeData.length[1], nodeData.precision, CS_KERNEL_2D_SINGLE));
-
-    int ldsUsage = nodeData.length[0] * nodeData.length[1] * kernel.transforms_per_block
+    int ldsUsage = product(lengths.begin(), lengths.end()) * kernel->transforms_per_block
                    * complex_type_size(nodeData.precision);
     if(1.5 * ldsUsage > ldsSize)
         return false;
@@ -846,6 +868,22 @@ bool NodeFactory::use_CS_2D_SINGLE(NodeMetaData& nodeData)
     return true;
 }
 
+bool NodeFactory::use_CS_2D_SINGLE(NodeMetaData& nodeData)
+{
+    // kernels from the pool are tuned for their problem size, but
+    // ones put together at runtime only pay off for large batches
+    if(!function_pool::has_function(
+           fpkey(nodeData.length[0], nodeData.length[1], nodeData.precision, CS_KERNEL_2D_SINGLE))
+       && !is_large_batch(nodeData))
+        return false;
+    return use_single_kernel(nodeData, 2);
+}
+
+bool NodeFactory::use_CS_3D_SINGLE(NodeMetaData& nodeData)
+{
+    return is_large_batch(nodeData) && use_single_kernel(nodeData, 3);
+}
+
 bool NodeFactory::use_CS_2D_RC(NodeMetaData& nodeData)
 {
     // Do not allow SBCC for (192,y) problems, not the
@@ -21,12 +21,15 @@
 #include "plan.h"
 #include "../../shared/arithmetic.h"
 #include "../../shared/array_predicate.h"
+#include "../../shared/array_validator.h"
 #include "../../shared/environment.h"
 #include "../../shared/precision_type.h"
 #include "../../shared/ptrdiff.h"
 #include "assignment_policy.h"
+#include "event_trace.h"
 #include "function_pool.h"
 #include "hip/hip_runtime_api.h"
+#include "host_exec.h"
 #include "logging.h"
 #include "node_factory.h"
 #include "rocfft-version.h"
@@ -36,10 +39,12 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <atomic>
 #include <functional>
 #include <iterator>
 #include <map>
 #include <numeric>
+#include <optional>
 #include <set>
 #include <sstream>
 #include <vector>
@@ -111,6 +116,72 @@ rocfft_status rocfft_plan_description_set_scale_factor(rocfft_plan_description d
     return rocfft_status_success;
 }
 
+rocfft_status rocfft_plan_description_set_max_work_buffer_size(rocfft_plan_description description,
+                                                               const size_t max_bytes)
+{
+    log_trace(__func__, "description", description, "max_bytes", max_bytes);
+    description->maxWorkBufBytes = max_bytes;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_streaming(rocfft_plan_description description,
+                                                    const size_t            max_device_bytes)
+{
+    log_trace(__func__, "description", description, "max_device_bytes", max_device_bytes);
+    description->streamingDeviceBytes = max_device_bytes;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_storage_precision(
+    rocfft_plan_description description, const rocfft_storage_precision storage)
+{
+    log_trace(__func__, "description", description, "storage", storage);
+    description->storagePrecision = storage;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_execution_target(rocfft_plan_description description,
+                                                           const rocfft_execution_target target)
+{
+    log_trace(__func__, "description", description, "target", target);
+    description->executionTarget = target;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_kernel_timing(rocfft_plan_description description,
+                                                       const int               enable)
+{
+    log_trace(__func__, "description", description, "enable", enable);
+    description->kernelTiming = enable != 0;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_callback_source(rocfft_plan_description description,
+                                                          const char*             source,
+                                                          const char*             load_function,
+                                                          const char*             store_function)
+{
+    log_trace(__func__,
+              "description",
+              description,
+              "load_function",
+              load_function ? load_function : "",
+              "store_function",
+              store_function ? store_function : "");
+    if(!source)
+    {
+        description->callbackSource = {};
+        return rocfft_status_success;
+    }
+    // source without any functions to call is pointless
+    if(!load_function && !store_function)
+        return rocfft_status_invalid_arg_value;
+    description->callbackSource.source         = source;
+    description->callbackSource.load_function  = load_function ? load_function : "";
+    description->callbackSource.store_function = store_function ? store_function : "";
+    return rocfft_status_success;
+}
+
 static size_t offset_count(rocfft_array_type type)
 {
     // planar data has 2 sets of offsets, otherwise we have one
@@ -435,6 +506,122 @@ std::string rocfft_rider_command(rocfft_plan plan)
     return rider.str();
 }
 
+// Build an ExecPlan for the plan's transform over the given number
+// of transforms.  Returns false if the plan was only compiled and is
+// not executable.
+static bool BuildExecPlan(const rocfft_plan plan, size_t batch, ExecPlan& execPlan)
+{
+    NodeMetaData rootPlanData(nullptr);
+
+    rootPlanData.dimension = plan->rank;
+    rootPlanData.batch     = batch;
+    for(size_t i = 0; i < plan->rank; i++)
+    {
+        rootPlanData.length.push_back(plan->lengths[i]);
+
+        rootPlanData.inStride.push_back(plan->desc.inStrides[i]);
+        rootPlanData.outStride.push_back(plan->desc.outStrides[i]);
+    }
+    rootPlanData.iDist = plan->desc.inDist;
+    rootPlanData.oDist = plan->desc.outDist;
+
+    rootPlanData.placement = plan->placement;
+    rootPlanData.precision = plan->precision;
+    rootPlanData.storage   = plan->desc.storagePrecision;
+    if((plan->transformType == rocfft_transform_type_complex_forward)
+       || (plan->transformType == rocfft_transform_type_real_forward))
+        rootPlanData.direction = -1;
+    else
+        rootPlanData.direction = 1;
+
+    rootPlanData.inArrayType  = plan->desc.inArrayType;
+    rootPlanData.outArrayType = plan->desc.outArrayType;
+    rootPlanData.rootIsC2C    = (rootPlanData.inArrayType != rocfft_array_type_real)
+                             && (rootPlanData.outArrayType != rocfft_array_type_real);
+
+    execPlan.hostExec = plan->desc.executionTarget == rocfft_execution_target_host;
+
+    if(execPlan.hostExec)
+    {
+        // host plans don't need a device, but decompose the same way
+        // as for the current device if there is one
+        execPlan.deviceProp = HostDeviceProp();
+    }
+    else
+    {
+        int deviceId = 0;
+        if(hipGetDevice(&deviceId) != hipSuccess)
+        {
+            throw std::runtime_error("hipGetDevice failed.");
+        }
+        if(hipGetDeviceProperties(&(execPlan.deviceProp), deviceId) != hipSuccess)
+        {
+            throw std::runtime_error("hipGetDeviceProperties failed for deviceId "
+                                     + std::to_string(deviceId));
+        }
+    }
+    rootPlanData.deviceProp = execPlan.deviceProp;
+    execPlan.rootPlan       = NodeFactory::CreateExplicitNode(rootPlanData, nullptr);
+
+    execPlan.callbackSource = plan->desc.callbackSource;
+
+    std::copy(plan->lengths.begin(),
+              plan->lengths.begin() + plan->rank,
+              std::back_inserter(execPlan.iLength));
+    std::copy(plan->lengths.begin(),
+              plan->lengths.begin() + plan->rank,
+              std::back_inserter(execPlan.oLength));
+
+    if(plan->transformType == rocfft_transform_type_real_inverse)
+    {
+        execPlan.iLength.front() = execPlan.iLength.front() / 2 + 1;
+        if(plan->placement == rocfft_placement_inplace)
+            execPlan.oLength.front() = execPlan.iLength.front() * 2;
+    }
+    if(plan->transformType == rocfft_transform_type_real_forward)
+    {
+        execPlan.oLength.front() = execPlan.oLength.front() / 2 + 1;
+        if(plan->placement == rocfft_placement_inplace)
+            execPlan.iLength.front() = execPlan.oLength.front() * 2;
+    }
+
+    // set scaling on the root plan
+    execPlan.rootPlan->scale_factor = plan->desc.scale_factor;
+
+    try
+    {
+        ProcessNode(execPlan); // TODO: more descriptions are needed
+    }
+    catch(std::exception&)
+    {
+        if(LOG_PLAN_ENABLED())
+            PrintNode(*LogSingleton::GetInstance().GetPlanOS(), execPlan);
+        throw;
+    }
+
+    // plan is compiled, no need to alloc twiddles + kargs etc
+    if(rocfft_getenv("ROCFFT_INTERNAL_COMPILE_ONLY") == "1")
+        return false;
+
+    if(execPlan.hostExec)
+    {
+        PlanHostExec(execPlan);
+        if(LOG_PLAN_ENABLED())
+            PrintNode(*LogSingleton::GetInstance().GetPlanOS(), execPlan);
+        return true;
+    }
+
+    TraceScope trace(TraceEvent::PLAN_STAGE, "kernel_setup");
+    if(!PlanPowX(execPlan)) // PlanPowX enqueues the GPU kernels by function
+    {
+
+        throw std::runtime_error("Unable to create execution plan.");
+    }
+    if(LOG_PLAN_ENABLED())
+        PrintNode(*LogSingleton::GetInstance().GetPlanOS(), execPlan);
+    return true;
+}
+
 rocfft_status rocfft_plan_create_internal(rocfft_plan                   plan,
                                           const rocfft_result_placement placement,
                                           const rocfft_transform_type   transform_type,
@@ -447,6 +634,9 @@ rocfft_status rocfft_plan_create_internal(rocfft_plan                   plan,
     if(dimensions > 3)
         return rocfft_status_invalid_dimensions;
 
+    TraceScope trace(TraceEvent::PLAN_CREATE);
+    trace.set_arg(0, dimensions).set_arg(1, number_of_transforms);
+
     rocfft_plan p = plan;
     p->rank       = dimensions;
     p->lengths[0] = 1;
@@ -459,7 +649,6 @@ rocfft_status rocfft_plan_create_internal(rocfft_plan                   plan,
     p->batch          = number_of_transforms;
     p->placement      = placement;
     p->precision      = precision;
-    p->base_type_size = real_type_size(precision);
     p->transformType  = transform_type;
 
     if(description != nullptr)
@@ -468,6 +657,35 @@ rocfft_status rocfft_plan_create_internal(rocfft_plan                   plan,
     }
     p->desc.init_defaults(p->transformType, p->placement, p->rank, p->lengths);
 
+    // narrower storage only makes sense for single-precision compute
+    if(p->desc.storagePrecision != rocfft_storage_precision_native
+       && precision != rocfft_precision_single)
+        return rocfft_status_invalid_arg_value;
+    p->base_type_size = real_type_size(precision, p->desc.storagePrecision);
+
+    // host kernels compute in single or double precision, on data
+    // that's already in host memory
+    if(p->desc.executionTarget == rocfft_execution_target_host
+       && (precision == rocfft_precision_half
+           || p->desc.storagePrecision != rocfft_storage_precision_native
+           || p->desc.streamingDeviceBytes))
+        return rocfft_status_invalid_arg_value;
+
+    // kernel timing needs device kernels that rocfft_execute
+    // launches itself
+    if(p->desc.kernelTiming
+       && (p->desc.executionTarget != rocfft_execution_target_device
+           || p->desc.streamingDeviceBytes))
+        return rocfft_status_invalid_arg_value;
+
+    // callbacks compiled from source need runtime-compiled device
+    // kernels that read and write numbers of the compute precision
+    if(!p->desc.callbackSource.empty()
+       && (p->desc.executionTarget != rocfft_execution_target_device
+           || p->desc.streamingDeviceBytes
+           || p->desc.storagePrecision != rocfft_storage_precision_native))
+        return rocfft_status_invalid_arg_value;
+
     // Check plan validity
     switch(transform_type)
     {
@@ -517,98 +735,66 @@ rocfft_status rocfft_plan_create_internal(rocfft_plan                   plan,
         break;
     }
 
+    // Reject output layouts that would write two elements to the
+    // same place.  Only the analytic check is cheap enough to do
+    // here, so layouts it can't decide are accepted.
+    std::vector<size_t> outLength(p->lengths.begin(), p->lengths.begin() + p->rank);
+    std::vector<size_t> outStride(p->desc.outStrides.begin(),
+                                  p->desc.outStrides.begin() + p->rank);
+    if(transform_type == rocfft_transform_type_real_forward)
+        outLength[0] = outLength[0] / 2 + 1;
+    if(array_overlap_analytic(outLength, outStride) == array_overlap::some)
+        return rocfft_status_invalid_strides;
+    outLength.push_back(p->batch);
+    outStride.push_back(p->desc.outDist);
+    if(array_overlap_analytic(outLength, outStride) == array_overlap::some)
+        return rocfft_status_invalid_distance;
+
     // sort the parameters to be row major, in case they're not
     plan->sort();
 
     log_bench(rocfft_rider_command(p));
 
+    // host-resident data is transformed a chunk at a time by plans
+    // that the streaming plan owns
+    if(plan->desc.streamingDeviceBytes)
+        return CreateStreamingPlan(plan);
+
     // construct the plan
     try
     {
-        NodeMetaData rootPlanData(nullptr);
-
-        rootPlanData.dimension = plan->rank;
-        rootPlanData.batch     = plan->batch;
-        for(size_t i = 0; i < plan->rank; i++)
-        {
-            rootPlanData.length.push_back(plan->lengths[i]);
-
-            rootPlanData.inStride.push_back(plan->desc.inStrides[i]);
-            rootPlanData.outStride.push_back(plan->desc.outStrides[i]);
-        }
-        rootPlanData.iDist = plan->desc.inDist;
-        rootPlanData.oDist = plan->desc.outDist;
-
-        rootPlanData.placement = plan->placement;
-        rootPlanData.precision = plan->precision;
-        if((plan->transformType == rocfft_transform_type_complex_forward)
-           || (plan->transformType == rocfft_transform_type_real_forward))
-            rootPlanData.direction = -1;
-        else
-            rootPlanData.direction = 1;
-
-        rootPlanData.inArrayType  = plan->desc.inArrayType;
-        rootPlanData.outArrayType = plan->desc.outArrayType;
-        rootPlanData.rootIsC2C    = (rootPlanData.inArrayType != rocfft_array_type_real)
-                                 && (rootPlanData.outArrayType != rocfft_array_type_real);
-
-        ExecPlan& execPlan = plan->execPlan;
-        int       deviceId = 0;
-        if(hipGetDevice(&deviceId) != hipSuccess)
-        {
-            throw std::runtime_error("hipGetDevice failed.");
-        }
-        if(hipGetDeviceProperties(&(execPlan.deviceProp), deviceId) != hipSuccess)
+        if(!BuildExecPlan(plan, plan->batch, plan->execPlan))
+            return rocfft_status_success;
+        plan->chunkBatch = plan->batch;
+
+        // If the work buffer is over the limit, split the batch into
+        // chunks that fit.  Work memory is roughly proportional to
+        // batch, so estimate the chunk size from that and shrink it
+        // further if the estimate was optimistic.
+        const size_t maxBytes = plan->desc.maxWorkBufBytes;
+        while(maxBytes && plan->WorkBufBytes() > maxBytes)
         {
-            throw std::runtime_error("hipGetDeviceProperties failed for deviceId "
-                                     + std::to_string(deviceId));
-        }
-        rootPlanData.deviceProp = execPlan.deviceProp;
-        execPlan.rootPlan       = NodeFactory::CreateExplicitNode(rootPlanData, nullptr);
+            if(plan->chunkBatch == 1)
+                return rocfft_status_invalid_work_buffer;
 
-        std::copy(plan->lengths.begin(),
-                  plan->lengths.begin() + plan->rank,
-                  std::back_inserter(execPlan.iLength));
-        std::copy(plan->lengths.begin(),
-                  plan->lengths.begin() + plan->rank,
-                  std::back_inserter(execPlan.oLength));
+            auto estimate = static_cast<size_t>(static_cast<double>(maxBytes)
+                                                / plan->WorkBufBytes() * plan->chunkBatch);
+            plan->chunkBatch = std::min(plan->chunkBatch - 1, std::max<size_t>(estimate, 1));
 
-        if(plan->transformType == rocfft_transform_type_real_inverse)
-        {
-            execPlan.iLength.front() = execPlan.iLength.front() / 2 + 1;
-            if(plan->placement == rocfft_placement_inplace)
-                execPlan.oLength.front() = execPlan.iLength.front() * 2;
-        }
-        if(plan->transformType == rocfft_transform_type_real_forward)
-        {
-            execPlan.oLength.front() = execPlan.oLength.front() / 2 + 1;
-            if(plan->placement == rocfft_placement_inplace)
-                execPlan.iLength.front() = execPlan.oLength.front() * 2;
-        }
-
-        // set scaling on the root plan
-        execPlan.rootPlan->scale_factor = p->desc.scale_factor;
+            plan->execPlan = ExecPlan();
+            BuildExecPlan(plan, plan->chunkBatch, plan->execPlan);
 
-        try
-        {
-            ProcessNode(execPlan); // TODO: more descriptions are needed
-        }
-        catch(std::exception&)
-        {
-            if(LOG_PLAN_ENABLED())
-                PrintNode(*LogSingleton::GetInstance().GetPlanOS(), execPlan);
-            throw;
+            plan->remainderPlan.reset();
+            if(plan->batch % plan->chunkBatch)
+            {
+                plan->remainderPlan = std::make_unique<ExecPlan>();
+                BuildExecPlan(plan, plan->batch % plan->chunkBatch, *plan->remainderPlan);
+            }
         }
 
-        // plan is compiled, no need to alloc twiddles + kargs etc
-        if(rocfft_getenv("ROCFFT_INTERNAL_COMPILE_ONLY") == "1")
-            return rocfft_status_success;
-
-        if(!PlanPowX(execPlan)) // PlanPowX enqueues the GPU kernels by function
-        {
-
-            throw std::runtime_error("Unable to create execution plan.");
-        }
+        if((plan->desc.kernelTiming || LOG_PROFILE_ENABLED()) && !plan->execPlan.hostExec)
+            plan->kernelTimer = std::make_unique<KernelTimer>();
+        trace.set_arg(2, plan->WorkBufBytes());
         return rocfft_status_success;
     }
     catch(std::exception& e)
@@ -636,6 +822,13 @@ rocfft_status rocfft_plan_create(rocfft_plan*                  plan,
                                  const size_t                  number_of_transforms,
                                  const rocfft_plan_description description)
 {
+    // the first plan in the process pays for most lazy
+    // initialization, so time it as part of startup
+    static std::atomic<bool>    first_plan{true};
+    std::optional<StartupTimer> first_plan_timer;
+    if(first_plan.exchange(false))
+        first_plan_timer.emplace("first_plan_create");
+
     rocfft_plan_allocate(plan);
 
     size_t log_len[3] = {1, 1, 1};
@@ -685,11 +878,61 @@ rocfft_status rocfft_plan_get_work_buffer_size(const rocfft_plan plan, size_t* s
     if(!plan)
         return rocfft_status_failure;
 
-    *size_in_bytes = plan->execPlan.WorkBufBytes(plan->base_type_size);
+    *size_in_bytes = plan->WorkBufBytes();
     log_trace(__func__, "plan", plan, "size_in_bytes ptr", size_in_bytes, "val", *size_in_bytes);
     return rocfft_status_success;
 }
 
+rocfft_status rocfft_plan_get_kernel_timing_count(const rocfft_plan plan, size_t* count)
+{
+    if(!plan || !count)
+        return rocfft_status_failure;
+
+    try
+    {
+        *count = plan->kernelTimer ? plan->kernelTimer->latest().size() : 0;
+    }
+    catch(std::exception&)
+    {
+        return rocfft_status_failure;
+    }
+    log_trace(__func__, "plan", plan, "count ptr", count, "val", *count);
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_get_kernel_timing(const rocfft_plan plan,
+                                            const size_t      index,
+                                            float*            duration_ms,
+                                            size_t*           size_in_bytes,
+                                            float*            bandwidth_GB_per_s)
+{
+    log_trace(__func__, "plan", plan, "index", index);
+    if(!plan)
+        return rocfft_status_failure;
+
+    std::vector<KernelTiming> kernels;
+    try
+    {
+        if(plan->kernelTimer)
+            kernels = plan->kernelTimer->latest();
+    }
+    catch(std::exception&)
+    {
+        return rocfft_status_failure;
+    }
+    if(index >= kernels.size())
+        return rocfft_status_invalid_arg_value;
+
+    const auto& kernel = kernels[index];
+    if(duration_ms)
+        *duration_ms = kernel.duration_ms;
+    if(size_in_bytes)
+        *size_in_bytes = kernel.bytes;
+    if(bandwidth_GB_per_s)
+        *bandwidth_GB_per_s = kernel.bandwidth_GB_per_s;
+    return rocfft_status_success;
+}
+
 rocfft_status rocfft_plan_get_print(const rocfft_plan plan)
 {
     log_trace(__func__, "plan", plan);
@@ -844,6 +1087,7 @@ void TreeNode::CopyNodeData(const TreeNode& srcNode)
     oOffset         = srcNode.oOffset;
     placement       = srcNode.placement;
     precision       = srcNode.precision;
+    storage         = srcNode.storage;
     direction       = srcNode.direction;
     inArrayType     = srcNode.inArrayType;
     outArrayType    = srcNode.outArrayType;
@@ -885,6 +1129,7 @@ void TreeNode::CopyNodeData(const NodeMetaData& data)
     oOffset      = data.oOffset;
     placement    = data.placement;
     precision    = data.precision;
+    storage      = data.storage;
     direction    = data.direction;
     inArrayType  = data.inArrayType;
     outArrayType = data.outArrayType;
@@ -1489,19 +1734,29 @@ void RuntimeCompilePlan(ExecPlan& execPlan)
     TreeNode* store_node            = nullptr;
     std::tie(load_node, store_node) = execPlan.get_load_store_nodes();
 
-    // callbacks are only possible on plans that don't use planar format for input or output
-    bool need_callbacks = !array_type_is_planar(load_node->inArrayType)
-                          && !array_type_is_planar(store_node->outArrayType);
+    // callbacks are only possible on plans whose buffers hold numbers
+    // of the compute precision
+    bool need_callbacks = execPlan.rootPlan->storage == rocfft_storage_precision_native;
 
     if(need_callbacks)
     {
-        load_node->compiledKernelWithCallbacks
-            = RTCKernel::runtime_compile(*load_node, execPlan.deviceProp.gcnArchName, true);
+        // kernels compiled with callback source only get the
+        // callbacks for the side of the transform they're doing
+        RTCCallbackSource load_source  = execPlan.callbackSource;
+        RTCCallbackSource store_source = execPlan.callbackSource;
+        if(store_node != load_node)
+        {
+            load_source.store_function.clear();
+            store_source.load_function.clear();
+        }
+
+        load_node->compiledKernelWithCallbacks = RTCKernel::runtime_compile(
+            *load_node, execPlan.deviceProp.gcnArchName, true, load_source);
 
         if(store_node != load_node)
         {
-            store_node->compiledKernelWithCallbacks
-                = RTCKernel::runtime_compile(*store_node, execPlan.deviceProp.gcnArchName, true);
+            store_node->compiledKernelWithCallbacks = RTCKernel::runtime_compile(
+                *store_node, execPlan.deviceProp.gcnArchName, true, store_source);
         }
     }
 
@@ -1515,10 +1770,18 @@ void RuntimeCompilePlan(ExecPlan& execPlan)
         if(node->compiledKernelWithCallbacks.valid())
             node->compiledKernelWithCallbacks.get();
     }
+
+    // built-in kernels can't run callbacks from source
+    if((!execPlan.callbackSource.load_function.empty()
+        && !load_node->compiledKernelWithCallbacks.get())
+       || (!execPlan.callbackSource.store_function.empty()
+           && !store_node->compiledKernelWithCallbacks.get()))
+        throw std::runtime_error("callback source requires runtime-compiled kernels");
 }
 
 void ProcessNode(ExecPlan& execPlan)
 {
+    TraceScope build_trace(TraceEvent::PLAN_STAGE, "build_tree");
     execPlan.rootPlan->RecursiveBuildTree();
 
     assert(execPlan.rootPlan->length.size() == execPlan.rootPlan->dimension);
@@ -1529,7 +1792,9 @@ void ProcessNode(ExecPlan& execPlan)
     execPlan.rootPlan->CollectLeaves(execPlan.execSeq, execPlan.fuseShims);
     CheckFuseShimForArch(execPlan);
     OrderFuseShims(execPlan.execSeq, execPlan.fuseShims);
+    build_trace.end();
 
+    TraceScope assign_trace(TraceEvent::PLAN_STAGE, "assign_buffers");
     // initialize root plan input/output location if not already done
     if(execPlan.rootPlan->obOut == OB_UNINIT)
         execPlan.rootPlan->obOut = OB_USER_OUT;
@@ -1582,9 +1847,14 @@ void ProcessNode(ExecPlan& execPlan)
               return node->scheme != CS_KERNEL_APPLY_CALLBACK;
           });
     (*scale_node)->scale_factor = execPlan.rootPlan->scale_factor;
+    assign_trace.end();
 
-    // compile kernels for applicable nodes
-    RuntimeCompilePlan(execPlan);
+    // compile kernels for applicable nodes, unless they'll run on the host
+    if(!execPlan.hostExec)
+    {
+        TraceScope compile_trace(TraceEvent::PLAN_STAGE, "runtime_compile");
+        RuntimeCompilePlan(execPlan);
+    }
 
     execPlan.workBufSize      = tmpBufSize + cmplxForRealSize + blueSize + chirpSize;
     execPlan.tmpWorkBufSize   = tmpBufSize;
@@ -23,6 +23,7 @@
 #include <cstddef>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <numeric>
 #include <unordered_map>
 #include <vector>
@@ -31,12 +32,15 @@
 
 #include "logging.h"
 #include "plan.h"
+#include "repo.h"
 #include "rtc_kernel.h"
 #include "transform.h"
 
 #include "kernel_launch.h"
 
+#include "event_trace.h"
 #include "function_pool.h"
+#include "kernel_timing.h"
 #include "ref_cpu.h"
 
 #include "real2complex.h"
@@ -53,14 +57,47 @@
 // failure returns false right away.
 bool PlanPowX(ExecPlan& execPlan)
 {
+    // generate all of the twiddle tables the plan needs at once.
+    // the nodes then take their tables from the repo, and the
+    // batch's references are released.
+    std::vector<TwiddleTableSpec> twiddle_specs;
     for(const auto& node : execPlan.execSeq)
     {
-        if(node->CreateTwiddleTableResource() == false)
-            return false;
+        auto node_specs = node->GetTwiddleTableSpecs();
+        std::copy(node_specs.begin(), node_specs.end(), std::back_inserter(twiddle_specs));
+    }
+    auto twiddle_batch = Repo::GetTwiddlesBatch(twiddle_specs, execPlan.deviceProp.gcnArchName);
+    auto release_batch = [&twiddle_batch]() {
+        for(const auto& twd : twiddle_batch)
+        {
+            if(twd.first)
+                Repo::ReleaseTwiddles(twd.first);
+        }
+    };
+
+    try
+    {
+        for(const auto& node : execPlan.execSeq)
+        {
+            if(node->CreateTwiddleTableResource() == false)
+            {
+                release_batch();
+                return false;
+            }
 
-        if(node->CreateDevKernelArgs() == false)
-            return false;
+            if(node->CreateDevKernelArgs() == false)
+            {
+                release_batch();
+                return false;
+            }
+        }
     }
+    catch(...)
+    {
+        release_batch();
+        throw;
+    }
+    release_batch();
 
     for(const auto& node : execPlan.execSeq)
     {
@@ -83,6 +120,12 @@ bool PlanPowX(ExecPlan& execPlan)
         }
         node->SetupGridParamAndFuncPtr(ptr, gp);
 
+        // precompiled kernels only read and write buffers of the
+        // compute precision
+        if(node->storage != rocfft_storage_precision_native && !rtcKernel)
+            throw std::runtime_error("storage precision not supported by "
+                                     + PrintScheme(node->scheme) + " kernel");
+
         execPlan.devFnCall.push_back(ptr);
         execPlan.gridParam.push_back(gp);
     }
@@ -90,78 +133,6 @@ bool PlanPowX(ExecPlan& execPlan)
     return true;
 }
 
-static size_t data_size_bytes(const std::vector<size_t>& lengths,
-                              rocfft_precision           precision,
-                              rocfft_array_type          type)
-{
-    // first compute the raw number of elements
-    const size_t elems = std::accumulate(
-        lengths.begin(), lengths.end(), static_cast<size_t>(1), std::multiplies<size_t>());
-    // size of each element
-    const size_t elemsize = real_type_size(precision);
-    switch(type)
-    {
-    case rocfft_array_type_complex_interleaved:
-    case rocfft_array_type_complex_planar:
-        // complex needs two numbers per element
-        return 2 * elems * elemsize;
-    case rocfft_array_type_real:
-        // real needs one number per element
-        return elems * elemsize;
-    case rocfft_array_type_hermitian_interleaved:
-    case rocfft_array_type_hermitian_planar:
-    {
-        // hermitian requires 2 numbers per element, but innermost
-        // dimension is cut down to roughly half
-        size_t non_innermost = elems / lengths[0];
-        return 2 * non_innermost * elemsize * ((lengths[0] / 2) + 1);
-    }
-    case rocfft_array_type_unset:
-        // we should really have an array type at this point
-        assert(false);
-        return 0;
-    }
-}
-
-static float execution_bandwidth_GB_per_s(size_t data_size_bytes, float duration_ms)
-{
-    // divide bytes by (1000000 * milliseconds) to get GB/s
-    return static_cast<float>(data_size_bytes) / (1000000.0 * duration_ms);
-}
-
-// NOTE: HIP returns the maximum global frequency in kHz, which might
-// not be the actual frequency when the transform ran.  This function
-// might also return 0.0 if the bandwidth can't be queried.
-static float max_memory_bandwidth_GB_per_s()
-{
-    // Try to get the device bandwidth from an environment variable:
-    auto pdevbw = rocfft_getenv("ROCFFT_DEVICE_BW");
-    if(!pdevbw.empty())
-    {
-        return atof(pdevbw.c_str());
-    }
-
-    // Try to get the device bandwidth from hip calls:
-    int deviceid = 0;
-    if(hipGetDevice(&deviceid) != hipSuccess)
-        // default to first device
-        deviceid = 0;
-    int max_memory_clock_kHz = 0;
-    int memory_bus_width     = 0;
-    if(hipDeviceGetAttribute(&max_memory_clock_kHz, hipDeviceAttributeMemoryClockRate, deviceid)
-       != hipSuccess)
-        max_memory_clock_kHz = 0;
-    if(hipDeviceGetAttribute(&memory_bus_width, hipDeviceAttributeMemoryBusWidth, deviceid)
-       != hipSuccess)
-        memory_bus_width = 0;
-    auto max_memory_clock_MHz = static_cast<float>(max_memory_clock_kHz) / 1000.0;
-    // multiply by 2.0 because transfer is bidirectional
-    // divide by 8.0 because bus width is in bits and we want bytes
-    // divide by 1000 to convert MB to GB
-    float result = (max_memory_clock_MHz * 2.0 * memory_bus_width / 8.0) / 1000.0;
-    return result;
-}
-
 // Print either an input or output buffer, given column-major dimensions
 void DebugPrintBuffer(rocfft_ostream&            stream,
                       rocfft_array_type          type,
@@ -317,13 +288,49 @@ void SetDefaultCallback(const TreeNode* node, const SetCallbackType& type, void*
 
     auto array_type = (type == SetCallbackType::LOAD) ? node->inArrayType : node->outArrayType;
 
-    // guaranteed to only have interleaved type by the caller (rocfft_execute)
     auto is_complex = (array_type == rocfft_array_type_complex_interleaved
                        || array_type == rocfft_array_type_hermitian_interleaved)
                           ? true
                           : false;
+    auto is_planar  = array_type_is_planar(array_type);
 
-    if(is_complex && type == SetCallbackType::LOAD)
+    if(is_planar && type == SetCallbackType::LOAD)
+    {
+        switch(node->precision)
+        {
+        case rocfft_precision_half:
+            result
+                = hipMemcpyFromSymbol(cb, HIP_SYMBOL(load_cb_default_planar_half), sizeof(void*));
+            break;
+        case rocfft_precision_single:
+            result
+                = hipMemcpyFromSymbol(cb, HIP_SYMBOL(load_cb_default_planar_float), sizeof(void*));
+            break;
+        case rocfft_precision_double:
+            result = hipMemcpyFromSymbol(
+                cb, HIP_SYMBOL(load_cb_default_planar_double), sizeof(void*));
+            break;
+        }
+    }
+    else if(is_planar && type == SetCallbackType::STORE)
+    {
+        switch(node->precision)
+        {
+        case rocfft_precision_half:
+            result
+                = hipMemcpyFromSymbol(cb, HIP_SYMBOL(store_cb_default_planar_half), sizeof(void*));
+            break;
+        case rocfft_precision_single:
+            result = hipMemcpyFromSymbol(
+                cb, HIP_SYMBOL(store_cb_default_planar_float), sizeof(void*));
+            break;
+        case rocfft_precision_double:
+            result = hipMemcpyFromSymbol(
+                cb, HIP_SYMBOL(store_cb_default_planar_double), sizeof(void*));
+            break;
+        }
+    }
+    else if(is_complex && type == SetCallbackType::LOAD)
     {
         switch(node->precision)
         {
@@ -394,29 +401,128 @@ void SetDefaultCallback(const TreeNode* node, const SetCallbackType& type, void*
         throw std::runtime_error("hipMemcpyFromSymbol failure");
 }
 
+// Point buf at the operating buffer ob, for data of the given array
+// type.  offset counts complex elements from the start of the
+// Bluestein buffer.
+static void resolve_buffer(const ExecPlan&   execPlan,
+                           OperatingBuffer   ob,
+                           rocfft_array_type type,
+                           size_t            offset,
+                           size_t            complexTSize,
+                           void*             in_buffer[],
+                           void*             out_buffer[],
+                           void*             workBuffer,
+                           void*             buf[2])
+{
+    switch(ob)
+    {
+    case OB_USER_IN:
+        buf[0] = in_buffer[0];
+        if(type == rocfft_array_type_complex_planar || type == rocfft_array_type_hermitian_planar)
+        {
+            buf[1] = in_buffer[1];
+        }
+        break;
+    case OB_USER_OUT:
+        buf[0] = out_buffer[0];
+        if(type == rocfft_array_type_complex_planar || type == rocfft_array_type_hermitian_planar)
+        {
+            buf[1] = out_buffer[1];
+        }
+        break;
+    case OB_TEMP:
+        buf[0] = workBuffer;
+        if(type == rocfft_array_type_complex_planar || type == rocfft_array_type_hermitian_planar)
+        {
+            // Assume planar using the same extra size of memory as
+            // interleaved format, and we just need to split it for
+            // planar.
+            buf[1] = (void*)((char*)workBuffer + execPlan.tmpWorkBufSize * complexTSize / 2);
+        }
+        break;
+    case OB_TEMP_CMPLX_FOR_REAL:
+        buf[0] = (void*)((char*)workBuffer + execPlan.tmpWorkBufSize * complexTSize);
+        // TODO: Can we use this in planar as well ??
+        // if(type == rocfft_array_type_complex_planar
+        //    || type == rocfft_array_type_hermitian_planar)
+        // {
+        //     buf[1] = (void*)((char*)workBuffer
+        //                      + (execPlan.tmpWorkBufSize + execPlan.copyWorkBufSize / 2)
+        //                            * complexTSize);
+        // }
+        break;
+    case OB_TEMP_BLUESTEIN:
+        buf[0] = (void*)((char*)workBuffer
+                         + (execPlan.tmpWorkBufSize + execPlan.copyWorkBufSize + offset)
+                               * complexTSize);
+        // Bluestein mul-kernels (3 types) work well for CI->CI
+        // so we only consider CI->CI now
+        break;
+    case OB_UNINIT:
+        rocfft_cerr << "Error: operating buffer not initialized for kernel!\n";
+        assert(ob != OB_UNINIT);
+        break;
+    default:
+        rocfft_cerr << "Error: operating buffer not specified for kernel!\n";
+        assert(false);
+    }
+}
+
+void AssignNodeBuffers(const ExecPlan& execPlan,
+                       const TreeNode& node,
+                       void*           in_buffer[],
+                       void*           out_buffer[],
+                       void*           workBuffer,
+                       void*           bufIn[2],
+                       void*           bufOut[2],
+                       void*&          bufTemp)
+{
+    // Size of complex type, as stored in the work buffer
+    const size_t complexTSize = complex_type_size(node.precision, node.storage);
+
+    resolve_buffer(execPlan,
+                   node.obIn,
+                   node.inArrayType,
+                   node.iOffset,
+                   complexTSize,
+                   in_buffer,
+                   out_buffer,
+                   workBuffer,
+                   bufIn);
+    resolve_buffer(execPlan,
+                   node.obOut,
+                   node.outArrayType,
+                   node.oOffset,
+                   complexTSize,
+                   in_buffer,
+                   out_buffer,
+                   workBuffer,
+                   bufOut);
+
+    // single-kernel bluestein requires a bluestein temp buffer separate from input and output
+    if(node.scheme == CS_KERNEL_BLUESTEIN_SINGLE)
+    {
+        bufTemp = ((char*)workBuffer
+                   + (execPlan.tmpWorkBufSize + execPlan.copyWorkBufSize) * complexTSize);
+    }
+}
+
 // Internal plan executor.
 // For in-place transforms, in_buffer == out_buffer.
-void TransformPowX(const ExecPlan&       execPlan,
-                   void*                 in_buffer[],
-                   void*                 out_buffer[],
-                   rocfft_execution_info info)
+void TransformPowX(const ExecPlan&        execPlan,
+                   void*                  in_buffer[],
+                   void*                  out_buffer[],
+                   rocfft_execution_info  info,
+                   KernelTimingExecution* timing)
 {
     assert(execPlan.execSeq.size() == execPlan.devFnCall.size());
     assert(execPlan.execSeq.size() == execPlan.gridParam.size());
 
-    // we can log profile information if we're on the null stream,
-    // since we will be able to wait for the transform to finish
-    bool            emit_profile_log  = LOG_PROFILE_ENABLED() && !info->rocfft_stream;
     bool            emit_kernelio_log = LOG_KERNELIO_ENABLED();
     rocfft_ostream* kernelio_stream   = nullptr;
-    float           max_memory_bw     = 0.0;
-    hipEvent_t      start, stop;
-    if(emit_profile_log)
-    {
-        if(hipEventCreate(&start) != hipSuccess || hipEventCreate(&stop) != hipSuccess)
-            throw std::runtime_error("hipEventCreate failure");
-        max_memory_bw = max_memory_bandwidth_GB_per_s();
-    }
+
+    if(timing)
+        timing->start(info->rocfft_stream);
 
     // assign callbacks to the node that are actually doing the
     // loading and storing to/from global memory
@@ -432,6 +538,11 @@ void TransformPowX(const ExecPlan&       execPlan,
     store_node->callbacks.store_cb_data      = info->callbacks.store_cb_data;
     store_node->callbacks.store_cb_lds_bytes = info->callbacks.store_cb_lds_bytes;
 
+    // callbacks compiled from source are part of the plan, and
+    // always run
+    load_node->callbacks.load_cb_source   = !execPlan.callbackSource.load_function.empty();
+    store_node->callbacks.store_cb_source = !execPlan.callbackSource.store_function.empty();
+
     for(size_t i = 0; i < execPlan.execSeq.size(); i++)
     {
         DeviceCallIn data;
@@ -443,128 +554,14 @@ void TransformPowX(const ExecPlan&       execPlan,
         else
             data.log_func = nullptr;
 
-        // Size of complex type
-        const size_t complexTSize = complex_type_size(data.node->precision);
-
-        switch(data.node->obIn)
-        {
-        case OB_USER_IN:
-            data.bufIn[0] = in_buffer[0];
-            if(data.node->inArrayType == rocfft_array_type_complex_planar
-               || data.node->inArrayType == rocfft_array_type_hermitian_planar)
-            {
-                data.bufIn[1] = in_buffer[1];
-            }
-            break;
-        case OB_USER_OUT:
-            data.bufIn[0] = out_buffer[0];
-            if(data.node->inArrayType == rocfft_array_type_complex_planar
-               || data.node->inArrayType == rocfft_array_type_hermitian_planar)
-            {
-                data.bufIn[1] = out_buffer[1];
-            }
-            break;
-        case OB_TEMP:
-            data.bufIn[0] = info->workBuffer;
-            if(data.node->inArrayType == rocfft_array_type_complex_planar
-               || data.node->inArrayType == rocfft_array_type_hermitian_planar)
-            {
-                // Assume planar using the same extra size of memory as
-                // interleaved format, and we just need to split it for
-                // planar.
-                data.bufIn[1]
-                    = (void*)((char*)info->workBuffer + execPlan.tmpWorkBufSize * complexTSize / 2);
-            }
-            break;
-        case OB_TEMP_CMPLX_FOR_REAL:
-            data.bufIn[0]
-                = (void*)((char*)info->workBuffer + execPlan.tmpWorkBufSize * complexTSize);
-            // TODO: Can we use this in planar as well ??
-            // if(data.node->inArrayType == rocfft_array_type_complex_planar
-            //    || data.node->inArrayType == rocfft_array_type_hermitian_planar)
-            // {
-            //     data.bufIn[1] = (void*)((char*)info->workBuffer
-            //                             + (execPlan.tmpWorkBufSize + execPlan.copyWorkBufSize / 2)
-            //                                   * complexTSize);
-            // }
-            break;
-        case OB_TEMP_BLUESTEIN:
-            data.bufIn[0] = (void*)((char*)info->workBuffer
-                                    + (execPlan.tmpWorkBufSize + execPlan.copyWorkBufSize
-                                       + data.node->iOffset)
-                                          * complexTSize);
-            // Bluestein mul-kernels (3 types) work well for CI->CI
-            // so we only consider CI->CI now
-            break;
-        case OB_UNINIT:
-            rocfft_cerr << "Error: operating buffer not initialized for kernel!\n";
-            assert(data.node->obIn != OB_UNINIT);
-            break;
-        default:
-            rocfft_cerr << "Error: operating buffer not specified for kernel!\n";
-            assert(false);
-        }
-
-        switch(data.node->obOut)
-        {
-        case OB_USER_IN:
-            data.bufOut[0] = in_buffer[0];
-            if(data.node->outArrayType == rocfft_array_type_complex_planar
-               || data.node->outArrayType == rocfft_array_type_hermitian_planar)
-            {
-                data.bufOut[1] = in_buffer[1];
-            }
-            break;
-        case OB_USER_OUT:
-            data.bufOut[0] = out_buffer[0];
-            if(data.node->outArrayType == rocfft_array_type_complex_planar
-               || data.node->outArrayType == rocfft_array_type_hermitian_planar)
-            {
-                data.bufOut[1] = out_buffer[1];
-            }
-            break;
-        case OB_TEMP:
-            data.bufOut[0] = info->workBuffer;
-            if(data.node->outArrayType == rocfft_array_type_complex_planar
-               || data.node->outArrayType == rocfft_array_type_hermitian_planar)
-            {
-                // assume planar using the same extra size of memory as
-                // interleaved format, and we just need to split it for
-                // planar.
-                data.bufOut[1]
-                    = (void*)((char*)info->workBuffer + execPlan.tmpWorkBufSize * complexTSize / 2);
-            }
-            break;
-        case OB_TEMP_CMPLX_FOR_REAL:
-            data.bufOut[0]
-                = (void*)((char*)info->workBuffer + execPlan.tmpWorkBufSize * complexTSize);
-            // TODO: Can we use this in planar as well ??
-            // if(data.node->outArrayType == rocfft_array_type_complex_planar
-            //    || data.node->outArrayType == rocfft_array_type_hermitian_planar)
-            // {
-            //     data.bufOut[1] = (void*)((char*)info->workBuffer
-            //                              + (execPlan.tmpWorkBufSize + execPlan.copyWorkBufSize / 2)
-            //                                    * complexTSize);
-            // }
-            break;
-        case OB_TEMP_BLUESTEIN:
-            data.bufOut[0] = (void*)((char*)info->workBuffer
-                                     + (execPlan.tmpWorkBufSize + execPlan.copyWorkBufSize
-                                        + data.node->oOffset)
-                                           * complexTSize);
-            // Bluestein mul-kernels (3 types) work well for CI->CI
-            // so we only consider CI->CI now
-            break;
-        default:
-            assert(false);
-        }
-
-        // single-kernel bluestein requires a bluestein temp buffer separate from input and output
-        if(data.node->scheme == CS_KERNEL_BLUESTEIN_SINGLE)
-        {
-            data.bufTemp = ((char*)info->workBuffer
-                            + (execPlan.tmpWorkBufSize + execPlan.copyWorkBufSize) * complexTSize);
-        }
+        AssignNodeBuffers(execPlan,
+                          *data.node,
+                          in_buffer,
+                          out_buffer,
+                          info->workBuffer,
+                          data.bufIn,
+                          data.bufOut,
+                          data.bufTemp);
 
         // if callbacks are enabled, make sure load_cb_fn and store_cb_fn are not nullptrs
         if((data.node->callbacks.load_cb_fn == nullptr
@@ -635,14 +632,10 @@ void TransformPowX(const ExecPlan&       execPlan,
             }
             rocfft_cout << std::endl;
 
-            RefLibOp refLibOp(&data);
+            RefLibOp refLibOp(&data, i);
 #endif
 
             // execution kernel:
-            if(emit_profile_log)
-                if(hipEventRecord(start) != hipSuccess)
-                    throw std::runtime_error("hipEventRecord failure");
-
             DeviceCallOut back;
 
             // give callback parameters to kernel launcher
@@ -658,55 +651,20 @@ void TransformPowX(const ExecPlan&       execPlan,
             if(data.node->scheme != CS_KERNEL_APPLY_CALLBACK
                || data.get_callback_type() != CallbackType::NONE)
             {
+                TraceScope trace(TraceEvent::KERNEL_LAUNCH);
+                if(trace.is_active())
+                    trace.set_name(PrintScheme(data.node->scheme))
+                        .set_arg(0, i)
+                        .set_arg(1, kernel_data_size_bytes(*data.node))
+                        .set_arg(2, data.node->batch);
+
                 if(localCompiledKernel)
                     localCompiledKernel->launch(data);
                 else
                     fn(&data, &back);
             }
-            if(emit_profile_log)
-                if(hipEventRecord(stop) != hipSuccess)
-                    throw std::runtime_error("hipEventRecord failure");
-
-            // If we were on the null stream, measure elapsed time
-            // and emit profile logging.  If a stream was given, we
-            // can't wait for the transform to finish, so we can't
-            // emit any information.
-            if(emit_profile_log)
-            {
-                if(hipEventSynchronize(stop) != hipSuccess)
-                    throw std::runtime_error("hipEventSynchronize failure");
-                size_t in_size_bytes = data_size_bytes(
-                    data.node->length, data.node->precision, data.node->inArrayType);
-                size_t out_size_bytes = data_size_bytes(
-                    data.node->length, data.node->precision, data.node->outArrayType);
-                size_t total_size_bytes = (in_size_bytes + out_size_bytes) * data.node->batch;
-
-                float duration_ms = 0.0f;
-                if(hipEventElapsedTime(&duration_ms, start, stop) != hipSuccess)
-                    throw std::runtime_error("hipEventElapsedTime failure");
-                auto exec_bw        = execution_bandwidth_GB_per_s(total_size_bytes, duration_ms);
-                auto efficiency_pct = 0.0;
-                if(max_memory_bw != 0.0)
-                    efficiency_pct = 100.0 * exec_bw / max_memory_bw;
-                log_profile(__func__,
-                            "scheme",
-                            PrintScheme(execPlan.execSeq[i]->scheme),
-                            "duration_ms",
-                            duration_ms,
-                            "in_size",
-                            std::make_pair(static_cast<const size_t*>(data.node->length.data()),
-                                           data.node->length.size()),
-                            "total_size_bytes",
-                            total_size_bytes,
-                            "exec_GB_s",
-                            exec_bw,
-                            "max_mem_GB_s",
-                            max_memory_bw,
-                            "bw_efficiency_pct",
-                            efficiency_pct,
-                            "kernel_index",
-                            i);
-            }
+            if(timing)
+                timing->stop(*data.node, data.rocfft_stream);
 
 #ifdef REF_DEBUG
             refLibOp.VerifyResult(&data);
@@ -747,9 +705,4 @@ void TransformPowX(const ExecPlan&       execPlan,
                          execPlan.rootPlan->batch);
         *kernelio_stream << std::endl;
     }
-    if(emit_profile_log)
-    {
-        (void)hipEventDestroy(start);
-        (void)hipEventDestroy(stop);
-    }
 }
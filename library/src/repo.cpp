@@ -23,6 +23,7 @@
 #include <assert.h>
 #include <iostream>
 #include <numeric>
+#include <set>
 #include <vector>
 
 #include "logging.h"
@@ -37,134 +38,100 @@
 std::mutex        Repo::mtx;
 std::atomic<bool> Repo::repoDestroyed(false);
 
-template <typename KeyType>
-std::pair<void*, size_t>
-    Repo::GetTwiddlesInternal(KeyType                                             key,
-                              std::map<KeyType, std::pair<gpubuf, unsigned int>>& twiddles,
-                              std::map<void*, KeyType>&                           twiddles_reverse,
-                              std::function<gpubuf(unsigned int)>                 create_twiddle)
+std::vector<std::pair<void*, size_t>>
+    Repo::GetTwiddlesBatch(const std::vector<TwiddleTableSpec>& specs, const char* gpu_arch)
 {
+    std::lock_guard<std::mutex> lck(mtx);
     if(repoDestroyed)
     {
         throw std::runtime_error("Repo prematurely destroyed.");
     }
+    Repo& repo = Repo::GetRepo();
 
-    // see if the repo has already stored the plan or not
-    if(hipGetDevice(&key.deviceId) != hipSuccess)
+    int deviceId = 0;
+    if(hipGetDevice(&deviceId) != hipSuccess)
     {
         throw std::runtime_error("hipGetDevice failed.");
     }
 
-    auto it = twiddles.find(key);
-    if(it != twiddles.end())
+    // see which tables the repo doesn't have yet
+    std::vector<TwiddleTableSpec> missing;
+    std::set<TwiddleTableSpec>    missing_set;
+    for(const auto& spec : specs)
+    {
+        if(repo.twiddles.count({spec, deviceId}) == 0 && missing_set.insert(spec).second)
+            missing.push_back(spec);
+    }
+
+    // generate them all in one buffer
+    if(!missing.empty())
     {
-        // already had this length
-        it->second.second += 1;
-        return {it->second.first.data(), it->second.first.size()};
+        std::vector<std::pair<size_t, size_t>> tables;
+        auto buf = std::make_shared<gpubuf>(
+            twiddles_create_batch(missing, gpu_arch, deviceId, tables));
+        for(size_t i = 0; i < missing.size(); ++i)
+        {
+            // empty tables aren't stored
+            if(tables[i].second == 0)
+                continue;
+            repo_key_t key{missing[i], deviceId};
+            void*      data = static_cast<char*>(buf->data()) + tables[i].first;
+            repo.twiddles.insert({key, {buf, data, tables[i].second, 0}});
+            repo.twiddles_reverse.insert({data, key});
+        }
     }
 
-    // otherwise, need to allocate
-    auto buf = create_twiddle(key.deviceId);
-    // if allocation failed, don't update maps
-    if(buf.data() == nullptr)
-        return {nullptr, 0};
-    it = twiddles.insert({key, std::make_pair(std::move(buf), 1)}).first;
-    twiddles_reverse.insert({it->second.first.data(), key});
-    return {it->second.first.data(), it->second.first.size()};
+    std::vector<std::pair<void*, size_t>> ret;
+    for(const auto& spec : specs)
+    {
+        auto it = repo.twiddles.find({spec, deviceId});
+        if(it == repo.twiddles.end())
+        {
+            ret.emplace_back(nullptr, 0);
+            continue;
+        }
+        it->second.refs += 1;
+        ret.emplace_back(it->second.data, it->second.size);
+    }
+    return ret;
 }
 
-template <typename KeyType>
-void Repo::ReleaseTwiddlesInternal(void*                                               ptr,
-                                   std::map<KeyType, std::pair<gpubuf, unsigned int>>& twiddles,
-                                   std::map<void*, KeyType>& twiddles_reverse)
+void Repo::ReleaseTwiddles(void* ptr)
 {
+    std::lock_guard<std::mutex> lck(mtx);
     if(repoDestroyed)
     {
         throw std::runtime_error("Repo prematurely destroyed.");
     }
+    Repo& repo = Repo::GetRepo();
 
-    auto reverse_it = twiddles_reverse.find(ptr);
-    if(reverse_it == twiddles_reverse.end())
+    auto reverse_it = repo.twiddles_reverse.find(ptr);
+    if(reverse_it == repo.twiddles_reverse.end())
         return;
-    auto forward_it = twiddles.find(reverse_it->second);
-    if(forward_it == twiddles.end())
+    auto forward_it = repo.twiddles.find(reverse_it->second);
+    if(forward_it == repo.twiddles.end())
     {
         // orphaned reverse entry?
-        twiddles_reverse.erase(reverse_it);
+        repo.twiddles_reverse.erase(reverse_it);
         return;
     }
-    forward_it->second.second -= 1;
-    if(forward_it->second.second == 0)
+    forward_it->second.refs -= 1;
+    if(forward_it->second.refs == 0)
     {
-        // remove from both maps
-        twiddles.erase(forward_it);
-        twiddles_reverse.erase(reverse_it);
+        // remove from both maps.  the buffer is freed when its last
+        // table is removed.
+        repo.twiddles.erase(forward_it);
+        repo.twiddles_reverse.erase(reverse_it);
     }
 }
 
-std::pair<void*, size_t> Repo::GetTwiddles1D(size_t                     length,
-                                             size_t                     length_limit,
-                                             rocfft_precision           precision,
-                                             const char*                gpu_arch,
-                                             size_t                     largeTwdBase,
-                                             bool                       attach_halfN,
-                                             const std::vector<size_t>& radices)
-{
-    std::lock_guard<std::mutex> lck(mtx);
-    Repo&                       repo = Repo::GetRepo();
-
-    repo_key_1D_t key{length, length_limit, precision, largeTwdBase, attach_halfN, radices};
-    return GetTwiddlesInternal(
-        key, repo.twiddles_1D, repo.twiddles_1D_reverse, [&](unsigned int deviceId) {
-            return twiddles_create(length,
-                                   length_limit,
-                                   precision,
-                                   gpu_arch,
-                                   largeTwdBase,
-                                   attach_halfN,
-                                   radices,
-                                   deviceId);
-        });
-}
-
-std::pair<void*, size_t> Repo::GetTwiddles2D(size_t           length0,
-                                             size_t           length1,
-                                             rocfft_precision precision,
-                                             const char*      gpu_arch)
-{
-    std::lock_guard<std::mutex> lck(mtx);
-    Repo&                       repo = Repo::GetRepo();
-
-    repo_key_2D_t key{length0, length1, precision};
-    return GetTwiddlesInternal(
-        key, repo.twiddles_2D, repo.twiddles_2D_reverse, [&](unsigned int deviceId) {
-            return twiddles_create_2D(length0, length1, precision, gpu_arch, deviceId);
-        });
-}
-
-void Repo::ReleaseTwiddle1D(void* ptr)
-{
-    std::lock_guard<std::mutex> lck(mtx);
-
-    Repo& repo = Repo::GetRepo();
-    return ReleaseTwiddlesInternal(ptr, repo.twiddles_1D, repo.twiddles_1D_reverse);
-}
-
-void Repo::ReleaseTwiddle2D(void* ptr)
-{
-    std::lock_guard<std::mutex> lck(mtx);
-
-    Repo& repo = Repo::GetRepo();
-    return ReleaseTwiddlesInternal(ptr, repo.twiddles_2D, repo.twiddles_2D_reverse);
-}
-
 void Repo::Clear()
 {
     std::lock_guard<std::mutex> lck(mtx);
     if(repoDestroyed)
         return;
     Repo& repo = Repo::GetRepo();
-    repo.twiddles_1D.clear();
-    repo.twiddles_2D.clear();
+    repo.twiddles.clear();
+    repo.twiddles_reverse.clear();
     twiddle_streams_cleanup();
 }
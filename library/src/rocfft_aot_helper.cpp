@@ -18,8 +18,12 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <numeric>
 #include <thread>
 
 using namespace std::placeholders;
@@ -27,8 +31,10 @@ using namespace std::placeholders;
 #include "../../shared/concurrency.h"
 #include "../../shared/environment.h"
 #include "../../shared/work_queue.h"
+#include "event_trace.h"
 #include "function_pool.h"
 #include "rtc_cache.h"
+#include "rtc_compile.h"
 #include "rtc_realcomplex_gen.h"
 #include "rtc_stockham_gen.h"
 #include "rtc_twiddle_gen.h"
@@ -218,7 +224,7 @@ void stockham_combo(ComputeScheme             scheme,
     }
 }
 
-void build_stockham_function_pool(CompileQueue& queue)
+void build_stockham_function_pool(std::vector<WorkItem>& items)
 {
     // build everything in the function pool
     function_pool& fp = function_pool::get_function_pool();
@@ -226,7 +232,7 @@ void build_stockham_function_pool(CompileQueue& queue)
     // scaling Stockham kernels are always built at runtime
     const bool enable_scaling = false;
 
-    for(const auto& i : fp.get_map())
+    for(const auto& i : fp.get_all_kernels())
     {
         // we only want to compile kernels explicitly marked for AOT RTC
         if(!i.second.aot_rtc)
@@ -241,7 +247,7 @@ void build_stockham_function_pool(CompileQueue& queue)
 
         stockham_combo(scheme,
                        i.second,
-                       [=, &queue](int                     direction,
+                       [=, &items](int                     direction,
                                    rocfft_result_placement placement,
                                    rocfft_array_type       inArrayType,
                                    rocfft_array_type       outArrayType,
@@ -273,25 +279,28 @@ void build_stockham_function_pool(CompileQueue& queue)
                                    return;
                            }
 
-                           auto kernel_name = stockham_rtc_kernel_name(scheme,
-                                                                       length1D,
-                                                                       0,
-                                                                       0,
-                                                                       direction,
-                                                                       precision,
-                                                                       placement,
-                                                                       inArrayType,
-                                                                       outArrayType,
-                                                                       unitstride,
-                                                                       ltwd_base,
-                                                                       ltwd_step,
-                                                                       false,
-                                                                       ebtype,
-                                                                       dir_reg_type,
-                                                                       intrinsic,
-                                                                       sbrc_trans_type,
-                                                                       callbacks,
-                                                                       enable_scaling);
+                           auto kernel_name = stockham_rtc_kernel_name(
+                               scheme,
+                               length1D,
+                               0,
+                               0,
+                               0,
+                               direction,
+                               precision,
+                               rocfft_storage_precision_native,
+                               placement,
+                               inArrayType,
+                               outArrayType,
+                               unitstride,
+                               ltwd_base,
+                               ltwd_step,
+                               false,
+                               ebtype,
+                               dir_reg_type,
+                               intrinsic,
+                               sbrc_trans_type,
+                               callbacks,
+                               enable_scaling);
                            std::function<std::string(const std::string&)> generate_src
                                = [=](const std::string& kernel_name) -> std::string {
                                StockhamGeneratorSpecs specs{
@@ -303,13 +312,16 @@ void build_stockham_function_pool(CompileQueue& queue)
                                specs.threads_per_transform = i.second.threads_per_transform[0];
                                specs.half_lds              = i.second.half_lds;
                                specs.direct_to_from_reg    = i.second.direct_to_from_reg;
+                               specs.cross_lane_exchange   = i.second.cross_lane_exchange;
                                return stockham_rtc(specs,
+                                                   specs,
                                                    specs,
                                                    nullptr,
                                                    kernel_name,
                                                    scheme,
                                                    direction,
                                                    precision,
+                                                   rocfft_storage_precision_native,
                                                    placement,
                                                    inArrayType,
                                                    outArrayType,
@@ -324,12 +336,12 @@ void build_stockham_function_pool(CompileQueue& queue)
                                                    callbacks,
                                                    enable_scaling);
                            };
-                           queue.push({kernel_name, generate_src});
+                           items.push_back({kernel_name, generate_src});
                        });
     }
 }
 
-void build_realcomplex(CompileQueue& queue)
+void build_realcomplex(std::vector<WorkItem>& items)
 {
     for(auto precision : {rocfft_precision_single, rocfft_precision_double})
     {
@@ -358,6 +370,7 @@ void build_realcomplex(CompileQueue& queue)
                             RealComplexEvenSpecs specs{{scheme,
                                                         dim,
                                                         precision,
+                                                        rocfft_storage_precision_native,
                                                         inArrayType,
                                                         outArrayType,
                                                         enable_callbacks,
@@ -368,7 +381,7 @@ void build_realcomplex(CompileQueue& queue)
                                 = [=](const std::string& kernel_name) -> std::string {
                                 return realcomplex_even_rtc(kernel_name, specs);
                             };
-                            queue.push({kernel_name, generate_src});
+                            items.push_back({kernel_name, generate_src});
                         }
                     }
                 }
@@ -386,6 +399,7 @@ void build_realcomplex(CompileQueue& queue)
                 RealComplexEvenTransposeSpecs specs{{scheme,
                                                      static_cast<size_t>(1),
                                                      precision,
+                                                     rocfft_storage_precision_native,
                                                      inArrayType,
                                                      outArrayType,
                                                      false,
@@ -395,13 +409,13 @@ void build_realcomplex(CompileQueue& queue)
                     = [=](const std::string& kernel_name) -> std::string {
                     return realcomplex_even_transpose_rtc(kernel_name, specs);
                 };
-                queue.push({kernel_name, generate_src});
+                items.push_back({kernel_name, generate_src});
             }
         }
     }
 }
 
-void build_apply_callback(CompileQueue& queue)
+void build_apply_callback(std::vector<WorkItem>& items)
 {
     for(auto precision : {rocfft_precision_single, rocfft_precision_double})
     {
@@ -410,11 +424,11 @@ void build_apply_callback(CompileQueue& queue)
             = [=](const std::string& kernel_name) -> std::string {
             return apply_callback_rtc(kernel_name, precision);
         };
-        queue.push({kernel_name, generate_src});
+        items.push_back({kernel_name, generate_src});
     }
 }
 
-void build_twiddle(CompileQueue& queue)
+void build_twiddle(std::vector<WorkItem>& items)
 {
     const auto twiddle_kernel_types = {
         TwiddleTableType::RADICES,
@@ -431,7 +445,7 @@ void build_twiddle(CompileQueue& queue)
                 = [=](const std::string& kernel_name) -> std::string {
                 return twiddle_rtc(kernel_name, type, precision);
             };
-            queue.push({kernel_name, generate_src});
+            items.push_back({kernel_name, generate_src});
         }
     }
 }
@@ -469,13 +483,79 @@ int main(int argc, char** argv)
     // tell RTC where the compile helper is
     rocfft_setenv("ROCFFT_RTC_PROCESS_HELPER", rtc_helper.c_str());
 
+    // the temporary cache is trimmed explicitly once everything is
+    // compiled, so don't trim it in the background while compiling
+    rocfft_setenv("ROCFFT_RTC_CACHE_MAX_SIZE", "0");
+
+    // record compiles and cache hits if ROCFFT_LAYER asks for events
+    event_trace_helper_setup();
+
     RTCCache::single = std::make_unique<RTCCache>();
 
     RTCCache::single->enable_write_mostly();
 
+    std::vector<WorkItem> items;
+    build_stockham_function_pool(items);
+    build_realcomplex(items);
+    build_apply_callback(items);
+    build_twiddle(items);
+
+    // kernels whose source hasn't changed since they were last
+    // compiled for every arch are just copied in the cache, so only
+    // the changed kernels take real time.  of those, start the
+    // longest compiles first so they don't all end up at the tail of
+    // the build.  kernels we've never compiled before have no known
+    // duration, so assume the worst and do them first as well.
+    //
+    // finding the unchanged kernels means generating their source
+    // here as well as when compiling, which is cheap next to
+    // compiling them.
+    static const size_t NUM_THREADS = rocfft_concurrency();
+
+    const auto durations = RTCCache::single->get_compile_durations();
+    const auto compiled  = RTCCache::single->get_compiled_sources(gpu_archs);
+    const auto signature = compile_signature();
+
+    std::vector<sqlite3_int64> costs(items.size());
+    {
+        std::atomic<size_t>      next_item{0};
+        std::vector<std::thread> threads;
+        threads.reserve(NUM_THREADS);
+        for(size_t i = 0; i < NUM_THREADS; ++i)
+        {
+            threads.emplace_back([&]() {
+                for(size_t j = next_item++; j < items.size(); j = next_item++)
+                {
+                    // generate with a copy, so the item doesn't hold
+                    // on to the source until it's compiled
+                    auto generate_src = items[j].generate_src;
+                    auto source_sum
+                        = rtc_source_sum(generate_src(items[j].kernel_name), signature);
+                    if(compiled.count(std::make_pair(items[j].kernel_name, source_sum)))
+                        costs[j] = 0;
+                    else
+                    {
+                        auto d   = durations.find(items[j].kernel_name);
+                        costs[j] = d == durations.end() ? std::numeric_limits<sqlite3_int64>::max()
+                                                        : d->second;
+                    }
+                }
+            });
+        }
+        for(auto& t : threads)
+            t.join();
+    }
+
+    std::vector<size_t> order(items.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&costs](size_t a, size_t b) {
+        return costs[a] > costs[b];
+    });
+
     CompileQueue queue;
+    for(auto i : order)
+        queue.push(std::move(items[i]));
 
-    static const size_t      NUM_THREADS = rocfft_concurrency();
     std::vector<std::thread> threads;
     threads.reserve(NUM_THREADS);
     for(size_t i = 0; i < NUM_THREADS; ++i)
@@ -492,11 +572,6 @@ int main(int argc, char** argv)
         });
     }
 
-    build_stockham_function_pool(queue);
-    build_realcomplex(queue);
-    build_apply_callback(queue);
-    build_twiddle(queue);
-
     // signal end of results with empty work items
     for(size_t i = 0; i < NUM_THREADS; ++i)
         queue.push({});
@@ -520,5 +595,6 @@ int main(int argc, char** argv)
 
     RTCCache::single.reset();
 
+    event_trace_cleanup();
     return 0;
 }
@@ -22,6 +22,7 @@
 #include "../../shared/gpubuf.h"
 #include "device/generator/stockham_gen.h"
 #include "rtc_compile.h"
+#include "rtc_stockham_config.h"
 #include "rtc_stockham_gen.h"
 #include "rtc_stockham_kernel.h"
 
@@ -29,41 +30,8 @@
 #include <random>
 #include <set>
 
-static const std::vector<unsigned int> supported_factors
-    = {2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 16, 17};
 static const std::vector<unsigned int> supported_wgs{64, 128, 256};
 
-// recursively find all unique factorizations of given length.  each
-// factorization is a vector of ints, sorted so they're uniquified in
-// a set.
-std::set<std::vector<unsigned int>> factorize(unsigned int length)
-{
-    std::set<std::vector<unsigned int>> ret;
-    for(auto factor : supported_factors)
-    {
-        if(length % factor == 0)
-        {
-            unsigned int remain = length / factor;
-            if(remain == 1)
-                ret.insert({factor});
-            else
-            {
-                // recurse into remainder
-                auto remain_factorization = factorize(remain);
-                for(auto& remain_factors : remain_factorization)
-                {
-                    std::vector<unsigned int> factors{factor};
-                    std::copy(
-                        remain_factors.begin(), remain_factors.end(), std::back_inserter(factors));
-                    std::sort(factors.begin(), factors.end());
-                    ret.insert(factors);
-                }
-            }
-        }
-    }
-    return ret;
-}
-
 // recursively return power set of a range of ints
 std::set<std::vector<unsigned int>> power_set(std::vector<unsigned int>::const_iterator begin,
                                               std::vector<unsigned int>::const_iterator end)
@@ -150,12 +118,14 @@ std::string test_kernel_src(const std::string&               kernel_name,
     specs.direct_to_from_reg    = direct_to_from_reg;
 
     return stockham_rtc(specs,
+                        specs,
                         specs,
                         &transforms_per_block,
                         kernel_name,
                         CS_KERNEL_STOCKHAM,
                         -1,
                         rocfft_precision_single,
+                        rocfft_storage_precision_native,
                         rocfft_placement_notinplace,
                         rocfft_array_type_complex_interleaved,
                         rocfft_array_type_complex_interleaved,
@@ -18,7 +18,9 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include "event_trace.h"
 #include "rtc_compile.h"
+#include <chrono>
 #include <iostream>
 #include <iterator>
 
@@ -27,13 +29,8 @@
 #include <io.h>
 #endif
 
-int main(int argc, const char* const* argv)
+static int run(int argc, const char* const* argv)
 {
-#ifdef WIN32
-    // stdout on Windows defaults to text mode and will mangle our code objects
-    _setmode(_fileno(stdout), _O_BINARY);
-#endif
-
     try
     {
         if(argc != 2)
@@ -53,7 +50,14 @@ int main(int argc, const char* const* argv)
                   std::back_inserter(kernel_src));
 
         // compile and write code object to stdout
-        auto code = compile_inprocess(kernel_src, gpu_arch);
+        auto compile_begin = std::chrono::steady_clock::now();
+        auto code          = compile_inprocess(kernel_src, gpu_arch);
+        trace_complete(TraceEvent::RTC_COMPILE,
+                       "rocfft_rtc_helper " + gpu_arch,
+                       compile_begin,
+                       std::chrono::steady_clock::now(),
+                       kernel_src.size(),
+                       code.size());
         std::cout.write(code.data(), code.size());
         std::cout.flush();
         if(!std::cout.good())
@@ -69,3 +73,16 @@ int main(int argc, const char* const* argv)
         return 1;
     }
 }
+
+int main(int argc, const char* const* argv)
+{
+#ifdef WIN32
+    // stdout on Windows defaults to text mode and will mangle our code objects
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    event_trace_helper_setup();
+    int ret = run(argc, argv);
+    event_trace_cleanup();
+    return ret;
+}
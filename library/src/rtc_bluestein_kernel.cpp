@@ -36,6 +36,9 @@ RTCKernel::RTCGenerator RTCKernelBluesteinSingle::generate_from_node(const TreeN
     if(node.scheme != CS_KERNEL_BLUESTEIN_SINGLE)
         return generator;
 
+    if(node.storage != rocfft_storage_precision_native)
+        throw std::runtime_error("Bluestein does not support mixed-precision storage");
+
     auto lengthBlue = node.lengthBlue;
 
     // find kernel config from function pool
@@ -141,6 +144,9 @@ RTCKernel::RTCGenerator RTCKernelBluesteinMulti::generate_from_node(const TreeNo
        && node.scheme != CS_KERNEL_FFT_MUL && node.scheme != CS_KERNEL_RES_MUL)
         return generator;
 
+    if(node.storage != rocfft_storage_precision_native)
+        throw std::runtime_error("Bluestein does not support mixed-precision storage");
+
     size_t N = node.length[0];
     size_t M = node.lengthBlue;
 
@@ -20,6 +20,7 @@
 
 #include "../../shared/environment.h"
 
+#include "event_trace.h"
 #include "library_path.h"
 #include "logging.h"
 #include "rtc_cache.h"
@@ -27,15 +28,63 @@
 #include "rtc_subprocess.h"
 #include "sqlite3.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
 #include <hip/hip_version.h>
 #include <hip/hiprtc.h>
 #include <mutex>
+#include <string_view>
+#include <tuple>
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace fs = std::filesystem;
 
 std::unique_ptr<RTCCache> RTCCache::single;
 
+// opening the caches is deferred until a kernel is actually needed,
+// since many processes never need one, or get everything from the
+// in-memory repo
+static std::mutex single_mutex;
+static bool       single_enabled = false;
+
+void RTCCache::setup()
+{
+    std::lock_guard<std::mutex> lock(single_mutex);
+    single_enabled = true;
+}
+
+void RTCCache::cleanup()
+{
+    std::lock_guard<std::mutex> lock(single_mutex);
+    single_enabled = false;
+    single.reset();
+}
+
+RTCCache* RTCCache::get()
+{
+    std::lock_guard<std::mutex> lock(single_mutex);
+    if(!single && single_enabled)
+    {
+        StartupTimer timer("rtc_cache_open");
+        single = std::make_unique<RTCCache>();
+    }
+    return single.get();
+}
+
 static const char* default_cache_filename = "rocfft_kernel_cache.db";
 
 // Lock for in-process compilation - due to limits in ROCclr, we
@@ -77,6 +126,212 @@ static std::vector<fs::path> rtccache_db_user_paths()
     return paths;
 }
 
+static std::string gpu_arch_strip_flags(const std::string gpu_arch_with_flags)
+{
+    return gpu_arch_with_flags.substr(0, gpu_arch_with_flags.find(':'));
+}
+
+// On-disk layout of an AOTCacheFile.  All offsets are from the start
+// of the file.  The file is only ever read on the kind of machine
+// that wrote it, so fields are in native byte order.
+static const char     aot_cache_magic[8] = {'R', 'O', 'C', 'F', 'F', 'T', 'K', 'C'};
+static const uint32_t aot_cache_version  = 1;
+
+struct AOTCacheHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t entry_count;
+};
+
+// one index entry per kernel, sorted by key
+struct AOTCacheEntry
+{
+    uint64_t kernel_name_offset;
+    uint64_t arch_offset;
+    uint64_t code_offset;
+    uint64_t code_bytes;
+    int64_t  hip_version;
+    uint32_t kernel_name_bytes;
+    uint32_t arch_bytes;
+    char     generator_sum[32];
+};
+static_assert(sizeof(AOTCacheHeader) == 16, "AOTCacheHeader must not be padded");
+static_assert(sizeof(AOTCacheEntry) == 80, "AOTCacheEntry must not be padded");
+
+// key that entries are sorted by: kernel_name, arch, hip_version,
+// generator_sum
+typedef std::tuple<std::string_view, std::string_view, int64_t, std::string_view> AOTCacheKey;
+
+static AOTCacheKey aot_cache_key(const char* data, const AOTCacheEntry& e)
+{
+    return {std::string_view(data + e.kernel_name_offset, e.kernel_name_bytes),
+            std::string_view(data + e.arch_offset, e.arch_bytes),
+            e.hip_version,
+            std::string_view(e.generator_sum, sizeof(e.generator_sum))};
+}
+
+std::unique_ptr<AOTCacheFile> AOTCacheFile::open(const fs::path& path)
+{
+    std::unique_ptr<AOTCacheFile> file(new AOTCacheFile);
+#ifdef WIN32
+    HANDLE handle = CreateFileA(path.string().c_str(),
+                                GENERIC_READ,
+                                FILE_SHARE_READ,
+                                nullptr,
+                                OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL,
+                                nullptr);
+    if(handle == INVALID_HANDLE_VALUE)
+        return nullptr;
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(handle, &file_size)
+       || static_cast<size_t>(file_size.QuadPart) < sizeof(AOTCacheHeader))
+    {
+        CloseHandle(handle);
+        return nullptr;
+    }
+    file->mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    // the mapping keeps the file open
+    CloseHandle(handle);
+    if(!file->mapping)
+        return nullptr;
+    file->data = static_cast<const char*>(MapViewOfFile(file->mapping, FILE_MAP_READ, 0, 0, 0));
+    if(!file->data)
+        return nullptr;
+    file->size = file_size.QuadPart;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return nullptr;
+    struct stat st;
+    if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)
+       || static_cast<size_t>(st.st_size) < sizeof(AOTCacheHeader))
+    {
+        close(fd);
+        return nullptr;
+    }
+    void* ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping keeps the file open
+    close(fd);
+    if(ptr == MAP_FAILED)
+        return nullptr;
+    file->data = static_cast<const char*>(ptr);
+    file->size = st.st_size;
+#endif
+    if(!file->valid())
+        return nullptr;
+    return file;
+}
+
+AOTCacheFile::~AOTCacheFile()
+{
+#ifdef WIN32
+    if(data)
+        UnmapViewOfFile(data);
+    if(mapping)
+        CloseHandle(mapping);
+#else
+    if(data)
+        munmap(const_cast<char*>(data), size);
+#endif
+}
+
+bool AOTCacheFile::valid() const
+{
+    AOTCacheHeader header;
+    memcpy(&header, data, sizeof(header));
+    if(memcmp(header.magic, aot_cache_magic, sizeof(aot_cache_magic)) != 0
+       || header.version != aot_cache_version)
+        return false;
+
+    if(header.entry_count > (size - sizeof(AOTCacheHeader)) / sizeof(AOTCacheEntry))
+        return false;
+    auto entries = reinterpret_cast<const AOTCacheEntry*>(data + sizeof(AOTCacheHeader));
+
+    auto in_file = [this](uint64_t offset, uint64_t bytes) {
+        return offset <= size && bytes <= size - offset;
+    };
+    for(uint32_t i = 0; i < header.entry_count; ++i)
+    {
+        const auto& e = entries[i];
+        if(!in_file(e.kernel_name_offset, e.kernel_name_bytes)
+           || !in_file(e.arch_offset, e.arch_bytes) || !in_file(e.code_offset, e.code_bytes))
+            return false;
+    }
+    return true;
+}
+
+const char* AOTCacheFile::find(const std::string&          kernel_name,
+                               const std::string&          gpu_arch,
+                               int64_t                     hip_version,
+                               const std::array<char, 32>& generator_sum,
+                               size_t&                     code_bytes) const
+{
+    AOTCacheHeader header;
+    memcpy(&header, data, sizeof(header));
+    auto entries_begin = reinterpret_cast<const AOTCacheEntry*>(data + sizeof(AOTCacheHeader));
+    auto entries_end   = entries_begin + header.entry_count;
+
+    AOTCacheKey key{kernel_name,
+                    gpu_arch,
+                    hip_version,
+                    std::string_view(generator_sum.data(), generator_sum.size())};
+
+    auto e = std::lower_bound(
+        entries_begin, entries_end, key, [this](const AOTCacheEntry& entry, const AOTCacheKey& k) {
+            return aot_cache_key(data, entry) < k;
+        });
+    if(e == entries_end || aot_cache_key(data, *e) != key)
+        return nullptr;
+    code_bytes = e->code_bytes;
+    return data + e->code_offset;
+}
+
+std::unique_ptr<RTCCompileLock> RTCCompileLock::acquire(const fs::path& lock_path)
+{
+    std::unique_ptr<RTCCompileLock> lock(new RTCCompileLock);
+#ifdef WIN32
+    HANDLE handle = CreateFileA(lock_path.string().c_str(),
+                                GENERIC_READ | GENERIC_WRITE,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                nullptr,
+                                OPEN_ALWAYS,
+                                FILE_ATTRIBUTE_NORMAL,
+                                nullptr);
+    if(handle == INVALID_HANDLE_VALUE)
+        return nullptr;
+    lock->handle          = handle;
+    OVERLAPPED overlapped = {};
+    if(!LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped))
+        return nullptr;
+#else
+    lock->fd = ::open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    if(lock->fd < 0)
+        return nullptr;
+    // flock locks belong to the open file, so threads of one process
+    // exclude each other too
+    int ret;
+    while((ret = flock(lock->fd, LOCK_EX)) != 0 && errno == EINTR)
+        ;
+    if(ret != 0)
+        return nullptr;
+#endif
+    return lock;
+}
+
+RTCCompileLock::~RTCCompileLock()
+{
+    // closing the file releases the lock
+#ifdef WIN32
+    if(handle)
+        CloseHandle(handle);
+#else
+    if(fd >= 0)
+        close(fd);
+#endif
+}
+
 static sqlite3_stmt_ptr prepare_stmt(sqlite3_ptr& db, const char* sql)
 {
     sqlite3_stmt* stmt = nullptr;
@@ -98,10 +353,12 @@ sqlite3_ptr RTCCache::connect_db(const fs::path& path, bool readonly)
         // open in-memory
         flags |= SQLITE_OPEN_MEMORY;
     }
-    if(sqlite3_open_v2(path.string().c_str(), &db_raw, flags, nullptr) != SQLITE_OK)
-        return nullptr;
-
+    int rc = sqlite3_open_v2(path.string().c_str(), &db_raw, flags, nullptr);
+    // sqlite allocates a handle even if the open fails, and it
+    // still needs to be closed
     sqlite3_ptr db(db_raw);
+    if(rc != SQLITE_OK)
+        return nullptr;
 
     // we can potentially want to write a bunch of kernels in
     // parallel (when doing mass compilation).  set a bigger busy
@@ -125,6 +382,41 @@ sqlite3_ptr RTCCache::connect_db(const fs::path& path, bool readonly)
                                    "      ))");
         if(sqlite3_step(create.get()) != SQLITE_DONE)
             return nullptr;
+
+        // checksums of the source that each kernel was compiled
+        // from, so a kernel whose source didn't change can be reused
+        // when the generator sum changes.  also remember how long
+        // each kernel took to compile.
+        auto create_source = prepare_stmt(db,
+                                          "CREATE TABLE IF NOT EXISTS source_v1 ("
+                                          "  kernel_name TEXT NOT NULL,"
+                                          "  arch TEXT NOT NULL,"
+                                          "  hip_version INTEGER NOT NULL,"
+                                          "  generator_sum BLOB NOT NULL,"
+                                          "  source_sum INTEGER NOT NULL,"
+                                          "  compile_ms INTEGER NOT NULL,"
+                                          "  PRIMARY KEY ("
+                                          "      kernel_name, arch, hip_version, generator_sum"
+                                          "      ))");
+        if(sqlite3_step(create_source.get()) != SQLITE_DONE)
+            return nullptr;
+
+        // how many times each kernel has been used and when it was
+        // last used, to decide what to remove when the cache gets
+        // too big
+        auto create_usage = prepare_stmt(db,
+                                         "CREATE TABLE IF NOT EXISTS usage_v1 ("
+                                         "  kernel_name TEXT NOT NULL,"
+                                         "  arch TEXT NOT NULL,"
+                                         "  hip_version INTEGER NOT NULL,"
+                                         "  generator_sum BLOB NOT NULL,"
+                                         "  use_count INTEGER NOT NULL,"
+                                         "  last_used INTEGER NOT NULL,"
+                                         "  PRIMARY KEY ("
+                                         "      kernel_name, arch, hip_version, generator_sum"
+                                         "      ))");
+        if(sqlite3_step(create_usage.get()) != SQLITE_DONE)
+            return nullptr;
     }
 
     return db;
@@ -132,16 +424,42 @@ sqlite3_ptr RTCCache::connect_db(const fs::path& path, bool readonly)
 
 RTCCache::RTCCache()
 {
+    // the system cache is normally an AOTCacheFile, but could also
+    // be a database (e.g. a user cache that's been copied somewhere
+    // and pointed to by ROCFFT_RTC_SYS_CACHE_PATH)
     auto sys_path = rtccache_db_sys_path();
     if(!sys_path.empty())
-        db_sys = connect_db(sys_path, true);
+    {
+        aot_sys = AOTCacheFile::open(sys_path);
+        if(!aot_sys)
+            db_sys = connect_db(sys_path, true);
+    }
 
     auto paths = rtccache_db_user_paths();
     for(const auto& p : paths)
     {
         db_user = connect_db(p, false);
         if(db_user)
+        {
+            if(!p.empty() && p != ":memory:")
+                user_path = p;
             break;
+        }
+    }
+
+    // size budget for the user cache, in bytes
+    max_size_bytes = 1024 * 1024 * 1024;
+    auto max_size  = rocfft_getenv("ROCFFT_RTC_CACHE_MAX_SIZE");
+    if(!max_size.empty())
+    {
+        try
+        {
+            max_size_bytes = std::stoll(max_size);
+        }
+        catch(std::exception&)
+        {
+            // ignore unparseable values and keep the default
+        }
     }
 
     static const char* get_stmt_text = "SELECT code "
@@ -169,6 +487,35 @@ RTCCache::RTCCache()
                                          "    CAST(STRFTIME('%s','now') AS INTEGER)"
                                          ")";
 
+    static const char* store_source_stmt_text = "INSERT OR REPLACE INTO source_v1 ("
+                                                "    kernel_name,"
+                                                "    arch,"
+                                                "    hip_version,"
+                                                "    generator_sum,"
+                                                "    source_sum,"
+                                                "    compile_ms"
+                                                ")"
+                                                "VALUES ("
+                                                "    :kernel_name,"
+                                                "    :arch,"
+                                                "    :hip_version,"
+                                                "    :generator_sum,"
+                                                "    :source_sum,"
+                                                "    :compile_ms"
+                                                ")";
+
+    static const char* get_source_stmt_text = "SELECT cache_v1.code, source_v1.compile_ms "
+                                              "FROM source_v1 "
+                                              "INNER JOIN cache_v1 USING ("
+                                              "    kernel_name, arch, hip_version, generator_sum"
+                                              "    ) "
+                                              "WHERE"
+                                              "  kernel_name = :kernel_name "
+                                              "  AND arch = :arch "
+                                              "  AND hip_version = :hip_version "
+                                              "  AND source_sum = :source_sum "
+                                              "LIMIT 1";
+
     // prepare get/store statements once so they can be called many
     // times
     if(db_sys)
@@ -186,8 +533,27 @@ RTCCache::RTCCache()
     }
     if(db_user)
     {
-        get_stmt_user   = prepare_stmt(db_user, get_stmt_text);
-        store_stmt_user = prepare_stmt(db_user, store_stmt_text);
+        get_stmt_user          = prepare_stmt(db_user, get_stmt_text);
+        store_stmt_user        = prepare_stmt(db_user, store_stmt_text);
+        store_source_stmt_user = prepare_stmt(db_user, store_source_stmt_text);
+        get_source_stmt_user   = prepare_stmt(db_user, get_source_stmt_text);
+    }
+}
+
+RTCCache::~RTCCache()
+{
+    try
+    {
+        {
+            std::lock_guard<std::mutex> lock(trim_mutex);
+            if(trim_future.valid())
+                trim_future.wait();
+        }
+        flush_uses();
+    }
+    catch(std::exception&)
+    {
+        // usage is only a hint for trimming, so it's ok to lose it
     }
 }
 
@@ -200,10 +566,6 @@ static std::vector<char> get_code_object_impl(const std::string&          kernel
 {
     std::vector<char> code;
 
-    // allow env variable to disable reads
-    if(!rocfft_getenv("ROCFFT_RTC_CACHE_READ_DISABLE").empty())
-        return code;
-
     std::lock_guard<std::mutex> lock(get_mutex);
 
     auto s = get_stmt.get();
@@ -235,27 +597,83 @@ std::vector<char> RTCCache::get_code_object(const std::string&          kernel_n
                                             const std::array<char, 32>& generator_sum)
 {
     std::vector<char> code;
+
+    // allow env variable to disable reads
+    if(!rocfft_getenv("ROCFFT_RTC_CACHE_READ_DISABLE").empty())
+        return code;
+
     // try user cache first
     if(get_stmt_user)
+    {
         code = get_code_object_impl(
             kernel_name, gpu_arch, generator_sum, db_user, get_stmt_user, get_mutex_user);
+        if(!code.empty())
+            record_use(kernel_name, gpu_arch, generator_sum);
+    }
     // fall back to system cache
+    if(code.empty() && aot_sys)
+    {
+        size_t      code_bytes = 0;
+        const char* aot_code
+            = aot_sys->find(kernel_name, gpu_arch, HIP_VERSION, generator_sum, code_bytes);
+        if(aot_code)
+            code.assign(aot_code, aot_code + code_bytes);
+    }
     if(code.empty() && get_stmt_sys)
         code = get_code_object_impl(
             kernel_name, gpu_arch, generator_sum, db_sys, get_stmt_sys, get_mutex_sys);
     return code;
 }
 
+std::vector<char> RTCCache::get_code_object_by_source(const std::string& kernel_name,
+                                                      const std::string& gpu_arch,
+                                                      sqlite3_int64      source_sum,
+                                                      sqlite3_int64&     compile_ms)
+{
+    std::vector<char> code;
+
+    // allow env variable to disable reads
+    if(!get_source_stmt_user || !rocfft_getenv("ROCFFT_RTC_CACHE_READ_DISABLE").empty())
+        return code;
+
+    std::lock_guard<std::mutex> lock(get_source_mutex_user);
+
+    auto s = get_source_stmt_user.get();
+    sqlite3_reset(s);
+
+    // bind arguments to the query and execute
+    if(sqlite3_bind_text(s, 1, kernel_name.c_str(), kernel_name.size(), SQLITE_TRANSIENT)
+           != SQLITE_OK
+       || sqlite3_bind_text(s, 2, gpu_arch.c_str(), gpu_arch.size(), SQLITE_TRANSIENT) != SQLITE_OK
+       || sqlite3_bind_int64(s, 3, HIP_VERSION) != SQLITE_OK
+       || sqlite3_bind_int64(s, 4, source_sum) != SQLITE_OK)
+    {
+        throw std::runtime_error(std::string("get_code_object_by_source bind: ")
+                                 + sqlite3_errmsg(db_user.get()));
+    }
+    if(sqlite3_step(s) == SQLITE_ROW)
+    {
+        int         nbytes = sqlite3_column_bytes(s, 0);
+        const char* data   = static_cast<const char*>(sqlite3_column_blob(s, 0));
+        std::copy(data, data + nbytes, std::back_inserter(code));
+        compile_ms = sqlite3_column_int64(s, 1);
+    }
+    sqlite3_reset(s);
+    return code;
+}
+
 void RTCCache::store_code_object(const std::string&          kernel_name,
                                  const std::string&          gpu_arch,
                                  const std::array<char, 32>& generator_sum,
-                                 const std::vector<char>&    code)
+                                 const std::vector<char>&    code,
+                                 sqlite3_int64               source_sum,
+                                 sqlite3_int64               compile_ms)
 {
     // allow env variable to disable writes
     if(!rocfft_getenv("ROCFFT_RTC_CACHE_WRITE_DISABLE").empty())
         return;
 
-    std::lock_guard<std::mutex> lock(store_mutex_user);
+    std::unique_lock<std::mutex> lock(store_mutex_user);
 
     auto s = store_stmt_user.get();
     sqlite3_reset(s);
@@ -281,8 +699,196 @@ void RTCCache::store_code_object(const std::string&          kernel_name,
             (*LogSingleton::GetInstance().GetRTCOS())
                 << "Error: failed to store code object for " << kernel_name << ": "
                 << sqlite3_errmsg(db_user.get()) << std::flush;
+        sqlite3_reset(s);
+        return;
     }
     sqlite3_reset(s);
+
+    // the source checksum is only an optimization for later
+    // compiles, so failing to store it is not an error
+    s = store_source_stmt_user.get();
+    sqlite3_reset(s);
+    if(sqlite3_bind_text(s, 1, kernel_name.c_str(), kernel_name.size(), SQLITE_TRANSIENT)
+           == SQLITE_OK
+       && sqlite3_bind_text(s, 2, gpu_arch.c_str(), gpu_arch.size(), SQLITE_TRANSIENT) == SQLITE_OK
+       && sqlite3_bind_int64(s, 3, HIP_VERSION) == SQLITE_OK
+       && sqlite3_bind_blob(s, 4, generator_sum.data(), generator_sum.size(), SQLITE_TRANSIENT)
+              == SQLITE_OK
+       && sqlite3_bind_int64(s, 5, source_sum) == SQLITE_OK
+       && sqlite3_bind_int64(s, 6, compile_ms) == SQLITE_OK)
+        sqlite3_step(s);
+    sqlite3_reset(s);
+
+    // check the size budget on the first store and then every so
+    // often, since each store makes the cache bigger
+    bool check_size = stores_since_trim++ % 16 == 0;
+    lock.unlock();
+
+    record_use(kernel_name, gpu_arch, generator_sum);
+    if(check_size)
+        maybe_trim();
+}
+
+void RTCCache::record_use(const std::string&          kernel_name,
+                          const std::string&          gpu_arch,
+                          const std::array<char, 32>& generator_sum)
+{
+    if(user_path.empty())
+        return;
+
+    size_t pending_count = 0;
+    {
+        std::lock_guard<std::mutex> lock(pending_uses_mutex);
+        auto& use = pending_uses[std::make_tuple(kernel_name, gpu_arch, generator_sum)];
+        ++use.first;
+        use.second = time(nullptr);
+        pending_count = pending_uses.size();
+    }
+    // write uses in batches, so a plan that loads many kernels
+    // doesn't need a write per kernel
+    if(pending_count >= 64)
+        flush_uses();
+}
+
+void RTCCache::flush_uses()
+{
+    decltype(pending_uses) uses;
+    {
+        std::lock_guard<std::mutex> lock(pending_uses_mutex);
+        uses.swap(pending_uses);
+    }
+    if(uses.empty() || !db_user || !rocfft_getenv("ROCFFT_RTC_CACHE_WRITE_DISABLE").empty())
+        return;
+
+    // write all of the uses with one statement
+    std::string upsert_text = "INSERT INTO usage_v1 ("
+                              "    kernel_name,"
+                              "    arch,"
+                              "    hip_version,"
+                              "    generator_sum,"
+                              "    use_count,"
+                              "    last_used"
+                              ")"
+                              "VALUES ";
+    for(size_t i = 0; i < uses.size(); ++i)
+    {
+        if(i > 0)
+            upsert_text += ",";
+        upsert_text += "(?, ?, ?, ?, ?, ?)";
+    }
+    upsert_text += " ON CONFLICT (kernel_name, arch, hip_version, generator_sum) DO UPDATE SET "
+                   "    use_count = use_count + excluded.use_count,"
+                   "    last_used = MAX(last_used, excluded.last_used)";
+
+    std::lock_guard<std::mutex> lock(store_mutex_user);
+
+    // usage is only a hint for trimming.  this is reached from
+    // looking up and storing kernels, which shouldn't fail just
+    // because the uses couldn't be written, so log and drop them.
+    auto log_error = [this](const char* step) {
+        if(LOG_RTC_ENABLED())
+            (*LogSingleton::GetInstance().GetRTCOS())
+                << "Error: failed to record kernel uses: flush_uses " << step << ": "
+                << sqlite3_errmsg(db_user.get()) << std::endl;
+    };
+
+    sqlite3_stmt* stmt_raw = nullptr;
+    if(sqlite3_prepare_v2(db_user.get(), upsert_text.c_str(), -1, &stmt_raw, nullptr) != SQLITE_OK)
+    {
+        log_error("prepare");
+        return;
+    }
+    sqlite3_stmt_ptr upsert_stmt(stmt_raw);
+    auto             s     = upsert_stmt.get();
+    int              param = 1;
+    for(const auto& [key, use] : uses)
+    {
+        const auto& [kernel_name, gpu_arch, generator_sum] = key;
+        if(sqlite3_bind_text(s, param++, kernel_name.c_str(), kernel_name.size(), SQLITE_TRANSIENT)
+               != SQLITE_OK
+           || sqlite3_bind_text(s, param++, gpu_arch.c_str(), gpu_arch.size(), SQLITE_TRANSIENT)
+                  != SQLITE_OK
+           || sqlite3_bind_int64(s, param++, HIP_VERSION) != SQLITE_OK
+           || sqlite3_bind_blob(
+                  s, param++, generator_sum.data(), generator_sum.size(), SQLITE_TRANSIENT)
+                  != SQLITE_OK
+           || sqlite3_bind_int64(s, param++, use.first) != SQLITE_OK
+           || sqlite3_bind_int64(s, param++, use.second) != SQLITE_OK)
+        {
+            log_error("bind");
+            return;
+        }
+    }
+    // don't complain if another process has the cache locked for
+    // too long
+    sqlite3_step(s);
+}
+
+std::unordered_map<std::string, sqlite3_int64> RTCCache::get_compile_durations()
+{
+    std::unordered_map<std::string, sqlite3_int64> durations;
+
+    // each architecture is a separate compile, so add them up
+    auto s = prepare_stmt(db_user,
+                          "SELECT kernel_name, SUM(arch_ms) "
+                          "FROM ("
+                          "  SELECT kernel_name, MAX(compile_ms) AS arch_ms "
+                          "  FROM source_v1 "
+                          "  WHERE hip_version = :hip_version "
+                          "  GROUP BY kernel_name, arch "
+                          "  ) "
+                          "GROUP BY kernel_name");
+    if(sqlite3_bind_int64(s.get(), 1, HIP_VERSION) != SQLITE_OK)
+        throw std::runtime_error(std::string("get_compile_durations bind: ")
+                                 + sqlite3_errmsg(db_user.get()));
+    while(sqlite3_step(s.get()) == SQLITE_ROW)
+    {
+        std::string kernel_name(reinterpret_cast<const char*>(sqlite3_column_text(s.get(), 0)),
+                                sqlite3_column_bytes(s.get(), 0));
+        durations[kernel_name] = sqlite3_column_int64(s.get(), 1);
+    }
+    return durations;
+}
+
+std::set<std::pair<std::string, sqlite3_int64>>
+    RTCCache::get_compiled_sources(const std::vector<std::string>& gpu_archs)
+{
+    std::set<std::pair<std::string, sqlite3_int64>> sources;
+
+    std::set<std::string> archs;
+    for(const auto& gpu_arch_with_flags : gpu_archs)
+        archs.insert(gpu_arch_strip_flags(gpu_arch_with_flags));
+    if(archs.empty())
+        return sources;
+
+    std::string sql = "SELECT kernel_name, source_sum "
+                      "FROM source_v1 "
+                      "WHERE hip_version = ? "
+                      "  AND arch IN (";
+    for(size_t i = 0; i < archs.size(); ++i)
+        sql += i == 0 ? "?" : ", ?";
+    sql += ") "
+           "GROUP BY kernel_name, source_sum "
+           "HAVING COUNT(DISTINCT arch) = ?";
+
+    auto s     = prepare_stmt(db_user, sql.c_str());
+    int  param = 1;
+    bool bound = sqlite3_bind_int64(s.get(), param++, HIP_VERSION) == SQLITE_OK;
+    for(const auto& arch : archs)
+        bound = bound
+                && sqlite3_bind_text(s.get(), param++, arch.c_str(), arch.size(), SQLITE_TRANSIENT)
+                       == SQLITE_OK;
+    bound = bound && sqlite3_bind_int64(s.get(), param++, archs.size()) == SQLITE_OK;
+    if(!bound)
+        throw std::runtime_error(std::string("get_compiled_sources bind: ")
+                                 + sqlite3_errmsg(db_user.get()));
+    while(sqlite3_step(s.get()) == SQLITE_ROW)
+    {
+        std::string kernel_name(reinterpret_cast<const char*>(sqlite3_column_text(s.get(), 0)),
+                                sqlite3_column_bytes(s.get(), 0));
+        sources.emplace(std::move(kernel_name), sqlite3_column_int64(s.get(), 1));
+    }
+    return sources;
 }
 
 rocfft_status RTCCache::serialize(void** buffer, size_t* buffer_len_bytes)
@@ -387,9 +993,53 @@ static RTCProcessType get_rtc_process_type()
     return RTCProcessType::DEFAULT;
 }
 
-static std::string gpu_arch_strip_flags(const std::string gpu_arch_with_flags)
+// 64-bit FNV-1a checksum of kernel source and compile signature, to
+// notice when a kernel's source is unchanged even though the
+// generator sum has changed
+static sqlite3_int64 source_checksum(const std::string& src)
 {
-    return gpu_arch_with_flags.substr(0, gpu_arch_with_flags.find(':'));
+    uint64_t sum = 0xcbf29ce484222325;
+    for(unsigned char c : src)
+    {
+        sum ^= c;
+        sum *= 0x100000001b3;
+    }
+    return static_cast<sqlite3_int64>(sum);
+}
+
+// number of lock files that kernel compiles are spread over.  two
+// kernels that hash to the same file can't be compiled at the same
+// time, so this needs to be much more than the number of kernels
+// that are compiled concurrently.
+static const uint64_t COMPILE_LOCK_SLOTS = 1024;
+
+std::unique_ptr<RTCCompileLock> RTCCache::lock_compile(const std::string& kernel_name,
+                                                       const std::string& gpu_arch)
+{
+    // if nothing is shared through the cache, other processes can't
+    // use what we compile
+    if(user_path.empty() || !rocfft_getenv("ROCFFT_RTC_CACHE_READ_DISABLE").empty()
+       || !rocfft_getenv("ROCFFT_RTC_CACHE_WRITE_DISABLE").empty())
+        return nullptr;
+
+    fs::path        lock_dir = user_path.string() + ".locks";
+    std::error_code err;
+    fs::create_directories(lock_dir, err);
+    if(err)
+        return nullptr;
+
+    auto slot = static_cast<uint64_t>(source_checksum(kernel_name + '\0' + gpu_arch))
+                % COMPILE_LOCK_SLOTS;
+    return RTCCompileLock::acquire(lock_dir / ("compile_" + std::to_string(slot) + ".lock"));
+}
+
+// callbacks are always potentially enabled, and activated by
+// checking the enable_callbacks variable later
+static const std::string kernel_src_prefix = "#define ROCFFT_CALLBACKS_ENABLED\n";
+
+sqlite3_int64 rtc_source_sum(const std::string& generated_src, const std::string& signature)
+{
+    return source_checksum(signature + '\0' + kernel_src_prefix + generated_src);
 }
 
 std::vector<char> cached_compile(const std::string&          kernel_name,
@@ -409,14 +1059,16 @@ std::vector<char> cached_compile(const std::string&          kernel_name,
 
     // check cache first
     std::vector<char> code;
-    if(RTCCache::single)
+    auto              cache = RTCCache::get();
+    if(cache)
     {
-        code = RTCCache::single->get_code_object(kernel_name, gpu_arch, generator_sum);
+        code = cache->get_code_object(kernel_name, gpu_arch, generator_sum);
     }
 
     if(!code.empty())
     {
         // cache hit
+        trace_instant(TraceEvent::RTC_CACHE_HIT, kernel_name);
         try
         {
             if(LOG_RTC_ENABLED())
@@ -439,13 +1091,41 @@ std::vector<char> cached_compile(const std::string&          kernel_name,
         }
     }
 
-    // callbacks are always potentially enabled, and activated by
-    // checking the enable_callbacks variable later
-    std::string kernel_src{"#define ROCFFT_CALLBACKS_ENABLED\n"};
+    trace_instant(TraceEvent::RTC_CACHE_MISS, kernel_name);
 
-    auto generate_begin = std::chrono::steady_clock::now();
-    kernel_src += generate_src(kernel_name);
-    auto generate_end = std::chrono::steady_clock::now();
+    // if another process on this node is already compiling this
+    // kernel, wait for it to finish and get its result from the
+    // cache.  if that process died, the lock is released without a
+    // result, and we compile the kernel ourselves.
+    std::unique_ptr<RTCCompileLock> node_lock;
+    if(cache)
+    {
+        auto lock_begin = std::chrono::steady_clock::now();
+        node_lock       = cache->lock_compile(kernel_name, gpu_arch);
+        if(node_lock)
+        {
+            code = cache->get_code_object(kernel_name, gpu_arch, generator_sum);
+            if(!code.empty())
+            {
+                if(LOG_RTC_ENABLED())
+                {
+                    std::chrono::duration<float, std::milli> wait_ms
+                        = std::chrono::steady_clock::now() - lock_begin;
+                    (*LogSingleton::GetInstance().GetRTCOS())
+                        << "// " << kernel_name << " compiled by another process, waited "
+                        << static_cast<int>(wait_ms.count()) << " ms" << std::endl;
+                }
+                return code;
+            }
+        }
+    }
+
+    auto        generate_begin = std::chrono::steady_clock::now();
+    std::string generated_src  = generate_src(kernel_name);
+    auto        generate_end   = std::chrono::steady_clock::now();
+    std::string kernel_src     = kernel_src_prefix + generated_src;
+    trace_complete(
+        TraceEvent::RTC_GENERATE, kernel_name, generate_begin, generate_end, kernel_src.size());
 
     if(LOG_RTC_ENABLED())
     {
@@ -458,6 +1138,26 @@ std::vector<char> cached_compile(const std::string&          kernel_name,
             << std::endl;
     }
 
+    // if identical source was already compiled the same way under a
+    // different generator sum, reuse that code object instead of
+    // compiling again
+    static const std::string signature  = compile_signature();
+    auto                     source_sum = rtc_source_sum(generated_src, signature);
+    if(cache)
+    {
+        sqlite3_int64 compile_ms = 0;
+        code = cache->get_code_object_by_source(kernel_name, gpu_arch, source_sum, compile_ms);
+        if(!code.empty())
+        {
+            if(LOG_RTC_ENABLED())
+                (*LogSingleton::GetInstance().GetRTCOS())
+                    << "// source unchanged for " << kernel_name << std::endl;
+            cache->store_code_object(
+                kernel_name, gpu_arch, generator_sum, code, source_sum, compile_ms);
+            return code;
+        }
+    }
+
     // try to set compile_begin time right when we're really
     // about to compile (i.e. after acquiring any locks)
     std::chrono::time_point<std::chrono::steady_clock> compile_begin;
@@ -517,6 +1217,12 @@ std::vector<char> cached_compile(const std::string&          kernel_name,
     }
     }
     auto compile_end = std::chrono::steady_clock::now();
+    trace_complete(TraceEvent::RTC_COMPILE,
+                   kernel_name,
+                   compile_begin,
+                   compile_end,
+                   kernel_src.size(),
+                   code.size());
 
     if(LOG_RTC_ENABLED())
     {
@@ -528,9 +1234,12 @@ std::vector<char> cached_compile(const std::string&          kernel_name,
             << std::endl;
     }
 
-    if(RTCCache::single)
+    if(cache)
     {
-        RTCCache::single->store_code_object(kernel_name, gpu_arch, generator_sum, code);
+        auto compile_ms
+            = std::chrono::duration_cast<std::chrono::milliseconds>(compile_end - compile_begin);
+        cache->store_code_object(
+            kernel_name, gpu_arch, generator_sum, code, source_sum, compile_ms.count());
     }
     return code;
 }
@@ -558,23 +1267,6 @@ void RTCCache::write_aot_cache(const std::string&              output_path,
     if(fs::exists(output_path))
         fs::remove(output_path);
 
-    // connect to the output path but discard the returned pointer -
-    // this will create the cache tables but close the connection so
-    // we can reopen it from inside our existing db handle.
-    connect_db(output_path, false);
-
-    auto attach_stmt = prepare_stmt(db_user, "ATTACH DATABASE :db AS out_db");
-    sqlite3_reset(attach_stmt.get());
-    if(sqlite3_bind_text(
-           attach_stmt.get(), 1, output_path.c_str(), output_path.size(), SQLITE_TRANSIENT)
-       != SQLITE_OK)
-        throw std::runtime_error(std::string("write_aot_cache attach bind: ")
-                                 + sqlite3_errmsg(db_user.get()));
-    if(sqlite3_step(attach_stmt.get()) != SQLITE_DONE)
-        throw std::runtime_error(std::string("write_aot_cache attach step: ")
-                                 + sqlite3_errmsg(db_user.get()));
-    sqlite3_reset(attach_stmt.get());
-
     // copy only the required arches, in case more are present in the
     // cache than we need
     auto create_temp_stmt = prepare_stmt(db_user,
@@ -600,82 +1292,195 @@ void RTCCache::write_aot_cache(const std::string&              output_path,
         sqlite3_reset(insert_temp_stmt.get());
     }
 
-    // copy the kernels over in a consistent order and zero out the timestamps
-    auto copy_stmt = prepare_stmt(db_user,
-                                  "INSERT INTO out_db.cache_v1 ("
-                                  "    kernel_name,"
-                                  "    arch,"
-                                  "    hip_version,"
-                                  "    generator_sum,"
-                                  "    code,"
-                                  "    timestamp"
-                                  ")"
-                                  "SELECT kernel_name, arch, hip_version, generator_sum, code, 0 "
-                                  "FROM cache_v1 "
-                                  "WHERE "
-                                  "  generator_sum = :generator_sum "
-                                  "  AND hip_version = :hip_version "
-                                  "  AND arch IN ("
-                                  "    SELECT arch FROM temp.aot_arch "
-                                  "  ) "
-                                  "ORDER BY kernel_name, arch, hip_version");
-    if(sqlite3_bind_blob(
-           copy_stmt.get(), 1, generator_sum.data(), generator_sum.size(), SQLITE_TRANSIENT)
-           != SQLITE_OK
-       || sqlite3_bind_int64(copy_stmt.get(), 2, HIP_VERSION) != SQLITE_OK)
-        throw std::runtime_error(std::string("write_aot_cache copy bind: ")
+    // kernels are read twice in the same order: first just the keys
+    // and sizes to build the index, and then the code itself.  that
+    // way the code never all needs to be in memory at once.
+    static const char* select_where = "FROM cache_v1 "
+                                      "WHERE "
+                                      "  generator_sum = :generator_sum "
+                                      "  AND hip_version = :hip_version "
+                                      "  AND arch IN ("
+                                      "    SELECT arch FROM temp.aot_arch "
+                                      "  ) "
+                                      "ORDER BY kernel_name, arch, hip_version";
+    auto select_stmt = [&](const char* columns) {
+        auto sql  = std::string("SELECT ") + columns + " " + select_where;
+        auto stmt = prepare_stmt(db_user, sql.c_str());
+        if(sqlite3_bind_blob(
+               stmt.get(), 1, generator_sum.data(), generator_sum.size(), SQLITE_TRANSIENT)
+               != SQLITE_OK
+           || sqlite3_bind_int64(stmt.get(), 2, HIP_VERSION) != SQLITE_OK)
+            throw std::runtime_error(std::string("write_aot_cache select bind: ")
+                                     + sqlite3_errmsg(db_user.get()));
+        return stmt;
+    };
+
+    std::vector<AOTCacheEntry> entries;
+    std::string                strings;
+    auto                       index_stmt = select_stmt("kernel_name, arch, LENGTH(code)");
+    int                        rc         = SQLITE_ROW;
+    while((rc = sqlite3_step(index_stmt.get())) == SQLITE_ROW)
+    {
+        auto s = index_stmt.get();
+
+        AOTCacheEntry e{};
+        // string offsets are relative to the start of the string
+        // table until we know how big the index is
+        e.kernel_name_offset = strings.size();
+        e.kernel_name_bytes  = sqlite3_column_bytes(s, 0);
+        strings.append(reinterpret_cast<const char*>(sqlite3_column_text(s, 0)),
+                       e.kernel_name_bytes);
+        e.arch_offset = strings.size();
+        e.arch_bytes  = sqlite3_column_bytes(s, 1);
+        strings.append(reinterpret_cast<const char*>(sqlite3_column_text(s, 1)), e.arch_bytes);
+        e.code_bytes  = sqlite3_column_int64(s, 2);
+        e.hip_version = HIP_VERSION;
+        std::copy(generator_sum.begin(), generator_sum.end(), e.generator_sum);
+        entries.push_back(e);
+    }
+    if(rc != SQLITE_DONE)
+        throw std::runtime_error(std::string("write_aot_cache index step: ")
                                  + sqlite3_errmsg(db_user.get()));
+    index_stmt.reset();
 
-    if(sqlite3_step(copy_stmt.get()) != SQLITE_DONE)
-        throw std::runtime_error(std::string("write_aot_cache copy step: ")
-                                 + sqlite3_errmsg(db_user.get()));
-    sqlite3_reset(copy_stmt.get());
+    // lay out the file: header, index, strings, and then each code
+    // object aligned to 8 bytes
+    auto align = [](uint64_t offset) { return (offset + 7) / 8 * 8; };
+
+    uint64_t strings_offset = sizeof(AOTCacheHeader) + entries.size() * sizeof(AOTCacheEntry);
+    uint64_t code_offset    = align(strings_offset + strings.size());
+    for(auto& e : entries)
+    {
+        e.code_offset = code_offset;
+        code_offset   = align(code_offset + e.code_bytes);
+    }
+
+    // code is written in query order, so sort a copy of the index
+    // for lookups
+    auto sorted_entries = entries;
+    std::sort(sorted_entries.begin(),
+              sorted_entries.end(),
+              [&strings](const AOTCacheEntry& a, const AOTCacheEntry& b) {
+                  return aot_cache_key(strings.data(), a) < aot_cache_key(strings.data(), b);
+              });
+    for(auto& e : sorted_entries)
+    {
+        e.kernel_name_offset += strings_offset;
+        e.arch_offset += strings_offset;
+    }
+
+    AOTCacheHeader header{};
+    std::copy(std::begin(aot_cache_magic), std::end(aot_cache_magic), header.magic);
+    header.version     = aot_cache_version;
+    header.entry_count = entries.size();
+
+    std::ofstream out(output_path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(sorted_entries.data()),
+              sorted_entries.size() * sizeof(AOTCacheEntry));
+    out.write(strings.data(), strings.size());
+
+    static const char padding[8] = {};
+    uint64_t          written    = strings_offset + strings.size();
+
+    auto code_stmt = select_stmt("code");
+    for(const auto& e : entries)
+    {
+        if(sqlite3_step(code_stmt.get()) != SQLITE_ROW
+           || static_cast<uint64_t>(sqlite3_column_bytes(code_stmt.get(), 0)) != e.code_bytes)
+            throw std::runtime_error(std::string("write_aot_cache code step: ")
+                                     + sqlite3_errmsg(db_user.get()));
+        out.write(padding, e.code_offset - written);
+        out.write(static_cast<const char*>(sqlite3_column_blob(code_stmt.get(), 0)),
+                  e.code_bytes);
+        written = e.code_offset + e.code_bytes;
+    }
+    code_stmt.reset();
+
+    out.close();
+    if(!out)
+        throw std::runtime_error("write_aot_cache: failed to write " + output_path);
 }
 
-void RTCCache::cleanup_cache(sqlite3_int64 target_size_bytes)
+// total size of the kernels in a cache, counted the same way as
+// trim_cache counts them
+static sqlite3_int64 cache_size(sqlite3_ptr& db)
 {
-    // delete any kernels that are older than the newest
-    // target-size-worth of kernels
-    auto delete_stmt = prepare_stmt(db_user,
-                                    "DELETE "
-                                    "FROM cache_v1 "
-                                    "WHERE "
-                                    "  ROWID NOT IN ( "
-                                    "    SELECT "
-                                    "      rid "
-                                    "    FROM "
-                                    "      ( "
-                                    "      SELECT "
-                                    "        ROWID AS rid, "
-                                    "        kernel_name "
-                                    "        timestamp, "
-                                    "        SUM(LENGTH(code) + LENGTH(kernel_name)) "
-                                    "          OVER "
-                                    "          ( "
-                                    "          ORDER BY "
-                                    "            timestamp DESC, "
-                                    "            kernel_name "
-                                    "          ) AS total_code_length "
-                                    "      FROM cache_v1 "
-                                    "      ) totals "
-                                    "    WHERE total_code_length < :target_size_bytes "
-                                    "    ) ");
+    auto size_stmt = prepare_stmt(db,
+                                  "SELECT "
+                                  "  COALESCE(SUM(LENGTH(code) + LENGTH(kernel_name)), 0) "
+                                  "FROM cache_v1");
+    if(sqlite3_step(size_stmt.get()) != SQLITE_ROW)
+        throw std::runtime_error(std::string("cache_size step: ") + sqlite3_errmsg(db.get()));
+    return sqlite3_column_int64(size_stmt.get(), 0);
+}
+
+// remove kernels from a cache to keep it under a target size.
+// kernels are ranked by when they were last used, but each use
+// beyond the first counts as an hour more recent (up to 30 days), so
+// that frequently used kernels outlive ones that were used once.
+static void trim_cache(sqlite3_ptr& db, sqlite3_int64 target_size_bytes)
+{
+    auto delete_stmt = prepare_stmt(
+        db,
+        "DELETE "
+        "FROM cache_v1 "
+        "WHERE "
+        "  ROWID NOT IN ( "
+        "    SELECT "
+        "      rid "
+        "    FROM "
+        "      ( "
+        "      SELECT "
+        "        c.ROWID AS rid, "
+        "        SUM(LENGTH(c.code) + LENGTH(c.kernel_name)) "
+        "          OVER "
+        "          ( "
+        "          ORDER BY "
+        "            MAX(c.timestamp, COALESCE(u.last_used, 0)) "
+        "              + MIN(COALESCE(u.use_count, 1) - 1, 720) * 3600 DESC, "
+        "            c.kernel_name "
+        "          ) AS total_code_length "
+        "      FROM cache_v1 c "
+        "      LEFT JOIN usage_v1 u USING (kernel_name, arch, hip_version, generator_sum) "
+        "      ) totals "
+        "    WHERE total_code_length < :target_size_bytes "
+        "    ) ");
     if(sqlite3_bind_int64(delete_stmt.get(), 1, target_size_bytes) != SQLITE_OK)
         throw std::runtime_error(std::string("cleanup_cache delete bind: ")
-                                 + sqlite3_errmsg(db_user.get()));
+                                 + sqlite3_errmsg(db.get()));
     if(sqlite3_step(delete_stmt.get()) != SQLITE_DONE)
         throw std::runtime_error(std::string("cleanup_cache delete step: ")
-                                 + sqlite3_errmsg(db_user.get()));
+                                 + sqlite3_errmsg(db.get()));
     delete_stmt.reset();
 
+    // forget source checksums and usage of kernels that are gone
+    for(std::string table : {"source_v1", "usage_v1"})
+    {
+        auto delete_orphan_stmt
+            = prepare_stmt(db,
+                           ("DELETE "
+                            "FROM "
+                            + table
+                            + " WHERE "
+                              "  (kernel_name, arch, hip_version, generator_sum) NOT IN ( "
+                              "    SELECT kernel_name, arch, hip_version, generator_sum "
+                              "    FROM cache_v1 "
+                              "    ) ")
+                               .c_str());
+        if(sqlite3_step(delete_orphan_stmt.get()) != SQLITE_DONE)
+            throw std::runtime_error("cleanup_cache delete " + table
+                                     + " step: " + sqlite3_errmsg(db.get()));
+    }
+
     // check if we can reclaim 20% or more of the file's space by vacuuming
-    auto          page_count_stmt = prepare_stmt(db_user, "PRAGMA page_count");
+    auto          page_count_stmt = prepare_stmt(db, "PRAGMA page_count");
     sqlite3_int64 page_count      = 0;
     if(sqlite3_step(page_count_stmt.get()) == SQLITE_ROW)
         page_count = sqlite3_column_int64(page_count_stmt.get(), 0);
     page_count_stmt.reset();
 
-    auto          freelist_count_stmt = prepare_stmt(db_user, "PRAGMA freelist_count");
+    auto          freelist_count_stmt = prepare_stmt(db, "PRAGMA freelist_count");
     sqlite3_int64 freelist_count      = 0;
     if(sqlite3_step(freelist_count_stmt.get()) == SQLITE_ROW)
         freelist_count = sqlite3_column_int64(freelist_count_stmt.get(), 0);
@@ -683,9 +1488,48 @@ void RTCCache::cleanup_cache(sqlite3_int64 target_size_bytes)
 
     if(freelist_count >= page_count * 0.2)
     {
-        auto vacuum_stmt = prepare_stmt(db_user, "VACUUM");
+        auto vacuum_stmt = prepare_stmt(db, "VACUUM");
         if(sqlite3_step(vacuum_stmt.get()) != SQLITE_DONE)
             throw std::runtime_error(std::string("cleanup_cache vacuum step: ")
-                                     + sqlite3_errmsg(db_user.get()));
+                                     + sqlite3_errmsg(db.get()));
     }
 }
+
+void RTCCache::cleanup_cache(sqlite3_int64 target_size_bytes)
+{
+    flush_uses();
+    trim_cache(db_user, target_size_bytes);
+}
+
+void RTCCache::maybe_trim()
+{
+    // only file caches persist long enough to need trimming
+    if(max_size_bytes <= 0 || user_path.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(trim_mutex);
+
+    // don't start another trim while one is still running
+    if(trim_future.valid()
+       && trim_future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return;
+
+    // rank kernels by up-to-date usage
+    flush_uses();
+
+    // trim with a separate connection, so that it doesn't hold up
+    // queries on this one.  go a bit under the budget, so we don't
+    // need to trim again right away.
+    trim_future = std::async(std::launch::async, [this]() {
+        try
+        {
+            auto db = connect_db(user_path, false);
+            if(db && cache_size(db) > max_size_bytes)
+                trim_cache(db, max_size_bytes / 10 * 9);
+        }
+        catch(std::exception&)
+        {
+            // the cache is only trimmed on a best-effort basis
+        }
+    });
+}
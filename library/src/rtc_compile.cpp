@@ -20,9 +20,27 @@
 
 #include "rtc_compile.h"
 
+#include <array>
 #include <hip/hiprtc.h>
 #include <stdexcept>
 
+// options given to hiprtc for every kernel, apart from the GPU
+// architecture
+static const std::array<const char*, 2> COMPILE_OPTIONS = {"-O3", "-std=c++14"};
+
+std::string compile_signature()
+{
+    int major = 0;
+    int minor = 0;
+    if(hiprtcVersion(&major, &minor) != HIPRTC_SUCCESS)
+        throw std::runtime_error("unable to get hiprtc version");
+
+    std::string signature = "hiprtc " + std::to_string(major) + "." + std::to_string(minor);
+    for(auto option : COMPILE_OPTIONS)
+        signature += std::string(" ") + option;
+    return signature;
+}
+
 std::vector<char> compile_inprocess(const std::string& kernel_src, const std::string& gpu_arch)
 {
     hiprtcProgram prog;
@@ -35,9 +53,7 @@ std::vector<char> compile_inprocess(const std::string& kernel_src, const std::st
 
     std::string gpu_arch_arg = "--gpu-architecture=" + gpu_arch;
 
-    std::vector<const char*> options;
-    options.push_back("-O3");
-    options.push_back("-std=c++14");
+    std::vector<const char*> options(COMPILE_OPTIONS.begin(), COMPILE_OPTIONS.end());
     options.push_back(gpu_arch_arg.c_str());
 
     auto compileResult = hiprtcCompileProgram(prog, options.size(), options.data());
@@ -25,17 +25,19 @@ rocfft_status rocfft_cache_serialize(void** buffer, size_t* buffer_len_bytes)
     if(!buffer || !buffer_len_bytes)
         return rocfft_status_invalid_arg_value;
 
-    if(!RTCCache::single)
+    auto cache = RTCCache::get();
+    if(!cache)
         return rocfft_status_failure;
 
-    return RTCCache::single->serialize(buffer, buffer_len_bytes);
+    return cache->serialize(buffer, buffer_len_bytes);
 }
 
 rocfft_status rocfft_cache_buffer_free(void* buffer)
 {
-    if(!RTCCache::single)
+    auto cache = RTCCache::get();
+    if(!cache)
         return rocfft_status_failure;
-    RTCCache::single->serialize_free(buffer);
+    cache->serialize_free(buffer);
     return rocfft_status_success;
 }
 
@@ -44,8 +46,9 @@ rocfft_status rocfft_cache_deserialize(const void* buffer, size_t buffer_len_byt
     if(!buffer || !buffer_len_bytes)
         return rocfft_status_invalid_arg_value;
 
-    if(!RTCCache::single)
+    auto cache = RTCCache::get();
+    if(!cache)
         return rocfft_status_failure;
 
-    return RTCCache::single->deserialize(buffer, buffer_len_bytes);
+    return cache->deserialize(buffer, buffer_len_bytes);
 }
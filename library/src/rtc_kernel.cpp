@@ -34,6 +34,9 @@
 #include "rtc_transpose_kernel.h"
 #include "tree_node.h"
 
+#include <cinttypes>
+#include <cstdio>
+
 RTCKernel::RTCKernel(const std::string&       kernel_name,
                      const std::vector<char>& code,
                      dim3                     gridDim,
@@ -120,8 +123,83 @@ void RTCKernel::launch(
         throw std::runtime_error("hipModuleLaunchKernel failure");
 }
 
-std::shared_future<std::unique_ptr<RTCKernel>> RTCKernel::runtime_compile(
-    const TreeNode& node, const std::string& gpu_arch, bool enable_callbacks)
+#ifdef ROCFFT_RUNTIME_COMPILE
+// FNV-1a hash of user callback source, so that kernels built from
+// different callbacks get different names, and cache entries
+static std::string callback_source_hash(const RTCCallbackSource& callback_source)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for(const auto& str :
+        {callback_source.source, callback_source.load_function, callback_source.store_function})
+    {
+        for(unsigned char c : str)
+        {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        // hash a null terminator too, so that the strings can't run
+        // together
+        hash *= 1099511628211ULL;
+    }
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016" PRIx64, hash);
+    return buf;
+}
+
+// type of the elements that kernels load from and store to arrays of
+// the given type
+static const char* rtc_element_type(rocfft_array_type type)
+{
+    return type == rocfft_array_type_real ? "real_type_t<scalar_type>" : "scalar_type";
+}
+
+// Splice user callback source into the source of a kernel that was
+// generated with callbacks enabled.  The user's code goes where the
+// kernel declares its callback type, after the types the callbacks
+// might need, and the callbacks are bound to the element types that
+// the kernel reads and writes.
+static std::string splice_callback_source(const std::string&       src,
+                                          const RTCCallbackSource& callback_source,
+                                          rocfft_array_type        inArrayType,
+                                          rocfft_array_type        outArrayType)
+{
+    const std::string cbtype_decl = rtc_const_cbtype_decl(true);
+
+    auto pos = src.find(cbtype_decl);
+    if(pos == std::string::npos)
+        throw std::runtime_error("kernel source does not accept callbacks");
+
+    std::string callback_src = "// user callback source\n" + callback_source.source + "\n";
+    // planar arrays get the callback types that take separate real
+    // and imaginary pointers
+    auto bind_callback = [&callback_src](const std::string& side,
+                                         rocfft_array_type  type,
+                                         const std::string& function) {
+        const bool        planar    = array_type_is_planar(type);
+        const std::string elem      = planar ? "real_type_t<scalar_type>" : rtc_element_type(type);
+        const std::string cb_struct = "source_" + side + "_cb" + (planar ? "_planar" : "");
+        const std::string cb_type
+            = std::string(planar ? "planar_callback_type" : "callback_type") + "<" + elem + ">";
+        callback_src += "template <>\nstruct " + cb_struct + "<" + elem + ">\n{\n";
+        callback_src += "    static __device__ " + cb_type + "::" + side + " get()\n";
+        callback_src += "    {\n        return " + function + ";\n";
+        callback_src += "    }\n};\n";
+    };
+    if(!callback_source.load_function.empty())
+        bind_callback("load", inArrayType, callback_source.load_function);
+    if(!callback_source.store_function.empty())
+        bind_callback("store", outArrayType, callback_source.store_function);
+    callback_src += "static const CallbackType cbtype = CallbackType::USER_SOURCE;\n";
+
+    return src.substr(0, pos) + callback_src + src.substr(pos + cbtype_decl.size());
+}
+#endif
+
+std::shared_future<std::unique_ptr<RTCKernel>>
+    RTCKernel::runtime_compile(const TreeNode&          node,
+                               const std::string&       gpu_arch,
+                               bool                     enable_callbacks,
+                               const RTCCallbackSource& callback_source)
 {
 
 #ifdef ROCFFT_RUNTIME_COMPILE
@@ -150,6 +228,23 @@ std::shared_future<std::unique_ptr<RTCKernel>> RTCKernel::runtime_compile(
         generator = RTCKernelBluesteinMulti::generate_from_node(node, gpu_arch, enable_callbacks);
     if(!generator.valid())
         generator = RTCKernelApplyCallback::generate_from_node(node, gpu_arch, enable_callbacks);
+
+    // user callbacks given as source become part of the kernel
+    if(generator.valid() && enable_callbacks && !callback_source.empty())
+    {
+        auto generate_name      = generator.generate_name;
+        auto hash               = callback_source_hash(callback_source);
+        generator.generate_name = [=]() { return generate_name() + "_CBSRC" + hash; };
+
+        auto generate_src      = generator.generate_src;
+        auto inArrayType       = node.inArrayType;
+        auto outArrayType      = node.outArrayType;
+        generator.generate_src = [=](const std::string& kernel_name) mutable {
+            return splice_callback_source(
+                generate_src(kernel_name), callback_source, inArrayType, outArrayType);
+        };
+    }
+
     if(generator.valid())
     {
         std::string kernel_name = generator.generate_name();
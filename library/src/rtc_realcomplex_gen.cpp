@@ -50,6 +50,7 @@ std::string realcomplex_rtc_kernel_name(const RealComplexSpecs& specs)
     kernel_name += "_dim" + std::to_string(specs.dim);
 
     kernel_name += rtc_precision_name(specs.precision);
+    kernel_name += rtc_storage_name(specs.storage);
     kernel_name += rtc_array_type_name(specs.inArrayType);
     kernel_name += rtc_array_type_name(specs.outArrayType);
 
@@ -268,7 +269,7 @@ std::string r2c_copy_rtc(const std::string& kernel_name, const RealComplexSpecs&
                                 "to read global memory."};
             guard.body += CallbackDeclaration("real_type_t<scalar_type>", "cbtype");
 
-            Variable elem{"elem", "auto"};
+            Variable elem{"elem", "real_type_t<scalar_type>"};
             guard.body += Declaration{elem, input[inputIdx].x()};
             if(specs.enable_scaling)
                 guard.body += MultiplyAssign(elem, scale_factor_var);
@@ -277,6 +278,8 @@ std::string r2c_copy_rtc(const std::string& kernel_name, const RealComplexSpecs&
         }
     }
 
+    if(specs.storage != rocfft_storage_precision_native)
+        func = make_storage(func, {"input", "output", "outputs", "outputc"});
     if(array_type_is_planar(specs.inArrayType))
         func = make_planar(func, "input");
     if(array_type_is_planar(specs.outArrayType))
@@ -297,6 +300,8 @@ std::string realcomplex_rtc(const std::string& kernel_name, const RealComplexSpe
     src += callback_h;
 
     src += rtc_precision_type_decl(specs.precision);
+    if(specs.storage != rocfft_storage_precision_native)
+        src += rtc_storage_type_decl(specs.storage);
 
     src += rtc_const_cbtype_decl(specs.enable_callbacks);
 
@@ -338,6 +343,7 @@ std::string realcomplex_even_rtc_kernel_name(const RealComplexEvenSpecs& specs)
     kernel_name += "_dim" + std::to_string(specs.dim);
 
     kernel_name += rtc_precision_name(specs.precision);
+    kernel_name += rtc_storage_name(specs.storage);
     kernel_name += rtc_array_type_name(specs.inArrayType);
     kernel_name += rtc_array_type_name(specs.outArrayType);
 
@@ -359,6 +365,8 @@ std::string realcomplex_even_rtc(const std::string& kernel_name, const RealCompl
     src += callback_h;
 
     src += rtc_precision_type_decl(specs.precision);
+    if(specs.storage != rocfft_storage_precision_native)
+        src += rtc_storage_type_decl(specs.storage);
 
     src += rtc_const_cbtype_decl(specs.enable_callbacks);
 
@@ -561,6 +569,8 @@ std::string realcomplex_even_rtc(const std::string& kernel_name, const RealCompl
 
     func.body += guard;
 
+    if(specs.storage != rocfft_storage_precision_native)
+        func = make_storage(func, {"input", "output"});
     if(array_type_is_planar(specs.inArrayType))
         func = make_planar(func, "input");
     if(array_type_is_planar(specs.outArrayType))
@@ -589,6 +599,7 @@ std::string realcomplex_even_transpose_rtc_kernel_name(const RealComplexEvenTran
     kernel_name += "_tile" + std::to_string(specs.TileX()) + "x" + std::to_string(specs.TileY());
 
     kernel_name += rtc_precision_name(specs.precision);
+    kernel_name += rtc_storage_name(specs.storage);
     kernel_name += rtc_array_type_name(specs.inArrayType);
     kernel_name += rtc_array_type_name(specs.outArrayType);
 
@@ -615,6 +626,8 @@ std::string realcomplex_even_transpose_rtc(const std::string&
     src += callback_h;
 
     src += rtc_precision_type_decl(specs.precision);
+    if(specs.storage != rocfft_storage_precision_native)
+        src += rtc_storage_type_decl(specs.storage);
 
     src += rtc_const_cbtype_decl(specs.enable_callbacks);
 
@@ -983,6 +996,8 @@ std::string realcomplex_even_transpose_rtc(const std::string&
         func.body += butterfly;
     }
 
+    if(specs.storage != rocfft_storage_precision_native)
+        func = make_storage(func, {"input", "output"});
     if(array_type_is_planar(specs.inArrayType))
         func = make_planar(func, "input");
     if(array_type_is_planar(specs.outArrayType))
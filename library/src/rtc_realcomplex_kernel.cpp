@@ -54,6 +54,7 @@ RTCKernel::RTCGenerator RTCKernelRealComplex::generate_from_node(const TreeNode&
     RealComplexSpecs specs{node.scheme,
                            node.length.size(),
                            node.precision,
+                           node.storage,
                            node.inArrayType,
                            node.outArrayType,
                            enable_callbacks,
@@ -181,6 +182,7 @@ RTCKernel::RTCGenerator RTCKernelRealComplexEven::generate_from_node(const TreeN
     RealComplexEvenSpecs specs{{node.scheme,
                                 node.length.size(),
                                 node.precision,
+                                node.storage,
                                 node.inArrayType,
                                 node.outArrayType,
                                 enable_callbacks,
@@ -303,6 +305,7 @@ RTCKernel::RTCGenerator RTCKernelRealComplexEvenTranspose::generate_from_node(
     RealComplexEvenTransposeSpecs specs{{node.scheme,
                                          node.length.size(),
                                          node.precision,
+                                         node.storage,
                                          node.inArrayType,
                                          node.outArrayType,
                                          enable_callbacks,
@@ -0,0 +1,189 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <map>
+#include <numeric>
+
+#include "../../shared/arithmetic.h"
+#include "rtc_stockham_config.h"
+
+using namespace std::placeholders;
+
+#include "device/generator/generator.h"
+#include "device/generator/stockham_gen.h"
+#include "device/generator/stockham_gen_base.h"
+
+const std::vector<unsigned int> supported_factors = {2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 16, 17};
+
+typedef std::map<unsigned int, std::set<std::vector<unsigned int>>> factorization_map;
+
+// Factorize a length, reusing the factorizations of remainders
+// that were already found.
+static const std::set<std::vector<unsigned int>>& factorize(unsigned int       length,
+                                                            factorization_map& memo)
+{
+    auto found = memo.find(length);
+    if(found != memo.end())
+        return found->second;
+
+    std::set<std::vector<unsigned int>> ret;
+    for(auto factor : supported_factors)
+    {
+        if(length % factor == 0)
+        {
+            unsigned int remain = length / factor;
+            if(remain == 1)
+                ret.insert({factor});
+            else
+            {
+                // recurse into remainder
+                for(auto& remain_factors : factorize(remain, memo))
+                {
+                    std::vector<unsigned int> factors{factor};
+                    std::copy(
+                        remain_factors.begin(), remain_factors.end(), std::back_inserter(factors));
+                    std::sort(factors.begin(), factors.end());
+                    ret.insert(factors);
+                }
+            }
+        }
+    }
+    // map references stay valid as more lengths are inserted
+    return memo.emplace(length, std::move(ret)).first->second;
+}
+
+std::set<std::vector<unsigned int>> factorize(unsigned int length)
+{
+    factorization_map memo;
+    return factorize(length, memo);
+}
+
+// Each thread should hold at most this many elements (or the largest
+// radix, if that's bigger) in registers.
+static const unsigned int MAX_ELEMS_PER_THREAD = 16;
+// Largest threads per transform and workgroup size that the
+// generated kernels use.
+static const unsigned int MAX_THREADS_PER_TRANSFORM = 256;
+static const unsigned int CONFIG_WORKGROUP_SIZE     = 256;
+// Workgroups are sized in whole wavefronts where possible.
+static const unsigned int CONFIG_WAVEFRONT_SIZE = 64;
+
+// Try to fit one factorization into a single kernel.
+static std::optional<StockhamConfig> configure_factors(unsigned int                     length,
+                                                       const std::vector<unsigned int>& factors)
+{
+    // use the fewest threads that keep each thread's registers within
+    // budget.  every thread needs at least one butterfly of the widest
+    // radix, and passes that don't divide evenly among the threads
+    // are done with guards.
+    const unsigned int max_factor = *std::max_element(factors.begin(), factors.end());
+    const unsigned int budget     = std::max(MAX_ELEMS_PER_THREAD, max_factor);
+    const unsigned int max_tpt    = std::min(length / max_factor, MAX_THREADS_PER_TRANSFORM);
+
+    StockhamConfig config;
+    config.factors = factors;
+    for(unsigned int t = DivRoundingUp(length, budget); t <= max_tpt; ++t)
+    {
+        if(StockhamKernel::compute_nregisters(length, factors, t) <= budget)
+        {
+            config.threads_per_transform = t;
+            break;
+        }
+    }
+    if(config.threads_per_transform == 0)
+        return std::nullopt;
+    const unsigned int tpt = config.threads_per_transform;
+
+    // half LDS needs every pass to divide evenly among the threads,
+    // since it can't do write guards
+    config.half_lds = length % tpt == 0 && std::all_of(factors.begin(), factors.end(), [=](auto f) {
+                          return (length / tpt) % f == 0;
+                      });
+
+    // a whole transform must fit into the generator's LDS budget
+    size_t bytes_per_batch = static_cast<size_t>(length) * StockhamKernel::BYTES_PER_ELEMENT;
+    if(config.half_lds)
+        bytes_per_batch /= 2;
+    if(bytes_per_batch > StockhamKernel::LDS_BYTE_LIMIT)
+        return std::nullopt;
+
+    // fill the workgroup with as many transforms as LDS allows, but
+    // keep the workgroup a whole number of wavefronts.  if that's
+    // not possible, leave the fewest lanes of the last wavefront idle.
+    const unsigned int max_tpb = std::min<unsigned int>(
+        StockhamKernel::LDS_BYTE_LIMIT / bytes_per_batch, CONFIG_WORKGROUP_SIZE / tpt);
+    const unsigned int tpb_step = CONFIG_WAVEFRONT_SIZE / std::gcd(tpt, CONFIG_WAVEFRONT_SIZE);
+    if(max_tpb >= tpb_step)
+    {
+        config.transforms_per_block = max_tpb - max_tpb % tpb_step;
+        return config;
+    }
+    auto idle_lanes = [=](unsigned int tpb) {
+        return DivRoundingUp(tpt * tpb, CONFIG_WAVEFRONT_SIZE) * CONFIG_WAVEFRONT_SIZE - tpt * tpb;
+    };
+    // compare idle lanes per transform
+    config.transforms_per_block = max_tpb;
+    for(unsigned int tpb = max_tpb - 1; tpb > 0; --tpb)
+    {
+        if(idle_lanes(tpb) * config.transforms_per_block
+           < idle_lanes(config.transforms_per_block) * tpb)
+            config.transforms_per_block = tpb;
+    }
+    return config;
+}
+
+std::optional<StockhamConfig> configure_stockham(size_t length)
+{
+    if(length < 2 || length > std::numeric_limits<unsigned int>::max())
+        return std::nullopt;
+
+    // reject lengths that can't fit before factorizing them, since
+    // long lengths have very many factorizations.  even with half
+    // LDS, the transform must fit into the LDS budget, and no thread
+    // holds more elements than the largest radix.
+    if(length * StockhamKernel::BYTES_PER_ELEMENT / 2 > StockhamKernel::LDS_BYTE_LIMIT)
+        return std::nullopt;
+    const unsigned int max_radix
+        = *std::max_element(supported_factors.begin(), supported_factors.end());
+    if(length > static_cast<size_t>(MAX_THREADS_PER_TRANSFORM)
+                    * std::max(MAX_ELEMS_PER_THREAD, max_radix))
+        return std::nullopt;
+
+    // prefer the fewest passes, and then the most even radices
+    auto                                   factorizations = factorize(length);
+    std::vector<std::vector<unsigned int>> candidates(factorizations.begin(),
+                                                      factorizations.end());
+    std::stable_sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        if(a.size() != b.size())
+            return a.size() < b.size();
+        return a.front() > b.front();
+    });
+    for(const auto& candidate : candidates)
+    {
+        // do the largest radix first, like most generated kernels
+        auto config = configure_factors(length, {candidate.rbegin(), candidate.rend()});
+        if(config)
+            return config;
+    }
+    return std::nullopt;
+}
@@ -21,6 +21,8 @@
 #include <functional>
 
 #include "../../shared/array_predicate.h"
+#include "function_pool.h"
+#include "rtc_stockham_config.h"
 #include "rtc_stockham_gen.h"
 
 using namespace std::placeholders;
@@ -35,29 +37,32 @@ using namespace std::placeholders;
 #include "device/generator/stockham_gen_rr.h"
 
 #include "device/generator/stockham_gen_2d.h"
+#include "device/generator/stockham_gen_3d.h"
 
 #include "device/kernel-generator-embed.h"
 
 // generate name for RTC stockham kernel
-std::string stockham_rtc_kernel_name(ComputeScheme           scheme,
-                                     size_t                  length1D,
-                                     size_t                  length2D,
-                                     size_t                  static_dim,
-                                     int                     direction,
-                                     rocfft_precision        precision,
-                                     rocfft_result_placement placement,
-                                     rocfft_array_type       inArrayType,
-                                     rocfft_array_type       outArrayType,
-                                     bool                    unitstride,
-                                     size_t                  largeTwdBase,
-                                     size_t                  largeTwdSteps,
-                                     bool                    largeTwdBatchIsTransformCount,
-                                     EmbeddedType            ebtype,
-                                     DirectRegType           dir2regMode,
-                                     IntrinsicAccessType     intrinsicMode,
-                                     SBRC_TRANSPOSE_TYPE     transpose_type,
-                                     bool                    enable_callbacks,
-                                     bool                    enable_scaling)
+std::string stockham_rtc_kernel_name(ComputeScheme            scheme,
+                                     size_t                   length1D,
+                                     size_t                   length2D,
+                                     size_t                   length3D,
+                                     size_t                   static_dim,
+                                     int                      direction,
+                                     rocfft_precision         precision,
+                                     rocfft_storage_precision storage,
+                                     rocfft_result_placement  placement,
+                                     rocfft_array_type        inArrayType,
+                                     rocfft_array_type        outArrayType,
+                                     bool                     unitstride,
+                                     size_t                   largeTwdBase,
+                                     size_t                   largeTwdSteps,
+                                     bool                     largeTwdBatchIsTransformCount,
+                                     EmbeddedType             ebtype,
+                                     DirectRegType            dir2regMode,
+                                     IntrinsicAccessType      intrinsicMode,
+                                     SBRC_TRANSPOSE_TYPE      transpose_type,
+                                     bool                     enable_callbacks,
+                                     bool                     enable_scaling)
 {
     std::string kernel_name = "fft_rtc";
 
@@ -70,6 +75,8 @@ std::string stockham_rtc_kernel_name(ComputeScheme           scheme,
     kernel_name += std::to_string(length1D);
     if(length2D)
         kernel_name += "x" + std::to_string(length2D);
+    if(length3D)
+        kernel_name += "x" + std::to_string(length3D);
 
     if(static_dim)
     {
@@ -78,6 +85,7 @@ std::string stockham_rtc_kernel_name(ComputeScheme           scheme,
     }
 
     kernel_name += rtc_precision_name(precision);
+    kernel_name += rtc_storage_name(storage);
 
     if(placement == rocfft_placement_inplace)
     {
@@ -106,8 +114,9 @@ std::string stockham_rtc_kernel_name(ComputeScheme           scheme,
         kernel_name += "_sbcr";
         break;
     case CS_KERNEL_2D_SINGLE:
-        // both lengths were already added above, which indicates it's
-        // 2D_SINGLE
+    case CS_KERNEL_3D_SINGLE:
+        // all lengths were already added above, which indicates it's
+        // 2D_SINGLE or 3D_SINGLE
         break;
     case CS_KERNEL_STOCKHAM_BLOCK_RC:
     {
@@ -171,8 +180,10 @@ std::string stockham_rtc_kernel_name(ComputeScheme           scheme,
     if(dir2regMode == DirectRegType::TRY_ENABLE_IF_SUPPORT)
         kernel_name += "_dirReg";
 
-    // callback kernels need to disable buffer load/store
-    if(enable_callbacks || dir2regMode == DirectRegType::FORCE_OFF_OR_NOT_SUPPORT)
+    // callback and mixed-precision kernels need to disable buffer
+    // load/store
+    if(enable_callbacks || dir2regMode == DirectRegType::FORCE_OFF_OR_NOT_SUPPORT
+       || storage != rocfft_storage_precision_native)
         intrinsicMode = IntrinsicAccessType::DISABLE_BOTH;
 
     switch(intrinsicMode)
@@ -196,11 +207,13 @@ std::string stockham_rtc_kernel_name(ComputeScheme           scheme,
 
 std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
                          const StockhamGeneratorSpecs& specs2d,
+                         const StockhamGeneratorSpecs& specs3d,
                          unsigned int*                 transforms_per_block,
                          const std::string&            kernel_name,
                          ComputeScheme                 scheme,
                          int                           direction,
                          rocfft_precision              precision,
+                         rocfft_storage_precision      storage,
                          rocfft_result_placement       placement,
                          rocfft_array_type             inArrayType,
                          rocfft_array_type             outArrayType,
@@ -217,11 +230,43 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
 {
     std::unique_ptr<Function> lds2reg, reg2lds, device;
     std::unique_ptr<Function> lds2reg1, reg2lds1, device1;
+    std::unique_ptr<Function> lds2reg2, reg2lds2, device2;
     std::unique_ptr<Function> global;
 
     std::vector<unsigned int> all_factors;
 
-    if(scheme == CS_KERNEL_2D_SINGLE)
+    if(scheme == CS_KERNEL_3D_SINGLE)
+    {
+        StockhamKernelFused3D kernel(specs, specs2d, specs3d);
+        if(transforms_per_block)
+            *transforms_per_block = kernel.transforms_per_block;
+        lds2reg = std::make_unique<Function>(kernel.kernel0.generate_lds_to_reg_input_function());
+        reg2lds
+            = std::make_unique<Function>(kernel.kernel0.generate_lds_from_reg_output_function());
+        device = std::make_unique<Function>(kernel.kernel0.generate_device_function());
+        // dimensions of the same length share device functions
+        if(kernel.kernel1.length != kernel.kernel0.length)
+        {
+            lds2reg1
+                = std::make_unique<Function>(kernel.kernel1.generate_lds_to_reg_input_function());
+            reg2lds1 = std::make_unique<Function>(
+                kernel.kernel1.generate_lds_from_reg_output_function());
+            device1 = std::make_unique<Function>(kernel.kernel1.generate_device_function());
+        }
+        if(kernel.kernel2.length != kernel.kernel0.length
+           && kernel.kernel2.length != kernel.kernel1.length)
+        {
+            lds2reg2
+                = std::make_unique<Function>(kernel.kernel2.generate_lds_to_reg_input_function());
+            reg2lds2 = std::make_unique<Function>(
+                kernel.kernel2.generate_lds_from_reg_output_function());
+            device2 = std::make_unique<Function>(kernel.kernel2.generate_device_function());
+        }
+        global = std::make_unique<Function>(kernel.generate_global_function());
+
+        all_factors = kernel.launcher_factors();
+    }
+    else if(scheme == CS_KERNEL_2D_SINGLE)
     {
         StockhamKernelFused2D kernel(specs, specs2d);
         if(transforms_per_block)
@@ -284,11 +329,15 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
         *device = make_inverse(*device);
         if(device1)
             *device1 = make_inverse(*device1);
+        if(device2)
+            *device2 = make_inverse(*device2);
         *global = make_inverse(*global);
     }
     if(placement == rocfft_placement_notinplace)
     {
         *global = make_outofplace(*global);
+        if(storage != rocfft_storage_precision_native)
+            *global = make_storage(*global, {"buf_in", "buf_out"});
         if(array_type_is_planar(inArrayType))
             *global = make_planar(*global, "buf_in");
         if(array_type_is_planar(outArrayType))
@@ -296,6 +345,8 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
     }
     else
     {
+        if(storage != rocfft_storage_precision_native)
+            *global = make_storage(*global, {"buf"});
         if(array_type_is_planar(inArrayType))
             *global = make_planar(*global, "buf");
     }
@@ -326,10 +377,18 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
         src += reg2lds1->render();
     if(device1)
         src += device1->render();
+    if(lds2reg2)
+        src += lds2reg2->render();
+    if(reg2lds2)
+        src += reg2lds2->render();
+    if(device2)
+        src += device2->render();
 
     // make_rtc removes templates from global function - add typedefs
     // and constants to replace them
     src += rtc_precision_type_decl(precision);
+    if(storage != rocfft_storage_precision_native)
+        src += rtc_storage_type_decl(storage);
     if(unit_stride)
         src += "static const StrideBin sb = SB_UNIT;\n";
     else
@@ -394,8 +453,10 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
     src += "static const bool apply_large_twiddle = ";
     src += (largeTwdBase > 0 && largeTwdSteps > 0) ? "true;\n" : "false;\n";
 
-    // callback kernels need to disable buffer load/store
-    if(enable_callbacks || dir2regMode == DirectRegType::FORCE_OFF_OR_NOT_SUPPORT)
+    // callback and mixed-precision kernels need to disable buffer
+    // load/store
+    if(enable_callbacks || dir2regMode == DirectRegType::FORCE_OFF_OR_NOT_SUPPORT
+       || storage != rocfft_storage_precision_native)
         intrinsicMode = IntrinsicAccessType::DISABLE_BOTH;
 
     switch(intrinsicMode)
@@ -420,3 +481,30 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
     src += make_rtc(*global, kernel_name, enable_scaling).render();
     return src;
 }
+
+std::optional<FFTKernel> configure_stockham_kernel(size_t length)
+{
+#ifdef ROCFFT_RUNTIME_COMPILE
+    auto config = configure_stockham(length);
+    if(!config)
+        return std::nullopt;
+
+    // half LDS kernels also go directly to and from registers.
+    // uneven kernels need full LDS and write guards, so they go
+    // through LDS like the generated kernels of that kind.
+    std::vector<size_t> factors(config->factors.begin(), config->factors.end());
+    const int           tpt = static_cast<int>(config->threads_per_transform);
+    const int           tpb = static_cast<int>(config->transforms_per_block);
+    return FFTKernel(nullptr,
+                     false,
+                     std::move(factors),
+                     tpb,
+                     tpt * tpb,
+                     {tpt, 0, 0},
+                     config->half_lds,
+                     config->half_lds);
+#else
+    // kernels that aren't in the pool need runtime compilation
+    return std::nullopt;
+#endif
+}
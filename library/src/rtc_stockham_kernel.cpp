@@ -37,9 +37,13 @@ RTCKernel::RTCGenerator RTCKernelStockham::generate_from_node(const TreeNode&
 
     std::optional<StockhamGeneratorSpecs> specs;
     std::optional<StockhamGeneratorSpecs> specs2d;
+    std::optional<StockhamGeneratorSpecs> specs3d;
 
     // if scale factor is enabled, we force RTC for this kernel
     bool enable_scaling = node.IsScalingEnabled();
+    // precompiled kernels only handle buffers of the compute
+    // precision, so mixed-precision storage also forces RTC
+    const bool mixed_storage = node.storage != rocfft_storage_precision_native;
 
     SBRC_TRANSPOSE_TYPE transpose_type = NONE;
 
@@ -77,7 +81,8 @@ RTCKernel::RTCGenerator RTCKernelStockham::generate_from_node(const TreeNode&
         // if a kernel is already precompiled, just use that.  but
         // changing largeTwdBatch transform count requires RTC, so we
         // can't use a precompiled kernel in that case.
-        if(kernel->device_function && !enable_scaling && !node.largeTwdBatchIsTransformCount)
+        if(kernel->device_function && !enable_scaling && !mixed_storage
+           && !node.largeTwdBatchIsTransformCount)
         {
             return generator;
         }
@@ -103,52 +108,56 @@ RTCKernel::RTCGenerator RTCKernelStockham::generate_from_node(const TreeNode&
         specs->threads_per_transform = kernel->threads_per_transform[0];
         specs->half_lds              = kernel->half_lds;
         specs->direct_to_from_reg    = kernel->direct_to_from_reg;
+        specs->cross_lane_exchange   = kernel->cross_lane_exchange;
         break;
     }
     case CS_KERNEL_2D_SINGLE:
+    case CS_KERNEL_3D_SINGLE:
     {
-        key    = fpkey(node.length[0], node.length[1], node.precision, node.scheme);
-        kernel = pool.get_kernel(key);
+        std::vector<size_t> lengths(node.length.begin(),
+                                    node.length.begin()
+                                        + (node.scheme == CS_KERNEL_3D_SINGLE ? 3 : 2));
+        kernel = function_pool::get_fused_kernel(lengths, node.precision);
         // already precompiled?
-        if(kernel->device_function && !enable_scaling)
+        if(kernel->device_function && !enable_scaling && !mixed_storage)
         {
             return generator;
         }
 
-        std::vector<unsigned int> factors1d;
-        std::vector<unsigned int> factors2d;
         std::vector<unsigned int> precisions = {static_cast<unsigned int>(node.precision)};
 
-        // need to break down factors into first dim and second dim
-        size_t len0_remain = node.length[0];
-        for(auto& f : kernel->factors)
-        {
-            len0_remain /= f;
-            if(len0_remain > 0)
-            {
-                factors1d.push_back(f);
-            }
-            else
-            {
-                factors2d.push_back(f);
-            }
-        }
+        // need to break down factors into each dimension
+        auto factors_per_dim = kernel->factors_per_dim(lengths);
+        std::vector<std::vector<unsigned int>> factors;
+        for(auto& f : factors_per_dim)
+            factors.emplace_back(f.begin(), f.end());
 
-        specs.emplace(factors1d,
-                      factors2d,
+        specs.emplace(factors[0],
+                      factors[1],
                       precisions,
                       static_cast<unsigned int>(kernel->workgroup_size),
                       PrintScheme(node.scheme));
         specs->threads_per_transform = kernel->threads_per_transform[0];
         specs->half_lds              = kernel->half_lds;
 
-        specs2d.emplace(factors2d,
-                        factors1d,
+        specs2d.emplace(factors[1],
+                        factors[0],
                         precisions,
                         static_cast<unsigned int>(kernel->workgroup_size),
                         PrintScheme(node.scheme));
         specs2d->threads_per_transform = kernel->threads_per_transform[1];
         specs2d->half_lds              = kernel->half_lds;
+
+        if(node.scheme == CS_KERNEL_3D_SINGLE)
+        {
+            specs3d.emplace(factors[2],
+                            std::vector<unsigned int>(),
+                            precisions,
+                            static_cast<unsigned int>(kernel->workgroup_size),
+                            PrintScheme(node.scheme));
+            specs3d->threads_per_transform = kernel->threads_per_transform[2];
+            specs3d->half_lds              = kernel->half_lds;
+        }
         break;
     }
     default:
@@ -172,13 +181,19 @@ RTCKernel::RTCGenerator RTCKernelStockham::generate_from_node(const TreeNode&
                            ? (node.inStride[1] == 1 && node.outStride[1] == 1)
                            : (node.inStride.front() == 1 && node.outStride.front() == 1);
 
+    // fused kernels are named by all of the lengths they transform
+    size_t length2D = specs2d ? node.length[1] : 0;
+    size_t length3D = specs3d ? node.length[2] : 0;
+
     generator.generate_name = [=, &node]() {
         return stockham_rtc_kernel_name(node.scheme,
                                         node.length[0],
-                                        node.scheme == CS_KERNEL_2D_SINGLE ? node.length[1] : 0,
+                                        length2D,
+                                        length3D,
                                         static_dim,
                                         node.direction,
                                         node.precision,
+                                        node.storage,
                                         node.placement,
                                         node.inArrayType,
                                         node.outArrayType,
@@ -197,11 +212,13 @@ RTCKernel::RTCGenerator RTCKernelStockham::generate_from_node(const TreeNode&
     generator.generate_src = [=, &node](const std::string& kernel_name) {
         return stockham_rtc(*specs,
                             specs2d ? *specs2d : *specs,
+                            specs3d ? *specs3d : *specs,
                             nullptr,
                             kernel_name,
                             node.scheme,
                             node.direction,
                             node.precision,
+                            node.storage,
                             node.placement,
                             node.inArrayType,
                             node.outArrayType,
@@ -33,6 +33,17 @@ std::string transpose_rtc_kernel_name(const TransposeSpecs& specs)
     kernel_name += std::to_string(specs.tileX);
     kernel_name += "x";
     kernel_name += std::to_string(specs.tileY);
+    kernel_name += "_";
+    kernel_name += std::to_string(specs.threads);
+    kernel_name += "threads";
+
+    if(specs.vecIn > 1 || specs.vecOut > 1)
+    {
+        kernel_name += "_vec";
+        kernel_name += std::to_string(specs.vecIn);
+        kernel_name += "x";
+        kernel_name += std::to_string(specs.vecOut);
+    }
 
     // 2D + 3D kernels are specialized to omit loops
     switch(specs.dim)
@@ -48,6 +59,7 @@ std::string transpose_rtc_kernel_name(const TransposeSpecs& specs)
     }
 
     kernel_name += rtc_precision_name(specs.precision);
+    kernel_name += rtc_storage_name(specs.storage);
     kernel_name += rtc_array_type_name(specs.inArrayType);
     kernel_name += rtc_array_type_name(specs.outArrayType);
 
@@ -85,6 +97,8 @@ std::string transpose_rtc(const std::string& kernel_name, const TransposeSpecs&
     src += callback_h;
 
     src += rtc_precision_type_decl(specs.precision);
+    if(specs.storage != rocfft_storage_precision_native)
+        src += rtc_storage_type_decl(specs.storage);
 
     src += rtc_const_cbtype_decl(specs.enable_callbacks);
 
@@ -113,7 +127,7 @@ std::string transpose_rtc(const std::string& kernel_name, const TransposeSpecs&
     Variable scale_factor_var{"scale_factor", "const real_type_t<scalar_type>"};
 
     Function func(kernel_name);
-    func.launch_bounds = specs.tileX * specs.tileY;
+    func.launch_bounds = specs.threads;
     func.qualifier     = "extern \"C\" __global__";
 
     func.arguments.append(input_var);
@@ -138,17 +152,33 @@ std::string transpose_rtc(const std::string& kernel_name, const TransposeSpecs&
         func.arguments.append(arg);
     func.arguments.append(scale_factor_var);
 
-    // we use tileX*tileX tiles - tileY must evenly divide into
-    // tileX, so that elems_per_thread is integral
-    if(specs.tileX % specs.tileY != 0)
+    // Reading, each row of the tile is covered by tileX/vecIn
+    // threads, so the block covers some number of rows per
+    // iteration.  Writing, each column is covered by tileY/vecOut
+    // threads.  Both must divide the tile evenly.
+    if(specs.vecIn == 0 || specs.vecOut == 0 || specs.tileX % specs.vecIn != 0
+       || specs.tileY % specs.vecOut != 0)
+        throw std::runtime_error("transpose vector width does not divide tile");
+    // wide accesses bypass the callback and planar load/store paths
+    if((specs.vecIn > 1 || specs.vecOut > 1) && specs.enable_callbacks)
+        throw std::runtime_error("vectorized transpose does not support callbacks");
+    if((specs.vecIn > 1 && array_type_is_planar(specs.inArrayType))
+       || (specs.vecOut > 1 && array_type_is_planar(specs.outArrayType)))
+        throw std::runtime_error("vectorized transpose does not support planar data");
+    const unsigned int threads_per_row = specs.tileX / specs.vecIn;
+    const unsigned int threads_per_col = specs.tileY / specs.vecOut;
+    if(specs.threads % threads_per_row != 0 || specs.threads % threads_per_col != 0)
+        throw std::runtime_error("transpose threads do not cover tile");
+    const unsigned int rows_per_iter = specs.threads / threads_per_row;
+    const unsigned int cols_per_iter = specs.threads / threads_per_col;
+    if(specs.tileY % rows_per_iter != 0 || specs.tileX % cols_per_iter != 0)
         throw std::runtime_error("non-integral transpose ELEMS_PER_THREAD");
-    auto elems_per_thread = specs.tileX / specs.tileY;
-    if(elems_per_thread == 0)
-        throw std::runtime_error("zero transpose ELEMS_PER_THREAD");
+    const unsigned int read_iters  = specs.tileY / rows_per_iter;
+    const unsigned int write_iters = specs.tileX / cols_per_iter;
 
-    // lds is a 2D array
+    // lds is a 2D array, indexed by column then row
     Variable lds{"lds", "__shared__ scalar_type", false, false, specs.tileX};
-    lds.size2D = Literal{specs.tileX};
+    lds.size2D = Literal{specs.tileY};
     func.body += Declaration{lds};
 
     Variable tileBlockIdx_y{"tileBlockIdx_y", "unsigned int"};
@@ -173,10 +203,10 @@ std::string transpose_rtc(const std::string& kernel_name, const TransposeSpecs&
         func.body += Assign{length2_var, 1};
     }
 
-    Variable tile_x_index{"tile_x_index", "unsigned int"};
-    Variable tile_y_index{"tile_y_index", "unsigned int"};
-    func.body += Declaration{tile_x_index, "threadIdx.x"};
-    func.body += Declaration{tile_y_index, "threadIdx.y"};
+    Variable thread_id{"thread_id", "unsigned int"};
+    Variable tile_col{"tile_col", "unsigned int"};
+    Variable tile_row{"tile_row", "unsigned int"};
+    func.body += Declaration{thread_id, "threadIdx.x"};
 
     func.body += CommentLines{"work out offset for dimensions after the first 3"};
     Variable remaining{"remaining", "unsigned int"};
@@ -222,12 +252,20 @@ std::string transpose_rtc(const std::string& kernel_name, const TransposeSpecs&
     Variable elem{"elem", "scalar_type"};
     Variable twl_idx{"twl_idx", "auto"};
 
-    For read_loop{i, 0, i < elems_per_thread, 1};
+    // wide loads/stores move vec elements at once
+    auto vec_type = [](unsigned int vec) {
+        return "complex_vec<scalar_type, " + std::to_string(vec) + ">";
+    };
+    Variable vec_in{"vec_in", vec_type(specs.vecIn)};
+    Variable vec_out{"vec_out", vec_type(specs.vecOut)};
+
+    For read_loop{i, 0, i < read_iters, 1};
     read_loop.pragma_unroll = true;
 
-    read_loop.body
-        += Declaration{logical_row, specs.tileX * tileBlockIdx_y + tile_y_index + i * specs.tileY};
-    read_loop.body += Declaration{idx0, specs.tileX * tileBlockIdx_x + tile_x_index};
+    read_loop.body += Declaration{tile_row, thread_id / threads_per_row + i * rows_per_iter};
+    read_loop.body += Declaration{tile_col, thread_id % threads_per_row * specs.vecIn};
+    read_loop.body += Declaration{logical_row, specs.tileY * tileBlockIdx_y + tile_row};
+    read_loop.body += Declaration{idx0, specs.tileX * tileBlockIdx_x + tile_col};
     read_loop.body += Declaration{idx1, logical_row};
     if(specs.dim != 2)
         read_loop.body += ModulusAssign(idx1, length1_var);
@@ -237,6 +275,8 @@ std::string transpose_rtc(const std::string& kernel_name, const TransposeSpecs&
     else
         read_loop.body += Declaration{idx2, logical_row / length1_var};
 
+    // vectors never straddle the end of length0, so checking the
+    // first element of a vector is enough
     if(!specs.tileAligned)
     {
         read_loop.body
@@ -246,47 +286,61 @@ std::string transpose_rtc(const std::string& kernel_name, const TransposeSpecs&
     read_loop.body += Declaration{global_read_idx,
                                   idx0 * stride_in0_var + idx1 * stride_in1_var
                                       + idx2 * stride_in2_var + offset_in};
+    if(specs.vecIn > 1)
+        read_loop.body += Declaration{
+            vec_in,
+            CallExpr{"load_complex_vec<" + std::to_string(specs.vecIn) + ">",
+                     {input_var, global_read_idx}}};
     read_loop.body += Declaration{elem};
-    read_loop.body += Assign{elem, LoadGlobal{input_var, global_read_idx}};
-
-    if(specs.largeTwdSteps)
+    for(unsigned int v = 0; v < specs.vecIn; ++v)
     {
-        auto twiddle_mul_macro
-            = specs.largeTwdDirection == -1 ? "TWIDDLE_STEP_MUL_FWD" : "TWIDDLE_STEP_MUL_INV";
-        std::string twiddle_step_func = "TWLstep" + std::to_string(specs.largeTwdSteps);
-
-        read_loop.body += Declaration{twl_idx, idx0 * idx1};
-        read_loop.body
-            += Call{twiddle_mul_macro, {twiddle_step_func, twiddles_large_var, twl_idx, elem}};
+        if(specs.vecIn > 1)
+            read_loop.body += Assign{elem, Variable{"vec_in.v", ""}[v]};
+        else
+            read_loop.body += Assign{elem, LoadGlobal{input_var, global_read_idx}};
+
+        if(specs.largeTwdSteps)
+        {
+            auto twiddle_mul_macro
+                = specs.largeTwdDirection == -1 ? "TWIDDLE_STEP_MUL_FWD" : "TWIDDLE_STEP_MUL_INV";
+            std::string twiddle_step_func = "TWLstep" + std::to_string(specs.largeTwdSteps);
+
+            if(v == 0)
+                read_loop.body += Declaration{twl_idx, idx0 * idx1};
+            else
+                read_loop.body += AddAssign(twl_idx, idx1);
+            read_loop.body
+                += Call{twiddle_mul_macro, {twiddle_step_func, twiddles_large_var, twl_idx, elem}};
+        }
+        read_loop.body += Assign{lds.at(tile_col + v, tile_row), elem};
     }
-    read_loop.body += Assign{lds.at(tile_x_index, i * specs.tileY + tile_y_index), elem};
 
     func.body += read_loop;
 
     func.body += SyncThreads{};
 
-    Variable val{"val", "scalar_type", false, false, elems_per_thread};
+    Variable val{"val", "scalar_type", false, false, write_iters * specs.vecOut};
     func.body += Declaration{val};
 
     func.body += CommentLines{"reallocate threads to write along fastest dim (length1) and",
                               "read transposed from LDS"};
-    func.body += Assign{tile_x_index, "threadIdx.y"};
-    func.body += Assign{tile_y_index, "threadIdx.x"};
-
-    For transpose_loop{i,
-                       0,
-                       i < elems_per_thread,
-                       1,
-                       {Assign{val[i], lds.at(tile_x_index + i * specs.tileY, tile_y_index)}}};
+
+    For transpose_loop{i, 0, i < write_iters, 1};
     transpose_loop.pragma_unroll = true;
+    transpose_loop.body += Declaration{tile_col, thread_id / threads_per_col + i * cols_per_iter};
+    transpose_loop.body += Declaration{tile_row, thread_id % threads_per_col * specs.vecOut};
+    for(unsigned int v = 0; v < specs.vecOut; ++v)
+        transpose_loop.body
+            += Assign{val[i * specs.vecOut + v], lds.at(tile_col, tile_row + v)};
     func.body += transpose_loop;
 
-    For write_loop{i, 0, i < elems_per_thread, 1};
+    For write_loop{i, 0, i < write_iters, 1};
     write_loop.pragma_unroll = true;
 
-    write_loop.body
-        += Declaration{logical_col, specs.tileX * tileBlockIdx_x + tile_x_index + i * specs.tileY};
-    write_loop.body += Declaration{logical_row, specs.tileX * tileBlockIdx_y + tile_y_index};
+    write_loop.body += Declaration{tile_col, thread_id / threads_per_col + i * cols_per_iter};
+    write_loop.body += Declaration{tile_row, thread_id % threads_per_col * specs.vecOut};
+    write_loop.body += Declaration{logical_col, specs.tileX * tileBlockIdx_x + tile_col};
+    write_loop.body += Declaration{logical_row, specs.tileY * tileBlockIdx_y + tile_row};
 
     write_loop.body += Declaration{idx0, logical_col};
     write_loop.body += Declaration{idx1, logical_row};
@@ -307,13 +361,28 @@ std::string transpose_rtc(const std::string& kernel_name, const TransposeSpecs&
     write_loop.body += Declaration{global_write_idx,
                                    idx0 * stride_out0_var + idx1 * stride_out1_var
                                        + idx2 * stride_out2_var + offset_out};
-    if(specs.enable_scaling)
-        write_loop.body += MultiplyAssign(val[i], scale_factor_var);
+    if(specs.vecOut > 1)
+        write_loop.body += Declaration{vec_out};
+    for(unsigned int v = 0; v < specs.vecOut; ++v)
+    {
+        auto out_elem = val[i * specs.vecOut + v];
+        if(specs.enable_scaling)
+            write_loop.body += MultiplyAssign(out_elem, scale_factor_var);
 
-    write_loop.body += StoreGlobal{output_var, global_write_idx, val[i]};
+        if(specs.vecOut > 1)
+            write_loop.body += Assign{Variable{"vec_out.v", ""}[v], out_elem};
+        else
+            write_loop.body += StoreGlobal{output_var, global_write_idx, out_elem};
+    }
+    if(specs.vecOut > 1)
+        write_loop.body
+            += Call{"store_complex_vec<" + std::to_string(specs.vecOut) + ">",
+                    {output_var, global_write_idx, vec_out}};
 
     func.body += write_loop;
 
+    if(specs.storage != rocfft_storage_precision_native)
+        func = make_storage(func, {"input", "output", "vec_in", "vec_out"});
     if(array_type_is_planar(specs.inArrayType))
         func = make_planar(func, "input");
     if(array_type_is_planar(specs.outArrayType))
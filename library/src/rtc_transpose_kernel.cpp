@@ -37,20 +37,19 @@ RTCKernel::RTCGenerator RTCKernelTranspose::generate_from_node(const TreeNode&
        && node.scheme != CS_KERNEL_TRANSPOSE_Z_XY)
         return generator;
 
-    unsigned int tileX = node.precision == rocfft_precision_single ? 64 : 32;
-    unsigned int tileY = node.precision == rocfft_precision_single ? 16 : 32;
+    auto tiling = static_cast<const TransposeNode&>(node).SelectTiling(enable_callbacks);
 
-    // grid Y counts rows on dims Y+Z, sliced into tiles of tileX.
+    // grid Y counts rows on dims Y+Z, sliced into tiles of tileY.
     // grid Z counts any dims beyond Y+Z, plus batch
     unsigned int gridYrows = length[1] * (length.size() > 2 ? length[2] : 1);
     auto         highdim   = std::min<size_t>(length.size(), 3);
     unsigned int gridZ     = std::accumulate(
         length.begin() + highdim, length.end(), node.batch, std::multiplies<unsigned int>());
 
-    generator.gridDim  = {DivRoundingUp<unsigned int>(length[0], tileX),
-                         DivRoundingUp<unsigned int>(gridYrows, tileX),
+    generator.gridDim  = {DivRoundingUp<unsigned int>(length[0], tiling.tileX),
+                         DivRoundingUp<unsigned int>(gridYrows, tiling.tileY),
                          gridZ};
-    generator.blockDim = {tileX, tileY};
+    generator.blockDim = {tiling.threads};
 
     size_t largeTwdSteps = 0;
     if(node.large1D > (size_t)256 * 256 * 256 * 256)
@@ -65,24 +64,21 @@ RTCKernel::RTCGenerator RTCKernelTranspose::generate_from_node(const TreeNode&
     else if(node.large1D > 0)
         largeTwdSteps = 1;
 
-    // check the length along the fast output dimension to decide if
-    // we should do diagonal block ordering
-    size_t fastOut = node.length[1];
-    // diagonal ordering only seems to help 2D cases, not 3D
-    bool diagonal = (fastOut % 256) == 0 && (node.outStride[0] % 256 == 0)
-                    && node.scheme == CS_KERNEL_TRANSPOSE;
+    bool tileAligned = node.length[0] % tiling.tileX == 0 && node.length[1] % tiling.tileY == 0;
 
-    bool tileAligned = node.length[0] % tileX == 0 && node.length[1] % tileX == 0;
-
-    TransposeSpecs specs{tileX,
-                         tileY,
+    TransposeSpecs specs{tiling.tileX,
+                         tiling.tileY,
+                         tiling.threads,
+                         tiling.vecIn,
+                         tiling.vecOut,
                          node.length.size(),
                          node.precision,
+                         node.storage,
                          node.inArrayType,
                          node.outArrayType,
                          largeTwdSteps,
                          node.direction,
-                         diagonal,
+                         tiling.diagonal,
                          tileAligned,
                          enable_callbacks,
                          node.IsScalingEnabled()};
@@ -0,0 +1,745 @@
+// Copyright (C) 2023 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../../shared/array_predicate.h"
+#include "../../shared/gpubuf.h"
+#include "logging.h"
+#include "plan.h"
+#include "rocfft.h"
+#include "streaming.h"
+#include "transform.h"
+
+// Number of device slots that chunks rotate through.  With three,
+// one chunk can be copied in while another is transformed and a
+// third is copied out.
+static const size_t STREAMING_SLOTS = 3;
+
+struct StreamingSlot
+{
+    gpubuf in;
+    gpubuf out;
+    gpubuf work;
+    // every slot has a stream of its own, so that none of them is
+    // serialized with other work on the stream given at execution
+    // time
+    hipStream_t stream = nullptr;
+    hipEvent_t  event  = nullptr;
+
+    StreamingSlot() = default;
+    ~StreamingSlot()
+    {
+        if(stream)
+            (void)hipStreamDestroy(stream);
+        if(event)
+            (void)hipEventDestroy(event);
+    }
+    StreamingSlot(const StreamingSlot&) = delete;
+    StreamingSlot& operator=(const StreamingSlot&) = delete;
+};
+
+// transforms for one pass, for a full chunk and for the remainder
+// chunk (if any)
+struct StreamingTransforms
+{
+    std::unique_ptr<rocfft_plan_t> full;
+    std::unique_ptr<rocfft_plan_t> remainder;
+    // if the transforms have a callback that needs to know where a
+    // chunk starts: the first item of each chunk, in device memory,
+    // which is given to the callback as its data
+    gpubuf chunk_starts;
+};
+
+struct StreamingPlan
+{
+    std::vector<StreamingPass>                 passes;
+    std::vector<StreamingTransforms>           transforms;
+    std::array<StreamingSlot, STREAMING_SLOTS> slots;
+    // recorded on the stream given at execution time, so that the
+    // slots' streams can wait for the caller's work
+    hipEvent_t user_event = nullptr;
+
+    StreamingPlan() = default;
+    ~StreamingPlan()
+    {
+        if(user_event)
+            (void)hipEventDestroy(user_event);
+    }
+    StreamingPlan(const StreamingPlan&) = delete;
+    StreamingPlan& operator=(const StreamingPlan&) = delete;
+};
+
+// Parameters for the device transform run on each chunk of a pass.
+// Data in a slot always starts at offset 0.
+struct StreamingTransformParams
+{
+    rocfft_result_placement   placement;
+    rocfft_transform_type     type;
+    std::vector<size_t>       lengths;
+    rocfft_plan_description_t desc;
+};
+
+static std::unique_ptr<rocfft_plan_t>
+    create_chunk_transform(rocfft_plan plan, const StreamingTransformParams& params, size_t batch)
+{
+    rocfft_plan chunkPlan = nullptr;
+    rocfft_plan_allocate(&chunkPlan);
+    std::unique_ptr<rocfft_plan_t> ret(chunkPlan);
+
+    auto desc = params.desc;
+    if(rocfft_plan_create_internal(chunkPlan,
+                                   params.placement,
+                                   params.type,
+                                   plan->precision,
+                                   params.lengths.size(),
+                                   params.lengths.data(),
+                                   batch,
+                                   &desc)
+       != rocfft_status_success)
+        throw std::runtime_error("failed to create streaming chunk transform");
+    return ret;
+}
+
+// Choose the number of items per chunk for a pass, and create its
+// transforms.  Each item needs item_bytes of slot memory, and the
+// slot memory plus the transform's work buffer must fit in
+// slot_bytes.  Returns false if not even one item fits.
+static bool fit_pass(rocfft_plan                                            plan,
+                     StreamingPass&                                         pass,
+                     size_t                                                 count,
+                     size_t                                                 item_bytes,
+                     size_t                                                 slot_bytes,
+                     const std::function<StreamingTransformParams(size_t)>& params,
+                     StreamingTransforms&                                   transforms)
+{
+    size_t chunk = std::min(count, slot_bytes / item_bytes);
+    while(chunk > 0)
+    {
+        transforms.full = create_chunk_transform(plan, params(chunk), chunk);
+        transforms.remainder.reset();
+        const size_t rem = count % chunk;
+        if(rem)
+            transforms.remainder = create_chunk_transform(plan, params(rem), rem);
+
+        size_t work = transforms.full->WorkBufBytes();
+        if(transforms.remainder)
+            work = std::max(work, transforms.remainder->WorkBufBytes());
+        const size_t total = chunk * item_bytes + work;
+        if(total <= slot_bytes)
+        {
+            pass.chunk_items = chunk;
+            return true;
+        }
+
+        // work memory is roughly proportional to the chunk size, so
+        // shrink by the amount we're over
+        auto estimate = static_cast<size_t>(static_cast<double>(slot_bytes) / total * chunk);
+        chunk         = std::min(chunk - 1, estimate);
+    }
+    return false;
+}
+
+static size_t elem_bytes(rocfft_array_type type, size_t base_type_size)
+{
+    return array_type_is_complex(type) ? 2 * base_type_size : base_type_size;
+}
+
+// bytes spanned by one transform's data, given its lengths and strides
+static size_t span_elems(const std::vector<size_t>& lengths, const std::array<size_t, 3>& strides)
+{
+    size_t span = 1;
+    for(size_t i = 0; i < lengths.size(); ++i)
+        span += (lengths[i] - 1) * strides[i];
+    return span;
+}
+
+// Stream whole transforms of the batch.  The device keeps the
+// user's strides and distance, so the chunk transform is the user's
+// transform with a smaller batch.
+static bool plan_batch_split(rocfft_plan plan, size_t slot_bytes)
+{
+    auto& sp = *plan->streaming;
+
+    std::vector<size_t> iLength(plan->lengths.begin(), plan->lengths.begin() + plan->rank);
+    std::vector<size_t> oLength = iLength;
+    if(plan->transformType == rocfft_transform_type_real_forward)
+        oLength.front() = oLength.front() / 2 + 1;
+    if(plan->transformType == rocfft_transform_type_real_inverse)
+        iLength.front() = iLength.front() / 2 + 1;
+
+    const size_t inElem  = elem_bytes(plan->desc.inArrayType, plan->base_type_size);
+    const size_t outElem = elem_bytes(plan->desc.outArrayType, plan->base_type_size);
+    const size_t inSpan  = span_elems(iLength, plan->desc.inStrides) * inElem;
+    const size_t outSpan = span_elems(oLength, plan->desc.outStrides) * outElem;
+    const size_t inDist  = plan->desc.inDist * inElem;
+    const size_t outDist = plan->desc.outDist * outElem;
+
+    // transforms must not interleave with each other, unless there's
+    // only one of them
+    if(plan->batch > 1 && (inDist < inSpan || outDist < outSpan))
+        return false;
+
+    const bool inplace = plan->placement == rocfft_placement_inplace;
+
+    StreamingPass pass;
+    pass.src     = StreamingBuffer::IN;
+    pass.dst     = inplace ? StreamingBuffer::IN : StreamingBuffer::OUT;
+    pass.inplace = inplace;
+
+    const size_t inItem     = plan->batch > 1 ? inDist : inSpan;
+    const size_t outItem    = plan->batch > 1 ? outDist : outSpan;
+    const size_t item_bytes = inplace ? std::max(inItem, outItem) : inItem + outItem;
+
+    auto params = [plan](size_t) {
+        StreamingTransformParams p;
+        p.placement = plan->placement;
+        p.type      = plan->transformType;
+        p.lengths.assign(plan->lengths.begin(), plan->lengths.begin() + plan->rank);
+        p.desc                      = plan->desc;
+        p.desc.inOffset             = {0, 0};
+        p.desc.outOffset            = {0, 0};
+        p.desc.maxWorkBufBytes      = 0;
+        p.desc.streamingDeviceBytes = 0;
+        return p;
+    };
+
+    StreamingTransforms transforms;
+    if(!fit_pass(plan, pass, plan->batch, item_bytes, slot_bytes, params, transforms))
+        return false;
+
+    StreamingRows in;
+    in.base      = plan->desc.inOffset[0] * inElem;
+    in.width     = inSpan;
+    in.pitch     = inDist;
+    in.dev_pitch = inItem;
+    StreamingRows out;
+    out.base      = plan->desc.outOffset[0] * outElem;
+    out.width     = outSpan;
+    out.pitch     = outDist;
+    out.dev_pitch = outItem;
+    streaming_split_rows(pass, plan->batch, in, out);
+
+    sp.passes.push_back(std::move(pass));
+    sp.transforms.push_back(std::move(transforms));
+    return true;
+}
+
+// Stream a 2D transform that does not fit on the device as a pass
+// over chunks of rows followed by a pass over chunks of columns
+// (the other way around for complex-to-real).  Rows must be
+// contiguous.
+static bool plan_row_column_split(rocfft_plan plan, size_t slot_bytes)
+{
+    if(plan->rank != 2 || plan->desc.inStrides[0] != 1 || plan->desc.outStrides[0] != 1)
+        return false;
+
+    auto& sp = *plan->streaming;
+
+    const size_t len0  = plan->lengths[0];
+    const size_t len1  = plan->lengths[1];
+    const size_t cplx  = 2 * plan->base_type_size;
+    const size_t hlen0 = len0 / 2 + 1;
+
+    const bool is_c2c = plan->transformType == rocfft_transform_type_complex_forward
+                        || plan->transformType == rocfft_transform_type_complex_inverse;
+    const bool is_r2c = plan->transformType == rocfft_transform_type_real_forward;
+    const bool is_c2r = plan->transformType == rocfft_transform_type_real_inverse;
+
+    // the column pass works on complex data: the output for C2C and
+    // R2C, the input for C2R
+    const auto&  desc          = plan->desc;
+    const bool   columns_on_in = is_c2r;
+    const size_t colCount      = is_c2c ? len0 : hlen0;
+    const size_t colPitch      = (columns_on_in ? desc.inStrides[1] : desc.outStrides[1]) * cplx;
+    const size_t colBase       = (columns_on_in ? desc.inOffset[0] : desc.outOffset[0]) * cplx;
+    const size_t colDist       = (columns_on_in ? desc.inDist : desc.outDist) * cplx;
+
+    const rocfft_transform_type colType
+        = (plan->transformType == rocfft_transform_type_complex_forward || is_r2c)
+              ? rocfft_transform_type_complex_forward
+              : rocfft_transform_type_complex_inverse;
+
+    // columns are packed side by side in the slot, so each chunk's
+    // transform strides by the number of columns in the chunk
+    auto colParams = [=](size_t chunk) {
+        StreamingTransformParams p;
+        p.placement         = rocfft_placement_inplace;
+        p.type              = colType;
+        p.lengths           = {len1};
+        p.desc.inArrayType  = rocfft_array_type_complex_interleaved;
+        p.desc.outArrayType = rocfft_array_type_complex_interleaved;
+        p.desc.inStrides    = {chunk, 0, 0};
+        p.desc.outStrides   = {chunk, 0, 0};
+        p.desc.inDist       = 1;
+        p.desc.outDist      = 1;
+        p.desc.scale_factor = is_c2r ? 1.0 : plan->desc.scale_factor;
+        p.desc.storagePrecision = plan->desc.storagePrecision;
+        return p;
+    };
+
+    // rows are packed in the slot; real-complex rows are transformed
+    // out of place since real and complex rows differ in size
+    const size_t rowInElem   = elem_bytes(plan->desc.inArrayType, plan->base_type_size);
+    const size_t rowOutElem  = elem_bytes(plan->desc.outArrayType, plan->base_type_size);
+    const size_t rowInWidth  = (is_c2r ? hlen0 : len0) * rowInElem;
+    const size_t rowOutWidth = (is_r2c ? hlen0 : len0) * rowOutElem;
+
+    auto rowParams = [=](size_t) {
+        StreamingTransformParams p;
+        p.placement         = is_c2c ? rocfft_placement_inplace : rocfft_placement_notinplace;
+        p.type              = plan->transformType;
+        p.lengths           = {len0};
+        p.desc.inArrayType  = plan->desc.inArrayType;
+        p.desc.outArrayType = plan->desc.outArrayType;
+        p.desc.scale_factor = is_c2r ? plan->desc.scale_factor : 1.0;
+        p.desc.storagePrecision = plan->desc.storagePrecision;
+        return p;
+    };
+
+    StreamingPass rowPass;
+    rowPass.src     = StreamingBuffer::IN;
+    rowPass.dst     = StreamingBuffer::OUT;
+    rowPass.inplace = is_c2c;
+    const size_t rowItem = is_c2c ? rowInWidth : rowInWidth + rowOutWidth;
+
+    StreamingPass colPass;
+    colPass.src     = columns_on_in ? StreamingBuffer::IN : StreamingBuffer::OUT;
+    colPass.dst     = colPass.src;
+    colPass.inplace = true;
+    const size_t colItem = len1 * cplx;
+
+    StreamingTransforms rowTransforms;
+    StreamingTransforms colTransforms;
+    if(!fit_pass(plan, rowPass, len1, rowItem, slot_bytes, rowParams, rowTransforms)
+       || !fit_pass(plan, colPass, colCount, colItem, slot_bytes, colParams, colTransforms))
+        return false;
+
+    // each pass covers every transform of the batch
+    for(size_t b = 0; b < plan->batch; ++b)
+    {
+        StreamingRows in;
+        in.base      = (plan->desc.inOffset[0] + b * plan->desc.inDist) * rowInElem;
+        in.width     = rowInWidth;
+        in.pitch     = plan->desc.inStrides[1] * rowInElem;
+        in.dev_pitch = rowInWidth;
+        StreamingRows out;
+        out.base      = (plan->desc.outOffset[0] + b * plan->desc.outDist) * rowOutElem;
+        out.width     = rowOutWidth;
+        out.pitch     = plan->desc.outStrides[1] * rowOutElem;
+        out.dev_pitch = rowOutWidth;
+        streaming_split_rows(rowPass, len1, in, out);
+
+        streaming_split_columns(colPass, colCount, len1, cplx, colBase + b * colDist, colPitch);
+    }
+
+    if(is_c2r)
+    {
+        sp.passes.push_back(std::move(colPass));
+        sp.transforms.push_back(std::move(colTransforms));
+    }
+    sp.passes.push_back(std::move(rowPass));
+    sp.transforms.push_back(std::move(rowTransforms));
+    if(!is_c2r)
+    {
+        sp.passes.push_back(std::move(colPass));
+        sp.transforms.push_back(std::move(colTransforms));
+    }
+    return true;
+}
+
+// Store callback for the column pass of a 1D split.  It multiplies
+// the result for column n2, element k1 by the twiddle
+// exp(-/+2 pi i n2 k1 / N).  Columns are contiguous in the output,
+// and the callback data points at the chunk's first column.
+static std::string split_twiddle_source(rocfft_precision precision,
+                                        size_t           N1,
+                                        size_t           N,
+                                        bool             forward)
+{
+    const std::string cplx = precision == rocfft_precision_double ? "rocfft_complex<double>"
+                                                                  : "rocfft_complex<float>";
+
+    std::string src;
+    src += "__device__ void streaming_twiddle_store(" + cplx + "* data, size_t offset, " + cplx
+           + " element, void* cbdata, void* sharedMem)\n";
+    src += "{\n";
+    src += "    const size_t n2 = *static_cast<const size_t*>(cbdata) + offset / "
+           + std::to_string(N1) + ";\n";
+    src += "    const size_t k1 = offset % " + std::to_string(N1) + ";\n";
+    src += "    double s, c;\n";
+    src += "    sincospi(" + std::string(forward ? "-2.0" : "2.0")
+           + " * static_cast<double>(n2 * k1) / " + std::to_string(N) + ", &s, &c);\n";
+    src += "    data[offset] = " + cplx
+           + "(element.x * c - element.y * s, element.x * s + element.y * c);\n";
+    src += "}\n";
+    return src;
+}
+
+// Stream a 1D complex transform that does not fit on the device, by
+// splitting its length N into N1 * N2 (the "four-step" FFT).  The
+// input is read as N1 rows of N2 columns:
+//
+// - a pass over chunks of columns does length-N1 FFTs, multiplies
+//   the results by twiddles and writes each column contiguously to
+//   the output buffer
+// - a pass over chunks of the N1 sequences with stride N1 in the
+//   output buffer does length-N2 FFTs in place, which leaves the
+//   results in order
+//
+// The first pass overwrites data that it has not read yet if input
+// and output are the same, so this needs an out-of-place transform
+// with unit strides.  The twiddles are applied by a store callback
+// compiled into the first pass's transforms, so this also needs
+// runtime compilation.
+static bool plan_1d_split(rocfft_plan plan, size_t slot_bytes)
+{
+    const bool is_c2c = plan->transformType == rocfft_transform_type_complex_forward
+                        || plan->transformType == rocfft_transform_type_complex_inverse;
+    if(plan->rank != 1 || !is_c2c || plan->placement == rocfft_placement_inplace
+       || plan->desc.inStrides[0] != 1 || plan->desc.outStrides[0] != 1
+       || plan->desc.storagePrecision != rocfft_storage_precision_native)
+        return false;
+
+    auto& sp = *plan->streaming;
+
+    // split as evenly as possible, giving the shorter length to the
+    // column pass since its chunks need input and output space
+    const size_t N  = plan->lengths[0];
+    size_t       N1 = 1;
+    for(size_t d = 2; d * d <= N; ++d)
+    {
+        if(N % d == 0)
+            N1 = d;
+    }
+    if(N1 == 1)
+        return false;
+    const size_t N2   = N / N1;
+    const size_t cplx = 2 * plan->base_type_size;
+
+    RTCCallbackSource twiddle;
+    twiddle.source = split_twiddle_source(
+        plan->precision, N1, N, plan->transformType == rocfft_transform_type_complex_forward);
+    twiddle.store_function = "streaming_twiddle_store";
+
+    // columns are packed side by side in the slot, and written out
+    // one after the other
+    auto colParams = [=](size_t chunk) {
+        StreamingTransformParams p;
+        p.placement           = rocfft_placement_notinplace;
+        p.type                = plan->transformType;
+        p.lengths             = {N1};
+        p.desc.inArrayType    = rocfft_array_type_complex_interleaved;
+        p.desc.outArrayType   = rocfft_array_type_complex_interleaved;
+        p.desc.inStrides      = {chunk, 0, 0};
+        p.desc.outStrides     = {1, 0, 0};
+        p.desc.inDist         = 1;
+        p.desc.outDist        = N1;
+        p.desc.callbackSource = twiddle;
+        return p;
+    };
+
+    // the second pass's sequences are packed side by side in the
+    // slot too
+    auto rowParams = [=](size_t chunk) {
+        StreamingTransformParams p;
+        p.placement         = rocfft_placement_inplace;
+        p.type              = plan->transformType;
+        p.lengths           = {N2};
+        p.desc.inArrayType  = rocfft_array_type_complex_interleaved;
+        p.desc.outArrayType = rocfft_array_type_complex_interleaved;
+        p.desc.inStrides    = {chunk, 0, 0};
+        p.desc.outStrides   = {chunk, 0, 0};
+        p.desc.inDist       = 1;
+        p.desc.outDist      = 1;
+        p.desc.scale_factor = plan->desc.scale_factor;
+        return p;
+    };
+
+    StreamingPass colPass;
+    colPass.src     = StreamingBuffer::IN;
+    colPass.dst     = StreamingBuffer::OUT;
+    colPass.inplace = false;
+
+    StreamingPass rowPass;
+    rowPass.src     = StreamingBuffer::OUT;
+    rowPass.dst     = StreamingBuffer::OUT;
+    rowPass.inplace = true;
+
+    StreamingTransforms colTransforms;
+    StreamingTransforms rowTransforms;
+    try
+    {
+        if(!fit_pass(plan, colPass, N2, 2 * N1 * cplx, slot_bytes, colParams, colTransforms)
+           || !fit_pass(plan, rowPass, N1, N2 * cplx, slot_bytes, rowParams, rowTransforms))
+            return false;
+    }
+    catch(std::exception&)
+    {
+        // the callback can't be compiled into the transforms
+        return false;
+    }
+
+    std::vector<size_t> starts;
+    for(size_t start = 0; start < N2; start += colPass.chunk_items)
+        starts.push_back(start);
+    if(colTransforms.chunk_starts.alloc(starts.size() * sizeof(size_t)) != hipSuccess
+       || hipMemcpy(colTransforms.chunk_starts.data(),
+                    starts.data(),
+                    starts.size() * sizeof(size_t),
+                    hipMemcpyHostToDevice)
+              != hipSuccess)
+        throw std::runtime_error("failed to allocate streaming chunk starts");
+
+    // each pass covers every transform of the batch
+    for(size_t b = 0; b < plan->batch; ++b)
+    {
+        const size_t inBase  = (plan->desc.inOffset[0] + b * plan->desc.inDist) * cplx;
+        const size_t outBase = (plan->desc.outOffset[0] + b * plan->desc.outDist) * cplx;
+        streaming_split_columns_to_rows(colPass, N2, N1, cplx, inBase, N2 * cplx, outBase);
+        streaming_split_columns(rowPass, N1, N2, cplx, outBase, N1 * cplx);
+    }
+
+    sp.passes.push_back(std::move(colPass));
+    sp.transforms.push_back(std::move(colTransforms));
+    sp.passes.push_back(std::move(rowPass));
+    sp.transforms.push_back(std::move(rowTransforms));
+    return true;
+}
+
+rocfft_status CreateStreamingPlan(rocfft_plan plan)
+{
+    if(array_type_is_planar(plan->desc.inArrayType)
+       || array_type_is_planar(plan->desc.outArrayType))
+        return rocfft_status_invalid_array_type;
+
+    const size_t slot_bytes = plan->desc.streamingDeviceBytes / STREAMING_SLOTS;
+
+    try
+    {
+        plan->streaming = std::make_shared<StreamingPlan>();
+        if(!plan_batch_split(plan, slot_bytes))
+        {
+            plan->streaming->passes.clear();
+            plan->streaming->transforms.clear();
+            if(!plan_row_column_split(plan, slot_bytes))
+            {
+                plan->streaming->passes.clear();
+                plan->streaming->transforms.clear();
+                if(!plan_1d_split(plan, slot_bytes))
+                {
+                    plan->streaming.reset();
+                    return rocfft_status_invalid_arg_value;
+                }
+            }
+        }
+
+        // allocate slots big enough for every chunk of every pass
+        size_t in_bytes   = 0;
+        size_t out_bytes  = 0;
+        size_t work_bytes = 0;
+        for(const auto& pass : plan->streaming->passes)
+        {
+            for(const auto& chunk : pass.chunks)
+            {
+                const size_t chunk_in  = chunk.in.rows * chunk.dev_in_pitch;
+                const size_t chunk_out = chunk.out.rows * chunk.dev_out_pitch;
+                if(pass.inplace)
+                    in_bytes = std::max({in_bytes, chunk_in, chunk_out});
+                else
+                {
+                    in_bytes  = std::max(in_bytes, chunk_in);
+                    out_bytes = std::max(out_bytes, chunk_out);
+                }
+            }
+        }
+        for(const auto& t : plan->streaming->transforms)
+        {
+            work_bytes = std::max(work_bytes, t.full->WorkBufBytes());
+            if(t.remainder)
+                work_bytes = std::max(work_bytes, t.remainder->WorkBufBytes());
+        }
+
+        for(size_t i = 0; i < STREAMING_SLOTS; ++i)
+        {
+            auto& slot = plan->streaming->slots[i];
+            if(slot.in.alloc(in_bytes) != hipSuccess
+               || (out_bytes && slot.out.alloc(out_bytes) != hipSuccess)
+               || (work_bytes && slot.work.alloc(work_bytes) != hipSuccess))
+                throw std::runtime_error("failed to allocate streaming slot");
+            if(hipStreamCreate(&slot.stream) != hipSuccess)
+                throw std::runtime_error("hipStreamCreate failure");
+            if(hipEventCreateWithFlags(&slot.event, hipEventDisableTiming) != hipSuccess)
+                throw std::runtime_error("hipEventCreate failure");
+        }
+        if(hipEventCreateWithFlags(&plan->streaming->user_event, hipEventDisableTiming)
+           != hipSuccess)
+            throw std::runtime_error("hipEventCreate failure");
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        }
+        plan->streaming.reset();
+        return rocfft_status_failure;
+    }
+    return rocfft_status_success;
+}
+
+// Moves chunks between host buffers and device slots with async 2D
+// copies, and transforms them with the pass's chunk transforms.
+class HipStreamingEngine : public StreamingEngine
+{
+public:
+    HipStreamingEngine(StreamingPlan& sp, char* in, char* out, hipStream_t userStream)
+        : sp(sp)
+        , in(in)
+        , out(out)
+        , userStream(userStream)
+    {
+        for(size_t i = 0; i < STREAMING_SLOTS; ++i)
+            streams[i] = sp.slots[i].stream;
+    }
+
+    void copy_to_device(size_t                slot,
+                        const StreamingPass&  pass,
+                        const StreamingChunk& chunk) override
+    {
+        if(hipMemcpy2DAsync(sp.slots[slot].in.data(),
+                            chunk.dev_in_pitch,
+                            host(pass.src) + chunk.in.offset,
+                            chunk.in.pitch,
+                            chunk.in.width,
+                            chunk.in.rows,
+                            hipMemcpyHostToDevice,
+                            streams[slot])
+           != hipSuccess)
+            throw std::runtime_error("streaming copy to device failed");
+    }
+
+    void transform(size_t slot, size_t pass_idx, const StreamingChunk& chunk) override
+    {
+        auto& transforms = sp.transforms[pass_idx];
+        auto  plan = chunk.remainder ? transforms.remainder.get() : transforms.full.get();
+
+        rocfft_execution_info_t info;
+        info.rocfft_stream  = streams[slot];
+        info.workBuffer     = sp.slots[slot].work.data();
+        info.workBufferSize = sp.slots[slot].work.size();
+        if(transforms.chunk_starts.data())
+            info.callbacks.store_cb_data = static_cast<size_t*>(transforms.chunk_starts.data())
+                                           + chunk.first / sp.passes[pass_idx].chunk_items;
+
+        void* chunkIn[]  = {sp.slots[slot].in.data()};
+        void* chunkOut[] = {sp.slots[slot].out.data()};
+        if(rocfft_execute(plan, chunkIn, chunkOut, &info) != rocfft_status_success)
+            throw std::runtime_error("streaming chunk transform failed");
+    }
+
+    void copy_to_host(size_t slot, const StreamingPass& pass, const StreamingChunk& chunk) override
+    {
+        const auto& dev = pass.inplace ? sp.slots[slot].in : sp.slots[slot].out;
+        if(hipMemcpy2DAsync(host(pass.dst) + chunk.out.offset,
+                            chunk.out.pitch,
+                            dev.data(),
+                            chunk.dev_out_pitch,
+                            chunk.out.width,
+                            chunk.out.rows,
+                            hipMemcpyDeviceToHost,
+                            streams[slot])
+           != hipSuccess)
+            throw std::runtime_error("streaming copy to host failed");
+    }
+
+    // the stream given at execution time takes part in every
+    // barrier, so that chunks wait for the caller's earlier work and
+    // the caller's later work waits for the chunks
+    void barrier() override
+    {
+        if(hipEventRecord(sp.user_event, userStream) != hipSuccess)
+            throw std::runtime_error("hipEventRecord failure");
+        for(size_t i = 0; i < STREAMING_SLOTS; ++i)
+        {
+            if(hipEventRecord(sp.slots[i].event, streams[i]) != hipSuccess)
+                throw std::runtime_error("hipEventRecord failure");
+        }
+        for(size_t i = 0; i < STREAMING_SLOTS; ++i)
+        {
+            if(hipStreamWaitEvent(streams[i], sp.user_event, 0) != hipSuccess
+               || hipStreamWaitEvent(userStream, sp.slots[i].event, 0) != hipSuccess)
+                throw std::runtime_error("hipStreamWaitEvent failure");
+            for(size_t j = 0; j < STREAMING_SLOTS; ++j)
+            {
+                if(i != j && hipStreamWaitEvent(streams[i], sp.slots[j].event, 0) != hipSuccess)
+                    throw std::runtime_error("hipStreamWaitEvent failure");
+            }
+        }
+    }
+
+private:
+    char* host(StreamingBuffer buf) const
+    {
+        return buf == StreamingBuffer::IN ? in : out;
+    }
+
+    StreamingPlan&                           sp;
+    char*                                    in;
+    char*                                    out;
+    hipStream_t                              userStream;
+    std::array<hipStream_t, STREAMING_SLOTS> streams;
+};
+
+rocfft_status ExecuteStreaming(const rocfft_plan     plan,
+                               void*                 in_buffer[],
+                               void*                 out_buffer[],
+                               rocfft_execution_info info)
+{
+    // callbacks would see chunk-relative offsets
+    if(info && (info->callbacks.load_cb_fn || info->callbacks.store_cb_fn))
+        return rocfft_status_failure;
+
+    hipStream_t stream = info ? info->rocfft_stream : nullptr;
+    auto        in     = static_cast<char*>(in_buffer[0]);
+    auto        out    = plan->placement == rocfft_placement_inplace
+                             ? in
+                             : static_cast<char*>(out_buffer[0]);
+
+    try
+    {
+        HipStreamingEngine engine(*plan->streaming, in, out, stream);
+        streaming_execute(plan->streaming->passes, STREAMING_SLOTS, engine);
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        }
+        return rocfft_status_failure;
+    }
+    return rocfft_status_success;
+}
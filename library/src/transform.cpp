@@ -20,12 +20,15 @@
 * THE SOFTWARE.
 *******************************************************************************/
 
+#include <array>
 #include <cassert>
 #include <cstdlib>
 #include <iostream>
 #include <vector>
 
 #include "../../shared/array_predicate.h"
+#include "event_trace.h"
+#include "host_exec.h"
 #include "logging.h"
 #include "plan.h"
 #include "rocfft.h"
@@ -101,6 +104,22 @@ rocfft_status rocfft_execution_info_set_store_callback(rocfft_execution_info inf
     return rocfft_status_success;
 }
 
+// offset user buffers to the start of a chunk of the batch
+static void offset_chunk_buffers(void**                buffers,
+                                 rocfft_array_type     type,
+                                 size_t                base_type_size,
+                                 size_t                offset_elems,
+                                 std::array<void*, 2>& chunk_buffers)
+{
+    // planar buffers hold one real per element, interleaved complex
+    // buffers hold two
+    const size_t elem_bytes
+        = array_type_is_interleaved(type) ? 2 * base_type_size : base_type_size;
+    const size_t num_buffers = array_type_is_planar(type) ? 2 : 1;
+    for(size_t i = 0; i < num_buffers; ++i)
+        chunk_buffers[i] = static_cast<char*>(buffers[i]) + offset_elems * elem_bytes;
+}
+
 rocfft_status rocfft_execute(const rocfft_plan     plan,
                              void*                 in_buffer[],
                              void*                 out_buffer[],
@@ -111,8 +130,12 @@ rocfft_status rocfft_execute(const rocfft_plan     plan,
 
     if(!plan)
         return rocfft_status_failure;
+    if(plan->streaming)
+        return ExecuteStreaming(plan, in_buffer, out_buffer, info);
     const ExecPlan& execPlan = plan->execPlan;
 
+    TraceScope trace(TraceEvent::EXECUTE);
+
     if(LOG_PLAN_ENABLED())
         PrintNode(*LogSingleton::GetInstance().GetPlanOS(), execPlan);
 
@@ -121,36 +144,115 @@ rocfft_status rocfft_execute(const rocfft_plan     plan,
     if(info)
         exec_info = *info;
 
-    gpubuf autoAllocWorkBuf;
+    gpubuf            autoAllocWorkBuf;
+    std::vector<char> hostWorkBuf;
 
-    if(execPlan.workBufSize > 0)
+    auto requiredWorkBufBytes = plan->WorkBufBytes();
+    if(trace.is_active())
+        trace.set_arg(0, plan->batch)
+            .set_arg(1, requiredWorkBufBytes)
+            .set_arg(2, (plan->batch + plan->chunkBatch - 1) / plan->chunkBatch);
+    if(requiredWorkBufBytes > 0)
     {
-        auto requiredWorkBufBytes = execPlan.WorkBufBytes(plan->base_type_size);
         if(!exec_info.workBuffer)
         {
             // user didn't provide a buffer, alloc one now
-            if(autoAllocWorkBuf.alloc(requiredWorkBufBytes) != hipSuccess)
-                return rocfft_status_failure;
+            if(execPlan.hostExec)
+            {
+                try
+                {
+                    hostWorkBuf.resize(requiredWorkBufBytes);
+                }
+                catch(std::bad_alloc&)
+                {
+                    return rocfft_status_failure;
+                }
+                exec_info.workBuffer = hostWorkBuf.data();
+            }
+            else
+            {
+                if(autoAllocWorkBuf.alloc(requiredWorkBufBytes) != hipSuccess)
+                    return rocfft_status_failure;
+                exec_info.workBuffer = autoAllocWorkBuf.data();
+            }
             exec_info.workBufferSize = requiredWorkBufBytes;
-            exec_info.workBuffer     = autoAllocWorkBuf.data();
         }
         // otherwise user provided a buffer, but complain if it's too small
         else if(exec_info.workBufferSize < requiredWorkBufBytes)
             return rocfft_status_invalid_work_buffer;
     }
 
-    // Callbacks do not currently support planar format
-    if((array_type_is_planar(execPlan.rootPlan->inArrayType)
-        || array_type_is_planar(execPlan.rootPlan->outArrayType))
+    // Callbacks would see numbers of the compute precision, but
+    // mixed-precision kernels convert on load and store instead
+    if(plan->desc.storagePrecision != rocfft_storage_precision_native
        && (exec_info.callbacks.load_cb_fn || exec_info.callbacks.store_cb_fn))
         return rocfft_status_failure;
 
+    // Callbacks compiled into the plan from source take the place of
+    // callback functions
+    const bool source_callbacks = !plan->desc.callbackSource.empty();
+    if(source_callbacks && (exec_info.callbacks.load_cb_fn || exec_info.callbacks.store_cb_fn))
+        return rocfft_status_invalid_arg_value;
+
+    // Callbacks see offsets relative to the buffers they're given,
+    // which would be wrong for all but the first chunk
+    const bool chunked = plan->chunkBatch < plan->batch;
+    if(chunked
+       && (exec_info.callbacks.load_cb_fn || exec_info.callbacks.store_cb_fn || source_callbacks))
+        return rocfft_status_failure;
+
+    // Host kernels don't call device callback functions
+    if(execPlan.hostExec && (exec_info.callbacks.load_cb_fn || exec_info.callbacks.store_cb_fn))
+        return rocfft_status_failure;
+
+    // kernels of all chunks are timed as one execution
+    std::unique_ptr<KernelTimingExecution> timing;
+
+    // chunks of the batch all run on the same target
+    auto transform = [&](const ExecPlan& chunkPlan, void** in_buffers, void** out_buffers) {
+        if(chunkPlan.hostExec)
+            ExecuteHostPlan(chunkPlan, in_buffers, out_buffers, &exec_info);
+        else
+            TransformPowX(chunkPlan, in_buffers, out_buffers, &exec_info, timing.get());
+    };
+
     try
     {
-        TransformPowX(execPlan,
-                      in_buffer,
-                      (plan->placement == rocfft_placement_inplace) ? in_buffer : out_buffer,
-                      &exec_info);
+        if(plan->kernelTimer)
+            timing = plan->kernelTimer->begin_execution();
+
+        void** in_buffers  = in_buffer;
+        void** out_buffers = (plan->placement == rocfft_placement_inplace) ? in_buffer : out_buffer;
+        if(!chunked)
+            transform(execPlan, in_buffers, out_buffers);
+        else
+        {
+            // run chunks one after another on the same stream, so they
+            // can share the work buffer
+            for(size_t chunkStart = 0; chunkStart < plan->batch; chunkStart += plan->chunkBatch)
+            {
+                const ExecPlan& chunkPlan = plan->batch - chunkStart < plan->chunkBatch
+                                                ? *plan->remainderPlan
+                                                : execPlan;
+
+                std::array<void*, 2> chunkIn  = {};
+                std::array<void*, 2> chunkOut = {};
+                offset_chunk_buffers(in_buffers,
+                                     plan->desc.inArrayType,
+                                     plan->base_type_size,
+                                     chunkStart * plan->desc.inDist,
+                                     chunkIn);
+                offset_chunk_buffers(out_buffers,
+                                     plan->desc.outArrayType,
+                                     plan->base_type_size,
+                                     chunkStart * plan->desc.outDist,
+                                     chunkOut);
+                transform(chunkPlan, chunkIn.data(), chunkOut.data());
+            }
+        }
+
+        if(timing)
+            plan->kernelTimer->end_execution(std::move(timing));
     }
     catch(std::exception& e)
     {
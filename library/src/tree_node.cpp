@@ -19,6 +19,8 @@
 // THE SOFTWARE.
 
 #include "tree_node.h"
+#include "../../shared/arithmetic.h"
+#include "../../shared/array_predicate.h"
 #include "../../shared/precision_type.h"
 #include "function_pool.h"
 #include "kernel_launch.h"
@@ -30,15 +32,12 @@ TreeNode::~TreeNode()
 {
     if(twiddles)
     {
-        if(scheme == CS_KERNEL_2D_SINGLE)
-            Repo::ReleaseTwiddle2D(twiddles);
-        else
-            Repo::ReleaseTwiddle1D(twiddles);
+        Repo::ReleaseTwiddles(twiddles);
         twiddles = nullptr;
     }
     if(twiddles_large)
     {
-        Repo::ReleaseTwiddle1D(twiddles_large);
+        Repo::ReleaseTwiddles(twiddles_large);
         twiddles_large = nullptr;
     }
 }
@@ -48,6 +47,7 @@ NodeMetaData::NodeMetaData(TreeNode* refNode)
     if(refNode != nullptr)
     {
         precision  = refNode->precision;
+        storage    = refNode->storage;
         batch      = refNode->batch;
         direction  = refNode->direction;
         rootIsC2C  = refNode->IsRootPlanC2CTransform();
@@ -55,15 +55,10 @@ NodeMetaData::NodeMetaData(TreeNode* refNode)
     }
 }
 
-bool LeafNode::CreateLargeTwdTable()
+void LeafNode::GetLargeTwdTableSpec(std::vector<TwiddleTableSpec>& specs)
 {
     if(large1D != 0)
-    {
-        std::tie(twiddles_large, twiddles_large_size) = Repo::GetTwiddles1D(
-            large1D, 0, precision, deviceProp.gcnArchName, largeTwdBase, false, {});
-    }
-
-    return true;
+        specs.push_back({{large1D}, 0, precision, largeTwdBase, false, {}});
 }
 
 size_t LeafNode::GetTwiddleTableLength()
@@ -123,23 +118,35 @@ bool LeafNode::CreateDevKernelArgs()
     return (devKernArg != nullptr);
 }
 
-bool LeafNode::CreateTwiddleTableResource()
+std::vector<TwiddleTableSpec> LeafNode::GetTwiddleTableSpecs()
 {
+    std::vector<TwiddleTableSpec> specs;
     if(need_twd_table)
     {
         if(!twd_no_radices)
             GetKernelFactors();
-        size_t twd_len                    = GetTwiddleTableLength();
-        std::tie(twiddles, twiddles_size) = Repo::GetTwiddles1D(twd_len,
-                                                                GetTwiddleTableLengthLimit(),
-                                                                precision,
-                                                                deviceProp.gcnArchName,
-                                                                0,
-                                                                twd_attach_halfN,
-                                                                kernelFactors);
+        specs.push_back({{GetTwiddleTableLength()},
+                         GetTwiddleTableLengthLimit(),
+                         precision,
+                         0,
+                         twd_attach_halfN,
+                         kernelFactors});
     }
+    GetLargeTwdTableSpec(specs);
+    return specs;
+}
 
-    return CreateLargeTwdTable();
+bool LeafNode::CreateTwiddleTableResource()
+{
+    for(const auto& spec : GetTwiddleTableSpecs())
+    {
+        if(spec.large_twiddle_base)
+            std::tie(twiddles_large, twiddles_large_size)
+                = Repo::GetTwiddles(spec, deviceProp.gcnArchName);
+        else
+            std::tie(twiddles, twiddles_size) = Repo::GetTwiddles(spec, deviceProp.gcnArchName);
+    }
+    return true;
 }
 
 void LeafNode::SetupGridParamAndFuncPtr(DevFnCall& fnPtr, GridParam& gp)
@@ -196,6 +203,79 @@ void LeafNode::SetupGridParamAndFuncPtr(DevFnCall& fnPtr, GridParam& gp)
 // grid params are set up by RTC
 void TransposeNode::SetupGPAndFnPtr_internal(DevFnCall& fnPtr, GridParam& gp) {}
 
+TransposeTiling TransposeNode::SelectTiling(bool enable_callbacks) const
+{
+    TransposeTiling tiling;
+
+    // start from square tiles
+    const bool single = precision == rocfft_precision_single;
+    tiling.tileX      = single ? 64 : 32;
+    tiling.tileY      = tiling.tileX;
+    unsigned int elems_per_thread = single ? 4 : 1;
+
+    // Move up to 16 bytes per global load/store along a unit-stride
+    // dimension.  The vector must not straddle the end of that
+    // dimension and every other stride/offset must keep vectors
+    // aligned.
+    const unsigned int max_vec = std::max<size_t>(16 / complex_type_size(precision, storage), 1);
+
+    auto vec_width = [&](rocfft_array_type          type,
+                         OperatingBuffer            buf,
+                         size_t                     fast_dim,
+                         const std::vector<size_t>& stride,
+                         size_t                     dist,
+                         size_t                     offset) {
+        if(enable_callbacks || array_type_is_planar(type) || stride[fast_dim] != 1)
+            return 1u;
+        // these temp buffers start part way into the work buffer, so
+        // they may not be vector-aligned
+        if(buf == OB_TEMP_CMPLX_FOR_REAL || buf == OB_TEMP_BLUESTEIN)
+            return 1u;
+        for(unsigned int vec = max_vec; vec > 1; vec /= 2)
+        {
+            bool aligned = length[fast_dim] % vec == 0 && dist % vec == 0 && offset % vec == 0;
+            for(size_t d = 0; d < stride.size(); ++d)
+            {
+                if(d != fast_dim && stride[d] % vec != 0)
+                    aligned = false;
+            }
+            if(aligned)
+                return vec;
+        }
+        return 1u;
+    };
+    // reads are along length[0], writes are along length[1]
+    tiling.vecIn     = vec_width(inArrayType, obIn, 0, inStride, iDist, iOffset);
+    tiling.vecOut    = vec_width(outArrayType, obOut, 1, outStride, oDist, oOffset);
+    elems_per_thread = std::max(elems_per_thread, std::max(tiling.vecIn, tiling.vecOut));
+
+    // Very skinny matrices would leave most of a square tile idle.
+    // Shrink the tile along the short side and stretch it along the
+    // long side so each block still moves the same number of
+    // elements.
+    const unsigned int min_tile  = 4;
+    const unsigned int tile_area = tiling.tileX * tiling.tileY;
+    const size_t       rows      = length[1] * (length.size() > 2 ? length[2] : 1);
+    if(length[0] < tiling.tileX)
+    {
+        tiling.tileX = std::max<unsigned int>(min_tile, 1u << CeilPo2(length[0]));
+        tiling.tileY = tile_area / tiling.tileX;
+    }
+    else if(rows < tiling.tileY)
+    {
+        tiling.tileY = std::max<unsigned int>(min_tile, 1u << CeilPo2(rows));
+        tiling.tileX = tile_area / tiling.tileY;
+    }
+    tiling.threads = tile_area / elems_per_thread;
+
+    // check the length along the fast output dimension to decide if
+    // we should do diagonal block ordering.  Diagonal ordering only
+    // seems to help 2D cases, not 3D.
+    tiling.diagonal = length[1] % 256 == 0 && outStride[0] % 256 == 0
+                      && scheme == CS_KERNEL_TRANSPOSE;
+    return tiling;
+}
+
 void TreeNode::SetTransposeOutputLength()
 {
     switch(scheme)
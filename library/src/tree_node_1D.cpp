@@ -750,10 +750,10 @@ void Stockham1DNode::SetupGPAndFnPtr_internal(DevFnCall& fnPtr, GridParam& gp)
     }
 }
 
-bool Stockham1DNode::CreateTwiddleTableResource()
+std::vector<TwiddleTableSpec> Stockham1DNode::GetTwiddleTableSpecs()
 {
     twd_attach_halfN = (ebtype != EmbeddedType::NONE);
-    return LeafNode::CreateTwiddleTableResource();
+    return LeafNode::GetTwiddleTableSpecs();
 }
 
 std::vector<size_t> Stockham1DNode::CollapsibleDims()
@@ -1017,8 +1017,8 @@ void SBCRNode::SetupGPAndFnPtr_internal(DevFnCall& fnPtr, GridParam& gp)
     return;
 }
 
-bool SBCRNode::CreateTwiddleTableResource()
+std::vector<TwiddleTableSpec> SBCRNode::GetTwiddleTableSpecs()
 {
     twd_attach_halfN = (ebtype != EmbeddedType::NONE);
-    return LeafNode::CreateTwiddleTableResource();
+    return LeafNode::GetTwiddleTableSpecs();
 }
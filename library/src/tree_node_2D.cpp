@@ -22,6 +22,7 @@
 #include "../../shared/arithmetic.h"
 #include "function_pool.h"
 #include "fuse_shim.h"
+#include "logging.h"
 #include "node_factory.h"
 #include "repo.h"
 
@@ -198,32 +199,60 @@ void RC2DNode::AssignParams_internal()
 /*****************************************************
  * CS_KERNEL_2D_SINGLE  *
  *****************************************************/
-bool Single2DNode::CreateTwiddleTableResource()
+bool Single2DNode::KernelCheck()
 {
-    // create one set of twiddles for each dimension
-    std::tie(twiddles, twiddles_size)
-        = Repo::GetTwiddles2D(length[0], length[1], precision, deviceProp.gcnArchName);
+    auto kernel = function_pool::get_fused_kernel(FusedLengths(), precision);
+    if(!kernel)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            auto& os = *LogSingleton::GetInstance().GetTraceOS();
+            os << "Kernel not found: \n\tlength:";
+            for(auto len : FusedLengths())
+                os << " " << len;
+            os << "\n\tprecision: " << precision << "\n\tscheme: " << PrintScheme(scheme)
+               << std::endl;
+        }
+        return false;
+    }
+
+    dir2regMode = kernel->direct_to_from_reg ? DirectRegType::TRY_ENABLE_IF_SUPPORT
+                                             : DirectRegType::FORCE_OFF_OR_NOT_SUPPORT;
+
+    kernelFactors = kernel->factors;
+    return true;
+}
 
-    return CreateLargeTwdTable();
+void Single2DNode::GetKernelFactors()
+{
+    kernelFactors = function_pool::get_fused_kernel(FusedLengths(), precision)->factors;
+}
+
+std::vector<TwiddleTableSpec> Single2DNode::GetTwiddleTableSpecs()
+{
+    // one set of twiddles for each dimension
+    std::vector<TwiddleTableSpec> specs{{FusedLengths(), 0, precision, 0, false, {}}};
+    GetLargeTwdTableSpec(specs);
+    return specs;
 }
 
 void Single2DNode::SetupGPAndFnPtr_internal(DevFnCall& fnPtr, GridParam& gp)
 {
-    auto kernel = function_pool::get_kernel(fpkey(length[0], length[1], precision));
-    fnPtr       = kernel.device_function;
-    bwd         = kernel.transforms_per_block;
+    auto lengths = FusedLengths();
+    auto kernel  = function_pool::get_fused_kernel(lengths, precision);
+    fnPtr        = kernel->device_function;
+    bwd          = kernel->transforms_per_block;
 
     gp.b_x   = (batch + bwd - 1) / bwd;
-    gp.wgs_x = kernel.workgroup_size;
+    gp.wgs_x = kernel->workgroup_size;
 
     // if fastest length is power of 2, pad it to avoid LDS bank conflicts
-    auto padded_len0 = IsPo2(length[0]) ? length[0] + 1 : length[0];
-    lds              = padded_len0 * length[1] * bwd;
+    lengths.front() = IsPo2(length[0]) ? length[0] + 1 : length[0];
+    lds             = product(lengths.begin(), lengths.end()) * bwd;
 
-    // if we're doing 3D transform, we need to repeat the 2D
-    // transform in the 3rd dimension
-    if(length.size() > 2)
-        gp.b_x *= length[2];
+    // repeat the transform over any higher dimensions, e.g. the 2D
+    // transform in the 3rd dimension of a 3D transform
+    gp.b_x *= product(length.begin() + lengths.size(), length.end());
 
     return;
 }
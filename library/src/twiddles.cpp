@@ -28,7 +28,10 @@
 #include "rtc_kernel.h"
 #include "rtc_twiddle_kernel.h"
 #include <cassert>
+#include <functional>
+#include <map>
 #include <math.h>
+#include <memory>
 #include <numeric>
 #include <stdexcept>
 #include <string>
@@ -78,6 +81,40 @@ void twiddle_streams_cleanup()
     twiddle_streams.clear();
 }
 
+static hipStream_t get_twiddle_stream(unsigned int deviceId)
+{
+    if(deviceId >= twiddle_streams.size())
+        twiddle_streams.resize(deviceId + 1);
+    if(twiddle_streams[deviceId] == nullptr)
+        twiddle_streams[deviceId].alloc();
+    return twiddle_streams[deviceId];
+}
+
+// RTC twiddle kernels, generated once for a batch of tables instead
+// of once for each launch
+class TwiddleKernels
+{
+public:
+    explicit TwiddleKernels(const std::string& gpu_arch)
+        : gpu_arch(gpu_arch)
+    {
+    }
+
+    RTCKernelTwiddle& get(TwiddleTableType type, rocfft_precision precision)
+    {
+        auto& kernel = kernels[{type, precision}];
+        if(!kernel)
+            kernel.reset(
+                new RTCKernelTwiddle(RTCKernelTwiddle::generate(gpu_arch, type, precision)));
+        return *kernel;
+    }
+
+private:
+    std::string gpu_arch;
+    std::map<std::pair<TwiddleTableType, rocfft_precision>, std::unique_ptr<RTCKernelTwiddle>>
+        kernels;
+};
+
 // Twiddle factors table
 template <typename T>
 class TwiddleTable
@@ -95,7 +132,7 @@ protected:
     bool attach_halfN;
 
     const rocfft_precision precision;
-    const std::string      gpu_arch;
+    TwiddleKernels&        kernels;
 
     void GetKernelParams(const std::vector<size_t>& radices,
                          std::vector<size_t>&       radices_prod,
@@ -104,6 +141,9 @@ protected:
                          size_t&                    min_radix,
                          size_t&                    table_sz)
     {
+        if(radices.size() > TWIDDLES_MAX_RADICES)
+            throw std::runtime_error("maximum twiddle radices exceeded");
+
         radices_sum_prod = {0};
         radices_prod     = {};
 
@@ -137,68 +177,55 @@ protected:
                             : radices_sum_prod.at(0);
     }
 
-    void GenerateTable(const std::vector<size_t>& radices, hipStream_t& stream, gpubuf& output)
+    // length of the table in elements, not counting the half-N
+    // table
+    size_t GetLength(const std::vector<size_t>& radices)
     {
-        if(radices.size() > TWIDDLES_MAX_RADICES)
-            throw std::runtime_error("maximum twiddle radices exceeded");
+        if(radices.empty())
+            return std::min(N, length_limit);
 
         size_t              table_sz, maxElem, minElem;
         std::vector<size_t> radices_prod, radices_sum_prod;
-
         GetKernelParams(radices, radices_prod, radices_sum_prod, maxElem, minElem, table_sz);
+        return std::min(table_sz, length_limit);
+    }
 
-        table_sz          = std::min(table_sz, length_limit);
-        auto total_length = attach_halfN ? table_sz + half_N : table_sz;
-
-        auto table_bytes = total_length * sizeof(T);
-
-        if(table_bytes == 0)
-            return;
+    void GenerateTable(const std::vector<size_t>& radices, hipStream_t stream, T* output)
+    {
+        size_t              table_sz, maxElem, minElem;
+        std::vector<size_t> radices_prod, radices_sum_prod;
 
-        if(output.alloc(table_bytes) != hipSuccess)
-            throw std::runtime_error("unable to allocate twiddle length "
-                                     + std::to_string(total_length));
+        GetKernelParams(radices, radices_prod, radices_sum_prod, maxElem, minElem, table_sz);
 
-        auto device_data_ptr = static_cast<T*>(output.data());
+        table_sz = std::min(table_sz, length_limit);
 
         launch_radices_kernel(
-            radices, radices_prod, radices_sum_prod, maxElem, minElem, stream, device_data_ptr);
+            radices, radices_prod, radices_sum_prod, maxElem, minElem, stream, output);
 
         if(attach_halfN)
         {
-            launch_half_N_kernel(stream, device_data_ptr + table_sz);
+            launch_half_N_kernel(stream, output + table_sz);
         }
     }
 
-    void GenerateTable(hipStream_t& stream, gpubuf& output)
+    void GenerateTable(hipStream_t stream, T* output)
     {
-        auto length       = std::min(N, length_limit);
-        auto total_length = attach_halfN ? length + half_N : length;
-        auto table_bytes  = total_length * sizeof(T);
-
-        if(table_bytes == 0)
-            return;
-
-        if(output.alloc(table_bytes) != hipSuccess)
-            throw std::runtime_error("unable to allocate twiddle length "
-                                     + std::to_string(total_length));
+        auto length = std::min(N, length_limit);
 
         auto blockSize = TWIDDLES_THREADS;
         auto numBlocks = DivRoundingUp<size_t>(length, blockSize);
 
-        auto device_data_ptr = static_cast<T*>(output.data());
-
-        auto kernel = RTCKernelTwiddle::generate(gpu_arch, TwiddleTableType::LENGTH_N, precision);
+        auto&         kernel = kernels.get(TwiddleTableType::LENGTH_N, precision);
         RTCKernelArgs kargs;
         kargs.append_size_t(length_limit);
         kargs.append_size_t(N);
-        kargs.append_ptr(device_data_ptr);
+        kargs.append_ptr(output);
 
         kernel.launch(kargs, dim3(numBlocks), dim3(blockSize), 0, stream);
 
         if(attach_halfN)
         {
-            launch_half_N_kernel(stream, device_data_ptr + length);
+            launch_half_N_kernel(stream, output + length);
         }
     }
 
@@ -207,7 +234,7 @@ protected:
                                std::vector<size_t>&       radices_sum_prod,
                                size_t                     maxElem,
                                size_t                     minElem,
-                               hipStream_t&               stream,
+                               hipStream_t                stream,
                                T*                         output)
     {
         auto num_radices = radices.size();
@@ -223,7 +250,7 @@ protected:
         std::copy(radices_prod.begin(), radices_prod.end(), radices_prod_device.data);
         std::copy(radices_sum_prod.begin(), radices_sum_prod.end(), radices_sum_prod_device.data);
 
-        auto kernel = RTCKernelTwiddle::generate(gpu_arch, TwiddleTableType::RADICES, precision);
+        auto&         kernel = kernels.get(TwiddleTableType::RADICES, precision);
         RTCKernelArgs kargs;
         kargs.append_size_t(length_limit);
         kargs.append_size_t(num_radices);
@@ -234,11 +261,11 @@ protected:
         kernel.launch(kargs, dim3(numBlocksX, numBlocksY), dim3(blockSize, blockSize), 0, stream);
     }
 
-    void launch_half_N_kernel(hipStream_t& stream, T* output)
+    void launch_half_N_kernel(hipStream_t stream, T* output)
     {
         auto blockSize = TWIDDLES_THREADS;
 
-        auto kernel = RTCKernelTwiddle::generate(gpu_arch, TwiddleTableType::HALF_N, precision);
+        auto&         kernel = kernels.get(TwiddleTableType::HALF_N, precision);
         RTCKernelArgs kargs;
         kargs.append_size_t(half_N);
         kargs.append_size_t(N);
@@ -250,94 +277,113 @@ protected:
     }
 
 public:
-    TwiddleTable(rocfft_precision   precision,
-                 const std::string& gpu_arch,
-                 size_t             _N,
-                 size_t             _length_limit,
-                 bool               _attach_halfN)
+    TwiddleTable(rocfft_precision precision,
+                 TwiddleKernels&  kernels,
+                 size_t           _N,
+                 size_t           _length_limit,
+                 bool             _attach_halfN)
         : N(_N)
         , length_limit(_length_limit ? _length_limit : _N)
         , attach_halfN(_attach_halfN)
         , precision(precision)
-        , gpu_arch(gpu_arch)
+        , kernels(kernels)
     {
         half_N = attach_halfN ? (N + 1) / 2 : 0;
     }
 
-    void GenerateTwiddleTable(const std::vector<size_t>& radices, hipStream_t& stream, gpubuf& twts)
+    // number of elements in the table
+    size_t TableLength(const std::vector<size_t>& radices)
+    {
+        return GetLength(radices) + half_N;
+    }
+
+    void GenerateTwiddleTable(const std::vector<size_t>& radices, hipStream_t stream, T* output)
     {
         auto use_radices = !radices.empty();
-        use_radices ? GenerateTable(radices, stream, twts) : GenerateTable(stream, twts);
+        use_radices ? GenerateTable(radices, stream, output) : GenerateTable(stream, output);
     }
 };
 
+// Twiddles for kernels that transform several dimensions at once:
+// one table per dimension, one after the other.  A dimension with
+// the same radices as an earlier one shares its table, which must
+// match the offsets that the kernel generator computes.
 template <typename T>
-class TwiddleTable2D : public TwiddleTable<T>
+class TwiddleTableMultiDim : public TwiddleTable<T>
 {
-private:
-    size_t N1;
-    size_t N2;
+    struct dim_params_t
+    {
+        size_t              table_sz = 0;
+        size_t              maxElem  = 0;
+        size_t              minElem  = 0;
+        std::vector<size_t> radices_prod;
+        std::vector<size_t> radices_sum_prod;
+        // offset of this dimension's table, or nullopt if it
+        // shares an earlier dimension's table
+        std::optional<size_t> offset;
+    };
+
+    std::vector<dim_params_t> GetDimParams(const std::vector<size_t>&              lengths,
+                                           const std::vector<std::vector<size_t>>& radices,
+                                           size_t&                                 table_sz)
+    {
+        std::vector<dim_params_t> dims(lengths.size());
+
+        table_sz = 0;
+        for(size_t d = 0; d < lengths.size(); ++d)
+        {
+            if(std::find(radices.begin(), radices.begin() + d, radices[d]) != radices.begin() + d)
+                continue;
+
+            auto& dim = dims[d];
+            TwiddleTable<T>::GetKernelParams(radices[d],
+                                             dim.radices_prod,
+                                             dim.radices_sum_prod,
+                                             dim.maxElem,
+                                             dim.minElem,
+                                             dim.table_sz);
+            dim.offset = table_sz;
+            table_sz += dim.table_sz;
+        }
+        return dims;
+    }
 
 public:
-    TwiddleTable2D(rocfft_precision precision, const std::string& gpu_arch, size_t _N1, size_t _N2)
-        : TwiddleTable<T>(precision, gpu_arch, 0, 0, false)
-        , N1(_N1)
-        , N2(_N2)
+    TwiddleTableMultiDim(rocfft_precision precision, TwiddleKernels& kernels)
+        : TwiddleTable<T>(precision, kernels, 0, 0, false)
+    {
+    }
+
+    // number of elements in all of the dimensions' tables
+    size_t TableLength(const std::vector<size_t>&              lengths,
+                       const std::vector<std::vector<size_t>>& radices)
     {
+        size_t table_sz = 0;
+        GetDimParams(lengths, radices, table_sz);
+        return table_sz;
     }
 
-    void GenerateTwiddleTable(const std::vector<size_t>& radices1,
-                              const std::vector<size_t>& radices2,
-                              hipStream_t&               stream,
-                              gpubuf&                    output)
+    void GenerateTwiddleTable(const std::vector<size_t>&              lengths,
+                              const std::vector<std::vector<size_t>>& radices,
+                              hipStream_t                             stream,
+                              T*                                      output)
     {
-        if(radices1 == radices2)
-            N2 = 0;
-
-        size_t              table_sz_1, maxElem_1, minElem_1;
-        std::vector<size_t> radices_prod_1, radices_sum_prod_1;
-
-        TwiddleTable<T>::GetKernelParams(
-            radices1, radices_prod_1, radices_sum_prod_1, maxElem_1, minElem_1, table_sz_1);
-
-        size_t              table_sz_2, maxElem_2, minElem_2;
-        std::vector<size_t> radices_prod_2, radices_sum_prod_2;
-
-        if(N2)
-            TwiddleTable<T>::GetKernelParams(
-                radices2, radices_prod_2, radices_sum_prod_2, maxElem_2, minElem_2, table_sz_2);
-        else
-            table_sz_2 = N2;
-
-        auto table_sz    = (table_sz_1 + table_sz_2);
-        auto table_bytes = table_sz * sizeof(T);
-
-        if(table_bytes == 0)
-            return;
-
-        if(output.alloc(table_bytes) != hipSuccess)
-            throw std::runtime_error("unable to allocate twiddle length "
-                                     + std::to_string(table_sz));
-
-        auto device_data_ptr          = static_cast<T*>(output.data());
-        TwiddleTable<T>::length_limit = N1;
-        TwiddleTable<T>::launch_radices_kernel(radices1,
-                                               radices_prod_1,
-                                               radices_sum_prod_1,
-                                               maxElem_1,
-                                               minElem_1,
-                                               stream,
-                                               device_data_ptr);
-        if(N2)
+        size_t table_sz = 0;
+        auto   dims     = GetDimParams(lengths, radices, table_sz);
+
+        for(size_t d = 0; d < lengths.size(); ++d)
         {
-            TwiddleTable<T>::length_limit = N2;
-            TwiddleTable<T>::launch_radices_kernel(radices2,
-                                                   radices_prod_2,
-                                                   radices_sum_prod_2,
-                                                   maxElem_2,
-                                                   minElem_2,
+            auto& dim = dims[d];
+            if(!dim.offset || dim.table_sz == 0)
+                continue;
+            TwiddleTable<T>::length_limit = lengths[d];
+            TwiddleTable<T>::launch_radices_kernel(radices[d],
+                                                   dim.radices_prod,
+                                                   dim.radices_sum_prod,
+                                                   dim.maxElem,
+                                                   dim.minElem,
                                                    stream,
-                                                   device_data_ptr + table_sz_1);
+                                                   output + *dim.offset);
         }
     }
 };
@@ -354,34 +400,31 @@ private:
     size_t tableSize;
 
     const rocfft_precision precision;
-    const std::string      gpu_arch;
+    TwiddleKernels&        kernels;
 
 public:
-    TwiddleTableLarge(rocfft_precision   precision,
-                      const std::string& gpu_arch,
-                      size_t             length,
-                      size_t             base = LTWD_BASE_DEFAULT)
+    TwiddleTableLarge(rocfft_precision precision,
+                      TwiddleKernels&  kernels,
+                      size_t           length,
+                      size_t           base = LTWD_BASE_DEFAULT)
         : N(length)
         , largeTwdBase(base)
         , precision(precision)
-        , gpu_arch(gpu_arch)
+        , kernels(kernels)
     {
         X         = static_cast<size_t>(1) << largeTwdBase; // ex: 2^8 = 256
         Y         = DivRoundingUp<size_t>(CeilPo2(N), largeTwdBase);
         tableSize = X * Y;
     }
 
-    void GenerateTwiddleTable(hipStream_t& stream, gpubuf& output)
+    // number of elements in the table
+    size_t TableLength()
     {
-        auto table_bytes = tableSize * sizeof(T);
-
-        if(table_bytes == 0)
-            return;
-
-        if(output.alloc(table_bytes) != hipSuccess)
-            throw std::runtime_error("unable to allocate twiddle length "
-                                     + std::to_string(tableSize));
+        return tableSize;
+    }
 
+    void GenerateTwiddleTable(hipStream_t stream, T* output)
+    {
         auto blockSize = TWIDDLES_THREADS;
 
         double phi = TWO_PI / double(N);
@@ -389,144 +432,121 @@ public:
         auto numBlocksX = DivRoundingUp<size_t>(X, blockSize);
         auto numBlocksY = DivRoundingUp<size_t>(Y, blockSize);
 
-        auto kernel = RTCKernelTwiddle::generate(gpu_arch, TwiddleTableType::LARGE, precision);
+        auto&         kernel = kernels.get(TwiddleTableType::LARGE, precision);
         RTCKernelArgs kargs;
         kargs.append_double(phi);
         kargs.append_size_t(largeTwdBase);
         kargs.append_size_t(X);
         kargs.append_size_t(Y);
-        kargs.append_ptr(output.data());
+        kargs.append_ptr(output);
 
         kernel.launch(kargs, dim3(numBlocksX, numBlocksY), dim3(blockSize, blockSize), 0, stream);
     }
 };
 
-template <typename T>
-gpubuf twiddles_create_pr(size_t                     N,
-                          size_t                     length_limit,
-                          rocfft_precision           precision,
-                          const char*                gpu_arch,
-                          size_t                     largeTwdBase,
-                          bool                       attach_halfN,
-                          const std::vector<size_t>& radices,
-                          unsigned int               deviceId)
+// tables in a batch start on this alignment, in bytes
+static const size_t TWIDDLE_TABLE_ALIGN = 256;
+
+// a table in a batch: its size in bytes, and a function that
+// launches the kernels to fill it in
+struct twiddle_batch_item_t
 {
-    if(largeTwdBase && length_limit)
-        throw std::runtime_error("length-limited large twiddles are not supported");
+    size_t                                   bytes = 0;
+    std::function<void(hipStream_t, void*)> generate;
+};
 
-    gpubuf twts;
-    if(deviceId >= twiddle_streams.size())
-        twiddle_streams.resize(deviceId + 1);
-    if(twiddle_streams[deviceId] == nullptr)
-        twiddle_streams[deviceId].alloc();
-    hipStream_t stream = twiddle_streams[deviceId];
+template <typename T>
+twiddle_batch_item_t twiddle_batch_item(const TwiddleTableSpec& spec, TwiddleKernels& kernels)
+{
+    twiddle_batch_item_t item;
 
-    if(stream == nullptr)
+    if(spec.lengths.size() > 1)
     {
-        if(hipStreamCreate(&stream) != hipSuccess)
-            throw std::runtime_error("hipStreamCreate failure");
+        auto kernel = function_pool::get_fused_kernel(spec.lengths, spec.precision);
+        if(!kernel)
+            throw std::runtime_error("no multi-dimensional kernel for twiddles");
+        auto radices = kernel->factors_per_dim(spec.lengths);
+
+        TwiddleTableMultiDim<T> table(spec.precision, kernels);
+        item.bytes    = table.TableLength(spec.lengths, radices) * sizeof(T);
+        item.generate = [=](hipStream_t stream, void* output) mutable {
+            table.GenerateTwiddleTable(spec.lengths, radices, stream, static_cast<T*>(output));
+        };
+        return item;
     }
 
-    if((N <= LARGE_TWIDDLE_THRESHOLD) && largeTwdBase == 0)
+    auto N = spec.lengths.at(0);
+    if(spec.large_twiddle_base)
     {
-        TwiddleTable<T> twTable(precision, gpu_arch, N, length_limit, attach_halfN);
-        twTable.GenerateTwiddleTable(radices, stream, twts);
+        if(spec.length_limit)
+            throw std::runtime_error("length-limited large twiddles are not supported");
+
+        TwiddleTableLarge<T> table(spec.precision, kernels, N, spec.large_twiddle_base);
+        item.bytes    = table.TableLength() * sizeof(T);
+        item.generate = [=](hipStream_t stream, void* output) mutable {
+            table.GenerateTwiddleTable(stream, static_cast<T*>(output));
+        };
+        return item;
     }
-    else
-    {
-        assert(!attach_halfN);
 
-        if(largeTwdBase == 0)
-        {
-            TwiddleTable<T> twTable(precision, gpu_arch, N, length_limit, attach_halfN);
-            twTable.GenerateTwiddleTable(radices, stream, twts);
-        }
-        else
-        {
-            TwiddleTableLarge<T> twTable(
-                precision, gpu_arch, N, largeTwdBase); // does not generate radices
-            twTable.GenerateTwiddleTable(stream, twts);
-        }
-    }
+    assert(N <= LARGE_TWIDDLE_THRESHOLD || !spec.attach_halfN);
 
-    if(hipStreamSynchronize(stream) != hipSuccess)
-        throw std::runtime_error("hipStream failure");
-
-    return twts;
-}
-
-gpubuf twiddles_create(size_t                     N,
-                       size_t                     length_limit,
-                       rocfft_precision           precision,
-                       const char*                gpu_arch,
-                       size_t                     largeTwdBase,
-                       bool                       attach_halfN,
-                       const std::vector<size_t>& radices,
-                       unsigned int               deviceId)
-{
-    switch(precision)
-    {
-    case rocfft_precision_single:
-        return twiddles_create_pr<rocfft_complex<float>>(
-            N, length_limit, precision, gpu_arch, largeTwdBase, attach_halfN, radices, deviceId);
-    case rocfft_precision_double:
-        return twiddles_create_pr<rocfft_complex<double>>(
-            N, length_limit, precision, gpu_arch, largeTwdBase, attach_halfN, radices, deviceId);
-    case rocfft_precision_half:
-        return twiddles_create_pr<rocfft_complex<_Float16>>(
-            N, length_limit, precision, gpu_arch, largeTwdBase, attach_halfN, radices, deviceId);
-    }
+    TwiddleTable<T> table(spec.precision, kernels, N, spec.length_limit, spec.attach_halfN);
+    item.bytes    = table.TableLength(spec.radices) * sizeof(T);
+    item.generate = [=](hipStream_t stream, void* output) mutable {
+        table.GenerateTwiddleTable(spec.radices, stream, static_cast<T*>(output));
+    };
+    return item;
 }
 
-template <typename T>
-gpubuf twiddles_create_2D_pr(
-    size_t N1, size_t N2, rocfft_precision precision, const char* gpu_arch, unsigned int deviceId)
+gpubuf twiddles_create_batch(const std::vector<TwiddleTableSpec>&    specs,
+                             const char*                             gpu_arch,
+                             unsigned int                            deviceId,
+                             std::vector<std::pair<size_t, size_t>>& tables)
 {
-    auto                kernel = function_pool::get_kernel(fpkey(N1, N2, precision));
-    std::vector<size_t> radices1, radices2;
+    TwiddleKernels kernels(gpu_arch);
 
-    int    count               = 0;
-    size_t cummulative_product = 1;
-    while(cummulative_product != N1)
+    // work out where each table goes before allocating anything
+    std::vector<twiddle_batch_item_t> items;
+    tables.clear();
+    size_t batch_bytes = 0;
+    for(const auto& spec : specs)
     {
-        cummulative_product *= kernel.factors[count++];
+        switch(spec.precision)
+        {
+        case rocfft_precision_single:
+            items.push_back(twiddle_batch_item<rocfft_complex<float>>(spec, kernels));
+            break;
+        case rocfft_precision_double:
+            items.push_back(twiddle_batch_item<rocfft_complex<double>>(spec, kernels));
+            break;
+        case rocfft_precision_half:
+            items.push_back(twiddle_batch_item<rocfft_complex<_Float16>>(spec, kernels));
+            break;
+        }
+        tables.emplace_back(batch_bytes, items.back().bytes);
+        batch_bytes += DivRoundingUp<size_t>(items.back().bytes, TWIDDLE_TABLE_ALIGN)
+                       * TWIDDLE_TABLE_ALIGN;
     }
-    radices1.insert(radices1.cbegin(), kernel.factors.cbegin(), kernel.factors.cbegin() + count);
-    radices2.insert(radices2.cbegin(), kernel.factors.cbegin() + count, kernel.factors.cend());
 
     gpubuf twts;
-    if(deviceId >= twiddle_streams.size())
-        twiddle_streams.resize(deviceId + 1);
-    if(twiddle_streams[deviceId] == nullptr)
-        twiddle_streams[deviceId].alloc();
-    hipStream_t stream = twiddle_streams[deviceId];
+    if(batch_bytes == 0)
+        return twts;
 
-    if(stream == nullptr)
+    if(twts.alloc(batch_bytes) != hipSuccess)
+        throw std::runtime_error("unable to allocate " + std::to_string(batch_bytes)
+                                 + " bytes of twiddles");
+
+    // launch everything, and only wait once at the end
+    auto stream = get_twiddle_stream(deviceId);
+    for(size_t i = 0; i < items.size(); ++i)
     {
-        if(hipStreamCreate(&stream) != hipSuccess)
-            throw std::runtime_error("hipStreamCreate failure");
+        if(items[i].bytes)
+            items[i].generate(stream, static_cast<char*>(twts.data()) + tables[i].first);
     }
 
-    TwiddleTable2D<T> twTable(precision, gpu_arch, N1, N2);
-    twTable.GenerateTwiddleTable(radices1, radices2, stream, twts);
-
     if(hipStreamSynchronize(stream) != hipSuccess)
         throw std::runtime_error("hipStream failure");
 
     return twts;
 }
-
-gpubuf twiddles_create_2D(
-    size_t N1, size_t N2, rocfft_precision precision, const char* gpu_arch, unsigned int deviceId)
-{
-    switch(precision)
-    {
-    case rocfft_precision_single:
-        return twiddles_create_2D_pr<rocfft_complex<float>>(N1, N2, precision, gpu_arch, deviceId);
-    case rocfft_precision_double:
-        return twiddles_create_2D_pr<rocfft_complex<double>>(N1, N2, precision, gpu_arch, deviceId);
-    case rocfft_precision_half:
-        return twiddles_create_2D_pr<rocfft_complex<_Float16>>(
-            N1, N2, precision, gpu_arch, deviceId);
-    }
-}
@@ -19,11 +19,14 @@
 # THE SOFTWARE.
 """Rider launch utils."""
 
+import json
 import logging
 import pathlib
+import queue
 import re
 import subprocess
 import tempfile
+import threading
 import time
 
 
@@ -131,3 +134,133 @@ def run(rider,
     success = proc.returncode == 0
 
     return token, times, success
+
+
+def problem_token(length,
+                  direction=-1,
+                  real=False,
+                  inplace=True,
+                  precision='single',
+                  nbatch=1):
+    """Return the fft params token for a rider problem.
+
+    Strides and distances are left unset so that rider fills in the
+    same defaults as for command line arguments.
+    """
+    if isinstance(length, int):
+        length = [length]
+
+    if real:
+        kind = 'real_forward' if direction == -1 else 'real_inverse'
+        itype, otype = ('R', 'HI') if direction == -1 else ('HI', 'R')
+    else:
+        kind = 'complex_forward' if direction == -1 else 'complex_inverse'
+        itype, otype = 'CI', 'CI'
+
+    return '_'.join([kind, 'len'] + [str(x) for x in length] + [
+        precision, 'ip' if inplace else 'op', 'batch',
+        str(nbatch), 'istride', itype, 'ostride', otype, 'idist', '0',
+        'odist', '0', 'ioffset', '0', '0', 'ooffset', '0', '0'
+    ])
+
+
+def _read_results(stream, results):
+    """Queue the JSON result lines written by rider, then None at EOF."""
+    for line in stream:
+        if line.startswith('{'):
+            try:
+                results.put(json.loads(line))
+            except json.JSONDecodeError:
+                logging.info('unable to parse rider output: ' + line)
+        else:
+            logging.debug(line.rstrip())
+    results.put(None)
+
+
+def run_batch(rider,
+              tokens,
+              ntrial=1,
+              warmup=1,
+              device=None,
+              verbose=False,
+              timeout=300):
+    """Run rocFFT rider on many problems in one process.
+
+    Returns a list of (token, times, success) tuples, in the same
+    order as `tokens`, like those returned by `run`.  The timeout
+    applies to each problem.  If rider crashes or times out, that
+    problem fails and a new rider process runs the remaining ones.
+    """
+    ret = []
+    while len(ret) < len(tokens):
+        remaining = tokens[len(ret):]
+
+        ftokens = tempfile.NamedTemporaryFile(mode='w+', suffix='.txt')
+        ftokens.write('\n'.join(remaining) + '\n')
+        ftokens.flush()
+
+        cmd = [
+            pathlib.Path(rider).resolve(), '--token-file', ftokens.name,
+            '-N', ntrial, '--warmup', warmup
+        ]
+        if device is not None:
+            cmd += ['--device', device]
+
+        cmd = [str(x) for x in cmd]
+        logging.info('running: ' + ' '.join(cmd) + ' (' +
+                     str(len(remaining)) + ' problems)')
+        if verbose:
+            print('running: ' + ' '.join(cmd))
+        ferr = tempfile.TemporaryFile(mode="w+")
+
+        time_start = time.time()
+        proc = subprocess.Popen(cmd,
+                                stdout=subprocess.PIPE,
+                                stderr=ferr,
+                                text=True)
+        results = queue.Queue()
+        reader = threading.Thread(target=_read_results,
+                                  args=(proc.stdout, results),
+                                  daemon=True)
+        reader.start()
+
+        for tok in remaining:
+            try:
+                result = results.get(timeout=None if timeout == 0 else timeout)
+            except queue.Empty:
+                logging.info("killed")
+                proc.kill()
+                result = None
+
+            if result is None:
+                # rider crashed or timed out on this problem
+                logging.info("PROCESS FAILED on " + tok)
+                ret.append((tok, [], False))
+                print('x', end='', flush=True)
+                break
+
+            status = result.get('status')
+            if status == 'ok':
+                ret.append((result['token'], [result['times']], True))
+                print('.', end='', flush=True)
+            elif status == 'skipped':
+                ret.append((result['token'], [], True))
+                print('s', end='', flush=True)
+            else:
+                logging.info("FAILED " + result['token'] + ": " +
+                             result.get('message', ''))
+                ret.append((result['token'], [], False))
+                print('x', end='', flush=True)
+
+        proc.wait()
+        time_end = time.time()
+        logging.info("elapsed time in seconds: " + str(time_end - time_start))
+
+        ferr.seek(0)
+        logging.debug(ferr.read())
+        ftokens.close()
+
+        if verbose:
+            print('finished: ' + ' '.join(cmd))
+
+    return ret
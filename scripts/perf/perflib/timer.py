@@ -41,6 +41,7 @@ class Timer:
     ntrial: int = 10
     verbose: bool = False
     timeout: float = 0
+    batch: bool = True
 
     def run_cases(self, generator):
 
@@ -50,23 +51,45 @@ class Timer:
 
         failed_tokens = []
 
+        problems = list(generator.generate_problems())
+
+        # Time all problems in one rider process if possible.
+        # dyna-rider needs a process per problem to load its libraries.
+        if self.batch and 'dyna' not in rider.name:
+            tokens = [
+                perflib.rider.problem_token(prob.length,
+                                            direction=prob.direction,
+                                            real=prob.real,
+                                            inplace=prob.inplace,
+                                            precision=prob.precision,
+                                            nbatch=prob.nbatch)
+                for prob in problems
+            ]
+            results = perflib.rider.run_batch(self.rider,
+                                              tokens,
+                                              ntrial=self.ntrial,
+                                              device=self.device,
+                                              verbose=self.verbose,
+                                              timeout=self.timeout)
+        else:
+            results = (perflib.rider.run(self.rider,
+                                         prob.length,
+                                         direction=prob.direction,
+                                         real=prob.real,
+                                         inplace=prob.inplace,
+                                         precision=prob.precision,
+                                         nbatch=prob.nbatch,
+                                         ntrial=self.ntrial,
+                                         device=self.device,
+                                         libraries=self.lib,
+                                         verbose=self.verbose,
+                                         timeout=self.timeout)
+                       for prob in problems)
+
         total_prob_count = 0
         no_accutest_prob_count = 0
-        for prob in generator.generate_problems():
+        for prob, (token, seconds, success) in zip(problems, results):
             total_prob_count += 1
-            token, seconds, success = perflib.rider.run(
-                self.rider,
-                prob.length,
-                direction=prob.direction,
-                real=prob.real,
-                inplace=prob.inplace,
-                precision=prob.precision,
-                nbatch=prob.nbatch,
-                ntrial=self.ntrial,
-                device=self.device,
-                libraries=self.lib,
-                verbose=self.verbose,
-                timeout=self.timeout)
 
             if success:
                 for idx, vals in enumerate(seconds):
@@ -105,6 +128,7 @@ class GroupedTimer:
     ntrial: int = 10
     verbose: bool = False
     timeout: float = 0
+    batch: bool = True
 
     def run_cases(self, generator):
         failed_tokens = []
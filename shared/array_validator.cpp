@@ -35,6 +35,15 @@ bool valid_length_stride_2d(const size_t l0, const size_t l1, const size_t s0, c
     return !((s0 * (l0 - 1) >= c) && (s1 * (l1 - 1) >= c));
 }
 
+// Return the largest offset reachable in a multi-index hyperface.
+size_t max_face_offset(const std::vector<size_t>& l, const std::vector<size_t>& s)
+{
+    size_t max_offset = 0;
+    for(size_t i = 0; i < l.size(); ++i)
+        max_offset += (l[i] - 1) * s[i];
+    return max_offset;
+}
+
 // Compare a 1D direction with a multi-index hyperface for collisions.
 bool valid_length_stride_1d_multi(const unsigned int        idx,
                                   const std::vector<size_t> l,
@@ -63,9 +72,7 @@ bool valid_length_stride_1d_multi(const unsigned int        idx,
     }
 
     // We only need to go to the maximum pointer offset for (l1,s1).
-    const auto max_offset
-        = std::accumulate(l1.begin(), l1.end(), (size_t)1, std::multiplies<size_t>())
-          - std ::inner_product(l1.begin(), l1.end(), s1.begin(), (size_t)0);
+    const auto                 max_offset = max_face_offset(l1, s1);
     std::unordered_set<size_t> a0{};
     for(size_t i = 1; i < l0; ++i)
     {
@@ -99,7 +106,7 @@ bool valid_length_stride_1d_multi(const unsigned int        idx,
     std::fill(index.begin(), index.end(), 0);
     do
     {
-        const int i = std::inner_product(index.begin(), index.end(), s1.begin(), (size_t)0);
+        const auto i = std::inner_product(index.begin(), index.end(), s1.begin(), (size_t)0);
         if(i > 0 && (i % s0 == 0))
         {
             // TODO: use an ordered set and binary search
@@ -135,15 +142,14 @@ bool valid_length_stride_multi_multi(const std::vector<size_t> l0,
 {
     std::unordered_set<size_t> a0{};
 
-    const auto max_offset
-        = std::accumulate(l1.begin(), l1.end(), (size_t)1, std::multiplies<size_t>())
-          - std::inner_product(l1.begin(), l1.end(), s1.begin(), (size_t)0);
-    std::vector<size_t> index0(l0.size()); // TODO: check this
+    // We only need to go to the maximum pointer offset for (l1,s1).
+    const auto          max_offset = max_face_offset(l1, s1);
+    std::vector<size_t> index0(l0.size());
     std::fill(index0.begin(), index0.end(), 0);
     do
     {
         const auto i = std::inner_product(index0.begin(), index0.end(), s0.begin(), (size_t)0);
-        if(i > max_offset)
+        if(i > 0 && i <= max_offset)
             a0.insert(i);
     } while(increment_rowmajor(index0, l0));
 
@@ -262,10 +268,10 @@ bool valid_length_stride_4d(const std::vector<size_t>& l,
 #endif
     for(size_t iperm = 0; iperm < perms.size(); ++iperm)
     {
-        std::vector<size_t> l0(2);
-        std::vector<size_t> s0(2);
-        std::vector<size_t> l1(2);
-        std::vector<size_t> s1(2);
+        std::vector<size_t> l0;
+        std::vector<size_t> s0;
+        std::vector<size_t> l1;
+        std::vector<size_t> s1;
         for(size_t i = 0; i < l.size(); ++i)
         {
             if(perms[iperm][i] == 0)
@@ -392,14 +398,14 @@ bool valid_length_stride_generald(const std::vector<size_t> l,
 #endif
         for(size_t iperm = 0; iperm < perms.size(); ++iperm)
         {
-            std::vector<size_t> l0(dim0);
-            std::vector<size_t> s0(dim0);
-            std::vector<size_t> l1(dim1);
-            std::vector<size_t> s1(dim1);
+            std::vector<size_t> l0;
+            std::vector<size_t> s0;
+            std::vector<size_t> l1;
+            std::vector<size_t> s1;
 
             for(size_t i = 0; i < l.size(); ++i)
             {
-                if(v[i] == 0)
+                if(perms[iperm][i] == 0)
                 {
                     l0.push_back(l[i]);
                     s0.push_back(s[i]);
@@ -454,11 +460,6 @@ bool valid_length_stride_generald(const std::vector<size_t> l,
     return true;
 }
 
-bool sort_by_stride(const std::pair<size_t, size_t>& ls0, const std::pair<size_t, size_t>& ls1)
-{
-    return ls0.second < ls1.second;
-}
-
 bool array_valid(const std::vector<size_t>& length,
                  const std::vector<size_t>& stride,
                  const int                  verbose)
@@ -480,41 +481,21 @@ bool array_valid(const std::vector<size_t>& length,
         }
     }
 
-    if(length.size() > 1)
+    // Most layouts can be decided without enumerating any indices.
+    switch(array_overlap_analytic(l, s))
     {
-        // Check happy path.
-        bool                                   happy_path = true;
-        std::vector<std::pair<size_t, size_t>> ls;
-        for(size_t idx = 0; idx < length.size(); ++idx)
-        {
-            ls.push_back(std::pair(length[idx], stride[idx]));
-        }
-        std::sort(ls.begin(), ls.end(), sort_by_stride);
-
+    case array_overlap::none:
         if(verbose > 2)
-        {
-            for(size_t idx = 0; idx < ls.size(); ++idx)
-            {
-                std::cout << ls[idx].first << "\t" << ls[idx].second << "\n";
-            }
-        }
-
-        for(size_t idx = 1; idx < ls.size(); ++idx)
-        {
-            if(ls[idx].second < ls[idx - 1].first * ls[idx - 1].second)
-            {
-                happy_path = false;
-                break;
-            }
-        }
-        if(happy_path)
-        {
-            if(verbose > 2)
-            {
-                std::cout << "happy path\n";
-            }
-            return true;
-        }
+            std::cout << "analytic: no overlap\n";
+        return true;
+    case array_overlap::some:
+        if(verbose > 2)
+            std::cout << "analytic: overlap\n";
+        return false;
+    case array_overlap::unknown:
+        if(verbose > 2)
+            std::cout << "analytic: unknown, enumerating\n";
+        break;
     }
 
     switch(l.size())
@@ -21,8 +21,100 @@
 #ifndef ARRAY_VALIDATOR_H
 #define ARRAY_VALIDATOR_H
 
+#include <algorithm>
+#include <numeric>
+#include <utility>
 #include <vector>
 
+enum class array_overlap
+{
+    // no two multi-indices have the same offset
+    none,
+    // at least two multi-indices have the same offset
+    some,
+    // the analytic checks couldn't decide
+    unknown,
+};
+
+// Decide whether the array with given length and stride has
+// multi-index collisions, without enumerating any indices.
+//
+// Dimensions are sorted by stride.  If each stride exceeds the
+// largest offset reachable by the smaller-stride dimensions, the
+// strides act as the digits of a mixed-radix number and every
+// multi-index has a unique offset.  A dimension whose stride falls
+// inside that range is checked for a definite collision against
+// each smaller dimension, and decided exactly if the smaller
+// dimensions pack densely.  Otherwise, the answer is unknown.
+//
+// This costs O(d log d) for the usual layouts, and O(d^2) otherwise.
+inline array_overlap array_overlap_analytic(const std::vector<size_t>& length,
+                                            const std::vector<size_t>& stride)
+{
+    if(length.size() != stride.size())
+        return array_overlap::unknown;
+
+    // A length of 1 makes its stride irrelevant.
+    std::vector<std::pair<size_t, size_t>> ls;
+    for(size_t i = 0; i < length.size(); ++i)
+    {
+        if(length[i] > 1)
+        {
+            if(stride[i] == 0)
+                return array_overlap::some;
+            ls.emplace_back(stride[i], length[i]);
+        }
+    }
+    std::sort(ls.begin(), ls.end());
+
+    bool decided = true;
+    // Largest offset reachable by the dimensions seen so far.
+    size_t reach = 0;
+    // Whether the dimensions seen so far reach exactly the multiples
+    // of the smallest stride, up to reach.
+    bool dense = true;
+    for(size_t i = 0; i < ls.size(); ++i)
+    {
+        const auto s = ls[i].first;
+        const auto l = ls[i].second;
+
+        if(s > reach)
+        {
+            dense = dense && (i == 0 || s == reach + ls[0].first);
+            reach += s * (l - 1);
+            continue;
+        }
+
+        // Check against each smaller dimension: the first common
+        // multiple of the two strides must be out of range of one
+        // of them.
+        for(size_t j = 0; j < i; ++j)
+        {
+            const auto c = std::lcm(s, ls[j].first);
+            if(s * (l - 1) >= c && ls[j].first * (ls[j].second - 1) >= c)
+                return array_overlap::some;
+        }
+
+        // If the smaller dimensions reach every multiple of g up to
+        // reach, then the first multiple of s that's also a
+        // multiple of g collides if it's in range.  Otherwise, no
+        // step along this dimension lands on a reachable offset.
+        if(dense)
+        {
+            const auto g = ls[0].first;
+            const auto c = g / std::gcd(g, s);
+            if(c < l && c * s <= reach)
+                return array_overlap::some;
+        }
+        else
+            decided = false;
+
+        dense = false;
+        reach += s * (l - 1);
+    }
+    return decided ? array_overlap::none : array_overlap::unknown;
+}
+
 // Checks whether the array with given length and stride has multi-index collisions.
 bool array_valid(const std::vector<size_t>& length,
                  const std::vector<size_t>& stride,
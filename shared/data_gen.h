@@ -24,14 +24,22 @@
 #include "../shared/arithmetic.h"
 #include "../shared/gpubuf.h"
 #include "../shared/rocfft_complex.h"
+#include <cstdint>
 #include <hip/hip_runtime.h>
 #include <hip/hip_runtime_api.h>
-#include <hiprand/hiprand.h>
-#include <hiprand/hiprand_kernel.h>
 #include <vector>
 
 static const unsigned int DATA_GEN_THREADS = 32;
 
+// Identifies the values the input generators below produce.  Bump
+// this whenever they change, so that reference results stored on
+// disk by earlier test runs are not reused with different inputs.
+static const unsigned int DATA_GEN_VERSION = 2;
+
+// Key for the input generators.  Inputs are fixed for a given
+// problem, so that tests can reuse reference results.
+static const uint64_t DATA_GEN_SEED = 0;
+
 template <typename T>
 struct input_val_1D
 {
@@ -72,21 +80,21 @@ static input_val_3D<T> get_input_val(const std::tuple<T, T, T>& val)
 }
 
 template <typename T>
-__device__ static size_t
+__host__ __device__ static size_t
     compute_index(const input_val_1D<T>& length, const input_val_1D<T>& stride, size_t base)
 {
     return (length.val1 * stride.val1) + base;
 }
 
 template <typename T>
-__device__ static size_t
+__host__ __device__ static size_t
     compute_index(const input_val_2D<T>& length, const input_val_2D<T>& stride, size_t base)
 {
     return (length.val1 * stride.val1) + (length.val2 * stride.val2) + base;
 }
 
 template <typename T>
-__device__ static size_t
+__host__ __device__ static size_t
     compute_index(const input_val_3D<T>& length, const input_val_3D<T>& stride, size_t base)
 {
     return (length.val1 * stride.val1) + (length.val2 * stride.val2) + (length.val3 * stride.val3)
@@ -94,25 +102,8 @@ __device__ static size_t
 }
 
 template <typename T>
-static inline input_val_1D<T> make_zero_length(const input_val_1D<T>& whole_length)
-{
-    return input_val_1D<T>{0};
-}
-
-template <typename T>
-static inline input_val_2D<T> make_zero_length(const input_val_2D<T>& whole_length)
-{
-    return input_val_2D<T>{0, 0};
-}
-
-template <typename T>
-static inline input_val_3D<T> make_zero_length(const input_val_3D<T>& whole_length)
-{
-    return input_val_3D<T>{0, 0, 0};
-}
-
-template <typename T>
-__device__ static input_val_1D<T> get_length(const size_t i, const input_val_1D<T>& whole_length)
+__host__ __device__ static input_val_1D<T> get_length(const size_t               i,
+                                                      const input_val_1D<T>& whole_length)
 {
     auto xlen = whole_length.val1;
 
@@ -122,7 +113,7 @@ __device__ static input_val_1D<T> get_length(const size_t i, const input_val_1D<
 }
 
 template <typename T>
-__device__ static size_t get_batch(const size_t i, const input_val_1D<T>& whole_length)
+__host__ __device__ static size_t get_batch(const size_t i, const input_val_1D<T>& whole_length)
 {
     auto xlen = whole_length.val1;
 
@@ -132,7 +123,8 @@ __device__ static size_t get_batch(const size_t i, const input_val_1D<T>& whole_
 }
 
 template <typename T>
-__device__ static input_val_2D<T> get_length(const size_t i, const input_val_2D<T>& whole_length)
+__host__ __device__ static input_val_2D<T> get_length(const size_t               i,
+                                                      const input_val_2D<T>& whole_length)
 {
     auto xlen = whole_length.val1;
     auto ylen = whole_length.val2;
@@ -144,7 +136,7 @@ __device__ static input_val_2D<T> get_length(const size_t i, const input_val_2D<
 }
 
 template <typename T>
-__device__ static size_t get_batch(const size_t i, const input_val_2D<T>& whole_length)
+__host__ __device__ static size_t get_batch(const size_t i, const input_val_2D<T>& whole_length)
 {
     auto xlen = whole_length.val1;
     auto ylen = whole_length.val2;
@@ -155,7 +147,8 @@ __device__ static size_t get_batch(const size_t i, const input_val_2D<T>& whole_
 }
 
 template <typename T>
-__device__ static input_val_3D<T> get_length(const size_t i, const input_val_3D<T>& whole_length)
+__host__ __device__ static input_val_3D<T> get_length(const size_t               i,
+                                                      const input_val_3D<T>& whole_length)
 {
     auto xlen = whole_length.val1;
     auto ylen = whole_length.val2;
@@ -169,7 +162,7 @@ __device__ static input_val_3D<T> get_length(const size_t i, const input_val_3D<
 }
 
 template <typename T>
-__device__ static size_t get_batch(const size_t i, const input_val_3D<T>& length)
+__host__ __device__ static size_t get_batch(const size_t i, const input_val_3D<T>& length)
 {
     auto xlen = length.val1;
     auto ylen = length.val2;
@@ -180,85 +173,171 @@ __device__ static size_t get_batch(const size_t i, const input_val_3D<T>& length
     return widx;
 }
 
+// Philox4x32-10 counter-based generator, from Salmon et al, "Parallel
+// Random Numbers: As Easy as 1, 2, 3".  It maps a 128-bit counter
+// and 64-bit key to 128 random bits, so every element of the input
+// can be generated independently from its index, and the host and
+// device produce identical values.
+struct philox4x32
+{
+    uint32_t v[4];
+};
+
+__host__ __device__ static inline uint32_t philox_mulhilo(uint32_t a, uint32_t b, uint32_t& hi)
+{
+    const uint64_t product = static_cast<uint64_t>(a) * b;
+    hi                     = static_cast<uint32_t>(product >> 32);
+    return static_cast<uint32_t>(product);
+}
+
+__host__ __device__ static inline philox4x32 philox4x32_10(philox4x32 ctr, uint64_t key)
+{
+    uint32_t k0 = static_cast<uint32_t>(key);
+    uint32_t k1 = static_cast<uint32_t>(key >> 32);
+    for(unsigned int round = 0; round < 10; ++round)
+    {
+        uint32_t hi0, hi1;
+        uint32_t lo0 = philox_mulhilo(0xD2511F53, ctr.v[0], hi0);
+        uint32_t lo1 = philox_mulhilo(0xCD9E8D57, ctr.v[2], hi1);
+        ctr          = {{hi1 ^ ctr.v[1] ^ k0, lo1, hi0 ^ ctr.v[3] ^ k1, lo0}};
+        k0 += 0x9E3779B9;
+        k1 += 0xBB67AE85;
+    }
+    return ctr;
+}
+
+// The counter is the element's multi-index and batch.
+template <typename T>
+__host__ __device__ static inline philox4x32 philox_counter(const input_val_1D<T>& i, size_t batch)
+{
+    return {{static_cast<uint32_t>(i.val1), 0, 0, static_cast<uint32_t>(batch)}};
+}
+
+template <typename T>
+__host__ __device__ static inline philox4x32 philox_counter(const input_val_2D<T>& i, size_t batch)
+{
+    return {{static_cast<uint32_t>(i.val1),
+             static_cast<uint32_t>(i.val2),
+             0,
+             static_cast<uint32_t>(batch)}};
+}
+
+template <typename T>
+__host__ __device__ static inline philox4x32 philox_counter(const input_val_3D<T>& i, size_t batch)
+{
+    return {{static_cast<uint32_t>(i.val1),
+             static_cast<uint32_t>(i.val2),
+             static_cast<uint32_t>(i.val3),
+             static_cast<uint32_t>(batch)}};
+}
+
+// Uniform double in [0, 1) from the top 53 of 64 random bits.
+__host__ __device__ static inline double philox_uniform_double(uint32_t hi, uint32_t lo)
+{
+    const uint64_t bits = (static_cast<uint64_t>(hi) << 32 | lo) >> 11;
+    return static_cast<double>(bits) * (1.0 / 9007199254740992.0);
+}
+
+// Generate element i of the (logically contiguous) input, for both
+// the device kernels and the host loops below.
+template <typename Tint, typename Treal>
+__host__ __device__ static inline void
+    generate_interleaved_data_element(const Tint&            whole_length,
+                                      size_t                 idist,
+                                      const Tint&            istride,
+                                      uint64_t               seed,
+                                      size_t                 i,
+                                      rocfft_complex<Treal>* data)
+{
+    auto i_length = get_length(i, whole_length);
+    auto i_batch  = get_batch(i, whole_length);
+    auto idx      = compute_index(i_length, istride, i_batch * idist);
+
+    auto r = philox4x32_10(philox_counter(i_length, i_batch), seed);
+
+    data[idx].x = philox_uniform_double(r.v[0], r.v[1]);
+    data[idx].y = philox_uniform_double(r.v[2], r.v[3]);
+}
+
+template <typename Tint, typename Treal>
+__host__ __device__ static inline void
+    generate_planar_data_element(const Tint& whole_length,
+                                 size_t      idist,
+                                 const Tint& istride,
+                                 uint64_t    seed,
+                                 size_t      i,
+                                 Treal*      real_data,
+                                 Treal*      imag_data)
+{
+    auto i_length = get_length(i, whole_length);
+    auto i_batch  = get_batch(i, whole_length);
+    auto idx      = compute_index(i_length, istride, i_batch * idist);
+
+    auto r = philox4x32_10(philox_counter(i_length, i_batch), seed);
+
+    real_data[idx] = philox_uniform_double(r.v[0], r.v[1]);
+    imag_data[idx] = philox_uniform_double(r.v[2], r.v[3]);
+}
+
+template <typename Tint, typename Treal>
+__host__ __device__ static inline void
+    generate_real_data_element(const Tint& whole_length,
+                               size_t      idist,
+                               const Tint& istride,
+                               uint64_t    seed,
+                               size_t      i,
+                               Treal*      data)
+{
+    auto i_length = get_length(i, whole_length);
+    auto i_batch  = get_batch(i, whole_length);
+    auto idx      = compute_index(i_length, istride, i_batch * idist);
+
+    auto r = philox4x32_10(philox_counter(i_length, i_batch), seed);
+
+    data[idx] = philox_uniform_double(r.v[0], r.v[1]);
+}
+
 template <typename Tint, typename Treal>
 __global__ static void __launch_bounds__(DATA_GEN_THREADS)
     generate_interleaved_data_kernel(const Tint             whole_length,
-                                     const Tint             zero_length,
                                      size_t                 idist,
                                      size_t                 isize,
                                      const Tint             istride,
+                                     uint64_t               seed,
                                      rocfft_complex<Treal>* data)
 {
     auto const i = threadIdx.x + blockIdx.x * blockDim.x;
     if(i < isize)
-    {
-        auto i_length = get_length(i, whole_length);
-        auto i_batch  = get_batch(i, whole_length);
-        auto i_base   = i_batch * idist;
-
-        auto seed = compute_index(zero_length, istride, i_base);
-        auto idx  = compute_index(i_length, istride, i_base);
-
-        hiprandStatePhilox4_32_10 gen_state;
-        hiprand_init(seed, idx, 0, &gen_state);
-
-        data[idx].x = hiprand_uniform_double(&gen_state);
-        data[idx].y = hiprand_uniform_double(&gen_state);
-    }
+        generate_interleaved_data_element(whole_length, idist, istride, seed, i, data);
 }
 
 template <typename Tint, typename Treal>
 __global__ static void __launch_bounds__(DATA_GEN_THREADS)
     generate_planar_data_kernel(const Tint whole_length,
-                                const Tint zero_length,
                                 size_t     idist,
                                 size_t     isize,
                                 const Tint istride,
+                                uint64_t   seed,
                                 Treal*     real_data,
                                 Treal*     imag_data)
 {
     auto const i = threadIdx.x + blockIdx.x * blockDim.x;
     if(i < isize)
-    {
-        auto i_length = get_length(i, whole_length);
-        auto i_batch  = get_batch(i, whole_length);
-        auto i_base   = i_batch * idist;
-
-        auto seed = compute_index(zero_length, istride, i_base);
-        auto idx  = compute_index(i_length, istride, i_base);
-
-        hiprandStatePhilox4_32_10 gen_state;
-        hiprand_init(seed, idx, 0, &gen_state);
-
-        real_data[idx] = hiprand_uniform_double(&gen_state);
-        imag_data[idx] = hiprand_uniform_double(&gen_state);
-    }
+        generate_planar_data_element(whole_length, idist, istride, seed, i, real_data, imag_data);
 }
 
 template <typename Tint, typename Treal>
 __global__ static void __launch_bounds__(DATA_GEN_THREADS)
     generate_real_data_kernel(const Tint whole_length,
-                              const Tint zero_length,
                               size_t     idist,
                               size_t     isize,
                               const Tint istride,
+                              uint64_t   seed,
                               Treal*     data)
 {
     auto const i = threadIdx.x + blockIdx.x * blockDim.x;
     if(i < isize)
-    {
-        auto i_length = get_length(i, whole_length);
-        auto i_batch  = get_batch(i, whole_length);
-        auto i_base   = i_batch * idist;
-
-        auto seed = compute_index(zero_length, istride, i_base);
-        auto idx  = compute_index(i_length, istride, i_base);
-
-        hiprandStatePhilox4_32_10 gen_state;
-        hiprand_init(seed, idx, 0, &gen_state);
-
-        data[idx] = hiprand_uniform_double(&gen_state);
-    }
+        generate_real_data_element(whole_length, idist, istride, seed, i, data);
 }
 
 // For complex-to-real transforms, the input data must be Hermitiam-symmetric.
@@ -275,6 +354,28 @@ __global__ static void __launch_bounds__(DATA_GEN_THREADS)
 // Kernels for imposing Hermitian symmetry on 1D
 // complex (interleaved/planar) data on the GPU.
 
+template <typename Tcomplex>
+__host__ __device__ static void
+    impose_hermitian_symmetry_interleaved_1_element(Tcomplex*    x,
+                                                    const size_t Nx,
+                                                    const size_t xstride,
+                                                    const size_t dist,
+                                                    const bool   Nxeven,
+                                                    size_t       idx)
+{
+    idx *= dist;
+
+    // The DC mode must be real-valued.
+    x[idx].y = 0.0;
+
+    if(Nxeven)
+    {
+        // Nyquist mode
+        auto pos = idx + (Nx / 2) * xstride;
+        x[pos].y = 0.0;
+    }
+}
+
 template <typename Tcomplex>
 __global__ static void __launch_bounds__(DATA_GEN_THREADS)
     impose_hermitian_symmetry_interleaved_1(Tcomplex*    x,
@@ -287,18 +388,28 @@ __global__ static void __launch_bounds__(DATA_GEN_THREADS)
     auto idx = blockIdx.x * blockDim.x + threadIdx.x;
 
     if(idx < nbatch)
-    {
-        idx *= dist;
+        impose_hermitian_symmetry_interleaved_1_element(x, Nx, xstride, dist, Nxeven, idx);
+}
 
-        // The DC mode must be real-valued.
-        x[idx].y = 0.0;
+template <typename Tfloat>
+__host__ __device__ static void
+    impose_hermitian_symmetry_planar_1_element(Tfloat*      ximag,
+                                               const size_t Nx,
+                                               const size_t xstride,
+                                               const size_t dist,
+                                               const bool   Nxeven,
+                                               size_t       idx)
+{
+    idx *= dist;
 
-        if(Nxeven)
-        {
-            // Nyquist mode
-            auto pos = idx + (Nx / 2) * xstride;
-            x[pos].y = 0.0;
-        }
+    // The DC mode must be real-valued.
+    ximag[idx] = 0;
+
+    if(Nxeven)
+    {
+        // Nyquist mode
+        auto pos   = idx + (Nx / 2) * xstride;
+        ximag[pos] = 0;
     }
 }
 
@@ -315,24 +426,69 @@ __global__ static void __launch_bounds__(DATA_GEN_THREADS)
     auto idx = blockIdx.x * blockDim.x + threadIdx.x;
 
     if(idx < nbatch)
+        impose_hermitian_symmetry_planar_1_element(ximag, Nx, xstride, dist, Nxeven, idx);
+}
+
+// Kernels for imposing Hermitian symmetry on 2D
+// complex (interleaved/planar) data on the GPU.
+
+template <typename Tcomplex>
+__host__ __device__ static void
+    impose_hermitian_symmetry_interleaved_2_element(Tcomplex*    x,
+                                                    const size_t Nx,
+                                                    const size_t Ny,
+                                                    const size_t xstride,
+                                                    const size_t ystride,
+                                                    const size_t dist,
+                                                    const bool   Nxeven,
+                                                    const bool   Nyeven,
+                                                    size_t       idx,
+                                                    size_t       idy)
+{
+    idx *= dist;
+
+    auto pos  = idx + idy * ystride;
+    auto cpos = idx + ((Ny - idy) % Ny) * ystride;
+
+    auto val = x[pos];
+
+    // DC mode:
+    if(idy == 0)
+        val.y = 0.0;
+
+    // Axes need to be symmetrized:
+    if(idy > 0 && idy < (Ny + 1) / 2)
+        val.y = -val.y;
+
+    // y-Nyquist
+    if(Nyeven && idy == Ny / 2)
+        val.y = 0.0;
+
+    x[cpos] = val;
+
+    if(Nxeven)
     {
-        idx *= dist;
+        pos += (Nx / 2) * xstride;
+        cpos += (Nx / 2) * xstride;
 
-        // The DC mode must be real-valued.
-        ximag[idx] = 0;
+        val = x[pos];
 
-        if(Nxeven)
-        {
-            // Nyquist mode
-            auto pos   = idx + (Nx / 2) * xstride;
-            ximag[pos] = 0;
-        }
+        // DC mode:
+        if(idy == 0)
+            val.y = 0;
+
+        // Axes need to be symmetrized:
+        if(idy > 0 && idy < (Ny + 1) / 2)
+            val.y = -val.y;
+
+        // y-Nyquist
+        if(Nyeven && idy == Ny / 2)
+            val.y = 0;
+
+        x[cpos] = val;
     }
 }
 
-// Kernels for imposing Hermitian symmetry on 2D
-// complex (interleaved/planar) data on the GPU.
-
 template <typename Tcomplex>
 __global__ static void __launch_bounds__(DATA_GEN_THREADS* DATA_GEN_THREADS)
     impose_hermitian_symmetry_interleaved_2(Tcomplex*    x,
@@ -349,49 +505,77 @@ __global__ static void __launch_bounds__(DATA_GEN_THREADS* DATA_GEN_THREADS)
     const auto idy = blockIdx.x * blockDim.x + threadIdx.x;
 
     if(idy < (Ny / 2 + 1) && idx < nbatch)
-    {
-        idx *= dist;
+        impose_hermitian_symmetry_interleaved_2_element(x,
+                                                        Nx,
+                                                        Ny,
+                                                        xstride,
+                                                        ystride,
+                                                        dist,
+                                                        Nxeven,
+                                                        Nyeven,
+                                                        idx,
+                                                        idy);
+}
 
-        auto pos  = idx + idy * ystride;
-        auto cpos = idx + ((Ny - idy) % Ny) * ystride;
+template <typename Tfloat>
+__host__ __device__ static void
+    impose_hermitian_symmetry_planar_2_element(Tfloat*      xreal,
+                                               Tfloat*      ximag,
+                                               const size_t Nx,
+                                               const size_t Ny,
+                                               const size_t xstride,
+                                               const size_t ystride,
+                                               const size_t dist,
+                                               const bool   Nxeven,
+                                               const bool   Nyeven,
+                                               size_t       idx,
+                                               size_t       idy)
+{
+    idx *= dist;
 
-        auto val = x[pos];
+    auto pos  = idx + idy * ystride;
+    auto cpos = idx + ((Ny - idy) % Ny) * ystride;
 
-        // DC mode:
-        if(idy == 0)
-            val.y = 0.0;
+    auto valreal = xreal[pos];
+    auto valimag = ximag[pos];
 
-        // Axes need to be symmetrized:
-        if(idy > 0 && idy < (Ny + 1) / 2)
-            val.y = -val.y;
+    // DC mode:
+    if(idy == 0)
+        valimag = 0;
 
-        // y-Nyquist
-        if(Nyeven && idy == Ny / 2)
-            val.y = 0.0;
+    // Axes need to be symmetrized:
+    if(idy > 0 && idy < (Ny + 1) / 2)
+        valimag = -valimag;
 
-        x[cpos] = val;
+    // y-Nyquist
+    if(Nyeven && idy == Ny / 2)
+        valimag = 0;
 
-        if(Nxeven)
-        {
-            pos += (Nx / 2) * xstride;
-            cpos += (Nx / 2) * xstride;
+    xreal[cpos] = valreal;
+    ximag[cpos] = valimag;
 
-            val = x[pos];
+    if(Nxeven)
+    {
+        pos += (Nx / 2) * xstride;
+        cpos += (Nx / 2) * xstride;
 
-            // DC mode:
-            if(idy == 0)
-                val.y = 0;
+        valreal = xreal[pos];
+        valimag = ximag[pos];
 
-            // Axes need to be symmetrized:
-            if(idy > 0 && idy < (Ny + 1) / 2)
-                val.y = -val.y;
+        // DC mode:
+        if(idy == 0)
+            valimag = 0;
 
-            // y-Nyquist
-            if(Nyeven && idy == Ny / 2)
-                val.y = 0;
+        // Axes need to be symmetrized:
+        if(idy > 0 && idy < (Ny + 1) / 2)
+            valimag = -valimag;
 
-            x[cpos] = val;
-        }
+        // y-Nyquist
+        if(Nyeven && idy == Ny / 2)
+            valimag = 0;
+
+        xreal[cpos] = valreal;
+        ximag[cpos] = valimag;
     }
 }
 
@@ -412,108 +596,122 @@ __global__ static void __launch_bounds__(DATA_GEN_THREADS* DATA_GEN_THREADS)
     const auto idy = blockIdx.x * blockDim.x + threadIdx.x;
 
     if(idy < (Ny / 2 + 1) && idx < nbatch)
-    {
-        idx *= dist;
-
-        auto pos  = idx + idy * ystride;
-        auto cpos = idx + ((Ny - idy) % Ny) * ystride;
-
-        auto valreal = xreal[pos];
-        auto valimag = ximag[pos];
-
-        // DC mode:
-        if(idy == 0)
-            valimag = 0;
-
-        // Axes need to be symmetrized:
-        if(idy > 0 && idy < (Ny + 1) / 2)
-            valimag = -valimag;
+        impose_hermitian_symmetry_planar_2_element(xreal,
+                                                   ximag,
+                                                   Nx,
+                                                   Ny,
+                                                   xstride,
+                                                   ystride,
+                                                   dist,
+                                                   Nxeven,
+                                                   Nyeven,
+                                                   idx,
+                                                   idy);
+}
 
-        // y-Nyquist
-        if(Nyeven && idy == Ny / 2)
-            valimag = 0;
+// Kernels for imposing Hermitian symmetry on 3D
+// complex (interleaved/planar) data on the GPU.
 
-        xreal[cpos] = valreal;
-        ximag[cpos] = valimag;
+template <typename Tcomplex>
+__host__ __device__ static void
+    impose_hermitian_symmetry_interleaved_3_element(Tcomplex*    x,
+                                                    const size_t Nx,
+                                                    const size_t Ny,
+                                                    const size_t Nz,
+                                                    const size_t xstride,
+                                                    const size_t ystride,
+                                                    const size_t zstride,
+                                                    const size_t dist,
+                                                    const bool   Nxeven,
+                                                    const bool   Nyeven,
+                                                    const bool   Nzeven,
+                                                    size_t       idx,
+                                                    size_t       idy,
+                                                    size_t       idz)
+{
+    idx *= dist;
 
-        if(Nxeven)
-        {
-            pos += (Nx / 2) * xstride;
-            cpos += (Nx / 2) * xstride;
+    auto pos  = idx + idy * ystride + idz * zstride;
+    auto cpos = idx + ((Ny - idy) % Ny) * ystride + ((Nz - idz) % Nz) * zstride;
 
-            valreal = xreal[pos];
-            valimag = ximag[pos];
+    // Origin
+    if(idy == 0 && idz == 0)
+    {
+        x[pos].y = 0.0;
+    }
 
-            // DC mode:
-            if(idy == 0)
-                valimag = 0;
+    // y-Nyquist
+    if(Nyeven && idy == Ny / 2 && idz == 0)
+    {
+        x[pos].y = 0.0;
+    }
 
-            // Axes need to be symmetrized:
-            if(idy > 0 && idy < (Ny + 1) / 2)
-                valimag = -valimag;
+    // z-Nyquist
+    if(Nzeven && idz == Nz / 2 && idy == 0)
+    {
+        x[pos].y = 0.0;
+    }
 
-            // y-Nyquist
-            if(Nyeven && idy == Ny / 2)
-                valimag = 0;
+    // yz-Nyquist
+    if(Nyeven && Nzeven && idy == Ny / 2 && idz == Nz / 2)
+    {
+        x[pos].y = 0.0;
+    }
 
-            xreal[cpos] = valreal;
-            ximag[cpos] = valimag;
-        }
+    // z-axis
+    if(idy == 0 && idz > 0 && idz < (Nz + 1) / 2)
+    {
+        x[cpos].x = x[pos].x;
+        x[cpos].y = -x[pos].y;
     }
-}
 
-// Kernels for imposing Hermitian symmetry on 3D
-// complex (interleaved/planar) data on the GPU.
+    // y-Nyquist axis
+    if(Nyeven && idy == Ny / 2 && idz > 0 && idz < (Nz + 1) / 2)
+    {
+        x[cpos].x = x[pos].x;
+        x[cpos].y = -x[pos].y;
+    }
 
-template <typename Tcomplex>
-__global__ static void __launch_bounds__(DATA_GEN_THREADS* DATA_GEN_THREADS* DATA_GEN_THREADS)
-    impose_hermitian_symmetry_interleaved_3(Tcomplex*    x,
-                                            const size_t Nx,
-                                            const size_t Ny,
-                                            const size_t Nz,
-                                            const size_t xstride,
-                                            const size_t ystride,
-                                            const size_t zstride,
-                                            const size_t dist,
-                                            const size_t nbatch,
-                                            const bool   Nxeven,
-                                            const bool   Nyeven,
-                                            const bool   Nzeven)
-{
-    const auto idy = blockIdx.x * blockDim.x + threadIdx.x;
-    const auto idz = blockIdx.y * blockDim.y + threadIdx.y;
-    auto       idx = blockIdx.z * blockDim.z + threadIdx.z;
+    // y-axis
+    if(idy > 0 && idy < (Ny + 1) / 2 && idz == 0)
+    {
+        x[cpos].x = x[pos].x;
+        x[cpos].y = -x[pos].y;
+    }
 
-    if(idy < Ny && idz < Nz && idx < nbatch)
+    // z-Nyquist axis
+    if(Nzeven && idz == Nz / 2 && idy > 0 && idy < (Ny + 1) / 2)
     {
-        idx *= dist;
+        x[cpos].x = x[pos].x;
+        x[cpos].y = -x[pos].y;
+    }
 
-        auto pos  = idx + idy * ystride + idz * zstride;
-        auto cpos = idx + ((Ny - idy) % Ny) * ystride + ((Nz - idz) % Nz) * zstride;
+    // yz plane
+    if(idy > 0 && idy < (Ny + 1) / 2 && idz > 0 && idz < Nz)
+    {
+        x[cpos].x = x[pos].x;
+        x[cpos].y = -x[pos].y;
+    }
 
+    if(Nxeven)
+    {
+        pos += (Nx / 2) * xstride;
+        cpos += (Nx / 2) * xstride;
         // Origin
         if(idy == 0 && idz == 0)
-        {
             x[pos].y = 0.0;
-        }
 
         // y-Nyquist
         if(Nyeven && idy == Ny / 2 && idz == 0)
-        {
             x[pos].y = 0.0;
-        }
 
         // z-Nyquist
         if(Nzeven && idz == Nz / 2 && idy == 0)
-        {
             x[pos].y = 0.0;
-        }
 
         // yz-Nyquist
         if(Nyeven && Nzeven && idy == Ny / 2 && idz == Nz / 2)
-        {
             x[pos].y = 0.0;
-        }
 
         // z-axis
         if(idy == 0 && idz > 0 && idz < (Nz + 1) / 2)
@@ -549,115 +747,146 @@ __global__ static void __launch_bounds__(DATA_GEN_THREADS* DATA_GEN_THREADS* DAT
             x[cpos].x = x[pos].x;
             x[cpos].y = -x[pos].y;
         }
-
-        if(Nxeven)
-        {
-            pos += (Nx / 2) * xstride;
-            cpos += (Nx / 2) * xstride;
-            // Origin
-            if(idy == 0 && idz == 0)
-                x[pos].y = 0.0;
-
-            // y-Nyquist
-            if(Nyeven && idy == Ny / 2 && idz == 0)
-                x[pos].y = 0.0;
-
-            // z-Nyquist
-            if(Nzeven && idz == Nz / 2 && idy == 0)
-                x[pos].y = 0.0;
-
-            // yz-Nyquist
-            if(Nyeven && Nzeven && idy == Ny / 2 && idz == Nz / 2)
-                x[pos].y = 0.0;
-
-            // z-axis
-            if(idy == 0 && idz > 0 && idz < (Nz + 1) / 2)
-            {
-                x[cpos].x = x[pos].x;
-                x[cpos].y = -x[pos].y;
-            }
-
-            // y-Nyquist axis
-            if(Nyeven && idy == Ny / 2 && idz > 0 && idz < (Nz + 1) / 2)
-            {
-                x[cpos].x = x[pos].x;
-                x[cpos].y = -x[pos].y;
-            }
-
-            // y-axis
-            if(idy > 0 && idy < (Ny + 1) / 2 && idz == 0)
-            {
-                x[cpos].x = x[pos].x;
-                x[cpos].y = -x[pos].y;
-            }
-
-            // z-Nyquist axis
-            if(Nzeven && idz == Nz / 2 && idy > 0 && idy < (Ny + 1) / 2)
-            {
-                x[cpos].x = x[pos].x;
-                x[cpos].y = -x[pos].y;
-            }
-
-            // yz plane
-            if(idy > 0 && idy < (Ny + 1) / 2 && idz > 0 && idz < Nz)
-            {
-                x[cpos].x = x[pos].x;
-                x[cpos].y = -x[pos].y;
-            }
-        }
     }
 }
 
-template <typename Tfloat>
+template <typename Tcomplex>
 __global__ static void __launch_bounds__(DATA_GEN_THREADS* DATA_GEN_THREADS* DATA_GEN_THREADS)
-    impose_hermitian_symmetry_planar_3(Tfloat*      xreal,
-                                       Tfloat*      ximag,
-                                       const size_t Nx,
-                                       const size_t Ny,
-                                       const size_t Nz,
-                                       const size_t xstride,
-                                       const size_t ystride,
-                                       const size_t zstride,
-                                       const size_t dist,
-                                       const size_t nbatch,
-                                       const bool   Nxeven,
-                                       const bool   Nyeven,
-                                       const bool   Nzeven)
+    impose_hermitian_symmetry_interleaved_3(Tcomplex*    x,
+                                            const size_t Nx,
+                                            const size_t Ny,
+                                            const size_t Nz,
+                                            const size_t xstride,
+                                            const size_t ystride,
+                                            const size_t zstride,
+                                            const size_t dist,
+                                            const size_t nbatch,
+                                            const bool   Nxeven,
+                                            const bool   Nyeven,
+                                            const bool   Nzeven)
 {
     const auto idy = blockIdx.x * blockDim.x + threadIdx.x;
     const auto idz = blockIdx.y * blockDim.y + threadIdx.y;
     auto       idx = blockIdx.z * blockDim.z + threadIdx.z;
 
     if(idy < Ny && idz < Nz && idx < nbatch)
+        impose_hermitian_symmetry_interleaved_3_element(x,
+                                                        Nx,
+                                                        Ny,
+                                                        Nz,
+                                                        xstride,
+                                                        ystride,
+                                                        zstride,
+                                                        dist,
+                                                        Nxeven,
+                                                        Nyeven,
+                                                        Nzeven,
+                                                        idx,
+                                                        idy,
+                                                        idz);
+}
+
+template <typename Tfloat>
+__host__ __device__ static void
+    impose_hermitian_symmetry_planar_3_element(Tfloat*      xreal,
+                                               Tfloat*      ximag,
+                                               const size_t Nx,
+                                               const size_t Ny,
+                                               const size_t Nz,
+                                               const size_t xstride,
+                                               const size_t ystride,
+                                               const size_t zstride,
+                                               const size_t dist,
+                                               const bool   Nxeven,
+                                               const bool   Nyeven,
+                                               const bool   Nzeven,
+                                               size_t       idx,
+                                               size_t       idy,
+                                               size_t       idz)
+{
+    idx *= dist;
+
+    auto pos  = idx + idy * ystride + idz * zstride;
+    auto cpos = idx + ((Ny - idy) % Ny) * ystride + ((Nz - idz) % Nz) * zstride;
+
+    // Origin
+    if(idy == 0 && idz == 0)
+    {
+        ximag[pos] = 0;
+    }
+
+    // y-Nyquist
+    if(Nyeven && idy == Ny / 2 && idz == 0)
     {
-        idx *= dist;
+        ximag[pos] = 0;
+    }
 
-        auto pos  = idx + idy * ystride + idz * zstride;
-        auto cpos = idx + ((Ny - idy) % Ny) * ystride + ((Nz - idz) % Nz) * zstride;
+    // z-Nyquist
+    if(Nzeven && idz == Nz / 2 && idy == 0)
+    {
+        ximag[pos] = 0;
+    }
 
+    // yz-Nyquist
+    if(Nyeven && Nzeven && idy == Ny / 2 && idz == Nz / 2)
+    {
+        ximag[pos] = 0;
+    }
+
+    // z-axis
+    if(idy == 0 && idz > 0 && idz < (Nz + 1) / 2)
+    {
+        xreal[cpos] = xreal[pos];
+        ximag[cpos] = -ximag[pos];
+    }
+
+    // y-Nyquist axis
+    if(Nyeven && idy == Ny / 2 && idz > 0 && idz < (Nz + 1) / 2)
+    {
+        xreal[cpos] = xreal[pos];
+        ximag[cpos] = -ximag[pos];
+    }
+
+    // y-axis
+    if(idy > 0 && idy < (Ny + 1) / 2 && idz == 0)
+    {
+        xreal[cpos] = xreal[pos];
+        ximag[cpos] = -ximag[pos];
+    }
+
+    // z-Nyquist axis
+    if(Nzeven && idz == Nz / 2 && idy > 0 && idy < (Ny + 1) / 2)
+    {
+        xreal[cpos] = xreal[pos];
+        ximag[cpos] = -ximag[pos];
+    }
+
+    // yz plane
+    if(idy > 0 && idy < (Ny + 1) / 2 && idz > 0 && idz < Nz)
+    {
+        xreal[cpos] = xreal[pos];
+        ximag[cpos] = -ximag[pos];
+    }
+
+    if(Nxeven)
+    {
+        pos += (Nx / 2) * xstride;
+        cpos += (Nx / 2) * xstride;
         // Origin
         if(idy == 0 && idz == 0)
-        {
             ximag[pos] = 0;
-        }
 
         // y-Nyquist
         if(Nyeven && idy == Ny / 2 && idz == 0)
-        {
             ximag[pos] = 0;
-        }
 
         // z-Nyquist
         if(Nzeven && idz == Nz / 2 && idy == 0)
-        {
             ximag[pos] = 0;
-        }
 
         // yz-Nyquist
         if(Nyeven && Nzeven && idy == Ny / 2 && idz == Nz / 2)
-        {
             ximag[pos] = 0;
-        }
 
         // z-axis
         if(idy == 0 && idz > 0 && idz < (Nz + 1) / 2)
@@ -693,77 +922,59 @@ __global__ static void __launch_bounds__(DATA_GEN_THREADS* DATA_GEN_THREADS* DAT
             xreal[cpos] = xreal[pos];
             ximag[cpos] = -ximag[pos];
         }
-
-        if(Nxeven)
-        {
-            pos += (Nx / 2) * xstride;
-            cpos += (Nx / 2) * xstride;
-            // Origin
-            if(idy == 0 && idz == 0)
-                ximag[pos] = 0;
-
-            // y-Nyquist
-            if(Nyeven && idy == Ny / 2 && idz == 0)
-                ximag[pos] = 0;
-
-            // z-Nyquist
-            if(Nzeven && idz == Nz / 2 && idy == 0)
-                ximag[pos] = 0;
-
-            // yz-Nyquist
-            if(Nyeven && Nzeven && idy == Ny / 2 && idz == Nz / 2)
-                ximag[pos] = 0;
-
-            // z-axis
-            if(idy == 0 && idz > 0 && idz < (Nz + 1) / 2)
-            {
-                xreal[cpos] = xreal[pos];
-                ximag[cpos] = -ximag[pos];
-            }
-
-            // y-Nyquist axis
-            if(Nyeven && idy == Ny / 2 && idz > 0 && idz < (Nz + 1) / 2)
-            {
-                xreal[cpos] = xreal[pos];
-                ximag[cpos] = -ximag[pos];
-            }
-
-            // y-axis
-            if(idy > 0 && idy < (Ny + 1) / 2 && idz == 0)
-            {
-                xreal[cpos] = xreal[pos];
-                ximag[cpos] = -ximag[pos];
-            }
-
-            // z-Nyquist axis
-            if(Nzeven && idz == Nz / 2 && idy > 0 && idy < (Ny + 1) / 2)
-            {
-                xreal[cpos] = xreal[pos];
-                ximag[cpos] = -ximag[pos];
-            }
-
-            // yz plane
-            if(idy > 0 && idy < (Ny + 1) / 2 && idz > 0 && idz < Nz)
-            {
-                xreal[cpos] = xreal[pos];
-                ximag[cpos] = -ximag[pos];
-            }
-        }
     }
 }
 
+template <typename Tfloat>
+__global__ static void __launch_bounds__(DATA_GEN_THREADS* DATA_GEN_THREADS* DATA_GEN_THREADS)
+    impose_hermitian_symmetry_planar_3(Tfloat*      xreal,
+                                       Tfloat*      ximag,
+                                       const size_t Nx,
+                                       const size_t Ny,
+                                       const size_t Nz,
+                                       const size_t xstride,
+                                       const size_t ystride,
+                                       const size_t zstride,
+                                       const size_t dist,
+                                       const size_t nbatch,
+                                       const bool   Nxeven,
+                                       const bool   Nyeven,
+                                       const bool   Nzeven)
+{
+    const auto idy = blockIdx.x * blockDim.x + threadIdx.x;
+    const auto idz = blockIdx.y * blockDim.y + threadIdx.y;
+    auto       idx = blockIdx.z * blockDim.z + threadIdx.z;
+
+    if(idy < Ny && idz < Nz && idx < nbatch)
+        impose_hermitian_symmetry_planar_3_element(xreal,
+                                                   ximag,
+                                                   Nx,
+                                                   Ny,
+                                                   Nz,
+                                                   xstride,
+                                                   ystride,
+                                                   zstride,
+                                                   dist,
+                                                   Nxeven,
+                                                   Nyeven,
+                                                   Nzeven,
+                                                   idx,
+                                                   idy,
+                                                   idz);
+}
+
 template <typename Tint, typename Treal>
 inline void generate_interleaved_data(const Tint&            whole_length,
                                       const size_t           idist,
                                       const size_t           isize,
                                       const Tint&            istride,
+                                      const uint64_t         seed,
                                       rocfft_complex<Treal>* input_data)
 {
     auto blockSize       = DATA_GEN_THREADS;
     auto numBlocks_setup = DivRoundingUp<size_t>(isize, blockSize);
 
     auto input_length = get_input_val(whole_length);
-    auto zero_length  = make_zero_length(input_length);
     auto input_stride = get_input_val(istride);
 
     hipLaunchKernelGGL(
@@ -773,26 +984,26 @@ inline void generate_interleaved_data(const Tint&            whole_length,
         0, // sharedMemBytes
         0, // stream
         input_length,
-        zero_length,
         idist,
         isize,
         input_stride,
+        seed,
         input_data);
 }
 
 template <typename Tint, typename Treal>
-inline void generate_planar_data(const Tint&  whole_length,
-                                 const size_t idist,
-                                 const size_t isize,
-                                 const Tint&  istride,
-                                 Treal*       real_data,
-                                 Treal*       imag_data)
+inline void generate_planar_data(const Tint&    whole_length,
+                                 const size_t   idist,
+                                 const size_t   isize,
+                                 const Tint&    istride,
+                                 const uint64_t seed,
+                                 Treal*         real_data,
+                                 Treal*         imag_data)
 {
     auto blockSize       = DATA_GEN_THREADS;
     auto numBlocks_setup = DivRoundingUp<size_t>(isize, blockSize);
 
     auto input_length = get_input_val(whole_length);
-    auto zero_length  = make_zero_length(input_length);
     auto input_stride = get_input_val(istride);
 
     hipLaunchKernelGGL(HIP_KERNEL_NAME(generate_planar_data_kernel<decltype(input_length), Treal>),
@@ -801,26 +1012,26 @@ inline void generate_planar_data(const Tint&  whole_length,
                        0, // sharedMemBytes
                        0, // stream
                        input_length,
-                       zero_length,
                        idist,
                        isize,
                        input_stride,
+                       seed,
                        real_data,
                        imag_data);
 }
 
 template <typename Tint, typename Treal>
-inline void generate_real_data(const Tint&  whole_length,
-                               const size_t idist,
-                               const size_t isize,
-                               const Tint&  istride,
-                               Treal*       input_data)
+inline void generate_real_data(const Tint&    whole_length,
+                               const size_t   idist,
+                               const size_t   isize,
+                               const Tint&    istride,
+                               const uint64_t seed,
+                               Treal*         input_data)
 {
     auto blockSize       = DATA_GEN_THREADS;
     auto numBlocks_setup = DivRoundingUp<size_t>(isize, blockSize);
 
     auto input_length = get_input_val(whole_length);
-    auto zero_length  = make_zero_length(input_length);
     auto input_stride = get_input_val(istride);
 
     hipLaunchKernelGGL(HIP_KERNEL_NAME(generate_real_data_kernel<decltype(input_length), Treal>),
@@ -829,13 +1040,72 @@ inline void generate_real_data(const Tint&  whole_length,
                        0, // sharedMemBytes
                        0, // stream
                        input_length,
-                       zero_length,
                        idist,
                        isize,
                        input_stride,
+                       seed,
                        input_data);
 }
 
+// Host versions of the generators, producing the same values as
+// the device kernels.  Each element is independent, so these
+// parallelize and vectorize freely.
+template <typename Tint, typename Treal>
+inline void generate_interleaved_data_host(const Tint&            whole_length,
+                                           const size_t           idist,
+                                           const size_t           isize,
+                                           const Tint&            istride,
+                                           const uint64_t         seed,
+                                           rocfft_complex<Treal>* input_data)
+{
+    auto input_length = get_input_val(whole_length);
+    auto input_stride = get_input_val(istride);
+
+#ifdef BUILD_CLIENTS_TESTS_OPENMP
+#pragma omp parallel for simd
+#endif
+    for(size_t i = 0; i < isize; ++i)
+        generate_interleaved_data_element(input_length, idist, input_stride, seed, i, input_data);
+}
+
+template <typename Tint, typename Treal>
+inline void generate_planar_data_host(const Tint&    whole_length,
+                                      const size_t   idist,
+                                      const size_t   isize,
+                                      const Tint&    istride,
+                                      const uint64_t seed,
+                                      Treal*         real_data,
+                                      Treal*         imag_data)
+{
+    auto input_length = get_input_val(whole_length);
+    auto input_stride = get_input_val(istride);
+
+#ifdef BUILD_CLIENTS_TESTS_OPENMP
+#pragma omp parallel for simd
+#endif
+    for(size_t i = 0; i < isize; ++i)
+        generate_planar_data_element(
+            input_length, idist, input_stride, seed, i, real_data, imag_data);
+}
+
+template <typename Tint, typename Treal>
+inline void generate_real_data_host(const Tint&    whole_length,
+                                    const size_t   idist,
+                                    const size_t   isize,
+                                    const Tint&    istride,
+                                    const uint64_t seed,
+                                    Treal*         input_data)
+{
+    auto input_length = get_input_val(whole_length);
+    auto input_stride = get_input_val(istride);
+
+#ifdef BUILD_CLIENTS_TESTS_OPENMP
+#pragma omp parallel for simd
+#endif
+    for(size_t i = 0; i < isize; ++i)
+        generate_real_data_element(input_length, idist, input_stride, seed, i, input_data);
+}
+
 template <typename Tcomplex>
 void impose_hermitian_symmetry_interleaved(const std::vector<size_t>& length,
                                            const std::vector<size_t>& ilength,
@@ -1010,4 +1280,138 @@ void impose_hermitian_symmetry_planar(const std::vector<size_t>& length,
     }
 }
 
+// Host versions of the above.  The device kernels never have two
+// threads touch the same element, so doing the same work in any
+// order on the host gives identical results.
+template <typename Tcomplex>
+void impose_hermitian_symmetry_interleaved_host(const std::vector<size_t>& length,
+                                                const std::vector<size_t>& stride,
+                                                size_t                     dist,
+                                                size_t                     batch,
+                                                Tcomplex*                  input_data)
+{
+    switch(length.size())
+    {
+    case 1:
+    {
+        for(size_t b = 0; b < batch; ++b)
+            impose_hermitian_symmetry_interleaved_1_element(
+                input_data, length[0], stride[0], dist, length[0] % 2 == 0, b);
+        break;
+    }
+    case 2:
+    {
+#ifdef BUILD_CLIENTS_TESTS_OPENMP
+#pragma omp parallel for
+#endif
+        for(size_t b = 0; b < batch; ++b)
+            for(size_t y = 0; y < length[0] / 2 + 1; ++y)
+                impose_hermitian_symmetry_interleaved_2_element(input_data,
+                                                                length[1],
+                                                                length[0],
+                                                                stride[1],
+                                                                stride[0],
+                                                                dist,
+                                                                length[1] % 2 == 0,
+                                                                length[0] % 2 == 0,
+                                                                b,
+                                                                y);
+        break;
+    }
+    case 3:
+    {
+#ifdef BUILD_CLIENTS_TESTS_OPENMP
+#pragma omp parallel for
+#endif
+        for(size_t b = 0; b < batch; ++b)
+            for(size_t z = 0; z < length[1]; ++z)
+                for(size_t y = 0; y < length[0]; ++y)
+                    impose_hermitian_symmetry_interleaved_3_element(input_data,
+                                                                    length[2],
+                                                                    length[0],
+                                                                    length[1],
+                                                                    stride[2],
+                                                                    stride[0],
+                                                                    stride[1],
+                                                                    dist,
+                                                                    length[2] % 2 == 0,
+                                                                    length[0] % 2 == 0,
+                                                                    length[1] % 2 == 0,
+                                                                    b,
+                                                                    y,
+                                                                    z);
+        break;
+    }
+    default:
+        throw std::runtime_error("Invalid dimension for impose_hermitian_symmetry");
+    }
+}
+
+template <typename Tfloat>
+void impose_hermitian_symmetry_planar_host(const std::vector<size_t>& length,
+                                           const std::vector<size_t>& stride,
+                                           size_t                     dist,
+                                           size_t                     batch,
+                                           Tfloat*                    input_data_real,
+                                           Tfloat*                    input_data_imag)
+{
+    switch(length.size())
+    {
+    case 1:
+    {
+        for(size_t b = 0; b < batch; ++b)
+            impose_hermitian_symmetry_planar_1_element(
+                input_data_imag, length[0], stride[0], dist, length[0] % 2 == 0, b);
+        break;
+    }
+    case 2:
+    {
+#ifdef BUILD_CLIENTS_TESTS_OPENMP
+#pragma omp parallel for
+#endif
+        for(size_t b = 0; b < batch; ++b)
+            for(size_t y = 0; y < length[0] / 2 + 1; ++y)
+                impose_hermitian_symmetry_planar_2_element(input_data_real,
+                                                           input_data_imag,
+                                                           length[1],
+                                                           length[0],
+                                                           stride[1],
+                                                           stride[0],
+                                                           dist,
+                                                           length[1] % 2 == 0,
+                                                           length[0] % 2 == 0,
+                                                           b,
+                                                           y);
+        break;
+    }
+    case 3:
+    {
+#ifdef BUILD_CLIENTS_TESTS_OPENMP
+#pragma omp parallel for
+#endif
+        for(size_t b = 0; b < batch; ++b)
+            for(size_t z = 0; z < length[1]; ++z)
+                for(size_t y = 0; y < length[0]; ++y)
+                    impose_hermitian_symmetry_planar_3_element(input_data_real,
+                                                               input_data_imag,
+                                                               length[2],
+                                                               length[0],
+                                                               length[1],
+                                                               stride[2],
+                                                               stride[0],
+                                                               stride[1],
+                                                               dist,
+                                                               length[2] % 2 == 0,
+                                                               length[0] % 2 == 0,
+                                                               length[1] % 2 == 0,
+                                                               b,
+                                                               y,
+                                                               z);
+        break;
+    }
+    default:
+        throw std::runtime_error("Invalid dimension for impose_hermitian_symmetry");
+    }
+}
+
 #endif // DATA_GEN_H
@@ -148,9 +148,15 @@ size_t count_iters(const std::tuple<T1, T1, T1>& i)
 }
 
 // Given an array type and transform length, strides, etc, load random floats in [0,1]
-// into the input array of floats/doubles or complex floats/doubles gpu buffers.
-template <typename Tfloat, typename Tint1>
-inline void set_input(std::vector<gpubuf>&       input,
+// into the input array of floats/doubles or complex floats/doubles buffers.
+//
+// gpubufs are filled on the device, any other buffers are host
+// memory and are filled on the host.  Both produce the same values,
+// which depend only on the logical index of each element, so the
+// input for a reference transform can be generated on the host in
+// any layout without copying it back from the device.
+template <typename Tfloat, typename Tbuffer, typename Tint1>
+inline void set_input(std::vector<Tbuffer>&      input,
                       const fft_array_type       itype,
                       const std::vector<size_t>& length,
                       const std::vector<size_t>& ilength,
@@ -158,9 +164,11 @@ inline void set_input(std::vector<gpubuf>&       input,
                       const Tint1&               whole_length,
                       const Tint1&               istride,
                       const size_t               idist,
-                      const size_t               nbatch)
+                      const size_t               nbatch,
+                      const std::vector<size_t>& ioffset)
 {
-    auto isize = count_iters(whole_length) * nbatch;
+    auto           isize     = count_iters(whole_length) * nbatch;
+    constexpr bool on_device = std::is_same<Tbuffer, gpubuf>::value;
 
     switch(itype)
     {
@@ -168,14 +176,22 @@ inline void set_input(std::vector<gpubuf>&       input,
     case fft_array_type_hermitian_interleaved:
     {
 
-        auto ibuffer = (rocfft_complex<Tfloat>*)input[0].data();
-        generate_interleaved_data(whole_length, idist, isize, istride, ibuffer);
+        auto ibuffer = (rocfft_complex<Tfloat>*)input[0].data() + ioffset[0];
+        if constexpr(on_device)
+            generate_interleaved_data(whole_length, idist, isize, istride, DATA_GEN_SEED, ibuffer);
+        else
+            generate_interleaved_data_host(
+                whole_length, idist, isize, istride, DATA_GEN_SEED, ibuffer);
 
         if(itype == fft_array_type_hermitian_interleaved)
         {
-            auto ibuffer_2 = (rocfft_complex<Tfloat>*)input[0].data();
-            impose_hermitian_symmetry_interleaved(
-                length, ilength, stride, idist, nbatch, ibuffer_2);
+            auto ibuffer_2 = (rocfft_complex<Tfloat>*)input[0].data() + ioffset[0];
+            if constexpr(on_device)
+                impose_hermitian_symmetry_interleaved(
+                    length, ilength, stride, idist, nbatch, ibuffer_2);
+            else
+                impose_hermitian_symmetry_interleaved_host(
+                    length, stride, idist, nbatch, ibuffer_2);
         }
 
         break;
@@ -183,22 +199,36 @@ inline void set_input(std::vector<gpubuf>&       input,
     case fft_array_type_complex_planar:
     case fft_array_type_hermitian_planar:
     {
-        auto ibuffer_real = (Tfloat*)input[0].data();
-        auto ibuffer_imag = (Tfloat*)input[1].data();
+        auto ibuffer_real = (Tfloat*)input[0].data() + ioffset[0];
+        auto ibuffer_imag = (Tfloat*)input[1].data() + ioffset[1];
 
-        generate_planar_data(whole_length, idist, isize, istride, ibuffer_real, ibuffer_imag);
+        if constexpr(on_device)
+            generate_planar_data(
+                whole_length, idist, isize, istride, DATA_GEN_SEED, ibuffer_real, ibuffer_imag);
+        else
+            generate_planar_data_host(
+                whole_length, idist, isize, istride, DATA_GEN_SEED, ibuffer_real, ibuffer_imag);
 
         if(itype == fft_array_type_hermitian_planar)
-            impose_hermitian_symmetry_planar(
-                length, ilength, stride, idist, nbatch, ibuffer_real, ibuffer_imag);
+        {
+            if constexpr(on_device)
+                impose_hermitian_symmetry_planar(
+                    length, ilength, stride, idist, nbatch, ibuffer_real, ibuffer_imag);
+            else
+                impose_hermitian_symmetry_planar_host(
+                    length, stride, idist, nbatch, ibuffer_real, ibuffer_imag);
+        }
 
         break;
     }
     case fft_array_type_real:
     {
-        auto ibuffer = (Tfloat*)input[0].data();
+        auto ibuffer = (Tfloat*)input[0].data() + ioffset[0];
 
-        generate_real_data(whole_length, idist, isize, istride, ibuffer);
+        if constexpr(on_device)
+            generate_real_data(whole_length, idist, isize, istride, DATA_GEN_SEED, ibuffer);
+        else
+            generate_real_data_host(whole_length, idist, isize, istride, DATA_GEN_SEED, ibuffer);
 
         break;
     }
@@ -208,20 +238,21 @@ inline void set_input(std::vector<gpubuf>&       input,
 }
 
 // unroll set_input for dimension 1, 2, 3
-template <typename Tfloat>
-inline void set_input(std::vector<gpubuf>&       input,
+template <typename Tfloat, typename Tbuffer>
+inline void set_input(std::vector<Tbuffer>&      input,
                       const fft_array_type       itype,
                       const std::vector<size_t>& length,
                       const std::vector<size_t>& ilength,
                       const std::vector<size_t>& istride,
                       const size_t               idist,
-                      const size_t               nbatch)
+                      const size_t               nbatch,
+                      const std::vector<size_t>& ioffset)
 {
     switch(length.size())
     {
     case 1:
         set_input<Tfloat>(
-            input, itype, length, ilength, istride, ilength[0], istride[0], idist, nbatch);
+            input, itype, length, ilength, istride, ilength[0], istride[0], idist, nbatch, ioffset);
         break;
     case 2:
         set_input<Tfloat>(input,
@@ -232,7 +263,8 @@ inline void set_input(std::vector<gpubuf>&       input,
                           std::make_tuple(ilength[0], ilength[1]),
                           std::make_tuple(istride[0], istride[1]),
                           idist,
-                          nbatch);
+                          nbatch,
+                          ioffset);
         break;
     case 3:
         set_input<Tfloat>(input,
@@ -243,7 +275,8 @@ inline void set_input(std::vector<gpubuf>&       input,
                           std::make_tuple(ilength[0], ilength[1], ilength[2]),
                           std::make_tuple(istride[0], istride[1], istride[2]),
                           idist,
-                          nbatch);
+                          nbatch,
+                          ioffset);
         break;
     default:
         abort();
@@ -1229,18 +1262,20 @@ public:
     }
 
     // Given a data type and dimensions, fill the buffer, imposing Hermitian symmetry if necessary.
-    inline void compute_input(std::vector<gpubuf>& input)
+    // The buffers may be on the device (gpubuf) or host.
+    template <typename Tbuffer>
+    inline void compute_input(std::vector<Tbuffer>& input)
     {
         switch(precision)
         {
         case fft_precision_half:
-            set_input<_Float16>(input, itype, length, ilength(), istride, idist, nbatch);
+            set_input<_Float16>(input, itype, length, ilength(), istride, idist, nbatch, ioffset);
             break;
         case fft_precision_double:
-            set_input<double>(input, itype, length, ilength(), istride, idist, nbatch);
+            set_input<double>(input, itype, length, ilength(), istride, idist, nbatch, ioffset);
             break;
         case fft_precision_single:
-            set_input<float>(input, itype, length, ilength(), istride, idist, nbatch);
+            set_input<float>(input, itype, length, ilength(), istride, idist, nbatch, ioffset);
             break;
         }
     }
@@ -2165,29 +2200,271 @@ inline void copy_buffers(const std::vector<std::vector<char, Tallocator1>>& inpu
     }
 }
 
-// Compute the L-infinity and L-2 distance between two buffers with strides istride and
-// length idist between batches to a buffer with strides ostride and length odist between
-// batches.  Both buffers are of complex type.
-
 struct VectorNorms
 {
     double l_2 = 0.0, l_inf = 0.0;
 };
 
+// The distance and norm functions below have two implementations.
+// The strided ones walk an arbitrary multi-index one element at a
+// time.  If the innermost dimension has unit stride, the data is
+// instead reduced in blocks of elements that are adjacent in memory,
+// using SIMD reductions within a block and compensated summation
+// across blocks.
+
+// Number of elements reduced with a plain SIMD sum before the
+// partial sum is folded into a compensated accumulator.
+static const size_t NORM_BLOCK_SIZE = 4096;
+
+// Neumaier's variant of Kahan summation, so that the L2 sum over a
+// large array doesn't lose precision as it grows.
+struct compensated_sum
+{
+    double sum          = 0.0;
+    double compensation = 0.0;
+
+    void add(const double x)
+    {
+        const double t = sum + x;
+        if(std::abs(sum) >= std::abs(x))
+            compensation += (sum - t) + x;
+        else
+            compensation += (x - t) + sum;
+        sum = t;
+    }
+
+    double value() const
+    {
+        return sum + compensation;
+    }
+};
+
+// Per-thread state for a blocked reduction.
+struct blocked_norms
+{
+    compensated_sum                        l2;
+    double                                 linf = 0.0;
+    std::vector<std::pair<size_t, size_t>> linf_failures;
+};
+
+// Return the number of row-major elements, starting from the
+// beginning of a row, that are adjacent in memory.  Returns 0 if the
+// innermost stride isn't 1.
+template <typename T1, typename T2>
+size_t contiguous_run_length(const T1& length, const T2& stride)
+{
+    return static_cast<size_t>(stride) == 1 ? length : 0;
+}
+
+template <typename T1, typename T2>
+size_t contiguous_run_length(const std::tuple<T1, T1>& length, const std::tuple<T2, T2>& stride)
+{
+    if(static_cast<size_t>(std::get<1>(stride)) != 1)
+        return 0;
+    if(static_cast<size_t>(std::get<0>(stride)) == static_cast<size_t>(std::get<1>(length)))
+        return count_iters(length);
+    return std::get<1>(length);
+}
+
+template <typename T1, typename T2>
+size_t contiguous_run_length(const std::tuple<T1, T1, T1>& length,
+                             const std::tuple<T2, T2, T2>& stride)
+{
+    if(static_cast<size_t>(std::get<2>(stride)) != 1)
+        return 0;
+    size_t run = std::get<2>(length);
+    if(static_cast<size_t>(std::get<1>(stride)) != run)
+        return run;
+    run *= std::get<1>(length);
+    if(static_cast<size_t>(std::get<0>(stride)) != run)
+        return run;
+    return run * std::get<0>(length);
+}
+
+// Return the memory offset of the i-th element in row-major order.
+template <typename T1, typename T2>
+size_t row_major_offset([[maybe_unused]] const T1& length, const T2& stride, const size_t i)
+{
+    return i * stride;
+}
+
+template <typename T1, typename T2>
+size_t row_major_offset(const std::tuple<T1, T1>& length,
+                        const std::tuple<T2, T2>& stride,
+                        const size_t              i)
+{
+    return (i / std::get<1>(length)) * std::get<0>(stride)
+           + (i % std::get<1>(length)) * std::get<1>(stride);
+}
+
+template <typename T1, typename T2>
+size_t row_major_offset(const std::tuple<T1, T1, T1>& length,
+                        const std::tuple<T2, T2, T2>& stride,
+                        const size_t                  i)
+{
+    const size_t i2 = i % std::get<2>(length);
+    const size_t i1 = (i / std::get<2>(length)) % std::get<1>(length);
+    const size_t i0 = i / std::get<2>(length) / std::get<1>(length);
+    return i0 * std::get<0>(stride) + i1 * std::get<1>(stride) + i2 * std::get<2>(stride);
+}
+
+// Visit nbatch arrays of dimension whole_length, whose first run
+// elements of each row are adjacent in both the input and the output
+// layout, as blocks of at most NORM_BLOCK_SIZE elements.  The blocks
+// are split evenly between threads in memory order, so that each
+// thread streams once through its share of the data.
+//
+// visit(state, b, idx, odx, n) is called for each block of n
+// elements starting at offsets idx, odx of batch b.  Returns the
+// per-thread states for the caller to combine.
+template <typename Tstate, typename Tint1, typename Tint2, typename Tint3, typename Tvisit>
+std::vector<Tstate> reduce_contiguous_blocks(const Tint1& whole_length,
+                                             const size_t nbatch,
+                                             const Tint2& istride,
+                                             const size_t idist,
+                                             const Tint3& ostride,
+                                             const size_t odist,
+                                             const size_t run,
+                                             Tvisit&&     visit)
+{
+    const size_t total          = count_iters(whole_length);
+    const size_t runs           = run ? total / run : 0;
+    const size_t blocks_per_run = (run + NORM_BLOCK_SIZE - 1) / NORM_BLOCK_SIZE;
+    const size_t nblocks        = nbatch * runs * blocks_per_run;
+    if(nblocks == 0)
+        return {};
+
+    auto partitions = partition_base(nblocks, compute_partition_count(total * nbatch));
+
+    std::vector<Tstate> states(partitions.size());
+#ifdef BUILD_CLIENTS_TESTS_OPENMP
+#pragma omp parallel for num_threads(partitions.size())
+#endif
+    for(size_t part = 0; part < partitions.size(); ++part)
+    {
+        for(size_t block = partitions[part].first; block < partitions[part].second; ++block)
+        {
+            const size_t k    = block % blocks_per_run;
+            const size_t r    = (block / blocks_per_run) % runs;
+            const size_t b    = block / blocks_per_run / runs;
+            const size_t elem = r * run + k * NORM_BLOCK_SIZE;
+            const size_t n    = std::min(NORM_BLOCK_SIZE, run - k * NORM_BLOCK_SIZE);
+            visit(states[part],
+                  b,
+                  b * idist + row_major_offset(whole_length, istride, elem),
+                  b * odist + row_major_offset(whole_length, ostride, elem),
+                  n);
+        }
+    }
+    return states;
+}
+
+// Combine the per-thread results of a blocked reduction.
+inline VectorNorms combine_blocked_norms(std::vector<blocked_norms>&             states,
+                                         std::vector<std::pair<size_t, size_t>>& linf_failures)
+{
+    compensated_sum l2;
+    double          linf = 0.0;
+    for(auto& state : states)
+    {
+        l2.add(state.l2.sum);
+        l2.add(state.l2.compensation);
+        linf = std::max(state.linf, linf);
+        linf_failures.insert(
+            linf_failures.end(), state.linf_failures.begin(), state.linf_failures.end());
+    }
+    // A NaN anywhere makes the L2 sum NaN, but max reductions can
+    // drop it.  Make sure the L-infinity norm reports it too.
+    if(std::isnan(l2.value()))
+        linf = l2.value();
+    return {.l_2 = sqrt(l2.value()), .l_inf = linf};
+}
+
+// Fold the sums for one block into a thread's state.
+inline void add_block_norms(blocked_norms& state, const double l2, const double linf)
+{
+    state.l2.add(l2);
+    state.linf = std::max(linf, state.linf);
+}
+
+// Accumulate the distance between n values of input and output,
+// spaced istep and ostep apart.  Each logical element of batch b at
+// offset idx is made of values_per_elem consecutive values.
+template <size_t istep, size_t ostep, size_t values_per_elem, typename Tin, typename Tout>
+inline void distance_block(const Tin*     input,
+                           const Tout*    output,
+                           const size_t   n,
+                           const double   output_scalar,
+                           const double   linf_cutoff,
+                           const size_t   b,
+                           const size_t   idx,
+                           blocked_norms& state)
+{
+    double l2   = 0.0;
+    double linf = 0.0;
+#ifdef BUILD_CLIENTS_TESTS_OPENMP
+#pragma omp simd reduction(+ : l2) reduction(max : linf)
+#endif
+    for(size_t i = 0; i < n; ++i)
+    {
+        const double diff = std::abs(output[i * ostep] * output_scalar
+                                     - static_cast<double>(input[i * istep]));
+        l2 += diff * diff;
+        linf = std::max(diff, linf);
+    }
+    add_block_norms(state, l2, linf);
+
+    // only go back over the block to find the failing elements if
+    // there are any
+    if(!(linf <= linf_cutoff))
+    {
+        for(size_t i = 0; i < n; ++i)
+        {
+            const double diff = std::abs(output[i * ostep] * output_scalar
+                                         - static_cast<double>(input[i * istep]));
+            if(!(diff <= linf_cutoff))
+                state.linf_failures.emplace_back(b, idx + i / values_per_elem);
+        }
+    }
+}
+
+// Accumulate the norm of n values of input, spaced istep apart.
+template <size_t istep, typename Tin>
+inline void norm_block(const Tin* input, const size_t n, blocked_norms& state)
+{
+    double l2   = 0.0;
+    double linf = 0.0;
+#ifdef BUILD_CLIENTS_TESTS_OPENMP
+#pragma omp simd reduction(+ : l2) reduction(max : linf)
+#endif
+    for(size_t i = 0; i < n; ++i)
+    {
+        const double val = std::abs(static_cast<double>(input[i * istep]));
+        l2 += val * val;
+        linf = std::max(val, linf);
+    }
+    add_block_norms(state, l2, linf);
+}
+
+// Compute the L-infinity and L-2 distance between two buffers with strides istride and
+// length idist between batches to a buffer with strides ostride and length odist between
+// batches.  Both buffers are of complex type.
+
 template <typename Tcomplex, typename Tint1, typename Tint2, typename Tint3>
-inline VectorNorms distance_1to1_complex(const Tcomplex*                         input,
-                                         const Tcomplex*                         output,
-                                         const Tint1&                            whole_length,
-                                         const size_t                            nbatch,
-                                         const Tint2&                            istride,
-                                         const size_t                            idist,
-                                         const Tint3&                            ostride,
-                                         const size_t                            odist,
-                                         std::vector<std::pair<size_t, size_t>>& linf_failures,
-                                         const double                            linf_cutoff,
-                                         const std::vector<size_t>&              ioffset,
-                                         const std::vector<size_t>&              ooffset,
-                                         const double output_scalar = 1.0)
+inline VectorNorms
+    distance_1to1_complex_strided(const Tcomplex*                         input,
+                                  const Tcomplex*                         output,
+                                  const Tint1&                            whole_length,
+                                  const size_t                            nbatch,
+                                  const Tint2&                            istride,
+                                  const size_t                            idist,
+                                  const Tint3&                            ostride,
+                                  const size_t                            odist,
+                                  std::vector<std::pair<size_t, size_t>>& linf_failures,
+                                  const double                            linf_cutoff,
+                                  const std::vector<size_t>&              ioffset,
+                                  const std::vector<size_t>&              ooffset,
+                                  const double                            output_scalar = 1.0)
 {
     double linf = 0.0;
     double l2   = 0.0;
@@ -2246,23 +2523,76 @@ inline VectorNorms distance_1to1_complex(const Tcomplex*
     return {.l_2 = sqrt(l2), .l_inf = linf};
 }
 
+// Compute the L-infinity and L-2 distance between two buffers of complex type, using the
+// blocked fast path if both have unit innermost stride.
+template <typename Tfloat, typename Tint1, typename Tint2, typename Tint3>
+inline VectorNorms distance_1to1_complex(const rocfft_complex<Tfloat>*           input,
+                                         const rocfft_complex<Tfloat>*           output,
+                                         const Tint1&                            whole_length,
+                                         const size_t                            nbatch,
+                                         const Tint2&                            istride,
+                                         const size_t                            idist,
+                                         const Tint3&                            ostride,
+                                         const size_t                            odist,
+                                         std::vector<std::pair<size_t, size_t>>& linf_failures,
+                                         const double                            linf_cutoff,
+                                         const std::vector<size_t>&              ioffset,
+                                         const std::vector<size_t>&              ooffset,
+                                         const double output_scalar = 1.0)
+{
+    const size_t run = std::min(contiguous_run_length(whole_length, istride),
+                                contiguous_run_length(whole_length, ostride));
+    if(run == 0)
+        return distance_1to1_complex_strided(input,
+                                             output,
+                                             whole_length,
+                                             nbatch,
+                                             istride,
+                                             idist,
+                                             ostride,
+                                             odist,
+                                             linf_failures,
+                                             linf_cutoff,
+                                             ioffset,
+                                             ooffset,
+                                             output_scalar);
+
+    // interleaved data is reduced as a real array of twice the length
+    const auto in     = reinterpret_cast<const Tfloat*>(input + ioffset[0]);
+    const auto out    = reinterpret_cast<const Tfloat*>(output + ooffset[0]);
+    auto       states = reduce_contiguous_blocks<blocked_norms>(
+        whole_length,
+        nbatch,
+        istride,
+        idist,
+        ostride,
+        odist,
+        run,
+        [&](blocked_norms& state, size_t b, size_t idx, size_t odx, size_t n) {
+            distance_block<1, 1, 2>(
+                in + 2 * idx, out + 2 * odx, 2 * n, output_scalar, linf_cutoff, b, idx, state);
+        });
+    return combine_blocked_norms(states, linf_failures);
+}
+
 // Compute the L-infinity and L-2 distance between two buffers with strides istride and
 // length idist between batches to a buffer with strides ostride and length odist between
 // batches.  Both buffers are of real type.
 template <typename Tfloat, typename Tint1, typename Tint2, typename Tint3>
-inline VectorNorms distance_1to1_real(const Tfloat*                           input,
-                                      const Tfloat*                           output,
-                                      const Tint1&                            whole_length,
-                                      const size_t                            nbatch,
-                                      const Tint2&                            istride,
-                                      const size_t                            idist,
-                                      const Tint3&                            ostride,
-                                      const size_t                            odist,
-                                      std::vector<std::pair<size_t, size_t>>& linf_failures,
-                                      const double                            linf_cutoff,
-                                      const std::vector<size_t>&              ioffset,
-                                      const std::vector<size_t>&              ooffset,
-                                      const double                            output_scalar = 1.0)
+inline VectorNorms
+    distance_1to1_real_strided(const Tfloat*                           input,
+                               const Tfloat*                           output,
+                               const Tint1&                            whole_length,
+                               const size_t                            nbatch,
+                               const Tint2&                            istride,
+                               const size_t                            idist,
+                               const Tint3&                            ostride,
+                               const size_t                            odist,
+                               std::vector<std::pair<size_t, size_t>>& linf_failures,
+                               const double                            linf_cutoff,
+                               const std::vector<size_t>&              ioffset,
+                               const std::vector<size_t>&              ooffset,
+                               const double                            output_scalar = 1.0)
 {
     double linf = 0.0;
     double l2   = 0.0;
@@ -2308,24 +2638,76 @@ inline VectorNorms distance_1to1_real(const Tfloat*                           in
     return {.l_2 = sqrt(l2), .l_inf = linf};
 }
 
+// Compute the L-infinity and L-2 distance between two buffers of real type, using the
+// blocked fast path if both have unit innermost stride.
+template <typename Tfloat, typename Tint1, typename Tint2, typename Tint3>
+inline VectorNorms distance_1to1_real(const Tfloat*                           input,
+                                      const Tfloat*                           output,
+                                      const Tint1&                            whole_length,
+                                      const size_t                            nbatch,
+                                      const Tint2&                            istride,
+                                      const size_t                            idist,
+                                      const Tint3&                            ostride,
+                                      const size_t                            odist,
+                                      std::vector<std::pair<size_t, size_t>>& linf_failures,
+                                      const double                            linf_cutoff,
+                                      const std::vector<size_t>&              ioffset,
+                                      const std::vector<size_t>&              ooffset,
+                                      const double                            output_scalar = 1.0)
+{
+    const size_t run = std::min(contiguous_run_length(whole_length, istride),
+                                contiguous_run_length(whole_length, ostride));
+    if(run == 0)
+        return distance_1to1_real_strided(input,
+                                          output,
+                                          whole_length,
+                                          nbatch,
+                                          istride,
+                                          idist,
+                                          ostride,
+                                          odist,
+                                          linf_failures,
+                                          linf_cutoff,
+                                          ioffset,
+                                          ooffset,
+                                          output_scalar);
+
+    const auto in     = input + ioffset[0];
+    const auto out    = output + ooffset[0];
+    auto       states = reduce_contiguous_blocks<blocked_norms>(
+        whole_length,
+        nbatch,
+        istride,
+        idist,
+        ostride,
+        odist,
+        run,
+        [&](blocked_norms& state, size_t b, size_t idx, size_t odx, size_t n) {
+            distance_block<1, 1, 1>(
+                in + idx, out + odx, n, output_scalar, linf_cutoff, b, idx, state);
+        });
+    return combine_blocked_norms(states, linf_failures);
+}
+
 // Compute the L-infinity and L-2 distance between two buffers with strides istride and
 // length idist between batches to a buffer with strides ostride and length odist between
 // batches.  input is complex-interleaved, output is complex-planar.
 template <typename Tval, typename Tint1, typename T2, typename T3>
-inline VectorNorms distance_1to2(const rocfft_complex<Tval>*             input,
-                                 const Tval*                             output0,
-                                 const Tval*                             output1,
-                                 const Tint1&                            whole_length,
-                                 const size_t                            nbatch,
-                                 const T2&                               istride,
-                                 const size_t                            idist,
-                                 const T3&                               ostride,
-                                 const size_t                            odist,
-                                 std::vector<std::pair<size_t, size_t>>& linf_failures,
-                                 const double                            linf_cutoff,
-                                 const std::vector<size_t>&              ioffset,
-                                 const std::vector<size_t>&              ooffset,
-                                 const double                            output_scalar = 1.0)
+inline VectorNorms
+    distance_1to2_strided(const rocfft_complex<Tval>*             input,
+                          const Tval*                             output0,
+                          const Tval*                             output1,
+                          const Tint1&                            whole_length,
+                          const size_t                            nbatch,
+                          const T2&                               istride,
+                          const size_t                            idist,
+                          const T3&                               ostride,
+                          const size_t                            odist,
+                          std::vector<std::pair<size_t, size_t>>& linf_failures,
+                          const double                            linf_cutoff,
+                          const std::vector<size_t>&              ioffset,
+                          const std::vector<size_t>&              ooffset,
+                          const double                            output_scalar = 1.0)
 {
     double linf = 0.0;
     double l2   = 0.0;
@@ -2383,6 +2765,62 @@ inline VectorNorms distance_1to2(const rocfft_complex<Tval>*             input,
     return {.l_2 = sqrt(l2), .l_inf = linf};
 }
 
+// Compute the L-infinity and L-2 distance between a complex-interleaved buffer and a
+// complex-planar buffer, using the blocked fast path if both have unit innermost stride.
+template <typename Tval, typename Tint1, typename T2, typename T3>
+inline VectorNorms distance_1to2(const rocfft_complex<Tval>*             input,
+                                 const Tval*                             output0,
+                                 const Tval*                             output1,
+                                 const Tint1&                            whole_length,
+                                 const size_t                            nbatch,
+                                 const T2&                               istride,
+                                 const size_t                            idist,
+                                 const T3&                               ostride,
+                                 const size_t                            odist,
+                                 std::vector<std::pair<size_t, size_t>>& linf_failures,
+                                 const double                            linf_cutoff,
+                                 const std::vector<size_t>&              ioffset,
+                                 const std::vector<size_t>&              ooffset,
+                                 const double                            output_scalar = 1.0)
+{
+    const size_t run = std::min(contiguous_run_length(whole_length, istride),
+                                contiguous_run_length(whole_length, ostride));
+    if(run == 0)
+        return distance_1to2_strided(input,
+                                     output0,
+                                     output1,
+                                     whole_length,
+                                     nbatch,
+                                     istride,
+                                     idist,
+                                     ostride,
+                                     odist,
+                                     linf_failures,
+                                     linf_cutoff,
+                                     ioffset,
+                                     ooffset,
+                                     output_scalar);
+
+    const auto in     = reinterpret_cast<const Tval*>(input + ioffset[0]);
+    const auto out0   = output0 + ooffset[0];
+    const auto out1   = output1 + ooffset[1];
+    auto       states = reduce_contiguous_blocks<blocked_norms>(
+        whole_length,
+        nbatch,
+        istride,
+        idist,
+        ostride,
+        odist,
+        run,
+        [&](blocked_norms& state, size_t b, size_t idx, size_t odx, size_t n) {
+            distance_block<2, 1, 1>(
+                in + 2 * idx, out0 + odx, n, output_scalar, linf_cutoff, b, idx, state);
+            distance_block<2, 1, 1>(
+                in + 2 * idx + 1, out1 + odx, n, output_scalar, linf_cutoff, b, idx, state);
+        });
+    return combine_blocked_norms(states, linf_failures);
+}
+
 // Compute the L-inifnity and L-2 distance between two buffers of dimension length and
 // with types given by itype, otype, and precision.
 template <typename Tallocator1,
@@ -2737,12 +3175,12 @@ inline VectorNorms distance(const std::vector<std::vector<char, Tallocator1>>& i
 // Compute the L-infinity and L-2 norm of a buffer with strides istride and
 // length idist.  Data is rocfft_complex.
 template <typename Tcomplex, typename T1, typename T2>
-inline VectorNorms norm_complex(const Tcomplex*            input,
-                                const T1&                  whole_length,
-                                const size_t               nbatch,
-                                const T2&                  istride,
-                                const size_t               idist,
-                                const std::vector<size_t>& offset)
+inline VectorNorms norm_complex_strided(const Tcomplex*            input,
+                                        const T1&                  whole_length,
+                                        const size_t               nbatch,
+                                        const T2&                  istride,
+                                        const size_t               idist,
+                                        const std::vector<size_t>& offset)
 {
     double linf = 0.0;
     double l2   = 0.0;
@@ -2780,15 +3218,45 @@ inline VectorNorms norm_complex(const Tcomplex*            input,
     return {.l_2 = sqrt(l2), .l_inf = linf};
 }
 
+// Compute the L-infinity and L-2 norm of a buffer of rocfft_complex, using the blocked fast
+// path if it has unit innermost stride.
+template <typename Tfloat, typename T1, typename T2>
+inline VectorNorms norm_complex(const rocfft_complex<Tfloat>* input,
+                                const T1&                     whole_length,
+                                const size_t                  nbatch,
+                                const T2&                     istride,
+                                const size_t                  idist,
+                                const std::vector<size_t>&    offset)
+{
+    const size_t run = contiguous_run_length(whole_length, istride);
+    if(run == 0)
+        return norm_complex_strided(input, whole_length, nbatch, istride, idist, offset);
+
+    const auto in     = reinterpret_cast<const Tfloat*>(input + offset[0]);
+    auto       states = reduce_contiguous_blocks<blocked_norms>(
+        whole_length,
+        nbatch,
+        istride,
+        idist,
+        istride,
+        idist,
+        run,
+        [&](blocked_norms& state, size_t, size_t idx, size_t, size_t n) {
+            norm_block<1>(in + 2 * idx, 2 * n, state);
+        });
+    std::vector<std::pair<size_t, size_t>> no_failures;
+    return combine_blocked_norms(states, no_failures);
+}
+
 // Compute the L-infinity and L-2 norm of abuffer with strides istride and
 // length idist.  Data is real-valued.
 template <typename Tfloat, typename T1, typename T2>
-inline VectorNorms norm_real(const Tfloat*              input,
-                             const T1&                  whole_length,
-                             const size_t               nbatch,
-                             const T2&                  istride,
-                             const size_t               idist,
-                             const std::vector<size_t>& offset)
+inline VectorNorms norm_real_strided(const Tfloat*              input,
+                                     const T1&                  whole_length,
+                                     const size_t               nbatch,
+                                     const T2&                  istride,
+                                     const size_t               idist,
+                                     const std::vector<size_t>& offset)
 {
     double linf = 0.0;
     double l2   = 0.0;
@@ -2821,6 +3289,36 @@ inline VectorNorms norm_real(const Tfloat*              input,
     return {.l_2 = sqrt(l2), .l_inf = linf};
 }
 
+// Compute the L-infinity and L-2 norm of a real-valued buffer, using the blocked fast path if
+// it has unit innermost stride.
+template <typename Tfloat, typename T1, typename T2>
+inline VectorNorms norm_real(const Tfloat*              input,
+                             const T1&                  whole_length,
+                             const size_t               nbatch,
+                             const T2&                  istride,
+                             const size_t               idist,
+                             const std::vector<size_t>& offset)
+{
+    const size_t run = contiguous_run_length(whole_length, istride);
+    if(run == 0)
+        return norm_real_strided(input, whole_length, nbatch, istride, idist, offset);
+
+    const auto in     = input + offset[0];
+    auto       states = reduce_contiguous_blocks<blocked_norms>(
+        whole_length,
+        nbatch,
+        istride,
+        idist,
+        istride,
+        idist,
+        run,
+        [&](blocked_norms& state, size_t, size_t idx, size_t, size_t n) {
+            norm_block<1>(in + idx, n, state);
+        });
+    std::vector<std::pair<size_t, size_t>> no_failures;
+    return combine_blocked_norms(states, no_failures);
+}
+
 // Compute the L-infinity and L-2 norm of abuffer with strides istride and
 // length idist.  Data format is given by precision and itype.
 template <typename Tallocator1, typename T1, typename T2>
@@ -41,6 +41,25 @@ static size_t complex_type_size(rocfft_precision precision)
     return real_type_size(precision) * 2;
 }
 
+// size of numbers kept in memory, which may be narrower than the
+// precision used for computation
+static size_t real_type_size(rocfft_precision precision, rocfft_storage_precision storage)
+{
+    switch(storage)
+    {
+    case rocfft_storage_precision_native:
+        return real_type_size(precision);
+    case rocfft_storage_precision_half:
+    case rocfft_storage_precision_bfloat16:
+        return 2;
+    }
+}
+
+static size_t complex_type_size(rocfft_precision precision, rocfft_storage_precision storage)
+{
+    return real_type_size(precision, storage) * 2;
+}
+
 static const char* precision_name(rocfft_precision precision)
 {
     switch(precision)